@@ -58,6 +58,7 @@
 #include "boards.h"
 #include "nrf_delay.h"
 #include "app_timer.h"
+#include "touch_calib.h"
 
 #define NRF_LOG_MODULE_NAME "APP"
 #include "nrf_log.h"
@@ -180,7 +181,7 @@ typedef struct
 #define NODE_PER_INCH	5
 #define DPI_PER_SCAN	(1.0 * DPI / SCAN_RATE)
 #define UNIT_LENGTH		(4.0 * NODE_PER_INCH / SCAN_RATE)
-#define OFFSET_VALUE	32
+#define OFFSET_VALUE	32	// Baseline until the calibration is learned or loaded, see touch_calib.h.
 #define ROWS 					16
 #define COLS 					24
 #define TACT_BUF_SZ 	ROWS * COLS
@@ -195,12 +196,13 @@ typedef struct
 #define HIGH 1
 #define IO_DELAY 1
 
-#define OFFSET(x, y) (x - y > 0 ? x - y : 0)
+STATIC_ASSERT((COLS == TOUCH_CALIB_COLS) && (ROWS == TOUCH_CALIB_ROWS));
 
 #define FLOATING_BUF_SIZE 8
 static uint16_t tact_buf[COLS][ROWS];
 static nrf_saadc_value_t floating_buf[FLOATING_BUF_SIZE][COLS][ROWS];
 static uint8_t floating_buf_idx = 0;
+static bool floating_buf_primed = false;	// The moving average is filled with the first frame, instead of starting from zero.
 static uint16_t touch_sqr_buf[TOUCH_SQR_SZ][TOUCH_SQR_SZ];
 
 touch_event_t last_touch = {
@@ -1590,14 +1592,18 @@ void scan_sensors()
 			exp_io_in_sel(j);
 			nrf_drv_saadc_sample();
 			nrf_drv_saadc_sample_convert(0, &floating_buf[floating_buf_idx % FLOATING_BUF_SIZE][i][j]);
+			if (!floating_buf_primed) {
+				for (int x = 0; x < FLOATING_BUF_SIZE; x++) { floating_buf[x][i][j] = floating_buf[floating_buf_idx % FLOATING_BUF_SIZE][i][j]; }
+			}
 
 			nrf_saadc_value_t floating_buf_sum = 0;
 			for (int x = 0; x < FLOATING_BUF_SIZE; x++) { floating_buf_sum += floating_buf[x][i][j]; }
-			tact_buf[i][j] = OFFSET(floating_buf_sum / FLOATING_BUF_SIZE, OFFSET_VALUE);
+			tact_buf[i][j] = touch_calib_apply(i, j, floating_buf_sum / FLOATING_BUF_SIZE);
 			col_sampled[i] |= tact_buf[i][j] > 0;
 
 		}
 	}
+	floating_buf_primed = true;
 
 	int touchCount = 0;
 	buf[0] = timestamp & 0xFF;
@@ -1646,12 +1652,9 @@ void scan_sensors()
 							uint16_t x = MAP(posx, 0, 23, 0, 65535);
 							uint16_t y = MAP(posy, 0, 15, 0, 65535);
 							uint16_t z = center_force;
-							/*
-							NRF_LOG_RAW_INFO("Frame(%d): ", timestamp);
-							NRF_LOG_RAW_INFO("(%d, %d) / (" NRF_LOG_FLOAT_MARKER ", " NRF_LOG_FLOAT_MARKER ")", i, j, NRF_LOG_FLOAT(posx), NRF_LOG_FLOAT(posy));
-							NRF_LOG_RAW_INFO("\r\n");
-							NRF_LOG_RAW_INFO("x(%d) y(%d) z(%d)\r\n", x, y, z);
-							*/
+							// One entry per touch. With NRF_LOG_BACKEND_SERIAL_BINARY this is
+							// formatted on the host (nrf_log_decode.py), so it can stay enabled.
+							NRF_LOG_RAW_INFO("Frame(%d): (%d, %d) x(%d) y(%d) z(%d)\r\n", timestamp, i, j, x, y, z);
 							
 							buf[2] = x & 0xFF;
 							buf[3] = x >> 8;
@@ -1684,6 +1687,9 @@ void scan_sensors()
 		no_touch_count = 0;
 		sleep_count = 0;
 	}
+
+	// Learns and tracks the baselines, and stores them when they have drifted.
+	touch_calib_frame_end(touchCount > 0);
 	
 	floating_buf_idx = (floating_buf_idx + 1) % FLOATING_BUF_SIZE;
 }
@@ -1739,6 +1745,9 @@ int main(void)
     {
         NRF_LOG_INFO("Bonds erased!\r\n");
     }
+    // After pm_init(), which initializes FDS. The stored calibration is loaded here.
+    err_code = touch_calib_init(OFFSET_VALUE);
+    APP_ERROR_CHECK(err_code);
     gap_params_init();
     advertising_init();
     services_init();
@@ -37,12 +37,23 @@
 #define NRF_BLE_QWR_ENABLED 0
 #endif
 
-// <q> PEER_MANAGER_ENABLED  - peer_manager - Peer Manager
- 
-
+// <e> PEER_MANAGER_ENABLED - peer_manager - Peer Manager
+//==========================================================
 #ifndef PEER_MANAGER_ENABLED
 #define PEER_MANAGER_ENABLED 1
 #endif
+#if  PEER_MANAGER_ENABLED
+// <o> PM_RA_CACHE_SIZE - Number of resolved private addresses to remember. 
+// <i> A bonded peer which reconnects with a resolvable private address it used
+// <i> before is identified without resolving the address against every IRK.
+// <i> It uses 8 bytes of RAM per entry. 0 disables the cache.
+
+#ifndef PM_RA_CACHE_SIZE
+#define PM_RA_CACHE_SIZE 4
+#endif
+
+#endif //PEER_MANAGER_ENABLED
+// </e>
 
 // </h> 
 //==========================================================
@@ -3033,6 +3044,29 @@
 #define APP_SCHEDULER_WITH_PROFILER 0
 #endif
 
+// <o> APP_SCHEDULER_PRIORITY_COUNT - Number of event priorities  <1-8> 
+
+
+// <i> Each priority has its own queue. Priority 0 is the highest.
+
+#ifndef APP_SCHEDULER_PRIORITY_COUNT
+#define APP_SCHEDULER_PRIORITY_COUNT 1
+#endif
+
+// <e> APP_SCHEDULER_WITH_HANDLER_STATS - Enabling per-handler execution and queue wait time statistics
+//==========================================================
+#ifndef APP_SCHEDULER_WITH_HANDLER_STATS
+#define APP_SCHEDULER_WITH_HANDLER_STATS 0
+#endif
+#if  APP_SCHEDULER_WITH_HANDLER_STATS
+// <o> APP_SCHEDULER_HANDLER_STATS_COUNT - Number of event handlers with statistics 
+#ifndef APP_SCHEDULER_HANDLER_STATS_COUNT
+#define APP_SCHEDULER_HANDLER_STATS_COUNT 8
+#endif
+
+#endif //APP_SCHEDULER_WITH_HANDLER_STATS
+// </e>
+
 #endif //APP_SCHEDULER_ENABLED
 // </e>
 
@@ -3128,19 +3162,51 @@
 #define BUTTON_ENABLED 1
 #endif
 
-// <q> CRC16_ENABLED  - crc16 - CRC16 calculation routines
- 
-
+// <e> CRC16_ENABLED - crc16 - CRC16 calculation routines
+//==========================================================
 #ifndef CRC16_ENABLED
 #define CRC16_ENABLED 1
 #endif
-
-// <q> CRC32_ENABLED  - crc32 - CRC32 calculation routines
+#if  CRC16_ENABLED
+// <o> CRC16_CONFIG_IMPLEMENTATION  - Implementation of crc16_compute
  
 
+// <i> Larger tables trade flash for speed. All implementations give the same result.
+// <0=> Bitwise (no table) 
+// <1=> Nibble table (32 bytes) 
+// <2=> Byte table (512 bytes) 
+// <3=> Slice-by-4 (2048 bytes) 
+// <4=> Slice-by-8 (4096 bytes) 
+
+#ifndef CRC16_CONFIG_IMPLEMENTATION
+#define CRC16_CONFIG_IMPLEMENTATION 2
+#endif
+
+#endif //CRC16_ENABLED
+// </e>
+
+// <e> CRC32_ENABLED - crc32 - CRC32 calculation routines
+//==========================================================
 #ifndef CRC32_ENABLED
 #define CRC32_ENABLED 0
 #endif
+#if  CRC32_ENABLED
+// <o> CRC32_CONFIG_IMPLEMENTATION  - Implementation of crc32_compute
+ 
+
+// <i> Larger tables trade flash for speed. All implementations give the same result.
+// <0=> Bitwise (no table) 
+// <1=> Nibble table (64 bytes) 
+// <2=> Byte table (1024 bytes) 
+// <3=> Slice-by-4 (4096 bytes) 
+// <4=> Slice-by-8 (8192 bytes) 
+
+#ifndef CRC32_CONFIG_IMPLEMENTATION
+#define CRC32_CONFIG_IMPLEMENTATION 0
+#endif
+
+#endif //CRC32_ENABLED
+// </e>
 
 // <q> ECC_ENABLED  - ecc - Elliptic Curve Cryptography Library
  
@@ -3193,6 +3259,31 @@
 #define FDS_VIRTUAL_PAGE_SIZE 1024
 #endif
 
+// <o> FDS_RECORD_INDEX_SIZE - Number of entries in the RAM index of records. 
+// <i> With the index, records are found by file ID and record key without scanning flash.
+// <i> It uses 8 bytes of RAM per entry and holds one record less than its number of entries.
+// <i> Must be 0 (disabled) or a power of two.
+
+#ifndef FDS_RECORD_INDEX_SIZE
+#define FDS_RECORD_INDEX_SIZE 32
+#endif
+
+// <o> FDS_GC_BACKGROUND_WORDS - Dirty words on a page which start background garbage collection. 
+// <i> When the FDS queue is empty, one page which has at least this many words in deleted records
+// <i> is garbage collected. 0 disables background garbage collection.
+
+#ifndef FDS_GC_BACKGROUND_WORDS
+#define FDS_GC_BACKGROUND_WORDS 768
+#endif
+
+// <o> FDS_TXN_MAX_RECORDS - Maximum number of records in a transaction. 
+// <i> Records written with fds_txn_write() become valid together. 0 disables transactions.
+// <i> Record key 0xFFFF is reserved for transactions unless they are disabled.
+
+#ifndef FDS_TXN_MAX_RECORDS
+#define FDS_TXN_MAX_RECORDS 0
+#endif
+
 #endif //FDS_ENABLED
 // </e>
 
@@ -3667,6 +3758,19 @@
 #define NRF_LOG_TIMESTAMP_DIGITS 8
 #endif
 
+// <q> NRF_LOG_BACKEND_SERIAL_BINARY  - Send binary frames instead of formatted text
+ 
+
+// <i> Format strings are sent as addresses and formatted on the host
+// <i> with components/libraries/log/tools/nrf_log_decode.py. To use it,
+// <i> set this to 1 and read the UART or RTT output with
+// <i> nrf_log_decode.py _build/nrf52832_xxaa.out -i /dev/ttyACM0 -b 115200.
+// <i> Left disabled, the log stays readable in any terminal.
+
+#ifndef NRF_LOG_BACKEND_SERIAL_BINARY
+#define NRF_LOG_BACKEND_SERIAL_BINARY 0
+#endif
+
 // <e> NRF_LOG_BACKEND_SERIAL_USES_UART - If enabled data is printed over UART
 //==========================================================
 #ifndef NRF_LOG_BACKEND_SERIAL_USES_UART
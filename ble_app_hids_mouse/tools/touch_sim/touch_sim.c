@@ -0,0 +1,576 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Touch calibration simulation for a PC host.
+ *
+ * Runs the frame pipeline of scan_sensors() in main.c against a simulated 24x16 sensor: a
+ * moving average over FLOATING_BUF_SIZE frames, then either the constant OFFSET_VALUE or
+ * touch_calib.c, then detection of local maxima. The sensor has a per-cell baseline, gain and
+ * noise level, and its baseline drifts with temperature. Calibration records are stored by
+ * fds.c on the RAM flash emulator in fstorage_ram.c, and the flash is kept across simulated
+ * resets, which run in new processes.
+ *
+ * The boot test measures the time to the first valid touch after power-on: the first frame
+ * which reports exactly one touch, within TOUCH_MAX_ERROR cells of the finger. The finger is
+ * either on the sensor at power-on, or lands TAP_FRAME frames later. Pipelines:
+ * - offset: main.c before calibration. The moving average starts from zero.
+ * - cold:   touch_calib.c without a stored record.
+ * - warm:   touch_calib.c with the record stored during the cold boot.
+ *
+ * The drift test runs for a number of hours with a tap every few seconds, and counts frames
+ * with missed or false touches and writes of the calibration record.
+ *
+ * Usage: touch_sim [hours]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include "sdk_common.h"
+#include "fds.h"
+#include "fstorage_ram.h"
+#include "touch_calib.h"
+
+
+#define SCAN_RATE           50          // Frames per second, as in main.c.
+#define FLOATING_BUF_SIZE   8           // As in main.c.
+#define OFFSET_VALUE        32          // As in main.c.
+#define COLS                TOUCH_CALIB_COLS
+#define ROWS                TOUCH_CALIB_ROWS
+
+#define TOUCH_PEAK          200.0       // Reading of a finger over the center of a cell, in counts.
+#define TOUCH_SIGMA         0.6         // Spread of a finger, in cells.
+#define TOUCH_MAX_ERROR     0.75        // Largest position error of a valid touch, in cells.
+#define TAP_FRAME           10          // Frame in which a tap lands in the boot test.
+#define BOOT_FRAMES         200         // Frames run by the boot test.
+
+#define DRIFT_COUNTS        10.0        // Amplitude of the thermal baseline drift, in counts.
+#define DRIFT_PERIOD_S      3600.0      // Period of the drift.
+#define DRIFT_TAP_PERIOD_S  5           // The drift test taps once in this period...
+#define DRIFT_TAP_FRAMES    25          // ...for this many frames.
+#define DRIFT_HOURS_DEFAULT 2
+
+
+typedef struct
+{
+    double baseline[COLS][ROWS];
+    double noise[COLS][ROWS];           // Standard deviation, in counts.
+    double gain[COLS][ROWS];
+} sensor_t;
+
+typedef struct
+{
+    bool   down;
+    double x;
+    double y;
+} finger_t;
+
+typedef enum
+{
+    PIPELINE_OFFSET,
+    PIPELINE_CALIB,
+} pipeline_type_t;
+
+typedef struct
+{
+    pipeline_type_t type;
+    int16_t         history[FLOATING_BUF_SIZE][COLS][ROWS];
+    uint8_t         idx;
+    bool            primed;
+} pipeline_t;
+
+// Result of a frame.
+typedef struct
+{
+    int    touches;
+    double x;               // Position of the first touch.
+    double y;
+} frame_t;
+
+
+static sensor_t  m_sensor;
+static uint32_t  m_rand = 1;
+static uint8_t * m_image;   // Flash kept across resets, shared between processes.
+static uint32_t  m_image_size;
+
+
+static uint32_t sim_rand(void)
+{
+    m_rand = (m_rand * 1103515245UL) + 12345UL;
+    return (m_rand >> 16) & 0x7FFF;
+}
+
+
+static double sim_uniform(void)
+{
+    return sim_rand() / 32768.0;
+}
+
+
+// Approximately normal, with standard deviation 1.
+static double sim_normal(void)
+{
+    return (sim_uniform() + sim_uniform() + sim_uniform() + sim_uniform() - 2.0) * sqrt(3.0);
+}
+
+
+// The same sensor in every process.
+static void sensor_init(void)
+{
+    m_rand = 12345;
+    for (int i = 0; i < COLS; i++)
+    {
+        for (int j = 0; j < ROWS; j++)
+        {
+            m_sensor.baseline[i][j] = 10.0 + (0.3 * i) + (0.4 * j) + (6.0 * sim_uniform()) - 3.0;
+            m_sensor.noise[i][j]    = 0.7 + (1.3 * sim_uniform());
+            m_sensor.gain[i][j]     = 0.8 + (0.4 * sim_uniform());
+        }
+    }
+}
+
+
+static int16_t sensor_read(int col, int row, uint32_t frame, finger_t const * p_finger)
+{
+    double const drift = DRIFT_COUNTS * sin(2.0 * M_PI * frame / (DRIFT_PERIOD_S * SCAN_RATE)) *
+                         (0.5 + (0.5 * col / COLS));
+    double       value = m_sensor.baseline[col][row] + drift +
+                         (m_sensor.noise[col][row] * sim_normal());
+
+    if (p_finger->down && (fabs(col - p_finger->x) < 3.0) && (fabs(row - p_finger->y) < 3.0))
+    {
+        double const d2 = ((col - p_finger->x) * (col - p_finger->x)) +
+                          ((row - p_finger->y) * (row - p_finger->y));
+
+        value += TOUCH_PEAK * m_sensor.gain[col][row] * exp(-d2 / (2.0 * TOUCH_SIGMA * TOUCH_SIGMA));
+    }
+
+    return (int16_t)MIN(MAX(lround(value), 0), 4095);
+}
+
+
+// Like is_touch_center() in main.c: greater than the cells before, not less than those after.
+static bool is_peak(uint16_t tact[COLS][ROWS], int col, int row)
+{
+    for (int m = -1; m <= 1; m++)
+    {
+        for (int n = -1; n <= 1; n++)
+        {
+            int const c = col + m;
+            int const r = row + n;
+
+            if (((m == 0) && (n == 0)) || (c < 0) || (c >= COLS) || (r < 0) || (r >= ROWS))
+            {
+                continue;
+            }
+            if (((m < 0) || ((m == 0) && (n < 0))) ? (tact[col][row] <= tact[c][r])
+                                                   : (tact[col][row] <  tact[c][r]))
+            {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+
+static frame_t pipeline_frame(pipeline_t * p_pipe, uint32_t frame, finger_t const * p_finger)
+{
+    static uint16_t tact[COLS][ROWS];
+    frame_t         result = {0};
+
+    for (int i = 0; i < COLS; i++)
+    {
+        for (int j = 0; j < ROWS; j++)
+        {
+            int16_t const raw = sensor_read(i, j, frame, p_finger);
+            int32_t       sum = 0;
+
+            p_pipe->history[p_pipe->idx][i][j] = raw;
+            if ((p_pipe->type == PIPELINE_CALIB) && !p_pipe->primed)
+            {
+                for (int x = 0; x < FLOATING_BUF_SIZE; x++)
+                {
+                    p_pipe->history[x][i][j] = raw;
+                }
+            }
+            for (int x = 0; x < FLOATING_BUF_SIZE; x++)
+            {
+                sum += p_pipe->history[x][i][j];
+            }
+
+            if (p_pipe->type == PIPELINE_CALIB)
+            {
+                tact[i][j] = touch_calib_apply(i, j, (int16_t)(sum / FLOATING_BUF_SIZE));
+            }
+            else
+            {
+                tact[i][j] = MAX((int32_t)(sum / FLOATING_BUF_SIZE) - OFFSET_VALUE, 0);
+            }
+        }
+    }
+    p_pipe->primed = true;
+    p_pipe->idx    = (p_pipe->idx + 1) % FLOATING_BUF_SIZE;
+
+    for (int i = 0; i < COLS; i++)
+    {
+        for (int j = 0; j < ROWS; j++)
+        {
+            double total = 0;
+            double x     = 0;
+            double y     = 0;
+
+            if ((tact[i][j] == 0) || !is_peak(tact, i, j))
+            {
+                continue;
+            }
+
+            for (int m = -1; m <= 1; m++)
+            {
+                for (int n = -1; n <= 1; n++)
+                {
+                    if (((i + m) >= 0) && ((i + m) < COLS) && ((j + n) >= 0) && ((j + n) < ROWS))
+                    {
+                        total += tact[i + m][j + n];
+                        x     += tact[i + m][j + n] * (i + m);
+                        y     += tact[i + m][j + n] * (j + n);
+                    }
+                }
+            }
+
+            if (result.touches++ == 0)
+            {
+                result.x = x / total;
+                result.y = y / total;
+            }
+        }
+    }
+
+    if (p_pipe->type == PIPELINE_CALIB)
+    {
+        touch_calib_frame_end(result.touches > 0);
+        fs_ram_run();
+    }
+
+    return result;
+}
+
+
+static bool frame_is_valid(frame_t const * p_frame, finger_t const * p_finger)
+{
+    return p_finger->down && (p_frame->touches == 1) &&
+           (hypot(p_frame->x - p_finger->x, p_frame->y - p_finger->y) <= TOUCH_MAX_ERROR);
+}
+
+
+// Powers on with the flash in m_image, or erased flash. Returns false on error.
+static bool power_on(pipeline_t * p_pipe, pipeline_type_t type, bool retained)
+{
+    memset(p_pipe, 0x00, sizeof(*p_pipe));
+    p_pipe->type = type;
+
+    if (type == PIPELINE_OFFSET)
+    {
+        return true;
+    }
+    if (retained && !fs_ram_flash_set(m_image, m_image_size))
+    {
+        return false;
+    }
+    if (touch_calib_init(OFFSET_VALUE) != NRF_SUCCESS)
+    {
+        return false;
+    }
+    fs_ram_run();
+
+    return true;
+}
+
+
+// Keeps the flash for the next power-on.
+static void power_off(void)
+{
+    uint32_t           size;
+    void const * const p_flash = fs_ram_flash_get(&size);
+
+    memcpy(m_image, p_flash, MIN(size, m_image_size));
+}
+
+
+// Runs the boot test in the current process. Returns the frame number of the first valid touch,
+// starting at 1, or 0 if there was none.
+static uint32_t boot_test(pipeline_type_t type, bool retained, uint32_t tap_frame)
+{
+    pipeline_t pipe;
+    finger_t   finger = {false, 10.3, 7.6};
+
+    if (!power_on(&pipe, type, retained))
+    {
+        return 0;
+    }
+
+    for (uint32_t frame = 0; frame < BOOT_FRAMES; frame++)
+    {
+        frame_t result;
+
+        finger.down = (frame >= tap_frame);
+        result      = pipeline_frame(&pipe, frame, &finger);
+        if (frame_is_valid(&result, &finger))
+        {
+            return frame + 1;
+        }
+    }
+
+    return 0;
+}
+
+
+// Learns the calibration without touch and keeps the flash once the record is written.
+static int calibration_store(void)
+{
+    pipeline_t          pipe;
+    finger_t            finger = {false, 0, 0};
+    touch_calib_stats_t stats;
+
+    if (!power_on(&pipe, PIPELINE_CALIB, false))
+    {
+        return 1;
+    }
+
+    for (uint32_t frame = 0; frame < (60 * SCAN_RATE); frame++)
+    {
+        (void)pipeline_frame(&pipe, frame, &finger);
+        touch_calib_stats_get(&stats);
+        if (stats.saves > 0)
+        {
+            power_off();
+            printf("Calibration record: %u bytes (%u bytes as plain arrays), stored after %u frames.\n\n",
+                   (unsigned)stats.record_bytes,
+                   (unsigned)(TOUCH_CALIB_CELLS * (sizeof(uint16_t) + 2 * sizeof(uint8_t))),
+                   (unsigned)stats.frames);
+            return 0;
+        }
+    }
+
+    printf("The calibration record was not stored.\n");
+    return 1;
+}
+
+
+static void drift_test(pipeline_type_t type, char const * p_name, uint32_t hours)
+{
+    uint32_t const      frames      = hours * 3600 * SCAN_RATE;
+    uint32_t            missed      = 0;
+    uint32_t            false_touch = 0;
+    uint32_t            tap_frames  = 0;
+    pipeline_t          pipe;
+    finger_t            finger      = {false, 0, 0};
+    touch_calib_stats_t stats;
+
+    if (!power_on(&pipe, type, true))
+    {
+        printf("%-8s power on failed\n", p_name);
+        return;
+    }
+
+    m_rand = 1;
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        uint32_t const phase = frame % (DRIFT_TAP_PERIOD_S * SCAN_RATE);
+        frame_t        result;
+
+        if (phase == 0)
+        {
+            finger.x = 1.0 + (sim_uniform() * (COLS - 3));
+            finger.y = 1.0 + (sim_uniform() * (ROWS - 3));
+        }
+        finger.down = (phase < DRIFT_TAP_FRAMES);
+
+        result = pipeline_frame(&pipe, frame, &finger);
+
+        if (finger.down)
+        {
+            // A touch takes a few frames to reach the moving average.
+            if (phase >= (FLOATING_BUF_SIZE / 2))
+            {
+                tap_frames++;
+                missed += !frame_is_valid(&result, &finger);
+            }
+        }
+        else if ((result.touches > 0) && (phase >= (DRIFT_TAP_FRAMES + FLOATING_BUF_SIZE)))
+        {
+            false_touch++;
+        }
+    }
+
+    memset(&stats, 0x00, sizeof(stats));
+    if (type == PIPELINE_CALIB)
+    {
+        touch_calib_stats_get(&stats);
+    }
+
+    printf("%-8s %5u h %10.2f %% %10.3f %% %8u %8u\n",
+           p_name, (unsigned)hours,
+           100.0 * missed / tap_frames,
+           100.0 * false_touch / (frames - tap_frames),
+           (unsigned)stats.saves,
+           (unsigned)stats.save_failures);
+}
+
+
+// Runs a test in a new process, since FDS can only be initialized once.
+static int run_in_child(int (*test)(void *), void * p_arg)
+{
+    pid_t pid;
+    int   status;
+
+    fflush(stdout);
+    pid = fork();
+    if (pid == 0)
+    {
+        exit(test(p_arg));
+    }
+    if ((pid < 0) || (waitpid(pid, &status, 0) != pid) || !WIFEXITED(status))
+    {
+        return -1;
+    }
+
+    return WEXITSTATUS(status);
+}
+
+
+typedef struct
+{
+    pipeline_type_t type;
+    bool            retained;
+    uint32_t        tap_frame;
+} boot_args_t;
+
+
+static int boot_child(void * p_arg)
+{
+    boot_args_t const * p_args = p_arg;
+    uint32_t            frame;
+
+    sensor_init();
+    m_rand = 1;
+    frame  = boot_test(p_args->type, p_args->retained, p_args->tap_frame);
+
+    return (int)MIN(frame, 255);
+}
+
+
+static int store_child(void * p_arg)
+{
+    (void)p_arg;
+    sensor_init();
+    m_rand = 1;
+    return calibration_store();
+}
+
+
+typedef struct
+{
+    pipeline_type_t type;
+    char const *    p_name;
+    uint32_t        hours;
+} drift_args_t;
+
+
+static int drift_child(void * p_arg)
+{
+    drift_args_t const * p_args = p_arg;
+
+    sensor_init();
+    drift_test(p_args->type, p_args->p_name, p_args->hours);
+    return 0;
+}
+
+
+static void boot_print(char const * p_name, pipeline_type_t type, bool retained)
+{
+    boot_args_t args = {type, retained, 0};
+    int         at_power_on;
+    int         tap;
+
+    at_power_on    = run_in_child(boot_child, &args);
+    args.tap_frame = TAP_FRAME;
+    tap            = run_in_child(boot_child, &args);
+
+    printf("%-8s", p_name);
+    if (at_power_on > 0)
+    {
+        printf(" %14u ms", (unsigned)(at_power_on * 1000 / SCAN_RATE));
+    }
+    else
+    {
+        printf(" %17s", "none");
+    }
+    if (tap > 0)
+    {
+        printf(" %14u ms\n", (unsigned)(tap * 1000 / SCAN_RATE));
+    }
+    else
+    {
+        printf(" %17s\n", "none");
+    }
+}
+
+
+int main(int argc, char ** argv)
+{
+    uint32_t     hours = DRIFT_HOURS_DEFAULT;
+    drift_args_t drift;
+
+    if (argc > 1)
+    {
+        hours = (uint32_t)strtoul(argv[1], NULL, 0);
+    }
+
+    (void)fs_ram_flash_get(&m_image_size);
+    m_image = mmap(NULL, m_image_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (m_image == MAP_FAILED)
+    {
+        return 1;
+    }
+    memset(m_image, 0xFF, m_image_size);
+
+    printf("Sensor %ux%u at %u Hz. Warm-up %u frames, drift threshold %u counts, "
+           "record rewrites at most every %u frames.\n\n",
+           COLS, ROWS, SCAN_RATE, TOUCH_CALIB_WARMUP_FRAMES, TOUCH_CALIB_DRIFT_COUNTS,
+           TOUCH_CALIB_SAVE_INTERVAL_FRAMES);
+
+    if (run_in_child(store_child, NULL) != 0)
+    {
+        return 1;
+    }
+
+    printf("%-8s %17s %17s\n", "", "first valid touch", "first valid touch");
+    printf("%-8s %17s %17s\n", "boot", "finger at pwr on", "tap at 200 ms");
+    boot_print("offset", PIPELINE_OFFSET, false);
+    boot_print("cold",   PIPELINE_CALIB,  false);
+    boot_print("warm",   PIPELINE_CALIB,  true);
+
+    printf("\n%-8s %7s %12s %12s %8s %8s\n", "drift", "", "missed", "false", "record", "failed");
+    printf("%-8s %7s %12s %12s %8s %8s\n", "", "", "touch", "touch", "writes", "writes");
+    drift = (drift_args_t){PIPELINE_OFFSET, "offset", hours};
+    (void)run_in_child(drift_child, &drift);
+    drift = (drift_args_t){PIPELINE_CALIB, "warm", hours};
+    (void)run_in_child(drift_child, &drift);
+
+    return 0;
+}
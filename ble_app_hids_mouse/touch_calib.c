@@ -0,0 +1,555 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "touch_calib.h"
+#include <string.h>
+#include "sdk_common.h"
+#include "fds.h"
+#include "crc16.h"
+
+
+#define CALIB_RECORD_VERSION    1               // Version of the record layout.
+#define CALIB_RAW_MAX           4095            // Largest reading of the 12 bit SAADC.
+#define CALIB_Q                 4               // Baselines and noise are kept in units of 1/16 count.
+#define CALIB_TRACK_SHIFT       6               // Tracking time constant, as a power of two frames.
+#define CALIB_MIN_MARGIN        (8 << CALIB_Q)  // Smallest touch threshold above the baseline.
+#define CALIB_COLD_REJECT_FRAMES 4              // Frames after which cold learning skips readings above threshold.
+#define CALIB_STALE_CELLS       (TOUCH_CALIB_CELLS / 4) // Cells above threshold which make a loaded calibration stale.
+#define CALIB_PLANES            3               // Baseline, gain and noise.
+#define CALIB_TOKEN_MAX_BYTES   2               // Largest encoded delta or run.
+
+// Header of the calibration record. The encoded planes follow it.
+typedef struct
+{
+    uint8_t  version;
+    uint8_t  cols;
+    uint8_t  rows;
+    uint8_t  reserved;
+    uint16_t length;    // Length of the encoded planes, in bytes.
+    uint16_t crc;       // CRC16 of the encoded planes.
+} calib_record_header_t;
+
+#define CALIB_RECORD_BYTES_MAX  (sizeof(calib_record_header_t) + \
+                                 (CALIB_PLANES * TOUCH_CALIB_CELLS * CALIB_TOKEN_MAX_BYTES))
+#define CALIB_RECORD_WORDS_MAX  BYTES_TO_WORDS(CALIB_RECORD_BYTES_MAX)
+
+
+static uint16_t             m_baseline[TOUCH_CALIB_CELLS];  // Baselines, in 1/16 counts.
+static uint16_t             m_noise[TOUCH_CALIB_CELLS];     // Mean absolute deviations, in 1/16 counts.
+static uint8_t              m_gain[TOUCH_CALIB_CELLS];      // Gains, in 1/64.
+static uint16_t             m_saved[TOUCH_CALIB_CELLS];     // Baselines in the record, in counts.
+static uint32_t             m_record[CALIB_RECORD_WORDS_MAX]; // Kept until the record is written.
+static fds_record_desc_t    m_desc;                 // Descriptor of the record, if there is one.
+static bool                 m_have_record;          // Whether m_desc is valid.
+static bool                 m_load_done;            // Whether a load has been attempted.
+static bool                 m_save_pending;         // Whether a write of m_record is in progress.
+static bool                 m_save_due;             // Whether the record must be written, regardless of drift.
+static bool                 m_prev_touched;         // Whether the previous frame had a touch.
+static uint16_t             m_learned;              // Frames learned after a cold start.
+static uint16_t             m_stale_cells;          // Cells above threshold in the first frame after a load.
+static uint32_t             m_frames_since_save;    // Frames since the last write was started.
+static touch_calib_stats_t  m_stats;
+
+
+// Starts learning the calibration from the next frame.
+static void cold_start(void)
+{
+    m_stats.state      = TOUCH_CALIB_STATE_COLD;
+    m_learned          = 0;
+    m_save_due         = true;
+    m_frames_since_save = TOUCH_CALIB_SAVE_INTERVAL_FRAMES;
+}
+
+
+static uint32_t abs_diff(uint32_t a, uint32_t b)
+{
+    return (a > b) ? (a - b) : (b - a);
+}
+
+
+// Rounds a value in 1/16 counts to counts.
+static uint16_t q_to_counts(uint32_t value)
+{
+    return (uint16_t)((value + (1 << (CALIB_Q - 1))) >> CALIB_Q);
+}
+
+
+static uint8_t * token_put(uint8_t * p_out, uint32_t token)
+{
+    while (token >= 0x80)
+    {
+        *p_out++ = (uint8_t)(token | 0x80);
+        token  >>= 7;
+    }
+    *p_out++ = (uint8_t)token;
+
+    return p_out;
+}
+
+
+// Encodes a plane as deltas between consecutive cells. A token is a zigzag-coded delta shifted
+// left by one, or the length of a run of zero deltas minus one, shifted left by one and with
+// bit 0 set. Tokens are stored as little-endian base 128 numbers.
+static uint8_t * plane_encode(uint8_t * p_out, uint16_t const * p_values)
+{
+    uint16_t prev = 0;
+    uint16_t i    = 0;
+
+    while (i < TOUCH_CALIB_CELLS)
+    {
+        int32_t const delta = (int32_t)p_values[i] - prev;
+
+        if (delta == 0)
+        {
+            uint16_t run = 1;
+
+            while (((i + run) < TOUCH_CALIB_CELLS) && (p_values[i + run] == prev))
+            {
+                run++;
+            }
+            p_out = token_put(p_out, ((uint32_t)(run - 1) << 1) | 1);
+            i    += run;
+        }
+        else
+        {
+            uint32_t const zigzag = (delta < 0) ? ((uint32_t)(-delta) << 1) - 1 : (uint32_t)delta << 1;
+
+            p_out = token_put(p_out, zigzag << 1);
+            prev  = p_values[i++];
+        }
+    }
+
+    return p_out;
+}
+
+
+// Decodes a plane encoded by plane_encode(). Returns NULL if the data is invalid.
+static uint8_t const * plane_decode(uint8_t const * p_in,
+                                    uint8_t const * p_end,
+                                    uint16_t      * p_values,
+                                    uint16_t        max_value)
+{
+    int32_t  value = 0;
+    uint16_t i     = 0;
+
+    while (i < TOUCH_CALIB_CELLS)
+    {
+        uint32_t token = 0;
+
+        for (uint32_t shift = 0; ; shift += 7)
+        {
+            if ((p_in == p_end) || (shift >= (7 * CALIB_TOKEN_MAX_BYTES)))
+            {
+                return NULL;
+            }
+            token |= (uint32_t)(*p_in & 0x7F) << shift;
+            if ((*p_in++ & 0x80) == 0)
+            {
+                break;
+            }
+        }
+
+        if (token & 1)
+        {
+            uint32_t const run = (token >> 1) + 1;
+
+            if (run > (uint32_t)(TOUCH_CALIB_CELLS - i))
+            {
+                return NULL;
+            }
+            for (uint32_t j = 0; j < run; j++)
+            {
+                p_values[i++] = (uint16_t)value;
+            }
+        }
+        else
+        {
+            uint32_t const zigzag = token >> 1;
+
+            value += (zigzag & 1) ? -(int32_t)((zigzag + 1) >> 1) : (int32_t)(zigzag >> 1);
+            if ((value < 0) || (value > max_value))
+            {
+                return NULL;
+            }
+            p_values[i++] = (uint16_t)value;
+        }
+    }
+
+    return p_in;
+}
+
+
+// Encodes the calibration into m_record. Returns the length of the record in bytes.
+static uint16_t record_encode(void)
+{
+    static uint16_t         plane[TOUCH_CALIB_CELLS];
+    calib_record_header_t * p_header = (calib_record_header_t *)m_record;
+    uint8_t         * const p_start  = (uint8_t *)m_record + sizeof(calib_record_header_t);
+    uint8_t               * p_out    = p_start;
+
+    for (uint16_t i = 0; i < TOUCH_CALIB_CELLS; i++)
+    {
+        m_saved[i] = q_to_counts(m_baseline[i]);
+    }
+    p_out = plane_encode(p_out, m_saved);
+
+    for (uint16_t i = 0; i < TOUCH_CALIB_CELLS; i++)
+    {
+        plane[i] = m_gain[i];
+    }
+    p_out = plane_encode(p_out, plane);
+
+    // The noise is stored in 1/4 counts, which is finer than its own variation.
+    for (uint16_t i = 0; i < TOUCH_CALIB_CELLS; i++)
+    {
+        plane[i] = MIN(UINT8_MAX, (m_noise[i] + 2) >> (CALIB_Q - 2));
+    }
+    p_out = plane_encode(p_out, plane);
+
+    p_header->version  = CALIB_RECORD_VERSION;
+    p_header->cols     = TOUCH_CALIB_COLS;
+    p_header->rows     = TOUCH_CALIB_ROWS;
+    p_header->reserved = 0;
+    p_header->length   = (uint16_t)(p_out - p_start);
+    p_header->crc      = crc16_compute(p_start, p_header->length, NULL);
+
+    // Pad the record to a whole word.
+    while (!is_word_aligned(p_out))
+    {
+        *p_out++ = 0;
+    }
+
+    return (uint16_t)(p_out - (uint8_t *)m_record);
+}
+
+
+// Decodes a record. The calibration is only changed if the whole record is valid.
+static bool record_decode(void const * p_data, uint32_t length)
+{
+    static uint16_t baseline[TOUCH_CALIB_CELLS];
+    static uint16_t gain[TOUCH_CALIB_CELLS];
+    static uint16_t noise[TOUCH_CALIB_CELLS];
+
+    calib_record_header_t const * p_header = (calib_record_header_t const *)p_data;
+    uint8_t               const * p_in     = (uint8_t const *)p_data + sizeof(calib_record_header_t);
+    uint8_t               const * p_end;
+
+    if ((length < sizeof(calib_record_header_t))                        ||
+        (p_header->version != CALIB_RECORD_VERSION)                     ||
+        (p_header->cols    != TOUCH_CALIB_COLS)                         ||
+        (p_header->rows    != TOUCH_CALIB_ROWS)                         ||
+        (p_header->length  >  (length - sizeof(calib_record_header_t))) ||
+        (p_header->crc     != crc16_compute(p_in, p_header->length, NULL)))
+    {
+        return false;
+    }
+
+    p_end = p_in + p_header->length;
+    p_in  = plane_decode(p_in, p_end, baseline, CALIB_RAW_MAX);
+    if (p_in != NULL)
+    {
+        p_in = plane_decode(p_in, p_end, gain, UINT8_MAX);
+    }
+    if (p_in != NULL)
+    {
+        p_in = plane_decode(p_in, p_end, noise, UINT8_MAX);
+    }
+    if (p_in != p_end)
+    {
+        return false;
+    }
+
+    for (uint16_t i = 0; i < TOUCH_CALIB_CELLS; i++)
+    {
+        m_saved[i]    = baseline[i];
+        m_baseline[i] = baseline[i] << CALIB_Q;
+        m_gain[i]     = (uint8_t)gain[i];
+        m_noise[i]    = noise[i] << (CALIB_Q - 2);
+    }
+
+    return true;
+}
+
+
+static void record_load(void)
+{
+    fds_find_token_t   token;
+    fds_flash_record_t record;
+
+    memset(&token, 0x00, sizeof(token));
+
+    if (fds_record_find(TOUCH_CALIB_FILE_ID, TOUCH_CALIB_RECORD_KEY, &m_desc, &token) != FDS_SUCCESS)
+    {
+        return;
+    }
+    m_have_record = true;
+
+    if (fds_record_open(&m_desc, &record) != FDS_SUCCESS)
+    {
+        return;
+    }
+
+    if (record_decode(record.p_data, record.p_header->tl.length_words * sizeof(uint32_t)))
+    {
+        m_stats.state       = TOUCH_CALIB_STATE_LOADED;
+        m_stats.loaded      = true;
+        m_stale_cells       = 0;
+        m_save_due          = false;
+        m_frames_since_save = 0;
+    }
+
+    (void)fds_record_close(&m_desc);
+}
+
+
+static void record_save(void)
+{
+    ret_code_t         ret;
+    fds_record_chunk_t chunk;
+    fds_record_t       record;
+
+    m_stats.record_bytes = record_encode();
+
+    chunk.p_data           = m_record;
+    chunk.length_words     = BYTES_TO_WORDS(m_stats.record_bytes);
+    record.file_id         = TOUCH_CALIB_FILE_ID;
+    record.key             = TOUCH_CALIB_RECORD_KEY;
+    record.data.p_chunks   = &chunk;
+    record.data.num_chunks = 1;
+
+    if (m_have_record)
+    {
+        ret = fds_record_update(&m_desc, &record);
+    }
+    else
+    {
+        ret = fds_record_write(&m_desc, &record);
+    }
+
+    m_frames_since_save = 0;
+
+    if (ret == FDS_SUCCESS)
+    {
+        m_have_record  = true;
+        m_save_pending = true;
+        m_save_due     = false;
+        m_stats.saves++;
+        return;
+    }
+
+    // Try again at the next check after the save interval.
+    m_save_due = true;
+    m_stats.save_failures++;
+    if (ret == FDS_ERR_NO_SPACE_IN_FLASH)
+    {
+        (void)fds_gc();
+    }
+}
+
+
+// Checks whether a baseline has drifted from the stored calibration.
+static bool drift_check(void)
+{
+    for (uint16_t i = 0; i < TOUCH_CALIB_CELLS; i++)
+    {
+        if (abs_diff(q_to_counts(m_baseline[i]), m_saved[i]) >= TOUCH_CALIB_DRIFT_COUNTS)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+static void fds_evt_handler(fds_evt_t const * const p_evt)
+{
+    switch (p_evt->id)
+    {
+        case FDS_EVT_INIT:
+            if ((p_evt->result == FDS_SUCCESS) && !m_load_done)
+            {
+                m_load_done = true;
+                record_load();
+            }
+            break;
+
+        case FDS_EVT_WRITE:
+        case FDS_EVT_UPDATE:
+            if ((p_evt->write.file_id == TOUCH_CALIB_FILE_ID) &&
+                (p_evt->write.record_key == TOUCH_CALIB_RECORD_KEY))
+            {
+                m_save_pending = false;
+                if (p_evt->result != FDS_SUCCESS)
+                {
+                    m_save_due = true;
+                    m_stats.save_failures++;
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+ret_code_t touch_calib_init(uint16_t default_baseline)
+{
+    ret_code_t ret;
+
+    for (uint16_t i = 0; i < TOUCH_CALIB_CELLS; i++)
+    {
+        m_baseline[i] = default_baseline << CALIB_Q;
+        m_noise[i]    = 0;
+        m_gain[i]     = TOUCH_CALIB_GAIN_ONE;
+        m_saved[i]    = default_baseline;
+    }
+
+    memset(&m_stats, 0x00, sizeof(m_stats));
+    m_stats.valid_frame = UINT32_MAX;
+    m_have_record       = false;
+    m_load_done         = false;
+    m_save_pending      = false;
+    m_prev_touched      = false;
+    cold_start();
+
+    ret = fds_register(fds_evt_handler);
+    if (ret != FDS_SUCCESS)
+    {
+        return ret;
+    }
+
+    // If FDS is already initialized, the record is loaded before this function returns.
+    return fds_init();
+}
+
+
+uint16_t touch_calib_apply(uint8_t col, uint8_t row, int16_t raw)
+{
+    uint16_t const i       = (col * TOUCH_CALIB_ROWS) + row;
+    uint32_t const value   = (uint32_t)MIN(MAX(raw, 0), CALIB_RAW_MAX) << CALIB_Q;
+    uint32_t const dev     = abs_diff(value, m_baseline[i]);
+    uint32_t const margin  = MAX(TOUCH_CALIB_NOISE_MARGIN * m_noise[i], CALIB_MIN_MARGIN);
+    uint32_t       result;
+
+    if (m_stats.state == TOUCH_CALIB_STATE_COLD)
+    {
+        // Running means over the frames learned so far. Once there is a first estimate,
+        // readings above threshold are taken as touches and not learned.
+        if (m_learned == 0)
+        {
+            m_baseline[i] = (uint16_t)value;
+            m_noise[i]    = 0;
+        }
+        else if ((m_learned < CALIB_COLD_REJECT_FRAMES) || (value <= (m_baseline[i] + margin)))
+        {
+            m_baseline[i] = (uint16_t)((int32_t)m_baseline[i] +
+                                       ((int32_t)value - m_baseline[i]) / (m_learned + 1));
+            m_noise[i]    = (uint16_t)((int32_t)m_noise[i] +
+                                       ((int32_t)dev - m_noise[i]) / (m_learned + 1));
+        }
+        return 0;
+    }
+
+    if (value <= (m_baseline[i] + margin))
+    {
+        // Track drift in cells at noise level, unless a touch may still be fading out.
+        if (!m_prev_touched)
+        {
+            m_baseline[i] = (uint16_t)((int32_t)m_baseline[i] +
+                                       (((int32_t)value - m_baseline[i]) >> CALIB_TRACK_SHIFT));
+            m_noise[i]    = (uint16_t)((int32_t)m_noise[i] +
+                                       (((int32_t)dev - m_noise[i]) >> CALIB_TRACK_SHIFT));
+        }
+        return 0;
+    }
+
+    if (m_stats.state == TOUCH_CALIB_STATE_LOADED)
+    {
+        m_stale_cells++;
+    }
+
+    result = ((value - m_baseline[i] - margin) * m_gain[i]) >> (CALIB_Q + 6);
+
+    return (uint16_t)MIN(result, UINT16_MAX);
+}
+
+
+void touch_calib_frame_end(bool touched)
+{
+    m_stats.frames++;
+    m_prev_touched = touched;
+
+    switch (m_stats.state)
+    {
+        case TOUCH_CALIB_STATE_COLD:
+            if (++m_learned < TOUCH_CALIB_WARMUP_FRAMES)
+            {
+                return;
+            }
+            break;
+
+        case TOUCH_CALIB_STATE_LOADED:
+            // A loaded calibration which sees most of the grid as touched belongs to another
+            // sensor or temperature. Learn it again.
+            if (m_stale_cells > CALIB_STALE_CELLS)
+            {
+                cold_start();
+                return;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    if (m_stats.state != TOUCH_CALIB_STATE_VALID)
+    {
+        m_stats.state       = TOUCH_CALIB_STATE_VALID;
+        m_stats.valid_frame = m_stats.frames;
+    }
+
+    if (m_frames_since_save < TOUCH_CALIB_SAVE_INTERVAL_FRAMES)
+    {
+        m_frames_since_save++;
+    }
+
+    if (m_save_pending                                                 ||
+        (m_frames_since_save < TOUCH_CALIB_SAVE_INTERVAL_FRAMES)       ||
+        ((m_stats.frames % TOUCH_CALIB_CHECK_INTERVAL_FRAMES) != 0)    ||
+        !(m_save_due || drift_check()))
+    {
+        return;
+    }
+
+    record_save();
+}
+
+
+bool touch_calib_is_valid(void)
+{
+    return (m_stats.state != TOUCH_CALIB_STATE_COLD);
+}
+
+
+void touch_calib_gain_set(uint8_t col, uint8_t row, uint8_t gain)
+{
+    m_gain[(col * TOUCH_CALIB_ROWS) + row] = gain;
+    m_save_due = true;
+}
+
+
+void touch_calib_stats_get(touch_calib_stats_t * p_stats)
+{
+    *p_stats = m_stats;
+}
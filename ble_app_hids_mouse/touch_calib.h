@@ -0,0 +1,170 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#ifndef TOUCH_CALIB_H__
+#define TOUCH_CALIB_H__
+
+/**
+ * @defgroup touch_calib Touch sensor calibration
+ * @{
+ * @ingroup ble_sdk_app_hids_mouse
+ *
+ * @brief   Per-cell calibration of the sensor grid, persisted in flash through FDS.
+ *
+ * @details Each cell has a baseline (its reading without touch), a gain and a noise level.
+ *          A calibrated reading is the raw reading minus the baseline and a noise margin,
+ *          scaled by the gain.
+ *
+ *          The baseline and noise of each cell are learned from frames without touch. After a
+ *          cold start the module needs @ref TOUCH_CALIB_WARMUP_FRAMES such frames before its
+ *          output is valid. The calibration is stored in an FDS record once it has been learned.
+ *          At the next boot, it is loaded and the output is valid from the first frame.
+ *
+ *          Baselines are tracked slowly while the device runs, to follow temperature drift. The
+ *          record is rewritten when a baseline has drifted by @ref TOUCH_CALIB_DRIFT_COUNTS from
+ *          the stored value, at most once every @ref TOUCH_CALIB_SAVE_INTERVAL_FRAMES frames.
+ *
+ *          The record holds the three planes delta-encoded in scan order. Neighbouring cells
+ *          have similar values, so most cells take one byte per plane, and runs of equal values
+ *          (like the default gain) take one or two bytes per run.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TOUCH_CALIB_COLS                    24              /**< Number of columns of the sensor grid. */
+#define TOUCH_CALIB_ROWS                    16              /**< Number of rows of the sensor grid. */
+#define TOUCH_CALIB_CELLS                   (TOUCH_CALIB_COLS * TOUCH_CALIB_ROWS)
+
+#define TOUCH_CALIB_FILE_ID                 0x7C00          /**< FDS file of the calibration record. */
+#define TOUCH_CALIB_RECORD_KEY              0x0001          /**< FDS key of the calibration record. */
+
+#define TOUCH_CALIB_GAIN_ONE                64              /**< Gain of 1.0. Gains are stored in units of 1/64. */
+#define TOUCH_CALIB_NOISE_MARGIN            4               /**< Readings up to this many times the noise level above the baseline are not touches. */
+
+#ifndef TOUCH_CALIB_WARMUP_FRAMES
+#define TOUCH_CALIB_WARMUP_FRAMES           32              /**< Frames without touch needed to learn the calibration after a cold start. */
+#endif
+
+#ifndef TOUCH_CALIB_DRIFT_COUNTS
+#define TOUCH_CALIB_DRIFT_COUNTS            8               /**< Baseline drift, in ADC counts, which makes the stored calibration stale. */
+#endif
+
+#ifndef TOUCH_CALIB_SAVE_INTERVAL_FRAMES
+#define TOUCH_CALIB_SAVE_INTERVAL_FRAMES    (50 * 60 * 10)  /**< Minimum number of frames between two writes of the record (10 minutes at 50 Hz). */
+#endif
+
+#ifndef TOUCH_CALIB_CHECK_INTERVAL_FRAMES
+#define TOUCH_CALIB_CHECK_INTERVAL_FRAMES   50              /**< Number of frames between two drift checks. */
+#endif
+
+
+/**@brief   Calibration state. */
+typedef enum
+{
+    TOUCH_CALIB_STATE_COLD,     //!< Learning the calibration. Calibrated readings are zero.
+    TOUCH_CALIB_STATE_LOADED,   //!< Loaded from flash, not yet checked against a frame.
+    TOUCH_CALIB_STATE_VALID,    //!< Calibrated readings are valid.
+} touch_calib_state_t;
+
+
+/**@brief   Calibration statistics. */
+typedef struct
+{
+    touch_calib_state_t state;          //!< Current state.
+    uint32_t            frames;         //!< Frames since @ref touch_calib_init.
+    uint32_t            valid_frame;    //!< Frame in which the output became valid, or UINT32_MAX.
+    uint16_t            record_bytes;   //!< Size of the last encoded record, including its header.
+    uint16_t            saves;          //!< Number of record writes started.
+    uint16_t            save_failures;  //!< Number of record writes which failed.
+    bool                loaded;         //!< Whether a calibration record was loaded at boot.
+} touch_calib_stats_t;
+
+
+/**@brief   Function for initializing the calibration and loading it from flash.
+ *
+ * @details Sets the default calibration: every baseline is @p default_baseline, every gain is
+ *          @ref TOUCH_CALIB_GAIN_ONE and the noise is zero. Then registers with FDS and
+ *          initializes it. The stored calibration is loaded as soon as FDS is initialized; until
+ *          then, the module learns the calibration like after a cold start.
+ *
+ * @param[in]   default_baseline    Baseline used until the calibration is learned, in ADC counts.
+ *
+ * @retval  NRF_SUCCESS     If the module was initialized.
+ * @return  An error code from @ref fds_register or @ref fds_init.
+ */
+ret_code_t touch_calib_init(uint16_t default_baseline);
+
+
+/**@brief   Function for calibrating the reading of a cell.
+ *
+ * @details Call this function for every cell of a frame, then call @ref touch_calib_frame_end.
+ *          While the calibration is being learned, the reading is used to learn it and the
+ *          function returns zero.
+ *
+ * @param[in]   col     Column of the cell.
+ * @param[in]   row     Row of the cell.
+ * @param[in]   raw     Filtered reading of the cell, in ADC counts.
+ *
+ * @return  The calibrated reading, or zero if it is at noise level or the calibration is not valid.
+ */
+uint16_t touch_calib_apply(uint8_t col, uint8_t row, int16_t raw);
+
+
+/**@brief   Function for ending a frame.
+ *
+ * @details Baselines are only tracked in frames which follow a frame without touch. Starts a
+ *          write of the calibration record when it is due.
+ *
+ * @param[in]   touched     Whether a touch was found in the frame.
+ */
+void touch_calib_frame_end(bool touched);
+
+
+/**@brief   Function for checking whether calibrated readings are valid.
+ *
+ * @retval  true    If readings from @ref touch_calib_apply can be used.
+ * @retval  false   If the calibration is still being learned.
+ */
+bool touch_calib_is_valid(void);
+
+
+/**@brief   Function for setting the gain of a cell, for example from a factory calibration.
+ *
+ * @details The gain is stored with the next write of the calibration record.
+ *
+ * @param[in]   col     Column of the cell.
+ * @param[in]   row     Row of the cell.
+ * @param[in]   gain    Gain, in units of 1/@ref TOUCH_CALIB_GAIN_ONE.
+ */
+void touch_calib_gain_set(uint8_t col, uint8_t row, uint8_t gain);
+
+
+/**@brief   Function for reading the calibration statistics.
+ *
+ * @param[out]  p_stats     Statistics.
+ */
+void touch_calib_stats_get(touch_calib_stats_t * p_stats);
+
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TOUCH_CALIB_H__
@@ -29,6 +29,10 @@
 #define IM_ADDR_CLEARTEXT_LENGTH        (3)
 #define IM_ADDR_CIPHERTEXT_LENGTH       (3)
 
+#ifndef PM_RA_CACHE_SIZE
+    #define PM_RA_CACHE_SIZE            (0)
+#endif
+
 // The number of registered event handlers.
 #define IM_EVENT_HANDLERS_CNT           (sizeof(m_evt_handlers) / sizeof(m_evt_handlers[0]))
 
@@ -53,6 +57,14 @@ typedef struct
     ble_gap_addr_t peer_address;
 } im_connection_t;
 
+#if (PM_RA_CACHE_SIZE > 0)
+typedef struct
+{
+    pm_peer_id_t   peer_id;                     // PM_PEER_ID_INVALID if the entry is unused.
+    uint8_t        addr[BLE_GAP_ADDR_LEN];      // A resolvable private address of the peer.
+} im_ra_cache_entry_t;
+#endif
+
 static bool                             m_module_initialized;
 static im_connection_t                  m_connections[8];
 static ble_conn_state_user_flag_id_t    m_conn_state_user_flag_id;
@@ -64,6 +76,12 @@ static pm_peer_id_t                     m_wlisted_peers[BLE_GAP_WHITELIST_ADDR_M
     static ble_gap_addr_t               m_current_id_addr;
 #endif
 
+#if (PM_RA_CACHE_SIZE > 0)
+// Resolvable private addresses resolved at connection, most recently used first.
+// Unused entries are at the end.
+static im_ra_cache_entry_t              m_ra_cache[PM_RA_CACHE_SIZE];
+#endif
+
 
 static void internal_state_reset()
 {
@@ -73,6 +91,13 @@ static void internal_state_reset()
     {
         m_connections[i].conn_handle = BLE_CONN_HANDLE_INVALID;
     }
+
+#if (PM_RA_CACHE_SIZE > 0)
+    for (uint32_t i = 0; i < PM_RA_CACHE_SIZE; i++)
+    {
+        m_ra_cache[i].peer_id = PM_PEER_ID_INVALID;
+    }
+#endif
 }
 
 
@@ -222,6 +247,108 @@ bool addr_compare(ble_gap_addr_t const * p_addr1, ble_gap_addr_t const * p_addr2
 }
 
 
+#if (PM_RA_CACHE_SIZE > 0)
+
+/**@brief Function for making an address the most recently used entry of the resolved address cache.
+ *
+ * @details The entries in front of @p index are moved back by one, overwriting the entry at
+ *          @p index.
+ *
+ * @param[in]  index    The entry to overwrite.
+ * @param[in]  peer_id  The peer which uses the address.
+ * @param[in]  p_addr   The address bytes.
+ */
+static void ra_cache_front_set(uint32_t index, pm_peer_id_t peer_id, uint8_t const * p_addr)
+{
+    memmove(&m_ra_cache[1], &m_ra_cache[0], index * sizeof(im_ra_cache_entry_t));
+
+    m_ra_cache[0].peer_id = peer_id;
+    memcpy(m_ra_cache[0].addr, p_addr, BLE_GAP_ADDR_LEN);
+}
+
+
+/**@brief Function for looking up a resolvable private address in the resolved address cache.
+ *
+ * @param[in]  p_addr  The address to look up.
+ *
+ * @return The peer whose IRK resolved the address, or PM_PEER_ID_INVALID if the address is not
+ *         in the cache.
+ */
+static pm_peer_id_t ra_cache_find(ble_gap_addr_t const * p_addr)
+{
+    for (uint32_t i = 0; i < PM_RA_CACHE_SIZE; i++)
+    {
+        pm_peer_id_t peer_id = m_ra_cache[i].peer_id;
+
+        if (peer_id == PM_PEER_ID_INVALID)
+        {
+            break;
+        }
+
+        if (memcmp(m_ra_cache[i].addr, p_addr->addr, BLE_GAP_ADDR_LEN) == 0)
+        {
+            ra_cache_front_set(i, peer_id, p_addr->addr);
+            return peer_id;
+        }
+    }
+
+    return PM_PEER_ID_INVALID;
+}
+
+
+/**@brief Function for adding an address to the resolved address cache.
+ *
+ * @details A peer which rotates its resolvable private address does not go back to an old one,
+ *          so the new address replaces the entry of the same peer, if there is one. Otherwise, it
+ *          replaces the least recently used entry.
+ *
+ * @param[in]  p_addr   The address, which was resolved with the IRK of @p peer_id.
+ * @param[in]  peer_id  The peer.
+ */
+static void ra_cache_insert(ble_gap_addr_t const * p_addr, pm_peer_id_t peer_id)
+{
+    uint32_t i;
+
+    for (i = 0; i < PM_RA_CACHE_SIZE - 1; i++)
+    {
+        if (   (m_ra_cache[i].peer_id == peer_id)
+            || (m_ra_cache[i].peer_id == PM_PEER_ID_INVALID))
+        {
+            break;
+        }
+    }
+
+    ra_cache_front_set(i, peer_id, p_addr->addr);
+}
+
+
+/**@brief Function for removing the addresses of a peer from the resolved address cache.
+ *
+ * @details Called when the IRK of the peer may have changed, or the peer has been deleted.
+ *
+ * @param[in]  peer_id  The peer, or PM_PEER_ID_INVALID to empty the cache.
+ */
+static void ra_cache_invalidate(pm_peer_id_t peer_id)
+{
+    uint32_t kept = 0;
+
+    for (uint32_t i = 0; i < PM_RA_CACHE_SIZE; i++)
+    {
+        if ((peer_id != PM_PEER_ID_INVALID) && (m_ra_cache[i].peer_id != peer_id))
+        {
+            m_ra_cache[kept++] = m_ra_cache[i];
+        }
+    }
+
+    for (; kept < PM_RA_CACHE_SIZE; kept++)
+    {
+        m_ra_cache[kept].peer_id = PM_PEER_ID_INVALID;
+    }
+}
+
+#endif // (PM_RA_CACHE_SIZE > 0)
+
+
 void im_ble_evt_handler(ble_evt_t * ble_evt)
 {
     ble_gap_evt_t gap_evt;
@@ -271,12 +398,26 @@ void im_ble_evt_handler(ble_evt_t * ble_evt)
 
             case BLE_GAP_ADDR_TYPE_RANDOM_PRIVATE_RESOLVABLE:
             {
+#if (PM_RA_CACHE_SIZE > 0)
+                // Resolving the address takes one AES operation per bonded peer, until the
+                // matching IRK is found. Peers which reconnect before rotating their address are
+                // found in the cache instead.
+                bonded_matching_peer_id = ra_cache_find(&gap_evt.params.connected.peer_addr);
+                if (bonded_matching_peer_id != PM_PEER_ID_INVALID)
+                {
+                    break;
+                }
+#endif
+
                 while (pds_peer_data_iterate(PM_PEER_DATA_ID_BONDING, &peer_id, &peer_data))
                 {
                     if (im_address_resolve(&gap_evt.params.connected.peer_addr,
                                            &peer_data.p_bonding_data->peer_ble_id.id_info))
                     {
                         bonded_matching_peer_id = peer_id;
+#if (PM_RA_CACHE_SIZE > 0)
+                        ra_cache_insert(&gap_evt.params.connected.peer_addr, peer_id);
+#endif
                         break;
                     }
                 }
@@ -351,6 +492,29 @@ void im_pdb_evt_handler(pdb_evt_t const * p_event)
     NRF_PM_DEBUG_CHECK(m_module_initialized);
     NRF_PM_DEBUG_CHECK(p_event != NULL);
 
+#if (PM_RA_CACHE_SIZE > 0)
+    // The IRK of a peer is part of its bonding data. Forget the addresses which were resolved
+    // with the old IRK once new bonding data has been written, or the data has been erased.
+    switch (p_event->evt_id)
+    {
+        case PDB_EVT_WRITE_BUF_STORED:
+        case PDB_EVT_RAW_STORED:
+        case PDB_EVT_CLEARED:
+            if (p_event->data_id == PM_PEER_DATA_ID_BONDING)
+            {
+                ra_cache_invalidate(p_event->peer_id);
+            }
+            break;
+
+        case PDB_EVT_PEER_FREED:
+            ra_cache_invalidate(p_event->peer_id);
+            break;
+
+        default:
+            break;
+    }
+#endif
+
     if ((p_event->evt_id  != PDB_EVT_WRITE_BUF_STORED) ||
         (p_event->data_id != PM_PEER_DATA_ID_BONDING))
     {
@@ -576,6 +740,15 @@ ret_code_t im_peer_free(pm_peer_id_t peer_id)
     {
         peer_id_set(conn_handle, PM_PEER_ID_INVALID);
     }
+
+#if (PM_RA_CACHE_SIZE > 0)
+    if (ret == NRF_SUCCESS)
+    {
+        // Stop identifying the peer by its addresses while its data is being erased.
+        ra_cache_invalidate(peer_id);
+    }
+#endif
+
     return ret;
 }
 
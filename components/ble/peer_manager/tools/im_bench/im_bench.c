@@ -0,0 +1,522 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host benchmark of peer identification in the ID Manager.
+ *
+ * id_manager.c is built against stubs of the SoftDevice, the connection state module and the
+ * Peer Database. The stub of sd_ecb_block_encrypt() is a software AES-128, so resolvable private
+ * addresses are resolved for real, and counts the AES operations.
+ *
+ * A number of bonded peers, each with its own IRK, is stored in the stub Peer Database. Some of
+ * them (the active devices) reconnect in random order, and each rotates its resolvable private
+ * address after a number of its connections. Every connection is identified by
+ * im_ble_evt_handler(), and checked against the device which connected.
+ *
+ * The connection latency of the ID Manager is estimated from the number of AES operations and
+ * the number of bonding data records read per connection:
+ *
+ *     ECB_US       Time of one sd_ecb_block_encrypt() call, in microseconds.
+ *     ITERATE_US   Time of one pds_peer_data_iterate() step, in microseconds.
+ *
+ * Halfway through the run, one device is bonded again with a new IRK. Its old address must no
+ * longer be identified, and its new one must be.
+ *
+ * Command line: bonds=<n> devices=<n> connects=<n> rotate=<n>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sdk_common.h"
+#include "ble.h"
+#include "ble_gap.h"
+#include "nrf_soc.h"
+#include "ble_conn_state.h"
+#include "id_manager.h"
+#include "peer_database.h"
+#include "peer_data_storage.h"
+
+
+extern void im_pdb_evt_handler(pdb_evt_t const * p_event);
+
+#ifndef ECB_US
+#define ECB_US          (10)    // Assumed: ECB block encryption plus the SVC call.
+#endif
+
+#ifndef ITERATE_US
+#define ITERATE_US      (20)    // Assumed: finding and opening one bonding data record in FDS.
+#endif
+
+#define MAX_BONDS       (64)
+#define CONN_HANDLE     (0)
+
+
+static pm_peer_data_bonding_t   m_bonds[MAX_BONDS];     // Bonding data of the peers, by peer ID.
+static uint32_t                 m_bond_cnt;
+static uint32_t                 m_iterate_index;
+
+static uint32_t                 m_aes_cnt;              // sd_ecb_block_encrypt() calls.
+static uint32_t                 m_iterate_cnt;          // pds_peer_data_iterate() steps.
+static bool                     m_connected;
+static pm_peer_id_t             m_identified_peer;
+
+static uint32_t                 m_rand = 1;
+
+
+static uint32_t rand_next(void)
+{
+    m_rand = m_rand * 1103515245 + 12345;
+    return m_rand >> 8;
+}
+
+
+/**@brief AES-128 block encryption, FIPS-197. */
+
+static const uint8_t m_sbox[256] =
+{
+    0x63, 0x7c, 0x77, 0x7b, 0xf2, 0x6b, 0x6f, 0xc5, 0x30, 0x01, 0x67, 0x2b, 0xfe, 0xd7, 0xab, 0x76,
+    0xca, 0x82, 0xc9, 0x7d, 0xfa, 0x59, 0x47, 0xf0, 0xad, 0xd4, 0xa2, 0xaf, 0x9c, 0xa4, 0x72, 0xc0,
+    0xb7, 0xfd, 0x93, 0x26, 0x36, 0x3f, 0xf7, 0xcc, 0x34, 0xa5, 0xe5, 0xf1, 0x71, 0xd8, 0x31, 0x15,
+    0x04, 0xc7, 0x23, 0xc3, 0x18, 0x96, 0x05, 0x9a, 0x07, 0x12, 0x80, 0xe2, 0xeb, 0x27, 0xb2, 0x75,
+    0x09, 0x83, 0x2c, 0x1a, 0x1b, 0x6e, 0x5a, 0xa0, 0x52, 0x3b, 0xd6, 0xb3, 0x29, 0xe3, 0x2f, 0x84,
+    0x53, 0xd1, 0x00, 0xed, 0x20, 0xfc, 0xb1, 0x5b, 0x6a, 0xcb, 0xbe, 0x39, 0x4a, 0x4c, 0x58, 0xcf,
+    0xd0, 0xef, 0xaa, 0xfb, 0x43, 0x4d, 0x33, 0x85, 0x45, 0xf9, 0x02, 0x7f, 0x50, 0x3c, 0x9f, 0xa8,
+    0x51, 0xa3, 0x40, 0x8f, 0x92, 0x9d, 0x38, 0xf5, 0xbc, 0xb6, 0xda, 0x21, 0x10, 0xff, 0xf3, 0xd2,
+    0xcd, 0x0c, 0x13, 0xec, 0x5f, 0x97, 0x44, 0x17, 0xc4, 0xa7, 0x7e, 0x3d, 0x64, 0x5d, 0x19, 0x73,
+    0x60, 0x81, 0x4f, 0xdc, 0x22, 0x2a, 0x90, 0x88, 0x46, 0xee, 0xb8, 0x14, 0xde, 0x5e, 0x0b, 0xdb,
+    0xe0, 0x32, 0x3a, 0x0a, 0x49, 0x06, 0x24, 0x5c, 0xc2, 0xd3, 0xac, 0x62, 0x91, 0x95, 0xe4, 0x79,
+    0xe7, 0xc8, 0x37, 0x6d, 0x8d, 0xd5, 0x4e, 0xa9, 0x6c, 0x56, 0xf4, 0xea, 0x65, 0x7a, 0xae, 0x08,
+    0xba, 0x78, 0x25, 0x2e, 0x1c, 0xa6, 0xb4, 0xc6, 0xe8, 0xdd, 0x74, 0x1f, 0x4b, 0xbd, 0x8b, 0x8a,
+    0x70, 0x3e, 0xb5, 0x66, 0x48, 0x03, 0xf6, 0x0e, 0x61, 0x35, 0x57, 0xb9, 0x86, 0xc1, 0x1d, 0x9e,
+    0xe1, 0xf8, 0x98, 0x11, 0x69, 0xd9, 0x8e, 0x94, 0x9b, 0x1e, 0x87, 0xe9, 0xce, 0x55, 0x28, 0xdf,
+    0x8c, 0xa1, 0x89, 0x0d, 0xbf, 0xe6, 0x42, 0x68, 0x41, 0x99, 0x2d, 0x0f, 0xb0, 0x54, 0xbb, 0x16,
+};
+
+
+static uint8_t xtime(uint8_t x)
+{
+    return (uint8_t)((x << 1) ^ ((x & 0x80) ? 0x1b : 0x00));
+}
+
+
+static void aes128_encrypt(uint8_t const * p_key, uint8_t const * p_in, uint8_t * p_out)
+{
+    uint8_t round_key[176];
+    uint8_t s[16];
+    uint8_t rcon = 0x01;
+
+    memcpy(round_key, p_key, 16);
+    for (uint32_t i = 16; i < sizeof(round_key); i += 4)
+    {
+        uint8_t t[4];
+
+        memcpy(t, &round_key[i - 4], 4);
+        if ((i % 16) == 0)
+        {
+            uint8_t t0 = t[0];
+            t[0] = m_sbox[t[1]] ^ rcon;
+            t[1] = m_sbox[t[2]];
+            t[2] = m_sbox[t[3]];
+            t[3] = m_sbox[t0];
+            rcon = xtime(rcon);
+        }
+        for (uint32_t j = 0; j < 4; j++)
+        {
+            round_key[i + j] = round_key[i + j - 16] ^ t[j];
+        }
+    }
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        s[i] = p_in[i] ^ round_key[i];
+    }
+
+    for (uint32_t round = 1; round <= 10; round++)
+    {
+        uint8_t t[16];
+
+        // SubBytes and ShiftRows. The state is stored column by column.
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            for (uint32_t r = 0; r < 4; r++)
+            {
+                t[4 * c + r] = m_sbox[s[4 * ((c + r) % 4) + r]];
+            }
+        }
+
+        // MixColumns, except in the last round.
+        for (uint32_t c = 0; c < 4; c++)
+        {
+            uint8_t * p_col = &t[4 * c];
+
+            if (round < 10)
+            {
+                uint8_t all = p_col[0] ^ p_col[1] ^ p_col[2] ^ p_col[3];
+                uint8_t c0  = p_col[0];
+
+                p_col[0] ^= all ^ xtime(p_col[0] ^ p_col[1]);
+                p_col[1] ^= all ^ xtime(p_col[1] ^ p_col[2]);
+                p_col[2] ^= all ^ xtime(p_col[2] ^ p_col[3]);
+                p_col[3] ^= all ^ xtime(p_col[3] ^ c0);
+            }
+        }
+
+        for (uint32_t i = 0; i < 16; i++)
+        {
+            s[i] = t[i] ^ round_key[16 * round + i];
+        }
+    }
+
+    memcpy(p_out, s, 16);
+}
+
+
+/**@brief The ah() function, without counting the AES operation. Like ah() in id_manager.c, the
+ *        key, the input and the output are little endian.
+ */
+static void bench_ah(uint8_t const * p_irk, uint8_t const * p_r, uint8_t * p_hash)
+{
+    uint8_t key[16];
+    uint8_t in[16] = {0};
+    uint8_t out[16];
+
+    for (uint32_t i = 0; i < 16; i++)
+    {
+        key[i] = p_irk[15 - i];
+    }
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        in[15 - i] = p_r[i];
+    }
+
+    aes128_encrypt(key, in, out);
+
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        p_hash[i] = out[15 - i];
+    }
+}
+
+
+/**@brief Stubs of the SoftDevice. */
+
+uint32_t sd_ecb_block_encrypt(nrf_ecb_hal_data_t * p_ecb_data)
+{
+    m_aes_cnt++;
+    aes128_encrypt(p_ecb_data->key, p_ecb_data->cleartext, p_ecb_data->ciphertext);
+    return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_addr_get(ble_gap_addr_t * p_addr)                        { return NRF_SUCCESS; }
+uint32_t sd_ble_gap_addr_set(ble_gap_addr_t const * p_addr)                  { return NRF_SUCCESS; }
+uint32_t sd_ble_gap_privacy_get(ble_gap_privacy_params_t * p_params)         { return NRF_SUCCESS; }
+uint32_t sd_ble_gap_privacy_set(ble_gap_privacy_params_t const * p_params)   { return NRF_SUCCESS; }
+uint32_t sd_ble_opt_get(uint32_t opt_id, ble_opt_t * p_opt)                  { return NRF_SUCCESS; }
+uint32_t sd_ble_opt_set(uint32_t opt_id, ble_opt_t const * p_opt)            { return NRF_SUCCESS; }
+
+uint32_t sd_ble_gap_whitelist_set(ble_gap_addr_t const * const * pp_wl_addrs, uint8_t len)
+{
+    return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_device_identities_set(ble_gap_id_key_t const * const * pp_id_keys,
+                                          ble_gap_irk_t    const * const * pp_local_irks,
+                                          uint8_t                          len)
+{
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Stubs of the connection state module. There is one connection at a time. */
+
+ble_conn_state_user_flag_id_t ble_conn_state_user_flag_acquire(void)
+{
+    return BLE_CONN_STATE_USER_FLAG0;
+}
+
+bool ble_conn_state_user_flag_get(uint16_t conn_handle, ble_conn_state_user_flag_id_t flag_id)
+{
+    return m_connected && (conn_handle == CONN_HANDLE);
+}
+
+void ble_conn_state_user_flag_set(uint16_t                      conn_handle,
+                                  ble_conn_state_user_flag_id_t flag_id,
+                                  bool                          value)
+{
+    m_connected = value;
+}
+
+
+/**@brief Stubs of the Peer Database. The bonding data of all peers is in m_bonds. */
+
+void pds_peer_data_iterate_prepare(void)
+{
+    m_iterate_index = 0;
+}
+
+bool pds_peer_data_iterate(pm_peer_data_id_t            data_id,
+                           pm_peer_id_t         * const p_peer_id,
+                           pm_peer_data_flash_t * const p_data)
+{
+    if ((data_id != PM_PEER_DATA_ID_BONDING) || (m_iterate_index >= m_bond_cnt))
+    {
+        return false;
+    }
+
+    m_iterate_cnt++;
+
+    *p_peer_id             = m_iterate_index;
+    p_data->data_id        = PM_PEER_DATA_ID_BONDING;
+    p_data->length_words   = PM_BONDING_DATA_N_WORDS();
+    p_data->p_bonding_data = &m_bonds[m_iterate_index];
+
+    m_iterate_index++;
+    return true;
+}
+
+ret_code_t pds_peer_data_read(pm_peer_id_t                    peer_id,
+                              pm_peer_data_id_t               data_id,
+                              pm_peer_data_t          * const p_data,
+                              uint32_t          const * const p_buf_len)
+{
+    return NRF_ERROR_NOT_FOUND;
+}
+
+ret_code_t pdb_peer_data_ptr_get(pm_peer_id_t                 peer_id,
+                                 pm_peer_data_id_t            data_id,
+                                 pm_peer_data_flash_t * const p_peer_data)
+{
+    if ((data_id != PM_PEER_DATA_ID_BONDING) || (peer_id >= m_bond_cnt))
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    p_peer_data->data_id        = PM_PEER_DATA_ID_BONDING;
+    p_peer_data->length_words   = PM_BONDING_DATA_N_WORDS();
+    p_peer_data->p_bonding_data = &m_bonds[peer_id];
+    return NRF_SUCCESS;
+}
+
+ret_code_t pdb_peer_free(pm_peer_id_t peer_id)
+{
+    return NRF_SUCCESS;
+}
+
+
+/**@brief Event handlers of the Peer Manager and the GATT Cache Manager. */
+
+void pm_im_evt_handler(im_evt_t const * p_event)
+{
+    if (p_event->evt_id == IM_EVT_BONDED_PEER_CONNECTED)
+    {
+        m_identified_peer = im_peer_id_get_by_conn_handle(p_event->conn_handle);
+    }
+}
+
+void gcm_im_evt_handler(im_evt_t const * p_event)
+{
+}
+
+
+/**@brief Function for making a new resolvable private address with an IRK. */
+static void rpa_make(uint8_t const * p_irk, ble_gap_addr_t * p_addr)
+{
+    uint32_t prand = rand_next();
+
+    p_addr->addr_type = BLE_GAP_ADDR_TYPE_RANDOM_PRIVATE_RESOLVABLE;
+    p_addr->addr[3]   = (uint8_t)prand;
+    p_addr->addr[4]   = (uint8_t)(prand >> 8);
+    p_addr->addr[5]   = (uint8_t)(((prand >> 16) & 0x3F) | 0x40);
+
+    bench_ah(p_irk, &p_addr->addr[3], p_addr->addr);
+}
+
+
+/**@brief Function for connecting with an address, and disconnecting.
+ *
+ * @return The peer identified by the ID Manager, or PM_PEER_ID_INVALID.
+ */
+static pm_peer_id_t connect(ble_gap_addr_t const * p_addr)
+{
+    ble_evt_t evt;
+
+    memset(&evt, 0, sizeof(evt));
+    evt.header.evt_id                         = BLE_GAP_EVT_CONNECTED;
+    evt.evt.gap_evt.conn_handle               = CONN_HANDLE;
+    evt.evt.gap_evt.params.connected.peer_addr = *p_addr;
+
+    m_identified_peer = PM_PEER_ID_INVALID;
+    im_ble_evt_handler(&evt);
+
+    m_connected = false;
+    return m_identified_peer;
+}
+
+
+/**@brief Function for bonding a peer again, with a new IRK. */
+static void rebond(pm_peer_id_t peer_id)
+{
+    pdb_evt_t evt;
+
+    for (uint32_t i = 0; i < BLE_GAP_SEC_KEY_LEN; i++)
+    {
+        m_bonds[peer_id].peer_ble_id.id_info.irk[i] = (uint8_t)rand_next();
+    }
+
+    memset(&evt, 0, sizeof(evt));
+    evt.evt_id  = PDB_EVT_WRITE_BUF_STORED;
+    evt.peer_id = peer_id;
+    evt.data_id = PM_PEER_DATA_ID_BONDING;
+    im_pdb_evt_handler(&evt);
+}
+
+
+/**@brief Function for checking ah() and the AES against the sample data of the Bluetooth core
+ *        specification 4.2, Vol 3, Part H, Appendix D.7.
+ */
+static bool ah_check(void)
+{
+    static const ble_gap_irk_t irk =
+    {
+        .irk = {0x9b, 0x7d, 0x39, 0x0a, 0xa6, 0x10, 0x10, 0x34,
+                0x05, 0xad, 0xc8, 0x57, 0xa3, 0x34, 0x02, 0xec},
+    };
+    static const ble_gap_addr_t addr =
+    {
+        .addr_type = BLE_GAP_ADDR_TYPE_RANDOM_PRIVATE_RESOLVABLE,
+        .addr      = {0xaa, 0xfb, 0x0d, 0x94, 0x81, 0x70},
+    };
+
+    return im_address_resolve(&addr, &irk);
+}
+
+
+int main(int argc, char ** argv)
+{
+    uint32_t bonds    = 8;
+    uint32_t devices  = 3;
+    uint32_t connects = 10000;
+    uint32_t rotate   = 8;
+    uint32_t errors   = 0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if      (sscanf(argv[i], "bonds=%u",    &bonds)    == 1) {}
+        else if (sscanf(argv[i], "devices=%u",  &devices)  == 1) {}
+        else if (sscanf(argv[i], "connects=%u", &connects) == 1) {}
+        else if (sscanf(argv[i], "rotate=%u",   &rotate)   == 1) {}
+        else
+        {
+            fprintf(stderr, "Usage: %s [bonds=<n>] [devices=<n>] [connects=<n>] [rotate=<n>]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    if ((bonds == 0) || (bonds > MAX_BONDS) || (devices == 0) || (devices > bonds) || (rotate == 0))
+    {
+        fprintf(stderr, "Need 0 < devices <= bonds <= %u and rotate > 0.\n", MAX_BONDS);
+        return 2;
+    }
+
+    if (im_init() != NRF_SUCCESS)
+    {
+        fprintf(stderr, "im_init failed.\n");
+        return 1;
+    }
+
+    if (!ah_check())
+    {
+        fprintf(stderr, "ah() does not match the sample data of the specification.\n");
+        return 1;
+    }
+
+    m_bond_cnt = bonds;
+    for (uint32_t i = 0; i < bonds; i++)
+    {
+        for (uint32_t j = 0; j < BLE_GAP_SEC_KEY_LEN; j++)
+        {
+            m_bonds[i].peer_ble_id.id_info.irk[j] = (uint8_t)rand_next();
+        }
+    }
+
+    // The active devices are spread over the bonds, so they are found at different depths.
+    pm_peer_id_t   device_peer[MAX_BONDS];
+    ble_gap_addr_t device_addr[MAX_BONDS];
+    uint32_t       device_uses[MAX_BONDS];
+
+    for (uint32_t i = 0; i < devices; i++)
+    {
+        device_peer[i] = (pm_peer_id_t)((i * bonds) / devices + (bonds / devices) / 2);
+        device_uses[i] = 0;
+        rpa_make(m_bonds[device_peer[i]].peer_ble_id.id_info.irk, &device_addr[i]);
+    }
+
+    uint32_t max_aes = 0;
+    clock_t  start   = clock();
+
+    m_aes_cnt     = 0;
+    m_iterate_cnt = 0;
+
+    for (uint32_t n = 0; n < connects; n++)
+    {
+        uint32_t d       = rand_next() % devices;
+        uint32_t aes_cnt = m_aes_cnt;
+
+        if (device_uses[d] == rotate)
+        {
+            rpa_make(m_bonds[device_peer[d]].peer_ble_id.id_info.irk, &device_addr[d]);
+            device_uses[d] = 0;
+        }
+        device_uses[d]++;
+
+        if (connect(&device_addr[d]) != device_peer[d])
+        {
+            errors++;
+        }
+
+        max_aes = MAX(max_aes, m_aes_cnt - aes_cnt);
+
+        if (n == connects / 2)
+        {
+            // The device is bonded again. Its old address resolves to no peer any more.
+            ble_gap_addr_t old_addr = device_addr[d];
+
+            rebond(device_peer[d]);
+            rpa_make(m_bonds[device_peer[d]].peer_ble_id.id_info.irk, &device_addr[d]);
+            device_uses[d] = 0;
+
+            if (connect(&old_addr) != PM_PEER_ID_INVALID)
+            {
+                fprintf(stderr, "The address of an old IRK was identified.\n");
+                errors++;
+            }
+        }
+    }
+
+    double elapsed = (double)(clock() - start) / CLOCKS_PER_SEC;
+    double aes     = (double)m_aes_cnt / connects;
+    double iterate = (double)m_iterate_cnt / connects;
+
+    printf("PM_RA_CACHE_SIZE %u, %u bonds, %u active devices, address rotated every %u "
+           "connections\n", PM_RA_CACHE_SIZE, bonds, devices, rotate);
+    printf("Connections:             %u\n", connects);
+    printf("AES per connection:      %.2f (max %u)\n", aes, max_aes);
+    printf("Records read per conn.:  %.2f\n", iterate);
+    printf("Estimated latency:       %.1f us (ECB %u us, record %u us)\n",
+           aes * ECB_US + iterate * ITERATE_US, ECB_US, ITERATE_US);
+    printf("Host time per conn.:     %.2f us\n", elapsed * 1e6 / connects);
+    printf("Identification errors:   %u\n", errors);
+
+    return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,25 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Configuration of the ID Manager benchmark. The values match ble_app_hids_mouse, and can be
+ * overridden from the make command line, for example: make run PM_RA_CACHE_SIZE=0 */
+
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+#define PEER_MANAGER_ENABLED 1
+
+#ifndef PM_RA_CACHE_SIZE
+#define PM_RA_CACHE_SIZE 4
+#endif
+
+#endif // SDK_CONFIG_H
@@ -41,7 +41,7 @@
 __STATIC_INLINE void * nrf_balloc_block_unwrap(nrf_balloc_t const * p_pool, void * p_head)
 {
     ASSERT((p_pool != NULL) && ((p_pool->block_size % sizeof(uint32_t)) == 0));
-    ASSERT((p_head != NULL) && (((uint32_t)(p_head) % sizeof(uint32_t)) == 0));
+    ASSERT((p_head != NULL) && (((uint32_t)(uintptr_t)(p_head) % sizeof(uint32_t)) == 0));
 
     uint32_t head_words  = NRF_BALLOC_DEBUG_HEAD_GUARD_WORDS_GET(p_pool->debug_flags);
     uint32_t tail_words  = NRF_BALLOC_DEBUG_TAIL_GUARD_WORDS_GET(p_pool->debug_flags);
@@ -56,7 +56,7 @@ __STATIC_INLINE void * nrf_balloc_block_unwrap(nrf_balloc_t const * p_pool, void
             if (*ptr != FREE_MEM_FILL)
             {
                 NRF_LOG_ERROR("Detected free memory corruption at %p (%p != %p, pool: %p)\r\n",
-                          (uint32_t)ptr, *ptr, FREE_MEM_FILL, (uint32_t)p_pool);
+                          (uint32_t)(uintptr_t)ptr, *ptr, FREE_MEM_FILL, (uint32_t)(uintptr_t)p_pool);
                 APP_ERROR_CHECK_BOOL(false);
             }
         }
@@ -85,7 +85,7 @@ __STATIC_INLINE void * nrf_balloc_block_unwrap(nrf_balloc_t const * p_pool, void
 __STATIC_INLINE void * nrf_balloc_element_wrap(nrf_balloc_t const * p_pool, void * p_element)
 {
     ASSERT((p_pool    != NULL) && ((p_pool->block_size % sizeof(uint32_t))    == 0));
-    ASSERT((p_element != NULL) && (((uint32_t)(p_element) % sizeof(uint32_t)) == 0));
+    ASSERT((p_element != NULL) && (((uint32_t)(uintptr_t)(p_element) % sizeof(uint32_t)) == 0));
 
     uint32_t head_words  = NRF_BALLOC_DEBUG_HEAD_GUARD_WORDS_GET(p_pool->debug_flags);
     uint32_t tail_words  = NRF_BALLOC_DEBUG_TAIL_GUARD_WORDS_GET(p_pool->debug_flags);
@@ -98,7 +98,7 @@ __STATIC_INLINE void * nrf_balloc_element_wrap(nrf_balloc_t const * p_pool, void
         if (*ptr != HEAD_GUARD_FILL)
         {
             NRF_LOG_ERROR("Detected Head Guard corruption at %p (%p != %p, pool: %p)\r\n",
-                      (uint32_t)ptr, *ptr, HEAD_GUARD_FILL, (uint32_t)p_pool);
+                      (uint32_t)(uintptr_t)ptr, *ptr, HEAD_GUARD_FILL, (uint32_t)(uintptr_t)p_pool);
             APP_ERROR_CHECK_BOOL(false);
         }
     }
@@ -108,7 +108,7 @@ __STATIC_INLINE void * nrf_balloc_element_wrap(nrf_balloc_t const * p_pool, void
         if (*ptr != TAIL_GUARD_FILL)
         {
             NRF_LOG_ERROR("Detected Tail Guard corruption at %p (%p != %p, pool: %p)\r\n",
-                      (uint32_t)ptr, *ptr, TAIL_GUARD_FILL, (uint32_t)p_pool);
+                      (uint32_t)(uintptr_t)ptr, *ptr, TAIL_GUARD_FILL, (uint32_t)(uintptr_t)p_pool);
             APP_ERROR_CHECK_BOOL(false);
         }
     }
@@ -126,6 +126,65 @@ __STATIC_INLINE void * nrf_balloc_element_wrap(nrf_balloc_t const * p_pool, void
 
 #endif // NRF_BALLOC_CONFIG_DEBUG_ENABLED
 
+#define FREE_HEAD_IDX_MASK  0x0000FFFFUL    /**< Part of the free list head that holds the block index.*/
+#define FREE_HEAD_TAG_INC   0x00010000UL    /**< Increment of the free list head ABA tag.*/
+
+/**@brief  Atomically replace a word if it holds the expected value.
+ *
+ * @param[in]   p_word      Pointer to the word.
+ * @param[in]   expected    Value that the word must hold.
+ * @param[in]   desired     New value of the word.
+ *
+ * @retval      true        The word held @p expected and was replaced.
+ * @retval      false       The word was changed by someone else.
+ */
+__STATIC_INLINE bool nrf_balloc_cas(volatile uint32_t * p_word, uint32_t expected, uint32_t desired)
+{
+#if (__CORTEX_M >= 0x03U)
+    do
+    {
+        if (__LDREXW(p_word) != expected)
+        {
+            __CLREX();
+            return false;
+        }
+    } while (__STREXW(desired, p_word) != 0);
+
+    return true;
+#else
+    bool swapped = false;
+
+    CRITICAL_REGION_ENTER();
+    if (*p_word == expected)
+    {
+        *p_word = desired;
+        swapped = true;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return swapped;
+#endif
+}
+
+/**@brief  Atomically add a value to a word.
+ *
+ * @param[in]   p_word      Pointer to the word.
+ * @param[in]   value       Value to add. Use a negated value to subtract.
+ *
+ * @return      Value of the word after the addition.
+ */
+static uint32_t nrf_balloc_add(volatile uint32_t * p_word, uint32_t value)
+{
+    uint32_t old_value;
+
+    do
+    {
+        old_value = *p_word;
+    } while (!nrf_balloc_cas(p_word, old_value, old_value + value));
+
+    return old_value + value;
+}
+
 /**@brief  Convert block index to a pointer.
  *
  * @param[in]   p_pool      Pointer to the memory pool.
@@ -133,7 +192,7 @@ __STATIC_INLINE void * nrf_balloc_element_wrap(nrf_balloc_t const * p_pool, void
  *
  * @return      Pointer to the beginning of the block.
  */
-static void * nrf_balloc_idx2block(nrf_balloc_t const * p_pool, uint8_t idx)
+static void * nrf_balloc_idx2block(nrf_balloc_t const * p_pool, uint16_t idx)
 {
     ASSERT(p_pool != NULL);
     return (uint8_t *)(p_pool->p_memory_begin) + ((size_t)(idx) * p_pool->block_size);
@@ -146,26 +205,118 @@ static void * nrf_balloc_idx2block(nrf_balloc_t const * p_pool, uint8_t idx)
  *
  * @return      Index of the block.
  */
-static uint8_t nrf_balloc_block2idx(nrf_balloc_t const * p_pool, void const * p_block)
+static uint16_t nrf_balloc_block2idx(nrf_balloc_t const * p_pool, void const * p_block)
 {
     ASSERT(p_pool != NULL);
     return ((size_t)(p_block) - (size_t)(p_pool->p_memory_begin)) / p_pool->block_size;
 }
 
+/**@brief  Take the first block off the free list.
+ *
+ * The link of the first block may be overwritten by another context that takes the same block
+ * and frees it again before this context swaps the head. The swap then fails, because the other
+ * context has changed the tag.
+ *
+ * @param[in]   p_pool      Pointer to the memory pool.
+ *
+ * @return      Index of the block or @ref NRF_BALLOC_IDX_NONE if the list is empty.
+ */
+static uint16_t nrf_balloc_list_pop(nrf_balloc_t const * p_pool)
+{
+    uint32_t head;
+    uint16_t idx;
+
+    do
+    {
+        head = p_pool->p_cb->free_head;
+        idx  = (uint16_t)(head & FREE_HEAD_IDX_MASK);
+        if (idx == NRF_BALLOC_IDX_NONE)
+        {
+            break;
+        }
+    } while (!nrf_balloc_cas(&p_pool->p_cb->free_head,
+                             head,
+                             ((head + FREE_HEAD_TAG_INC) & ~FREE_HEAD_IDX_MASK)
+                             | p_pool->p_free_links[idx]));
+
+    return idx;
+}
+
+/**@brief  Put a block at the front of the free list.
+ *
+ * @param[in]   p_pool      Pointer to the memory pool.
+ * @param[in]   idx         Index of the block.
+ */
+static void nrf_balloc_list_push(nrf_balloc_t const * p_pool, uint16_t idx)
+{
+    uint32_t head;
+
+    do
+    {
+        head = p_pool->p_cb->free_head;
+        p_pool->p_free_links[idx] = (uint16_t)(head & FREE_HEAD_IDX_MASK);
+    } while (!nrf_balloc_cas(&p_pool->p_cb->free_head,
+                             head,
+                             ((head + FREE_HEAD_TAG_INC) & ~FREE_HEAD_IDX_MASK) | idx));
+}
+
+#if NRF_BALLOC_CONFIG_CACHE_SIZE
+/**@brief  Get the cache of the current interrupt priority level.
+ *
+ * @param[in]   p_pool      Pointer to the memory pool.
+ *
+ * @return      Pointer to the cache.
+ */
+__STATIC_INLINE nrf_balloc_cache_t * nrf_balloc_cache_get(nrf_balloc_t const * p_pool)
+{
+    uint8_t level = current_int_priority_get();
+
+    // Thread Mode, and anything below the lowest application priority, uses the last cache.
+    return &p_pool->p_cb->cache[MIN(level, NRF_BALLOC_CACHE_LEVELS - 1)];
+}
+#endif // NRF_BALLOC_CONFIG_CACHE_SIZE
+
+#if NRF_BALLOC_CONFIG_DEBUG_ENABLED
+/**@brief  Mark a block as allocated or free in the allocation map.
+ *
+ * @param[in]   p_pool      Pointer to the memory pool.
+ * @param[in]   idx         Index of the block.
+ * @param[in]   allocated   New state of the block.
+ *
+ * @return      Previous state of the block.
+ */
+static bool nrf_balloc_map_update(nrf_balloc_t const * p_pool, uint16_t idx, bool allocated)
+{
+    volatile uint32_t * p_word = &p_pool->p_alloc_map[idx / 32];
+    uint32_t            mask   = 1UL << (idx % 32);
+    uint32_t            old_value;
+
+    do
+    {
+        old_value = *p_word;
+    } while (!nrf_balloc_cas(p_word,
+                             old_value,
+                             allocated ? (old_value | mask) : (old_value & ~mask)));
+
+    return (old_value & mask) != 0;
+}
+#endif // NRF_BALLOC_CONFIG_DEBUG_ENABLED
+
 ret_code_t nrf_balloc_init(nrf_balloc_t const * p_pool)
 {
     VERIFY_PARAM_NOT_NULL(p_pool);
 
     ASSERT(p_pool->p_cb);
-    ASSERT(p_pool->p_stack_base);
-    ASSERT(p_pool->p_stack_limit);
+    ASSERT(p_pool->p_free_links);
     ASSERT(p_pool->p_memory_begin);
+    ASSERT(p_pool->pool_size);
     ASSERT(p_pool->block_size);
 
     NRF_LOG_INFO("Init\r\n");
 
 #if NRF_BALLOC_CONFIG_DEBUG_ENABLED
     ASSERT(p_pool->p_memory_end);
+    ASSERT(p_pool->p_alloc_map);
 
     if (NRF_BALLOC_DEBUG_DATA_TRASHING_CHECK_GET(p_pool->debug_flags))
     {
@@ -174,16 +325,18 @@ ret_code_t nrf_balloc_init(nrf_balloc_t const * p_pool)
             *ptr = FREE_MEM_FILL;
         }
     }
+
+    memset((void *)p_pool->p_alloc_map, 0, CEIL_DIV(p_pool->pool_size, 32) * sizeof(uint32_t));
 #endif
 
-    p_pool->p_cb->p_stack_pointer = p_pool->p_stack_base;
-    uint8_t pool_size = p_pool->p_stack_limit - p_pool->p_stack_base;
-    while (pool_size--)
+    // Link the blocks in address order, so that the first allocation returns the first block.
+    for (uint16_t idx = 0; idx < p_pool->pool_size; idx++)
     {
-        *(p_pool->p_cb->p_stack_pointer)++ = pool_size;
+        p_pool->p_free_links[idx] = idx + 1;
     }
+    p_pool->p_free_links[p_pool->pool_size - 1] = NRF_BALLOC_IDX_NONE;
 
-    p_pool->p_cb->max_utilization = 0;
+    memset(p_pool->p_cb, 0, sizeof(nrf_balloc_cb_t));
 
     return NRF_SUCCESS;
 }
@@ -192,55 +345,64 @@ void * nrf_balloc_alloc(nrf_balloc_t const * p_pool)
 {
     ASSERT(p_pool != NULL);
 
-    void * p_block = NULL;
+    void   * p_block = NULL;
+    uint16_t idx;
 
-    CRITICAL_REGION_ENTER();
+#if NRF_BALLOC_CONFIG_CACHE_SIZE
+    nrf_balloc_cache_t * p_cache = nrf_balloc_cache_get(p_pool);
 
-    if (p_pool->p_cb->p_stack_pointer > p_pool->p_stack_base)
+    if (p_cache->count > 0)
+    {
+        idx = p_cache->idx[--p_cache->count];
+    }
+    else
+#endif
+    {
+        idx = nrf_balloc_list_pop(p_pool);
+    }
+
+    if (idx != NRF_BALLOC_IDX_NONE)
     {
         // Allocate block.
-        p_block = nrf_balloc_idx2block(p_pool, *--(p_pool->p_cb->p_stack_pointer));
+        p_block = nrf_balloc_idx2block(p_pool, idx);
 
         // Update utilization statistics.
-        uint8_t utilization = p_pool->p_stack_limit - p_pool->p_cb->p_stack_pointer;
-        if (p_pool->p_cb->max_utilization < utilization)
+        uint32_t utilization = nrf_balloc_add(&p_pool->p_cb->utilization, 1);
+        uint32_t max_utilization;
+        do
         {
-            p_pool->p_cb->max_utilization = utilization;
-        }
-    }
-
-    CRITICAL_REGION_EXIT();
+            max_utilization = p_pool->p_cb->max_utilization;
+        } while ((max_utilization < utilization) &&
+                 !nrf_balloc_cas(&p_pool->p_cb->max_utilization, max_utilization, utilization));
 
 #if NRF_BALLOC_CONFIG_DEBUG_ENABLED
-    if (p_block != NULL)
-    {
+        UNUSED_RETURN_VALUE(nrf_balloc_map_update(p_pool, idx, true));
         p_block = nrf_balloc_block_unwrap(p_pool, p_block);
-    }
 #endif
+    }
 
     NRF_LOG_DEBUG("nrf_balloc_alloc(p_pool: %p, p_element: %p)\r\n",
-                  (uint32_t)p_pool, (uint32_t)p_block);
+                  (uint32_t)(uintptr_t)p_pool, (uint32_t)(uintptr_t)p_block);
     return p_block;
 }
 
 void nrf_balloc_free(nrf_balloc_t const * p_pool, void * p_element)
 {
     ASSERT(p_pool != NULL);
-    ASSERT(p_element != NULL)
+    ASSERT(p_element != NULL);
     NRF_LOG_DEBUG("nrf_balloc_free(p_pool: %p, p_element: %p)\r\n",
-                  (uint32_t)p_pool, (uint32_t)p_element);
+                  (uint32_t)(uintptr_t)p_pool, (uint32_t)(uintptr_t)p_element);
 
 #if NRF_BALLOC_CONFIG_DEBUG_ENABLED
     void * p_block = nrf_balloc_element_wrap(p_pool, p_element);
 
-    // These checks could be done outside critical region as they use only pool configuration data.
     if (NRF_BALLOC_DEBUG_BASIC_CHECKS_GET(p_pool->debug_flags))
     {
         // Check if the element belongs to this pool.
         if ((p_block < p_pool->p_memory_begin) || (p_block >= p_pool->p_memory_end))
         {
             NRF_LOG_ERROR("Attempted to free element that does belong to the pool (pool: %p, element: %p)\r\n",
-                          (uint32_t)p_pool, (uint32_t)p_element);
+                          (uint32_t)(uintptr_t)p_pool, (uint32_t)(uintptr_t)p_element);
             APP_ERROR_CHECK_BOOL(false);
         }
 
@@ -248,48 +410,47 @@ void nrf_balloc_free(nrf_balloc_t const * p_pool, void * p_element)
         if ((((size_t)(p_block) - (size_t)(p_pool->p_memory_begin)) % p_pool->block_size) != 0)
         {
             NRF_LOG_ERROR("Atempted to free corrupted element address (pool: %p, element: %p)\r\n",
-                          (uint32_t)p_pool, (uint32_t)p_element);
+                          (uint32_t)(uintptr_t)p_pool, (uint32_t)(uintptr_t)p_element);
             APP_ERROR_CHECK_BOOL(false);
         }
-    }
-#else
-    void * p_block = p_element;
-#endif // NRF_BALLOC_CONFIG_DEBUG_ENABLED
-
-    CRITICAL_REGION_ENTER();
 
-#if NRF_BALLOC_CONFIG_DEBUG_ENABLED
-    // These checks have to be done in critical region as they use p_pool->p_stack_pointer.
-    if (NRF_BALLOC_DEBUG_BASIC_CHECKS_GET(p_pool->debug_flags))
-    {
         // Check for allocated/free ballance.
-        if (p_pool->p_cb->p_stack_pointer >= p_pool->p_stack_limit)
+        if (p_pool->p_cb->utilization == 0)
         {
             NRF_LOG_ERROR("Attempted to free an element while the pool is full (pool: %p, element: %p)\r\n",
-                          (uint32_t)p_pool, (uint32_t)p_element);
+                          (uint32_t)(uintptr_t)p_pool, (uint32_t)(uintptr_t)p_element);
             APP_ERROR_CHECK_BOOL(false);
         }
     }
 
-    if (NRF_BALLOC_DEBUG_DOUBLE_FREE_CHECK_GET(p_pool->debug_flags))
+    uint16_t idx = nrf_balloc_block2idx(p_pool, p_block);
+
+    // Clearing the allocation bit is atomic, so only one of two racing frees passes this check.
+    if (!nrf_balloc_map_update(p_pool, idx, false) &&
+        NRF_BALLOC_DEBUG_DOUBLE_FREE_CHECK_GET(p_pool->debug_flags))
     {
-        // Check for double free.
-        for (uint8_t * p_idx = p_pool->p_stack_base; p_idx < p_pool->p_cb->p_stack_pointer; p_idx++)
-        {
-            if (nrf_balloc_idx2block(p_pool, *p_idx) == p_block)
-            {
-                NRF_LOG_ERROR("Attempted to double-free an element (pool: %p, element: %p)\r\n",
-                              (uint32_t)p_pool, (uint32_t)p_element);
-                APP_ERROR_CHECK_BOOL(false);
-            }
-        }
+        NRF_LOG_ERROR("Attempted to double-free an element (pool: %p, element: %p)\r\n",
+                      (uint32_t)(uintptr_t)p_pool, (uint32_t)(uintptr_t)p_element);
+        APP_ERROR_CHECK_BOOL(false);
     }
+#else
+    uint16_t idx = nrf_balloc_block2idx(p_pool, p_element);
 #endif // NRF_BALLOC_CONFIG_DEBUG_ENABLED
 
+    UNUSED_RETURN_VALUE(nrf_balloc_add(&p_pool->p_cb->utilization, (uint32_t)-1));
+
     // Free the element.
-    *(p_pool->p_cb->p_stack_pointer)++ = nrf_balloc_block2idx(p_pool, p_block);
+#if NRF_BALLOC_CONFIG_CACHE_SIZE
+    nrf_balloc_cache_t * p_cache = nrf_balloc_cache_get(p_pool);
 
-    CRITICAL_REGION_EXIT();
+    if (p_cache->count < NRF_BALLOC_CONFIG_CACHE_SIZE)
+    {
+        p_cache->idx[p_cache->count++] = idx;
+        return;
+    }
+#endif
+
+    nrf_balloc_list_push(p_pool, idx);
 }
 
 #endif // NRF_MODULE_ENABLED(NRF_BALLOC)
@@ -15,6 +15,16 @@
   * @{
   * @ingroup app_common
   * @brief This module handles block memory allocator features.
+  *
+  * @details Free blocks are kept on a linked list of 16-bit block indexes. On cores with
+  *          exclusive access instructions (Cortex-M3 and newer), the head of the list is changed
+  *          with a compare-and-swap, so allocating and freeing never disables interrupts. On
+  *          Cortex-M0, the compare-and-swap is done in a critical region.
+  *
+  *          When @ref NRF_BALLOC_CONFIG_CACHE_SIZE is not 0, each interrupt priority level (and
+  *          Thread Mode) keeps up to that many freed blocks of every pool for itself, and
+  *          allocates from them first. Blocks held by one level's cache can't be allocated on
+  *          another level, so pools that use the cache should be sized with this in mind.
   */
 
 
@@ -28,6 +38,7 @@ extern "C" {
 #include "sdk_errors.h"
 #include "sdk_config.h"
 #include "app_util_platform.h"
+#include "nrf_assert.h"
 
 /**@defgroup NRF_BALLOC_DEBUG Macros for preparing debug flags for block allocator module.
  * @{ */
@@ -60,33 +71,67 @@ extern "C" {
     #define NRF_BALLOC_DEFAULT_DEBUG_FLAGS   0
 #endif // NRF_BALLOC_CONFIG_DEBUG_ENABLED
 
+/**@brief Free-list link value of the last free block. Also the index of an empty free list. */
+#define NRF_BALLOC_IDX_NONE     UINT16_MAX
+
+/**@brief Maximum number of blocks in a pool. */
+#define NRF_BALLOC_MAX_POOL_SIZE    (NRF_BALLOC_IDX_NONE - 1)
+
+#if NRF_BALLOC_CONFIG_CACHE_SIZE
+/**@brief Number of per-level caches. One for each interrupt priority level that the application
+ *        can use and one for Thread Mode.
+ */
+#define NRF_BALLOC_CACHE_LEVELS     (_PRIO_APP_LOWEST + 2)
+
+/**@brief Cache of free blocks that belongs to a single interrupt priority level.
+ *
+ * Contexts that run at the same priority level can't preempt each other, so the cache is used
+ * without any synchronization.
+ */
+typedef struct
+{
+    uint16_t count;                                 //!< Number of cached blocks.
+    uint16_t idx[NRF_BALLOC_CONFIG_CACHE_SIZE];     //!< Indexes of the cached blocks.
+} nrf_balloc_cache_t;
+#endif // NRF_BALLOC_CONFIG_CACHE_SIZE
+
 /**@brief Block memory allocator control block.*/
 typedef struct
 {
-    uint8_t * p_stack_pointer;          //!< Current allocation stack pointer.
-    uint8_t   max_utilization;          //!< Maximum utilization of the memory pool.
+    volatile uint32_t  free_head;       //!< Index of the first free block (low half-word) and ABA tag.
+                                        /**<
+                                         * The tag is incremented by every change of the free list,
+                                         * so a stale compare-and-swap of the head always fails.
+                                         */
+    volatile uint32_t  utilization;     //!< Number of allocated blocks.
+    volatile uint32_t  max_utilization; //!< Maximum utilization of the memory pool.
+#if NRF_BALLOC_CONFIG_CACHE_SIZE
+    nrf_balloc_cache_t cache[NRF_BALLOC_CACHE_LEVELS];  //!< Per-level caches of free blocks.
+#endif
 } nrf_balloc_cb_t;
 
 /**@brief Block memory allocator pool instance. The pool is made of elements of the same size. */
 typedef struct
 {
     nrf_balloc_cb_t * p_cb;             //!< Pointer to the instance control block.
-    uint8_t         * p_stack_base;     //!< Base of the allocation stack.
+    uint16_t        * p_free_links;     //!< Free list links, one for each block.
                                         /**<
-                                         * Stack is used to store handlers to not allocated elements.
+                                         * Entry n is the index of the free block that follows
+                                         * block n on the free list.
                                          */
-    uint8_t         * p_stack_limit;    //!< Maximum possible value of the allocation stack pointer.
     void            * p_memory_begin;   //!< Pointer to the start of the memory pool.
                                         /**<
                                          * Memory is used as a heap for blocks.
                                          */
 #if NRF_BALLOC_CONFIG_DEBUG_ENABLED
     void            * p_memory_end;     //!< Pointer to the end of the memory pool.
+    volatile uint32_t * p_alloc_map;    //!< Bit map of the allocated blocks.
     uint32_t          debug_flags;      //!< Debugging settings.
                                         /**<
                                          * Debug flag should be created by @ref NRF_BALLOC_DEBUG.
                                          */
 #endif // NRF_BALLOC_CONFIG_DEBUG_ENABLED
+    uint16_t          pool_size;        //!< Number of blocks in the pool.
     uint16_t          block_size;       //!< Size of the allocated block (including debug overhead).
                                         /**<
                                          * Single block contains user element with header and tail 
@@ -123,35 +168,37 @@ typedef struct
  */
 #if NRF_BALLOC_CONFIG_DEBUG_ENABLED
     #define NRF_BALLOC_DBG_DEF(_name, _element_size, _pool_size, _debug_flags)                      \
-        STATIC_ASSERT((_pool_size) <= UINT8_MAX);                                                   \
-        static uint8_t              _name##_nrf_balloc_pool_stack[(_pool_size)];                    \
+        STATIC_ASSERT((_pool_size) <= NRF_BALLOC_MAX_POOL_SIZE);                                    \
+        static uint16_t             _name##_nrf_balloc_pool_links[(_pool_size)];                    \
+        static uint32_t             _name##_nrf_balloc_pool_map[CEIL_DIV((_pool_size), 32)];        \
         static uint32_t             _name##_nrf_balloc_pool_mem                                     \
             [NRF_BALLOC_BLOCK_SIZE(_element_size, _debug_flags) * (_pool_size) / sizeof(uint32_t)]; \
         static nrf_balloc_cb_t      _name##_nrf_balloc_cb;                                          \
         static const nrf_balloc_t   _name =                                                         \
             {                                                                                       \
                 .p_cb           = &_name##_nrf_balloc_cb,                                           \
-                .p_stack_base   = _name##_nrf_balloc_pool_stack,                                    \
-                .p_stack_limit  = _name##_nrf_balloc_pool_stack + (_pool_size),                     \
+                .p_free_links   = _name##_nrf_balloc_pool_links,                                    \
                 .p_memory_begin = _name##_nrf_balloc_pool_mem,                                      \
+                .pool_size      = (_pool_size),                                                     \
                 .block_size     = NRF_BALLOC_BLOCK_SIZE(_element_size, _debug_flags),               \
                 .p_memory_end   = (uint8_t *)_name##_nrf_balloc_pool_mem                            \
                                 + NRF_BALLOC_BLOCK_SIZE(_element_size, _debug_flags) * (_pool_size),\
+                .p_alloc_map    = _name##_nrf_balloc_pool_map,                                      \
                 .debug_flags    = (_debug_flags),                                                   \
             }
 #else
     #define NRF_BALLOC_DBG_DEF(_name, _element_size, _pool_size, _debug_flags)                      \
-        STATIC_ASSERT((_pool_size) <= UINT8_MAX);                                                   \
-        static uint8_t              _name##_nrf_balloc_pool_stack[(_pool_size)];                    \
+        STATIC_ASSERT((_pool_size) <= NRF_BALLOC_MAX_POOL_SIZE);                                    \
+        static uint16_t             _name##_nrf_balloc_pool_links[(_pool_size)];                    \
         static uint32_t             _name##_nrf_balloc_pool_mem                                     \
             [NRF_BALLOC_BLOCK_SIZE(_element_size, _debug_flags) * (_pool_size) / sizeof(uint32_t)]; \
         static nrf_balloc_cb_t      _name##_nrf_balloc_cb;                                          \
         static const nrf_balloc_t   _name =                                                         \
             {                                                                                       \
                 .p_cb           = &_name##_nrf_balloc_cb,                                           \
-                .p_stack_base   = _name##_nrf_balloc_pool_stack,                                    \
-                .p_stack_limit  = _name##_nrf_balloc_pool_stack + (_pool_size),                     \
+                .p_free_links   = _name##_nrf_balloc_pool_links,                                    \
                 .p_memory_begin = _name##_nrf_balloc_pool_mem,                                      \
+                .pool_size      = (_pool_size),                                                     \
                 .block_size     = NRF_BALLOC_BLOCK_SIZE(_element_size, _debug_flags),               \
             }
 #endif // NRF_BALLOC_CONFIG_DEBUG_ENABLED
@@ -173,9 +220,9 @@ typedef struct
  * @param[in]   _name    Name of the allocator.
  */
 #define NRF_BALLOC_INTERFACE_DEC(_type, _name)    \
-    _type * _name##_alloc(void);                  \
-    void    _name##_free(_type * p_element);      \
-    uint8_t _name##_max_utilization_get(void)
+    _type *  _name##_alloc(void);                 \
+    void     _name##_free(_type * p_element);     \
+    uint16_t _name##_max_utilization_get(void)
 
 /**@brief Define a custom block allocator interface.
  *
@@ -201,7 +248,7 @@ typedef struct
         nrf_balloc_free((_p_pool), p_element);                                  \
     }                                                                           \
                                                                                 \
-    _attr uint8_t _name##_max_utilization_get(void)                             \
+    _attr uint16_t _name##_max_utilization_get(void)                            \
     {                                                                           \
         ASSERT((_p_pool) != NULL);                                              \
         return nrf_balloc_max_utilization_get((_p_pool));                       \
@@ -237,6 +284,8 @@ ret_code_t nrf_balloc_init(nrf_balloc_t const * p_pool);
  *
  * @note    This module guarantees that the returned memory is aligned to 4.
  *
+ * @note    This function can be called from any context, including interrupt handlers.
+ *
  * @param[in]   p_pool  Pointer to the memory pool from which the element will be allocated.
  *
  * @return      Allocated element or NULL if the specified pool is empty.
@@ -256,10 +305,22 @@ void nrf_balloc_free(nrf_balloc_t const * p_pool, void * p_element);
  *
  * @return Maximum number of elements allocated from the pool.
  */
-__STATIC_INLINE uint8_t nrf_balloc_max_utilization_get(nrf_balloc_t const * p_pool)
+__STATIC_INLINE uint16_t nrf_balloc_max_utilization_get(nrf_balloc_t const * p_pool)
+{
+    ASSERT(p_pool != NULL);
+    return (uint16_t)p_pool->p_cb->max_utilization;
+}
+
+/**@brief Function for getting current memory pool utilization.
+ *
+ * @param[in]   p_pool Pointer to the memory pool instance.
+ *
+ * @return Number of elements currently allocated from the pool.
+ */
+__STATIC_INLINE uint16_t nrf_balloc_utilization_get(nrf_balloc_t const * p_pool)
 {
     ASSERT(p_pool != NULL);
-    return p_pool->p_cb->max_utilization;
+    return (uint16_t)p_pool->p_cb->utilization;
 }
 
 #ifdef __cplusplus
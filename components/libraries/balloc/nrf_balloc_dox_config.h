@@ -71,6 +71,19 @@
 
 
 
+/** @brief Number of freed blocks of each pool kept for every interrupt priority level.
+ *
+ *  Set to 0 to disable the per-level caches.
+ *
+ *  Minimum value: 0
+ *  Maximum value: 16
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define NRF_BALLOC_CONFIG_CACHE_SIZE
+
+
+
 /** @brief Enables debug mode in the module.
  *
  *  Set to 1 to activate.
@@ -0,0 +1,303 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Block allocator stress test and benchmark for a PC host.
+ *
+ * The first part runs in one thread. It allocates the whole pool, checking that the blocks come
+ * in address order and that the pool then reports no free block, and checks the utilization
+ * statistics. With NRF_BALLOC_CONFIG_DEBUG_ENABLED it also checks that a double free, a write to
+ * a free block and a write past the end of an element are reported.
+ *
+ * The second part runs one thread per interrupt priority level. Each thread allocates a burst of
+ * 1 to 8 blocks, claims every block in an ownership table, fills it, and then checks the contents
+ * and frees the burst. A block that is handed out twice or written by another thread is
+ * reported. At the end every block must be on the free list or in a per-level cache. The time is
+ * per successful alloc/free pair, over all threads.
+ *
+ * Command line: threads=<1..8> ops=<bursts per thread>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include "sdk_common.h"
+#include "app_error.h"
+#include "nrf_balloc.h"
+
+
+#ifndef POOL_SIZE
+#define POOL_SIZE       (300)           // More than 255, so the indexes need 16 bits.
+#endif
+
+#define ELEMENT_SIZE    (20)
+#define BURST_MAX       (8)
+#define THREADS_MAX     (8)
+#define THREADS_DEFAULT (4)
+#define OPS_DEFAULT     (1000000)
+#define THREAD_MODE_LEVEL (_PRIO_APP_LOWEST + 1)  // Below every thread of the stress test.
+
+NRF_BALLOC_DEF(m_pool, ELEMENT_SIZE, POOL_SIZE);
+
+pthread_mutex_t       balloc_bench_critical_region = PTHREAD_MUTEX_INITIALIZER;
+__thread uint8_t      balloc_bench_level;
+__thread uint32_t     balloc_bench_exclusive;
+
+static volatile uint8_t m_owners[POOL_SIZE];    // Level + 1 of the thread that holds the block.
+static uint32_t         m_threads = THREADS_DEFAULT;
+static uint32_t         m_ops     = OPS_DEFAULT;
+static uint32_t         m_checks;
+static uint32_t         m_failures;             // Updated atomically by the threads.
+static uint32_t         m_app_errors;
+static uint64_t         m_pairs;                // Blocks allocated and freed, over all threads.
+
+
+void app_error_handler_bare(ret_code_t error_code)
+{
+    m_app_errors++;
+}
+
+
+void assert_nrf_callback(uint16_t line_num, const uint8_t * file_name)
+{
+    printf("FAILED: ASSERT at %s:%u\n", (char const *)file_name, line_num);
+    exit(1);
+}
+
+
+static void check(bool condition, char const * p_what)
+{
+    m_checks++;
+    if (!condition)
+    {
+        m_failures++;
+        printf("FAILED: %s\n", p_what);
+    }
+}
+
+
+static void thread_fail(char const * p_what, uint32_t idx)
+{
+    // Report only the first few failures; one race usually causes many.
+    if (__sync_fetch_and_add(&m_failures, 1) < 10)
+    {
+        printf("FAILED: level %u: %s, block %u\n", balloc_bench_level, p_what, idx);
+    }
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static uint32_t block_idx(void const * p_element)
+{
+    // With the debug checks, the element starts after the head guard, still inside its block.
+    return ((uint8_t const *)p_element - (uint8_t const *)m_pool.p_memory_begin) / m_pool.block_size;
+}
+
+
+static void pool_test(void)
+{
+    static uint8_t * blocks[POOL_SIZE];
+
+    check(nrf_balloc_init(&m_pool) == NRF_SUCCESS, "init");
+    for (uint32_t i = 0; i < POOL_SIZE; i++)
+    {
+        blocks[i] = nrf_balloc_alloc(&m_pool);
+        if ((blocks[i] == NULL) ||
+            ((i > 0) && (blocks[i] - blocks[i - 1] != m_pool.block_size)))
+        {
+            check(false, "blocks in address order");
+            return;
+        }
+    }
+    check(nrf_balloc_alloc(&m_pool) == NULL, "no block when the pool is used up");
+    check(nrf_balloc_utilization_get(&m_pool) == POOL_SIZE, "utilization of a full pool");
+    check(nrf_balloc_max_utilization_get(&m_pool) == POOL_SIZE, "max utilization of a full pool");
+
+    for (uint32_t i = 0; i < POOL_SIZE; i++)
+    {
+        nrf_balloc_free(&m_pool, blocks[i]);
+    }
+    check(nrf_balloc_utilization_get(&m_pool) == 0, "utilization of an empty pool");
+    check(nrf_balloc_max_utilization_get(&m_pool) == POOL_SIZE, "max utilization is kept");
+    check(m_app_errors == 0, "no error reported");
+
+#if NRF_BALLOC_CONFIG_DEBUG_ENABLED
+    // A bad free can fail several checks at once, so only look for at least one report.
+    uint8_t * p_element = nrf_balloc_alloc(&m_pool);
+    uint32_t  errors    = m_app_errors;
+
+    nrf_balloc_free(&m_pool, p_element);
+    nrf_balloc_free(&m_pool, p_element);
+    check(m_app_errors > errors, "double free reported");
+
+    check(nrf_balloc_init(&m_pool) == NRF_SUCCESS, "init after a double free");
+    p_element = nrf_balloc_alloc(&m_pool);
+    nrf_balloc_free(&m_pool, p_element);
+    p_element[0] = 0;
+    errors = m_app_errors;
+    check(nrf_balloc_alloc(&m_pool) == p_element, "freed block reused first");
+    check(m_app_errors > errors, "write to a free block reported");
+
+    errors = m_app_errors;
+    p_element[ELEMENT_SIZE] = 0;
+    nrf_balloc_free(&m_pool, p_element);
+    check(m_app_errors > errors, "write past the element reported");
+
+    m_app_errors = 0;
+#endif // NRF_BALLOC_CONFIG_DEBUG_ENABLED
+}
+
+
+static void * stress_thread(void * p_context)
+{
+    uint8_t * burst[BURST_MAX];
+    uint32_t  seed  = 12345u + (uint32_t)(uintptr_t)p_context;
+    uint64_t  pairs = 0;
+
+    balloc_bench_level = (uint8_t)(uintptr_t)p_context;
+
+    for (uint32_t op = 0; op < m_ops; op++)
+    {
+        uint32_t count = 0;
+
+        seed = (seed * 1103515245u) + 12345u;
+        for (uint32_t n = 1 + ((seed >> 16) % BURST_MAX); count < n; count++)
+        {
+            burst[count] = nrf_balloc_alloc(&m_pool);
+            if (burst[count] == NULL)
+            {
+                break;
+            }
+
+            uint32_t idx = block_idx(burst[count]);
+            if (!__sync_bool_compare_and_swap(&m_owners[idx], 0, balloc_bench_level + 1))
+            {
+                thread_fail("block handed out twice", idx);
+            }
+            memset(burst[count], (uint8_t)(op + balloc_bench_level), ELEMENT_SIZE);
+        }
+
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t idx = block_idx(burst[i]);
+            for (uint32_t j = 0; j < ELEMENT_SIZE; j++)
+            {
+                if (burst[i][j] != (uint8_t)(op + balloc_bench_level))
+                {
+                    thread_fail("block written by another thread", idx);
+                    break;
+                }
+            }
+            m_owners[idx] = 0;
+            nrf_balloc_free(&m_pool, burst[i]);
+        }
+        pairs += count;
+    }
+
+    (void)__sync_fetch_and_add(&m_pairs, pairs);
+    return NULL;
+}
+
+
+static void stress_test(void)
+{
+    static uint8_t * blocks[POOL_SIZE];
+    pthread_t        threads[THREADS_MAX];
+    uint32_t         cached = 0;
+    uint32_t         free   = 0;
+
+    check(nrf_balloc_init(&m_pool) == NRF_SUCCESS, "init");
+
+    uint64_t const start = host_time_ns();
+    for (uint32_t i = 0; i < m_threads; i++)
+    {
+        if (pthread_create(&threads[i], NULL, stress_thread, (void *)(uintptr_t)i) != 0)
+        {
+            fprintf(stderr, "pthread_create failed\n");
+            exit(2);
+        }
+    }
+    for (uint32_t i = 0; i < m_threads; i++)
+    {
+        (void)pthread_join(threads[i], NULL);
+    }
+    uint64_t const elapsed = host_time_ns() - start;
+
+    check(nrf_balloc_utilization_get(&m_pool) == 0, "utilization after the stress run");
+    check(m_app_errors == 0, "no error reported in the stress run");
+
+    uint16_t const max_utilization = nrf_balloc_max_utilization_get(&m_pool);
+
+    // Every block that is not waiting in the cache of a thread must be free in Thread Mode.
+    balloc_bench_level = THREAD_MODE_LEVEL;
+    while ((free < POOL_SIZE) && ((blocks[free] = nrf_balloc_alloc(&m_pool)) != NULL))
+    {
+        free++;
+    }
+#if NRF_BALLOC_CONFIG_CACHE_SIZE
+    for (uint32_t i = 0; i < m_threads; i++)
+    {
+        cached += m_pool.p_cb->cache[i].count;
+    }
+#endif
+    check(free + cached == POOL_SIZE, "every block free after the stress run");
+
+    printf("  %u threads: %5.1f ns per alloc/free pair, max utilization %u of %u\n",
+           m_threads, (double)elapsed / m_pairs,
+           max_utilization, POOL_SIZE);
+}
+
+
+int main(int argc, char * argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "threads=", 8) == 0)
+        {
+            m_threads = strtoul(argv[i] + 8, NULL, 0);
+        }
+        else if (strncmp(argv[i], "ops=", 4) == 0)
+        {
+            m_ops = strtoul(argv[i] + 4, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [threads=<1..%u>] [ops=<n>]\n", argv[0], THREADS_MAX);
+            return 2;
+        }
+    }
+    if ((m_threads == 0) || (m_threads > THREADS_MAX))
+    {
+        fprintf(stderr, "threads must be 1 to %u\n", THREADS_MAX);
+        return 2;
+    }
+
+    printf("%s, cache of %u blocks%s, %u blocks of %u bytes\n",
+           (__CORTEX_M >= 0x03U) ? "exclusive access" : "critical region",
+           NRF_BALLOC_CONFIG_CACHE_SIZE,
+           NRF_BALLOC_CONFIG_DEBUG_ENABLED ? ", debug checks" : "", POOL_SIZE, ELEMENT_SIZE);
+
+    pool_test();
+    stress_test();
+
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host replacement of components/libraries/util/app_util_platform.h for the block allocator
+ * benchmark. Every thread stands for one interrupt priority level. Critical regions take one
+ * mutex, and the exclusive access instructions are emulated with a compare-and-swap against the
+ * value that the exclusive load returned. That is weaker than a real exclusive monitor (it
+ * misses a store of the same value), which is exactly the ABA case that the allocator has to
+ * handle with its own tag. */
+
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include <stdint.h>
+#include <pthread.h>
+#include "compiler_abstraction.h"
+
+#define _PRIO_APP_LOWEST    7
+
+extern pthread_mutex_t     balloc_bench_critical_region;
+extern __thread uint8_t    balloc_bench_level;
+extern __thread uint32_t   balloc_bench_exclusive;
+
+#define CRITICAL_REGION_ENTER()     { pthread_mutex_lock(&balloc_bench_critical_region);
+#define CRITICAL_REGION_EXIT()      pthread_mutex_unlock(&balloc_bench_critical_region); }
+
+#define ANON_UNIONS_ENABLE
+#define ANON_UNIONS_DISABLE
+
+static inline uint8_t current_int_priority_get(void)
+{
+    return balloc_bench_level;
+}
+
+static inline uint32_t __LDREXW(volatile uint32_t * p_word)
+{
+    balloc_bench_exclusive = __atomic_load_n(p_word, __ATOMIC_ACQUIRE);
+    return balloc_bench_exclusive;
+}
+
+static inline uint32_t __STREXW(uint32_t value, volatile uint32_t * p_word)
+{
+    return __sync_bool_compare_and_swap(p_word, balloc_bench_exclusive, value) ? 0 : 1;
+}
+
+static inline void __CLREX(void)
+{
+}
+
+#endif // APP_UTIL_PLATFORM_H__
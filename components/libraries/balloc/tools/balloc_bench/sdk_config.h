@@ -0,0 +1,38 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Configuration of the block allocator benchmark. The Makefile sets the cache size and enables
+ * the debug checks for some of the builds. */
+
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+#define NRF_BALLOC_ENABLED 1
+#define NRF_BALLOC_CONFIG_LOG_ENABLED 0
+
+#ifndef NRF_BALLOC_CONFIG_CACHE_SIZE
+#define NRF_BALLOC_CONFIG_CACHE_SIZE 0
+#endif
+
+#ifndef NRF_BALLOC_CONFIG_DEBUG_ENABLED
+#define NRF_BALLOC_CONFIG_DEBUG_ENABLED 0
+#endif
+
+#define NRF_BALLOC_CONFIG_HEAD_GUARD_WORDS 1
+#define NRF_BALLOC_CONFIG_TAIL_WORDS 1
+#define NRF_BALLOC_CONFIG_BASIC_CHECKS_ENABLED 1
+#define NRF_BALLOC_CONFIG_DOUBLE_FREE_CHECK_ENABLED 1
+#define NRF_BALLOC_CONFIG_DATA_TRASHING_CHECK_ENABLED 1
+
+#define NRF_LOG_ENABLED 0
+
+#endif // SDK_CONFIG_H
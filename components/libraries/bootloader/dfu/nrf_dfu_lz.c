@@ -0,0 +1,474 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "nrf_dfu_lz.h"
+#include <string.h>
+#include "nrf_error.h"
+#include "nordic_common.h"
+#include "app_util.h"
+#include "nrf_log.h"
+
+#define LZ_VERSION              (1)
+#define LZ_FLAG_DELTA           (1<<0)
+#define LZ_NIBBLE_EXT           (15)            // Nibble value followed by length bytes.
+#define LZ_SHIFT_MAX_BYTES      (5)             // LEB128 bytes of a 32-bit number.
+#define LZ_WINDOW_MASK          (NRF_DFU_LZ_WINDOW_SIZE - 1)
+
+STATIC_ASSERT((NRF_DFU_LZ_WINDOW_BITS >= 8) && (NRF_DFU_LZ_WINDOW_BITS <= 16));
+
+// Decoder states. Each state waits for input; matches are copied as soon as they are known.
+typedef enum
+{
+    LZ_STATE_IDLE,          // Not started.
+    LZ_STATE_HEADER,        // Collecting the header.
+    LZ_STATE_TOKEN,         // Waiting for a token.
+    LZ_STATE_LIT_LEN,       // Adding literal length bytes.
+    LZ_STATE_LITERALS,      // Copying literals.
+    LZ_STATE_DISTANCE,      // Collecting the match distance.
+    LZ_STATE_SHIFT,         // Collecting the base shift of a base match.
+    LZ_STATE_MATCH_LEN,     // Adding match length bytes.
+    LZ_STATE_COMPLETE,      // The image is complete.
+    LZ_STATE_ERROR          // Stopped by an error.
+} lz_state_t;
+
+static lz_state_t           m_state;
+static nrf_dfu_lz_sink_t    m_sink;
+static uint8_t const *      mp_base;
+static uint32_t             m_base_size;
+static uint32_t             m_base_crc;
+
+static uint8_t              m_header[NRF_DFU_LZ_HEADER_SIZE];
+static uint32_t             m_field_len;        // Bytes collected of the header, distance or shift.
+static uint32_t             m_field;            // Distance or shift being collected.
+static uint32_t             m_image_size;
+static uint32_t             m_window_size;      // Largest distance allowed by the header.
+static bool                 m_delta;
+
+static uint32_t             m_lit_len;          // Literals left to copy.
+static uint32_t             m_match_len;
+static bool                 m_match_ext;        // The match length is followed by length bytes.
+static uint32_t             m_distance;
+static uint32_t             m_base_shift;       // Offset of base matches from the output offset, signed.
+
+static uint32_t             m_out;              // Bytes decoded.
+static uint32_t             m_emitted;          // Bytes passed to the sink.
+static uint8_t              m_window[NRF_DFU_LZ_WINDOW_SIZE];
+static uint32_t             m_win_pos;          // Where the next byte is decoded.
+static uint32_t             m_emit_pos;         // First byte not passed to the sink.
+
+
+// Passes the decoded bytes to the sink, and wraps the window when it is full.
+static uint32_t window_emit(void)
+{
+    uint32_t err_code = NRF_SUCCESS;
+
+    if (m_win_pos > m_emit_pos)
+    {
+        err_code   = m_sink(&m_window[m_emit_pos], m_win_pos - m_emit_pos);
+        m_emitted += m_win_pos - m_emit_pos;
+        m_emit_pos = m_win_pos;
+    }
+
+    if (m_win_pos == NRF_DFU_LZ_WINDOW_SIZE)
+    {
+        m_win_pos  = 0;
+        m_emit_pos = 0;
+    }
+
+    return err_code;
+}
+
+
+// Appends literals or a base match to the output.
+static uint32_t window_write(uint8_t const * p_data, uint32_t len)
+{
+    while (len > 0)
+    {
+        uint32_t const n = MIN(len, NRF_DFU_LZ_WINDOW_SIZE - m_win_pos);
+
+        memcpy(&m_window[m_win_pos], p_data, n);
+        m_win_pos += n;
+        m_out     += n;
+        p_data    += n;
+        len       -= n;
+
+        if (m_win_pos == NRF_DFU_LZ_WINDOW_SIZE)
+        {
+            uint32_t const err_code = window_emit();
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+// Appends a match of earlier output. A distance shorter than the length repeats a pattern.
+static uint32_t window_copy(uint32_t distance, uint32_t len)
+{
+    while (len > 0)
+    {
+        uint32_t const src = (m_win_pos - distance) & LZ_WINDOW_MASK;
+        uint32_t const n   = MIN(len, MIN(NRF_DFU_LZ_WINDOW_SIZE - src,
+                                          NRF_DFU_LZ_WINDOW_SIZE - m_win_pos));
+
+        // The source is behind the output, or ahead of it after wrapping around the window.
+        if ((src + n <= m_win_pos) || (m_win_pos + n <= src))
+        {
+            memcpy(&m_window[m_win_pos], &m_window[src], n);
+        }
+        else
+        {
+            for (uint32_t i = 0; i < n; i++)
+            {
+                m_window[m_win_pos + i] = m_window[src + i];
+            }
+        }
+        m_win_pos += n;
+        m_out     += n;
+        len       -= n;
+
+        if (m_win_pos == NRF_DFU_LZ_WINDOW_SIZE)
+        {
+            uint32_t const err_code = window_emit();
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+static uint32_t header_parse(void)
+{
+    uint8_t const flags       = m_header[4];
+    uint8_t const window_bits = m_header[5];
+
+    if ((m_header[0] != 'D') || (m_header[1] != 'L') || (m_header[2] != 'Z') ||
+        (m_header[3] != LZ_VERSION))
+    {
+        NRF_LOG_INFO("LZ: not a compressed image\r\n");
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    if (((flags & ~LZ_FLAG_DELTA) != 0) || (window_bits > NRF_DFU_LZ_WINDOW_BITS))
+    {
+        NRF_LOG_INFO("LZ: flags 0x%02x, window %d bits not supported\r\n", flags, window_bits);
+        return NRF_ERROR_NOT_SUPPORTED;
+    }
+
+    m_image_size  = uint32_decode(&m_header[8]);
+    m_window_size = 1UL << window_bits;
+    m_delta       = ((flags & LZ_FLAG_DELTA) != 0);
+
+    if (m_delta)
+    {
+        if (mp_base == NULL)
+        {
+            return NRF_ERROR_NOT_SUPPORTED;
+        }
+
+        if ((uint32_decode(&m_header[12]) != m_base_size) ||
+            (uint32_decode(&m_header[16]) != m_base_crc))
+        {
+            NRF_LOG_INFO("LZ: delta against another image\r\n");
+            return NRF_ERROR_INVALID_DATA;
+        }
+    }
+
+    m_state = (m_image_size == 0) ? LZ_STATE_COMPLETE : LZ_STATE_TOKEN;
+
+    return NRF_SUCCESS;
+}
+
+
+// Called when the literal length is known.
+static uint32_t literals_start(void)
+{
+    if (m_lit_len > (m_image_size - m_out))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    if (m_lit_len > 0)
+    {
+        m_state = LZ_STATE_LITERALS;
+    }
+    else
+    {
+        m_state = (m_out == m_image_size) ? LZ_STATE_COMPLETE : LZ_STATE_DISTANCE;
+        m_field_len = 0;
+        m_field     = 0;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+// Called when the match length is known: copies the match.
+static uint32_t match_copy(void)
+{
+    uint32_t err_code;
+
+    if (m_match_len > (m_image_size - m_out))
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    if (m_distance == 0)
+    {
+        int64_t const base_pos = (int64_t)m_out + (int32_t)m_base_shift;
+
+        if ((base_pos < 0) || ((base_pos + m_match_len) > m_base_size))
+        {
+            return NRF_ERROR_INVALID_DATA;
+        }
+        err_code = window_write(mp_base + base_pos, m_match_len);
+    }
+    else
+    {
+        err_code = window_copy(m_distance, m_match_len);
+    }
+
+    m_state = (m_out == m_image_size) ? LZ_STATE_COMPLETE : LZ_STATE_TOKEN;
+
+    return err_code;
+}
+
+
+// Called when the match source is known.
+static uint32_t match_start(void)
+{
+    if (m_match_ext)
+    {
+        m_state = LZ_STATE_MATCH_LEN;
+        return NRF_SUCCESS;
+    }
+
+    return match_copy();
+}
+
+
+// Decodes one step, consuming at least one byte of input.
+static uint32_t decode_step(uint8_t const ** pp_data, uint32_t len)
+{
+    uint8_t const * p_data = *pp_data;
+    uint32_t        err_code = NRF_SUCCESS;
+    uint8_t         byte;
+    uint32_t        n;
+
+    switch (m_state)
+    {
+        case LZ_STATE_HEADER:
+            n = MIN(len, NRF_DFU_LZ_HEADER_SIZE - m_field_len);
+            memcpy(&m_header[m_field_len], p_data, n);
+            m_field_len += n;
+            p_data      += n;
+            if (m_field_len == NRF_DFU_LZ_HEADER_SIZE)
+            {
+                err_code = header_parse();
+            }
+            break;
+
+        case LZ_STATE_TOKEN:
+            byte        = *p_data++;
+            m_lit_len   = byte >> 4;
+            m_match_len = (byte & 0x0F) + NRF_DFU_LZ_MIN_MATCH;
+            m_match_ext = ((byte & 0x0F) == LZ_NIBBLE_EXT);
+            if (m_lit_len == LZ_NIBBLE_EXT)
+            {
+                m_state = LZ_STATE_LIT_LEN;
+            }
+            else
+            {
+                err_code = literals_start();
+            }
+            break;
+
+        case LZ_STATE_LIT_LEN:
+            byte       = *p_data++;
+            m_lit_len += byte;
+            if (m_lit_len > m_image_size)
+            {
+                err_code = NRF_ERROR_INVALID_DATA;
+            }
+            else if (byte != UINT8_MAX)
+            {
+                err_code = literals_start();
+            }
+            break;
+
+        case LZ_STATE_LITERALS:
+            n = MIN(len, m_lit_len);
+            err_code   = window_write(p_data, n);
+            p_data    += n;
+            m_lit_len -= n;
+            if ((err_code == NRF_SUCCESS) && (m_lit_len == 0))
+            {
+                err_code = literals_start();
+            }
+            break;
+
+        case LZ_STATE_DISTANCE:
+            m_field |= (uint32_t)(*p_data++) << (8 * m_field_len);
+            if (++m_field_len < sizeof(uint16_t))
+            {
+                break;
+            }
+            m_distance = m_field;
+            if (m_distance == 0)
+            {
+                if (!m_delta)
+                {
+                    err_code = NRF_ERROR_INVALID_DATA;
+                    break;
+                }
+                m_state     = LZ_STATE_SHIFT;
+                m_field_len = 0;
+                m_field     = 0;
+            }
+            else if ((m_distance > m_window_size) || (m_distance > m_out))
+            {
+                err_code = NRF_ERROR_INVALID_DATA;
+            }
+            else
+            {
+                err_code = match_start();
+            }
+            break;
+
+        case LZ_STATE_SHIFT:
+            byte     = *p_data++;
+            m_field |= (uint32_t)(byte & 0x7F) << (7 * m_field_len);
+            if ((byte & 0x80) != 0)
+            {
+                if (++m_field_len == LZ_SHIFT_MAX_BYTES)
+                {
+                    err_code = NRF_ERROR_INVALID_DATA;
+                }
+                break;
+            }
+            // Zigzag decoding: 0, 1, 2, 3 are 0, -1, 1, -2.
+            m_base_shift += (m_field >> 1) ^ (0 - (m_field & 1));
+            err_code = match_start();
+            break;
+
+        case LZ_STATE_MATCH_LEN:
+            byte         = *p_data++;
+            m_match_len += byte;
+            if (m_match_len > m_image_size)
+            {
+                err_code = NRF_ERROR_INVALID_DATA;
+            }
+            else if (byte != UINT8_MAX)
+            {
+                err_code = match_copy();
+            }
+            break;
+
+        case LZ_STATE_COMPLETE:
+            err_code = NRF_ERROR_INVALID_LENGTH;
+            break;
+
+        default:
+            err_code = NRF_ERROR_INVALID_STATE;
+            break;
+    }
+
+    *pp_data = p_data;
+    return err_code;
+}
+
+
+uint32_t nrf_dfu_lz_init(nrf_dfu_lz_sink_t sink, uint8_t const * p_base, uint32_t base_size, uint32_t base_crc)
+{
+    if (sink == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    m_sink       = sink;
+    mp_base      = p_base;
+    m_base_size  = base_size;
+    m_base_crc   = base_crc;
+    m_field_len  = 0;
+    m_image_size = 0;
+    m_base_shift = 0;
+    m_out        = 0;
+    m_emitted    = 0;
+    m_win_pos    = 0;
+    m_emit_pos   = 0;
+    m_state      = LZ_STATE_HEADER;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t nrf_dfu_lz_decode(uint8_t const * p_data, uint32_t len)
+{
+    uint32_t err_code = NRF_SUCCESS;
+
+    if ((m_state == LZ_STATE_IDLE) || (m_state == LZ_STATE_ERROR))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if ((p_data == NULL) && (len > 0))
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    while ((len > 0) && (err_code == NRF_SUCCESS))
+    {
+        uint8_t const * const p_start = p_data;
+
+        err_code = decode_step(&p_data, len);
+        len     -= (uint32_t)(p_data - p_start);
+    }
+
+    if (err_code == NRF_SUCCESS)
+    {
+        err_code = window_emit();
+    }
+
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_INFO("LZ: decoding failed at 0x%08x: %d\r\n", m_out, err_code);
+        m_state = LZ_STATE_ERROR;
+    }
+
+    return err_code;
+}
+
+
+uint32_t nrf_dfu_lz_image_size_get(void)
+{
+    return m_image_size;
+}
+
+
+uint32_t nrf_dfu_lz_offset_get(void)
+{
+    return m_emitted;
+}
+
+
+bool nrf_dfu_lz_is_complete(void)
+{
+    return (m_state == LZ_STATE_COMPLETE);
+}
@@ -0,0 +1,139 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/**@file
+ *
+ * @defgroup sdk_nrf_dfu_lz Compressed firmware images
+ * @{
+ * @ingroup  sdk_nrf_dfu
+ *
+ * @brief   Streaming decoder for compressed firmware images.
+ *
+ * @details A compressed image is produced by tools/dfu_lz/dfu_lz.py. It is decoded as it is
+ *          received, in chunks of any size, and the decoded image is passed to a sink
+ *          function, typically @ref nrf_dfu_stream_write. The decoder only needs a window of
+ *          @ref NRF_DFU_LZ_WINDOW_SIZE bytes of RAM; the image is never staged in RAM.
+ *
+ *          The format is a sequence of LZ77 matches and literals, similar to LZ4:
+ *
+ *          - A 20-byte header: "DLZ", version 1, flags, log2 of the window size, two reserved
+ *            bytes, then the image size, the base size and the base CRC-32 as little-endian
+ *            32-bit words.
+ *          - Sequences of a token byte, literals and a match. The high nibble of the token is
+ *            the number of literals and the low nibble the match length minus
+ *            @ref NRF_DFU_LZ_MIN_MATCH. A nibble of 15 is followed by bytes which are added to
+ *            it, up to and including the first byte that is not 255. The literal bytes follow
+ *            the literal length, then a 16-bit little-endian match distance, then the match
+ *            length bytes.
+ *          - A distance of 1 to the window size copies earlier output. A distance of zero
+ *            copies from the base image instead (delta images only): it is followed by a
+ *            zigzag-encoded LEB128 number which is added to the base shift, and the match is
+ *            copied from the base at the current output offset plus the base shift.
+ *          - The image ends as soon as it is complete, after the literals or the match of a
+ *            sequence.
+ *
+ *          A delta image is encoded against the installed image, the base. The base must
+ *          stay in flash until the decoding is finished, so delta images need a dual bank
+ *          layout. The base size and CRC-32 in the header are checked against those given to
+ *          @ref nrf_dfu_lz_init, for example from the bank_0 settings.
+ *
+ *          An interrupted transfer is restarted from the beginning of the compressed image.
+ */
+
+#ifndef NRF_DFU_LZ_H__
+#define NRF_DFU_LZ_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief   Log2 of the window size. Images encoded with a larger window are rejected. */
+#ifndef NRF_DFU_LZ_WINDOW_BITS
+#define NRF_DFU_LZ_WINDOW_BITS      (11)
+#endif
+
+#define NRF_DFU_LZ_WINDOW_SIZE      (1UL << NRF_DFU_LZ_WINDOW_BITS)  /**< RAM used for the window, in bytes. */
+#define NRF_DFU_LZ_HEADER_SIZE      (20)                            /**< Size of the image header. */
+#define NRF_DFU_LZ_MIN_MATCH        (4)                             /**< Shortest match. */
+
+
+/**@brief Function for receiving the decoded image.
+ *
+ * @param[in]  p_data  Decoded data, valid only during the call.
+ * @param[in]  len     Length of @p p_data, in bytes.
+ *
+ * @return NRF_SUCCESS, or an error which stops the decoding and is returned by
+ *         @ref nrf_dfu_lz_decode.
+ */
+typedef uint32_t (*nrf_dfu_lz_sink_t)(uint8_t const * p_data, uint32_t len);
+
+
+/**@brief Function for starting to decode a compressed image.
+ *
+ * @param[in]  sink       Function receiving the decoded image.
+ * @param[in]  p_base     Start of the installed image, or NULL if delta images are not
+ *                        supported.
+ * @param[in]  base_size  Size of the installed image, in bytes.
+ * @param[in]  base_crc   CRC-32 of the installed image.
+ *
+ * @retval NRF_SUCCESS     If the decoder was started.
+ * @retval NRF_ERROR_NULL  If @p sink is NULL.
+ */
+uint32_t nrf_dfu_lz_init(nrf_dfu_lz_sink_t sink, uint8_t const * p_base, uint32_t base_size, uint32_t base_crc);
+
+
+/**@brief Function for decoding the next chunk of a compressed image.
+ *
+ * @details The chunk can end anywhere in the compressed image. Decoded data is passed to the
+ *          sink before the function returns.
+ *
+ * @param[in]  p_data  Compressed data.
+ * @param[in]  len     Length of @p p_data, in bytes.
+ *
+ * @retval NRF_SUCCESS              If the chunk was decoded.
+ * @retval NRF_ERROR_NULL           If @p p_data is NULL and @p len is not zero.
+ * @retval NRF_ERROR_INVALID_STATE  If the decoder is not started, or stopped by an error.
+ * @retval NRF_ERROR_INVALID_DATA   If the image is corrupt, or its base is not the installed
+ *                                  image.
+ * @retval NRF_ERROR_INVALID_LENGTH If there is data after the end of the image.
+ * @retval NRF_ERROR_NOT_SUPPORTED  If the image needs a larger window, or is a delta image and
+ *                                  no base was given.
+ * @return Any error returned by the sink.
+ */
+uint32_t nrf_dfu_lz_decode(uint8_t const * p_data, uint32_t len);
+
+
+/**@brief Function for getting the size of the decoded image, or zero if the header has not
+ *        been decoded yet.
+ */
+uint32_t nrf_dfu_lz_image_size_get(void);
+
+
+/**@brief Function for getting the number of bytes passed to the sink. */
+uint32_t nrf_dfu_lz_offset_get(void);
+
+
+/**@brief Function for checking whether the whole image has been decoded. */
+bool nrf_dfu_lz_is_complete(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_DFU_LZ_H__
+
+/** @} */
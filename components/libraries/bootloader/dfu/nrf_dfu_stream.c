@@ -0,0 +1,287 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "nrf_dfu_stream.h"
+#include <string.h>
+#include "nrf_dfu_flash.h"
+#include "nrf_dfu_types.h"
+#include "nrf_error.h"
+#include "nordic_common.h"
+#include "app_util.h"
+#include "crc32.h"
+#include "sha256.h"
+#include "nrf_log.h"
+
+#define STREAM_BUF_COUNT            (2)
+#define STREAM_BUF_SIZE_WORDS       (NRF_DFU_STREAM_BUF_SIZE / sizeof(uint32_t))
+
+#define STREAM_FLAG_NONE            (0)
+#define STREAM_FLAG_STARTED         (1<<0)
+#define STREAM_FLAG_FAILURE         (1<<1)
+#define STREAM_FLAG_FINISHED        (1<<2)  // Flushed in the middle of a word.
+
+STATIC_ASSERT((NRF_DFU_STREAM_BUF_SIZE % sizeof(uint32_t)) == 0);
+STATIC_ASSERT((CODE_PAGE_SIZE % NRF_DFU_STREAM_BUF_SIZE) == 0);
+
+static uint32_t          m_buf[STREAM_BUF_COUNT][STREAM_BUF_SIZE_WORDS];
+static volatile bool     m_buf_busy[STREAM_BUF_COUNT];  // Buffer is being programmed.
+static uint8_t           m_fill_idx;                    // Buffer which receives data.
+static volatile uint8_t  m_done_idx;                    // Buffer whose store completes next.
+static uint32_t          m_fill_start;                  // Image offset of the fill buffer.
+static uint32_t          m_fill_len;                    // Bytes in the fill buffer.
+static uint32_t const *  m_p_dest;                      // Start of the image in flash.
+static uint32_t          m_offset;                      // Bytes added to the image.
+static uint32_t          m_crc;
+static sha256_context_t  m_hash_ctx;
+static volatile uint8_t  m_flags;
+
+
+// Stores complete in the order they were requested, so the completed one is the oldest.
+static void store_done(fs_evt_t const * const evt, fs_ret_t result)
+{
+    if (result != FS_SUCCESS)
+    {
+        m_flags |= STREAM_FLAG_FAILURE;
+    }
+
+    m_buf_busy[m_done_idx] = false;
+    m_done_idx = (m_done_idx + 1) % STREAM_BUF_COUNT;
+}
+
+
+// Waits until a buffer has been programmed.
+static uint32_t buf_wait(uint8_t idx)
+{
+    while (m_buf_busy[idx] && ((m_flags & STREAM_FLAG_FAILURE) == 0))
+    {
+        if (nrf_dfu_flash_wait() != FS_SUCCESS)
+        {
+            m_flags |= STREAM_FLAG_FAILURE;
+        }
+    }
+
+    return ((m_flags & STREAM_FLAG_FAILURE) == 0) ? NRF_SUCCESS : NRF_ERROR_INTERNAL;
+}
+
+
+static uint32_t buf_wait_all(void)
+{
+    for (uint8_t i = 0; i < STREAM_BUF_COUNT; i++)
+    {
+        uint32_t const err_code = buf_wait(i);
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+// Starts programming the fill buffer, erasing its page first if it is the first buffer in it,
+// and switches to the next buffer.
+static uint32_t buf_store(void)
+{
+    uint32_t const * const p_dest = m_p_dest + (m_fill_start / sizeof(uint32_t));
+    fs_ret_t               ret_val;
+
+    if ((m_fill_start % CODE_PAGE_SIZE) == 0)
+    {
+        ret_val = nrf_dfu_flash_erase(p_dest, 1, NULL);
+        if (ret_val != FS_SUCCESS)
+        {
+            NRF_LOG_INFO("Stream: erase failed %d\r\n", ret_val);
+            m_flags |= STREAM_FLAG_FAILURE;
+            return NRF_ERROR_INTERNAL;
+        }
+    }
+
+    m_buf_busy[m_fill_idx] = true;
+
+    ret_val = nrf_dfu_flash_store(p_dest,
+                                  m_buf[m_fill_idx],
+                                  CEIL_DIV(m_fill_len, sizeof(uint32_t)),
+                                  store_done);
+    if (ret_val != FS_SUCCESS)
+    {
+        NRF_LOG_INFO("Stream: store failed %d\r\n", ret_val);
+        m_buf_busy[m_fill_idx] = false;
+        m_flags |= STREAM_FLAG_FAILURE;
+        return NRF_ERROR_INTERNAL;
+    }
+
+    m_fill_idx    = (m_fill_idx + 1) % STREAM_BUF_COUNT;
+    m_fill_start += m_fill_len;
+    m_fill_len    = 0;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t nrf_dfu_stream_init(uint32_t const * p_dest, uint32_t offset)
+{
+    uint32_t err_code;
+
+    if (p_dest == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    if (((uintptr_t)p_dest & (CODE_PAGE_SIZE - 1)) != 0)
+    {
+        return NRF_ERROR_INVALID_ADDR;
+    }
+
+    // Let the stores of a previous stream finish before the buffers are reused.
+    err_code = buf_wait_all();
+    if (err_code != NRF_SUCCESS)
+    {
+        return err_code;
+    }
+
+    offset &= ~(sizeof(uint32_t) - 1);
+
+    m_p_dest     = p_dest;
+    m_offset     = offset;
+    m_fill_start = offset;
+    m_fill_len   = 0;
+    m_fill_idx   = 0;
+    m_done_idx   = 0;
+    m_flags      = STREAM_FLAG_STARTED;
+
+    m_crc = crc32_compute((uint8_t const *)p_dest, offset, NULL);
+    (void)sha256_init(&m_hash_ctx);
+    (void)sha256_update(&m_hash_ctx, (uint8_t const *)p_dest, offset);
+
+    NRF_LOG_INFO("Stream: started at offset 0x%08x\r\n", offset);
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t nrf_dfu_stream_write(uint8_t const * p_data, uint32_t len)
+{
+    if (((m_flags & STREAM_FLAG_STARTED) == 0) || ((m_flags & STREAM_FLAG_FINISHED) != 0))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if ((m_flags & STREAM_FLAG_FAILURE) != 0)
+    {
+        return NRF_ERROR_INTERNAL;
+    }
+
+    if (len == 0)
+    {
+        return NRF_SUCCESS;
+    }
+
+    if (p_data == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    // Hash the data now, while the previous buffer is being programmed.
+    m_crc = crc32_compute(p_data, len, (m_offset == 0) ? NULL : &m_crc);
+    (void)sha256_update(&m_hash_ctx, p_data, len);
+    m_offset += len;
+
+    while (len > 0)
+    {
+        // A buffer ends at a multiple of its size, so that it does not cross a page, also
+        // after a flush or a resume in the middle of a buffer.
+        uint32_t const buf_end = NRF_DFU_STREAM_BUF_SIZE - (m_fill_start % NRF_DFU_STREAM_BUF_SIZE);
+        uint32_t const chunk   = MIN(len, buf_end - m_fill_len);
+
+        if (m_fill_len == 0)
+        {
+            uint32_t const err_code = buf_wait(m_fill_idx);
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+
+        memcpy((uint8_t *)m_buf[m_fill_idx] + m_fill_len, p_data, chunk);
+        m_fill_len += chunk;
+        p_data     += chunk;
+        len        -= chunk;
+
+        if (m_fill_len == buf_end)
+        {
+            uint32_t const err_code = buf_store();
+            if (err_code != NRF_SUCCESS)
+            {
+                return err_code;
+            }
+        }
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t nrf_dfu_stream_flush(void)
+{
+    if ((m_flags & STREAM_FLAG_STARTED) == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if ((m_flags & STREAM_FLAG_FAILURE) != 0)
+    {
+        return NRF_ERROR_INTERNAL;
+    }
+
+    if (m_fill_len > 0)
+    {
+        uint32_t const pad = (sizeof(uint32_t) - (m_fill_len % sizeof(uint32_t))) % sizeof(uint32_t);
+        uint32_t       err_code;
+
+        if (pad > 0)
+        {
+            // The rest of the last word cannot be written again.
+            memset((uint8_t *)m_buf[m_fill_idx] + m_fill_len, 0xFF, pad);
+            m_flags |= STREAM_FLAG_FINISHED;
+        }
+
+        err_code = buf_store();
+        if (err_code != NRF_SUCCESS)
+        {
+            return err_code;
+        }
+    }
+
+    return buf_wait_all();
+}
+
+
+uint32_t nrf_dfu_stream_offset_get(void)
+{
+    return m_offset;
+}
+
+
+uint32_t nrf_dfu_stream_crc_get(void)
+{
+    return m_crc;
+}
+
+
+void nrf_dfu_stream_hash_get(uint8_t * p_hash, uint8_t le)
+{
+    // Finalize a copy, so that the stream can continue.
+    sha256_context_t hash_ctx = m_hash_ctx;
+
+    (void)sha256_final(&hash_ctx, p_hash, le);
+}
@@ -0,0 +1,134 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/**@file
+ *
+ * @defgroup sdk_nrf_dfu_stream Streaming firmware writes
+ * @{
+ * @ingroup  sdk_nrf_dfu
+ *
+ * @brief   Writes a firmware image to flash as it is received, computing its CRC-32 and SHA-256
+ *          on the way.
+ *
+ * @details Received data is copied into one of two RAM buffers of @ref NRF_DFU_STREAM_BUF_SIZE
+ *          bytes, and the CRC and hash are updated with it. When a buffer is full, it is stored
+ *          with @ref nrf_dfu_flash_store and the other buffer is filled while the first one is
+ *          programmed. A flash page is erased when the first buffer in it is stored. Only when
+ *          data arrives faster than the flash can program it does @ref nrf_dfu_stream_write
+ *          wait for a buffer to become free.
+ *
+ *          When the transfer is done, @ref nrf_dfu_stream_flush stores the last, partly filled
+ *          buffer. The CRC and hash of the image are then available without reading it back
+ *          from flash.
+ */
+
+#ifndef NRF_DFU_STREAM_H__
+#define NRF_DFU_STREAM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief   Size of each of the two buffers, in bytes. Must be a multiple of four that divides
+ *          CODE_PAGE_SIZE.
+ *
+ * @details The transfer does not wait for the flash as long as filling a buffer takes longer
+ *          than erasing a page and programming a buffer. With BLE at about 16 kB/s, that needs
+ *          2048 bytes on nRF52.
+ */
+#ifndef NRF_DFU_STREAM_BUF_SIZE
+#define NRF_DFU_STREAM_BUF_SIZE     (2048)
+#endif
+
+
+/**@brief Function for starting to stream an image to flash.
+ *
+ * @details When resuming an interrupted transfer, @p offset is the number of bytes already in
+ *          flash. The CRC and hash of those bytes are computed from flash. The offset is
+ *          rounded down to a word; read the offset to resume from with
+ *          @ref nrf_dfu_stream_offset_get. The flash after the offset must be erased, or the
+ *          offset must be at the start of a page.
+ *
+ * @param[in]  p_dest  Start of the image in flash. Must be aligned to a flash page.
+ * @param[in]  offset  Number of bytes of the image already in flash.
+ *
+ * @retval NRF_SUCCESS              If the stream was started.
+ * @retval NRF_ERROR_NULL           If @p p_dest is NULL.
+ * @retval NRF_ERROR_INVALID_ADDR   If @p p_dest is not aligned to a flash page.
+ * @retval NRF_ERROR_INTERNAL       If a flash operation of the previous stream failed.
+ */
+uint32_t nrf_dfu_stream_init(uint32_t const * p_dest, uint32_t offset);
+
+
+/**@brief Function for adding received data to the image.
+ *
+ * @details The data is copied, so @p p_data can be reused when the function returns.
+ *
+ * @param[in]  p_data  Data to add.
+ * @param[in]  len     Length of @p p_data, in bytes.
+ *
+ * @retval NRF_SUCCESS              If the data was added.
+ * @retval NRF_ERROR_NULL           If @p p_data is NULL and @p len is not zero.
+ * @retval NRF_ERROR_INVALID_STATE  If the stream is not started, or was flushed at an offset
+ *                                  which is not a multiple of four.
+ * @retval NRF_ERROR_INTERNAL       If a flash operation failed.
+ */
+uint32_t nrf_dfu_stream_write(uint8_t const * p_data, uint32_t len);
+
+
+/**@brief Function for storing the buffered data and waiting until all of it is in flash.
+ *
+ * @details The last word is padded with 0xFF. If the image length is not a multiple of four,
+ *          no more data can be added after the flush.
+ *
+ * @retval NRF_SUCCESS              If all data is in flash.
+ * @retval NRF_ERROR_INVALID_STATE  If the stream is not started.
+ * @retval NRF_ERROR_INTERNAL       If a flash operation failed.
+ */
+uint32_t nrf_dfu_stream_flush(void);
+
+
+/**@brief Function for getting the number of bytes added to the image, including those which
+ *        were in flash when the stream was started.
+ */
+uint32_t nrf_dfu_stream_offset_get(void);
+
+
+/**@brief Function for getting the CRC-32 of the bytes added to the image.
+ *
+ * @details The same value as crc32_compute over the image, and valid as soon as
+ *          @ref nrf_dfu_stream_write returns, before the data is in flash.
+ */
+uint32_t nrf_dfu_stream_crc_get(void);
+
+
+/**@brief Function for getting the SHA-256 hash of the bytes added to the image.
+ *
+ * @details More data can be added after this call.
+ *
+ * @param[out] p_hash  32-byte buffer for the hash.
+ * @param[in]  le      Endianness of the hash, as for sha256_final.
+ */
+void nrf_dfu_stream_hash_get(uint8_t * p_hash, uint8_t le);
+
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_DFU_STREAM_H__
+
+/** @} */
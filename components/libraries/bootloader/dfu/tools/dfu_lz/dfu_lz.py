@@ -0,0 +1,399 @@
+#!/usr/bin/env python3
+# Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+#
+# The information contained herein is property of Nordic Semiconductor ASA.
+# Terms and conditions of usage are described in detail in NORDIC
+# SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+#
+# Licensees are granted free, non-transferable use of the information. NO
+# WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+# the file.
+#
+
+"""Compressor for DFU firmware images.
+
+Writes images in the format decoded by nrf_dfu_lz.c in the bootloader (see
+nrf_dfu_lz.h for the layout): LZ77 sequences with a small window, so that the
+bootloader decodes them in fixed RAM while they are received. With --base, the
+image is also encoded against the installed image, which the bootloader reads
+from flash: the parts of the new image which are found in the old one cost a
+few bytes each.
+
+Commands:
+    compress    Compresses a .bin or .hex image, and checks that it decodes.
+    decompress  Decodes a compressed image, as the bootloader does.
+    bin         Converts an Intel HEX file to a binary image, with the gaps
+                filled with 0xFF, from its lowest to its highest address.
+
+The window must not be larger than NRF_DFU_LZ_WINDOW_BITS in the bootloader.
+A longer --chain searches more earlier positions for matches: better
+compression, slower.
+
+Examples:
+    dfu_lz.py compress _build/nrf52832_xxaa.hex app.dlz
+    dfu_lz.py compress new.hex app_delta.dlz --base old.hex
+    dfu_lz.py decompress app_delta.dlz app.bin --base old.hex
+
+Only the Python 3 standard library is used.
+"""
+
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = b'DLZ'
+VERSION = 1
+FLAG_DELTA = 0x01
+HEADER = struct.Struct('<3sBBBxxIII')
+MIN_MATCH = 4
+NIBBLE_EXT = 15
+MAX_DISTANCE = 0xFFFF
+
+
+class FormatError(Exception):
+    pass
+
+
+def read_hex(path):
+    """Reads an Intel HEX file into a bytearray starting at its lowest address."""
+    data = {}
+    base = 0
+    with open(path) as f:
+        for num, line in enumerate(f, 1):
+            line = line.strip()
+            if not line:
+                continue
+            if not line.startswith(':'):
+                raise FormatError('%s:%d: not an Intel HEX record' % (path, num))
+            rec = bytes.fromhex(line[1:])
+            if len(rec) < 5 or len(rec) != rec[0] + 5 or sum(rec) & 0xFF:
+                raise FormatError('%s:%d: bad record' % (path, num))
+            length, addr, rtype = rec[0], (rec[1] << 8) | rec[2], rec[3]
+            payload = rec[4:4 + length]
+            if rtype == 0x00:
+                data[base + addr] = payload
+            elif rtype == 0x01:
+                break
+            elif rtype == 0x02:
+                base = int.from_bytes(payload, 'big') << 4
+            elif rtype == 0x04:
+                base = int.from_bytes(payload, 'big') << 16
+    if not data:
+        return bytearray()
+    start = min(data)
+    end = max(addr + len(payload) for addr, payload in data.items())
+    image = bytearray(b'\xff' * (end - start))
+    for addr, payload in data.items():
+        image[addr - start:addr - start + len(payload)] = payload
+    return image
+
+
+def read_image(path):
+    if path.lower().endswith('.hex'):
+        return bytes(read_hex(path))
+    with open(path, 'rb') as f:
+        return f.read()
+
+
+def crc32(data):
+    # Same as crc32_compute.
+    return zlib.crc32(data) & 0xFFFFFFFF
+
+
+def length_bytes(value):
+    """Bytes following a nibble of 15: runs of 255, then a byte below 255."""
+    return b'\xff' * (value // 255) + bytes([value % 255])
+
+
+def zigzag_leb128(value):
+    value = ((value << 1) ^ (value >> 31)) & 0xFFFFFFFF
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def match_length(a, pa, b, pb, limit):
+    """Length of the common run of a[pa:] and b[pb:], at most limit."""
+    length = 0
+    step = 32
+    while length < limit:
+        n = min(step, limit - length)
+        if a[pa + length:pa + length + n] == b[pb + length:pb + length + n]:
+            length += n
+        else:
+            while length < limit and a[pa + length] == b[pb + length]:
+                length += 1
+            break
+    return length
+
+
+class Encoder:
+    def __init__(self, image, base, window_bits, chain):
+        self.image = image
+        self.base = base
+        self.window = min(1 << window_bits, MAX_DISTANCE)
+        self.chain = chain
+        self.head = {}
+        self.prev = [-1] * len(image)
+        self.inserted = 0
+        self.base_index = {}
+        self.shift = 0
+        if base is not None:
+            for pos in range(len(base) - MIN_MATCH + 1):
+                self.base_index.setdefault(base[pos:pos + MIN_MATCH], []).append(pos)
+
+    def insert_until(self, pos):
+        image = self.image
+        end = min(pos, len(image) - MIN_MATCH + 1)
+        for p in range(self.inserted, end):
+            key = image[p:p + MIN_MATCH]
+            self.prev[p] = self.head.get(key, -1)
+            self.head[key] = p
+        self.inserted = max(self.inserted, end)
+
+    def find_match(self, pos):
+        """Returns (gain, length, distance, base position) of the best match at pos."""
+        image = self.image
+        limit = len(image) - pos
+        if limit < MIN_MATCH:
+            return None
+        self.insert_until(pos)
+        key = image[pos:pos + MIN_MATCH]
+        best = None
+
+        # Earlier output: a distance costs two bytes.
+        cand = self.head.get(key, -1)
+        tries = self.chain
+        while cand >= 0 and pos - cand <= self.window and tries > 0:
+            length = match_length(image, cand, image, pos, limit)
+            if length >= MIN_MATCH and (best is None or length - 2 > best[0]):
+                best = (length - 2, length, pos - cand, None)
+                if length == limit:
+                    break
+            cand = self.prev[cand]
+            tries -= 1
+
+        if self.base is None:
+            return best
+
+        # The installed image: a zero distance and the change of the base shift.
+        candidates = []
+        expected = pos + self.shift
+        if 0 <= expected <= len(self.base) - MIN_MATCH:
+            candidates.append(expected)
+        positions = self.base_index.get(key, ())
+        if len(positions) > self.chain:
+            # Look at the positions closest to the current shift.
+            lo, hi = 0, len(positions)
+            while lo < hi:
+                mid = (lo + hi) // 2
+                if positions[mid] < expected:
+                    lo = mid + 1
+                else:
+                    hi = mid
+            half = self.chain // 2
+            positions = positions[max(0, lo - half):lo + half]
+        candidates.extend(positions)
+        base_limit = len(self.base)
+        for bpos in candidates:
+            length = match_length(self.base, bpos, image, pos, min(limit, base_limit - bpos))
+            if length < MIN_MATCH:
+                continue
+            gain = length - 2 - len(zigzag_leb128(bpos - pos - self.shift))
+            if best is None or gain > best[0]:
+                best = (gain, length, 0, bpos)
+        return best
+
+    def encode(self):
+        image = self.image
+        out = bytearray()
+        pos = 0
+        lit_start = 0
+        while pos < len(image):
+            match = self.find_match(pos)
+            if match is not None and match[0] > 0 and pos + 1 < len(image):
+                # Lazy matching: take a literal if the next position has a better match.
+                later = self.find_match(pos + 1)
+                if later is not None and later[0] > match[0] + 1:
+                    pos += 1
+                    continue
+            if match is None or match[0] <= 0:
+                pos += 1
+                continue
+
+            gain, length, distance, bpos = match
+            literals = image[lit_start:pos]
+            lit_nibble = min(len(literals), NIBBLE_EXT)
+            match_nibble = min(length - MIN_MATCH, NIBBLE_EXT)
+            out.append((lit_nibble << 4) | match_nibble)
+            if lit_nibble == NIBBLE_EXT:
+                out += length_bytes(len(literals) - NIBBLE_EXT)
+            out += literals
+            out += struct.pack('<H', distance)
+            if distance == 0:
+                new_shift = bpos - pos
+                out += zigzag_leb128(new_shift - self.shift)
+                self.shift = new_shift
+            if match_nibble == NIBBLE_EXT:
+                out += length_bytes(length - MIN_MATCH - NIBBLE_EXT)
+            pos += length
+            lit_start = pos
+
+        literals = image[lit_start:]
+        if literals:
+            lit_nibble = min(len(literals), NIBBLE_EXT)
+            out.append(lit_nibble << 4)
+            if lit_nibble == NIBBLE_EXT:
+                out += length_bytes(len(literals) - NIBBLE_EXT)
+            out += literals
+        return bytes(out)
+
+
+def compress(image, base=None, window_bits=11, chain=32):
+    flags = FLAG_DELTA if base is not None else 0
+    header = HEADER.pack(MAGIC, VERSION, flags, window_bits, len(image),
+                         len(base) if base is not None else 0,
+                         crc32(base) if base is not None else 0)
+    return header + Encoder(image, base, window_bits, chain).encode()
+
+
+def decompress(data, base=None):
+    """Decodes an image like nrf_dfu_lz.c, with the same checks."""
+    if len(data) < HEADER.size:
+        raise FormatError('truncated header')
+    magic, version, flags, window_bits, size, base_size, base_crc = HEADER.unpack_from(data)
+    if magic != MAGIC or version != VERSION:
+        raise FormatError('not a compressed image')
+    if flags & ~FLAG_DELTA or window_bits > 16:
+        raise FormatError('flags 0x%02x, window of %d bits not supported' % (flags, window_bits))
+    if flags & FLAG_DELTA:
+        if base is None:
+            raise FormatError('delta image: the base image is needed')
+        if len(base) != base_size or crc32(base) != base_crc:
+            raise FormatError('delta image against another base')
+    window = 1 << window_bits
+    out = bytearray()
+    pos = HEADER.size
+    shift = 0
+
+    def byte():
+        nonlocal pos
+        if pos >= len(data):
+            raise FormatError('truncated image')
+        pos += 1
+        return data[pos - 1]
+
+    def extended(value):
+        if value == NIBBLE_EXT:
+            while True:
+                b = byte()
+                value += b
+                if b != 0xFF:
+                    break
+        return value
+
+    while len(out) < size:
+        token = byte()
+        lit_len = extended(token >> 4)
+        if lit_len > size - len(out) or pos + lit_len > len(data):
+            raise FormatError('bad literals at 0x%x' % len(out))
+        out += data[pos:pos + lit_len]
+        pos += lit_len
+        if len(out) == size:
+            break
+        distance = byte() | (byte() << 8)
+        if distance == 0:
+            if not flags & FLAG_DELTA:
+                raise FormatError('base match in an image without base')
+            value, bits = 0, 0
+            while True:
+                b = byte()
+                value |= (b & 0x7F) << bits
+                bits += 7
+                if not b & 0x80:
+                    break
+                if bits >= 35:
+                    raise FormatError('bad base shift')
+            value &= 0xFFFFFFFF
+            shift += (value >> 1) ^ -(value & 1)
+        elif distance > window or distance > len(out):
+            raise FormatError('bad distance at 0x%x' % len(out))
+        length = extended(token & 0x0F) + MIN_MATCH
+        if length > size - len(out):
+            raise FormatError('bad match length at 0x%x' % len(out))
+        if distance == 0:
+            bpos = len(out) + shift
+            if bpos < 0 or bpos + length > len(base):
+                raise FormatError('base match outside the base at 0x%x' % len(out))
+            out += base[bpos:bpos + length]
+        else:
+            for _ in range(length):
+                out.append(out[-distance])
+    if pos != len(data):
+        raise FormatError('data after the end of the image')
+    return bytes(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compress DFU firmware images.')
+    sub = parser.add_subparsers(dest='command')
+    sub.required = True
+
+    p = sub.add_parser('compress', help='compress an image')
+    p.add_argument('input', help='image, .bin or .hex')
+    p.add_argument('output', help='compressed image')
+    p.add_argument('--base', help='installed image, for a delta image')
+    p.add_argument('--window-bits', type=int, default=11,
+                   help='log2 of the window size (default 11, 2048 bytes)')
+    p.add_argument('--chain', type=int, default=32,
+                   help='match candidates searched per position (default 32)')
+
+    p = sub.add_parser('decompress', help='decode a compressed image')
+    p.add_argument('input', help='compressed image')
+    p.add_argument('output', help='image')
+    p.add_argument('--base', help='installed image, for a delta image')
+
+    p = sub.add_parser('bin', help='convert an Intel HEX file to a binary image')
+    p.add_argument('input', help='.hex file')
+    p.add_argument('output', help='.bin file')
+
+    args = parser.parse_args()
+    try:
+        if args.command == 'compress':
+            if not 8 <= args.window_bits <= 16:
+                parser.error('--window-bits must be 8 to 16')
+            image = read_image(args.input)
+            base = read_image(args.base) if args.base else None
+            data = compress(image, base, args.window_bits, max(1, args.chain))
+            if decompress(data, base) != image:
+                raise FormatError('internal error: the image does not decode')
+            with open(args.output, 'wb') as f:
+                f.write(data)
+            print('%s: %d bytes, %d compressed%s, ratio %.2f' %
+                  (args.output, len(image), len(data), ' (delta)' if base is not None else '',
+                   len(image) / max(1, len(data))))
+        elif args.command == 'decompress':
+            with open(args.input, 'rb') as f:
+                data = f.read()
+            base = read_image(args.base) if args.base else None
+            image = decompress(data, base)
+            with open(args.output, 'wb') as f:
+                f.write(image)
+        else:
+            with open(args.output, 'wb') as f:
+                f.write(read_hex(args.input))
+    except (FormatError, OSError) as e:
+        print('dfu_lz.py: %s' % e, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
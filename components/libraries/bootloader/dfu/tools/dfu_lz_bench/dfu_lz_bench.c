@@ -0,0 +1,463 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host test and benchmark of the compressed image decoder nrf_dfu_lz.c.
+ *
+ * Each case is a compressed image made by dfu_lz.py, the image it decodes to and, for delta
+ * images, the installed image. For each case the test:
+ * - decodes the image in packets into nrf_dfu_stream_write, on a host version of the NVMC path
+ *   of nrf_dfu_flash.c (below), and checks the flash content and the CRC-32 of the stream,
+ * - decodes it in chunks of one byte and of random sizes,
+ * - decodes corrupted and truncated copies, which must fail cleanly or decode to an image of
+ *   the right size,
+ * and prints the compression ratio, the host decode throughput and the air time at the link
+ * speed, compressed and not.
+ *
+ * Command line: case=<image.dlz>,<image.bin>[,<base.bin>] ... packet=<bytes>
+ *               link_bps=<bytes/s> seconds=<s>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "nrf_error.h"
+#include "nordic_common.h"
+#include "nrf_dfu_flash.h"
+#include "nrf_dfu_lz.h"
+#include "nrf_dfu_stream.h"
+#include "nrf_dfu_types.h"
+#include "crc32.h"
+
+#define CASES_MAX           (8)
+#define PACKET_DEFAULT      (20)        // ATT MTU of 23 bytes.
+#define LINK_BPS_DEFAULT    (16000)     // Six packets per 7.5 ms connection interval.
+#define SECONDS_DEFAULT     (1)
+#define CORRUPT_RUNS        (2000)
+#define BANK_SIZE           (256 * 1024)
+
+typedef struct
+{
+    char const * p_dlz_name;
+    char const * p_bin_name;
+    char const * p_base_name;
+    uint8_t *    p_dlz;
+    uint32_t     dlz_size;
+    uint8_t *    p_bin;
+    uint32_t     bin_size;
+    uint8_t *    p_base;
+    uint32_t     base_size;
+} bench_case_t;
+
+static bench_case_t m_cases[CASES_MAX];
+static uint32_t     m_case_count;
+static uint32_t     m_packet = PACKET_DEFAULT;
+
+static uint32_t     m_bank[BANK_SIZE / sizeof(uint32_t)] __attribute__((aligned(CODE_PAGE_SIZE)));
+
+static bench_case_t const * mp_case;    // Case checked by check_sink.
+static uint32_t     m_sink_offset;
+static bool         m_sink_ok;
+
+static uint32_t     m_checks;
+static uint32_t     m_failures;
+
+
+static void check(bool ok, char const * p_what)
+{
+    m_checks++;
+    if (!ok)
+    {
+        if (m_failures < 20)
+        {
+            printf("FAILED: %s\n", p_what);
+        }
+        m_failures++;
+    }
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+/* Host version of nrf_dfu_flash.c without the SoftDevice: the bank is a RAM array, and
+ * operations complete before the functions return. */
+
+uint32_t nrf_dfu_flash_init(bool sd_enabled)
+{
+    memset(m_bank, 0xFF, sizeof(m_bank));
+    return NRF_SUCCESS;
+}
+
+
+fs_ret_t nrf_dfu_flash_store(uint32_t const * p_dest, uint32_t const * const p_src, uint32_t len_words, dfu_flash_callback_t callback)
+{
+    uint32_t * const p_word = (uint32_t *)p_dest;
+
+    if ((p_dest < m_bank) || (p_dest + len_words > m_bank + ARRAY_SIZE(m_bank)))
+    {
+        return FS_ERR_INVALID_ADDR;
+    }
+
+    for (uint32_t i = 0; i < len_words; i++)
+    {
+        p_word[i] &= p_src[i];
+    }
+
+    if (callback)
+    {
+        fs_evt_t evt = { .id = FS_EVT_STORE, .p_context = (void *)callback };
+        evt.store.p_data       = p_dest;
+        evt.store.length_words = len_words;
+        callback(&evt, FS_SUCCESS);
+    }
+    return FS_SUCCESS;
+}
+
+
+fs_ret_t nrf_dfu_flash_erase(uint32_t const * p_dest, uint32_t num_pages, dfu_flash_callback_t callback)
+{
+    uint32_t const words = num_pages * CODE_PAGE_SIZE / sizeof(uint32_t);
+
+    if ((p_dest < m_bank) || (p_dest + words > m_bank + ARRAY_SIZE(m_bank)))
+    {
+        return FS_ERR_INVALID_ADDR;
+    }
+
+    memset((uint32_t *)p_dest, 0xFF, words * sizeof(uint32_t));
+
+    if (callback)
+    {
+        fs_evt_t evt = { .id = FS_EVT_ERASE, .p_context = (void *)callback };
+        callback(&evt, FS_SUCCESS);
+    }
+    return FS_SUCCESS;
+}
+
+
+void nrf_dfu_flash_error_clear(void)
+{
+}
+
+
+fs_ret_t nrf_dfu_flash_wait(void)
+{
+    return FS_SUCCESS;
+}
+
+
+static uint8_t * file_read(char const * p_name, uint32_t * p_size)
+{
+    FILE *    p_file = fopen(p_name, "rb");
+    uint8_t * p_data;
+    long      size;
+
+    if (p_file == NULL)
+    {
+        perror(p_name);
+        exit(2);
+    }
+    (void)fseek(p_file, 0, SEEK_END);
+    size = ftell(p_file);
+    (void)fseek(p_file, 0, SEEK_SET);
+
+    p_data = malloc((size > 0) ? (size_t)size : 1);
+    if ((p_data == NULL) || (fread(p_data, 1, (size_t)size, p_file) != (size_t)size))
+    {
+        fprintf(stderr, "%s: read failed\n", p_name);
+        exit(2);
+    }
+    (void)fclose(p_file);
+
+    *p_size = (uint32_t)size;
+    return p_data;
+}
+
+
+static uint32_t lz_init(bench_case_t const * p_case, nrf_dfu_lz_sink_t sink)
+{
+    uint32_t const base_crc = (p_case->p_base != NULL) ?
+                              crc32_compute(p_case->p_base, p_case->base_size, NULL) : 0;
+
+    return nrf_dfu_lz_init(sink, p_case->p_base, p_case->base_size, base_crc);
+}
+
+
+// Decodes a compressed image in chunks of chunk bytes, or of random sizes up to 64 if zero.
+static uint32_t lz_decode(uint8_t const * p_data, uint32_t size, uint32_t chunk)
+{
+    uint32_t err_code = NRF_SUCCESS;
+
+    for (uint32_t pos = 0; (pos < size) && (err_code == NRF_SUCCESS); )
+    {
+        uint32_t const max = (chunk > 0) ? chunk : 1 + (uint32_t)(rand() % 64);
+        uint32_t const n   = MIN(size - pos, max);
+
+        err_code = nrf_dfu_lz_decode(&p_data[pos], n);
+        pos     += n;
+    }
+    return err_code;
+}
+
+
+// Checks the decoded data against the expected image.
+static uint32_t check_sink(uint8_t const * p_data, uint32_t len)
+{
+    if ((len > mp_case->bin_size - m_sink_offset) ||
+        (memcmp(p_data, &mp_case->p_bin[m_sink_offset], len) != 0))
+    {
+        m_sink_ok = false;
+    }
+    m_sink_offset += MIN(len, mp_case->bin_size - m_sink_offset);
+    return NRF_SUCCESS;
+}
+
+
+// Accepts anything, but not more than the image size in the header.
+static uint32_t bounded_sink(uint8_t const * p_data, uint32_t len)
+{
+    volatile uint8_t touch = 0;
+
+    for (uint32_t i = 0; i < len; i++)
+    {
+        touch ^= p_data[i];
+    }
+    m_sink_offset += len;
+    if (m_sink_offset > nrf_dfu_lz_image_size_get())
+    {
+        m_sink_ok = false;
+    }
+    return NRF_SUCCESS;
+}
+
+
+static uint32_t null_sink(uint8_t const * p_data, uint32_t len)
+{
+    return NRF_SUCCESS;
+}
+
+
+static void case_flash(bench_case_t const * p_case)
+{
+    char what[128];
+
+    snprintf(what, sizeof(what), "%s: decode into flash", p_case->p_dlz_name);
+    check(nrf_dfu_stream_init(m_bank, 0) == NRF_SUCCESS, what);
+    check(lz_init(p_case, nrf_dfu_stream_write) == NRF_SUCCESS, what);
+    check(lz_decode(p_case->p_dlz, p_case->dlz_size, m_packet) == NRF_SUCCESS, what);
+    check(nrf_dfu_lz_is_complete(), what);
+    check(nrf_dfu_stream_flush() == NRF_SUCCESS, what);
+
+    snprintf(what, sizeof(what), "%s: image in flash", p_case->p_dlz_name);
+    check(nrf_dfu_lz_offset_get() == p_case->bin_size, what);
+    check(nrf_dfu_stream_offset_get() == p_case->bin_size, what);
+    check(memcmp(m_bank, p_case->p_bin, p_case->bin_size) == 0, what);
+    check(nrf_dfu_stream_crc_get() == crc32_compute(p_case->p_bin, p_case->bin_size, NULL), what);
+}
+
+
+static void case_chunks(bench_case_t const * p_case)
+{
+    static uint32_t const chunks[] = { 1, 0, 244 };
+    uint8_t header[NRF_DFU_LZ_HEADER_SIZE];
+    char    what[128];
+
+    mp_case = p_case;
+    for (uint32_t i = 0; i < ARRAY_SIZE(chunks); i++)
+    {
+        snprintf(what, sizeof(what), "%s: decode in chunks of %u", p_case->p_dlz_name, chunks[i]);
+        m_sink_offset = 0;
+        m_sink_ok     = true;
+        check(lz_init(p_case, check_sink) == NRF_SUCCESS, what);
+        check(lz_decode(p_case->p_dlz, p_case->dlz_size, chunks[i]) == NRF_SUCCESS, what);
+        check(m_sink_ok && (m_sink_offset == p_case->bin_size) && nrf_dfu_lz_is_complete(), what);
+    }
+
+    snprintf(what, sizeof(what), "%s: data after the end", p_case->p_dlz_name);
+    check(lz_init(p_case, null_sink) == NRF_SUCCESS, what);
+    check(nrf_dfu_lz_decode(p_case->p_dlz, p_case->dlz_size) == NRF_SUCCESS, what);
+    check(nrf_dfu_lz_decode(p_case->p_dlz, 1) == NRF_ERROR_INVALID_LENGTH, what);
+    check(nrf_dfu_lz_decode(p_case->p_dlz, 1) == NRF_ERROR_INVALID_STATE, what);
+
+    snprintf(what, sizeof(what), "%s: bad header", p_case->p_dlz_name);
+    memcpy(header, p_case->p_dlz, sizeof(header));
+    header[5] = NRF_DFU_LZ_WINDOW_BITS + 1;
+    check(lz_init(p_case, null_sink) == NRF_SUCCESS, what);
+    check(nrf_dfu_lz_decode(header, sizeof(header)) == NRF_ERROR_NOT_SUPPORTED, what);
+    header[5] = p_case->p_dlz[5];
+    header[0] = 'X';
+    check(lz_init(p_case, null_sink) == NRF_SUCCESS, what);
+    check(nrf_dfu_lz_decode(header, sizeof(header)) == NRF_ERROR_INVALID_DATA, what);
+
+    if (p_case->p_base != NULL)
+    {
+        snprintf(what, sizeof(what), "%s: wrong base", p_case->p_dlz_name);
+        check(nrf_dfu_lz_init(null_sink, p_case->p_base, p_case->base_size, 0) == NRF_SUCCESS, what);
+        check(nrf_dfu_lz_decode(p_case->p_dlz, p_case->dlz_size) == NRF_ERROR_INVALID_DATA, what);
+        check(nrf_dfu_lz_init(null_sink, NULL, 0, 0) == NRF_SUCCESS, what);
+        check(nrf_dfu_lz_decode(p_case->p_dlz, p_case->dlz_size) == NRF_ERROR_NOT_SUPPORTED, what);
+    }
+}
+
+
+// Corrupted images must fail, or decode to no more than the size in the header.
+static void case_corrupt(bench_case_t const * p_case)
+{
+    uint8_t * const p_copy = malloc(p_case->dlz_size);
+    uint32_t        failed = 0;
+    char            what[128];
+
+    snprintf(what, sizeof(what), "%s: corrupted image", p_case->p_dlz_name);
+    for (uint32_t run = 0; run < CORRUPT_RUNS; run++)
+    {
+        uint32_t const flips = 1 + (rand() % 4);
+        uint32_t const size  = (run % 4 == 0) ? (uint32_t)(rand() % p_case->dlz_size) : p_case->dlz_size;
+        uint32_t       err_code;
+
+        memcpy(p_copy, p_case->p_dlz, p_case->dlz_size);
+        for (uint32_t i = 0; i < flips; i++)
+        {
+            // Leave the header alone most of the time, to get past its checks.
+            uint32_t const pos = (run % 8 == 0) ? (rand() % p_case->dlz_size) :
+                                 NRF_DFU_LZ_HEADER_SIZE + (rand() % (p_case->dlz_size - NRF_DFU_LZ_HEADER_SIZE));
+            p_copy[pos] ^= (uint8_t)(1 + (rand() % 255));
+        }
+
+        m_sink_offset = 0;
+        m_sink_ok     = true;
+        (void)lz_init(p_case, bounded_sink);
+        err_code = lz_decode(p_copy, size, 0);
+        if (err_code != NRF_SUCCESS)
+        {
+            failed++;
+        }
+        check(m_sink_ok, what);
+        check((err_code != NRF_SUCCESS) || !nrf_dfu_lz_is_complete() ||
+              (m_sink_offset == nrf_dfu_lz_image_size_get()), what);
+    }
+    printf("    %u corrupted images, %u rejected\n", CORRUPT_RUNS, failed);
+    free(p_copy);
+}
+
+
+static void case_bench(bench_case_t const * p_case, uint32_t link_bps, uint32_t seconds)
+{
+    uint64_t const start = host_time_ns();
+    uint64_t       elapsed;
+    uint32_t       runs = 0;
+
+    do
+    {
+        (void)lz_init(p_case, null_sink);
+        (void)lz_decode(p_case->p_dlz, p_case->dlz_size, m_packet);
+        runs++;
+        elapsed = host_time_ns() - start;
+    }
+    while (elapsed < seconds * 1000000000ull);
+
+    printf("  %-16s %7u -> %7u bytes, ratio %5.2f%s\n",
+           p_case->p_dlz_name, p_case->bin_size, p_case->dlz_size,
+           (double)p_case->bin_size / p_case->dlz_size, (p_case->p_base != NULL) ? " (delta)" : "");
+    printf("    decode %.1f MB/s out, %.1f MB/s in; air time %.2f s instead of %.2f s\n",
+           (double)p_case->bin_size * runs / (elapsed * 1e-3),
+           (double)p_case->dlz_size * runs / (elapsed * 1e-3),
+           (double)p_case->dlz_size / link_bps, (double)p_case->bin_size / link_bps);
+}
+
+
+static void case_add(char * p_arg)
+{
+    bench_case_t * const p_case = &m_cases[m_case_count++];
+
+    p_case->p_dlz_name  = strtok(p_arg, ",");
+    p_case->p_bin_name  = strtok(NULL, ",");
+    p_case->p_base_name = strtok(NULL, ",");
+    if (p_case->p_bin_name == NULL)
+    {
+        fprintf(stderr, "case=<image.dlz>,<image.bin>[,<base.bin>]\n");
+        exit(2);
+    }
+
+    p_case->p_dlz = file_read(p_case->p_dlz_name, &p_case->dlz_size);
+    p_case->p_bin = file_read(p_case->p_bin_name, &p_case->bin_size);
+    if (p_case->p_base_name != NULL)
+    {
+        p_case->p_base = file_read(p_case->p_base_name, &p_case->base_size);
+    }
+    if ((p_case->dlz_size <= NRF_DFU_LZ_HEADER_SIZE) || (p_case->bin_size > BANK_SIZE))
+    {
+        fprintf(stderr, "%s: compressed image too short or image too large\n", p_case->p_dlz_name);
+        exit(2);
+    }
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t link_bps = LINK_BPS_DEFAULT;
+    uint32_t seconds  = SECONDS_DEFAULT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if ((strncmp(argv[i], "case=", 5) == 0) && (m_case_count < CASES_MAX))
+        {
+            case_add(argv[i] + 5);
+        }
+        else if (strncmp(argv[i], "packet=", 7) == 0)
+        {
+            m_packet = strtoul(argv[i] + 7, NULL, 0);
+        }
+        else if (strncmp(argv[i], "link_bps=", 9) == 0)
+        {
+            link_bps = strtoul(argv[i] + 9, NULL, 0);
+        }
+        else if (strncmp(argv[i], "seconds=", 8) == 0)
+        {
+            seconds = strtoul(argv[i] + 8, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s case=<image.dlz>,<image.bin>[,<base.bin>] ... "
+                            "[packet=<bytes>] [link_bps=<bytes/s>] [seconds=<s>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((m_case_count == 0) || (m_packet == 0) || (link_bps == 0))
+    {
+        fprintf(stderr, "at least one case, packet and link_bps more than 0\n");
+        return 2;
+    }
+
+    srand(1);
+    check(nrf_dfu_flash_init(false) == NRF_SUCCESS, "flash init");
+    check(nrf_dfu_lz_decode(m_cases[0].p_dlz, 1) == NRF_ERROR_INVALID_STATE, "decode before init");
+    check(nrf_dfu_lz_init(NULL, NULL, 0, 0) == NRF_ERROR_NULL, "init NULL");
+
+    printf("Window %u bytes, %u byte packets at %u bytes/s\n",
+           (unsigned)NRF_DFU_LZ_WINDOW_SIZE, m_packet, link_bps);
+    for (uint32_t i = 0; i < m_case_count; i++)
+    {
+        case_bench(&m_cases[i], link_bps, seconds);
+        case_flash(&m_cases[i]);
+        case_chunks(&m_cases[i]);
+        case_corrupt(&m_cases[i]);
+    }
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+
+    return (m_failures == 0) ? 0 : 1;
+}
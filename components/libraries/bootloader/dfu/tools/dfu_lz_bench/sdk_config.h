@@ -0,0 +1,27 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Configuration of the compressed DFU image benchmark. The values can be overridden from the
+ * make command line, for example: make run NRF_DFU_LZ_WINDOW_BITS=12 WINDOW_BITS=12 */
+
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+#define CRC32_ENABLED 1
+
+#ifndef CRC32_CONFIG_IMPLEMENTATION
+#define CRC32_CONFIG_IMPLEMENTATION 0
+#endif
+
+#define NRF_LOG_ENABLED 0
+
+#endif // SDK_CONFIG_H
@@ -0,0 +1,532 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host test and benchmark of the streaming DFU writes in nrf_dfu_stream.c.
+ *
+ * A firmware image is sent over a simulated link in packets, and written to the RAM flash
+ * emulator fstorage_ram.c through a host version of nrf_dfu_flash.c (below). The link, the CPU
+ * and the flash run in parallel in simulated time. The CPU time for copying, CRC-32 and SHA-256
+ * is charged per byte; the defaults are estimates for an nRF52832 at 64 MHz with the bitwise
+ * crc32_compute.
+ *
+ * Two ways of writing the image are compared:
+ * - staged: each object (DATA_OBJECT_MAX_SIZE) is erased, received into RAM, stored, waited for
+ *   and checked with crc32_compute over flash, while the link waits for the object to be
+ *   executed. When all objects are in flash, the CRC-32 and SHA-256 of the image are computed
+ *   over flash.
+ * - stream: each packet is passed to nrf_dfu_stream_write as it arrives. The link is held back
+ *   only while the CPU waits for a free buffer. After the last packet, nrf_dfu_stream_flush
+ *   waits for the flash, and the CRC-32 and SHA-256 are read from the stream.
+ *
+ * For each, the test checks the flash content, CRC-32 and SHA-256 against the image, and prints
+ * the transfer time and the validation time after the last packet. It also checks that a stream
+ * resumed from flash in the middle of the image gives the same result.
+ *
+ * Command line: size=<bytes> packet=<bytes> link_bps=<bytes/s> copy_ns=<ns/byte>
+ *               crc_ns=<ns/byte> sha_ns=<ns/byte>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "nrf_error.h"
+#include "nordic_common.h"
+#include "app_util.h"
+#include "fstorage.h"
+#include "fstorage_ram.h"
+#include "nrf_dfu_flash.h"
+#include "nrf_dfu_stream.h"
+#include "nrf_dfu_types.h"
+#include "crc32.h"
+#include "sha256.h"
+
+#define SIZE_DEFAULT        (100001)    // Not a multiple of a word, to test the padding.
+#define PACKET_DEFAULT      (20)        // ATT MTU of 23 bytes.
+#define LINK_BPS_DEFAULT    (16000)     // Six packets per 7.5 ms connection interval.
+#define COPY_NS_DEFAULT     (16)
+#define CRC_NS_DEFAULT      (780)       // Bitwise implementation, about 50 cycles per byte.
+#define SHA_NS_DEFAULT      (1560)      // About 100 cycles per byte.
+#define HASH_LEN            (32)
+#define NO_EVENT            (UINT64_MAX)
+
+#define FLASH_FLAG_OPER                 (1<<0)
+#define FLASH_FLAG_FAILURE_SINCE_LAST   (1<<1)
+
+typedef struct
+{
+    uint64_t total_ns;      // From the first packet to a validated image.
+    uint64_t validate_ns;   // From the last packet to a validated image.
+    uint64_t cpu_ns;        // Time the CPU was busy copying and hashing.
+    uint64_t wait_ns;       // Time the CPU waited for the flash.
+} result_t;
+
+static uint32_t m_size     = SIZE_DEFAULT;
+static uint32_t m_packet   = PACKET_DEFAULT;
+static uint64_t m_copy_ns  = COPY_NS_DEFAULT;
+static uint64_t m_crc_ns   = CRC_NS_DEFAULT;
+static uint64_t m_sha_ns   = SHA_NS_DEFAULT;
+static uint64_t m_pkt_ns;                       // Time to send one packet over the link.
+
+static uint8_t * mp_image;
+static uint32_t  m_image_crc;
+static uint8_t   m_image_hash[HASH_LEN];
+
+static uint64_t m_now;
+static uint64_t m_flash_end = NO_EVENT;         // When the flash chunk in progress completes.
+static uint32_t m_flash_flags;
+static result_t m_result;
+
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+
+static void fs_evt_handler(fs_evt_t const * const evt, fs_ret_t result);
+
+FS_REGISTER_CFG(fs_config_t fs_dfu_config) =
+{
+    .callback  = fs_evt_handler,
+    .num_pages = FS_RAM_PAGES,
+};
+
+
+static void check(bool ok, char const * p_what)
+{
+    m_checks++;
+    if (!ok)
+    {
+        if (m_failures < 20)
+        {
+            printf("FAILED: %s\n", p_what);
+        }
+        m_failures++;
+    }
+}
+
+
+// Starts the next flash chunk if the flash is idle.
+static void flash_kick(void)
+{
+    if ((m_flash_end == NO_EVENT) && !fs_queue_is_empty())
+    {
+        m_flash_end = m_now + fs_ram_chunk_time_get() * 1000ull;
+    }
+}
+
+
+// Advances the simulated time, completing the flash chunks which end before it.
+static void time_advance(uint64_t until)
+{
+    flash_kick();
+    while (m_flash_end <= until)
+    {
+        m_now       = m_flash_end;
+        m_flash_end = NO_EVENT;
+        (void)fs_ram_process();
+        flash_kick();
+    }
+    if (until > m_now)
+    {
+        m_now = until;
+    }
+}
+
+
+static void cpu_run(uint64_t ns)
+{
+    m_result.cpu_ns += ns;
+    time_advance(m_now + ns);
+}
+
+
+/* Host version of nrf_dfu_flash.c, as with the SoftDevice enabled: fstorage runs the operations
+ * in the background, and nrf_dfu_flash_wait sleeps until the next flash event. */
+
+static void fs_evt_handler(fs_evt_t const * const evt, fs_ret_t result)
+{
+    m_flash_flags &= ~FLASH_FLAG_OPER;
+    if (result != FS_SUCCESS)
+    {
+        m_flash_flags |= FLASH_FLAG_FAILURE_SINCE_LAST;
+    }
+
+    if (evt->p_context)
+    {
+        ((dfu_flash_callback_t)evt->p_context)(evt, result);
+    }
+}
+
+
+uint32_t nrf_dfu_flash_init(bool sd_enabled)
+{
+    m_flash_flags = 0;
+    return (fs_init() == FS_SUCCESS) ? NRF_SUCCESS : NRF_ERROR_INVALID_STATE;
+}
+
+
+fs_ret_t nrf_dfu_flash_store(uint32_t const * p_dest, uint32_t const * const p_src, uint32_t len_words, dfu_flash_callback_t callback)
+{
+    fs_ret_t ret_val;
+
+    if ((m_flash_flags & FLASH_FLAG_FAILURE_SINCE_LAST) != 0)
+    {
+        return FS_ERR_FAILURE_SINCE_LAST;
+    }
+
+    ret_val = fs_store(&fs_dfu_config, p_dest, p_src, len_words, (void *)callback);
+    if (ret_val == FS_SUCCESS)
+    {
+        m_flash_flags |= FLASH_FLAG_OPER;
+    }
+    return ret_val;
+}
+
+
+fs_ret_t nrf_dfu_flash_erase(uint32_t const * p_dest, uint32_t num_pages, dfu_flash_callback_t callback)
+{
+    fs_ret_t ret_val;
+
+    if ((m_flash_flags & FLASH_FLAG_FAILURE_SINCE_LAST) != 0)
+    {
+        return FS_ERR_FAILURE_SINCE_LAST;
+    }
+
+    ret_val = fs_erase(&fs_dfu_config, p_dest, num_pages, (void *)callback);
+    if (ret_val == FS_SUCCESS)
+    {
+        m_flash_flags |= FLASH_FLAG_OPER;
+    }
+    return ret_val;
+}
+
+
+void nrf_dfu_flash_error_clear(void)
+{
+    m_flash_flags &= ~FLASH_FLAG_FAILURE_SINCE_LAST;
+}
+
+
+fs_ret_t nrf_dfu_flash_wait(void)
+{
+    uint64_t const start = m_now;
+
+    // Like sd_app_evt_wait, return after the next flash event.
+    flash_kick();
+    if (m_flash_end != NO_EVENT)
+    {
+        time_advance(m_flash_end);
+    }
+    m_result.wait_ns += m_now - start;
+
+    return ((m_flash_flags & FLASH_FLAG_FAILURE_SINCE_LAST) != 0) ? FS_ERR_FAILURE_SINCE_LAST
+                                                                   : FS_SUCCESS;
+}
+
+
+// Waits for all queued flash operations, like nrf_dfu_flash_wait on the target.
+static fs_ret_t flash_wait_all(void)
+{
+    fs_ret_t ret_val = FS_SUCCESS;
+
+    while (!fs_queue_is_empty() && (ret_val == FS_SUCCESS))
+    {
+        ret_val = nrf_dfu_flash_wait();
+    }
+    return ret_val;
+}
+
+
+static uint32_t const * bank_get(void)
+{
+    return fs_dfu_config.p_start_addr;
+}
+
+
+static void hash_compute(uint8_t const * p_data, uint32_t len, uint8_t * p_hash)
+{
+    sha256_context_t ctx;
+
+    (void)sha256_init(&ctx);
+    (void)sha256_update(&ctx, p_data, len);
+    (void)sha256_final(&ctx, p_hash, 0);
+}
+
+
+static void image_check(char const * p_mode, uint32_t crc, uint8_t const * p_hash)
+{
+    char what[64];
+
+    snprintf(what, sizeof(what), "%s: image in flash", p_mode);
+    check(memcmp(bank_get(), mp_image, m_size) == 0, what);
+    snprintf(what, sizeof(what), "%s: padding", p_mode);
+    check((m_size % 4 == 0) || (((uint8_t const *)bank_get())[m_size] == 0xFF), what);
+    snprintf(what, sizeof(what), "%s: CRC-32", p_mode);
+    check(crc == m_image_crc, what);
+    snprintf(what, sizeof(what), "%s: SHA-256", p_mode);
+    check(memcmp(p_hash, m_image_hash, HASH_LEN) == 0, what);
+}
+
+
+static void bank_erase(void)
+{
+    uint32_t const pages = CEIL_DIV(m_size, CODE_PAGE_SIZE);
+
+    check(nrf_dfu_flash_erase(bank_get(), pages, NULL) == FS_SUCCESS, "erase bank");
+    fs_ram_run();
+    m_flash_end = NO_EVENT;
+    m_flash_flags &= ~FLASH_FLAG_OPER;
+}
+
+
+static void result_start(void)
+{
+    memset(&m_result, 0, sizeof(m_result));
+    m_now = 0;
+}
+
+
+static void result_print(char const * p_mode)
+{
+    fs_ram_stats_t stats;
+
+    fs_ram_stats_get(&stats);
+    printf("  %-7s %8.3f s  %6.1f kB/s  validation %8.3f ms  CPU %5.1f %%  flash wait %8.3f ms  "
+           "%u stores, %u erases\n",
+           p_mode, m_result.total_ns * 1e-9, m_size / (m_result.total_ns * 1e-6),
+           m_result.validate_ns * 1e-6, 100.0 * m_result.cpu_ns / m_result.total_ns,
+           m_result.wait_ns * 1e-6, stats.store_ops, stats.erase_ops);
+}
+
+
+static void run_staged(void)
+{
+    static uint32_t object[DATA_OBJECT_MAX_SIZE / sizeof(uint32_t)];
+    uint32_t const * const p_bank = bank_get();
+    uint64_t last_pkt = 0;
+    uint32_t crc;
+    uint8_t  hash[HASH_LEN];
+
+    result_start();
+    fs_ram_stats_reset();
+
+    for (uint32_t obj = 0; obj < m_size; obj += DATA_OBJECT_MAX_SIZE)
+    {
+        uint32_t const obj_len = MIN(m_size - obj, DATA_OBJECT_MAX_SIZE);
+        uint32_t const * const p_obj = p_bank + (obj / sizeof(uint32_t));
+        uint64_t link_free;
+        uint32_t obj_crc;
+
+        // Create: erase the object's pages.
+        check(nrf_dfu_flash_erase(p_obj, CEIL_DIV(obj_len, CODE_PAGE_SIZE), NULL) == FS_SUCCESS,
+              "staged: erase");
+        check(flash_wait_all() == FS_SUCCESS, "staged: erase wait");
+
+        // Write: receive the object into RAM.
+        link_free = m_now;
+        for (uint32_t pos = 0; pos < obj_len; pos += m_packet)
+        {
+            uint32_t const len = MIN(obj_len - pos, m_packet);
+
+            time_advance(link_free + m_pkt_ns);
+            link_free = m_now;
+            memcpy((uint8_t *)object + pos, &mp_image[obj + pos], len);
+            cpu_run(len * m_copy_ns);
+        }
+        last_pkt = link_free;
+        memset((uint8_t *)object + obj_len, 0xFF, CEIL_DIV(obj_len, 4) * 4 - obj_len);
+
+        // Execute: store the object, wait for it and check it in flash. The link waits for
+        // the response.
+        check(nrf_dfu_flash_store(p_obj, object, CEIL_DIV(obj_len, 4), NULL) == FS_SUCCESS,
+              "staged: store");
+        check(flash_wait_all() == FS_SUCCESS, "staged: store wait");
+        obj_crc = crc32_compute((uint8_t const *)p_obj, obj_len, NULL);
+        cpu_run(obj_len * m_crc_ns);
+        check(obj_crc == crc32_compute(&mp_image[obj], obj_len, NULL), "staged: object CRC-32");
+    }
+
+    // Validate the image in flash.
+    crc = crc32_compute((uint8_t const *)p_bank, m_size, NULL);
+    hash_compute((uint8_t const *)p_bank, m_size, hash);
+    cpu_run(m_size * (m_crc_ns + m_sha_ns));
+
+    m_result.total_ns    = m_now;
+    m_result.validate_ns = m_now - last_pkt;
+
+    image_check("staged", crc, hash);
+    result_print("staged");
+}
+
+
+// Streams the image from offset start; when stop is not the size, stops there as if reset.
+static void stream_run(uint32_t start, uint32_t stop)
+{
+    uint64_t link_free = m_now;         // When the link starts sending the next packet.
+
+    check(nrf_dfu_stream_init(bank_get(), start) == NRF_SUCCESS, "stream: init");
+    check(nrf_dfu_stream_offset_get() == (start & ~3u), "stream: init offset");
+    start &= ~3u;
+
+    for (uint32_t pos = start; pos < stop; pos += m_packet)
+    {
+        uint32_t const len = MIN(stop - pos, m_packet);
+
+        // The link sends the next packet while the CPU handles this one.
+        time_advance(link_free + m_pkt_ns);
+        link_free = m_now;
+        cpu_run(len * (m_copy_ns + m_crc_ns + m_sha_ns));
+        check(nrf_dfu_stream_write(&mp_image[pos], len) == NRF_SUCCESS, "stream: write");
+    }
+
+    if (stop < m_size)
+    {
+        // Let the flash finish, as if the device had been idle before the reset.
+        check(flash_wait_all() == FS_SUCCESS, "stream: wait before reset");
+        return;
+    }
+
+    check(nrf_dfu_stream_flush() == NRF_SUCCESS, "stream: flush");
+    check(nrf_dfu_stream_offset_get() == m_size, "stream: offset");
+
+    m_result.total_ns    = m_now;
+    m_result.validate_ns = m_now - link_free;
+}
+
+
+static void run_stream(void)
+{
+    uint8_t hash[HASH_LEN];
+    uint8_t byte = 0;
+
+    result_start();
+    fs_ram_stats_reset();
+
+    stream_run(0, m_size);
+    nrf_dfu_stream_hash_get(hash, 0);
+    image_check("stream", nrf_dfu_stream_crc_get(), hash);
+    result_print("stream");
+
+    if (m_size % 4 != 0)
+    {
+        check(nrf_dfu_stream_write(&byte, 1) == NRF_ERROR_INVALID_STATE, "stream: write after padding");
+    }
+}
+
+
+// Interrupts a stream in the middle of a page, and resumes it from what is in flash.
+static void run_resume(void)
+{
+    uint32_t const stop = ((m_size / 2) & ~3u) + CODE_PAGE_SIZE / 2 + 8;
+    uint8_t hash[HASH_LEN];
+
+    bank_erase();
+    result_start();
+    stream_run(0, MIN(stop, m_size));
+    // A partly filled buffer is lost in the reset; resume from the last full one.
+    stream_run((stop / NRF_DFU_STREAM_BUF_SIZE) * NRF_DFU_STREAM_BUF_SIZE, m_size);
+    nrf_dfu_stream_hash_get(hash, 0);
+    image_check("resume", nrf_dfu_stream_crc_get(), hash);
+}
+
+
+static void api_test(void)
+{
+    uint8_t byte = 0;
+
+    check(nrf_dfu_stream_write(&byte, 1) == NRF_ERROR_INVALID_STATE, "write before init");
+    check(nrf_dfu_stream_flush() == NRF_ERROR_INVALID_STATE, "flush before init");
+    check(nrf_dfu_stream_init(NULL, 0) == NRF_ERROR_NULL, "init NULL");
+    check(nrf_dfu_stream_init(bank_get() + 1, 0) == NRF_ERROR_INVALID_ADDR, "init unaligned");
+    check(nrf_dfu_stream_init(bank_get(), 0) == NRF_SUCCESS, "init");
+    check(nrf_dfu_stream_write(NULL, 1) == NRF_ERROR_NULL, "write NULL");
+    check(nrf_dfu_stream_write(NULL, 0) == NRF_SUCCESS, "write nothing");
+    check(nrf_dfu_stream_crc_get() == crc32_compute(&byte, 0, NULL), "CRC-32 of nothing");
+    check(nrf_dfu_stream_flush() == NRF_SUCCESS, "flush nothing");
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t link_bps = LINK_BPS_DEFAULT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "size=", 5) == 0)
+        {
+            m_size = strtoul(argv[i] + 5, NULL, 0);
+        }
+        else if (strncmp(argv[i], "packet=", 7) == 0)
+        {
+            m_packet = strtoul(argv[i] + 7, NULL, 0);
+        }
+        else if (strncmp(argv[i], "link_bps=", 9) == 0)
+        {
+            link_bps = strtoul(argv[i] + 9, NULL, 0);
+        }
+        else if (strncmp(argv[i], "copy_ns=", 8) == 0)
+        {
+            m_copy_ns = strtoull(argv[i] + 8, NULL, 0);
+        }
+        else if (strncmp(argv[i], "crc_ns=", 7) == 0)
+        {
+            m_crc_ns = strtoull(argv[i] + 7, NULL, 0);
+        }
+        else if (strncmp(argv[i], "sha_ns=", 7) == 0)
+        {
+            m_sha_ns = strtoull(argv[i] + 7, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [size=<bytes>] [packet=<bytes>] [link_bps=<bytes/s>] "
+                            "[copy_ns=<ns/byte>] [crc_ns=<ns/byte>] [sha_ns=<ns/byte>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((m_size < 2 * CODE_PAGE_SIZE) || (m_size >= FS_RAM_PAGES * CODE_PAGE_SIZE) ||
+        (m_packet == 0) || (link_bps == 0))
+    {
+        fprintf(stderr, "size must be %u to %u bytes, packet and link_bps more than 0\n",
+                (unsigned)(2 * CODE_PAGE_SIZE), (unsigned)(FS_RAM_PAGES * CODE_PAGE_SIZE - 1));
+        return 2;
+    }
+
+    mp_image = malloc(m_size);
+    if (mp_image == NULL)
+    {
+        return 2;
+    }
+    srand(1);
+    for (uint32_t i = 0; i < m_size; i++)
+    {
+        mp_image[i] = (uint8_t)rand();
+    }
+    m_image_crc = crc32_compute(mp_image, m_size, NULL);
+    hash_compute(mp_image, m_size, m_image_hash);
+    m_pkt_ns = m_packet * 1000000000ull / link_bps;
+
+    check(nrf_dfu_flash_init(true) == NRF_SUCCESS, "flash init");
+    api_test();
+    bank_erase();
+
+    printf("%u bytes in %u byte packets at %u bytes/s, buffers of %u bytes, "
+           "copy %u ns, CRC-32 %u ns, SHA-256 %u ns per byte\n",
+           m_size, m_packet, link_bps, (unsigned)NRF_DFU_STREAM_BUF_SIZE,
+           (unsigned)m_copy_ns, (unsigned)m_crc_ns, (unsigned)m_sha_ns);
+    run_staged();
+    bank_erase();
+    run_stream();
+    run_resume();
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+
+    free(mp_image);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Configuration of the streaming DFU benchmark. The values can be overridden from the make
+ * command line, for example: make run NRF_DFU_STREAM_BUF_SIZE=4096 */
+
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+#define CRC32_ENABLED 1
+
+#ifndef CRC32_CONFIG_IMPLEMENTATION
+#define CRC32_CONFIG_IMPLEMENTATION 0
+#endif
+
+#define FSTORAGE_ENABLED 1
+
+#ifndef FS_QUEUE_SIZE
+#define FS_QUEUE_SIZE 4
+#endif
+
+#ifndef FS_OP_MAX_RETRIES
+#define FS_OP_MAX_RETRIES 3
+#endif
+
+#ifndef FS_MAX_WRITE_SIZE_WORDS
+#define FS_MAX_WRITE_SIZE_WORDS 256
+#endif
+
+// Room for images up to 252 kB.
+#ifndef FS_RAM_PAGES
+#define FS_RAM_PAGES 64
+#endif
+
+#define NRF_LOG_ENABLED 0
+
+#endif // SDK_CONFIG_H
@@ -12,5 +12,20 @@
  */
 #define CRC16_ENABLED
 
+/** @brief Implementation of crc16_compute.
+ *
+ * Larger tables trade flash for speed. All implementations give the same result.
+ *
+ *  Following options are available:
+ * - 0 - Bitwise (no table)
+ * - 1 - Nibble table (32 bytes)
+ * - 2 - Byte table (512 bytes)
+ * - 3 - Slice-by-4 (2048 bytes)
+ * - 4 - Slice-by-8 (4096 bytes)
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define CRC16_CONFIG_IMPLEMENTATION
+
 
 /** @} */
@@ -28,6 +28,19 @@
 extern "C" {
 #endif
 
+/**@name Implementations of @ref crc32_compute, selected with CRC32_CONFIG_IMPLEMENTATION.
+ *
+ * All implementations give the same result. They trade flash for speed: the bitwise one has no
+ * table, the nibble one a 16-entry table, the byte one a 256-entry table and the slice-by-4 and
+ * slice-by-8 ones four and eight 256-entry tables, with which they consume 4 or 8 bytes per step.
+ * @{ */
+#define CRC32_IMPLEMENTATION_BITWISE    0   /**< Bit by bit, no table. */
+#define CRC32_IMPLEMENTATION_NIBBLE     1   /**< 16-entry table (64 bytes). */
+#define CRC32_IMPLEMENTATION_BYTE       2   /**< 256-entry table (1024 bytes). */
+#define CRC32_IMPLEMENTATION_SLICE_BY_4 3   /**< Four 256-entry tables (4096 bytes). */
+#define CRC32_IMPLEMENTATION_SLICE_BY_8 4   /**< Eight 256-entry tables (8192 bytes). */
+/** @} */
+
 /**@brief Function for calculating CRC-32 in blocks.
  *
  * Feed each consecutive data block into this function, along with the current value of p_crc as
@@ -12,5 +12,20 @@
  */
 #define CRC32_ENABLED
 
+/** @brief Implementation of crc32_compute.
+ *
+ * Larger tables trade flash for speed. All implementations give the same result.
+ *
+ *  Following options are available:
+ * - 0 - Bitwise (no table)
+ * - 1 - Nibble table (64 bytes)
+ * - 2 - Byte table (1024 bytes)
+ * - 3 - Slice-by-4 (4096 bytes)
+ * - 4 - Slice-by-8 (8192 bytes)
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define CRC32_CONFIG_IMPLEMENTATION
+
 
 /** @} */
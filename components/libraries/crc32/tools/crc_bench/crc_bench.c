@@ -0,0 +1,220 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* CRC benchmark for a PC host.
+ *
+ * Checks crc16_compute() and crc32_compute(), as built with the implementation selected by
+ * CRC16_CONFIG_IMPLEMENTATION and CRC32_CONFIG_IMPLEMENTATION, against bit-by-bit reference
+ * functions in this file: the check values of "123456789", buffers at every alignment and
+ * chained calls split at random lengths. Then prints the throughput of each function over one
+ * buffer.
+ *
+ * Command line: size=<bytes> rounds=<n>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "crc16.h"
+#include "crc32.h"
+
+
+#define SIZE_DEFAULT    (65536)
+#define ROUNDS_DEFAULT  (200)
+#define CHECK_SIZE      (1024)  // Size of the buffers checked against the reference.
+#define CHECK_SPLITS    (2000)  // Random splits into chained calls.
+
+
+static char const * const m_impl_names[] =
+{
+    "bitwise", "nibble table", "byte table", "slice-by-4", "slice-by-8"
+};
+
+static uint32_t m_rand = 1;
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+static volatile uint32_t m_sink;    // Results are stored so that the calls are not optimized away.
+
+
+static void check(bool ok, char const * p_what)
+{
+    m_checks++;
+    if (!ok)
+    {
+        m_failures++;
+        printf("FAILED: %s\n", p_what);
+    }
+}
+
+
+static uint32_t bench_rand(void)
+{
+    m_rand = (m_rand * 1103515245UL) + 12345UL;
+    return (m_rand >> 16);
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+// CRC-16-CCITT, polynomial 0x1021, MSB first, initial value 0xFFFF.
+static uint16_t crc16_reference(uint8_t const * p_data, uint32_t size, uint16_t crc)
+{
+    for (uint32_t i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)(p_data[i] << 8);
+        for (uint32_t j = 0; j < 8; j++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+
+// CRC-32, reflected polynomial 0xEDB88320, initial value and final XOR 0xFFFFFFFF.
+static uint32_t crc32_reference(uint8_t const * p_data, uint32_t size)
+{
+    uint32_t crc = 0xFFFFFFFF;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        crc ^= p_data[i];
+        for (uint32_t j = 0; j < 8; j++)
+        {
+            crc = (crc & 1) ? ((crc >> 1) ^ 0xEDB88320) : (crc >> 1);
+        }
+    }
+    return ~crc;
+}
+
+
+static void crc_check(uint8_t const * p_buf)
+{
+    static uint8_t const check_string[] = "123456789";
+
+    check(crc16_compute(check_string, 9, NULL) == 0x29B1, "crc16 check value");
+    check(crc32_compute(check_string, 9, NULL) == 0xCBF43926, "crc32 check value");
+    check(crc16_compute(check_string, 0, NULL) == 0xFFFF, "crc16 of nothing");
+    check(crc32_compute(check_string, 0, NULL) == 0, "crc32 of nothing");
+
+    // The table implementations have a separate path for aligned words.
+    for (uint32_t offset = 0; offset < 8; offset++)
+    {
+        for (uint32_t size = 0; size < 24; size++)
+        {
+            check(crc16_compute(p_buf + offset, size, NULL) == crc16_reference(p_buf + offset, size, 0xFFFF),
+                  "crc16 at offset");
+            check(crc32_compute(p_buf + offset, size, NULL) == crc32_reference(p_buf + offset, size),
+                  "crc32 at offset");
+        }
+    }
+
+    uint16_t const crc16_expected = crc16_reference(p_buf, CHECK_SIZE, 0xFFFF);
+    uint32_t const crc32_expected = crc32_reference(p_buf, CHECK_SIZE);
+
+    for (uint32_t i = 0; i < CHECK_SPLITS; i++)
+    {
+        uint32_t offset = 0;
+        uint16_t crc16  = 0;
+        uint32_t crc32  = 0;
+
+        while (offset < CHECK_SIZE)
+        {
+            uint32_t len = bench_rand() % 37;
+
+            if (len > CHECK_SIZE - offset)
+            {
+                len = CHECK_SIZE - offset;
+            }
+            crc16 = crc16_compute(p_buf + offset, len, (offset == 0) ? NULL : &crc16);
+            crc32 = crc32_compute(p_buf + offset, len, (offset == 0) ? NULL : &crc32);
+            offset += len;
+        }
+        check(crc16 == crc16_expected, "crc16 chained");
+        check(crc32 == crc32_expected, "crc32 chained");
+    }
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t size   = SIZE_DEFAULT;
+    uint32_t rounds = ROUNDS_DEFAULT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "size=", 5) == 0)
+        {
+            size = strtoul(argv[i] + 5, NULL, 0);
+        }
+        else if (strncmp(argv[i], "rounds=", 7) == 0)
+        {
+            rounds = strtoul(argv[i] + 7, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [size=<bytes>] [rounds=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((size == 0) || (rounds == 0))
+    {
+        fprintf(stderr, "size and rounds must be more than 0\n");
+        return 2;
+    }
+
+    uint32_t const buf_size = (size > CHECK_SIZE + 8) ? size : CHECK_SIZE + 8;
+    uint8_t      * p_buf    = malloc(buf_size);
+    if (p_buf == NULL)
+    {
+        return 2;
+    }
+    for (uint32_t i = 0; i < buf_size; i++)
+    {
+        p_buf[i] = (uint8_t)bench_rand();
+    }
+
+    crc_check(p_buf);
+
+    uint64_t start = host_time_ns();
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        m_sink = crc16_compute(p_buf, size, NULL);
+    }
+    uint64_t const crc16_ns = host_time_ns() - start;
+
+    start = host_time_ns();
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        m_sink = crc32_compute(p_buf, size, NULL);
+    }
+    uint64_t const crc32_ns = host_time_ns() - start;
+
+    double const mbytes = (double)size * rounds / 1e6;
+
+    printf("%-12s  crc16 %7.1f MB/s  crc32 %7.1f MB/s  (%u bytes, %u checks, %u failures)\n",
+           m_impl_names[CRC32_CONFIG_IMPLEMENTATION],
+           mbytes / (crc16_ns * 1e-9), mbytes / (crc32_ns * 1e-9),
+           size, m_checks, m_failures);
+
+    free(p_buf);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -44,6 +44,15 @@ static fds_tl_t const m_fds_tl_dirty =
     .length_words = 0xFFFF  // Leave the record length field unchanged in flash.
 };
 
+#if (FDS_TXN_MAX_RECORDS > 0)
+// Used to commit a transaction. Any file ID other than FDS_FILE_ID_INVALID commits it.
+static fds_ic_t const m_fds_ic_commit =
+{
+    .file_id = 0x0000,
+    .crc16   = 0x0000
+};
+#endif
+
 // Internal status flags.
 static uint8_t              m_flags;
 
@@ -65,6 +74,19 @@ static fds_swap_page_t      m_swap_page;
 // Garbage collection data.
 static fds_gc_data_t        m_gc;
 
+// The number of times each virtual page was erased since initialization, in flash order.
+static uint32_t             m_erase_count[FDS_VIRTUAL_PAGES];
+
+#if (FDS_RECORD_INDEX_SIZE > 0)
+// Index of the valid records, used to find records without scanning flash.
+static fds_index_t          m_index;
+#endif
+
+#if (FDS_TXN_MAX_RECORDS > 0)
+// The queued transaction.
+static fds_txn_t            m_txn;
+#endif
+
 
 static void flag_set(fds_flags_t flag)
 {
@@ -140,6 +162,14 @@ static void event_prepare(fds_op_t const * const p_op, fds_evt_t * const p_evt)
             p_evt->id = FDS_EVT_GC;
             break;
 
+#if (FDS_TXN_MAX_RECORDS > 0)
+        case FDS_OP_TXN:
+            p_evt->id                   = FDS_EVT_TXN;
+            p_evt->txn.record_count     = m_txn.count;
+            p_evt->txn.records_replaced = p_op->txn.replaced;
+            break;
+#endif
+
         default:
             // Should not happen.
             break;
@@ -147,10 +177,49 @@ static void event_prepare(fds_op_t const * const p_op, fds_evt_t * const p_evt)
 }
 
 
+// FDS_RECORD_KEY_TXN is reserved for transaction headers only if transactions are enabled.
+// Otherwise it is an ordinary record key.
+static bool record_key_is_txn(uint16_t record_key)
+{
+#if (FDS_TXN_MAX_RECORDS > 0)
+    return (record_key == FDS_RECORD_KEY_TXN);
+#else
+    UNUSED_PARAMETER(record_key);
+    return false;
+#endif
+}
+
+
 static bool header_is_valid(fds_header_t const * const p_header)
 {
-    return ((p_header->ic.file_id    != FDS_FILE_ID_INVALID) &&
-            (p_header->tl.record_key != FDS_RECORD_KEY_DIRTY));
+    return ((p_header->ic.file_id    != FDS_FILE_ID_INVALID)  &&
+            (p_header->tl.record_key != FDS_RECORD_KEY_DIRTY) &&
+            !record_key_is_txn(p_header->tl.record_key));
+}
+
+
+// A transaction header is committed once its file ID has been written.
+// The records of a committed transaction are valid.
+static bool txn_is_committed(fds_header_t const * const p_header)
+{
+    return ((p_header->ic.file_id != FDS_FILE_ID_INVALID)  &&
+            record_key_is_txn(p_header->tl.record_key)    &&
+            (p_header->record_id  <= p_header->tl.length_words));
+}
+
+
+// Returns the number of words from a record header to the next one. The records of a committed
+// transaction are nested in it, so only the transaction header and the IDs of the records it
+// replaced are skipped. Everything else, including uncommitted transactions, is skipped whole.
+static uint16_t header_skip_words(fds_header_t const * const p_header)
+{
+    if (txn_is_committed(p_header))
+    {
+        // The record ID field holds the number of replaced records.
+        return (FDS_HEADER_SIZE + p_header->record_id);
+    }
+
+    return (FDS_HEADER_SIZE + p_header->tl.length_words);
 }
 
 
@@ -277,8 +346,8 @@ static void page_scan(uint32_t const *       p_addr,
         }
 
         // Jump to the next record.
-        p_addr         += (FDS_HEADER_SIZE + p_header->tl.length_words);
-        *words_written += (FDS_HEADER_SIZE + p_header->tl.length_words);
+        p_addr         += header_skip_words(p_header);
+        *words_written += header_skip_words(p_header);
     }
 
     if (can_gc != NULL)
@@ -313,6 +382,27 @@ static ret_code_t page_tag_write_data(uint32_t const * const p_page_addr)
 }
 
 
+// Returns the position of a page in flash, which does not change when pages are swapped.
+static uint16_t page_flash_index(uint32_t const * const p_page_addr)
+{
+    return (uint16_t)((p_page_addr - fs_config.p_start_addr) / FDS_PAGE_SIZE);
+}
+
+
+// Erases a page and counts the erase.
+static ret_code_t page_erase(uint32_t const * const p_page_addr)
+{
+    ret_code_t const ret = fs_erase(&fs_config, p_page_addr, FDS_PHY_PAGES_IN_VPAGE, NULL);
+
+    if (ret == FS_SUCCESS)
+    {
+        m_erase_count[page_flash_index(p_page_addr)]++;
+    }
+
+    return ret;
+}
+
+
 // Reserve space on a page.
 // NOTE: this function takes into the account the space required for the record header.
 static ret_code_t write_space_reserve(uint16_t length_words, uint16_t * p_page)
@@ -375,7 +465,7 @@ static bool record_find_next(uint16_t page, uint32_t const ** p_record)
     if (p_next_rec != NULL)
     {
         p_header    = ((fds_header_t*)p_next_rec);
-        p_next_rec += (FDS_HEADER_SIZE + p_header->tl.length_words);
+        p_next_rec += header_skip_words(p_header);
     }
     else
     {
@@ -397,7 +487,7 @@ static bool record_find_next(uint16_t page, uint32_t const ** p_record)
         else
         {
             // The record is not valid, jump to the next.
-            p_next_rec += (FDS_HEADER_SIZE + (p_header->tl.length_words));
+            p_next_rec += header_skip_words(p_header);
         }
     }
 
@@ -406,6 +496,243 @@ static bool record_find_next(uint16_t page, uint32_t const ** p_record)
 }
 
 
+#if (FDS_RECORD_INDEX_SIZE > 0)
+
+#define FDS_INDEX_MASK  (FDS_RECORD_INDEX_SIZE - 1)
+
+
+static uint16_t index_hash(uint16_t file_id, uint16_t record_key)
+{
+    // Fibonacci hashing: the multiplication mixes all key bits into the middle bits.
+    uint32_t const key = ((uint32_t)file_id << 16) | record_key;
+    return (uint16_t)(((key * 0x9E3779B1UL) >> 16) & FDS_INDEX_MASK);
+}
+
+
+// Add a record to the index, unless it is already in it.
+// If the index is full, it is marked as invalid and lookups fall back to scanning flash.
+// NOTE: Must be called from within a critical section.
+static void index_insert(uint32_t const * const p_record)
+{
+    fds_header_t const * const p_header = (fds_header_t*)p_record;
+    uint16_t                   i;
+
+    if (!m_index.is_valid)
+    {
+        return;
+    }
+
+    i = index_hash(p_header->ic.file_id, p_header->tl.record_key);
+
+    while (m_index.entry[i].p_record != NULL)
+    {
+        if (m_index.entry[i].p_record == p_record)
+        {
+            return;
+        }
+        i = (i + 1) & FDS_INDEX_MASK;
+    }
+
+    // Keep one entry free, so that probing always terminates.
+    if (m_index.count == FDS_RECORD_INDEX_SIZE - 1)
+    {
+        m_index.is_valid = false;
+        return;
+    }
+
+    m_index.entry[i].p_record   = p_record;
+    m_index.entry[i].file_id    = p_header->ic.file_id;
+    m_index.entry[i].record_key = p_header->tl.record_key;
+    m_index.count++;
+}
+
+
+// Remove a record from the index, if it is in it.
+// NOTE: Must be called from within a critical section.
+static void index_remove(uint32_t const * const p_record)
+{
+    fds_header_t const * const p_header = (fds_header_t*)p_record;
+    uint16_t                   i;
+    uint16_t                   j;
+
+    if (!m_index.is_valid)
+    {
+        return;
+    }
+
+    i = index_hash(p_header->ic.file_id, p_header->tl.record_key);
+
+    while (m_index.entry[i].p_record != p_record)
+    {
+        if (m_index.entry[i].p_record == NULL)
+        {
+            return;
+        }
+        i = (i + 1) & FDS_INDEX_MASK;
+    }
+
+    // Shift back the following entries of the probe sequence which may not be placed between
+    // their home position and the free entry, so that no tombstones are needed.
+    for (j = (i + 1) & FDS_INDEX_MASK;
+         m_index.entry[j].p_record != NULL;
+         j = (j + 1) & FDS_INDEX_MASK)
+    {
+        uint16_t const home = index_hash(m_index.entry[j].file_id, m_index.entry[j].record_key);
+
+        if (((j - home) & FDS_INDEX_MASK) >= ((j - i) & FDS_INDEX_MASK))
+        {
+            m_index.entry[i] = m_index.entry[j];
+            i = j;
+        }
+    }
+
+    m_index.entry[i].p_record = NULL;
+    m_index.count--;
+}
+
+
+// Build the index from the records in the data pages.
+static void index_build(void)
+{
+    CRITICAL_SECTION_ENTER();
+    memset(&m_index, 0x00, sizeof(m_index));
+    m_index.is_valid = true;
+
+    for (uint16_t page = 0; (page < FDS_MAX_PAGES) && m_index.is_valid; page++)
+    {
+        uint32_t const * p_record = NULL;
+
+        if (m_pages[page].page_type != FDS_PAGE_DATA)
+        {
+            continue;
+        }
+
+        while (record_find_next(page, &p_record))
+        {
+            index_insert(p_record);
+        }
+    }
+    CRITICAL_SECTION_EXIT();
+}
+
+
+// Find the next record with the given file ID and record key, in the same order as a flash scan.
+// Returns false if the index is not valid and flash must be scanned instead.
+static bool index_find(uint16_t            file_id,
+                       uint16_t            record_key,
+                       fds_find_token_t  * p_token,
+                       ret_code_t        * p_ret)
+{
+    uint32_t const * p_found   = NULL;
+    uint16_t         found_page = FDS_MAX_PAGES;
+    bool             is_valid;
+
+    CRITICAL_SECTION_ENTER();
+    is_valid = m_index.is_valid;
+    if (is_valid)
+    {
+        uint16_t i = index_hash(file_id, record_key);
+
+        for (; m_index.entry[i].p_record != NULL; i = (i + 1) & FDS_INDEX_MASK)
+        {
+            uint32_t const * const p_record = m_index.entry[i].p_record;
+            uint16_t               page;
+
+            if ((m_index.entry[i].file_id    != file_id) ||
+                (m_index.entry[i].record_key != record_key))
+            {
+                continue;
+            }
+
+            // Skip records at or before the token position.
+            if ((page_from_record(&page, p_record) != FDS_SUCCESS) ||
+                (page < p_token->page) ||
+                ((page == p_token->page) && (p_token->p_addr != NULL) &&
+                 (p_record <= p_token->p_addr)))
+            {
+                continue;
+            }
+
+            // Keep the first record in page and address order.
+            if ((page < found_page) ||
+                ((page == found_page) && (p_record < p_found)))
+            {
+                p_found    = p_record;
+                found_page = page;
+            }
+        }
+    }
+    CRITICAL_SECTION_EXIT();
+
+    if (!is_valid)
+    {
+        return false;
+    }
+
+    if (p_found == NULL)
+    {
+        p_token->page   = FDS_MAX_PAGES;
+        p_token->p_addr = NULL;
+        *p_ret          = FDS_ERR_NOT_FOUND;
+    }
+    else
+    {
+        p_token->page   = found_page;
+        p_token->p_addr = p_found;
+        *p_ret          = FDS_SUCCESS;
+    }
+
+    return true;
+}
+
+
+// Find a record by ID among the indexed records.
+// Returns false if the index is not valid and flash must be scanned instead.
+static bool index_find_by_id(uint32_t record_id, uint32_t const ** pp_record)
+{
+    bool is_valid;
+
+    *pp_record = NULL;
+
+    CRITICAL_SECTION_ENTER();
+    is_valid = m_index.is_valid;
+    if (is_valid)
+    {
+        for (uint16_t i = 0; i < FDS_RECORD_INDEX_SIZE; i++)
+        {
+            uint32_t const * const p_record = m_index.entry[i].p_record;
+
+            if ((p_record != NULL) && (((fds_header_t*)p_record)->record_id == record_id))
+            {
+                *pp_record = p_record;
+                break;
+            }
+        }
+    }
+    CRITICAL_SECTION_EXIT();
+
+    return is_valid;
+}
+
+
+// Mark the index as out of sync with flash. It is rebuilt after garbage collection.
+static void index_invalidate(void)
+{
+    CRITICAL_SECTION_ENTER();
+    m_index.is_valid = false;
+    CRITICAL_SECTION_EXIT();
+}
+
+#else
+
+#define index_insert(p_record)
+#define index_remove(p_record)
+#define index_build()
+#define index_invalidate()
+
+#endif // (FDS_RECORD_INDEX_SIZE > 0)
+
+
 // Find a record given its descriptor and retrive the page in which the record is stored.
 // NOTE: Do not pass NULL as an argument for p_page.
 static bool record_find_by_desc(fds_record_desc_t * const p_desc, uint16_t * const p_page)
@@ -421,6 +748,22 @@ static bool record_find_by_desc(fds_record_desc_t * const p_desc, uint16_t * con
         return (page_from_record(p_page, p_desc->p_record) == FDS_SUCCESS);
     }
 
+#if (FDS_RECORD_INDEX_SIZE > 0)
+    uint32_t const * p_record;
+
+    if (index_find_by_id(p_desc->record_id, &p_record))
+    {
+        if (p_record == NULL)
+        {
+            return false;
+        }
+
+        p_desc->p_record     = p_record;
+        p_desc->gc_run_count = m_gc.run_count;
+        return (page_from_record(p_page, p_record) == FDS_SUCCESS);
+    }
+#endif
+
     // Otherwise, find the record in flash.
     for (*p_page = 0; *p_page < FDS_MAX_PAGES; (*p_page)++)
     {
@@ -462,6 +805,26 @@ static ret_code_t record_find(uint16_t          const * const p_file_id,
         return FDS_ERR_NULL_ARG;
     }
 
+#if (FDS_RECORD_INDEX_SIZE > 0)
+    if ((p_file_id != NULL) && (p_record_key != NULL))
+    {
+        ret_code_t ret;
+
+        if (index_find(*p_file_id, *p_record_key, p_token, &ret))
+        {
+            if (ret == FDS_SUCCESS)
+            {
+                fds_header_t const * const p_header = (fds_header_t*)p_token->p_addr;
+
+                p_desc->record_id    = p_header->record_id;
+                p_desc->p_record     = p_token->p_addr;
+                p_desc->gc_run_count = m_gc.run_count;
+            }
+            return ret;
+        }
+    }
+#endif
+
     // Begin (or resume) searching for a record.
     for (; p_token->page < FDS_MAX_PAGES; p_token->page++)
     {
@@ -522,15 +885,46 @@ static void dirty_records_stat(uint16_t         page,
 
         if (!header_is_valid(p_header))
         {
-            (*p_dirty_records) += 1;
-            (*p_word_count)    += FDS_HEADER_SIZE + p_header->tl.length_words;
+            // The header of a committed transaction is not a record, but GC reclaims it.
+            if (!txn_is_committed(p_header))
+            {
+                (*p_dirty_records) += 1;
+            }
+            (*p_word_count) += header_skip_words(p_header);
         }
 
-        p_rec += (FDS_HEADER_SIZE + (p_header->tl.length_words));
+        p_rec += header_skip_words(p_header);
     }
 }
 
 
+// Count the dirty words on each data page, to select pages for garbage collection.
+static void pages_dirty_words_init(void)
+{
+    for (uint16_t i = 0; i < FDS_MAX_PAGES; i++)
+    {
+        uint16_t dirty_records = 0;
+
+        m_pages[i].words_dirty = 0;
+        if (m_pages[i].page_type == FDS_PAGE_DATA)
+        {
+            dirty_records_stat(i, &dirty_records, &m_pages[i].words_dirty);
+        }
+    }
+}
+
+
+// Account for a record which has been flagged as dirty, or for the header of a transaction
+// which has been committed.
+static void page_record_dirty(uint16_t page, uint32_t const * const p_record)
+{
+    fds_header_t const * const p_header = (fds_header_t*)p_record;
+
+    m_pages[page].words_dirty += header_skip_words(p_header);
+    m_pages[page].can_gc       = true;
+}
+
+
 // Advances one position in the queue.
 // Returns true if the queue is not empty.
 static bool queue_advance(void)
@@ -579,12 +973,38 @@ static void chunk_queue_get_and_advance(fds_record_chunk_t ** pp_chunk)
 
 static void chunk_queue_skip(fds_op_t const * const p_op)
 {
+    uint32_t chunk_count = 0;
+
     if ((p_op->op_code == FDS_OP_WRITE) ||
         (p_op->op_code == FDS_OP_UPDATE))
     {
-        m_chunk_queue.rp    += p_op->write.chunk_count;
-        m_chunk_queue.count -= p_op->write.chunk_count;
+        chunk_count = p_op->write.chunk_count;
     }
+    else if (p_op->op_code == FDS_OP_TXN)
+    {
+        chunk_count = p_op->txn.chunk_count;
+    }
+
+    m_chunk_queue.rp     = (m_chunk_queue.rp + chunk_count) % FDS_CHUNK_QUEUE_SIZE;
+    m_chunk_queue.count -= chunk_count;
+}
+
+
+// Copy chunks to the end of the chunk queue.
+// NOTE: Must be called from within a critical section, after checking that the chunks fit.
+static void chunk_queue_put(uint32_t num_chunks, fds_record_chunk_t const * const p_chunk)
+{
+    uint32_t const       idx         = (m_chunk_queue.count + m_chunk_queue.rp) %
+                                       FDS_CHUNK_QUEUE_SIZE;
+    fds_record_chunk_t * p_chunk_dst = &m_chunk_queue.chunk[idx];
+
+    for (uint32_t i = 0; i < num_chunks; i++)
+    {
+        *p_chunk_dst = p_chunk[i];
+        chunk_queue_next(&p_chunk_dst);
+    }
+
+    m_chunk_queue.count += num_chunks;
 }
 
 
@@ -607,18 +1027,7 @@ static bool op_enqueue(fds_op_t           const * const p_op,
 
         if (num_chunks != 0)
         {
-            idx = (m_chunk_queue.count + m_chunk_queue.rp) % FDS_CHUNK_QUEUE_SIZE;
-
-            fds_record_chunk_t * p_chunk_dst;
-            p_chunk_dst = &m_chunk_queue.chunk[idx];
-
-            for (uint32_t i = 0; i < num_chunks; i++)
-            {
-                *p_chunk_dst = p_chunk[i];
-                chunk_queue_next(&p_chunk_dst);
-            }
-
-            m_chunk_queue.count += num_chunks;
+            chunk_queue_put(num_chunks, p_chunk);
         }
 
         ret = true;
@@ -796,8 +1205,15 @@ static ret_code_t record_find_and_delete(fds_op_t * const p_op)
         // Flag the record as dirty.
         ret = record_header_flag_dirty((uint32_t*)desc.p_record);
 
-        // This page can now be garbage collected.
-        m_pages[page].can_gc = true;
+        if (ret == FDS_SUCCESS)
+        {
+            CRITICAL_SECTION_ENTER();
+            index_remove(desc.p_record);
+            CRITICAL_SECTION_EXIT();
+
+            // This page can now be garbage collected.
+            page_record_dirty(page, desc.p_record);
+        }
     }
     else
     {
@@ -826,8 +1242,15 @@ static ret_code_t file_find_and_delete(fds_op_t * const p_op)
          // A record was found: flag it as dirty.
         ret = record_header_flag_dirty((uint32_t*)desc.p_record);
 
-        // This page can now be garbage collected.
-        m_pages[tok.page].can_gc = true;
+        if (ret == FDS_SUCCESS)
+        {
+            CRITICAL_SECTION_ENTER();
+            index_remove(desc.p_record);
+            CRITICAL_SECTION_EXIT();
+
+            // This page can now be garbage collected.
+            page_record_dirty(tok.page, desc.p_record);
+        }
     }
     else // FDS_ERR_NOT_FOUND
     {
@@ -895,8 +1318,9 @@ static bool crc_verify_success(uint16_t crc, uint16_t len_words, uint32_t const
 static void gc_init(void)
 {
     m_gc.run_count++;
-    m_gc.cur_page = 0;
-    m_gc.resume   = false;
+    m_gc.cur_page       = 0;
+    m_gc.resume         = false;
+    m_gc.page_collected = false;
 
     // Setup which pages to GC. Defer checking for open records and the can_gc flag,
     // as other operations might change those while GC is running.
@@ -907,6 +1331,34 @@ static void gc_init(void)
 }
 
 
+// Only GC pages with no open records and with some records which have been deleted.
+static bool gc_page_eligible(uint16_t page)
+{
+    return (m_pages[page].page_type    == FDS_PAGE_DATA) &&
+           (m_pages[page].records_open == 0)             &&
+           (m_pages[page].can_gc       == true);
+}
+
+
+// Returns true if page a should be garbage collected before page b: the page with the largest
+// share of dirty words reclaims the most space per erase. Ties go to the least worn page.
+static bool gc_page_better(uint16_t a, uint16_t b)
+{
+    uint32_t const used_a  = m_pages[a].write_offset - FDS_PAGE_TAG_SIZE;
+    uint32_t const used_b  = m_pages[b].write_offset - FDS_PAGE_TAG_SIZE;
+    uint32_t const ratio_a = m_pages[a].words_dirty * used_b;
+    uint32_t const ratio_b = m_pages[b].words_dirty * used_a;
+
+    if (ratio_a != ratio_b)
+    {
+        return (ratio_a > ratio_b);
+    }
+
+    return (m_erase_count[page_flash_index(m_pages[a].p_addr)] <
+            m_erase_count[page_flash_index(m_pages[b].p_addr)]);
+}
+
+
 // Obtain the next page to be garbage collected.
 // Returns true if there are pages left to garbage collect, returns false otherwise.
 static bool gc_page_next(uint16_t * const p_next_page)
@@ -915,21 +1367,31 @@ static bool gc_page_next(uint16_t * const p_next_page)
 
     for (uint16_t i = 0; i < FDS_MAX_PAGES; i++)
     {
-        if (m_gc.do_gc_page[i])
+        if (!m_gc.do_gc_page[i])
+        {
+            continue;
+        }
+
+        if (!gc_page_eligible(i))
         {
             // Do not attempt to GC this page again.
             m_gc.do_gc_page[i] = false;
+            continue;
+        }
 
-            // Only GC pages with no open records and with some records which have been deleted.
-            if ((m_pages[i].records_open == 0) && (m_pages[i].can_gc == true))
-            {
-                *p_next_page = i;
-                ret = true;
-                break;
-            }
+        if (!ret || gc_page_better(i, *p_next_page))
+        {
+            *p_next_page = i;
+            ret = true;
         }
     }
 
+    if (ret)
+    {
+        // Do not attempt to GC this page again.
+        m_gc.do_gc_page[*p_next_page] = false;
+    }
+
     return ret;
 }
 
@@ -939,7 +1401,7 @@ static ret_code_t gc_swap_erase(void)
     m_gc.state               = GC_DISCARD_SWAP;
     m_swap_page.write_offset = FDS_PAGE_TAG_SIZE;
 
-    return fs_erase(&fs_config, m_swap_page.p_addr, FDS_PHY_PAGES_IN_VPAGE, NULL);
+    return page_erase(m_swap_page.p_addr);
 }
 
 
@@ -952,7 +1414,7 @@ static ret_code_t gc_page_erase(void)
 
     if (m_pages[gc].records_open == 0)
     {
-        ret = fs_erase(&fs_config, m_pages[gc].p_addr, FDS_PHY_PAGES_IN_VPAGE, NULL);
+        ret = page_erase(m_pages[gc].p_addr);
         m_gc.state = GC_ERASE_PAGE;
     }
     else
@@ -1019,12 +1481,24 @@ static ret_code_t gc_tag_new_swap(void)
 
 static ret_code_t gc_next_page(void)
 {
-    if (!gc_page_next(&m_gc.cur_page))
+    // Background GC collects one page at a time, so that it does not keep the flash busy.
+    bool const done = (m_gc.single_page && m_gc.page_collected);
+
+    if (done || !gc_page_next(&m_gc.cur_page))
     {
         // No pages left to GC; GC has terminated. Reset the state.
-        m_gc.state        = GC_BEGIN;
-        m_gc.cur_page     = 0;
-        m_gc.p_record_src = NULL;
+        m_gc.state          = GC_BEGIN;
+        m_gc.cur_page       = 0;
+        m_gc.p_record_src   = NULL;
+        m_gc.page_collected = false;
+
+#if (FDS_RECORD_INDEX_SIZE > 0)
+        if (!m_index.is_valid)
+        {
+            // Retry, in case the index was full or out of sync.
+            index_build();
+        }
+#endif
 
         return FDS_OP_COMPLETED;
     }
@@ -1055,6 +1529,11 @@ static void gc_swap_pages(void)
     // Keep the offset for this page, but reset it for the swap.
     m_pages[m_gc.cur_page].write_offset = m_swap_page.write_offset;
     m_swap_page.write_offset            = FDS_PAGE_TAG_SIZE;
+
+    // Only valid records were copied.
+    m_pages[m_gc.cur_page].words_dirty  = 0;
+    m_pages[m_gc.cur_page].can_gc       = false;
+    m_gc.page_collected                 = true;
 }
 
 
@@ -1076,6 +1555,8 @@ static void gc_state_advance(void)
         // A page was successfully erased. Prepare to promote the swap.
         case GC_ERASE_PAGE:
             gc_swap_pages();
+            // The records of the page have moved to the swap.
+            index_build();
             m_gc.state = GC_PROMOTE_SWAP;
             break;
 
@@ -1099,6 +1580,53 @@ static void gc_state_advance(void)
 
 
 // Initialize the filesystem.
+// Finds a record which was replaced by a committed transaction, but not deleted because the
+// transaction was interrupted. Returns true if such a record was found.
+static bool txn_stale_record_find(uint32_t const ** pp_record)
+{
+    for (uint16_t page = 0; page < FDS_MAX_PAGES; page++)
+    {
+        uint32_t const * p_rec = m_pages[page].p_addr + FDS_PAGE_TAG_SIZE;
+
+        while ((p_rec < (m_pages[page].p_addr + FDS_PAGE_SIZE)) &&
+               (*p_rec != FDS_ERASED_WORD))
+        {
+            fds_header_t const * const p_header = (fds_header_t*)p_rec;
+
+            if (txn_is_committed(p_header))
+            {
+                for (uint32_t i = 0; i < p_header->record_id; i++)
+                {
+                    fds_record_desc_t desc = {0};
+                    uint16_t          rec_page;
+
+                    desc.record_id = p_rec[FDS_HEADER_SIZE + i];
+
+                    if (record_find_by_desc(&desc, &rec_page))
+                    {
+                        *pp_record = desc.p_record;
+                        return true;
+                    }
+                }
+            }
+
+            p_rec += header_skip_words(p_header);
+        }
+    }
+
+    return false;
+}
+
+
+static void init_complete(void)
+{
+    index_build();
+    pages_dirty_words_init();
+    flag_set(FDS_FLAG_INITIALIZED);
+    flag_clear(FDS_FLAG_INITIALIZING);
+}
+
+
 static ret_code_t init_execute(uint32_t prev_ret, fds_op_t * const p_op)
 {
     ret_code_t ret = FDS_ERR_INTERNAL;
@@ -1132,17 +1660,31 @@ static ret_code_t init_execute(uint32_t prev_ret, fds_op_t * const p_op)
                     break;
                 }
             }
-            if (!write_reqd)
+            if (write_reqd)
+            {
+                break;
+            }
+            p_op->init.step = FDS_OP_INIT_TXN_RECOVER;
+        }
+        // Fallthrough to FDS_OP_INIT_TXN_RECOVER.
+
+        case FDS_OP_INIT_TXN_RECOVER:
+        {
+            // Complete transactions which were interrupted after they were committed,
+            // by deleting the records they replaced, one at a time.
+            uint32_t const * p_record;
+
+            if (!txn_stale_record_find(&p_record))
             {
-                flag_set(FDS_FLAG_INITIALIZED);
-                flag_clear(FDS_FLAG_INITIALIZING);
+                init_complete();
                 return FDS_OP_COMPLETED;
             }
+            ret = record_header_flag_dirty((uint32_t*)p_record);
         }
         break;
 
         case FDS_OP_INIT_ERASE_SWAP:
-            ret = fs_erase(&fs_config, m_swap_page.p_addr, FDS_PHY_PAGES_IN_VPAGE, NULL);
+            ret = page_erase(m_swap_page.p_addr);
             // If the swap is going to be discarded then reset its write_offset.
             m_swap_page.write_offset = FDS_PAGE_TAG_SIZE;
             p_op->init.step          = FDS_OP_INIT_TAG_SWAP;
@@ -1244,12 +1786,31 @@ static ret_code_t write_execute(uint32_t prev_ret, fds_op_t * const p_op)
 
         case FDS_OP_WRITE_FLAG_DIRTY:
             ret = record_header_flag_dirty((uint32_t*)desc.p_record);
+            if (ret == FDS_SUCCESS)
+            {
+                uint16_t page;
+
+                CRITICAL_SECTION_ENTER();
+                index_remove(desc.p_record);
+                CRITICAL_SECTION_EXIT();
+
+                // The page which holds the old copy can now be garbage collected.
+                if (page_from_record(&page, desc.p_record) == FDS_SUCCESS)
+                {
+                    page_record_dirty(page, desc.p_record);
+                }
+            }
             p_op->write.step = FDS_OP_WRITE_DONE;
             break;
 
         case FDS_OP_WRITE_DONE:
             ret = FDS_OP_COMPLETED;
 
+            // The record is valid in flash now.
+            CRITICAL_SECTION_ENTER();
+            index_insert(p_write_addr);
+            CRITICAL_SECTION_EXIT();
+
 #if defined(FDS_CRC_ENABLED)
             if (flag_is_set(FDS_FLAG_VERIFY_CRC))
             {
@@ -1280,6 +1841,261 @@ static ret_code_t write_execute(uint32_t prev_ret, fds_op_t * const p_op)
 }
 
 
+#if (FDS_TXN_MAX_RECORDS > 0)
+
+// Returns the number of records replaced by the queued transaction.
+static uint16_t txn_replace_count(void)
+{
+    return (uint16_t)m_txn.header[FDS_OFFSET_ID];
+}
+
+
+// Returns true if all records replaced by the queued transaction exist.
+// This prevents duplicates when queuing multiple updates of the same record.
+static bool txn_replaced_records_exist(void)
+{
+    for (uint16_t i = 0; i < txn_replace_count(); i++)
+    {
+        fds_record_desc_t desc = {0};
+        uint16_t          page;
+
+        desc.record_id = m_txn.header[FDS_HEADER_SIZE + i];
+
+        if (!record_find_by_desc(&desc, &page))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+static ret_code_t txn_store(uint32_t       const * const p_dest,
+                            uint32_t       const * const p_src,
+                            uint16_t                     length_words)
+{
+    fs_ret_t const ret = fs_store(&fs_config, p_dest, p_src, length_words, NULL);
+    return (ret == FS_SUCCESS) ? FDS_SUCCESS : FDS_ERR_BUSY;
+}
+
+
+// Move on to the next record of the transaction, or to the commit if all records are written.
+static void txn_record_next(fds_op_t * const p_op)
+{
+    p_op->txn.record++;
+    p_op->txn.step = (p_op->txn.record < m_txn.count) ? FDS_OP_TXN_RECORD_HEADER :
+                                                        FDS_OP_TXN_COMMIT;
+}
+
+
+// Verifies the CRC of the records of a transaction, once they have been written to flash.
+static bool txn_records_verify(uint32_t const * const p_txn)
+{
+#if defined(FDS_CRC_ENABLED)
+    uint32_t const * p_rec = p_txn + FDS_HEADER_SIZE + txn_replace_count();
+
+    if (!flag_is_set(FDS_FLAG_VERIFY_CRC))
+    {
+        return true;
+    }
+
+    for (uint16_t i = 0; i < m_txn.count; i++)
+    {
+        if (!crc_verify_success(m_txn.record[i].ic.crc16, m_txn.record[i].tl.length_words, p_rec))
+        {
+            return false;
+        }
+        p_rec += FDS_HEADER_SIZE + m_txn.record[i].tl.length_words;
+    }
+#endif
+
+    return true;
+}
+
+
+// Add the records of a committed transaction to the index.
+static void txn_records_index(uint32_t const * const p_txn)
+{
+    uint32_t const * p_rec = p_txn + FDS_HEADER_SIZE + txn_replace_count();
+
+    CRITICAL_SECTION_ENTER();
+    for (uint16_t i = 0; i < m_txn.count; i++)
+    {
+        index_insert(p_rec);
+        p_rec += FDS_HEADER_SIZE + m_txn.record[i].tl.length_words;
+    }
+    CRITICAL_SECTION_EXIT();
+}
+
+
+// Flag the next record replaced by the transaction as dirty.
+// Returns FDS_OP_COMPLETED if there are no more records to delete.
+static ret_code_t txn_replaced_record_delete(fds_op_t * const p_op)
+{
+    while (p_op->txn.replaced < txn_replace_count())
+    {
+        fds_record_desc_t desc = {0};
+        uint16_t          page;
+
+        desc.record_id = m_txn.header[FDS_HEADER_SIZE + p_op->txn.replaced];
+        p_op->txn.replaced++;
+
+        if (record_find_by_desc(&desc, &page))
+        {
+            ret_code_t const ret = record_header_flag_dirty((uint32_t*)desc.p_record);
+
+            if (ret == FDS_SUCCESS)
+            {
+                CRITICAL_SECTION_ENTER();
+                index_remove(desc.p_record);
+                CRITICAL_SECTION_EXIT();
+
+                page_record_dirty(page, desc.p_record);
+            }
+            return ret;
+        }
+    }
+
+    return FDS_OP_COMPLETED;
+}
+
+
+// Executes transactions.
+static ret_code_t txn_execute(uint32_t prev_ret, fds_op_t * const p_op)
+{
+    ret_code_t           ret;
+    fds_page_t   * const p_page = &m_pages[p_op->txn.page];
+    uint32_t     * const p_txn  = (uint32_t*)(p_page->p_addr + p_page->write_offset);
+    fds_txn_step_t const step   = p_op->txn.step;
+
+    if (prev_ret != FS_SUCCESS)
+    {
+        ret = FDS_ERR_OPERATION_TIMEOUT;
+    }
+    else
+    {
+        // Execute the current step of the operation. The step is only advanced if
+        // fstorage accepted the write.
+        switch (step)
+        {
+            case FDS_OP_TXN_BEGIN:
+                if (!txn_replaced_records_exist())
+                {
+                    ret = FDS_ERR_NOT_FOUND;
+                    break;
+                }
+                // Write the header, leaving the commit word erased, and the replaced record IDs.
+                ret = txn_store(p_txn, m_txn.header, FDS_HEADER_SIZE + txn_replace_count());
+                if (ret == FDS_SUCCESS)
+                {
+                    p_op->txn.offset = FDS_HEADER_SIZE + txn_replace_count();
+                    p_op->txn.step   = FDS_OP_TXN_RECORD_HEADER;
+                }
+                break;
+
+            case FDS_OP_TXN_RECORD_HEADER:
+                // The whole header is written at once, since the record is not valid
+                // until the transaction is committed.
+                ret = txn_store(p_txn + p_op->txn.offset,
+                                (uint32_t*)&m_txn.record[p_op->txn.record], FDS_HEADER_SIZE);
+                if (ret == FDS_SUCCESS)
+                {
+                    p_op->txn.offset       += FDS_HEADER_SIZE;
+                    p_op->txn.record_chunks = m_txn.num_chunks[p_op->txn.record];
+                    if (p_op->txn.record_chunks != 0)
+                    {
+                        p_op->txn.step = FDS_OP_TXN_CHUNKS;
+                    }
+                    else
+                    {
+                        txn_record_next(p_op);
+                    }
+                }
+                break;
+
+            case FDS_OP_TXN_CHUNKS:
+            {
+                fds_record_chunk_t * p_chunk = NULL;
+
+                chunk_queue_get_and_advance(&p_chunk);
+                p_op->txn.chunk_count--;
+
+                ret = txn_store(p_txn + p_op->txn.offset, p_chunk->p_data, p_chunk->length_words);
+                if (ret == FDS_SUCCESS)
+                {
+                    p_op->txn.offset += p_chunk->length_words;
+                    p_op->txn.record_chunks--;
+                    if (p_op->txn.record_chunks == 0)
+                    {
+                        txn_record_next(p_op);
+                    }
+                }
+            }
+            break;
+
+            case FDS_OP_TXN_COMMIT:
+                if (!txn_records_verify(p_txn))
+                {
+                    ret = FDS_ERR_CRC_CHECK_FAILED;
+                    break;
+                }
+                ret = txn_store(p_txn + FDS_OFFSET_IC,
+                                (uint32_t*)&m_fds_ic_commit, FDS_HEADER_SIZE_IC);
+                if (ret == FDS_SUCCESS)
+                {
+                    p_op->txn.step = FDS_OP_TXN_FLAG_DIRTY;
+                }
+                break;
+
+            case FDS_OP_TXN_FLAG_DIRTY:
+                if (p_op->txn.replaced == 0)
+                {
+                    // The transaction was committed. Its header can be garbage collected.
+                    txn_records_index(p_txn);
+                    page_record_dirty(p_op->txn.page, p_txn);
+                }
+                ret = txn_replaced_record_delete(p_op);
+                break;
+
+            default:
+                ret = FDS_ERR_INTERNAL;
+                break;
+        }
+    }
+
+    if (ret == FDS_OP_EXECUTING)
+    {
+        return ret;
+    }
+
+    // There won't be another callback for this operation.
+    if (p_op->txn.step == FDS_OP_TXN_BEGIN)
+    {
+        // Nothing was written. Cancel the reservation of flash space.
+        CRITICAL_SECTION_ENTER();
+        write_space_free(p_op->txn.length_words, p_op->txn.page);
+        CRITICAL_SECTION_EXIT();
+    }
+    else
+    {
+        if (p_op->txn.step <= FDS_OP_TXN_COMMIT)
+        {
+            // The transaction was not committed, so all of it can be garbage collected.
+            p_page->words_dirty += FDS_HEADER_SIZE + p_op->txn.length_words;
+            p_page->can_gc       = true;
+        }
+        page_offsets_update(p_page, p_op->txn.length_words);
+    }
+
+    m_txn.is_queued = false;
+
+    return ret;
+}
+
+#endif // FDS_TXN_MAX_RECORDS
+
+
 static ret_code_t delete_execute(uint32_t prev_ret, fds_op_t * const p_op)
 {
     ret_code_t ret;
@@ -1319,7 +2135,7 @@ static ret_code_t delete_execute(uint32_t prev_ret, fds_op_t * const p_op)
 }
 
 
-static ret_code_t gc_execute(uint32_t prev_ret)
+static ret_code_t gc_execute(uint32_t prev_ret, fds_op_t * const p_op)
 {
     ret_code_t ret;
 
@@ -1328,6 +2144,9 @@ static ret_code_t gc_execute(uint32_t prev_ret)
         return FDS_ERR_OPERATION_TIMEOUT;
     }
 
+    // A GC requested by the application completes a background GC which it resumes.
+    m_gc.single_page = p_op->gc.background;
+
     if (m_gc.resume)
     {
         m_gc.resume = false;
@@ -1374,11 +2193,65 @@ static ret_code_t gc_execute(uint32_t prev_ret)
 }
 
 
+#if (FDS_GC_BACKGROUND_WORDS > 0)
+
+static void queue_start(void);
+
+
+// Start garbage collecting a single page when the queue is idle, if any page which can be garbage
+// collected has at least FDS_GC_BACKGROUND_WORDS dirty words.
+static void gc_background_start(void)
+{
+    fds_op_t op;
+    bool     start = false;
+
+    // Do not interrupt a GC which has failed or has been paused; the application resumes it.
+    if (!flag_is_set(FDS_FLAG_INITIALIZED) || (m_gc.state != GC_BEGIN))
+    {
+        return;
+    }
+
+    for (uint16_t i = 0; i < FDS_MAX_PAGES; i++)
+    {
+        if (gc_page_eligible(i) && (m_pages[i].words_dirty >= FDS_GC_BACKGROUND_WORDS))
+        {
+            start = true;
+            break;
+        }
+    }
+
+    if (!start)
+    {
+        return;
+    }
+
+    op.op_code       = FDS_OP_GC;
+    op.gc.background = true;
+
+    if (op_enqueue(&op, 0, NULL))
+    {
+        queue_start();
+    }
+}
+
+#else
+
+#define gc_background_start()
+
+#endif // FDS_GC_BACKGROUND_WORDS
+
+
 static void queue_process(fs_ret_t result)
 {
     ret_code_t         ret;
     fds_op_t   * const p_op = &m_op_queue.op[m_op_queue.rp];
 
+    if (result != FS_SUCCESS)
+    {
+        // It is unknown which flash words were written.
+        index_invalidate();
+    }
+
     switch (p_op->op_code)
     {
         case FDS_OP_INIT:
@@ -1396,9 +2269,15 @@ static void queue_process(fs_ret_t result)
             break;
 
         case FDS_OP_GC:
-            ret = gc_execute(result);
+            ret = gc_execute(result, p_op);
             break;
 
+#if (FDS_TXN_MAX_RECORDS > 0)
+        case FDS_OP_TXN:
+            ret = txn_execute(result, p_op);
+            break;
+#endif
+
         default:
             ret = FDS_ERR_INTERNAL;
             break;
@@ -1435,6 +2314,9 @@ static void queue_process(fs_ret_t result)
             // No more elements in the queue. Clear the FDS_FLAG_PROCESSING flag,
             // so that new operation can start processing the queue.
             flag_clear(FDS_FLAG_PROCESSING);
+
+            // Use the idle flash to reclaim space.
+            gc_background_start();
         }
     }
 }
@@ -1457,6 +2339,31 @@ static void fs_event_handler(fs_evt_t const * const p_evt, fs_ret_t result)
 
 
 // Enqueues write and update operations.
+// Computes the CRC of a record header and of the record data.
+// Returns zero if CRC is not enabled.
+static uint16_t record_crc_compute(fds_header_t const * const p_header,
+                                   fds_record_t const * const p_record)
+{
+    uint16_t crc = 0;
+
+#if defined (FDS_CRC_ENABLED)
+    // First, compute the CRC for the first 6 bytes of the header which contain the
+    // record key, length and file ID, then, compute the CRC of the record ID (4 bytes).
+    crc = crc16_compute((uint8_t*)p_header,             6, NULL);
+    crc = crc16_compute((uint8_t*)&p_header->record_id, 4, &crc);
+
+    for (uint32_t i = 0; i < p_record->data.num_chunks; i++)
+    {
+        // Compute the CRC for the record data.
+        crc = crc16_compute((uint8_t*)p_record->data.p_chunks[i].p_data,
+                            p_record->data.p_chunks[i].length_words * sizeof(uint32_t), &crc);
+    }
+#endif
+
+    return crc;
+}
+
+
 static ret_code_t write_enqueue(fds_record_desc_t         * const p_desc,
                                 fds_record_t        const * const p_record,
                                 fds_reserve_token_t const * const p_tok,
@@ -1465,7 +2372,6 @@ static ret_code_t write_enqueue(fds_record_desc_t         * const p_desc,
     ret_code_t ret;
     fds_op_t   op;
     uint16_t   page;
-    uint16_t   crc          = 0;
     uint16_t   length_words = 0;
 
     if (!flag_is_set(FDS_FLAG_INITIALIZED))
@@ -1478,8 +2384,9 @@ static ret_code_t write_enqueue(fds_record_desc_t         * const p_desc,
         return FDS_ERR_NULL_ARG;
     }
 
-    if ((p_record->file_id == FDS_FILE_ID_INVALID) ||
-        (p_record->key     == FDS_RECORD_KEY_DIRTY))
+    if ((p_record->file_id == FDS_FILE_ID_INVALID)  ||
+        (p_record->key     == FDS_RECORD_KEY_DIRTY) ||
+        record_key_is_txn(p_record->key))
     {
         return FDS_ERR_INVALID_ARG;
     }
@@ -1533,21 +2440,7 @@ static ret_code_t write_enqueue(fds_record_desc_t         * const p_desc,
         op.write.record_to_delete = p_desc->record_id;
     }
 
-#if defined (FDS_CRC_ENABLED)
-    // First, compute the CRC for the first 6 bytes of the header which contain the
-    // record key, length and file ID, then, compute the CRC of the record ID (4 bytes).
-    crc = crc16_compute((uint8_t*)&op.write.header,           6, NULL);
-    crc = crc16_compute((uint8_t*)&op.write.header.record_id, 4, &crc);
-
-    for (uint32_t i = 0; i < p_record->data.num_chunks; i++)
-    {
-        // Compute the CRC for the record data.
-        crc = crc16_compute((uint8_t*)p_record->data.p_chunks[i].p_data,
-                            p_record->data.p_chunks[i].length_words * sizeof(uint32_t), &crc);
-    }
-#endif
-
-    op.write.header.ic.crc16 = crc;
+    op.write.header.ic.crc16 = record_crc_compute(&op.write.header, p_record);
 
     // Attempt to enqueue the operation.
     if (!op_enqueue(&op, p_record->data.num_chunks, p_record->data.p_chunks))
@@ -1630,12 +2523,16 @@ ret_code_t fds_init(void)
 
     if (init_opts == ALREADY_INSTALLED)
     {
-        // No initialization is necessary. Notify the application immediately.
-        flag_set(FDS_FLAG_INITIALIZED);
-        flag_clear(FDS_FLAG_INITIALIZING);
+        uint32_t const * p_record;
 
-        event_send(&evt_success);
-        return FDS_SUCCESS;
+        if (!txn_stale_record_find(&p_record))
+        {
+            // No initialization is necessary. Notify the application immediately.
+            init_complete();
+
+            event_send(&evt_success);
+            return FDS_SUCCESS;
+        }
     }
 
     fds_op_t op;
@@ -1662,6 +2559,10 @@ ret_code_t fds_init(void)
             op.init.step = FDS_OP_INIT_TAG_DATA;
             break;
 
+        case ALREADY_INSTALLED:
+            op.init.step = FDS_OP_INIT_TXN_RECOVER;
+            break;
+
         default:
             // Should not happen.
             break;
@@ -1862,6 +2763,201 @@ ret_code_t fds_record_update(fds_record_desc_t       * const p_desc,
 }
 
 
+#if (FDS_TXN_MAX_RECORDS > 0)
+
+// Enqueue a transaction and the chunks of all its records.
+static bool txn_enqueue(fds_op_t         const * const p_op,
+                        fds_txn_record_t const * const p_records,
+                        uint16_t                       count)
+{
+    bool ret = false;
+
+    CRITICAL_SECTION_ENTER();
+    if  ((m_op_queue.count    <= FDS_OP_QUEUE_SIZE - 1) &&
+         (m_chunk_queue.count <= FDS_CHUNK_QUEUE_SIZE - p_op->txn.chunk_count))
+    {
+        uint32_t const idx = (m_op_queue.count + m_op_queue.rp) % FDS_OP_QUEUE_SIZE;
+
+        m_op_queue.op[idx] = *p_op;
+        m_op_queue.count++;
+
+        for (uint16_t i = 0; i < count; i++)
+        {
+            chunk_queue_put(p_records[i].p_record->data.num_chunks,
+                            p_records[i].p_record->data.p_chunks);
+        }
+
+        ret = true;
+    }
+    CRITICAL_SECTION_EXIT();
+
+    return ret;
+}
+
+
+ret_code_t fds_txn_write(fds_txn_record_t const * const p_records, uint16_t count)
+{
+    ret_code_t ret;
+    fds_op_t   op;
+    fds_tl_t   tl;
+    uint16_t   page;
+    uint16_t   replace_count = 0;
+    uint16_t   length_words  = 0;
+    uint32_t   num_chunks    = 0;
+
+    if (!flag_is_set(FDS_FLAG_INITIALIZED))
+    {
+        return FDS_ERR_NOT_INITIALIZED;
+    }
+
+    if (p_records == NULL)
+    {
+        return FDS_ERR_NULL_ARG;
+    }
+
+    if ((count == 0) || (count > FDS_TXN_MAX_RECORDS))
+    {
+        return FDS_ERR_INVALID_ARG;
+    }
+
+    // Check all records, and compute the length of the transaction.
+    for (uint16_t i = 0; i < count; i++)
+    {
+        fds_record_t const * const p_record = p_records[i].p_record;
+
+        if ((p_record == NULL) || (p_records[i].update && (p_records[i].p_desc == NULL)))
+        {
+            return FDS_ERR_NULL_ARG;
+        }
+
+        if ((p_record->file_id == FDS_FILE_ID_INVALID)  ||
+            (p_record->key     == FDS_RECORD_KEY_DIRTY) ||
+            record_key_is_txn(p_record->key))
+        {
+            return FDS_ERR_INVALID_ARG;
+        }
+
+        if (!chunk_is_aligned(p_record->data.p_chunks,
+                              p_record->data.num_chunks))
+        {
+            return FDS_ERR_UNALIGNED_ADDR;
+        }
+
+        length_words += FDS_HEADER_SIZE;
+        for (uint32_t j = 0; j < p_record->data.num_chunks; j++)
+        {
+            length_words += p_record->data.p_chunks[j].length_words;
+        }
+
+        num_chunks += p_record->data.num_chunks;
+        if (p_records[i].update)
+        {
+            replace_count++;
+        }
+    }
+
+    // The replaced record IDs are stored in the transaction header.
+    length_words += replace_count;
+
+    if (num_chunks > FDS_CHUNK_QUEUE_SIZE)
+    {
+        return FDS_ERR_NO_SPACE_IN_QUEUES;
+    }
+
+    CRITICAL_SECTION_ENTER();
+    ret = m_txn.is_queued ? FDS_ERR_NO_SPACE_IN_QUEUES : FDS_SUCCESS;
+    m_txn.is_queued = true;
+    CRITICAL_SECTION_EXIT();
+
+    if (ret != FDS_SUCCESS)
+    {
+        return ret;
+    }
+
+    // Find a page where to write the transaction.
+    ret = write_space_reserve(length_words, &page);
+
+    if (ret != FDS_SUCCESS)
+    {
+        m_txn.is_queued = false;
+        return ret;
+    }
+
+    // Prepare the headers. Record IDs are assigned in order.
+    tl.record_key   = FDS_RECORD_KEY_TXN;
+    tl.length_words = length_words;
+
+    memcpy(&m_txn.header[FDS_OFFSET_TL], &tl, sizeof(tl));
+    m_txn.header[FDS_OFFSET_IC] = FDS_ERASED_WORD;
+    m_txn.header[FDS_OFFSET_ID] = replace_count;
+    m_txn.count                 = count;
+
+    replace_count = 0;
+    for (uint16_t i = 0; i < count; i++)
+    {
+        fds_record_t const * const p_record = p_records[i].p_record;
+        fds_header_t       * const p_header = &m_txn.record[i];
+
+        p_header->record_id       = record_id_new();
+        p_header->ic.file_id      = p_record->file_id;
+        p_header->tl.record_key   = p_record->key;
+        p_header->tl.length_words = 0;
+
+        for (uint32_t j = 0; j < p_record->data.num_chunks; j++)
+        {
+            p_header->tl.length_words += p_record->data.p_chunks[j].length_words;
+        }
+
+        p_header->ic.crc16   = record_crc_compute(p_header, p_record);
+        m_txn.num_chunks[i]  = p_record->data.num_chunks;
+
+        if (p_records[i].update)
+        {
+            m_txn.header[FDS_HEADER_SIZE + replace_count] = p_records[i].p_desc->record_id;
+            replace_count++;
+        }
+    }
+
+    // Initialize the operation.
+    memset(&op, 0x00, sizeof(op));
+    op.op_code          = FDS_OP_TXN;
+    op.txn.step         = FDS_OP_TXN_BEGIN;
+    op.txn.page         = page;
+    op.txn.length_words = length_words;
+    op.txn.chunk_count  = num_chunks;
+
+    if (!txn_enqueue(&op, p_records, count))
+    {
+        // No space availble in the queues. Cancel the reservation of flash space.
+        CRITICAL_SECTION_ENTER();
+        write_space_free(length_words, page);
+        CRITICAL_SECTION_EXIT();
+
+        m_txn.is_queued = false;
+        return FDS_ERR_NO_SPACE_IN_QUEUES;
+    }
+
+    // Initialize the record descriptors.
+    for (uint16_t i = 0; i < count; i++)
+    {
+        if (p_records[i].p_desc != NULL)
+        {
+            p_records[i].p_desc->p_record       = NULL;
+            p_records[i].p_desc->record_id      = m_txn.record[i].record_id;
+            p_records[i].p_desc->record_is_open = false;
+            p_records[i].p_desc->gc_run_count   = m_gc.run_count;
+        }
+    }
+
+    // Start processing the queue, if necessary.
+    queue_start();
+
+    return FDS_SUCCESS;
+}
+
+#endif // FDS_TXN_MAX_RECORDS
+
+
 ret_code_t fds_record_delete(fds_record_desc_t * const p_desc)
 {
     fds_op_t op;
@@ -1927,11 +3023,16 @@ ret_code_t fds_gc(void)
         return FDS_ERR_NOT_INITIALIZED;
     }
 
-    op.op_code = FDS_OP_GC;
+    op.op_code       = FDS_OP_GC;
+    op.gc.background = false;
+
+    // A GC which is executing, for example in the background, must not retry its last step.
+    bool const gc_executing = flag_is_set(FDS_FLAG_PROCESSING) &&
+                              (m_op_queue.op[m_op_queue.rp].op_code == FDS_OP_GC);
 
     if (op_enqueue(&op, 0, NULL))
     {
-        if (m_gc.state != GC_BEGIN)
+        if ((m_gc.state != GC_BEGIN) && !gc_executing)
         {
             // Resume GC by retrying the last step.
             m_gc.resume = true;
@@ -2052,6 +3153,48 @@ ret_code_t fds_stat(fds_stat_t * const p_stat)
 }
 
 
+ret_code_t fds_page_stat(uint16_t page, fds_page_stat_t * const p_stat)
+{
+    if (!flag_is_set(FDS_FLAG_INITIALIZED))
+    {
+        return FDS_ERR_NOT_INITIALIZED;
+    }
+
+    if (p_stat == NULL)
+    {
+        return FDS_ERR_NULL_ARG;
+    }
+
+    if (page >= FDS_VIRTUAL_PAGES)
+    {
+        return FDS_ERR_INVALID_ARG;
+    }
+
+    memset(p_stat, 0x00, sizeof(fds_page_stat_t));
+
+    p_stat->erase_count = m_erase_count[page];
+
+    if (page_flash_index(m_swap_page.p_addr) == page)
+    {
+        p_stat->is_swap    = true;
+        p_stat->words_used = m_swap_page.write_offset;
+        return FDS_SUCCESS;
+    }
+
+    for (uint16_t i = 0; i < FDS_MAX_PAGES; i++)
+    {
+        if (page_flash_index(m_pages[i].p_addr) == page)
+        {
+            p_stat->words_used  = m_pages[i].write_offset + m_pages[i].words_reserved;
+            p_stat->words_dirty = m_pages[i].words_dirty;
+            break;
+        }
+    }
+
+    return FDS_SUCCESS;
+}
+
+
 #if defined(FDS_CRC_ENABLED)
 
 ret_code_t fds_verify_crc_on_writes(bool enable)
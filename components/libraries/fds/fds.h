@@ -51,6 +51,18 @@ extern "C" {
 #define FDS_RECORD_KEY_DIRTY    (0x0000)
 
 
+/**@brief   Record key for transaction headers.
+ *
+ * If FDS_TXN_MAX_RECORDS is greater than zero, this key is used to mark the header that groups
+ * the records of a transaction written by @ref fds_txn_write, and must not be used as a record
+ * key by the application. If transactions are disabled, it is an ordinary record key.
+ *
+ * @note    Flash written with transactions enabled must not be used with transactions disabled,
+ *          because transaction headers would then be read as records.
+ */
+#define FDS_RECORD_KEY_TXN      (0xFFFF)
+
+
 /**@brief   FDS return values.
  */
 enum
@@ -166,6 +178,22 @@ typedef struct
 } fds_record_t;
 
 
+/**@brief   A record to be written as part of a transaction, see @ref fds_txn_write.
+ */
+typedef struct
+{
+    fds_record_t      const * p_record;     //!< The record to be written to flash.
+
+    /**@brief   The descriptor of the record.
+     *
+     * If @p update is true, it identifies the record to be replaced. It is set to the descriptor
+     * of the new record. Can be NULL if @p update is false.
+     */
+    fds_record_desc_t       * p_desc;
+    bool                      update;       //!< Whether the new record replaces an existing one.
+} fds_txn_record_t;
+
+
 /**@brief   A token to a reserved space in flash, created by @ref fds_reserve.
  *
  * This token can be used to write the record in the reserved space (@ref fds_record_write_reserved)
@@ -200,7 +228,8 @@ typedef enum
     FDS_EVT_UPDATE,     //!< Event for @ref fds_record_update.
     FDS_EVT_DEL_RECORD, //!< Event for @ref fds_record_delete.
     FDS_EVT_DEL_FILE,   //!< Event for @ref fds_file_delete.
-    FDS_EVT_GC          //!< Event for @ref fds_gc.
+    FDS_EVT_GC,         //!< Event for @ref fds_gc.
+    FDS_EVT_TXN         //!< Event for @ref fds_txn_write.
 } fds_evt_id_t;
 
 
@@ -239,6 +268,11 @@ typedef struct
             uint16_t pages_skipped;
             uint16_t space_reclaimed;
         } gc;
+        struct
+        {
+            uint16_t record_count;      //!< The number of records in the transaction.
+            uint16_t records_replaced;  //!< The number of old records that were deleted.
+        } txn; //!< Information for @ref FDS_EVT_TXN events.
     };
 } fds_evt_t;
 
@@ -273,6 +307,20 @@ typedef struct
 } fds_stat_t;
 
 
+/**@brief   Statistics for one flash page used by FDS. */
+typedef struct
+{
+    /**@brief The number of times the page was erased since @ref fds_init was called.
+     *
+     * Erase counts are kept in RAM only.
+     */
+    uint32_t erase_count;
+    uint16_t words_used;    //!< The number of words written or reserved, including the page tag.
+    uint16_t words_dirty;   //!< The number of words in deleted records, which garbage collection can reclaim.
+    bool     is_swap;       //!< Whether the page is currently the swap page.
+} fds_page_stat_t;
+
+
 /**@brief   FDS event handler function prototype.
  *
  * @param   p_evt   The event.
@@ -311,9 +359,10 @@ ret_code_t fds_init(void);
 /**@brief   Function for writing a record to flash.
  *
  * There are no restrictions on the file ID and the record key, except that the record key must be
- * different from @ref FDS_RECORD_KEY_DIRTY and the file ID must be different from
- * @ref FDS_FILE_ID_INVALID. In particular, no restrictions are made regarding the uniqueness of
- * the file ID or the record key. All records with the same file ID are grouped into one file.
+ * different from @ref FDS_RECORD_KEY_DIRTY and, if transactions are enabled, from
+ * @ref FDS_RECORD_KEY_TXN, and the file ID must be different from @ref FDS_FILE_ID_INVALID. In
+ * particular, no restrictions are made regarding the uniqueness of the file ID or the record key.
+ * All records with the same file ID are grouped into one file.
  * If no file with the specified ID exists, it is created. There can be multiple records with the
  * same record key in a file.
  *
@@ -385,9 +434,10 @@ ret_code_t fds_reserve_cancel(fds_reserve_token_t * const p_token);
  *          @ref fds_reserve.
  *
  * There are no restrictions on the file ID and the record key, except that the record key must be
- * different from @ref FDS_RECORD_KEY_DIRTY and the file ID must be different from
- * @ref FDS_FILE_ID_INVALID. In particular, no restrictions are made regarding the uniqueness of
- * the file ID or the record key. All records with the same file ID are grouped into one file.
+ * different from @ref FDS_RECORD_KEY_DIRTY and, if transactions are enabled, from
+ * @ref FDS_RECORD_KEY_TXN, and the file ID must be different from @ref FDS_FILE_ID_INVALID. In
+ * particular, no restrictions are made regarding the uniqueness of the file ID or the record key.
+ * All records with the same file ID are grouped into one file.
  * If no file with the specified ID exists, it is created. There can be multiple records with the
  * same record key in a file.
  *
@@ -472,9 +522,10 @@ ret_code_t fds_file_delete(uint16_t file_id);
  * old record (identified by @p p_desc).
  *
  * There are no restrictions on the file ID and the record key, except that the record key must be
- * different from @ref FDS_RECORD_KEY_DIRTY and the file ID must be different from
- * @ref FDS_FILE_ID_INVALID. In particular, no restrictions are made regarding the uniqueness of
- * the file ID or the record key. All records with the same file ID are grouped into one file.
+ * different from @ref FDS_RECORD_KEY_DIRTY and, if transactions are enabled, from
+ * @ref FDS_RECORD_KEY_TXN, and the file ID must be different from @ref FDS_FILE_ID_INVALID. In
+ * particular, no restrictions are made regarding the uniqueness of the file ID or the record key.
+ * All records with the same file ID are grouped into one file.
  * If no file with the specified ID exists, it is created. There can be multiple records with the
  * same record key in a file.
  *
@@ -505,6 +556,42 @@ ret_code_t fds_record_update(fds_record_desc_t       * const p_desc,
                              fds_record_t      const * const p_record);
 
 
+/**@brief   Function for writing and updating several records in one transaction.
+ *
+ * The records are written one after the other in a single reserved space, behind a transaction
+ * header. They become valid together when the last word of the header is written. If power is
+ * lost before that, none of the records are found after @ref fds_init. Records that are updated
+ * are deleted after the new records have become valid. If power is lost in between, they are
+ * deleted by @ref fds_init.
+ *
+ * A transaction needs fewer flash operations than writing the records one by one, because each
+ * record header is written at once. All records must fit in one virtual page together with the
+ * transaction header, which takes 3 words plus 1 word for each record that is updated.
+ *
+ * The same rules as for @ref fds_record_write apply to the records. Record data is not buffered
+ * internally, so it must be kept in memory until the @ref FDS_EVT_TXN event has been received.
+ * Only one transaction can be queued at a time.
+ *
+ * This function is available if FDS_TXN_MAX_RECORDS is greater than zero.
+ *
+ * @param[in]   p_records   The records to write.
+ * @param[in]   count       The number of records, at most FDS_TXN_MAX_RECORDS.
+ *
+ * @retval  FDS_SUCCESS                 If the operation was queued successfully.
+ * @retval  FDS_ERR_NOT_INITIALIZED     If the module is not initialized.
+ * @retval  FDS_ERR_NULL_ARG            If @p p_records, a record, or the descriptor of a record
+ *                                      to update is NULL.
+ * @retval  FDS_ERR_INVALID_ARG         If @p count is zero or too large, or if a file ID or
+ *                                      record key is invalid.
+ * @retval  FDS_ERR_UNALIGNED_ADDR      If record data is not aligned to a 4 byte boundary.
+ * @retval  FDS_ERR_RECORD_TOO_LARGE    If the records do not fit in a virtual page.
+ * @retval  FDS_ERR_NO_SPACE_IN_FLASH   If there is not enough free space in flash.
+ * @retval  FDS_ERR_NO_SPACE_IN_QUEUES  If the operation queue is full, there are more record
+ *                                      chunks than can be buffered, or a transaction is queued.
+ */
+ret_code_t fds_txn_write(fds_txn_record_t const * const p_records, uint16_t count);
+
+
 /**@brief   Function for iterating through all records in flash.
  *
  * To search for the next record, call the function again and supply the same @ref fds_find_token_t
@@ -641,6 +728,14 @@ ret_code_t fds_record_close(fds_record_desc_t * const p_desc);
  * This function is asynchronous. Completion is reported through an event that is sent to the
  * registered event handler function.
  *
+ * Pages are garbage collected in order of their share of deleted records, so that each page erase
+ * reclaims as much space as possible.
+ *
+ * If FDS_GC_BACKGROUND_WORDS is not zero, FDS also garbage collects one page at a time whenever
+ * its queue becomes empty and a page has at least that many words in deleted records. Background
+ * garbage collection also sends an @ref FDS_EVT_GC event. Operations that are queued while it
+ * runs are executed after it has finished with the page.
+ *
  * @retval  FDS_SUCCESS                 If the operation was queued successfully.
  * @retval  FDS_ERR_NOT_INITIALIZED     If the module is not initialized.
  * @retval  FDS_ERR_NO_SPACE_IN_QUEUES  If the operation queue is full.
@@ -702,6 +797,22 @@ ret_code_t fds_record_id_from_desc(fds_record_desc_t const * const p_desc,
 ret_code_t fds_stat(fds_stat_t * const p_stat);
 
 
+/**@brief   Function for retrieving statistics for one flash page.
+ *
+ * Pages are numbered in flash order, from 0 to FDS_VIRTUAL_PAGES - 1. The numbering does not
+ * change when garbage collection swaps pages, so the erase counts show how evenly the flash wears.
+ *
+ * @param[in]   page        The page number.
+ * @param[out]  p_stat      Page statistics.
+ *
+ * @retval  FDS_SUCCESS                 If the statistics were returned successfully.
+ * @retval  FDS_ERR_NOT_INITIALIZED     If the module is not initialized.
+ * @retval  FDS_ERR_NULL_ARG            If @p p_stat is NULL.
+ * @retval  FDS_ERR_INVALID_ARG         If @p page is out of range.
+ */
+ret_code_t fds_page_stat(uint16_t page, fds_page_stat_t * const p_stat);
+
+
 #if defined(FDS_CRC_ENABLED)
 
 /**@brief   Function for enabling and disabling CRC verification for write operations.
@@ -67,5 +67,39 @@
 #define FDS_VIRTUAL_PAGE_SIZE
 
 
+/** @brief Number of entries in the RAM index of records.
+ *
+ * With the index, records are found by file ID and record key without scanning flash.
+ * It uses 8 bytes of RAM per entry and can hold one record less than its number of entries.
+ * If there are more valid records, FDS falls back to scanning flash until a garbage
+ * collection finds that they fit again. Must be 0 (disabled) or a power of two.
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define FDS_RECORD_INDEX_SIZE
+
+
+/** @brief Number of dirty words on a page which starts background garbage collection.
+ *
+ * When the operation queue becomes empty, FDS garbage collects one page which has at least
+ * this many words in deleted records. A page erase keeps the flash busy for up to 85 ms,
+ * so lower values reclaim space earlier at the cost of more erases. 0 disables background
+ * garbage collection; space is then only reclaimed by @ref fds_gc.
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define FDS_GC_BACKGROUND_WORDS
+
+
+/** @brief Maximum number of records in a transaction written by @ref fds_txn_write.
+ *
+ * Each record costs about 24 bytes of RAM for the headers kept until they are written.
+ * 0 disables transactions; @ref fds_txn_write then returns @ref FDS_ERR_INVALID_ARG, and
+ * @ref FDS_RECORD_KEY_TXN can be used as a record key.
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define FDS_TXN_MAX_RECORDS
+
 
 /** @} */
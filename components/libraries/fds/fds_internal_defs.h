@@ -77,6 +77,26 @@ extern "C" {
     #error "FDS requires at least two virtual pages."
 #endif
 
+// The number of entries in the RAM record index. Zero disables the index.
+#ifndef FDS_RECORD_INDEX_SIZE
+    #define FDS_RECORD_INDEX_SIZE   (0)
+#endif
+
+#if ((FDS_RECORD_INDEX_SIZE & (FDS_RECORD_INDEX_SIZE - 1)) != 0)
+    #error "FDS_RECORD_INDEX_SIZE must be zero or a power of two."
+#endif
+
+// The number of dirty words on a page which starts background garbage collection.
+// Zero disables background garbage collection.
+#ifndef FDS_GC_BACKGROUND_WORDS
+    #define FDS_GC_BACKGROUND_WORDS (0)
+#endif
+
+// The largest number of records in a transaction. Zero disables transactions.
+#ifndef FDS_TXN_MAX_RECORDS
+    #define FDS_TXN_MAX_RECORDS     (0)
+#endif
+
 
 // FDS internal status flags.
 typedef enum
@@ -105,6 +125,7 @@ typedef struct
     uint16_t                write_offset;   // The page write offset, in 4-byte words.
     uint16_t                words_reserved; // The amount of words reserved by fds_write_reserve().
     uint16_t                records_open;   // The number of records opened using fds_open().
+    uint16_t                words_dirty;    // The number of words in dirty records, which GC can reclaim.
     bool                    can_gc;         // Indicates that there are some records that have been deleted.
 } fds_page_t;
 
@@ -125,7 +146,8 @@ typedef enum
     FDS_OP_UPDATE,      // Update a record.
     FDS_OP_DEL_RECORD,  // Delete a record.
     FDS_OP_DEL_FILE,    // Delete a file.
-    FDS_OP_GC           // Run garbage collection.
+    FDS_OP_GC,          // Run garbage collection.
+    FDS_OP_TXN          // Write a transaction.
 } fds_op_code_t;
 
 
@@ -135,6 +157,7 @@ typedef enum
     FDS_OP_INIT_TAG_DATA,
     FDS_OP_INIT_ERASE_SWAP,
     FDS_OP_INIT_PROMOTE_SWAP,
+    FDS_OP_INIT_TXN_RECOVER,        // Delete records replaced by an interrupted transaction.
 } fds_init_step_t;
 
 
@@ -158,6 +181,16 @@ typedef enum
 } fds_delete_step_t;
 
 
+typedef enum
+{
+    FDS_OP_TXN_BEGIN,               // Write the transaction header, except the commit word.
+    FDS_OP_TXN_RECORD_HEADER,       // Write the header of a record.
+    FDS_OP_TXN_CHUNKS,              // Write the record data.
+    FDS_OP_TXN_COMMIT,              // Write the commit word of the transaction header.
+    FDS_OP_TXN_FLAG_DIRTY,          // Flag the records replaced by the transaction as dirty.
+} fds_txn_step_t;
+
+
 #if defined(__CC_ARM)
     #pragma push
     #pragma anon_unions
@@ -192,6 +225,21 @@ typedef struct
             uint16_t          record_key;
             uint32_t          record_to_delete;
         } del;
+        struct
+        {
+            bool              background;       // Collect one page only.
+        } gc;
+        struct
+        {
+            fds_txn_step_t    step;
+            uint16_t          page;             // The page the flash space for this command was reserved.
+            uint16_t          length_words;     // The length of the transaction after its header, in 4-byte words.
+            uint16_t          offset;           // Offset of the next write from the transaction header, in 4-byte words.
+            uint16_t          replaced;         // The number of replaced records which have been flagged as dirty.
+            uint8_t           record;           // The record being written.
+            uint8_t           record_chunks;    // Number of chunks left to write for this record.
+            uint8_t           chunk_count;      // Number of chunks left to write for the transaction.
+        } txn;
     };
 } fds_op_t;
 
@@ -288,9 +336,51 @@ typedef struct
     uint16_t         run_count;                 // Total number of times GC was run.
     bool             do_gc_page[FDS_MAX_PAGES]; // Controls which pages to garbage collect.
     bool             resume;                    // Whether or not GC should be resumed.
+    bool             single_page;               // Stop after one page (background GC).
+    bool             page_collected;            // A page was collected since GC began.
 } fds_gc_data_t;
 
 
+#if (FDS_TXN_MAX_RECORDS > 0)
+
+// A queued transaction. The headers are kept here, because they are written to flash from RAM.
+typedef struct
+{
+    // The transaction header: the key and length, the commit word, the number of records replaced,
+    // and the IDs of those records. The commit word is written last.
+    uint32_t         header[FDS_HEADER_SIZE + FDS_TXN_MAX_RECORDS];
+    fds_header_t     record[FDS_TXN_MAX_RECORDS];       // The headers of the records.
+    uint8_t          num_chunks[FDS_TXN_MAX_RECORDS];   // The number of chunks of each record.
+    uint16_t         count;                             // The number of records.
+    bool             is_queued;                         // Whether a transaction is queued.
+} fds_txn_t;
+
+#endif // FDS_TXN_MAX_RECORDS
+
+
+#if (FDS_RECORD_INDEX_SIZE > 0)
+
+// An entry of the RAM record index. The file ID and record key are copies of the ones in the
+// record header, so that lookups do not have to read flash.
+typedef struct
+{
+    uint32_t const * p_record;      // The address of the record, or NULL if the entry is free.
+    uint16_t         file_id;       // The file ID of the record.
+    uint16_t         record_key;    // The record key of the record.
+} fds_index_entry_t;
+
+
+// Open-addressed hash table of the valid records, keyed by file ID and record key.
+typedef struct
+{
+    fds_index_entry_t entry[FDS_RECORD_INDEX_SIZE];
+    uint16_t          count;        // The number of used entries.
+    bool              is_valid;     // False if the index is not complete, e.g., because it is full.
+} fds_index_t;
+
+#endif
+
+
 // Macros to enable and disable application interrupts.
 #if defined (FDS_THREADS)
 
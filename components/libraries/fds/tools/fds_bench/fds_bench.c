@@ -0,0 +1,755 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* FDS benchmark for a PC host.
+ *
+ * Runs fds.c on top of the RAM flash emulator in fstorage_ram.c and drives it with workloads
+ * modeled on typical FDS users. For each workload it reports:
+ * - flash operations and words written per logical write (write amplification),
+ * - page erases, garbage collection frequency and the spread of erases over the pages,
+ * - the simulated latency of writes, including waiting for garbage collection,
+ * - the worst-case host time spent in queue_process(), which runs from the fstorage callback
+ *   and from the FDS API functions.
+ *
+ * bond_txn is bond_churn with the records written together stored in one transaction
+ * (FDS_TXN_MAX_RECORDS). It writes the same records, so its flash operations and latency per
+ * write compare directly with bond_churn.
+ *
+ * find writes one-word records, eight keys per file, until flash is full, and times
+ * fds_record_find() each time the number of records doubles. It prints the host time of a lookup
+ * of a stored record and of a missing key against the number of records. With
+ * FDS_RECORD_INDEX_SIZE, lookups use the RAM index while it holds all records, and scan flash
+ * after it has filled up.
+ *
+ * The flash is left idle between writes until the queue is empty, so background garbage
+ * collection (FDS_GC_BACKGROUND_WORDS) runs between writes and does not delay them.
+ *
+ * Usage: fds_bench [workload [writes]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "sdk_common.h"
+#include "fds.h"
+#include "fstorage_ram.h"
+
+
+#define BENCH_WRITES_DEFAULT    (2000)  // Logical writes per workload.
+
+#define BOND_SLOTS              (8)     // Number of bonds kept, like a peer manager database.
+#define BOND_KEY_BONDING        (1)     // Bonding data: keys and address.
+#define BOND_KEY_CCCD           (2)     // Local GATT database: CCCD values.
+#define BOND_KEY_SC_PENDING     (3)     // Service changed pending flag.
+#define BOND_WORDS_BONDING      (20)
+#define BOND_WORDS_CCCD         (8)
+
+#define CALIB_FILE              (0x2000)
+#define CALIB_KEY               (1)
+#define CALIB_WORDS             (64)    // A 256 byte sensor calibration snapshot.
+
+#define COUNTER_FILE            (0x3000)
+#define COUNTER_KEY             (1)
+
+#define FIND_FILE               (0x4000)
+#define FIND_KEYS_PER_FILE      (8)
+#define FIND_RECORDS_FIRST      (16)    // Record count of the first lookup measurement.
+#define FIND_STEPS_MAX          (16)
+#define FIND_LOOKUPS            (20000) // Lookups timed at each record count.
+
+
+typedef struct
+{
+    uint32_t writes;            // Logical writes: record writes and updates.
+    uint32_t deletes;           // Record and file deletes.
+    uint64_t payload_words;     // Words of record data written.
+    uint32_t gc_runs;           // Garbage collections run because flash was full.
+    uint32_t gc_events;         // All garbage collections, including background ones.
+    uint64_t gc_us_max;         // Longest garbage collection run because flash was full, in simulated microseconds.
+    uint64_t write_us_total;    // Simulated write latency, from the API call to the event.
+    uint64_t write_us_max;
+    uint64_t api_ns_max;        // Longest host time spent in an FDS API call.
+} bench_stats_t;
+
+
+typedef struct
+{
+    uint32_t records;           // Records in flash.
+    double   found_ns;          // Host time of a lookup of a stored record.
+    double   missing_ns;        // Host time of a lookup of a key that is not stored.
+} find_step_t;
+
+
+static bench_stats_t m_bench;
+static find_step_t   m_find_steps[FIND_STEPS_MAX];
+static uint32_t      m_find_step_count;
+static fds_evt_t     m_evt;         // The last event other than FDS_EVT_GC.
+static uint64_t      m_evt_us;      // Simulated time of m_evt.
+static fds_evt_t     m_gc_evt;      // The last FDS_EVT_GC event.
+static uint32_t      m_rand = 1;
+
+
+// Background garbage collection can send FDS_EVT_GC at any time, so it is kept apart from the
+// events of the operations the benchmark waits for.
+static void fds_evt_handler(fds_evt_t const * const p_evt)
+{
+    if (p_evt->id == FDS_EVT_GC)
+    {
+        m_gc_evt = *p_evt;
+        m_bench.gc_events++;
+    }
+    else
+    {
+        m_evt    = *p_evt;
+        m_evt_us = fs_ram_time_get();
+    }
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static uint32_t bench_rand(void)
+{
+    m_rand = (m_rand * 1103515245UL) + 12345UL;
+    return (m_rand >> 16);
+}
+
+
+// FDS API functions run queue_process() synchronously when the queue is idle.
+static void api_time_record(uint64_t start_ns)
+{
+    uint64_t const elapsed = host_time_ns() - start_ns;
+
+    if (elapsed > m_bench.api_ns_max)
+    {
+        m_bench.api_ns_max = elapsed;
+    }
+}
+
+
+static ret_code_t gc_run(void)
+{
+    uint64_t const start    = fs_ram_time_get();
+    uint64_t const start_ns = host_time_ns();
+    ret_code_t     ret      = fds_gc();
+
+    api_time_record(start_ns);
+    if (ret != FDS_SUCCESS)
+    {
+        return ret;
+    }
+
+    fs_ram_run();
+
+    m_bench.gc_runs++;
+    if ((fs_ram_time_get() - start) > m_bench.gc_us_max)
+    {
+        m_bench.gc_us_max = fs_ram_time_get() - start;
+    }
+
+    return m_gc_evt.result;
+}
+
+
+// A record to store, for the workloads which can store several records at once.
+typedef struct
+{
+    fds_record_desc_t * p_desc;
+    uint16_t            file_id;
+    uint16_t            key;
+    uint32_t    const * p_data;
+    uint16_t            length_words;
+    bool                update;
+} bond_record_t;
+
+
+// Waits for a write started at the simulated time start, and accounts for its records. All
+// records of a transaction have the latency of the transaction.
+static ret_code_t write_complete(uint64_t start, uint16_t records, uint32_t payload_words)
+{
+    fs_ram_run();
+    if (m_evt.result != FDS_SUCCESS)
+    {
+        return m_evt.result;
+    }
+
+    m_bench.writes         += records;
+    m_bench.payload_words  += payload_words;
+    m_bench.write_us_total += (m_evt_us - start) * records;
+    if ((m_evt_us - start) > m_bench.write_us_max)
+    {
+        m_bench.write_us_max = m_evt_us - start;
+    }
+
+    return FDS_SUCCESS;
+}
+
+
+// Writes or updates a record. If flash is full, runs garbage collection and retries once.
+static ret_code_t record_store(fds_record_desc_t * const p_desc,
+                               uint16_t                  file_id,
+                               uint16_t                  key,
+                               uint32_t          const * p_data,
+                               uint16_t                  length_words,
+                               bool                      update)
+{
+    uint64_t     const start   = fs_ram_time_get();
+    bool               gc_done = false;
+    ret_code_t         ret;
+    fds_record_chunk_t chunk;
+    fds_record_t       record;
+
+    chunk.p_data           = p_data;
+    chunk.length_words     = length_words;
+    record.file_id         = file_id;
+    record.key             = key;
+    record.data.p_chunks   = &chunk;
+    record.data.num_chunks = 1;
+
+    for (;;)
+    {
+        uint64_t const start_ns = host_time_ns();
+
+        ret = update ? fds_record_update(p_desc, &record) : fds_record_write(p_desc, &record);
+        api_time_record(start_ns);
+
+        if ((ret != FDS_ERR_NO_SPACE_IN_FLASH) || gc_done)
+        {
+            break;
+        }
+
+        ret = gc_run();
+        if (ret != FDS_SUCCESS)
+        {
+            return ret;
+        }
+        gc_done = true;
+    }
+
+    if (ret != FDS_SUCCESS)
+    {
+        return ret;
+    }
+
+    return write_complete(start, 1, length_words);
+}
+
+
+#if FDS_TXN_MAX_RECORDS > 0
+// Writes or updates the records of a bond_record_t array in one transaction. If flash is full,
+// runs garbage collection and retries once.
+static ret_code_t txn_store(bond_record_t const * const p_records, uint16_t count)
+{
+    uint64_t     const start   = fs_ram_time_get();
+    bool               gc_done = false;
+    uint32_t           payload = 0;
+    ret_code_t         ret;
+    fds_record_chunk_t chunks [FDS_TXN_MAX_RECORDS];
+    fds_record_t       records[FDS_TXN_MAX_RECORDS];
+    fds_txn_record_t   txn    [FDS_TXN_MAX_RECORDS];
+
+    for (uint16_t i = 0; i < count; i++)
+    {
+        chunks[i].p_data            = p_records[i].p_data;
+        chunks[i].length_words      = p_records[i].length_words;
+        records[i].file_id          = p_records[i].file_id;
+        records[i].key              = p_records[i].key;
+        records[i].data.p_chunks    = &chunks[i];
+        records[i].data.num_chunks  = 1;
+        txn[i].p_record             = &records[i];
+        txn[i].p_desc               = p_records[i].p_desc;
+        txn[i].update               = p_records[i].update;
+        payload                    += p_records[i].length_words;
+    }
+
+    for (;;)
+    {
+        uint64_t const start_ns = host_time_ns();
+
+        ret = fds_txn_write(txn, count);
+        api_time_record(start_ns);
+
+        if ((ret != FDS_ERR_NO_SPACE_IN_FLASH) || gc_done)
+        {
+            break;
+        }
+
+        ret = gc_run();
+        if (ret != FDS_SUCCESS)
+        {
+            return ret;
+        }
+        gc_done = true;
+    }
+
+    if (ret != FDS_SUCCESS)
+    {
+        return ret;
+    }
+
+    return write_complete(start, count, payload);
+}
+#endif
+
+
+// Stores the records of a bond_record_t array, one at a time or in one transaction.
+static ret_code_t bond_records_store(bond_record_t const * const p_records,
+                                     uint16_t                    count,
+                                     bool                        use_txn)
+{
+    ret_code_t ret = FDS_SUCCESS;
+
+#if FDS_TXN_MAX_RECORDS > 0
+    if (use_txn)
+    {
+        return txn_store(p_records, count);
+    }
+#endif
+
+    for (uint16_t i = 0; (i < count) && (ret == FDS_SUCCESS); i++)
+    {
+        ret = record_store(p_records[i].p_desc, p_records[i].file_id, p_records[i].key,
+                           p_records[i].p_data, p_records[i].length_words, p_records[i].update);
+    }
+
+    return ret;
+}
+
+
+static ret_code_t file_delete(uint16_t file_id)
+{
+    uint64_t const start_ns = host_time_ns();
+    ret_code_t     ret      = fds_file_delete(file_id);
+
+    api_time_record(start_ns);
+    if (ret != FDS_SUCCESS)
+    {
+        return ret;
+    }
+
+    fs_ram_run();
+    m_bench.deletes++;
+
+    return m_evt.result;
+}
+
+
+// Bonding with new peers, replacing the oldest bond when all slots are used, with reconnections
+// to bonded peers in between which update their CCCDs and service changed flag. With use_txn,
+// the records written together are stored in one transaction.
+static ret_code_t bond_churn_run(uint32_t writes, bool use_txn)
+{
+    static uint32_t   bonding[BOND_SLOTS][BOND_WORDS_BONDING];
+    static uint32_t   cccd[BOND_SLOTS][BOND_WORDS_CCCD];
+    static uint32_t   sc_pending[BOND_SLOTS];
+    fds_record_desc_t desc_cccd[BOND_SLOTS];
+    fds_record_desc_t desc_sc[BOND_SLOTS];
+    fds_record_desc_t desc;
+    bond_record_t     records[3];
+    uint16_t          count;
+    uint32_t          bonds    = 0;
+    uint32_t          next     = 0;
+    ret_code_t        ret      = FDS_SUCCESS;
+
+    memset(desc_cccd, 0x00, sizeof(desc_cccd));
+    memset(desc_sc,   0x00, sizeof(desc_sc));
+
+    for (uint32_t i = 0; (m_bench.writes < writes) && (ret == FDS_SUCCESS); i++)
+    {
+        if ((bonds == 0) || ((bench_rand() % 4) == 0))
+        {
+            // New bond.
+            uint16_t const peer = next;
+
+            next = (next + 1) % BOND_SLOTS;
+            if (bonds == BOND_SLOTS)
+            {
+                ret = file_delete(peer);
+            }
+            else
+            {
+                bonds++;
+            }
+
+            memset(bonding[peer], (int)bench_rand(), sizeof(bonding[peer]));
+            memset(cccd[peer], 0x00, sizeof(cccd[peer]));
+            sc_pending[peer] = 0;
+
+            records[0] = (bond_record_t){&desc, peer, BOND_KEY_BONDING, bonding[peer],
+                                         BOND_WORDS_BONDING, false};
+            records[1] = (bond_record_t){&desc_cccd[peer], peer, BOND_KEY_CCCD, cccd[peer],
+                                         BOND_WORDS_CCCD, false};
+            records[2] = (bond_record_t){&desc_sc[peer], peer, BOND_KEY_SC_PENDING,
+                                         &sc_pending[peer], 1, false};
+            count      = 3;
+        }
+        else
+        {
+            // Reconnection to a bonded peer.
+            uint16_t const peer = bench_rand() % bonds;
+
+            cccd[peer][bench_rand() % BOND_WORDS_CCCD] ^= 0x0001;
+            records[0] = (bond_record_t){&desc_cccd[peer], peer, BOND_KEY_CCCD, cccd[peer],
+                                         BOND_WORDS_CCCD, true};
+            count      = 1;
+
+            if ((bench_rand() % 2) == 0)
+            {
+                sc_pending[peer] ^= 1;
+                records[1] = (bond_record_t){&desc_sc[peer], peer, BOND_KEY_SC_PENDING,
+                                             &sc_pending[peer], 1, true};
+                count      = 2;
+            }
+        }
+
+        if (ret == FDS_SUCCESS)
+        {
+            ret = bond_records_store(records, count, use_txn && (count > 1));
+        }
+    }
+
+    return ret;
+}
+
+
+static ret_code_t workload_bond_churn(uint32_t writes)
+{
+    return bond_churn_run(writes, false);
+}
+
+
+#if FDS_TXN_MAX_RECORDS > 0
+static ret_code_t workload_bond_txn(uint32_t writes)
+{
+    return bond_churn_run(writes, true);
+}
+#endif
+
+
+// Periodic snapshots of a calibration table.
+static ret_code_t workload_calibration(uint32_t writes)
+{
+    static uint32_t   calib[CALIB_WORDS];
+    fds_record_desc_t desc;
+    ret_code_t        ret = FDS_SUCCESS;
+
+    memset(&desc, 0x00, sizeof(desc));
+
+    for (uint32_t i = 0; (i < writes) && (ret == FDS_SUCCESS); i++)
+    {
+        calib[bench_rand() % CALIB_WORDS] = bench_rand();
+        ret = record_store(&desc, CALIB_FILE, CALIB_KEY, calib, CALIB_WORDS, (i > 0));
+    }
+
+    return ret;
+}
+
+
+// A counter which is stored every time it changes, like a boot or event counter.
+static ret_code_t workload_counter(uint32_t writes)
+{
+    static uint32_t   counter;
+    fds_record_desc_t desc;
+    ret_code_t        ret = FDS_SUCCESS;
+
+    memset(&desc, 0x00, sizeof(desc));
+
+    for (uint32_t i = 0; (i < writes) && (ret == FDS_SUCCESS); i++)
+    {
+        counter++;
+        ret = record_store(&desc, COUNTER_FILE, COUNTER_KEY, &counter, 1, (i > 0));
+    }
+
+    return ret;
+}
+
+
+// Finds the record with the given number, as stored by workload_find().
+static ret_code_t find_record(uint32_t number, fds_record_desc_t * const p_desc)
+{
+    fds_find_token_t token;
+
+    memset(&token, 0x00, sizeof(token));
+    return fds_record_find(FIND_FILE + (number / FIND_KEYS_PER_FILE),
+                           1 + (number % FIND_KEYS_PER_FILE), p_desc, &token);
+}
+
+
+// Checks that each of the stored records is found and holds its number, then times lookups of
+// stored records and of keys which are not stored.
+static ret_code_t find_step_run(uint32_t records)
+{
+    find_step_t * const p_step = &m_find_steps[m_find_step_count++];
+    fds_record_desc_t   desc;
+    fds_find_token_t    token;
+    uint64_t            start_ns;
+
+    for (uint32_t i = 0; i < records; i++)
+    {
+        fds_flash_record_t record;
+        ret_code_t         ret = find_record(i, &desc);
+
+        if (ret == FDS_SUCCESS)
+        {
+            ret = fds_record_open(&desc, &record);
+        }
+        if (ret != FDS_SUCCESS)
+        {
+            return ret;
+        }
+        if (*(uint32_t const *)record.p_data != i)
+        {
+            (void)fds_record_close(&desc);
+            return FDS_ERR_NOT_FOUND;
+        }
+        ret = fds_record_close(&desc);
+        if (ret != FDS_SUCCESS)
+        {
+            return ret;
+        }
+    }
+
+    start_ns = host_time_ns();
+    for (uint32_t i = 0; i < FIND_LOOKUPS; i++)
+    {
+        if (find_record(bench_rand() % records, &desc) != FDS_SUCCESS)
+        {
+            return FDS_ERR_NOT_FOUND;
+        }
+    }
+    p_step->found_ns = (double)(host_time_ns() - start_ns) / FIND_LOOKUPS;
+
+    start_ns = host_time_ns();
+    for (uint32_t i = 0; i < FIND_LOOKUPS; i++)
+    {
+        uint32_t const number = bench_rand() % records;
+
+        memset(&token, 0x00, sizeof(token));
+        if (fds_record_find(FIND_FILE + (number / FIND_KEYS_PER_FILE), FIND_KEYS_PER_FILE + 1,
+                            &desc, &token) != FDS_ERR_NOT_FOUND)
+        {
+            return FDS_ERR_NOT_FOUND;
+        }
+    }
+    p_step->missing_ns = (double)(host_time_ns() - start_ns) / FIND_LOOKUPS;
+    p_step->records    = records;
+
+    return FDS_SUCCESS;
+}
+
+
+// Lookups by file ID and record key, as peer_manager does on every connection, against the
+// number of records in flash. Writes until flash is full or writes records are stored.
+static ret_code_t workload_find(uint32_t writes)
+{
+    fds_record_desc_t desc;
+    uint32_t          records = 0;
+    uint32_t          next    = FIND_RECORDS_FIRST;
+    ret_code_t        ret     = FDS_SUCCESS;
+
+    while ((records < writes) && (ret == FDS_SUCCESS))
+    {
+        uint32_t data = records;
+
+        ret = record_store(&desc, FIND_FILE + (records / FIND_KEYS_PER_FILE),
+                           1 + (records % FIND_KEYS_PER_FILE), &data, 1, false);
+        if (ret != FDS_SUCCESS)
+        {
+            break;
+        }
+        records++;
+
+        if ((records == next) && (m_find_step_count < (FIND_STEPS_MAX - 1)))
+        {
+            ret   = find_step_run(records);
+            next *= 2;
+        }
+    }
+
+    // Flash is full: measure with all records stored as well.
+    if (ret == FDS_ERR_NO_SPACE_IN_FLASH)
+    {
+        ret = FDS_SUCCESS;
+    }
+    if ((ret == FDS_SUCCESS) && (records > 0) && (records != (next / 2)))
+    {
+        ret = find_step_run(records);
+    }
+
+    return ret;
+}
+
+
+static void workload_find_report(void)
+{
+    printf("%12s %8s %8s %8s\n", "", "records", "found ns", "miss ns");
+    for (uint32_t i = 0; i < m_find_step_count; i++)
+    {
+        printf("%12s %8u %8.1f %8.1f\n", "", (unsigned)m_find_steps[i].records,
+               m_find_steps[i].found_ns, m_find_steps[i].missing_ns);
+    }
+}
+
+
+typedef struct
+{
+    char const * p_name;
+    ret_code_t (*run)(uint32_t writes);
+    void       (*report)(void);     // Prints results beyond the common columns, or NULL.
+} workload_t;
+
+static workload_t const m_workloads[] =
+{
+    {"bond_churn",  workload_bond_churn,  NULL},
+#if FDS_TXN_MAX_RECORDS > 0
+    {"bond_txn",    workload_bond_txn,    NULL},
+#endif
+    {"calibration", workload_calibration, NULL},
+    {"counter",     workload_counter,     NULL},
+    {"find",        workload_find,        workload_find_report},
+};
+
+
+// Finds the lowest and highest erase counts of the pages used by FDS.
+static void page_erases_get(uint32_t * const p_min, uint32_t * const p_max)
+{
+    *p_min = UINT32_MAX;
+    *p_max = 0;
+
+    for (uint16_t i = 0; i < FDS_VIRTUAL_PAGES; i++)
+    {
+        fds_page_stat_t stat;
+
+        if (fds_page_stat(i, &stat) == FDS_SUCCESS)
+        {
+            *p_min = MIN(*p_min, stat.erase_count);
+            *p_max = MAX(*p_max, stat.erase_count);
+        }
+    }
+}
+
+
+static int workload_run(workload_t const * p_workload, uint32_t writes)
+{
+    fs_ram_stats_t flash;
+    ret_code_t     ret;
+    uint64_t       queue_process_ns;
+    uint32_t       erases_min;
+    uint32_t       erases_max;
+
+    if ((fds_register(fds_evt_handler) != FDS_SUCCESS) || (fds_init() != FDS_SUCCESS))
+    {
+        printf("%-12s fds_init failed\n", p_workload->p_name);
+        return 1;
+    }
+    fs_ram_run();
+    if ((m_evt.id != FDS_EVT_INIT) || (m_evt.result != FDS_SUCCESS))
+    {
+        printf("%-12s fds_init failed\n", p_workload->p_name);
+        return 1;
+    }
+    fs_ram_stats_reset();
+
+    ret = p_workload->run(writes);
+    fs_ram_stats_get(&flash);
+
+    if (ret != FDS_SUCCESS)
+    {
+        printf("%-12s failed after %u writes: error 0x%x\n",
+               p_workload->p_name, (unsigned)m_bench.writes, (unsigned)ret);
+        return 1;
+    }
+
+    queue_process_ns = MAX(flash.callback_max_ns, m_bench.api_ns_max);
+    page_erases_get(&erases_min, &erases_max);
+
+    printf("%-12s %6u %8.2f %8.2f %6u %5u %5u %8.1f %8.1f %8.2f %8.1f %8.1f %4u-%-4u\n",
+           p_workload->p_name,
+           (unsigned)m_bench.writes,
+           (double)(flash.store_ops + flash.erase_ops) / m_bench.writes,
+           (double)flash.words_written / m_bench.payload_words,
+           (unsigned)flash.pages_erased,
+           (unsigned)m_bench.gc_runs,
+           (unsigned)(m_bench.gc_events - m_bench.gc_runs),
+           m_bench.gc_events ? (double)m_bench.writes / m_bench.gc_events : 0.0,
+           m_bench.gc_us_max / 1000.0,
+           (double)m_bench.write_us_total / m_bench.writes / 1000.0,
+           m_bench.write_us_max / 1000.0,
+           queue_process_ns / 1000.0,
+           (unsigned)erases_min,
+           (unsigned)erases_max);
+
+    if (p_workload->report != NULL)
+    {
+        p_workload->report();
+    }
+
+    return 0;
+}
+
+
+int main(int argc, char ** argv)
+{
+    uint32_t writes = BENCH_WRITES_DEFAULT;
+    int      failed = 0;
+
+    if (argc > 2)
+    {
+        writes = (uint32_t)strtoul(argv[2], NULL, 0);
+    }
+
+    printf("FDS: %u pages of %u words, record index %u entries, background GC at %u words. "
+           "Flash: %u us/word, %u us/page erase.\n\n",
+           FDS_VIRTUAL_PAGES, FDS_VIRTUAL_PAGE_SIZE, FDS_RECORD_INDEX_SIZE,
+           FDS_GC_BACKGROUND_WORDS, FS_RAM_WORD_WRITE_US, FS_RAM_PAGE_ERASE_US);
+    printf("%-12s %6s %8s %8s %6s %5s %5s %8s %8s %8s %8s %8s %9s\n",
+           "", "", "flash", "words/", "page", "full", "bg", "writes/", "GC max", "write", "write",
+           "q_proc", "page");
+    printf("%-12s %6s %8s %8s %6s %5s %5s %8s %8s %8s %8s %8s %9s\n",
+           "workload", "writes", "ops/wr", "payload", "erases", "GCs", "GCs", "GC", "ms", "avg ms",
+           "max ms", "max us", "erases");
+
+    // FDS cannot be reset, so each workload runs in its own process.
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_workloads); i++)
+    {
+        pid_t pid;
+        int   status;
+
+        if ((argc > 1) && (strcmp(argv[1], m_workloads[i].p_name) != 0))
+        {
+            continue;
+        }
+
+        fflush(stdout);
+        pid = fork();
+        if (pid == 0)
+        {
+            exit(workload_run(&m_workloads[i], writes));
+        }
+        if ((pid < 0) || (waitpid(pid, &status, 0) != pid) ||
+            !WIFEXITED(status) || (WEXITSTATUS(status) != 0))
+        {
+            failed = 1;
+        }
+    }
+
+    return failed;
+}
@@ -0,0 +1,67 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Configuration of the FDS benchmark. The FDS values match ble_app_hids_mouse, and can be
+ * overridden from the make command line, for example: make run FDS_VIRTUAL_PAGES=4 */
+
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+#define FDS_ENABLED 1
+
+#ifndef FDS_OP_QUEUE_SIZE
+#define FDS_OP_QUEUE_SIZE 4
+#endif
+
+#ifndef FDS_CHUNK_QUEUE_SIZE
+#define FDS_CHUNK_QUEUE_SIZE 8
+#endif
+
+#ifndef FDS_MAX_USERS
+#define FDS_MAX_USERS 8
+#endif
+
+#ifndef FDS_VIRTUAL_PAGES
+#define FDS_VIRTUAL_PAGES 3
+#endif
+
+#ifndef FDS_VIRTUAL_PAGE_SIZE
+#define FDS_VIRTUAL_PAGE_SIZE 1024
+#endif
+
+#ifndef FDS_RECORD_INDEX_SIZE
+#define FDS_RECORD_INDEX_SIZE 32
+#endif
+
+#ifndef FDS_GC_BACKGROUND_WORDS
+#define FDS_GC_BACKGROUND_WORDS 768
+#endif
+
+#ifndef FDS_TXN_MAX_RECORDS
+#define FDS_TXN_MAX_RECORDS 8
+#endif
+
+#define FSTORAGE_ENABLED 1
+
+#ifndef FS_QUEUE_SIZE
+#define FS_QUEUE_SIZE 4
+#endif
+
+#ifndef FS_OP_MAX_RETRIES
+#define FS_OP_MAX_RETRIES 3
+#endif
+
+#ifndef FS_MAX_WRITE_SIZE_WORDS
+#define FS_MAX_WRITE_SIZE_WORDS 1024
+#endif
+
+#endif // SDK_CONFIG_H
@@ -21,6 +21,7 @@ static __INLINE uint32_t fifo_length(app_fifo_t * p_fifo)
 
 
 #define FIFO_LENGTH() fifo_length(p_fifo)  /**< Macro for calculating the FIFO length. */
+#define FIFO_BULK_MIN_LEN 8                 /**< Transfers shorter than this are copied byte by byte, which is cheaper than calling memcpy. */
 
 
 /**@brief Put one byte to the FIFO. */
@@ -46,6 +47,56 @@ static __INLINE void fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte)
 }
 
 
+/**@brief Put a number of bytes to the FIFO, with at most two copies around the end of the buffer. */
+static __INLINE void fifo_put_bulk(app_fifo_t * p_fifo, uint8_t const * p_bytes, uint32_t len)
+{
+    uint32_t const offset = p_fifo->write_pos & p_fifo->buf_size_mask;
+    uint32_t const first  = MIN(len, p_fifo->buf_size_mask + 1 - offset);
+
+    if (len < FIFO_BULK_MIN_LEN)
+    {
+        for (uint32_t i = 0; i < len; i++)
+        {
+            p_fifo->p_buf[(offset + i) & p_fifo->buf_size_mask] = p_bytes[i];
+        }
+    }
+    else
+    {
+        memcpy(&p_fifo->p_buf[offset], p_bytes, first);
+        if (first < len)
+        {
+            memcpy(p_fifo->p_buf, p_bytes + first, len - first);
+        }
+    }
+    p_fifo->write_pos += len;
+}
+
+
+/**@brief Get a number of bytes from the FIFO, with at most two copies around the end of the buffer. */
+static __INLINE void fifo_get_bulk(app_fifo_t * p_fifo, uint8_t * p_bytes, uint32_t len)
+{
+    uint32_t const offset = p_fifo->read_pos & p_fifo->buf_size_mask;
+    uint32_t const first  = MIN(len, p_fifo->buf_size_mask + 1 - offset);
+
+    if (len < FIFO_BULK_MIN_LEN)
+    {
+        for (uint32_t i = 0; i < len; i++)
+        {
+            p_bytes[i] = p_fifo->p_buf[(offset + i) & p_fifo->buf_size_mask];
+        }
+    }
+    else
+    {
+        memcpy(p_bytes, &p_fifo->p_buf[offset], first);
+        if (first < len)
+        {
+            memcpy(p_bytes + first, p_fifo->p_buf, len - first);
+        }
+    }
+    p_fifo->read_pos += len;
+}
+
+
 uint32_t app_fifo_init(app_fifo_t * p_fifo, uint8_t * p_buf, uint16_t buf_size)
 {
     // Check buffer for null pointer.
@@ -120,7 +171,6 @@ uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p
 
     const uint32_t byte_count    = fifo_length(p_fifo);
     const uint32_t requested_len = (*p_size);
-    uint32_t       index         = 0;
     uint32_t       read_size     = MIN(requested_len, byte_count);
 
     (*p_size) = byte_count;
@@ -138,10 +188,7 @@ uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p
     }
 
     // Fetch bytes from the FIFO.
-    while (index < read_size)
-    {
-        fifo_get(p_fifo, &p_byte_array[index++]);
-    }
+    fifo_get_bulk(p_fifo, p_byte_array, read_size);
 
     (*p_size) = read_size;
 
@@ -156,7 +203,6 @@ uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint3
 
     const uint32_t available_count = p_fifo->buf_size_mask - fifo_length(p_fifo) + 1;
     const uint32_t requested_len   = (*p_size);
-    uint32_t       index           = 0;
     uint32_t       write_size      = MIN(requested_len, available_count);
 
     (*p_size) = available_count;
@@ -173,13 +219,84 @@ uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint3
         return NRF_SUCCESS;
     }
 
-    //Fetch bytes from the FIFO.
-    while (index < write_size)
+    // Store bytes in the FIFO.
+    fifo_put_bulk(p_fifo, p_byte_array, write_size);
+
+    (*p_size) = write_size;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_read_acquire(app_fifo_t * p_fifo, uint8_t ** pp_data, uint32_t * p_size)
+{
+    VERIFY_PARAM_NOT_NULL(p_fifo);
+    VERIFY_PARAM_NOT_NULL(pp_data);
+    VERIFY_PARAM_NOT_NULL(p_size);
+
+    const uint32_t byte_count = fifo_length(p_fifo);
+    const uint32_t offset     = p_fifo->read_pos & p_fifo->buf_size_mask;
+
+    // The span ends at the end of the buffer, even if the FIFO wraps around.
+    (*p_size)  = MIN(byte_count, p_fifo->buf_size_mask + 1 - offset);
+    (*pp_data) = &p_fifo->p_buf[offset];
+
+    if (byte_count == 0)
     {
-        fifo_put(p_fifo, p_byte_array[index++]);
+        return NRF_ERROR_NOT_FOUND;
     }
 
-    (*p_size) = write_size;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_read_commit(app_fifo_t * p_fifo, uint32_t size)
+{
+    VERIFY_PARAM_NOT_NULL(p_fifo);
+
+    if (size > fifo_length(p_fifo))
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    p_fifo->read_pos += size;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_write_acquire(app_fifo_t * p_fifo, uint8_t ** pp_data, uint32_t * p_size)
+{
+    VERIFY_PARAM_NOT_NULL(p_fifo);
+    VERIFY_PARAM_NOT_NULL(pp_data);
+    VERIFY_PARAM_NOT_NULL(p_size);
+
+    const uint32_t available_count = p_fifo->buf_size_mask - fifo_length(p_fifo) + 1;
+    const uint32_t offset          = p_fifo->write_pos & p_fifo->buf_size_mask;
+
+    // The span ends at the end of the buffer, even if there is free space at its start.
+    (*p_size)  = MIN(available_count, p_fifo->buf_size_mask + 1 - offset);
+    (*pp_data) = &p_fifo->p_buf[offset];
+
+    if (available_count == 0)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_fifo_write_commit(app_fifo_t * p_fifo, uint32_t size)
+{
+    VERIFY_PARAM_NOT_NULL(p_fifo);
+
+    if (size > p_fifo->buf_size_mask - fifo_length(p_fifo) + 1)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    p_fifo->write_pos += size;
 
     return NRF_SUCCESS;
 }
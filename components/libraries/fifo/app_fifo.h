@@ -144,6 +144,59 @@ uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p
  */
 uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint32_t * p_size);
 
+/**@brief Function for getting direct access to the bytes at the head of the FIFO.
+ *
+ * The bytes are not consumed until @ref app_fifo_read_commit is called. Only the contiguous part
+ * of the FIFO is returned: if the data wraps around the end of the buffer, the rest can be
+ * acquired after the first part has been committed.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO. Must not be NULL.
+ * @param[out] pp_data  Pointer to the first byte in the FIFO buffer.
+ * @param[out] p_size   Number of contiguous bytes which can be read from *pp_data.
+ *
+ * @retval     NRF_SUCCESS          If at least one byte can be read.
+ * @retval     NRF_ERROR_NULL       If a NULL parameter was passed.
+ * @retval     NRF_ERROR_NOT_FOUND  If the FIFO is empty.
+ */
+uint32_t app_fifo_read_acquire(app_fifo_t * p_fifo, uint8_t ** pp_data, uint32_t * p_size);
+
+/**@brief Function for consuming bytes which were read through @ref app_fifo_read_acquire.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO. Must not be NULL.
+ * @param[in]  size     Number of bytes to consume.
+ *
+ * @retval     NRF_SUCCESS              If the bytes were consumed.
+ * @retval     NRF_ERROR_NULL           If a NULL parameter was passed.
+ * @retval     NRF_ERROR_INVALID_LENGTH If there are fewer than size bytes in the FIFO.
+ */
+uint32_t app_fifo_read_commit(app_fifo_t * p_fifo, uint32_t size);
+
+/**@brief Function for getting direct access to the free space at the tail of the FIFO.
+ *
+ * The bytes written to the returned space are not added to the FIFO until
+ * @ref app_fifo_write_commit is called. Only the contiguous part of the free space is returned.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO. Must not be NULL.
+ * @param[out] pp_data  Pointer to the first free byte in the FIFO buffer.
+ * @param[out] p_size   Number of contiguous bytes which can be written to *pp_data.
+ *
+ * @retval     NRF_SUCCESS       If at least one byte can be written.
+ * @retval     NRF_ERROR_NULL    If a NULL parameter was passed.
+ * @retval     NRF_ERROR_NO_MEM  If the FIFO is full.
+ */
+uint32_t app_fifo_write_acquire(app_fifo_t * p_fifo, uint8_t ** pp_data, uint32_t * p_size);
+
+/**@brief Function for adding bytes which were written through @ref app_fifo_write_acquire.
+ *
+ * @param[in]  p_fifo   Pointer to the FIFO. Must not be NULL.
+ * @param[in]  size     Number of bytes to add.
+ *
+ * @retval     NRF_SUCCESS              If the bytes were added.
+ * @retval     NRF_ERROR_NULL           If a NULL parameter was passed.
+ * @retval     NRF_ERROR_INVALID_LENGTH If there is less than size bytes of free space in the FIFO.
+ */
+uint32_t app_fifo_write_commit(app_fifo_t * p_fifo, uint32_t size);
+
 
 #ifdef __cplusplus
 }
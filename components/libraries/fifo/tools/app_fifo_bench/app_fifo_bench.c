@@ -0,0 +1,405 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* app_fifo test and benchmark for a PC host.
+ *
+ * The test writes and reads a byte sequence through a random mix of app_fifo_put/get/peek,
+ * app_fifo_write/read and the acquire/commit functions, with random lengths, and checks the
+ * content, the length and the return codes against a model of the FIFO.
+ *
+ * The benchmark moves the same amount of data through the FIFO in chunks of several sizes, by
+ * writing a chunk and reading it back:
+ * - byte:     app_fifo_put() and app_fifo_get() for each byte, as the FIFO was used before
+ *             app_fifo_write() and app_fifo_read() copied in bulk,
+ * - copy:     app_fifo_write() and app_fifo_read(),
+ * - in place: the acquire and commit functions, copying the chunk to and from the spans.
+ *
+ * Command line: fifo_size=<bytes, power of two> mbytes=<MB moved per run>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "nrf_error.h"
+#include "app_fifo.h"
+
+
+#define FIFO_SIZE_DEFAULT   (1024)
+#define MBYTES_DEFAULT      (64)
+#define TEST_OPS            (200000)    // Random operations in the test.
+
+typedef enum
+{
+    PATH_BYTE,
+    PATH_COPY,
+    PATH_IN_PLACE,
+    PATH_COUNT
+} path_t;
+
+
+static char const * const m_path_names[PATH_COUNT] = {"byte", "copy", "in place"};
+static uint32_t const     m_chunk_sizes[]          = {1, 4, 16, 64, 256};
+
+static uint32_t m_rand = 1;
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+static uint32_t m_write_seq;    // Model: number of bytes written.
+static uint32_t m_read_seq;     // Model: number of bytes read.
+
+
+static void check(bool ok, char const * p_what)
+{
+    m_checks++;
+    if (!ok)
+    {
+        m_failures++;
+        if (m_failures <= 10)
+        {
+            printf("FAILED: %s (written %u, read %u)\n", p_what, m_write_seq, m_read_seq);
+        }
+    }
+}
+
+
+static uint32_t bench_rand(void)
+{
+    m_rand = (m_rand * 1103515245UL) + 12345UL;
+    return (m_rand >> 16);
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static uint8_t seq_byte(uint32_t seq)
+{
+    return (uint8_t)(seq ^ (seq >> 8) ^ (seq >> 16));
+}
+
+
+static void random_write(app_fifo_t * p_fifo, uint32_t fifo_size)
+{
+    uint8_t        buf[FIFO_SIZE_DEFAULT * 4];
+    uint32_t const free_space = fifo_size - (m_write_seq - m_read_seq);
+    uint32_t       len        = bench_rand() % (fifo_size + 4);
+    uint32_t       err_code;
+
+    switch (bench_rand() % 3)
+    {
+        case 0:
+            err_code = app_fifo_put(p_fifo, seq_byte(m_write_seq));
+            check(err_code == ((free_space > 0) ? NRF_SUCCESS : NRF_ERROR_NO_MEM), "put return");
+            if (err_code == NRF_SUCCESS)
+            {
+                m_write_seq++;
+            }
+            break;
+
+        case 1:
+            for (uint32_t i = 0; i < len; i++)
+            {
+                buf[i] = seq_byte(m_write_seq + i);
+            }
+            err_code = app_fifo_write(p_fifo, buf, &len);
+            check(err_code == ((free_space > 0) ? NRF_SUCCESS : NRF_ERROR_NO_MEM), "write return");
+            if (err_code == NRF_SUCCESS)
+            {
+                check(len <= free_space, "write overfills");
+                m_write_seq += len;
+            }
+            else
+            {
+                check(len == 0, "write size when full");
+            }
+            break;
+
+        default:
+        {
+            uint8_t * p_span;
+            uint32_t  span_len;
+
+            err_code = app_fifo_write_acquire(p_fifo, &p_span, &span_len);
+            check(err_code == ((free_space > 0) ? NRF_SUCCESS : NRF_ERROR_NO_MEM), "write acquire return");
+            check(span_len <= free_space, "write span larger than free space");
+            if (err_code != NRF_SUCCESS)
+            {
+                check(app_fifo_write_commit(p_fifo, 1) == NRF_ERROR_INVALID_LENGTH, "commit when full");
+                break;
+            }
+            check((p_span >= p_fifo->p_buf) && (p_span + span_len <= p_fifo->p_buf + fifo_size),
+                  "write span in buffer");
+            len = (len < span_len) ? len : span_len;
+            for (uint32_t i = 0; i < len; i++)
+            {
+                p_span[i] = seq_byte(m_write_seq + i);
+            }
+            check(app_fifo_write_commit(p_fifo, len) == NRF_SUCCESS, "write commit");
+            m_write_seq += len;
+            break;
+        }
+    }
+}
+
+
+static void random_read(app_fifo_t * p_fifo, uint32_t fifo_size)
+{
+    uint8_t        buf[FIFO_SIZE_DEFAULT * 4];
+    uint32_t const count = m_write_seq - m_read_seq;
+    uint32_t       len   = bench_rand() % (fifo_size + 4);
+    uint32_t       err_code;
+    uint8_t        byte;
+
+    switch (bench_rand() % 4)
+    {
+        case 0:
+            err_code = app_fifo_get(p_fifo, &byte);
+            check(err_code == ((count > 0) ? NRF_SUCCESS : NRF_ERROR_NOT_FOUND), "get return");
+            if (err_code == NRF_SUCCESS)
+            {
+                check(byte == seq_byte(m_read_seq), "get content");
+                m_read_seq++;
+            }
+            break;
+
+        case 1:
+            if (count > 0)
+            {
+                uint16_t const index = (uint16_t)(bench_rand() % count);
+
+                check(app_fifo_peek(p_fifo, index, &byte) == NRF_SUCCESS, "peek return");
+                check(byte == seq_byte(m_read_seq + index), "peek content");
+            }
+            check(app_fifo_peek(p_fifo, (uint16_t)count, &byte) == NRF_ERROR_NOT_FOUND, "peek past end");
+            break;
+
+        case 2:
+        {
+            uint32_t size_only = 0;
+
+            err_code = app_fifo_read(p_fifo, NULL, &size_only);
+            check(size_only == count, "read size");
+            err_code = app_fifo_read(p_fifo, buf, &len);
+            check(err_code == ((count > 0) ? NRF_SUCCESS : NRF_ERROR_NOT_FOUND), "read return");
+            if (err_code == NRF_SUCCESS)
+            {
+                check(len <= count, "read past end");
+                for (uint32_t i = 0; i < len; i++)
+                {
+                    check(buf[i] == seq_byte(m_read_seq + i), "read content");
+                }
+                m_read_seq += len;
+            }
+            break;
+        }
+
+        default:
+        {
+            uint8_t * p_span;
+            uint32_t  span_len;
+
+            err_code = app_fifo_read_acquire(p_fifo, &p_span, &span_len);
+            check(err_code == ((count > 0) ? NRF_SUCCESS : NRF_ERROR_NOT_FOUND), "read acquire return");
+            check(span_len <= count, "read span past end");
+            if (err_code != NRF_SUCCESS)
+            {
+                check(app_fifo_read_commit(p_fifo, 1) == NRF_ERROR_INVALID_LENGTH, "commit when empty");
+                break;
+            }
+            check((p_span >= p_fifo->p_buf) && (p_span + span_len <= p_fifo->p_buf + fifo_size),
+                  "read span in buffer");
+            len = (len < span_len) ? len : span_len;
+            for (uint32_t i = 0; i < len; i++)
+            {
+                check(p_span[i] == seq_byte(m_read_seq + i), "read span content");
+            }
+            check(app_fifo_read_commit(p_fifo, len) == NRF_SUCCESS, "read commit");
+            m_read_seq += len;
+            break;
+        }
+    }
+}
+
+
+static void random_test(uint8_t * p_mem, uint32_t fifo_size)
+{
+    app_fifo_t fifo;
+
+    check(app_fifo_init(&fifo, p_mem, (uint16_t)fifo_size) == NRF_SUCCESS, "init");
+    check(app_fifo_init(&fifo, p_mem, (uint16_t)(fifo_size + 1)) == NRF_ERROR_INVALID_LENGTH,
+          "init with a size which is not a power of two");
+    check(app_fifo_init(&fifo, p_mem, (uint16_t)fifo_size) == NRF_SUCCESS, "init");
+
+    for (uint32_t i = 0; i < TEST_OPS; i++)
+    {
+        // Alternate between mostly writing and mostly reading, so that the FIFO fills and drains.
+        bool const writing = ((i / 1000) % 2) == 0;
+
+        if ((bench_rand() % 4) < (writing ? 3 : 1))
+        {
+            random_write(&fifo, fifo_size);
+        }
+        else
+        {
+            random_read(&fifo, fifo_size);
+        }
+        check(m_write_seq - m_read_seq <= fifo_size, "FIFO overfilled");
+    }
+}
+
+
+static void chunk_move(app_fifo_t * p_fifo, path_t path, uint8_t * p_src, uint8_t * p_dst, uint32_t chunk)
+{
+    uint32_t len;
+
+    switch (path)
+    {
+        case PATH_BYTE:
+            for (uint32_t i = 0; i < chunk; i++)
+            {
+                (void)app_fifo_put(p_fifo, p_src[i]);
+            }
+            for (uint32_t i = 0; i < chunk; i++)
+            {
+                (void)app_fifo_get(p_fifo, &p_dst[i]);
+            }
+            break;
+
+        case PATH_COPY:
+            len = chunk;
+            (void)app_fifo_write(p_fifo, p_src, &len);
+            len = chunk;
+            (void)app_fifo_read(p_fifo, p_dst, &len);
+            break;
+
+        default:
+            // A span ends at the end of the buffer, so a chunk can take two of them.
+            for (uint32_t done = 0; done < chunk; done += len)
+            {
+                uint8_t * p_span;
+
+                (void)app_fifo_write_acquire(p_fifo, &p_span, &len);
+                len = (len < chunk - done) ? len : (chunk - done);
+                memcpy(p_span, &p_src[done], len);
+                (void)app_fifo_write_commit(p_fifo, len);
+            }
+            for (uint32_t done = 0; done < chunk; done += len)
+            {
+                uint8_t * p_span;
+
+                (void)app_fifo_read_acquire(p_fifo, &p_span, &len);
+                len = (len < chunk - done) ? len : (chunk - done);
+                memcpy(&p_dst[done], p_span, len);
+                (void)app_fifo_read_commit(p_fifo, len);
+            }
+            break;
+    }
+}
+
+
+static double throughput(uint8_t * p_mem, uint32_t fifo_size, path_t path, uint32_t chunk, uint32_t mbytes)
+{
+    app_fifo_t     fifo;
+    uint8_t        src[256];
+    uint8_t        dst[256];
+    uint32_t const rounds = (uint32_t)(((uint64_t)mbytes * 1000000) / chunk);
+
+    for (uint32_t i = 0; i < chunk; i++)
+    {
+        src[i] = (uint8_t)bench_rand();
+    }
+    (void)app_fifo_init(&fifo, p_mem, (uint16_t)fifo_size);
+
+    // Keep some data in the FIFO, so that the chunks wrap around the end of the buffer.
+    for (uint32_t i = 0; i < (fifo_size / 3 / chunk) * chunk; i++)
+    {
+        (void)app_fifo_put(&fifo, src[i % chunk]);
+    }
+
+    uint64_t const start = host_time_ns();
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        chunk_move(&fifo, path, src, dst, chunk);
+    }
+    uint64_t const elapsed = host_time_ns() - start;
+
+    // The data in the FIFO is a whole number of chunks, so each chunk read back equals src.
+    check(memcmp(src, dst, chunk) == 0, "chunk content");
+    return ((double)chunk * rounds / 1e6) / (elapsed * 1e-9);
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t fifo_size = FIFO_SIZE_DEFAULT;
+    uint32_t mbytes    = MBYTES_DEFAULT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "fifo_size=", 10) == 0)
+        {
+            fifo_size = strtoul(argv[i] + 10, NULL, 0);
+        }
+        else if (strncmp(argv[i], "mbytes=", 7) == 0)
+        {
+            mbytes = strtoul(argv[i] + 7, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [fifo_size=<bytes>] [mbytes=<MB>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((fifo_size < 256) || (fifo_size > FIFO_SIZE_DEFAULT * 4) || ((fifo_size & (fifo_size - 1)) != 0) ||
+        (mbytes == 0))
+    {
+        fprintf(stderr, "fifo_size must be a power of two from 256 to %u, mbytes more than 0\n",
+                FIFO_SIZE_DEFAULT * 4);
+        return 2;
+    }
+
+    uint8_t * p_mem = malloc(fifo_size);
+    if (p_mem == NULL)
+    {
+        return 2;
+    }
+
+    random_test(p_mem, fifo_size);
+
+    printf("FIFO of %u bytes, %u MB moved per run, in MB/s:\n", fifo_size, mbytes);
+    printf("  chunk");
+    for (path_t path = PATH_BYTE; path < PATH_COUNT; path++)
+    {
+        printf("  %8s", m_path_names[path]);
+    }
+    printf("\n");
+    for (uint32_t i = 0; i < sizeof(m_chunk_sizes) / sizeof(m_chunk_sizes[0]); i++)
+    {
+        printf("  %5u", m_chunk_sizes[i]);
+        for (path_t path = PATH_BYTE; path < PATH_COUNT; path++)
+        {
+            printf("  %8.1f", throughput(p_mem, fifo_size, path, m_chunk_sizes[i], mbytes));
+        }
+        printf("\n");
+    }
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+
+    free(p_mem);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,595 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#include "sdk_common.h"
+#if NRF_MODULE_ENABLED(FSTORAGE)
+#include "fstorage.h"
+#include "fstorage_ram.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+
+#define FS_FLAG_INITIALIZED         (1 << 0)  // The module has been initialized.
+#define FS_FLAG_FLASH_RETAINED      (1 << 1)  // The flash content was set by fs_ram_flash_set.
+
+#define FS_PAGE_SIZE                (4096)
+#define FS_PAGE_SIZE_WORDS          (FS_PAGE_SIZE / sizeof(uint32_t))
+#define FS_RAM_WORDS                (FS_RAM_PAGES * FS_PAGE_SIZE_WORDS)
+
+// Limits of the 'fs_data' section. The host linker script must define these symbols.
+extern fs_config_t __start_fs_data[];
+extern fs_config_t __stop_fs_data[];
+
+#define FS_CONFIG_COUNT             ((uint32_t)(__stop_fs_data - __start_fs_data))
+
+
+// fstorage op-codes.
+typedef enum
+{
+    FS_OP_NONE,   // No operation.
+    FS_OP_STORE,  // Store data.
+    FS_OP_ERASE   // Erase one or more flash pages.
+} fs_op_code_t;
+
+
+// fstorage operation.
+typedef struct
+{
+    fs_config_t  const * p_config;          // Application-specific fstorage configuration.
+    void *               p_context;         // User-defined context passed to the interrupt handler.
+    fs_op_code_t         op_code;           // ID of the operation.
+    union
+    {
+        struct
+        {
+            uint32_t const * p_src;         // Pointer to the data to be written to flash.
+            uint32_t const * p_dest;        // Destination of the data in flash.
+            uint16_t         length_words;  // Length of the data to be written, in words.
+            uint16_t         offset;        // Write offset.
+        } store;
+        struct
+        {
+            uint16_t page;                  // Next page to erase, relative to the emulated flash.
+            uint16_t pages_erased;
+            uint16_t pages_to_erase;
+        } erase;
+    };
+} fs_op_t;
+
+
+// Queue of requested operations.
+typedef struct
+{
+    fs_op_t  op[FS_QUEUE_SIZE];  // Queue elements.
+    uint32_t rp;                 // Index of the operation being processed.
+    uint32_t count;              // Number of elements in the queue.
+} fs_op_queue_t;
+
+
+static uint8_t          m_flags;                        // fstorage status flags.
+static fs_op_queue_t    m_queue;                        // Queue of requested operations.
+static uint64_t         m_time_us;                      // Simulated time.
+static uint32_t         m_word_write_us = FS_RAM_WORD_WRITE_US;
+static uint32_t         m_page_erase_us = FS_RAM_PAGE_ERASE_US;
+static fs_ram_stats_t   m_stats;
+
+// The emulated flash, the number of writes to each word since its page was erased, and the
+// number of times each page was erased.
+static uint32_t         m_flash[FS_RAM_WORDS] __attribute__((aligned(FS_PAGE_SIZE)));
+static uint8_t          m_word_writes[FS_RAM_WORDS];
+static uint32_t         m_page_erases[FS_RAM_PAGES];
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+// Sends events to the application, and measures the time spent in the callback.
+static void send_event(fs_op_t const * const p_op, fs_ret_t result)
+{
+    fs_evt_t evt;
+    uint64_t start;
+    uint32_t elapsed;
+
+    memset(&evt, 0x00, sizeof(fs_evt_t));
+
+    switch (p_op->op_code)
+    {
+        case FS_OP_STORE:
+            evt.id                 = FS_EVT_STORE;
+            evt.store.p_data       = p_op->store.p_dest;
+            evt.store.length_words = p_op->store.length_words;
+            break;
+
+        case FS_OP_ERASE:
+            evt.id               = FS_EVT_ERASE;
+            evt.erase.first_page = p_op->erase.page - p_op->erase.pages_erased;
+            evt.erase.last_page  = p_op->erase.page;
+            break;
+
+        default:
+            // Should not happen.
+            break;
+    }
+    evt.p_context = p_op->p_context;
+
+    start = host_time_ns();
+    p_op->p_config->callback(&evt, result);
+    elapsed = (uint32_t)(host_time_ns() - start);
+
+    m_stats.callbacks++;
+    m_stats.callback_total_ns += elapsed;
+    if (elapsed > m_stats.callback_max_ns)
+    {
+        m_stats.callback_max_ns = elapsed;
+    }
+}
+
+
+// Checks that a configuration is non-NULL and within section variable bounds.
+static bool check_config(fs_config_t const * const config)
+{
+    return ((config != NULL) &&
+            (config >= __start_fs_data) &&
+            (config <  __stop_fs_data));
+}
+
+
+// Programs a chunk of a store operation. Bits can only be changed from 1 to 0.
+static uint16_t store_execute(fs_op_t const * const p_op)
+{
+    uint32_t const   offset    = p_op->store.offset;
+    uint16_t         chunk_len = p_op->store.length_words - offset;
+    uint32_t const * p_src     = p_op->store.p_src + offset;
+    uint32_t         word      = (p_op->store.p_dest + offset) - m_flash;
+
+    if (chunk_len > FS_MAX_WRITE_SIZE_WORDS)
+    {
+        chunk_len = FS_MAX_WRITE_SIZE_WORDS;
+    }
+
+    for (uint16_t i = 0; i < chunk_len; i++, word++)
+    {
+        if (m_word_writes[word] > 0)
+        {
+            m_stats.words_rewritten++;
+        }
+        if (m_word_writes[word] < UINT8_MAX)
+        {
+            m_word_writes[word]++;
+        }
+        m_flash[word] &= p_src[i];
+    }
+
+    m_stats.words_written += chunk_len;
+    m_stats.busy_us       += (uint64_t)chunk_len * m_word_write_us;
+    m_time_us             += (uint64_t)chunk_len * m_word_write_us;
+
+    return chunk_len;
+}
+
+
+// Erases the next page of an erase operation.
+static void erase_execute(fs_op_t const * const p_op)
+{
+    uint16_t const page = p_op->erase.page;
+
+    memset(&m_flash[page * FS_PAGE_SIZE_WORDS],       0xFF, FS_PAGE_SIZE);
+    memset(&m_word_writes[page * FS_PAGE_SIZE_WORDS], 0x00, FS_PAGE_SIZE_WORDS);
+
+    if (++m_page_erases[page] > m_stats.max_page_erases)
+    {
+        m_stats.max_page_erases = m_page_erases[page];
+    }
+
+    m_stats.pages_erased++;
+    m_stats.busy_us += m_page_erase_us;
+    m_time_us       += m_page_erase_us;
+}
+
+
+// Advances the queue, wrapping around if necessary.
+static void queue_advance(void)
+{
+    m_queue.count--;
+
+    if (++m_queue.rp == FS_QUEUE_SIZE)
+    {
+        m_queue.rp = 0;
+    }
+}
+
+
+// Retrieves a pointer to the next free element in the queue.
+// Additionally, increases the number of elements stored in the queue.
+static bool queue_get_next_free(fs_op_t ** p_op)
+{
+    uint32_t idx;
+
+    if (m_queue.count == FS_QUEUE_SIZE)
+    {
+        return false;
+    }
+
+    idx = ((m_queue.rp + m_queue.count) < FS_QUEUE_SIZE) ?
+           (m_queue.rp + m_queue.count) : ((m_queue.rp + m_queue.count)-FS_QUEUE_SIZE);
+
+    m_queue.count++;
+
+    // Zero the element so that unassigned fields will be zero.
+    memset(&m_queue.op[idx], 0x00, sizeof(fs_op_t));
+
+    *p_op = &m_queue.op[idx];
+
+    return true;
+}
+
+
+fs_ret_t fs_init(void)
+{
+    uint32_t const   total_users   = FS_CONFIG_COUNT;
+    uint32_t const * p_current_end = &m_flash[FS_RAM_WORDS];
+
+    if (m_flags & FS_FLAG_INITIALIZED)
+    {
+        return FS_SUCCESS;
+    }
+
+    if (!(m_flags & FS_FLAG_FLASH_RETAINED))
+    {
+        memset(m_flash, 0xFF, sizeof(m_flash));
+    }
+
+    // Assign flash space to the configurations which have not set it, like fstorage.c does:
+    // higher priority means a higher memory address.
+    for (;;)
+    {
+        fs_config_t * p_config = NULL;
+
+        for (uint32_t i = 0; i < total_users; i++)
+        {
+            fs_config_t * const p_config_i = &__start_fs_data[i];
+
+            if ((p_config_i->p_start_addr != NULL) &&
+                (p_config_i->p_end_addr   != NULL))
+            {
+                continue;
+            }
+
+            if ((p_config == NULL) || (p_config_i->priority > p_config->priority))
+            {
+                p_config = p_config_i;
+            }
+        }
+
+        if (p_config == NULL)
+        {
+            break;
+        }
+
+        if ((uint32_t)(p_current_end - m_flash) < (p_config->num_pages * FS_PAGE_SIZE_WORDS))
+        {
+            return FS_ERR_INVALID_CFG;
+        }
+
+        p_config->p_end_addr   = p_current_end;
+        p_config->p_start_addr = p_current_end - (p_config->num_pages * FS_PAGE_SIZE_WORDS);
+
+        p_current_end = p_config->p_start_addr;
+    }
+
+    m_flags |= FS_FLAG_INITIALIZED;
+
+    return FS_SUCCESS;
+}
+
+
+fs_ret_t fs_fake_init(void)
+{
+    m_flags |= FS_FLAG_INITIALIZED;
+    return FS_SUCCESS;
+}
+
+
+fs_ret_t fs_store(fs_config_t const * const p_config,
+                  uint32_t    const * const p_dest,
+                  uint32_t    const * const p_src,
+                  uint16_t    const         length_words,
+                  void *                    p_context)
+{
+    fs_op_t * p_op;
+
+    if (!(m_flags & FS_FLAG_INITIALIZED))
+    {
+        return FS_ERR_NOT_INITIALIZED;
+    }
+
+    if (!check_config(p_config))
+    {
+        return FS_ERR_INVALID_CFG;
+    }
+
+    if ((p_src == NULL) || (p_dest == NULL))
+    {
+        return FS_ERR_NULL_ARG;
+    }
+
+    // Check that both pointers are word aligned.
+    if (((uintptr_t)p_src  & 0x03) ||
+        ((uintptr_t)p_dest & 0x03))
+    {
+        return FS_ERR_UNALIGNED_ADDR;
+    }
+
+    // Check that the operation doesn't go outside the client's memory boundaries.
+    if ((p_config->p_start_addr > p_dest) ||
+        (p_config->p_end_addr   < (p_dest + length_words)))
+    {
+        return FS_ERR_INVALID_ADDR;
+    }
+
+    if (length_words == 0)
+    {
+        return FS_ERR_INVALID_ARG;
+    }
+
+    if (!queue_get_next_free(&p_op))
+    {
+        return FS_ERR_QUEUE_FULL;
+    }
+
+    // Initialize the operation.
+    p_op->p_context          = p_context;
+    p_op->p_config           = p_config;
+    p_op->op_code            = FS_OP_STORE;
+    p_op->store.p_src        = p_src;
+    p_op->store.p_dest       = p_dest;
+    p_op->store.length_words = length_words;
+
+    return FS_SUCCESS;
+}
+
+
+fs_ret_t fs_erase(fs_config_t const * const p_config,
+                  uint32_t    const * const p_page_addr,
+                  uint16_t    const         num_pages,
+                  void *                    p_context)
+{
+    fs_op_t * p_op;
+
+    if (!(m_flags & FS_FLAG_INITIALIZED))
+    {
+        return FS_ERR_NOT_INITIALIZED;
+    }
+
+    if (!check_config(p_config))
+    {
+        return FS_ERR_INVALID_CFG;
+    }
+
+    if (p_page_addr == NULL)
+    {
+        return FS_ERR_NULL_ARG;
+    }
+
+    // Check that the page is aligned to a page boundary.
+    if (((uintptr_t)p_page_addr & (FS_PAGE_SIZE-1)) != 0)
+    {
+        return FS_ERR_UNALIGNED_ADDR;
+    }
+
+    // Check that the operation doesn't go outside the client's memory boundaries.
+    if ((p_page_addr < p_config->p_start_addr) ||
+        (p_page_addr + (FS_PAGE_SIZE_WORDS * num_pages) > p_config->p_end_addr))
+    {
+        return FS_ERR_INVALID_ADDR;
+    }
+
+    if (num_pages == 0)
+    {
+        return FS_ERR_INVALID_ARG;
+    }
+
+    if (!queue_get_next_free(&p_op))
+    {
+        return FS_ERR_QUEUE_FULL;
+    }
+
+    // Initialize the operation.
+    p_op->p_context            = p_context;
+    p_op->p_config             = p_config;
+    p_op->op_code              = FS_OP_ERASE;
+    p_op->erase.page           = (p_page_addr - m_flash) / FS_PAGE_SIZE_WORDS;
+    p_op->erase.pages_to_erase = num_pages;
+
+    return FS_SUCCESS;
+}
+
+
+fs_ret_t fs_queued_op_count_get(uint32_t * const p_op_count)
+{
+    if (p_op_count == NULL)
+    {
+        return FS_ERR_NULL_ARG;
+    }
+
+    *p_op_count = m_queue.count;
+
+    return FS_SUCCESS;
+}
+
+
+void fs_sys_event_handler(uint32_t sys_evt)
+{
+    // Flash operations are executed by fs_ram_process(); there are no system events.
+    UNUSED_PARAMETER(sys_evt);
+}
+
+
+bool fs_queue_is_full(void)
+{
+    return (m_queue.count == FS_QUEUE_SIZE);
+}
+
+
+bool fs_queue_is_empty(void)
+{
+    return (m_queue.count == 0);
+}
+
+
+void fs_ram_latency_set(uint32_t word_write_us, uint32_t page_erase_us)
+{
+    m_word_write_us = word_write_us;
+    m_page_erase_us = page_erase_us;
+}
+
+
+bool fs_ram_process(void)
+{
+    fs_op_t * const p_op = &m_queue.op[m_queue.rp];
+
+    if (m_queue.count == 0)
+    {
+        return false;
+    }
+
+    switch (p_op->op_code)
+    {
+        case FS_OP_STORE:
+            p_op->store.offset += store_execute(p_op);
+
+            if (p_op->store.offset == p_op->store.length_words)
+            {
+                // The operation has finished. Advance the queue first, so that the
+                // callback can queue new operations.
+                fs_op_t const op = *p_op;
+
+                queue_advance();
+                m_stats.store_ops++;
+                send_event(&op, FS_SUCCESS);
+            }
+            break;
+
+        case FS_OP_ERASE:
+            erase_execute(p_op);
+            p_op->erase.page++;
+            p_op->erase.pages_erased++;
+
+            if (p_op->erase.pages_erased == p_op->erase.pages_to_erase)
+            {
+                fs_op_t const op = *p_op;
+
+                queue_advance();
+                m_stats.erase_ops++;
+                send_event(&op, FS_SUCCESS);
+            }
+            break;
+
+        default:
+            // Should not happen.
+            queue_advance();
+            break;
+    }
+
+    return true;
+}
+
+
+uint32_t fs_ram_chunk_time_get(void)
+{
+    fs_op_t const * const p_op = &m_queue.op[m_queue.rp];
+    uint32_t              chunk_len;
+
+    if (m_queue.count == 0)
+    {
+        return 0;
+    }
+
+    if (p_op->op_code == FS_OP_ERASE)
+    {
+        return m_page_erase_us;
+    }
+
+    chunk_len = p_op->store.length_words - p_op->store.offset;
+    if (chunk_len > FS_MAX_WRITE_SIZE_WORDS)
+    {
+        chunk_len = FS_MAX_WRITE_SIZE_WORDS;
+    }
+
+    return chunk_len * m_word_write_us;
+}
+
+
+void fs_ram_run(void)
+{
+    while (fs_ram_process())
+    {
+        // Keep going until all operations, including those queued by callbacks, are done.
+    }
+}
+
+
+void const * fs_ram_flash_get(uint32_t * const p_size)
+{
+    *p_size = sizeof(m_flash);
+    return m_flash;
+}
+
+
+bool fs_ram_flash_set(void const * p_data, uint32_t size)
+{
+    if ((m_flags & FS_FLAG_INITIALIZED) || (size != sizeof(m_flash)))
+    {
+        return false;
+    }
+
+    memcpy(m_flash, p_data, size);
+    m_flags |= FS_FLAG_FLASH_RETAINED;
+
+    return true;
+}
+
+
+uint64_t fs_ram_time_get(void)
+{
+    return m_time_us;
+}
+
+
+void fs_ram_time_advance(uint32_t us)
+{
+    m_time_us += us;
+}
+
+
+void fs_ram_stats_get(fs_ram_stats_t * const p_stats)
+{
+    *p_stats = m_stats;
+}
+
+
+void fs_ram_stats_reset(void)
+{
+    uint32_t const max_page_erases = m_stats.max_page_erases;
+
+    memset(&m_stats, 0x00, sizeof(m_stats));
+    m_stats.max_page_erases = max_page_erases;
+}
+
+#endif //NRF_MODULE_ENABLED(FSTORAGE)
@@ -0,0 +1,169 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#ifndef FSTORAGE_RAM_H__
+#define FSTORAGE_RAM_H__
+
+/**
+ * @defgroup fstorage_ram fstorage RAM backend
+ * @ingroup fstorage
+ * @{
+ *
+ * @brief   RAM-backed implementation of the fstorage API, for building flash users such as
+ *          FDS on a PC host.
+ *
+ * @details fstorage_ram.c replaces fstorage.c in host builds. It emulates nRF52 flash: pages
+ *          of 4096 bytes which read as 0xFF when erased, and word writes which can only change
+ *          bits from 1 to 0, leaving a word at the AND of its old and new values. Operations are
+ *          queued and split into chunks like in fstorage.c, but they are executed only when the
+ *          host calls @ref fs_ram_process. Each chunk advances a simulated clock by a
+ *          configurable flash latency.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "fstorage.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+
+/**@brief   Number of emulated flash pages. The pages requested by all configurations must fit. */
+#ifndef FS_RAM_PAGES
+#define FS_RAM_PAGES            (32)
+#endif
+
+/**@brief   Default time to write one word, in microseconds (nRF52832 maximum). */
+#ifndef FS_RAM_WORD_WRITE_US
+#define FS_RAM_WORD_WRITE_US    (68)
+#endif
+
+/**@brief   Default time to erase one page, in microseconds (nRF52832 maximum). */
+#ifndef FS_RAM_PAGE_ERASE_US
+#define FS_RAM_PAGE_ERASE_US    (85000)
+#endif
+
+
+/**@brief   Flash statistics, accumulated since the last call to @ref fs_ram_stats_reset. */
+typedef struct
+{
+    uint32_t store_ops;             //!< Number of completed store operations.
+    uint32_t erase_ops;             //!< Number of completed erase operations.
+    uint32_t words_written;         //!< Number of words programmed.
+    uint32_t pages_erased;          //!< Number of pages erased.
+    uint32_t words_rewritten;       //!< Number of writes to words which were already written since the last erase.
+    uint32_t max_page_erases;       //!< Highest erase count of a single page, since fs_init.
+    uint64_t busy_us;               //!< Simulated time the flash was busy, in microseconds.
+    uint32_t callback_max_ns;       //!< Longest host time spent in a completion callback, in nanoseconds.
+    uint64_t callback_total_ns;     //!< Total host time spent in completion callbacks, in nanoseconds.
+    uint32_t callbacks;             //!< Number of completion callbacks.
+} fs_ram_stats_t;
+
+
+/**@brief   Function for setting the flash latency.
+ *
+ * @param[in]   word_write_us   Time to write one word, in microseconds.
+ * @param[in]   page_erase_us   Time to erase one page, in microseconds.
+ */
+void fs_ram_latency_set(uint32_t word_write_us, uint32_t page_erase_us);
+
+
+/**@brief   Function for executing the next queued flash operation chunk.
+ *
+ * @details One chunk is up to @ref FS_MAX_WRITE_SIZE_WORDS words or one page. When the last
+ *          chunk of an operation completes, the callback of its configuration is called.
+ *
+ * @retval  true    If a chunk was executed.
+ * @retval  false   If the queue is empty.
+ */
+bool fs_ram_process(void);
+
+
+/**@brief   Function for reading how long the next chunk will take, without executing it.
+ *
+ * @details Lets a host simulation run the flash in parallel with the CPU: start the chunk at
+ *          the current time, and call @ref fs_ram_process when its duration has passed, so that
+ *          the completion callback runs at the right time.
+ *
+ * @return  Duration of the next chunk, in microseconds, or zero if the queue is empty.
+ */
+uint32_t fs_ram_chunk_time_get(void);
+
+
+/**@brief   Function for executing queued flash operations until the queue is empty.
+ *
+ * @details Operations queued from completion callbacks are executed too.
+ */
+void fs_ram_run(void);
+
+
+/**@brief   Function for reading the content of the emulated flash.
+ *
+ * @details Together with @ref fs_ram_flash_set, this keeps the flash across a simulated reset,
+ *          which is a new process since flash users like FDS cannot be initialized twice.
+ *
+ * @param[out]  p_size  Size of the emulated flash, in bytes.
+ *
+ * @return  The emulated flash.
+ */
+void const * fs_ram_flash_get(uint32_t * const p_size);
+
+
+/**@brief   Function for setting the content of the emulated flash before @ref fs_init.
+ *
+ * @details The flash addresses of the configurations are assigned the same way in every
+ *          process, so flash read with @ref fs_ram_flash_get can be set again after a reset.
+ *
+ * @param[in]   p_data  Flash content.
+ * @param[in]   size    Size of @p p_data, in bytes. Must be the size of the emulated flash.
+ *
+ * @retval  true    If the flash was set.
+ * @retval  false   If fstorage is already initialized or @p size is wrong.
+ */
+bool fs_ram_flash_set(void const * p_data, uint32_t size);
+
+
+/**@brief   Function for reading the simulated time.
+ *
+ * @return  Microseconds since @ref fs_init, advanced only by flash operations and
+ *          @ref fs_ram_time_advance.
+ */
+uint64_t fs_ram_time_get(void);
+
+
+/**@brief   Function for advancing the simulated time, for example to model CPU work between
+ *          flash operations.
+ *
+ * @param[in]   us  Microseconds to advance.
+ */
+void fs_ram_time_advance(uint32_t us);
+
+
+/**@brief   Function for reading the flash statistics.
+ *
+ * @param[out]  p_stats     Statistics.
+ */
+void fs_ram_stats_get(fs_ram_stats_t * const p_stats);
+
+
+/**@brief   Function for clearing the flash statistics. Page erase counts are kept. */
+void fs_ram_stats_reset(void);
+
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FSTORAGE_RAM_H__
@@ -24,6 +24,19 @@
 #define NRF_LOG_TIMESTAMP_DIGITS
 
 
+/** @brief Send binary frames instead of formatted text
+ *
+ * Log entries are sent as the address of the format string and the raw
+ * arguments (see @ref nrf_log_binary) and formatted on the host with
+ * tools/nrf_log_decode.py, using the ELF file of the application.
+ *
+ *  Set to 1 to activate.
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define NRF_LOG_BACKEND_SERIAL_BINARY
+
+
 /** @brief If enabled data is printed over UART
  *
  *  Set to 1 to activate.
@@ -0,0 +1,152 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/**@file
+ * @addtogroup nrf_log Logger module
+ * @ingroup    app_common
+ *
+ * @defgroup nrf_log_binary Binary log frames
+ * @{
+ * @ingroup  nrf_log
+ * @brief    Encoder for log entries that are formatted on the host instead of on the device.
+ *
+ * @details A frame carries the address of the format string and the raw arguments instead of
+ *          the formatted text. The host looks the format string up in the ELF file of the
+ *          application and does the formatting (see tools/nrf_log_decode.py). Encoding a frame
+ *          costs a few dozen instructions, compared to a full snprintf for the text backend,
+ *          and the frames are usually less than half the size of the text.
+ *
+ *          Frame layout (multi-byte fields are little endian):
+ *          | Field     | Size   | Description                                                |
+ *          |-----------|--------|------------------------------------------------------------|
+ *          | Sync      | 1      | @ref NRF_LOG_BINARY_SYNC.                                  |
+ *          | Length    | 1      | Length of the body.                                        |
+ *          | Flags     | 1      | Severity, raw bit, timestamp bit and frame type.           |
+ *          | Timestamp | 0 or 4 | Present if @ref NRF_LOG_BINARY_FLAG_TIMESTAMP is set.      |
+ *          | Payload   | n      | Standard or hexdump payload, see below.                    |
+ *          | Checksum  | 1      | Makes the sum of all bytes from Length on equal 0 mod 256. |
+ *
+ *          The body is Flags, Timestamp and Payload.
+ *
+ *          Standard payload: the format string address (4 bytes), the number of arguments
+ *          (1 byte), a mask of the arguments that are strings (1 byte), and the arguments.
+ *          Integer arguments are sent as unsigned LEB128, so small values take one byte and
+ *          negative values five. String arguments (%s) are sent inline as a length byte followed
+ *          by at most @ref NRF_LOG_BINARY_STRING_MAX_LEN characters, because they may point to
+ *          RAM.
+ *
+ *          Hexdump payload: the description string address (4 bytes), the offset of the chunk
+ *          (2 bytes), the total length of the dump (2 bytes), and at most
+ *          @ref NRF_LOG_BINARY_HEXDUMP_CHUNK_LEN bytes of data.
+ */
+
+#ifndef NRF_LOG_BINARY_H__
+#define NRF_LOG_BINARY_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@brief Maximum number of characters of a string argument that are sent. */
+#ifndef NRF_LOG_BINARY_STRING_MAX_LEN
+#define NRF_LOG_BINARY_STRING_MAX_LEN   32
+#endif
+
+/**@brief Maximum number of hexdump bytes sent in one frame. */
+#ifndef NRF_LOG_BINARY_HEXDUMP_CHUNK_LEN
+#define NRF_LOG_BINARY_HEXDUMP_CHUNK_LEN 64
+#endif
+
+#define NRF_LOG_BINARY_SYNC             0xA5 //!< First byte of every frame.
+
+#define NRF_LOG_BINARY_FLAG_LEVEL_MASK  0x07 //!< Severity level of the entry.
+#define NRF_LOG_BINARY_FLAG_RAW         0x08 //!< Entry is logged without a prefix.
+#define NRF_LOG_BINARY_FLAG_TIMESTAMP   0x10 //!< Frame contains a timestamp.
+#define NRF_LOG_BINARY_FLAG_TYPE_POS    5
+#define NRF_LOG_BINARY_FLAG_TYPE_MASK   (0x03 << NRF_LOG_BINARY_FLAG_TYPE_POS)
+
+#define NRF_LOG_BINARY_TYPE_STD         0    //!< Standard entry.
+#define NRF_LOG_BINARY_TYPE_HEXDUMP     1    //!< Chunk of a hexdump.
+
+#define NRF_LOG_BINARY_MAX_ARGS         6    //!< Maximum number of arguments of an entry.
+
+/**@brief Maximum body length of a standard frame. */
+#define NRF_LOG_BINARY_STD_BODY_MAX_LEN                                                      \
+    (1 + 4 + 4 + 1 + 1 + NRF_LOG_BINARY_MAX_ARGS * (1 + NRF_LOG_BINARY_STRING_MAX_LEN))
+
+/**@brief Maximum body length of a hexdump frame. */
+#define NRF_LOG_BINARY_HEXDUMP_BODY_MAX_LEN (1 + 4 + 4 + 2 + 2 + NRF_LOG_BINARY_HEXDUMP_CHUNK_LEN)
+
+/**@brief Size of a buffer that can hold any frame. */
+#define NRF_LOG_BINARY_FRAME_MAX_LEN                                                         \
+    (3 + ((NRF_LOG_BINARY_STD_BODY_MAX_LEN > NRF_LOG_BINARY_HEXDUMP_BODY_MAX_LEN) ?          \
+          NRF_LOG_BINARY_STD_BODY_MAX_LEN : NRF_LOG_BINARY_HEXDUMP_BODY_MAX_LEN))
+
+/**@brief Function for encoding a standard log entry.
+ *
+ * The arguments of the std handler (@ref nrf_log_std_handler_t) are taken as they are, so the
+ * function can be called from any backend.
+ *
+ * @param[out] p_frame        Buffer of at least @ref NRF_LOG_BINARY_FRAME_MAX_LEN bytes.
+ * @param[in]  severity_level Severity level, optionally with the raw bit.
+ * @param[in]  p_timestamp    Pointer to the timestamp, or NULL.
+ * @param[in]  p_str          Format string. Must be located in the application image.
+ * @param[in]  p_args         Arguments.
+ * @param[in]  nargs          Number of arguments, at most @ref NRF_LOG_BINARY_MAX_ARGS.
+ *
+ * @return Length of the frame.
+ */
+uint32_t nrf_log_binary_std_encode(uint8_t              * p_frame,
+                                   uint8_t                severity_level,
+                                   const uint32_t * const p_timestamp,
+                                   const char * const     p_str,
+                                   const uint32_t       * p_args,
+                                   uint32_t               nargs);
+
+/**@brief Function for encoding the next chunk of a hexdump.
+ *
+ * The data is given in two parts, like for the hexdump handler
+ * (@ref nrf_log_hexdump_handler_t). Call the function until the offset reaches the total
+ * length. A dump of zero length is sent as one empty frame.
+ *
+ * @param[out]   p_frame        Buffer of at least @ref NRF_LOG_BINARY_FRAME_MAX_LEN bytes.
+ * @param[in]    severity_level Severity level, optionally with the raw bit.
+ * @param[in]    p_timestamp    Pointer to the timestamp, or NULL.
+ * @param[in]    p_str          Description string. Must be located in the application image.
+ * @param[inout] p_offset       Offset of the first byte to encode. Advanced past the encoded
+ *                              bytes.
+ * @param[in]    p_buf0         First part of the data.
+ * @param[in]    buf0_length    Length of the first part.
+ * @param[in]    p_buf1         Second part of the data.
+ * @param[in]    buf1_length    Length of the second part.
+ *
+ * @return Length of the frame.
+ */
+uint32_t nrf_log_binary_hexdump_encode(uint8_t              * p_frame,
+                                       uint8_t                severity_level,
+                                       const uint32_t * const p_timestamp,
+                                       const char * const     p_str,
+                                       uint32_t             * p_offset,
+                                       const uint8_t * const  p_buf0,
+                                       uint32_t               buf0_length,
+                                       const uint8_t * const  p_buf1,
+                                       uint32_t               buf1_length);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_LOG_BINARY_H__
+
+/** @} */
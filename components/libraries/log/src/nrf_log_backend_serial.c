@@ -12,6 +12,7 @@
 #include "sdk_common.h"
 #if NRF_MODULE_ENABLED(NRF_LOG)
 #include "nrf_log_backend.h"
+#include "nrf_log_binary.h"
 #include "nrf_error.h"
 #include <stdarg.h>
 #include <string.h>
@@ -37,6 +38,14 @@ static nrf_drv_uart_t m_uart = NRF_DRV_UART_INSTANCE(NRF_LOG_BACKEND_UART_INSTAN
 
 #endif //NRF_LOG_BACKEND_SERIAL_USES_UART
 
+#ifndef NRF_LOG_BACKEND_SERIAL_BINARY
+#define NRF_LOG_BACKEND_SERIAL_BINARY 0
+#endif
+
+#if NRF_LOG_BACKEND_SERIAL_BINARY
+STATIC_ASSERT(NRF_LOG_BINARY_FRAME_MAX_LEN <= NRF_LOG_BACKEND_MAX_STRING_LENGTH);
+#endif
+
 #define HEXDUMP_BYTES_PER_LINE               16
 #define HEXDUMP_HEXBYTE_AREA                 3 // Two bytes for hexbyte and space to separate
 #define TIMESTAMP_STR(val) "[%0" NUM_TO_STR(val) "d]"
@@ -51,7 +60,9 @@ static nrf_drv_uart_t m_uart = NRF_DRV_UART_INSTANCE(NRF_LOG_BACKEND_UART_INSTAN
 
 static bool m_initialized   = false;
 static bool m_blocking_mode = false;
+#if !NRF_LOG_BACKEND_SERIAL_BINARY
 static const char m_default_color[] = "\x1B[0m";
+#endif
 
 #if (NRF_LOG_BACKEND_SERIAL_USES_UART)
 static volatile bool m_rx_done = false;
@@ -181,6 +192,64 @@ static uint8_t serial_get_byte(void)
 }
 
 
+#if NRF_LOG_BACKEND_SERIAL_BINARY
+static bool nrf_log_backend_serial_binary_std_handler(
+    uint8_t                severity_level,
+    const uint32_t * const p_timestamp,
+    const char * const     p_str,
+    uint32_t             * p_args,
+    uint32_t               nargs)
+{
+    uint8_t  frame[NRF_LOG_BINARY_FRAME_MAX_LEN];
+    uint32_t frame_len;
+
+    if (serial_is_busy())
+    {
+        return false;
+    }
+
+    frame_len = nrf_log_binary_std_encode(frame, severity_level, p_timestamp, p_str, p_args, nargs);
+    return serial_tx(frame, frame_len);
+}
+
+
+static uint32_t nrf_log_backend_serial_binary_hexdump_handler(
+    uint8_t                severity_level,
+    const uint32_t * const p_timestamp,
+    const char * const     p_str,
+    uint32_t               offset,
+    const uint8_t * const  p_buf0,
+    uint32_t               buf0_length,
+    const uint8_t * const  p_buf1,
+    uint32_t               buf1_length)
+{
+    uint8_t  frame[NRF_LOG_BINARY_FRAME_MAX_LEN];
+    uint32_t frame_len;
+    uint32_t next_offset = offset;
+
+    do
+    {
+        if (serial_is_busy())
+        {
+            break;
+        }
+
+        frame_len = nrf_log_binary_hexdump_encode(frame, severity_level, p_timestamp, p_str,
+                                                  &next_offset,
+                                                  p_buf0, buf0_length,
+                                                  p_buf1, buf1_length);
+        if (!serial_tx(frame, frame_len))
+        {
+            break;
+        }
+        offset = next_offset;
+    }
+    while (offset < buf0_length + buf1_length);
+
+    return offset;
+}
+#else //NRF_LOG_BACKEND_SERIAL_BINARY
+
 static bool buf_len_update(uint32_t * p_buf_len, int32_t new_len)
 {
     bool ret;
@@ -447,16 +516,26 @@ static uint32_t nrf_log_backend_serial_hexdump_handler(
     return byte_cnt;
 }
 
+#endif //NRF_LOG_BACKEND_SERIAL_BINARY
+
 
 nrf_log_std_handler_t nrf_log_backend_std_handler_get(void)
 {
+#if NRF_LOG_BACKEND_SERIAL_BINARY
+    return nrf_log_backend_serial_binary_std_handler;
+#else
     return nrf_log_backend_serial_std_handler;
+#endif
 }
 
 
 nrf_log_hexdump_handler_t nrf_log_backend_hexdump_handler_get(void)
 {
+#if NRF_LOG_BACKEND_SERIAL_BINARY
+    return nrf_log_backend_serial_binary_hexdump_handler;
+#else
     return nrf_log_backend_serial_hexdump_handler;
+#endif
 }
 
 
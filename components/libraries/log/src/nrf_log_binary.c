@@ -0,0 +1,252 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+#include "sdk_common.h"
+#if NRF_MODULE_ENABLED(NRF_LOG)
+#include "nrf_log_binary.h"
+#include "nrf_log_internal.h"
+#include "nrf_assert.h"
+#include <string.h>
+
+STATIC_ASSERT(NRF_LOG_BINARY_STD_BODY_MAX_LEN <= UINT8_MAX);
+STATIC_ASSERT(NRF_LOG_BINARY_HEXDUMP_BODY_MAX_LEN <= UINT8_MAX);
+
+/**@brief Check if a character ends a conversion specification, that is if it is not a flag, a
+ *        width, a precision or a length modifier. */
+__STATIC_INLINE bool is_conversion_end(char c)
+{
+    switch (c)
+    {
+        case '-': case '+': case ' ': case '#': case '.': case '*':
+        case 'h': case 'l': case 'L': case 'j': case 'z': case 't':
+            return false;
+
+        default:
+            return (c < '0') || (c > '9');
+    }
+}
+
+
+/**@brief Find the arguments that are consumed by %s conversions.
+ *
+ * Flags, width, precision and length modifiers are skipped. A '*' width or precision consumes an
+ * argument of its own.
+ *
+ * @param[in] p_fmt Format string.
+ * @param[in] nargs Number of arguments.
+ *
+ * @return Mask with bit n set if argument n is a string.
+ */
+static uint32_t string_args_get(char const * p_fmt, uint32_t nargs)
+{
+    uint32_t mask = 0;
+    uint32_t arg  = 0;
+
+    while ((arg < nargs) && ((p_fmt = strchr(p_fmt, '%')) != NULL))
+    {
+        p_fmt++;
+        if (*p_fmt == '%')
+        {
+            p_fmt++;
+            continue;
+        }
+
+        while (!is_conversion_end(*p_fmt))
+        {
+            if (*p_fmt == '*')
+            {
+                arg++;
+            }
+            p_fmt++;
+        }
+
+        if (*p_fmt == '\0')
+        {
+            break;
+        }
+        if ((*p_fmt == 's') && (arg < nargs))
+        {
+            mask |= (1UL << arg);
+        }
+        arg++;
+        p_fmt++;
+    }
+    return mask;
+}
+
+
+__STATIC_INLINE uint8_t * u32_put(uint8_t * p_dst, uint32_t value)
+{
+    p_dst[0] = (uint8_t)value;
+    p_dst[1] = (uint8_t)(value >> 8);
+    p_dst[2] = (uint8_t)(value >> 16);
+    p_dst[3] = (uint8_t)(value >> 24);
+    return p_dst + 4;
+}
+
+
+__STATIC_INLINE uint8_t * u16_put(uint8_t * p_dst, uint32_t value)
+{
+    p_dst[0] = (uint8_t)value;
+    p_dst[1] = (uint8_t)(value >> 8);
+    return p_dst + 2;
+}
+
+
+/**@brief Write a value as unsigned LEB128: 7 bits per byte, lowest first, bit 7 set on all but
+ *        the last byte. */
+__STATIC_INLINE uint8_t * uleb128_put(uint8_t * p_dst, uint32_t value)
+{
+    while (value >= 0x80)
+    {
+        *p_dst++ = (uint8_t)(value | 0x80);
+        value  >>= 7;
+    }
+    *p_dst++ = (uint8_t)value;
+    return p_dst;
+}
+
+
+/**@brief Write the sync byte, flags and timestamp.
+ *
+ * @return Pointer to the payload.
+ */
+static uint8_t * frame_start(uint8_t              * p_frame,
+                             uint8_t                severity_level,
+                             const uint32_t * const p_timestamp,
+                             uint8_t                type)
+{
+    uint8_t flags = (severity_level & NRF_LOG_BINARY_FLAG_LEVEL_MASK) |
+                    (uint8_t)(type << NRF_LOG_BINARY_FLAG_TYPE_POS);
+
+    if (severity_level & NRF_LOG_RAW)
+    {
+        flags |= NRF_LOG_BINARY_FLAG_RAW;
+    }
+    if (p_timestamp != NULL)
+    {
+        flags |= NRF_LOG_BINARY_FLAG_TIMESTAMP;
+    }
+
+    p_frame[0] = NRF_LOG_BINARY_SYNC;
+    p_frame[2] = flags;
+
+    return (p_timestamp != NULL) ? u32_put(&p_frame[3], *p_timestamp) : &p_frame[3];
+}
+
+
+/**@brief Write the length and checksum.
+ *
+ * @return Length of the frame.
+ */
+static uint32_t frame_end(uint8_t * p_frame, uint8_t * p_end)
+{
+    uint32_t len = p_end - p_frame;
+    uint8_t  sum;
+    uint32_t i;
+
+    p_frame[1] = (uint8_t)(len - 2);
+
+    sum = 0;
+    for (i = 1; i < len; i++)
+    {
+        sum += p_frame[i];
+    }
+    *p_end = (uint8_t)(0x100 - sum);
+
+    return len + 1;
+}
+
+
+uint32_t nrf_log_binary_std_encode(uint8_t              * p_frame,
+                                   uint8_t                severity_level,
+                                   const uint32_t * const p_timestamp,
+                                   const char * const     p_str,
+                                   const uint32_t       * p_args,
+                                   uint32_t               nargs)
+{
+    uint8_t * p_dst   = frame_start(p_frame, severity_level, p_timestamp, NRF_LOG_BINARY_TYPE_STD);
+    uint32_t  strings = (nargs > 0) ? string_args_get(p_str, nargs) : 0;
+    uint32_t  i;
+
+    ASSERT(nargs <= NRF_LOG_BINARY_MAX_ARGS);
+
+    p_dst    = u32_put(p_dst, (uint32_t)(uintptr_t)p_str);
+    *p_dst++ = (uint8_t)nargs;
+    *p_dst++ = (uint8_t)strings;
+
+    for (i = 0; i < nargs; i++)
+    {
+        if (strings & (1UL << i))
+        {
+            char const * p_arg = (char const *)(uintptr_t)p_args[i];
+            uint8_t      len   = 0;
+
+            while ((len < NRF_LOG_BINARY_STRING_MAX_LEN) && (p_arg[len] != '\0'))
+            {
+                p_dst[1 + len] = (uint8_t)p_arg[len];
+                len++;
+            }
+            p_dst[0] = len;
+            p_dst   += 1 + len;
+        }
+        else
+        {
+            p_dst = uleb128_put(p_dst, p_args[i]);
+        }
+    }
+
+    return frame_end(p_frame, p_dst);
+}
+
+
+uint32_t nrf_log_binary_hexdump_encode(uint8_t              * p_frame,
+                                       uint8_t                severity_level,
+                                       const uint32_t * const p_timestamp,
+                                       const char * const     p_str,
+                                       uint32_t             * p_offset,
+                                       const uint8_t * const  p_buf0,
+                                       uint32_t               buf0_length,
+                                       const uint8_t * const  p_buf1,
+                                       uint32_t               buf1_length)
+{
+    uint8_t * p_dst  = frame_start(p_frame, severity_level, p_timestamp,
+                                   NRF_LOG_BINARY_TYPE_HEXDUMP);
+    uint32_t  offset = *p_offset;
+    uint32_t  length = buf0_length + buf1_length;
+    uint32_t  chunk  = MIN(length - offset, NRF_LOG_BINARY_HEXDUMP_CHUNK_LEN);
+
+    p_dst = u32_put(p_dst, (uint32_t)(uintptr_t)p_str);
+    p_dst = u16_put(p_dst, offset);
+    p_dst = u16_put(p_dst, length);
+
+    if (offset < buf0_length)
+    {
+        uint32_t len0 = MIN(chunk, buf0_length - offset);
+
+        memcpy(p_dst, &p_buf0[offset], len0);
+        if (chunk > len0)
+        {
+            memcpy(&p_dst[len0], p_buf1, chunk - len0);
+        }
+    }
+    else if (chunk > 0)
+    {
+        memcpy(p_dst, &p_buf1[offset - buf0_length], chunk);
+    }
+    p_dst += chunk;
+
+    *p_offset = offset + chunk;
+
+    return frame_end(p_frame, p_dst);
+}
+
+#endif // NRF_MODULE_ENABLED(NRF_LOG)
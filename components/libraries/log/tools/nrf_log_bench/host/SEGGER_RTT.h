@@ -0,0 +1,23 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host replacement of the SEGGER RTT API for the log benchmark. The benchmark implements the
+ * functions and collects what the serial backend writes. */
+
+#ifndef SEGGER_RTT_H
+#define SEGGER_RTT_H
+
+void     SEGGER_RTT_Init(void);
+unsigned SEGGER_RTT_WriteNoLock(unsigned BufferIndex, const void * pBuffer, unsigned NumBytes);
+int      SEGGER_RTT_WaitKey(void);
+
+#endif // SEGGER_RTT_H
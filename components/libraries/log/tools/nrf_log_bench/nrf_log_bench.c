@@ -0,0 +1,378 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Log backend benchmark for a PC host.
+ *
+ * The serial backend is built with RTT output, and RTT is replaced by a buffer. Each entry of a
+ * table is passed to the backend std handler, as NRF_LOG_PROCESS() does, and the output is
+ * checked:
+ * - the text build compares it with the expected line,
+ * - the binary build collects the frames, together with a 100-byte hexdump in two parts, an
+ *   empty hexdump, some garbage and a corrupted frame, and writes them and the expected lines
+ *   to files. The Makefile decodes the frames with nrf_log_decode.py and compares.
+ * Entries with %s arguments are only used in the binary build, since the text build would pass
+ * the 32-bit arguments to the host snprintf as pointers.
+ *
+ * Then it measures the backend time of the touch trace of ble_app_hids_mouse (six integer
+ * arguments) and of a 100-byte hexdump. The RTT replacement copies the output into a ring
+ * buffer, like RTT does.
+ *
+ * Command line: calls=<entries timed> frames=<file> expected=<file>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "nrf_log_backend.h"
+#include "nrf_log_internal.h"
+
+
+#define CALLS_DEFAULT   (1000000)
+#define CAPTURE_SIZE    (4096)
+#define RING_SIZE       (1024)
+#define DUMP_SIZE       (100)
+#define DUMP_SPLIT      (37)            // Length of the first part of the dump.
+#define DUMP_LINE       (16)
+#define TIMESTAMP       (12345)
+#define ARGS_MAX        (6)
+
+typedef struct
+{
+    uint8_t      severity;
+    bool         timestamp;
+    char const * p_str;
+    uint32_t     nargs;
+    uint32_t     args[ARGS_MAX];
+    char const * strings[ARGS_MAX];     // Arguments that are strings, NULL for the others.
+    char const * p_expected;
+} entry_t;
+
+static char const m_name[] = "touch";
+static char const m_long[] = "0123456789abcdefghijklmnopqrstuvwxyz, cut after 32 characters";
+
+static char const m_touch_str[] = "Frame(%d): (%d, %d) x(%d) y(%d) z(%d)\r\n";
+static char const m_dump_str[]  = "hexdump of 100 bytes";
+
+static entry_t const m_entries[] =
+{
+    {NRF_LOG_LEVEL_INFO | NRF_LOG_RAW, false, m_touch_str, 6,
+     {31234, 3, 4, 1234, 54321, 345}, {NULL},
+     "Frame(31234): (3, 4) x(1234) y(54321) z(345)\r\n"},
+    {NRF_LOG_LEVEL_DEBUG, true, "app: no arguments\r\n", 0,
+     {0}, {NULL},
+     "[00012345]app: no arguments\r\n"},
+    {NRF_LOG_LEVEL_ERROR, false, "%d %i %hd %hhd %u %08x\r\n", 6,
+     {(uint32_t)-1, (uint32_t)-100000, 0xFFFF8000, 0xFE, 0xFFFFFFFF, 0xABC}, {NULL},
+     "-1 -100000 -32768 -2 4294967295 00000abc\r\n"},
+    {NRF_LOG_LEVEL_WARNING, true, "%*d|%-5d|%05u\r\n", 4,
+     {6, 99, (uint32_t)-7, 42}, {NULL},
+     "[00012345]    99|-7   |00042\r\n"},
+    {NRF_LOG_LEVEL_INFO, false, "%x|%X|%c|%%\r\n", 3,
+     {0xBEEF, 0xBEEF, 'Q'}, {NULL},
+     "beef|BEEF|Q|%\r\n"},
+    {NRF_LOG_LEVEL_INFO, true, "%s=%d %s!\r\n", 3,
+     {0, 5, 0}, {m_name, NULL, m_long},
+     "[00012345]touch=5 0123456789abcdefghijklmnopqrstuv!\r\n"},
+};
+
+static uint32_t m_calls = CALLS_DEFAULT;
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+static bool     m_capture;
+static uint8_t  m_capture_buf[CAPTURE_SIZE];
+static uint32_t m_capture_len;
+static uint8_t  m_ring[RING_SIZE];
+static uint32_t m_ring_pos;
+static uint64_t m_bytes;
+
+
+void SEGGER_RTT_Init(void)
+{
+}
+
+
+unsigned SEGGER_RTT_WriteNoLock(unsigned BufferIndex, const void * pBuffer, unsigned NumBytes)
+{
+    uint8_t const * p_data = pBuffer;
+
+    if (m_capture)
+    {
+        if (m_capture_len + NumBytes <= CAPTURE_SIZE)
+        {
+            memcpy(&m_capture_buf[m_capture_len], p_data, NumBytes);
+            m_capture_len += NumBytes;
+        }
+        return NumBytes;
+    }
+
+    m_bytes += NumBytes;
+    for (unsigned done = 0; done < NumBytes; )
+    {
+        unsigned chunk = MIN(NumBytes - done, RING_SIZE - m_ring_pos);
+
+        memcpy(&m_ring[m_ring_pos], &p_data[done], chunk);
+        done      += chunk;
+        m_ring_pos = (m_ring_pos + chunk) % RING_SIZE;
+    }
+    return NumBytes;
+}
+
+
+int SEGGER_RTT_WaitKey(void)
+{
+    return 0;
+}
+
+
+static void check(bool condition, char const * p_what)
+{
+    m_checks++;
+    if (!condition)
+    {
+        m_failures++;
+        printf("FAILED: %s\n", p_what);
+    }
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void entry_log(entry_t const * p_entry)
+{
+    static uint32_t const timestamp = TIMESTAMP;
+    uint32_t              args[ARGS_MAX];
+
+    for (uint32_t i = 0; i < ARGS_MAX; i++)
+    {
+        args[i] = (p_entry->strings[i] != NULL) ? (uint32_t)(uintptr_t)p_entry->strings[i]
+                                                : p_entry->args[i];
+    }
+    check(nrf_log_backend_std_handler_get()(p_entry->severity,
+                                            p_entry->timestamp ? &timestamp : NULL,
+                                            p_entry->p_str, args, p_entry->nargs),
+          "entry accepted");
+}
+
+
+#if NRF_LOG_BACKEND_SERIAL_BINARY
+static char const m_empty_str[] = "empty hexdump";
+
+
+static void text_append(FILE * p_file, char const * p_text)
+{
+    // The decoder ends lines with \n only.
+    for (; *p_text != '\0'; p_text++)
+    {
+        if (*p_text != '\r')
+        {
+            (void)fputc(*p_text, p_file);
+        }
+    }
+}
+
+
+static uint32_t hexdump_log(uint32_t const * p_timestamp, char const * p_str,
+                            uint8_t const * p_data, uint32_t length)
+{
+    uint32_t split  = MIN(length, DUMP_SPLIT);
+    uint32_t offset = 0;
+    uint32_t calls  = 0;
+
+    do
+    {
+        offset = nrf_log_backend_hexdump_handler_get()(NRF_LOG_LEVEL_INFO, p_timestamp, p_str,
+                                                       offset, p_data, split,
+                                                       p_data + split, length - split);
+        calls++;
+    } while ((offset < length) && (calls < length));
+
+    return offset;
+}
+
+
+static void frames_write(char const * p_frames_file, char const * p_expected_file)
+{
+    static uint32_t const timestamp = TIMESTAMP;
+    static uint8_t const  garbage[] = {0xA5, 0x03, 'z', 'z', 0xA5, 0x00};
+    uint8_t               dump[DUMP_SIZE];
+    FILE                * p_frames   = fopen(p_frames_file, "wb");
+    FILE                * p_expected = fopen(p_expected_file, "w");
+
+    if ((p_frames == NULL) || (p_expected == NULL))
+    {
+        fprintf(stderr, "cannot open the output files\n");
+        exit(2);
+    }
+
+    m_capture     = true;
+    m_capture_len = 0;
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_entries); i++)
+    {
+        entry_log(&m_entries[i]);
+        text_append(p_expected, m_entries[i].p_expected);
+    }
+
+    // Garbage between the frames, then a corrupted frame that the decoder must drop without
+    // losing the frame after it.
+    memcpy(&m_capture_buf[m_capture_len], garbage, sizeof(garbage));
+    m_capture_len += sizeof(garbage);
+    uint32_t const corrupted = m_capture_len;
+    entry_log(&m_entries[0]);
+    m_capture_buf[corrupted + 5] ^= 0x01;
+    entry_log(&m_entries[0]);
+    text_append(p_expected, m_entries[0].p_expected);
+
+    for (uint32_t i = 0; i < DUMP_SIZE; i++)
+    {
+        dump[i] = (uint8_t)((i * 7) + 0x20);
+    }
+    check(hexdump_log(&timestamp, m_dump_str, dump, DUMP_SIZE) == DUMP_SIZE, "hexdump sent");
+    fprintf(p_expected, "[%08u]%s\n", TIMESTAMP, m_dump_str);
+    for (uint32_t line = 0; line < DUMP_SIZE; line += DUMP_LINE)
+    {
+        char hex_part[DUMP_LINE * 3 + 1] = "";
+        char char_part[DUMP_LINE + 1]    = "";
+
+        for (uint32_t i = line; i < MIN(line + DUMP_LINE, DUMP_SIZE); i++)
+        {
+            (void)sprintf(&hex_part[strlen(hex_part)], (i == line) ? "%02X" : " %02X", dump[i]);
+            char_part[i - line] = ((dump[i] >= 0x20) && (dump[i] < 0x7F)) ? dump[i] : '.';
+        }
+        fprintf(p_expected, "%10s%-48s %s\n", "", hex_part, char_part);
+    }
+
+    check(hexdump_log(NULL, m_empty_str, NULL, 0) == 0, "empty hexdump sent");
+    fprintf(p_expected, "%s\n", m_empty_str);
+
+    m_capture = false;
+    check(fwrite(m_capture_buf, 1, m_capture_len, p_frames) == m_capture_len, "frames written");
+    (void)fclose(p_frames);
+    (void)fclose(p_expected);
+}
+#else
+
+static void output_test(void)
+{
+    m_capture = true;
+    for (uint32_t i = 0; i < ARRAY_SIZE(m_entries); i++)
+    {
+        if (m_entries[i].strings[0] || m_entries[i].strings[1] || m_entries[i].strings[2])
+        {
+            continue;
+        }
+
+        m_capture_len = 0;
+        entry_log(&m_entries[i]);
+        check((m_capture_len == strlen(m_entries[i].p_expected)) &&
+              (memcmp(m_capture_buf, m_entries[i].p_expected, m_capture_len) == 0),
+              m_entries[i].p_expected);
+    }
+    m_capture = false;
+}
+#endif // NRF_LOG_BACKEND_SERIAL_BINARY
+
+
+static void cost_measure(void)
+{
+    uint32_t       args[ARGS_MAX];
+    uint8_t        dump[DUMP_SIZE] = {0};
+    uint32_t const dump_calls      = m_calls / 10;
+
+    memcpy(args, m_entries[0].args, sizeof(args));
+    m_bytes = 0;
+
+    uint64_t start = host_time_ns();
+    for (uint32_t i = 0; i < m_calls; i++)
+    {
+        // Vary the arguments a little, like the coordinates of a real trace.
+        args[0] = i;
+        args[5] = i & 0x3FF;
+        (void)nrf_log_backend_std_handler_get()(NRF_LOG_LEVEL_INFO | NRF_LOG_RAW, NULL,
+                                                m_touch_str, args, 6);
+    }
+    uint64_t elapsed = host_time_ns() - start;
+    printf("  touch trace:     %6.1f ns per entry, %4.1f bytes per entry\n",
+           (double)elapsed / m_calls, (double)m_bytes / m_calls);
+
+    m_bytes = 0;
+    start   = host_time_ns();
+    for (uint32_t i = 0; i < dump_calls; i++)
+    {
+        dump[0] = (uint8_t)i;
+        (void)nrf_log_backend_hexdump_handler_get()(NRF_LOG_LEVEL_INFO, NULL, m_dump_str, 0,
+                                                    dump, DUMP_SPLIT,
+                                                    dump + DUMP_SPLIT, DUMP_SIZE - DUMP_SPLIT);
+    }
+    elapsed = host_time_ns() - start;
+    printf("  100-byte dump:   %6.1f ns per entry, %4.1f bytes per entry\n",
+           (double)elapsed / dump_calls, (double)m_bytes / dump_calls);
+}
+
+
+int main(int argc, char * argv[])
+{
+    char const * p_frames_file   = NULL;
+    char const * p_expected_file = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "calls=", 6) == 0)
+        {
+            m_calls = strtoul(argv[i] + 6, NULL, 0);
+        }
+        else if (strncmp(argv[i], "frames=", 7) == 0)
+        {
+            p_frames_file = argv[i] + 7;
+        }
+        else if (strncmp(argv[i], "expected=", 9) == 0)
+        {
+            p_expected_file = argv[i] + 9;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [calls=<n>] [frames=<file> expected=<file>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (m_calls < 10)
+    {
+        fprintf(stderr, "calls must be at least 10\n");
+        return 2;
+    }
+
+    printf("%s output\n", NRF_LOG_BACKEND_SERIAL_BINARY ? "binary" : "text");
+    check(nrf_log_backend_init(true) == NRF_SUCCESS, "init");
+
+#if NRF_LOG_BACKEND_SERIAL_BINARY
+    if ((p_frames_file != NULL) && (p_expected_file != NULL))
+    {
+        frames_write(p_frames_file, p_expected_file);
+    }
+#else
+    (void)p_frames_file;
+    (void)p_expected_file;
+    output_test();
+#endif
+    cost_measure();
+
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Configuration of the log benchmark. The serial backend writes to RTT, which the benchmark
+ * replaces with a buffer. The Makefile builds it with and without NRF_LOG_BACKEND_SERIAL_BINARY. */
+
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+#define NRF_LOG_ENABLED 1
+#define NRF_LOG_USES_COLORS 0
+#define NRF_LOG_TIMESTAMP_DIGITS 8
+#define NRF_LOG_BACKEND_MAX_STRING_LENGTH 256
+#define NRF_LOG_BACKEND_SERIAL_USES_UART 0
+#define NRF_LOG_BACKEND_SERIAL_USES_RTT 1
+
+#ifndef NRF_LOG_BACKEND_SERIAL_BINARY
+#define NRF_LOG_BACKEND_SERIAL_BINARY 0
+#endif
+
+#endif // SDK_CONFIG_H
@@ -0,0 +1,285 @@
+#!/usr/bin/env python3
+# Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+#
+# The information contained herein is property of Nordic Semiconductor ASA.
+# Terms and conditions of usage are described in detail in NORDIC
+# SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+#
+# Licensees are granted free, non-transferable use of the information. NO
+# WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+# the file.
+#
+
+"""Decoder for binary nrf_log frames.
+
+Reads the frames written by the serial backend when NRF_LOG_BACKEND_SERIAL_BINARY
+is enabled (see nrf_log_binary.h for the frame layout), looks the format strings
+up in the ELF file of the application and prints the formatted log.
+
+Examples:
+    nrf_log_decode.py _build/nrf52832_xxaa.out -i /dev/ttyACM0 -b 115200
+    JLinkRTTLogger ... rtt.bin; nrf_log_decode.py app.out -i rtt.bin
+
+Only the Python 3 standard library is used.
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+SYNC = 0xA5
+
+FLAG_LEVEL_MASK = 0x07
+FLAG_RAW = 0x08
+FLAG_TIMESTAMP = 0x10
+FLAG_TYPE_POS = 5
+FLAG_TYPE_MASK = 0x03 << FLAG_TYPE_POS
+
+TYPE_STD = 0
+TYPE_HEXDUMP = 1
+
+HEXDUMP_BYTES_PER_LINE = 16
+
+SHF_ALLOC = 0x2
+SHT_NOBITS = 8
+
+
+class ElfImage(object):
+    """Read-only view of the allocated sections of an ELF file, by address."""
+
+    def __init__(self, path):
+        with open(path, 'rb') as f:
+            self.data = f.read()
+        if self.data[:4] != b'\x7fELF':
+            raise ValueError('%s is not an ELF file' % path)
+        is_64 = self.data[4] == 2
+        endian = '<' if self.data[5] == 1 else '>'
+
+        if is_64:
+            shoff, = struct.unpack_from(endian + 'Q', self.data, 0x28)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', self.data, 0x3A)
+            section_fmt = endian + 'IIQQQQ'
+        else:
+            shoff, = struct.unpack_from(endian + 'I', self.data, 0x20)
+            shentsize, shnum = struct.unpack_from(endian + 'HH', self.data, 0x2E)
+            section_fmt = endian + 'IIIIII'
+
+        self.sections = []
+        for i in range(shnum):
+            _, sh_type, sh_flags, sh_addr, sh_offset, sh_size = \
+                struct.unpack_from(section_fmt, self.data, shoff + i * shentsize)
+            if (sh_flags & SHF_ALLOC) and sh_type != SHT_NOBITS and sh_addr != 0:
+                self.sections.append((sh_addr, sh_size, sh_offset))
+        self.cache = {}
+
+    def string(self, addr):
+        """Return the NUL-terminated string at addr, or None if it is not in the image."""
+        if addr in self.cache:
+            return self.cache[addr]
+        result = None
+        for sh_addr, sh_size, sh_offset in self.sections:
+            if sh_addr <= addr < sh_addr + sh_size:
+                start = sh_offset + addr - sh_addr
+                end = self.data.find(b'\0', start, sh_offset + sh_size)
+                if end >= 0:
+                    result = self.data[start:end].decode('latin-1')
+                break
+        self.cache[addr] = result
+        return result
+
+
+CONVERSION = re.compile(r'%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d*))?(hh|h|ll|l|L|j|z|t)?([diouxXcsfeEgGp%])')
+
+
+def format_c(fmt, args):
+    """Format like printf, with the 32-bit arguments of the device."""
+    args = list(args)
+
+    def next_arg():
+        return args.pop(0) if args else 0
+
+    def as_int(value):
+        return value - (1 << 32) if isinstance(value, int) and value & 0x80000000 else value
+
+    def convert(m):
+        flags, width, precision, length, conv = m.groups()
+        if conv == '%':
+            return '%'
+        if width == '*':
+            width = str(as_int(next_arg()))
+        if precision == '*':
+            precision = str(as_int(next_arg()))
+        spec = '%' + flags + (width or '') + ('.' + precision if precision is not None else '')
+        value = next_arg()
+        if conv == 's':
+            return (spec + 's') % (value if isinstance(value, str) else '0x%08x' % value)
+        if isinstance(value, str):
+            return value
+        if conv in 'di':
+            if length == 'hh':
+                value = struct.unpack('b', struct.pack('B', value & 0xFF))[0]
+            elif length == 'h':
+                value = struct.unpack('h', struct.pack('H', value & 0xFFFF))[0]
+            else:
+                value = as_int(value)
+            return (spec + 'd') % value
+        if conv in 'ouxX':
+            if length == 'hh':
+                value &= 0xFF
+            elif length == 'h':
+                value &= 0xFFFF
+            return (spec + ('d' if conv == 'u' else conv)) % value
+        if conv == 'c':
+            return (spec + 'c') % chr(value & 0xFF)
+        if conv == 'p':
+            return (spec + 's') % ('0x%08x' % value)
+        # Floats can't be passed through the 32-bit arguments.
+        return '<%s:0x%08x>' % (conv, value)
+
+    return CONVERSION.sub(convert, fmt)
+
+
+class Decoder(object):
+
+    def __init__(self, elf, out, timestamp_digits):
+        self.elf = elf
+        self.out = out
+        self.timestamp_digits = timestamp_digits
+        self.buf = bytearray()
+        self.frames = 0
+        self.errors = 0
+
+    def feed(self, data):
+        self.buf += data
+        buf = self.buf
+        pos = 0
+        while True:
+            pos = buf.find(SYNC, pos)
+            if pos < 0 or len(buf) - pos < 2:
+                break
+            body_len = buf[pos + 1]
+            end = pos + 3 + body_len
+            if len(buf) < end:
+                break
+            if body_len == 0 or (sum(buf[pos + 1:end]) & 0xFF) != 0 or not self.frame(buf[pos + 2:end - 1]):
+                # Not a frame, or a corrupted one. Resynchronize on the next sync byte.
+                self.errors += 1
+                pos += 1
+                continue
+            self.frames += 1
+            pos = end
+        del buf[:pos if pos >= 0 else len(buf)]
+
+    def frame(self, body):
+        flags = body[0]
+        pos = 1
+        prefix = ''
+        if flags & FLAG_TIMESTAMP:
+            timestamp, = struct.unpack_from('<I', body, pos)
+            pos += 4
+            prefix = '[%0*d]' % (self.timestamp_digits, timestamp)
+        frame_type = (flags & FLAG_TYPE_MASK) >> FLAG_TYPE_POS
+        try:
+            if frame_type == TYPE_STD:
+                self.std(prefix, body, pos)
+            elif frame_type == TYPE_HEXDUMP:
+                self.hexdump(prefix, body, pos)
+            else:
+                return False
+        except (struct.error, IndexError):
+            return False
+        return True
+
+    def std(self, prefix, body, pos):
+        addr, nargs, strings = struct.unpack_from('<IBB', body, pos)
+        pos += 6
+        args = []
+        for i in range(nargs):
+            if strings & (1 << i):
+                length = body[pos]
+                args.append(bytes(body[pos + 1:pos + 1 + length]).decode('latin-1'))
+                pos += 1 + length
+            else:
+                value, shift = 0, 0
+                while True:
+                    byte = body[pos]
+                    pos += 1
+                    value |= (byte & 0x7F) << shift
+                    shift += 7
+                    if not byte & 0x80:
+                        break
+                args.append(value & 0xFFFFFFFF)
+        if pos != len(body):
+            raise IndexError('trailing bytes')
+
+        fmt = self.elf.string(addr)
+        if fmt is None:
+            text = '<unknown format 0x%08x> %s\n' % (addr, ' '.join(str(a) for a in args))
+        else:
+            text = format_c(fmt, args)
+        self.write(prefix + text)
+
+    def hexdump(self, prefix, body, pos):
+        addr, offset, length = struct.unpack_from('<IHH', body, pos)
+        data = bytes(body[pos + 8:])
+        if offset == 0:
+            description = self.elf.string(addr)
+            if description is None:
+                description = '<unknown string 0x%08x>' % addr
+            self.write(prefix + description + '\n')
+        indent = ' ' * len(prefix)
+        for i in range(0, len(data), HEXDUMP_BYTES_PER_LINE):
+            line = data[i:i + HEXDUMP_BYTES_PER_LINE]
+            hex_part = ' '.join('%02X' % b for b in line)
+            char_part = ''.join(chr(b) if 0x20 <= b < 0x7F else '.' for b in line)
+            self.write('%s%-*s %s\n' % (indent, HEXDUMP_BYTES_PER_LINE * 3, hex_part, char_part))
+
+    def write(self, text):
+        self.out.write(text.replace('\r\n', '\n'))
+
+
+def open_input(path, baudrate):
+    if path == '-':
+        return sys.stdin.buffer
+    f = open(path, 'rb', buffering=0)
+    if os.isatty(f.fileno()):
+        import termios
+        import tty
+        tty.setraw(f.fileno())
+        if baudrate:
+            attrs = termios.tcgetattr(f.fileno())
+            speed = getattr(termios, 'B%d' % baudrate)
+            attrs[4] = attrs[5] = speed
+            termios.tcsetattr(f.fileno(), termios.TCSANOW, attrs)
+    return f
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decode binary nrf_log frames.')
+    parser.add_argument('elf', help='ELF file of the application that sends the log')
+    parser.add_argument('-i', '--input', default='-',
+                        help='file or serial port to read the frames from (default: stdin)')
+    parser.add_argument('-b', '--baudrate', type=int, default=0,
+                        help='baud rate, if the input is a serial port')
+    parser.add_argument('-t', '--timestamp-digits', type=int, default=8,
+                        help='number of digits of the timestamp (NRF_LOG_TIMESTAMP_DIGITS)')
+    args = parser.parse_args()
+
+    decoder = Decoder(ElfImage(args.elf), sys.stdout, args.timestamp_digits)
+    source = open_input(args.input, args.baudrate)
+    try:
+        while True:
+            data = source.read1(4096) if hasattr(source, 'read1') else source.read(4096)
+            if not data:
+                break
+            decoder.feed(data)
+            sys.stdout.flush()
+    except KeyboardInterrupt:
+        pass
+    sys.stderr.write('%d frames, %d errors\n' % (decoder.frames, decoder.errors))
+
+
+if __name__ == '__main__':
+    main()
@@ -139,9 +139,6 @@
 #ifndef MEMORY_MANAGER_XXSMALL_BLOCK_COUNT
     #define MEMORY_MANAGER_XXSMALL_BLOCK_COUNT 0
     #define MEMORY_MANAGER_XXSMALL_BLOCK_SIZE  0
-    #define XXSMALL_BLOCK_START                0
-    #define XXSMALL_BLOCK_END                  0
-    #define XXSMALL_MEMORY_START               0
 #endif // MEMORY_MANAGER_XXSMALL_BLOCK_SIZE
 
 
@@ -149,9 +146,6 @@
 #ifndef MEMORY_MANAGER_XSMALL_BLOCK_COUNT
    #define MEMORY_MANAGER_XSMALL_BLOCK_COUNT   0
    #define MEMORY_MANAGER_XSMALL_BLOCK_SIZE    0
-   #define XSMALL_BLOCK_START                  0
-   #define XSMALL_BLOCK_END                    0
-   #define XSMALL_MEMORY_START                 0
 #endif // MEMORY_MANAGER_XSMALL_BLOCK_SIZE
 
 
@@ -159,9 +153,6 @@
 #ifndef MEMORY_MANAGER_SMALL_BLOCK_COUNT
    #define MEMORY_MANAGER_SMALL_BLOCK_COUNT    0
    #define MEMORY_MANAGER_SMALL_BLOCK_SIZE     0
-   #define SMALL_BLOCK_START                   0
-   #define SMALL_BLOCK_END                     0
-   #define SMALL_MEMORY_START                  0
 #endif // MEMORY_MANAGER_SMALL_BLOCK_COUNT
 
 
@@ -169,9 +160,6 @@
 #ifndef MEMORY_MANAGER_MEDIUM_BLOCK_COUNT
    #define MEMORY_MANAGER_MEDIUM_BLOCK_COUNT   0
    #define MEMORY_MANAGER_MEDIUM_BLOCK_SIZE    0
-   #define MEDIUM_BLOCK_START                  0
-   #define MEDIUM_BLOCK_END                    0
-   #define MEDIUM_MEMORY_START                 0
 #endif // MEMORY_MANAGER_MEDIUM_BLOCK_COUNT
 
 
@@ -179,9 +167,6 @@
 #ifndef MEMORY_MANAGER_LARGE_BLOCK_COUNT
    #define MEMORY_MANAGER_LARGE_BLOCK_COUNT    0
    #define MEMORY_MANAGER_LARGE_BLOCK_SIZE     0
-   #define LARGE_BLOCK_START                   0
-   #define LARGE_BLOCK_END                     0
-   #define LARGE_MEMORY_START                  0
 #endif // MEMORY_MANAGER_LARGE_BLOCK_COUNT
 
 
@@ -189,9 +174,6 @@
 #ifndef MEMORY_MANAGER_XLARGE_BLOCK_COUNT
    #define MEMORY_MANAGER_XLARGE_BLOCK_COUNT   0
    #define MEMORY_MANAGER_XLARGE_BLOCK_SIZE    0
-   #define XLARGE_BLOCK_START                  0
-   #define XLARGE_BLOCK_END                    0
-   #define XLARGE_MEMORY_START                 0
 #endif // MEMORY_MANAGER_XLARGE_BLOCK_COUNT
 
 
@@ -199,9 +181,6 @@
 #ifndef MEMORY_MANAGER_XXLARGE_BLOCK_COUNT
    #define MEMORY_MANAGER_XXLARGE_BLOCK_COUNT  0
    #define MEMORY_MANAGER_XXLARGE_BLOCK_SIZE   0
-   #define XXLARGE_BLOCK_START                 0
-   #define XXLARGE_BLOCK_END                   0
-   #define XXLARGE_MEMORY_START                0
 #endif // MEMORY_MANAGER_XXLARGE_BLOCK_COUNT
 
 
@@ -368,7 +347,7 @@
                            MEMORY_MANAGER_MEDIUM_BLOCK_COUNT  +                                     \
                            MEMORY_MANAGER_LARGE_BLOCK_COUNT   +                                     \
                            MEMORY_MANAGER_XLARGE_BLOCK_COUNT  +                                     \
-                           MEMORY_MANAGER_XLARGE_BLOCK_COUNT)
+                           MEMORY_MANAGER_XXLARGE_BLOCK_COUNT)
 
 
 /**@brief Total memory managed by the module. */
@@ -381,7 +360,7 @@
                            XXLARGE_MEMORY_SIZE)
 
 
-#define BLOCK_CAT_COUNT                7                                                            /**< Block category count is 7 (xxsmall, xsmall, small, medium, large, xlarge, xxlarge). Having one of the block count to zero has no impact on this count. */
+#define BLOCK_CAT_COUNT                NRF_MEM_BLOCK_CAT_COUNT                                      /**< Block category count is 7 (xxsmall, xsmall, small, medium, large, xlarge, xxlarge). Having one of the block count to zero has no impact on this count. */
 #define BLOCK_CAT_XXS                  0                                                            /**< Extra Extra Small category identifier. */
 #define BLOCK_CAT_XS                   1                                                            /**< Extra Small category identifier. */
 #define BLOCK_CAT_SMALL                2                                                            /**< Small category identifier. */
@@ -392,6 +371,7 @@
 
 #define BITMAP_SIZE                    32                                                           /**< Bitmap size for each word used to contain block information. */
 #define BLOCK_BITMAP_ARRAY_SIZE        CEIL_DIV(TOTAL_BLOCK_COUNT, BITMAP_SIZE)                     /**< Determines number of blocks needed for book keeping availability status of all blocks. */
+#define BLOCK_SUMMARY_ARRAY_SIZE       CEIL_DIV(BLOCK_BITMAP_ARRAY_SIZE, BITMAP_SIZE)               /**< Number of words needed to flag which bitmap words have a free block. */
 
 
 /**@brief Lookup table for maximum memory size per block category. */
@@ -444,6 +424,7 @@ static const uint32_t m_block_mem_start[BLOCK_CAT_COUNT] =
 
 static uint8_t  m_memory[TOTAL_MEMORY_SIZE];                                                        /**< Memory managed by the module. */
 static uint32_t m_mem_pool[BLOCK_BITMAP_ARRAY_SIZE];                                                /**< Bitmap used for book-keeping availability of all blocks managed by the module.  */
+static uint32_t m_mem_pool_summary[BLOCK_SUMMARY_ARRAY_SIZE];                                       /**< Bitmap of the words of m_mem_pool which have at least one free block. */
 
 #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
 
@@ -474,11 +455,8 @@ static uint32_t m_min_size[BLOCK_CAT_COUNT]  =
 /**@brief Table for book keeping largest size allocated in each block range. */
 static uint32_t m_max_size[BLOCK_CAT_COUNT];
 
-/**@brief Global pointing to minimum size holder for block type being allocated. */
-static uint32_t * p_min_size;
-
-/**@brief Global pointing to maximum size holder for block type being allocated. */
-static uint32_t * p_max_size;
+/**@brief Allocation statistics for each block category. */
+static nrf_mem_block_stats_t m_block_stats[BLOCK_CAT_COUNT];
 
 /**@brief Lookup table for count of block available in each block category. */
 static uint32_t m_block_count[BLOCK_CAT_COUNT] =
@@ -504,6 +482,8 @@ static bool     m_module_initialized = false;
  *
  * @details Function to get X and Y co-ordinates for the block identified by index.
  *          Here, X determines relevant word for the block. Y determines the actual bit in the word.
+ *          Blocks are stored from the most significant bit down, so that the lowest free block in
+ *          a word is found with a single count-leading-zeros instruction.
  *
  * @param[in]  index Identifies the block.
  * @param[out] p_x   Points to the word that contains the bit representing the block.
@@ -514,7 +494,7 @@ static __INLINE void get_block_coordinates(uint32_t block_index, uint32_t * p_x,
     // Determine position of the block in the bitmap.
     // X determines relevant word for the block. Y determines the actual bit in the word.
     const uint32_t x = block_index / BITMAP_SIZE;
-    const uint32_t y = (block_index - x * BITMAP_SIZE);
+    const uint32_t y = (BITMAP_SIZE - 1) - (block_index - x * BITMAP_SIZE);
 
     (*p_x) = x;
     (*p_y) = y;
@@ -526,6 +506,8 @@ static void block_init (uint32_t block_index)
 {
     uint32_t x;
     uint32_t y;
+    uint32_t summary_x;
+    uint32_t summary_y;
 
     // Determine position of the block in the bitmap.
     // X determines relevant word for the block. Y determines the actual bit in the word.
@@ -533,6 +515,10 @@ static void block_init (uint32_t block_index)
 
     // Set bit related to the block to indicate that the block is free.
     SET_BIT(m_mem_pool[x], y);
+
+    // The word now has a free block.
+    get_block_coordinates(x, &summary_x, &summary_y);
+    SET_BIT(m_mem_pool_summary[summary_x], summary_y);
 }
 
 
@@ -553,21 +539,15 @@ static __INLINE uint32_t get_block_cat(uint32_t size, uint32_t block_index)
 }
 
 
-/**@brief Function to get the size of the block number 'block_index'. */
-static __INLINE uint32_t get_block_size(uint32_t block_index)
+/**@brief Function to get the address of the block number 'block_index' of category 'block_cat'. */
+static __INLINE uint8_t * get_block_memory(uint32_t block_cat, uint32_t block_index)
 {
-    const uint32_t block_cat = get_block_cat(0, block_index);
-
-    #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
-        p_min_size = &m_min_size[block_cat];
-        p_max_size = &m_max_size[block_cat];
-    #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
-
-    return m_block_size[block_cat];
+    return &m_memory[m_block_mem_start[block_cat]
+                     + (block_index - m_block_start[block_cat]) * m_block_size[block_cat]];
 }
 
 
-/**@brief Function to free the block identified by block number 'block_index'. */
+/**@brief Function to check if the block identified by block number 'block_index' is free. */
 static bool is_block_free(uint32_t block_index)
 {
     uint32_t x;
@@ -592,6 +572,53 @@ static void block_allocate(uint32_t block_index)
     get_block_coordinates(block_index, &x, &y);
 
     CLR_BIT(m_mem_pool[x], y);
+
+    if (m_mem_pool[x] == 0)
+    {
+        // That was the last free block of the word.
+        get_block_coordinates(x, &x, &y);
+        CLR_BIT(m_mem_pool_summary[x], y);
+    }
+}
+
+
+/**@brief Function to find the lowest free block with a number of at least 'block_index'.
+ *
+ * @details The word holding 'block_index' is checked first. Otherwise, the summary bitmap gives
+ *          the next word with a free block, so the cost does not depend on the number of blocks.
+ *
+ * @return  The block number, or TOTAL_BLOCK_COUNT if there is no free block.
+ */
+static uint32_t find_free_block(uint32_t block_index)
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t word;
+
+    get_block_coordinates(block_index, &x, &y);
+
+    // Blocks from 'block_index' to the end of its word.
+    word = m_mem_pool[x] & ((y == BITMAP_SIZE - 1) ? 0xFFFFFFFF : ((1UL << (y + 1)) - 1));
+    if (word != 0)
+    {
+        return x * BITMAP_SIZE + __CLZ(word);
+    }
+
+    // Words after it which have a free block.
+    for (uint32_t word_index = x + 1; word_index < BLOCK_BITMAP_ARRAY_SIZE; )
+    {
+        get_block_coordinates(word_index, &x, &y);
+
+        word = m_mem_pool_summary[x] & ((y == BITMAP_SIZE - 1) ? 0xFFFFFFFF : ((1UL << (y + 1)) - 1));
+        if (word != 0)
+        {
+            word_index = x * BITMAP_SIZE + __CLZ(word);
+            return word_index * BITMAP_SIZE + __CLZ(m_mem_pool[word_index]);
+        }
+        word_index = (x + 1) * BITMAP_SIZE;
+    }
+
+    return TOTAL_BLOCK_COUNT;
 }
 
 
@@ -641,45 +668,57 @@ uint32_t nrf_mem_reserve(uint8_t ** pp_buffer, uint32_t * p_size)
     MM_MUTEX_LOCK();
 
     const uint32_t block_cat    = get_block_cat(requested_size, TOTAL_BLOCK_COUNT);
-    uint32_t       block_index  = m_block_start[block_cat];
-    uint32_t       memory_index = m_block_mem_start[block_cat];
+    uint32_t       block_index  = find_free_block(m_block_start[block_cat]);
     uint32_t       err_code     = (NRF_ERROR_NO_MEM | NRF_ERROR_MEMORY_MANAGER_ERR_BASE);
 
     NRF_LOG_DEBUG("[MM]: Start index for the pool = 0x%08lX, total block count 0x%08X\r\n",
-           block_index,
+           m_block_start[block_cat],
            TOTAL_BLOCK_COUNT);
 
-    for (; block_index < TOTAL_BLOCK_COUNT; block_index++)
+    if (block_index < TOTAL_BLOCK_COUNT)
     {
-        uint32_t block_size = get_block_size(block_index);
+        // If the category is exhausted, the block comes from a larger one.
+        const uint32_t alloc_cat = get_block_cat(0, block_index);
 
-        if (is_block_free(block_index) == true)
-        {
-            NRF_LOG_DEBUG("[MM]: Reserving block 0x%08lX\r\n", block_index);
+        NRF_LOG_DEBUG("[MM]: Reserving block 0x%08lX\r\n", block_index);
 
-            // Search succeeded, found free block.
-            err_code     = NRF_SUCCESS;
+        // Search succeeded, found free block.
+        err_code     = NRF_SUCCESS;
 
-            // Allocate block.
-            block_allocate(block_index);
+        // Allocate block.
+        block_allocate(block_index);
 
-            (*pp_buffer) = &m_memory[memory_index];
-            (*p_size)    = block_size;
+        (*pp_buffer) = get_block_memory(alloc_cat, block_index);
+        (*p_size)    = m_block_size[alloc_cat];
 
-            #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
-                (*p_min_size) = MIN((*p_min_size), requested_size);
-                (*p_max_size) = MAX((*p_max_size), requested_size);
-            #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+        #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+            nrf_mem_block_stats_t * p_stats = &m_block_stats[alloc_cat];
 
-            break;
-        }
-        memory_index += block_size;
+            m_min_size[alloc_cat] = MIN(m_min_size[alloc_cat], requested_size);
+            m_max_size[alloc_cat] = MAX(m_max_size[alloc_cat], requested_size);
+
+            p_stats->alloc_count++;
+            p_stats->requested_bytes += requested_size;
+            p_stats->allocated_bytes += m_block_size[alloc_cat];
+            p_stats->in_use++;
+            p_stats->peak_in_use      = MAX(p_stats->peak_in_use, p_stats->in_use);
+            if (alloc_cat != block_cat)
+            {
+                m_block_stats[block_cat].fallback_count++;
+            }
+        #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
     }
+    #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+    else
+    {
+        m_block_stats[block_cat].fail_count++;
+    }
+    #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
     if (err_code != NRF_SUCCESS)
     {
         NRF_LOG_DEBUG ("[MM]: Memory reservation result %d, memory %p, size %d!",
                 err_code,
-                (uint32_t)(*pp_buffer),
+                (uint32_t)(uintptr_t)(*pp_buffer),
                 (*p_size));
 
         #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
@@ -690,7 +729,7 @@ uint32_t nrf_mem_reserve(uint8_t ** pp_buffer, uint32_t * p_size)
     MM_MUTEX_UNLOCK();
 
     NRF_LOG_DEBUG("[MM]: << nrf_mem_reserve %p, result 0x%08lX.\r\n",
-                 (uint32_t)(*pp_buffer), err_code);
+                 (uint32_t)(uintptr_t)(*pp_buffer), err_code);
 
     return err_code;
 }
@@ -722,7 +761,7 @@ void * nrf_calloc(uint32_t count, uint32_t size)
     uint32_t retval = nrf_mem_reserve(&buffer,&allocated_size);
     if (retval == NRF_SUCCESS)
     {
-        NRF_LOG_DEBUG ("[nrf_calloc]: buffer %p, total size %d\r\n", (uint32_t)buffer, allocated_size);
+        NRF_LOG_DEBUG ("[nrf_calloc]: buffer %p, total size %d\r\n", (uint32_t)(uintptr_t)buffer, allocated_size);
         memset(buffer,0, allocated_size);
     }
     else
@@ -740,23 +779,37 @@ void nrf_free(void * p_mem)
     VERIFY_MODULE_INITIALIZED_VOID();
     NULL_PARAM_CHECK_VOID(p_mem);
 
-    NRF_LOG_DEBUG("[MM]: >> nrf_free %p.\r\n", (uint32_t)p_mem);
+    NRF_LOG_DEBUG("[MM]: >> nrf_free %p.\r\n", (uint32_t)(uintptr_t)p_mem);
 
     MM_MUTEX_LOCK();
 
-    uint32_t index;
-    uint32_t memory_index = 0;
+    const uint32_t offset = (uint32_t)((uint8_t *)p_mem - m_memory);
 
-    for (index = 0; index < TOTAL_BLOCK_COUNT; index++)
+    // Find the category from the address, then the block within it.
+    for (uint32_t block_cat = 0; block_cat < BLOCK_CAT_COUNT; block_cat++)
     {
-        if (&m_memory[memory_index] == p_mem)
+        const uint32_t mem_start = m_block_mem_start[block_cat];
+        const uint32_t mem_end   = mem_start + (m_block_end[block_cat] - m_block_start[block_cat])
+                                             * m_block_size[block_cat];
+
+        if ((offset >= mem_start) && (offset < mem_end))
         {
-            // Found a free block of memory, assign.
-            NRF_LOG_DEBUG("[MM]: << Freeing block %d.\r\n", index);
-            block_init(index);
+            const uint32_t index = m_block_start[block_cat]
+                                 + (offset - mem_start) / m_block_size[block_cat];
+
+            // Ignore pointers into the middle of a block, and blocks which are already free.
+            if ((((offset - mem_start) % m_block_size[block_cat]) == 0) && !is_block_free(index))
+            {
+                // Found a free block of memory, assign.
+                NRF_LOG_DEBUG("[MM]: << Freeing block %d.\r\n", index);
+                block_init(index);
+
+                #ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+                    m_block_stats[block_cat].in_use--;
+                #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+            }
             break;
         }
-        memory_index += get_block_size(index);
     }
 
     MM_MUTEX_UNLOCK();
@@ -888,6 +941,43 @@ void nrf_mem_diagnose(void)
     NRF_LOG_DEBUG ("+------------+------------+------------+------------+------------+------------+\r\n");
 }
 
+
+uint32_t nrf_mem_stats_get(uint32_t block_cat, nrf_mem_block_stats_t * p_stats)
+{
+    NULL_PARAM_CHECK(p_stats);
+
+    if (block_cat >= BLOCK_CAT_COUNT)
+    {
+        return (NRF_ERROR_INVALID_PARAM | NRF_ERROR_MEMORY_MANAGER_ERR_BASE);
+    }
+
+    MM_MUTEX_LOCK();
+
+    (*p_stats) = m_block_stats[block_cat];
+
+    MM_MUTEX_UNLOCK();
+
+    return NRF_SUCCESS;
+}
+
+
+void nrf_mem_stats_reset(void)
+{
+    MM_MUTEX_LOCK();
+
+    for (uint32_t block_cat = 0; block_cat < BLOCK_CAT_COUNT; block_cat++)
+    {
+        // Blocks which are in use stay counted.
+        const uint32_t in_use = m_block_stats[block_cat].in_use;
+
+        memset(&m_block_stats[block_cat], 0, sizeof(nrf_mem_block_stats_t));
+        m_block_stats[block_cat].in_use      = in_use;
+        m_block_stats[block_cat].peak_in_use = in_use;
+    }
+
+    MM_MUTEX_UNLOCK();
+}
+
 #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
 /** @} */
 #endif //NRF_MODULE_ENABLED(MEM_MANAGER)
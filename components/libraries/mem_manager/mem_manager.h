@@ -29,6 +29,10 @@
  * To use fewer than seven buffer pools, do not define the count for the unwanted block
  * or explicitly set it to zero. At least one block category must be configured
  * for this module to function as expected.
+ *
+ * Free blocks are tracked in a bitmap with a summary word on top, so reserving and freeing a block
+ * take the same time regardless of the number of blocks. If the category which fits a request is
+ * exhausted, the block is taken from the next larger category which has one.
  */
 
 #ifndef MEM_MANAGER_H__
@@ -41,6 +45,23 @@ extern "C" {
 #endif
 
 
+#define NRF_MEM_BLOCK_CAT_COUNT 7   /**< Number of block categories, from xxsmall (0) to xxlarge (6). */
+
+
+/**@brief Allocation statistics of one block category. */
+typedef struct
+{
+    uint32_t alloc_count;       /**< Number of blocks reserved from this category. */
+    uint32_t fail_count;        /**< Number of requests which fit this category and failed for lack of memory. */
+    uint32_t fallback_count;    /**< Number of requests which fit this category but were served from a larger one, because it was exhausted. */
+    uint32_t in_use;            /**< Number of blocks of this category currently in use. */
+    uint32_t peak_in_use;       /**< Largest number of blocks of this category in use at the same time. */
+    uint32_t requested_bytes;   /**< Sum of the sizes requested for the blocks reserved from this category. */
+    uint32_t allocated_bytes;   /**< Sum of the sizes of the blocks reserved from this category. The
+                                     difference to requested_bytes is the internal fragmentation. */
+} nrf_mem_block_stats_t;
+
+
 /**@brief Initializes Memory Manager.
  *
  * @details API to initialize the Memory Manager. Always call this API before using any of the other
@@ -137,6 +158,24 @@ void * nrf_realloc(void *p_buffer, uint32_t size);
  */
 void nrf_mem_diagnose(void);
 
+
+/**@brief Function for getting the allocation statistics of a block category.
+ *
+ * @param[in]  block_cat  Block category, from 0 (xxsmall) to @ref NRF_MEM_BLOCK_CAT_COUNT - 1 (xxlarge).
+ * @param[out] p_stats    Statistics of the category.
+ *
+ * @retval NRF_SUCCESS             If the statistics were returned.
+ * @retval NRF_ERROR_INVALID_PARAM If the block category does not exist.
+ */
+uint32_t nrf_mem_stats_get(uint32_t block_cat, nrf_mem_block_stats_t * p_stats);
+
+
+/**@brief Function for resetting the allocation statistics of all block categories.
+ *
+ * @details The number of blocks in use is kept, and becomes the new peak.
+ */
+void nrf_mem_stats_reset(void);
+
 #endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
 
 
@@ -0,0 +1,506 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Memory manager test and benchmark for a PC host.
+ *
+ * The test reserves and frees blocks of random sizes, mostly small ones, and checks each result
+ * against a model of the block layout in sdk_config.h: the block must be the lowest free one of
+ * the smallest category that fits, or of the next larger category which has one, at the address
+ * given by the layout. The content written to each block is checked when it is freed, which
+ * catches overlapping blocks. Pointers into the middle of a block and double frees must be
+ * ignored. With MEM_MANAGER_ENABLE_DIAGNOSTICS, the statistics of nrf_mem_stats_get() are checked
+ * against the model too, and printed.
+ *
+ * The benchmark then keeps the pool at 10%, 50% and 90% of its blocks in use with random reserves
+ * and frees, and prints the host time of nrf_mem_reserve() and nrf_free() at each level.
+ *
+ * Command line: ops=<operations per run>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "nrf_error.h"
+#include "mem_manager.h"
+
+
+#define OPS_DEFAULT     (200000)
+#define ERR_STATE       (NRF_ERROR_INVALID_STATE | NRF_ERROR_MEMORY_MANAGER_ERR_BASE)
+#define ERR_NO_MEM      (NRF_ERROR_NO_MEM | NRF_ERROR_MEMORY_MANAGER_ERR_BASE)
+#define ERR_PARAM       (NRF_ERROR_INVALID_PARAM | NRF_ERROR_MEMORY_MANAGER_ERR_BASE)
+
+typedef struct
+{
+    uint32_t size;
+    uint32_t count;
+    uint32_t start;         // Index of the first block.
+    uint32_t mem_start;     // Offset of the first block in the memory of the module.
+} cat_t;
+
+typedef struct
+{
+    uint8_t * p_mem;
+    uint32_t  block;
+    uint32_t  requested;
+    uint8_t   pattern;
+} alloc_t;
+
+
+static cat_t m_cats[NRF_MEM_BLOCK_CAT_COUNT] =
+{
+    {MEMORY_MANAGER_XXSMALL_BLOCK_SIZE, MEMORY_MANAGER_XXSMALL_BLOCK_COUNT},
+    {MEMORY_MANAGER_XSMALL_BLOCK_SIZE,  MEMORY_MANAGER_XSMALL_BLOCK_COUNT},
+    {MEMORY_MANAGER_SMALL_BLOCK_SIZE,   MEMORY_MANAGER_SMALL_BLOCK_COUNT},
+    {MEMORY_MANAGER_MEDIUM_BLOCK_SIZE,  MEMORY_MANAGER_MEDIUM_BLOCK_COUNT},
+    {MEMORY_MANAGER_LARGE_BLOCK_SIZE,   MEMORY_MANAGER_LARGE_BLOCK_COUNT},
+    {MEMORY_MANAGER_XLARGE_BLOCK_SIZE,  MEMORY_MANAGER_XLARGE_BLOCK_COUNT},
+    {MEMORY_MANAGER_XXLARGE_BLOCK_SIZE, MEMORY_MANAGER_XXLARGE_BLOCK_COUNT},
+};
+
+static uint32_t   m_total_blocks;
+static uint32_t   m_max_size;
+static bool     * mp_block_used;    // Model: blocks in use.
+static alloc_t  * mp_allocs;        // Blocks reserved through the module, in no order.
+static uint32_t   m_alloc_count;
+static uint8_t  * mp_base;          // Address of the memory of the module, learned from the first block.
+
+#ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+static nrf_mem_block_stats_t m_stats[NRF_MEM_BLOCK_CAT_COUNT];  // Model of the statistics.
+#endif
+
+static uint32_t m_rand = 1;
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+
+static void check(bool ok, char const * p_what)
+{
+    m_checks++;
+    if (!ok)
+    {
+        m_failures++;
+        if (m_failures <= 10)
+        {
+            printf("FAILED: %s\n", p_what);
+        }
+    }
+}
+
+
+static uint32_t bench_rand(void)
+{
+    m_rand = (m_rand * 1103515245UL) + 12345UL;
+    return (m_rand >> 16);
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void layout_init(void)
+{
+    uint32_t start     = 0;
+    uint32_t mem_start = 0;
+
+    for (uint32_t i = 0; i < NRF_MEM_BLOCK_CAT_COUNT; i++)
+    {
+        m_cats[i].start     = start;
+        m_cats[i].mem_start = mem_start;
+        start              += m_cats[i].count;
+        mem_start          += m_cats[i].count * m_cats[i].size;
+        if (m_cats[i].count > 0)
+        {
+            m_max_size = m_cats[i].size;
+        }
+    }
+    m_total_blocks = start;
+}
+
+
+static uint32_t block_cat(uint32_t block)
+{
+    uint32_t cat = 0;
+
+    while (block >= m_cats[cat].start + m_cats[cat].count)
+    {
+        cat++;
+    }
+    return cat;
+}
+
+
+/**@brief Random request size. Small sizes are the most frequent, as in typical users. */
+static uint32_t random_size(void)
+{
+    static uint8_t const weights[NRF_MEM_BLOCK_CAT_COUNT] = {5, 4, 3, 2, 1, 1, 0};
+
+    uint32_t pick = bench_rand() % 16;
+    uint32_t cat  = 0;
+
+    while (pick >= weights[cat])
+    {
+        pick -= weights[cat];
+        cat++;
+    }
+
+    uint32_t const low = (cat == 0) ? 0 : m_cats[cat - 1].size;
+
+    return low + 1 + (bench_rand() % (m_cats[cat].size - low));
+}
+
+
+/**@brief Reserves a block, with nrf_calloc() if 'zeroed', and checks the result against the model. */
+static void reserve_check(uint32_t requested, bool zeroed)
+{
+    uint8_t  * p_mem    = NULL;
+    uint32_t   size     = requested;
+    uint32_t   err_code;
+    uint32_t   cat      = 0;
+    uint32_t   block;
+
+    if (zeroed)
+    {
+        p_mem    = nrf_calloc(1, requested);
+        err_code = (p_mem != NULL) ? NRF_SUCCESS : ERR_NO_MEM;
+    }
+    else
+    {
+        err_code = nrf_mem_reserve(&p_mem, &size);
+    }
+
+    if ((requested == 0) || (requested > m_max_size))
+    {
+        check(err_code == (zeroed ? ERR_NO_MEM : ERR_PARAM), "reserve of an invalid size");
+        return;
+    }
+
+    while ((m_cats[cat].count == 0) || (m_cats[cat].size < requested))
+    {
+        cat++;
+    }
+    for (block = m_cats[cat].start; (block < m_total_blocks) && mp_block_used[block]; block++)
+    {
+    }
+
+    if (block == m_total_blocks)
+    {
+        check(err_code == ERR_NO_MEM, "reserve when exhausted");
+#ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+        m_stats[cat].fail_count++;
+#endif
+        return;
+    }
+
+    uint32_t const alloc_cat = block_cat(block);
+    uint32_t const offset    = m_cats[alloc_cat].mem_start
+                             + (block - m_cats[alloc_cat].start) * m_cats[alloc_cat].size;
+
+    check(err_code == NRF_SUCCESS, "reserve");
+    if (err_code != NRF_SUCCESS)
+    {
+        return;
+    }
+    if (mp_base == NULL)
+    {
+        mp_base = p_mem - offset;
+    }
+    check(p_mem == mp_base + offset, "lowest free block of the smallest category that fits");
+    if (zeroed)
+    {
+        size = m_cats[alloc_cat].size;
+        for (uint32_t i = 0; i < requested; i++)
+        {
+            if (p_mem[i] != 0)
+            {
+                check(false, "calloc zeroes the block");
+                break;
+            }
+        }
+    }
+    check(size == m_cats[alloc_cat].size, "reserved size");
+
+    // Continue from the block the module returned, so that one error is reported once.
+    block = m_cats[alloc_cat].start + (uint32_t)(p_mem - mp_base - m_cats[alloc_cat].mem_start)
+                                      / m_cats[alloc_cat].size;
+    if (block >= m_total_blocks)
+    {
+        check(false, "block outside the memory of the module");
+        return;
+    }
+
+    alloc_t * p_alloc = &mp_allocs[m_alloc_count++];
+
+    p_alloc->p_mem     = p_mem;
+    p_alloc->block     = block;
+    p_alloc->requested = requested;
+    p_alloc->pattern   = (uint8_t)bench_rand();
+    memset(p_mem, p_alloc->pattern, requested);
+    mp_block_used[block] = true;
+
+#ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+    nrf_mem_block_stats_t * p_stats = &m_stats[alloc_cat];
+
+    p_stats->alloc_count++;
+    p_stats->in_use++;
+    p_stats->requested_bytes += requested;
+    p_stats->allocated_bytes += size;
+    if (p_stats->in_use > p_stats->peak_in_use)
+    {
+        p_stats->peak_in_use = p_stats->in_use;
+    }
+    if (alloc_cat != cat)
+    {
+        m_stats[cat].fallback_count++;
+    }
+#endif
+}
+
+
+/**@brief Frees a random block, checking its content, with some invalid frees around it. */
+static void free_check(void)
+{
+    uint32_t const index   = bench_rand() % m_alloc_count;
+    alloc_t        alloc   = mp_allocs[index];
+    uint32_t const variant = bench_rand() % 8;
+
+    for (uint32_t i = 0; i < alloc.requested; i++)
+    {
+        if (alloc.p_mem[i] != alloc.pattern)
+        {
+            check(false, "block content overwritten");
+            break;
+        }
+    }
+
+    if (variant == 0)
+    {
+        nrf_free(alloc.p_mem + 1 + (bench_rand() % (m_cats[block_cat(alloc.block)].size - 1)));
+    }
+
+    nrf_free(alloc.p_mem);
+    mp_allocs[index]           = mp_allocs[--m_alloc_count];
+    mp_block_used[alloc.block] = false;
+
+    if (variant == 1)
+    {
+        nrf_free(alloc.p_mem);
+    }
+
+#ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+    m_stats[block_cat(alloc.block)].in_use--;
+#endif
+}
+
+
+static void free_all(void)
+{
+    while (m_alloc_count > 0)
+    {
+        free_check();
+    }
+}
+
+
+#ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+static void stats_check(void)
+{
+    nrf_mem_block_stats_t stats;
+
+    for (uint32_t cat = 0; cat < NRF_MEM_BLOCK_CAT_COUNT; cat++)
+    {
+        check(nrf_mem_stats_get(cat, &stats) == NRF_SUCCESS, "stats get");
+        check(memcmp(&stats, &m_stats[cat], sizeof(stats)) == 0, "statistics");
+    }
+    check(nrf_mem_stats_get(NRF_MEM_BLOCK_CAT_COUNT, &stats) == ERR_PARAM, "stats of no category");
+}
+
+
+static void stats_print(void)
+{
+    printf("  category   size  count  allocs  fallbacks  fails  peak  fragmentation\n");
+    for (uint32_t cat = 0; cat < NRF_MEM_BLOCK_CAT_COUNT; cat++)
+    {
+        nrf_mem_block_stats_t stats;
+
+        (void)nrf_mem_stats_get(cat, &stats);
+        printf("  %8u  %5u  %5u  %6u  %9u  %5u  %4u  %12.1f%%\n", cat, m_cats[cat].size,
+               m_cats[cat].count, stats.alloc_count, stats.fallback_count, stats.fail_count,
+               stats.peak_in_use,
+               (stats.allocated_bytes == 0) ? 0.0 :
+               100.0 * (stats.allocated_bytes - stats.requested_bytes) / stats.allocated_bytes);
+    }
+}
+#endif // MEM_MANAGER_ENABLE_DIAGNOSTICS
+
+
+static void model_test(uint32_t ops)
+{
+    uint8_t * p_mem;
+    uint32_t  size = 0;
+
+    check(nrf_mem_reserve(&p_mem, &size) == ERR_STATE, "reserve before init");
+    check(nrf_mem_init() == NRF_SUCCESS, "init");
+    nrf_free(NULL);
+
+    reserve_check(0, false);
+    reserve_check(m_max_size + 1, false);
+    reserve_check(0, true);
+
+    // Fill and drain the pool completely now and then, so that every category is exhausted.
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        bool const filling = ((i / (4 * m_total_blocks)) % 2) == 0;
+
+        if ((m_alloc_count > 0) && ((bench_rand() % 4) < (filling ? 1 : 3)))
+        {
+            free_check();
+        }
+        else
+        {
+            reserve_check(random_size(), (bench_rand() % 16) == 0);
+        }
+    }
+
+    free_all();
+}
+
+
+static int compare_u32(void const * p_a, void const * p_b)
+{
+    uint32_t const a = *(uint32_t const *)p_a;
+    uint32_t const b = *(uint32_t const *)p_b;
+
+    return (a > b) - (a < b);
+}
+
+
+static void latency_print(char const * p_name, uint32_t * p_ns, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    qsort(p_ns, count, sizeof(uint32_t), compare_u32);
+    printf("  %-8s %6u ns median, %6u ns 99th percentile, %7u ns max\n", p_name,
+           p_ns[count / 2], p_ns[(uint32_t)((uint64_t)count * 99 / 100)], p_ns[count - 1]);
+}
+
+
+/**@brief Times reserves and frees while the pool is kept near the given use, in percent. */
+static void latency_run(uint32_t percent, uint32_t ops, uint32_t * p_reserve_ns, uint32_t * p_free_ns)
+{
+    uint32_t const target   = m_total_blocks * percent / 100;
+    uint32_t       reserves = 0;
+    uint32_t       frees    = 0;
+    uint32_t       fails    = 0;
+
+    for (uint32_t i = 0; i < ops; i++)
+    {
+        bool const reserve = (m_alloc_count == 0) ||
+                             ((bench_rand() % 4) < ((m_alloc_count < target) ? 3 : 1));
+
+        if (reserve)
+        {
+            uint8_t      * p_mem;
+            uint32_t       size  = random_size();
+            uint64_t const start = host_time_ns();
+            uint32_t const err   = nrf_mem_reserve(&p_mem, &size);
+
+            p_reserve_ns[reserves++] = (uint32_t)(host_time_ns() - start);
+            if (err == NRF_SUCCESS)
+            {
+                mp_allocs[m_alloc_count++].p_mem = p_mem;
+            }
+            else
+            {
+                fails++;
+            }
+        }
+        else
+        {
+            uint32_t const index = bench_rand() % m_alloc_count;
+            uint64_t const start = host_time_ns();
+
+            nrf_free(mp_allocs[index].p_mem);
+            p_free_ns[frees++]  = (uint32_t)(host_time_ns() - start);
+            mp_allocs[index]    = mp_allocs[--m_alloc_count];
+        }
+    }
+
+    printf("%u%% of %u blocks in use, %u reserves (%u failed), %u frees:\n",
+           percent, m_total_blocks, reserves, fails, frees);
+    latency_print("reserve", p_reserve_ns, reserves);
+    latency_print("free", p_free_ns, frees);
+
+    while (m_alloc_count > 0)
+    {
+        nrf_free(mp_allocs[--m_alloc_count].p_mem);
+    }
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t ops = OPS_DEFAULT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "ops=", 4) == 0)
+        {
+            ops = strtoul(argv[i] + 4, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [ops=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    layout_init();
+
+    mp_block_used       = calloc(m_total_blocks, sizeof(bool));
+    mp_allocs           = calloc(m_total_blocks, sizeof(alloc_t));
+    uint32_t * p_res_ns = calloc(ops, sizeof(uint32_t));
+    uint32_t * p_fre_ns = calloc(ops, sizeof(uint32_t));
+    if ((mp_block_used == NULL) || (mp_allocs == NULL) || (p_res_ns == NULL) || (p_fre_ns == NULL))
+    {
+        return 2;
+    }
+
+#ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+    printf("With MEM_MANAGER_ENABLE_DIAGNOSTICS:\n");
+#endif
+    model_test(ops);
+#ifdef MEM_MANAGER_ENABLE_DIAGNOSTICS
+    stats_check();
+    stats_print();
+#endif
+
+    latency_run(10, ops, p_res_ns, p_fre_ns);
+    latency_run(50, ops, p_res_ns, p_fre_ns);
+    latency_run(90, ops, p_res_ns, p_fre_ns);
+
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+
+    free(p_res_ns);
+    free(p_fre_ns);
+    free(mp_allocs);
+    free(mp_block_used);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Configuration of the memory manager benchmark. The block counts can be overridden from the
+ * make command line, for example: make run MEMORY_MANAGER_MEDIUM_BLOCK_COUNT=0 */
+
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+#define MEM_MANAGER_ENABLED 1
+
+#ifndef MEMORY_MANAGER_XXSMALL_BLOCK_COUNT
+#define MEMORY_MANAGER_XXSMALL_BLOCK_COUNT 255
+#endif
+#define MEMORY_MANAGER_XXSMALL_BLOCK_SIZE 32
+
+#ifndef MEMORY_MANAGER_XSMALL_BLOCK_COUNT
+#define MEMORY_MANAGER_XSMALL_BLOCK_COUNT 255
+#endif
+#define MEMORY_MANAGER_XSMALL_BLOCK_SIZE 64
+
+#ifndef MEMORY_MANAGER_SMALL_BLOCK_COUNT
+#define MEMORY_MANAGER_SMALL_BLOCK_COUNT 255
+#endif
+#define MEMORY_MANAGER_SMALL_BLOCK_SIZE 128
+
+#ifndef MEMORY_MANAGER_MEDIUM_BLOCK_COUNT
+#define MEMORY_MANAGER_MEDIUM_BLOCK_COUNT 64
+#endif
+#define MEMORY_MANAGER_MEDIUM_BLOCK_SIZE 256
+
+#ifndef MEMORY_MANAGER_LARGE_BLOCK_COUNT
+#define MEMORY_MANAGER_LARGE_BLOCK_COUNT 32
+#endif
+#define MEMORY_MANAGER_LARGE_BLOCK_SIZE 512
+
+#ifndef MEMORY_MANAGER_XLARGE_BLOCK_COUNT
+#define MEMORY_MANAGER_XLARGE_BLOCK_COUNT 16
+#endif
+#define MEMORY_MANAGER_XLARGE_BLOCK_SIZE 1024
+
+#ifndef MEMORY_MANAGER_XXLARGE_BLOCK_COUNT
+#define MEMORY_MANAGER_XXLARGE_BLOCK_COUNT 8
+#endif
+#define MEMORY_MANAGER_XXLARGE_BLOCK_SIZE 2048
+
+#define MEM_MANAGER_DISABLE_API_PARAM_CHECK 0
+
+#define NRF_LOG_ENABLED 0
+
+#endif // SDK_CONFIG_H
@@ -0,0 +1,268 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include "sdk_common.h"
+#if NRF_MODULE_ENABLED(NRF_QUEUE)
+#include "nrf_spsc_queue.h"
+
+/**@brief Read the counter owned by the other side.
+ *
+ * The barrier keeps the accesses to the elements that the counter covers after the read.
+ */
+__STATIC_INLINE uint32_t counter_acquire(nrf_atomic_u32_t const * p_counter)
+{
+    uint32_t value = *p_counter;
+    __DMB();
+    return value;
+}
+
+/**@brief Publish the counter owned by this side.
+ *
+ * The barrier keeps the accesses to the elements that the counter covers before the write.
+ */
+__STATIC_INLINE void counter_release(nrf_atomic_u32_t * p_counter, uint32_t value)
+{
+    __DMB();
+    *p_counter = value;
+}
+
+/**@brief Get a pointer to the storage of an element.
+ *
+ * @param[in]   p_queue     Pointer to the queue instance.
+ * @param[in]   count       Free-running element counter.
+ *
+ * @return      Pointer to the element.
+ */
+__STATIC_INLINE void * element_ptr(nrf_spsc_queue_t const * p_queue, uint32_t count)
+{
+    return (void *)((size_t)p_queue->p_buffer
+                    + (count & (p_queue->size - 1)) * p_queue->element_size);
+}
+
+/**@brief Copy elements into the storage, with at most two copies around its end. */
+static void queue_copy_in(nrf_spsc_queue_t const * p_queue,
+                          uint32_t                 write_count,
+                          void const             * p_data,
+                          size_t                   element_count)
+{
+    size_t continuous = p_queue->size - (write_count & (p_queue->size - 1));
+    size_t first      = MIN(element_count, continuous) * p_queue->element_size;
+
+    memcpy(element_ptr(p_queue, write_count), p_data, first);
+    if (element_count > continuous)
+    {
+        memcpy(p_queue->p_buffer,
+               (void const *)((size_t)p_data + first),
+               (element_count - continuous) * p_queue->element_size);
+    }
+}
+
+/**@brief Copy elements out of the storage, with at most two copies around its end. */
+static void queue_copy_out(nrf_spsc_queue_t const * p_queue,
+                           uint32_t                 read_count,
+                           void                   * p_data,
+                           size_t                   element_count)
+{
+    size_t continuous = p_queue->size - (read_count & (p_queue->size - 1));
+    size_t first      = MIN(element_count, continuous) * p_queue->element_size;
+
+    memcpy(p_data, element_ptr(p_queue, read_count), first);
+    if (element_count > continuous)
+    {
+        memcpy((void *)((size_t)p_data + first),
+               p_queue->p_buffer,
+               (element_count - continuous) * p_queue->element_size);
+    }
+}
+
+/**@brief Copy one element, avoiding memcpy for the common element sizes. */
+__STATIC_INLINE void element_copy(void * p_dst, void const * p_src, size_t element_size)
+{
+    switch (element_size)
+    {
+        case sizeof(uint8_t):
+            *((uint8_t *)p_dst) = *((uint8_t const *)p_src);
+            break;
+
+        case sizeof(uint16_t):
+            *((uint16_t *)p_dst) = *((uint16_t const *)p_src);
+            break;
+
+        case sizeof(uint32_t):
+            *((uint32_t *)p_dst) = *((uint32_t const *)p_src);
+            break;
+
+        default:
+            memcpy(p_dst, p_src, element_size);
+            break;
+    }
+}
+
+/**@brief Record a new utilization maximum. Called by the producer. */
+__STATIC_INLINE void max_utilization_update(nrf_spsc_queue_t const * p_queue, uint32_t utilization)
+{
+    if (p_queue->p_cb->max_utilization < utilization)
+    {
+        p_queue->p_cb->max_utilization = utilization;
+    }
+}
+
+ret_code_t nrf_spsc_queue_push(nrf_spsc_queue_t const * p_queue, void const * p_element)
+{
+    ASSERT(p_queue != NULL);
+    ASSERT(p_element != NULL);
+
+    uint32_t write_count = p_queue->p_cb->write_count;
+    uint32_t read_count  = counter_acquire(&p_queue->p_cb->read_count);
+
+    if ((write_count - read_count) == p_queue->size)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    element_copy(element_ptr(p_queue, write_count), p_element, p_queue->element_size);
+    counter_release(&p_queue->p_cb->write_count, write_count + 1);
+
+    max_utilization_update(p_queue, write_count + 1 - read_count);
+
+    return NRF_SUCCESS;
+}
+
+size_t nrf_spsc_queue_in(nrf_spsc_queue_t const * p_queue,
+                         void const             * p_data,
+                         size_t                   element_count)
+{
+    ASSERT(p_queue != NULL);
+    ASSERT(p_data != NULL);
+
+    uint32_t write_count = p_queue->p_cb->write_count;
+    uint32_t read_count  = counter_acquire(&p_queue->p_cb->read_count);
+
+    element_count = MIN(element_count, p_queue->size - (write_count - read_count));
+    if (element_count == 0)
+    {
+        return 0;
+    }
+
+    queue_copy_in(p_queue, write_count, p_data, element_count);
+    counter_release(&p_queue->p_cb->write_count, write_count + element_count);
+
+    max_utilization_update(p_queue, write_count + element_count - read_count);
+
+    return element_count;
+}
+
+ret_code_t nrf_spsc_queue_pop(nrf_spsc_queue_t const * p_queue, void * p_element)
+{
+    ASSERT(p_queue != NULL);
+    ASSERT(p_element != NULL);
+
+    uint32_t read_count  = p_queue->p_cb->read_count;
+    uint32_t write_count = counter_acquire(&p_queue->p_cb->write_count);
+
+    if (write_count == read_count)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    element_copy(p_element, element_ptr(p_queue, read_count), p_queue->element_size);
+    counter_release(&p_queue->p_cb->read_count, read_count + 1);
+
+    return NRF_SUCCESS;
+}
+
+ret_code_t nrf_spsc_queue_peek(nrf_spsc_queue_t const * p_queue, void * p_element)
+{
+    ASSERT(p_queue != NULL);
+    ASSERT(p_element != NULL);
+
+    uint32_t read_count  = p_queue->p_cb->read_count;
+    uint32_t write_count = counter_acquire(&p_queue->p_cb->write_count);
+
+    if (write_count == read_count)
+    {
+        return NRF_ERROR_NOT_FOUND;
+    }
+
+    element_copy(p_element, element_ptr(p_queue, read_count), p_queue->element_size);
+
+    return NRF_SUCCESS;
+}
+
+size_t nrf_spsc_queue_out(nrf_spsc_queue_t const * p_queue,
+                          void                   * p_data,
+                          size_t                   element_count)
+{
+    ASSERT(p_queue != NULL);
+    ASSERT(p_data != NULL);
+
+    uint32_t read_count  = p_queue->p_cb->read_count;
+    uint32_t write_count = counter_acquire(&p_queue->p_cb->write_count);
+
+    element_count = MIN(element_count, write_count - read_count);
+    if (element_count == 0)
+    {
+        return 0;
+    }
+
+    queue_copy_out(p_queue, read_count, p_data, element_count);
+    counter_release(&p_queue->p_cb->read_count, read_count + element_count);
+
+    return element_count;
+}
+
+size_t nrf_spsc_queue_span_get(nrf_spsc_queue_t const * p_queue, void const ** pp_data)
+{
+    ASSERT(p_queue != NULL);
+    ASSERT(pp_data != NULL);
+
+    uint32_t read_count  = p_queue->p_cb->read_count;
+    uint32_t write_count = counter_acquire(&p_queue->p_cb->write_count);
+    size_t   continuous  = p_queue->size - (read_count & (p_queue->size - 1));
+
+    *pp_data = element_ptr(p_queue, read_count);
+
+    return MIN(write_count - read_count, continuous);
+}
+
+void nrf_spsc_queue_consume(nrf_spsc_queue_t const * p_queue, size_t element_count)
+{
+    ASSERT(p_queue != NULL);
+
+    uint32_t read_count = p_queue->p_cb->read_count;
+
+    ASSERT(element_count <= p_queue->p_cb->write_count - read_count);
+
+    counter_release(&p_queue->p_cb->read_count, read_count + element_count);
+}
+
+size_t nrf_spsc_queue_utilization_get(nrf_spsc_queue_t const * p_queue)
+{
+    ASSERT(p_queue != NULL);
+
+    // Read the consumer counter first so that the difference can't underflow. If both sides ran
+    // in between, it can exceed the queue size, so clamp it.
+    uint32_t read_count  = counter_acquire(&p_queue->p_cb->read_count);
+    uint32_t write_count = counter_acquire(&p_queue->p_cb->write_count);
+
+    return MIN(write_count - read_count, p_queue->size);
+}
+
+void nrf_spsc_queue_reset(nrf_spsc_queue_t const * p_queue)
+{
+    ASSERT(p_queue != NULL);
+
+    memset(p_queue->p_cb, 0, sizeof(nrf_spsc_queue_cb_t));
+    __DMB();
+}
+
+#endif // NRF_MODULE_ENABLED(NRF_QUEUE)
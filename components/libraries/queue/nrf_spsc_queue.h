@@ -0,0 +1,231 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+
+/**
+* @defgroup nrf_spsc_queue Single-producer, single-consumer queue
+* @{
+* @ingroup nrf_queue
+* @brief Lock-free queue for one producer context and one consumer context.
+*
+* @details Unlike @ref nrf_queue, this queue never disables interrupts. It is safe as long as
+*          only one context (for example an interrupt handler) calls the producer functions
+*          (@ref nrf_spsc_queue_push, @ref nrf_spsc_queue_in) and only one context (for example
+*          the main loop) calls the consumer functions (@ref nrf_spsc_queue_pop,
+*          @ref nrf_spsc_queue_peek, @ref nrf_spsc_queue_out, @ref nrf_spsc_queue_span_get,
+*          @ref nrf_spsc_queue_consume).
+*
+*          The producer owns the write counter and the consumer the read counter. Each side
+*          publishes its counter with a memory barrier after it has copied the elements, and reads
+*          the counter of the other side before it touches them. Elements are therefore never seen
+*          half-written, and slots are never reused before they have been read.
+*
+*          The queue does not overwrite old elements when it is full, because that would make the
+*          producer move the read counter.
+*/
+
+#ifndef NRF_SPSC_QUEUE_H__
+#define NRF_SPSC_QUEUE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "nrf_assert.h"
+#include "nrf_atomic.h"
+#include "sdk_errors.h"
+#include "app_util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**@brief Queue control block. */
+typedef struct
+{
+    nrf_atomic_u32_t write_count;       //!< Number of elements written. Owned by the producer.
+    nrf_atomic_u32_t read_count;        //!< Number of elements read. Owned by the consumer.
+    uint32_t         max_utilization;   //!< Maximum utilization of the queue. Updated by the producer.
+} nrf_spsc_queue_cb_t;
+
+/**@brief Instance of the queue. */
+typedef struct
+{
+    nrf_spsc_queue_cb_t * p_cb;         //!< Pointer to the instance control block.
+    void                * p_buffer;     //!< Pointer to the memory that is used as storage.
+    uint32_t              size;         //!< Size of the queue. A power of two.
+    size_t                element_size; //!< Size of one element.
+} nrf_spsc_queue_t;
+
+/**@brief Create a queue instance.
+ *
+ * @note  This macro reserves memory for the given queue instance.
+ *
+ * @param[in]   _type       Type which is stored.
+ * @param[in]   _name       Name of the queue.
+ * @param[in]   _size       Size of the queue. Must be a power of two.
+ */
+#define NRF_SPSC_QUEUE_DEF(_type, _name, _size)                                 \
+    STATIC_ASSERT(IS_POWER_OF_TWO(_size));                                      \
+    static _type                  _name##_nrf_spsc_queue_buffer[(_size)];       \
+    static nrf_spsc_queue_cb_t    _name##_nrf_spsc_queue_cb;                    \
+    static const nrf_spsc_queue_t _name =                                       \
+        {                                                                       \
+            .p_cb           = &_name##_nrf_spsc_queue_cb,                       \
+            .p_buffer       = _name##_nrf_spsc_queue_buffer,                    \
+            .size           = (_size),                                          \
+            .element_size   = sizeof(_type),                                    \
+        }
+
+/**@brief Function for pushing an element to the end of the queue. Producer only.
+ *
+ * @param[in]   p_queue             Pointer to the queue instance.
+ * @param[in]   p_element           Pointer to the element that will be stored in the queue.
+ *
+ * @return      NRF_SUCCESS         If an element has been successfully added.
+ * @return      NRF_ERROR_NO_MEM    If the queue is full.
+ */
+ret_code_t nrf_spsc_queue_push(nrf_spsc_queue_t const * p_queue, void const * p_element);
+
+/**@brief Function for writing as many elements as fit to the queue. Producer only.
+ *
+ * @param[in]   p_queue             Pointer to the queue instance.
+ * @param[in]   p_data              Pointer to the buffer with elements to write.
+ * @param[in]   element_count       Number of elements to write.
+ *
+ * @return      The number of added elements.
+ */
+size_t nrf_spsc_queue_in(nrf_spsc_queue_t const * p_queue,
+                         void const             * p_data,
+                         size_t                   element_count);
+
+/**@brief Function for popping an element from the front of the queue. Consumer only.
+ *
+ * @param[in]   p_queue             Pointer to the queue instance.
+ * @param[out]  p_element           Pointer where the element will be copied.
+ *
+ * @return      NRF_SUCCESS         If an element was returned.
+ * @return      NRF_ERROR_NOT_FOUND If the queue is empty.
+ */
+ret_code_t nrf_spsc_queue_pop(nrf_spsc_queue_t const * p_queue, void * p_element);
+
+/**@brief Function for copying the element at the front of the queue without removing it.
+ *        Consumer only.
+ *
+ * @param[in]   p_queue             Pointer to the queue instance.
+ * @param[out]  p_element           Pointer where the element will be copied.
+ *
+ * @return      NRF_SUCCESS         If an element was returned.
+ * @return      NRF_ERROR_NOT_FOUND If the queue is empty.
+ */
+ret_code_t nrf_spsc_queue_peek(nrf_spsc_queue_t const * p_queue, void * p_element);
+
+/**@brief Function for reading as many elements as are available, up to a limit. Consumer only.
+ *
+ * @param[in]   p_queue             Pointer to the queue instance.
+ * @param[out]  p_data              Pointer to the buffer where elements will be copied.
+ * @param[in]   element_count       Maximum number of elements to read.
+ *
+ * @return      The number of read elements.
+ */
+size_t nrf_spsc_queue_out(nrf_spsc_queue_t const * p_queue,
+                          void                   * p_data,
+                          size_t                   element_count);
+
+/**@brief Function for getting the elements at the front of the queue in place. Consumer only.
+ *
+ * The elements stay in the queue until @ref nrf_spsc_queue_consume is called. Only the elements
+ * up to the end of the storage are returned. If the queue wraps around, the rest can be fetched
+ * after the first part has been consumed.
+ *
+ * @param[in]   p_queue             Pointer to the queue instance.
+ * @param[out]  pp_data             Pointer to the first element.
+ *
+ * @return      The number of contiguous elements at *pp_data. 0 if the queue is empty.
+ */
+size_t nrf_spsc_queue_span_get(nrf_spsc_queue_t const * p_queue, void const ** pp_data);
+
+/**@brief Function for removing elements returned by @ref nrf_spsc_queue_span_get. Consumer only.
+ *
+ * @param[in]   p_queue             Pointer to the queue instance.
+ * @param[in]   element_count       Number of elements to remove. Must not exceed the number of
+ *                                  elements returned by @ref nrf_spsc_queue_span_get.
+ */
+void nrf_spsc_queue_consume(nrf_spsc_queue_t const * p_queue, size_t element_count);
+
+/**@brief Function for getting the current queue utilization. Can be called from either side.
+ *
+ * @param[in]   p_queue     Pointer to the queue instance.
+ *
+ * @return      Current queue utilization. The other side may change it at any time.
+ */
+size_t nrf_spsc_queue_utilization_get(nrf_spsc_queue_t const * p_queue);
+
+/**@brief Function for checking if the queue is empty.
+ *
+ * @param[in]   p_queue     Pointer to the queue instance.
+ *
+ * @return      True if the queue is empty.
+ */
+__STATIC_INLINE bool nrf_spsc_queue_is_empty(nrf_spsc_queue_t const * p_queue);
+
+/**@brief Function for checking if the queue is full.
+ *
+ * @param[in]   p_queue     Pointer to the queue instance.
+ *
+ * @return      True if the queue is full.
+ */
+__STATIC_INLINE bool nrf_spsc_queue_is_full(nrf_spsc_queue_t const * p_queue);
+
+/**@brief Function for getting the maximal queue utilization.
+ *
+ * @param[in]   p_queue     Pointer to the queue instance.
+ *
+ * @return      Maximal queue utilization.
+ */
+__STATIC_INLINE size_t nrf_spsc_queue_max_utilization_get(nrf_spsc_queue_t const * p_queue);
+
+/**@brief Function for resetting the queue state.
+ *
+ * @note  Neither the producer nor the consumer may use the queue during the reset.
+ *
+ * @param[in]   p_queue     Pointer to the queue instance.
+ */
+void nrf_spsc_queue_reset(nrf_spsc_queue_t const * p_queue);
+
+#ifndef SUPPRESS_INLINE_IMPLEMENTATION
+
+__STATIC_INLINE bool nrf_spsc_queue_is_empty(nrf_spsc_queue_t const * p_queue)
+{
+    ASSERT(p_queue != NULL);
+    return (nrf_spsc_queue_utilization_get(p_queue) == 0);
+}
+
+__STATIC_INLINE bool nrf_spsc_queue_is_full(nrf_spsc_queue_t const * p_queue)
+{
+    ASSERT(p_queue != NULL);
+    return (nrf_spsc_queue_utilization_get(p_queue) == p_queue->size);
+}
+
+__STATIC_INLINE size_t nrf_spsc_queue_max_utilization_get(nrf_spsc_queue_t const * p_queue)
+{
+    ASSERT(p_queue != NULL);
+    return p_queue->p_cb->max_utilization;
+}
+
+#endif // SUPPRESS_INLINE_IMPLEMENTATION
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // NRF_SPSC_QUEUE_H__
+/** @} */
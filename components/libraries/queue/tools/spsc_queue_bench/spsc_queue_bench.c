@@ -0,0 +1,283 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* nrf_spsc_queue stress test and benchmark for a PC host.
+ *
+ * A producer thread and a consumer thread pass numbered elements through one queue, as an
+ * interrupt handler and the main loop would on the chip. Each element is 16 bytes, derived from
+ * its number, so that an element which is read before it has been completely written, read
+ * twice or skipped is detected. The run is repeated with each pair of producer and consumer
+ * functions:
+ * - push/pop:  nrf_spsc_queue_push() and nrf_spsc_queue_pop(), with nrf_spsc_queue_peek()
+ *              checked before some of the pops,
+ * - in/out:    nrf_spsc_queue_in() and nrf_spsc_queue_out() with random counts,
+ * - in/span:   nrf_spsc_queue_in() and nrf_spsc_queue_span_get()/nrf_spsc_queue_consume().
+ *
+ * Each side spins while the queue is full or empty. The throughput is in elements per second.
+ *
+ * Command line: items=<elements per run>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include "nrf_error.h"
+#include "nrf_spsc_queue.h"
+
+
+#define ITEMS_DEFAULT   (2000000)
+#define QUEUE_SIZE      (256)
+#define BULK_MAX        (32)        // Most elements moved in one call of the bulk functions.
+
+typedef struct
+{
+    uint32_t seq;
+    uint32_t hash;
+    uint32_t inverse;
+    uint32_t mixed;
+} element_t;
+
+typedef enum
+{
+    MODE_PUSH_POP,
+    MODE_IN_OUT,
+    MODE_IN_SPAN,
+    MODE_COUNT
+} bench_mode_t;
+
+
+NRF_SPSC_QUEUE_DEF(element_t, m_queue, QUEUE_SIZE);
+
+static char const * const m_mode_names[MODE_COUNT] = {"push/pop", "in/out", "in/span"};
+
+static bench_mode_t m_mode;
+static uint32_t     m_items = ITEMS_DEFAULT;
+static uint32_t     m_errors;       // Written by the consumer thread only while the threads run.
+static uint32_t     m_peeks;
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static void element_make(element_t * p_element, uint32_t seq)
+{
+    p_element->seq     = seq;
+    p_element->hash    = seq * 2654435761U;
+    p_element->inverse = ~seq;
+    p_element->mixed   = (seq << 16) ^ (seq >> 3) ^ 0x5A5AA5A5;
+}
+
+
+static void element_check(element_t const * p_element, uint32_t seq)
+{
+    element_t expected;
+
+    element_make(&expected, seq);
+    if (memcmp(p_element, &expected, sizeof(expected)) != 0)
+    {
+        if (m_errors < 10)
+        {
+            printf("FAILED: %s: element %u read as %u (%08X %08X %08X)\n", m_mode_names[m_mode],
+                   seq, p_element->seq, p_element->hash, p_element->inverse, p_element->mixed);
+        }
+        m_errors++;
+    }
+}
+
+
+// Each thread has its own generator, so that the runs do not depend on the interleaving.
+static uint32_t thread_rand(uint32_t * p_state)
+{
+    *p_state = (*p_state * 1103515245UL) + 12345UL;
+    return (*p_state >> 16);
+}
+
+
+static void * producer_thread(void * p_context)
+{
+    element_t elements[BULK_MAX];
+    uint32_t  state = 1;
+    uint32_t  seq   = 0;
+
+    (void)p_context;
+
+    while (seq < m_items)
+    {
+        if (m_mode == MODE_PUSH_POP)
+        {
+            element_make(&elements[0], seq);
+            if (nrf_spsc_queue_push(&m_queue, &elements[0]) == NRF_SUCCESS)
+            {
+                seq++;
+                continue;
+            }
+        }
+        else
+        {
+            uint32_t count = 1 + (thread_rand(&state) % BULK_MAX);
+
+            if (count > m_items - seq)
+            {
+                count = m_items - seq;
+            }
+            for (uint32_t i = 0; i < count; i++)
+            {
+                element_make(&elements[i], seq + i);
+            }
+            count = nrf_spsc_queue_in(&m_queue, elements, count);
+            seq  += count;
+            if (count > 0)
+            {
+                continue;
+            }
+        }
+        sched_yield();
+    }
+    return NULL;
+}
+
+
+static void * consumer_thread(void * p_context)
+{
+    element_t elements[BULK_MAX];
+    uint32_t  state = 2;
+    uint32_t  seq   = 0;
+
+    (void)p_context;
+
+    while (seq < m_items)
+    {
+        uint32_t count = 0;
+
+        switch (m_mode)
+        {
+            case MODE_PUSH_POP:
+                // The producer only adds elements, so a peeked element must be the next one popped.
+                if (((seq % 7) == 0) && (nrf_spsc_queue_peek(&m_queue, &elements[1]) == NRF_SUCCESS))
+                {
+                    element_check(&elements[1], seq);
+                    m_peeks++;
+                }
+                if (nrf_spsc_queue_pop(&m_queue, &elements[0]) == NRF_SUCCESS)
+                {
+                    element_check(&elements[0], seq);
+                    count = 1;
+                }
+                break;
+
+            case MODE_IN_OUT:
+                count = nrf_spsc_queue_out(&m_queue, elements, 1 + (thread_rand(&state) % BULK_MAX));
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    element_check(&elements[i], seq + i);
+                }
+                break;
+
+            default:
+            {
+                element_t const * p_span;
+
+                count = nrf_spsc_queue_span_get(&m_queue, (void const **)&p_span);
+                if (count > 0)
+                {
+                    count = 1 + (thread_rand(&state) % count);
+                    for (uint32_t i = 0; i < count; i++)
+                    {
+                        element_check(&p_span[i], seq + i);
+                    }
+                    nrf_spsc_queue_consume(&m_queue, count);
+                }
+                break;
+            }
+        }
+
+        seq += count;
+        if (count == 0)
+        {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+
+int main(int argc, char * argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "items=", 6) == 0)
+        {
+            m_items = strtoul(argv[i] + 6, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [items=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (m_items == 0)
+    {
+        fprintf(stderr, "items must be more than 0\n");
+        return 2;
+    }
+
+    printf("%u elements of %u bytes per run, queue of %u elements\n",
+           m_items, (unsigned)sizeof(element_t), QUEUE_SIZE);
+
+    for (m_mode = MODE_PUSH_POP; m_mode < MODE_COUNT; m_mode++)
+    {
+        pthread_t      producer;
+        pthread_t      consumer;
+        uint32_t const errors = m_errors;
+
+        nrf_spsc_queue_reset(&m_queue);
+
+        uint64_t const start = host_time_ns();
+        if ((pthread_create(&consumer, NULL, consumer_thread, NULL) != 0) ||
+            (pthread_create(&producer, NULL, producer_thread, NULL) != 0))
+        {
+            fprintf(stderr, "pthread_create failed\n");
+            return 2;
+        }
+        (void)pthread_join(producer, NULL);
+        (void)pthread_join(consumer, NULL);
+        uint64_t const elapsed = host_time_ns() - start;
+
+        if (!nrf_spsc_queue_is_empty(&m_queue))
+        {
+            printf("FAILED: %s: queue not empty at the end\n", m_mode_names[m_mode]);
+            m_errors++;
+        }
+        if (nrf_spsc_queue_max_utilization_get(&m_queue) > QUEUE_SIZE)
+        {
+            printf("FAILED: %s: max utilization %u\n", m_mode_names[m_mode],
+                   (unsigned)nrf_spsc_queue_max_utilization_get(&m_queue));
+            m_errors++;
+        }
+
+        printf("  %-9s %6.1f Mops/s, max utilization %3u, %u errors\n", m_mode_names[m_mode],
+               m_items / (elapsed * 1e-3), (unsigned)nrf_spsc_queue_max_utilization_get(&m_queue),
+               m_errors - errors);
+    }
+    printf("  %u elements peeked, %u errors\n", m_peeks, m_errors);
+
+    return (m_errors == 0) ? 0 : 1;
+}
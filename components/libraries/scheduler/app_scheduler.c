@@ -15,7 +15,6 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <string.h>
-#include "nrf_soc.h"
 #include "nrf_assert.h"
 #include "app_util_platform.h"
 
@@ -24,19 +23,33 @@ typedef struct
 {
     app_sched_event_handler_t handler;          /**< Pointer to event handler to receive the event. */
     uint16_t                  event_data_size;  /**< Size of event data. */
+    volatile bool             committed;        /**< The producer has finished writing the event. */
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+    uint32_t                  commit_time;      /**< Timestamp of the commit. */
+#endif
 } event_header_t;
 
 STATIC_ASSERT(sizeof(event_header_t) <= APP_SCHED_EVENT_HEADER_SIZE);
 
-static event_header_t * m_queue_event_headers;  /**< Array for holding the queue event headers. */
-static uint8_t        * m_queue_event_data;     /**< Array for holding the queue event data. */
-static volatile uint8_t m_queue_start_index;    /**< Index of queue entry at the start of the queue. */
-static volatile uint8_t m_queue_end_index;      /**< Index of queue entry at the end of the queue. */
-static uint16_t         m_queue_event_size;     /**< Maximum event size in queue. */
-static uint16_t         m_queue_size;           /**< Number of queue entries. */
-
+/**@brief Structure for holding the queue of one priority. */
+typedef struct
+{
+    event_header_t * p_headers;         /**< Array for holding the queue event headers. */
+    uint8_t        * p_data;            /**< Array for holding the queue event data. */
+    volatile uint8_t start_index;       /**< Index of queue entry at the start of the queue. */
+    volatile uint8_t end_index;         /**< Index of queue entry at the end of the queue. */
+    uint16_t         event_size;        /**< Maximum event size in queue. */
+    uint16_t         queue_size;        /**< Number of queue entries. */
 #if APP_SCHEDULER_WITH_PROFILER
-static uint16_t m_max_queue_utilization;    /**< Maximum observed queue utilization. */
+    uint16_t         max_utilization;   /**< Maximum observed queue utilization. */
+#endif
+} event_queue_t;
+
+static event_queue_t m_queues[APP_SCHEDULER_PRIORITY_COUNT];    /**< Queues, highest priority first. */
+
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+static app_sched_handler_stats_t  m_handler_stats[APP_SCHEDULER_HANDLER_STATS_COUNT];   /**< Statistics of the executed handlers. */
+static app_sched_timestamp_func_t m_timestamp_func;                                     /**< Time source of the statistics. */
 #endif
 
 #if APP_SCHEDULER_WITH_PAUSE
@@ -46,150 +59,325 @@ static uint32_t m_scheduler_paused_counter = 0; /**< Counter storing the differe
 
 /**@brief Function for incrementing a queue index, and handle wrap-around.
  *
+ * @param[in]   p_queue Queue.
  * @param[in]   index   Old index.
  *
  * @return      New (incremented) index.
  */
-static __INLINE uint8_t next_index(uint8_t index)
+static __INLINE uint8_t next_index(event_queue_t const * p_queue, uint8_t index)
 {
-    return (index < m_queue_size) ? (index + 1) : 0;
+    return (index < p_queue->queue_size) ? (index + 1) : 0;
 }
 
 
-static __INLINE uint8_t app_sched_queue_full()
+static __INLINE bool queue_full(event_queue_t const * p_queue)
 {
-  uint8_t tmp = m_queue_start_index;
-  return next_index(m_queue_end_index) == tmp;
+    uint8_t tmp = p_queue->start_index;
+    return next_index(p_queue, p_queue->end_index) == tmp;
 }
 
-/**@brief Macro for checking if a queue is full. */
-#define APP_SCHED_QUEUE_FULL() app_sched_queue_full()
-
 
-static __INLINE uint8_t app_sched_queue_empty()
+static __INLINE bool queue_empty(event_queue_t const * p_queue)
 {
-  uint8_t tmp = m_queue_start_index;
-  return m_queue_end_index == tmp;
+    uint8_t tmp = p_queue->start_index;
+    return p_queue->end_index == tmp;
 }
 
-/**@brief Macro for checking if a queue is empty. */
-#define APP_SCHED_QUEUE_EMPTY() app_sched_queue_empty()
 
+static __INLINE uint16_t queue_utilization(event_queue_t const * p_queue)
+{
+    uint16_t start = p_queue->start_index;
+    uint16_t end   = p_queue->end_index;
+    return (end >= start) ? (end - start) : (p_queue->queue_size + 1 - start + end);
+}
 
-uint32_t app_sched_init(uint16_t event_size, uint16_t queue_size, void * p_event_buffer)
+
+uint32_t app_sched_prio_init(uint8_t  priority,
+                             uint16_t event_size,
+                             uint16_t queue_size,
+                             void *   p_event_buffer)
 {
     uint16_t data_start_index = (queue_size + 1) * sizeof(event_header_t);
 
-    // Check that buffer is correctly aligned
-    if (!is_word_aligned(p_event_buffer))
+    // Check that the priority exists and that buffer is correctly aligned
+    if ((priority >= APP_SCHEDULER_PRIORITY_COUNT) || !is_word_aligned(p_event_buffer))
     {
         return NRF_ERROR_INVALID_PARAM;
     }
 
-    // Initialize event scheduler
-    m_queue_event_headers = p_event_buffer;
-    m_queue_event_data    = &((uint8_t *)p_event_buffer)[data_start_index];
-    m_queue_end_index     = 0;
-    m_queue_start_index   = 0;
-    m_queue_event_size    = event_size;
-    m_queue_size          = queue_size;
+    // Initialize event queue
+    event_queue_t * p_queue = &m_queues[priority];
+
+    p_queue->p_headers   = p_event_buffer;
+    p_queue->p_data      = &((uint8_t *)p_event_buffer)[data_start_index];
+    p_queue->end_index   = 0;
+    p_queue->start_index = 0;
+    p_queue->event_size  = event_size;
+    p_queue->queue_size  = queue_size;
+
+    for (uint16_t i = 0; i <= queue_size; i++)
+    {
+        p_queue->p_headers[i].committed = false;
+    }
 
 #if APP_SCHEDULER_WITH_PROFILER
-    m_max_queue_utilization = 0;
+    p_queue->max_utilization = 0;
 #endif
 
     return NRF_SUCCESS;
 }
 
 
+uint32_t app_sched_init(uint16_t event_size, uint16_t queue_size, void * p_event_buffer)
+{
+    return app_sched_prio_init(APP_SCHED_PRIORITY_LOWEST, event_size, queue_size, p_event_buffer);
+}
+
+
+uint16_t app_sched_prio_queue_space_get(uint8_t priority)
+{
+    ASSERT(priority < APP_SCHEDULER_PRIORITY_COUNT);
+    return m_queues[priority].queue_size - queue_utilization(&m_queues[priority]);
+}
+
+
 uint16_t app_sched_queue_space_get()
 {
-    uint16_t start = m_queue_start_index;
-    uint16_t end   = m_queue_end_index;
-    uint16_t free_space = m_queue_size - ((end >= start) ?
-                           (end - start) : (m_queue_size + 1 - start + end));
-    return free_space;
+    return app_sched_prio_queue_space_get(APP_SCHED_PRIORITY_LOWEST);
 }
 
 
 #if APP_SCHEDULER_WITH_PROFILER
-static void queue_utilization_check(void)
+static void queue_utilization_check(event_queue_t * p_queue)
 {
-    uint16_t start = m_queue_start_index;
-    uint16_t end   = m_queue_end_index;
-    uint16_t queue_utilization = (end >= start) ? (end - start) :
-        (m_queue_size + 1 - start + end);
+    uint16_t utilization = queue_utilization(p_queue);
 
-    if (queue_utilization > m_max_queue_utilization)
+    if (utilization > p_queue->max_utilization)
     {
-        m_max_queue_utilization = queue_utilization;
+        p_queue->max_utilization = utilization;
     }
 }
 
+uint16_t app_sched_prio_queue_utilization_get(uint8_t priority)
+{
+    ASSERT(priority < APP_SCHEDULER_PRIORITY_COUNT);
+    return m_queues[priority].max_utilization;
+}
+
 uint16_t app_sched_queue_utilization_get(void)
 {
-    return m_max_queue_utilization;
+    return app_sched_prio_queue_utilization_get(APP_SCHED_PRIORITY_LOWEST);
 }
 #endif // APP_SCHEDULER_WITH_PROFILER
 
 
+uint32_t app_sched_event_alloc(uint8_t                   priority,
+                               uint16_t                  event_data_size,
+                               app_sched_event_handler_t handler,
+                               app_sched_event_slot_t *  p_slot)
+{
+    ASSERT(p_slot != NULL);
+
+    if (priority >= APP_SCHEDULER_PRIORITY_COUNT)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    event_queue_t * p_queue = &m_queues[priority];
+
+    if (p_queue->p_headers == NULL)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    if (event_data_size > p_queue->event_size)
+    {
+        return NRF_ERROR_INVALID_LENGTH;
+    }
+
+    uint16_t event_index = 0xFFFF;
+
+    CRITICAL_REGION_ENTER();
+
+    if (!queue_full(p_queue))
+    {
+        event_index        = p_queue->end_index;
+        p_queue->end_index = next_index(p_queue, p_queue->end_index);
+
+    #if APP_SCHEDULER_WITH_PROFILER
+        // This function call must be protected with critical region because
+        // it modifies 'max_utilization'.
+        queue_utilization_check(p_queue);
+    #endif
+    }
+
+    CRITICAL_REGION_EXIT();
+
+    if (event_index == 0xFFFF)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    // NOTE: This can be done outside the critical region since the event consumer will
+    //       not execute the event before it is committed.
+    p_queue->p_headers[event_index].handler         = handler;
+    p_queue->p_headers[event_index].event_data_size = event_data_size;
+
+    p_slot->p_event_data = &p_queue->p_data[event_index * p_queue->event_size];
+    p_slot->priority     = priority;
+    p_slot->index        = (uint8_t)event_index;
+
+    return NRF_SUCCESS;
+}
+
+
+void app_sched_event_commit(app_sched_event_slot_t const * p_slot)
+{
+    ASSERT(p_slot != NULL);
+    ASSERT(p_slot->priority < APP_SCHEDULER_PRIORITY_COUNT);
+
+    event_header_t * p_header = &m_queues[p_slot->priority].p_headers[p_slot->index];
+
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+    if (m_timestamp_func != NULL)
+    {
+        p_header->commit_time = m_timestamp_func();
+    }
+#endif
+
+    // Keep the writes of the event data and header before the write that hands them over.
+    __DMB();
+    p_header->committed = true;
+}
+
+
+uint32_t app_sched_prio_event_put(uint8_t                   priority,
+                                  void const *              p_event_data,
+                                  uint16_t                  event_data_size,
+                                  app_sched_event_handler_t handler)
+{
+    app_sched_event_slot_t slot;
+
+    if ((p_event_data == NULL) || (event_data_size == 0))
+    {
+        event_data_size = 0;
+    }
+
+    uint32_t err_code = app_sched_event_alloc(priority, event_data_size, handler, &slot);
+
+    if (err_code == NRF_SUCCESS)
+    {
+        if (event_data_size > 0)
+        {
+            memcpy(slot.p_event_data, p_event_data, event_data_size);
+        }
+        app_sched_event_commit(&slot);
+    }
+
+    return err_code;
+}
+
+
 uint32_t app_sched_event_put(void                    * p_event_data,
                              uint16_t                  event_data_size,
                              app_sched_event_handler_t handler)
 {
-    uint32_t err_code;
+    return app_sched_prio_event_put(APP_SCHED_PRIORITY_LOWEST,
+                                    p_event_data,
+                                    event_data_size,
+                                    handler);
+}
 
-    if (event_data_size <= m_queue_event_size)
-    {
-        uint16_t event_index = 0xFFFF;
 
-        CRITICAL_REGION_ENTER();
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+void app_sched_handler_stats_timestamp_set(app_sched_timestamp_func_t timestamp_func)
+{
+    m_timestamp_func = timestamp_func;
+}
 
-        if (!APP_SCHED_QUEUE_FULL())
+
+/**@brief Function for finding the statistics of a handler, claiming a free entry if needed.
+ *
+ * @param[in]   handler   Event handler.
+ * @param[in]   claim     Claim a free entry if the handler has none.
+ *
+ * @return      Statistics of the handler, or NULL if there are none and no free entry.
+ */
+static app_sched_handler_stats_t * handler_stats_find(app_sched_event_handler_t handler,
+                                                      bool                      claim)
+{
+    for (uint32_t i = 0; i < APP_SCHEDULER_HANDLER_STATS_COUNT; i++)
+    {
+        if (m_handler_stats[i].handler == handler)
         {
-            event_index       = m_queue_end_index;
-            m_queue_end_index = next_index(m_queue_end_index);
-
-        #if APP_SCHEDULER_WITH_PROFILER
-            // This function call must be protected with critical region because
-            // it modifies 'm_max_queue_utilization'.
-            queue_utilization_check();
-        #endif
+            return &m_handler_stats[i];
         }
 
-        CRITICAL_REGION_EXIT();
-
-        if (event_index != 0xFFFF)
+        if (m_handler_stats[i].handler == NULL)
         {
-            // NOTE: This can be done outside the critical region since the event consumer will
-            //       always be called from the main loop, and will thus never interrupt this code.
-            m_queue_event_headers[event_index].handler = handler;
-            if ((p_event_data != NULL) && (event_data_size > 0))
-            {
-                memcpy(&m_queue_event_data[event_index * m_queue_event_size],
-                       p_event_data,
-                       event_data_size);
-                m_queue_event_headers[event_index].event_data_size = event_data_size;
-            }
-            else
+            if (!claim)
             {
-                m_queue_event_headers[event_index].event_data_size = 0;
+                break;
             }
-
-            err_code = NRF_SUCCESS;
-        }
-        else
-        {
-            err_code = NRF_ERROR_NO_MEM;
+            m_handler_stats[i].handler = handler;
+            return &m_handler_stats[i];
         }
     }
-    else
+
+    return NULL;
+}
+
+
+uint32_t app_sched_handler_stats_get(app_sched_event_handler_t   handler,
+                                     app_sched_handler_stats_t * p_stats)
+{
+    ASSERT(p_stats != NULL);
+
+    app_sched_handler_stats_t const * p_entry = handler_stats_find(handler, false);
+
+    if ((handler == NULL) || (p_entry == NULL))
     {
-        err_code = NRF_ERROR_INVALID_LENGTH;
+        return NRF_ERROR_NOT_FOUND;
     }
 
-    return err_code;
+    *p_stats = *p_entry;
+    return NRF_SUCCESS;
+}
+
+
+void app_sched_handler_stats_reset(void)
+{
+    memset(m_handler_stats, 0, sizeof(m_handler_stats));
+}
+
+
+/**@brief Function for adding one execution to the statistics of a handler.
+ *
+ * @param[in]   p_header     Header of the executed event.
+ * @param[in]   start_time   Timestamp taken before the handler was called.
+ * @param[in]   end_time     Timestamp taken after the handler returned.
+ */
+static void handler_stats_update(event_header_t const * p_header,
+                                 uint32_t               start_time,
+                                 uint32_t               end_time)
+{
+    app_sched_handler_stats_t * p_entry = handler_stats_find(p_header->handler, true);
+
+    if (p_entry == NULL)
+    {
+        return;
+    }
+
+    uint32_t exec_time = end_time - start_time;
+    uint32_t wait_time = start_time - p_header->commit_time;
+
+    p_entry->event_count++;
+    p_entry->exec_time_total += exec_time;
+    p_entry->exec_time_max    = MAX(p_entry->exec_time_max, exec_time);
+    p_entry->wait_time_total += wait_time;
+    p_entry->wait_time_max    = MAX(p_entry->wait_time_max, wait_time);
 }
+#endif // APP_SCHEDULER_WITH_HANDLER_STATS
 
 
 #if APP_SCHEDULER_WITH_PAUSE
@@ -232,29 +420,71 @@ static __INLINE bool is_app_sched_paused(void)
 }
 
 
+/**@brief Function for finding the queue of the next event to execute.
+ *
+ * @return    The highest priority queue with a committed event at its start, or NULL if there is
+ *            none.
+ */
+static event_queue_t * next_queue_get(void)
+{
+    for (uint32_t priority = 0; priority < APP_SCHEDULER_PRIORITY_COUNT; priority++)
+    {
+        event_queue_t * p_queue = &m_queues[priority];
+
+        if ((p_queue->p_headers != NULL) &&
+            !queue_empty(p_queue) &&
+            p_queue->p_headers[p_queue->start_index].committed)
+        {
+            return p_queue;
+        }
+    }
+
+    return NULL;
+}
+
+
 void app_sched_execute(void)
 {
-    while (!is_app_sched_paused() && !APP_SCHED_QUEUE_EMPTY())
+    event_queue_t * p_queue;
+
+    while (!is_app_sched_paused() && ((p_queue = next_queue_get()) != NULL))
     {
         // Since this function is only called from the main loop, there is no
         // need for a critical region here, however a special care must be taken
         // regarding update of the queue start index (see the end of the loop).
-        uint16_t event_index = m_queue_start_index;
+        uint16_t         event_index = p_queue->start_index;
+        event_header_t * p_header    = &p_queue->p_headers[event_index];
 
-        void * p_event_data;
-        uint16_t event_data_size;
-        app_sched_event_handler_t event_handler;
+        void * p_event_data = &p_queue->p_data[event_index * p_queue->event_size];
 
-        p_event_data = &m_queue_event_data[event_index * m_queue_event_size];
-        event_data_size = m_queue_event_headers[event_index].event_data_size;
-        event_handler   = m_queue_event_headers[event_index].handler;
+        // Keep the reads of the event data and header after the read of the committed flag.
+        __DMB();
 
-        event_handler(p_event_data, event_data_size);
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+        app_sched_timestamp_func_t timestamp_func = m_timestamp_func;
+        uint32_t                   start_time     = 0;
+
+        if (timestamp_func != NULL)
+        {
+            start_time = timestamp_func();
+        }
+#endif
+
+        p_header->handler(p_event_data, p_header->event_data_size);
+
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+        if (timestamp_func != NULL)
+        {
+            handler_stats_update(p_header, start_time, timestamp_func());
+        }
+#endif
 
         // Event processed, now it is safe to move the queue start index,
         // so the queue entry occupied by this event can be used to store
-        // a next one.
-        m_queue_start_index = next_index(m_queue_start_index);
+        // a next one. The barrier keeps the accesses of the handler before that.
+        __DMB();
+        p_header->committed  = false;
+        p_queue->start_index = next_index(p_queue, event_index);
     }
 }
 #endif //NRF_MODULE_ENABLED(APP_SCHEDULER)
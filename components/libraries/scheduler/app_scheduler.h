@@ -39,6 +39,23 @@
  *     scheduler's queue. The app_sched_execute() function will pull this event and call its
  *     handler in the main context.
  *
+ * @section app_scheduler_prio Priorities:
+ *
+ *   When @ref APP_SCHEDULER_PRIORITY_COUNT is larger than 1, each priority has its own queue, with
+ *   its own event size and number of entries. Priority 0 is the highest. app_sched_execute()
+ *   always executes the oldest event of the highest priority queue that is not empty, so a burst
+ *   of events on one queue does not delay events on higher priority queues. The queues are set up
+ *   with APP_SCHED_PRIO_INIT(). The functions without a priority argument (APP_SCHED_INIT(),
+ *   app_sched_event_put(), and so on) use the lowest priority, @ref APP_SCHED_PRIORITY_LOWEST.
+ *
+ *   Instead of having the data copied by app_sched_prio_event_put(), a producer can reserve a slot
+ *   with app_sched_event_alloc(), write the event data directly into it, and pass it on for
+ *   execution with app_sched_event_commit(). Events queued after an uncommitted one on the same
+ *   queue are not executed until it is committed.
+ *
+ * @note The priority queues, the slot functions and the handler statistics are not available in
+ *       the serialization variant of the scheduler (app_scheduler_serconn.c).
+ *
  * @if (PERIPHERAL)
  * For an example usage of the scheduler, see the implementations of
  * @ref ble_sdk_app_hids_mouse and @ref ble_sdk_app_hids_keyboard.
@@ -59,7 +76,21 @@
 extern "C" {
 #endif
 
-#define APP_SCHED_EVENT_HEADER_SIZE 8       /**< Size of app_scheduler.event_header_t (only for use inside APP_SCHED_BUF_SIZE()). */
+#ifndef APP_SCHEDULER_PRIORITY_COUNT
+#define APP_SCHEDULER_PRIORITY_COUNT 1
+#endif
+
+#ifndef APP_SCHEDULER_HANDLER_STATS_COUNT
+#define APP_SCHEDULER_HANDLER_STATS_COUNT 8
+#endif
+
+#define APP_SCHED_PRIORITY_LOWEST   (APP_SCHEDULER_PRIORITY_COUNT - 1)  /**< Priority used by the functions without a priority argument. */
+
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+#define APP_SCHED_EVENT_HEADER_SIZE (sizeof(void *) + 8)   /**< Size of app_scheduler.event_header_t (only for use inside APP_SCHED_BUF_SIZE()). */
+#else
+#define APP_SCHED_EVENT_HEADER_SIZE (2 * sizeof(void *))    /**< Size of app_scheduler.event_header_t (only for use inside APP_SCHED_BUF_SIZE()). */
+#endif
 
 /**@brief Compute number of bytes required to hold the scheduler buffer.
  *
@@ -75,6 +106,28 @@ extern "C" {
 /**@brief Scheduler event handler type. */
 typedef void (*app_sched_event_handler_t)(void * p_event_data, uint16_t event_size);
 
+/**@brief Event slot reserved with @ref app_sched_event_alloc. */
+typedef struct
+{
+    void *   p_event_data;  /**< Where the producer writes the event data. */
+    uint8_t  priority;      /**< Priority of the queue that holds the slot. */
+    uint8_t  index;         /**< Index of the slot in the queue. */
+} app_sched_event_slot_t;
+
+/**@brief Time source for the handler statistics. Returns a free-running counter. */
+typedef uint32_t (*app_sched_timestamp_func_t)(void);
+
+/**@brief Execution statistics of one event handler. Times are in timestamp function ticks. */
+typedef struct
+{
+    app_sched_event_handler_t handler;          /**< Event handler. */
+    uint32_t                  event_count;      /**< Number of executed events. */
+    uint32_t                  exec_time_total;  /**< Total time spent in the handler. */
+    uint32_t                  exec_time_max;    /**< Longest execution of the handler. */
+    uint32_t                  wait_time_total;  /**< Total time between commit and execution. */
+    uint32_t                  wait_time_max;    /**< Longest time between commit and execution. */
+} app_sched_handler_stats_t;
+
 /**@brief Macro for initializing the event scheduler.
  *
  * @details It will also handle dimensioning and allocation of the memory buffer required by the
@@ -96,6 +149,24 @@ typedef void (*app_sched_event_handler_t)(void * p_event_data, uint16_t event_si
         APP_ERROR_CHECK(ERR_CODE);                                                                 \
     } while (0)
 
+/**@brief Macro for initializing the queue of one priority.
+ *
+ * @details Like APP_SCHED_INIT(), but for the queue of the given priority.
+ *
+ * @param[in] PRIORITY     Priority of the queue, from 0 (highest) to @ref APP_SCHED_PRIORITY_LOWEST.
+ * @param[in] EVENT_SIZE   Maximum size of events to be passed through the queue.
+ * @param[in] QUEUE_SIZE   Number of entries in the queue.
+ */
+#define APP_SCHED_PRIO_INIT(PRIORITY, EVENT_SIZE, QUEUE_SIZE)                                      \
+    do                                                                                             \
+    {                                                                                              \
+        static uint32_t APP_SCHED_BUF[CEIL_DIV(APP_SCHED_BUF_SIZE((EVENT_SIZE), (QUEUE_SIZE)),     \
+                                               sizeof(uint32_t))];                                 \
+        uint32_t ERR_CODE = app_sched_prio_init((PRIORITY), (EVENT_SIZE), (QUEUE_SIZE),            \
+                                                APP_SCHED_BUF);                                    \
+        APP_ERROR_CHECK(ERR_CODE);                                                                 \
+    } while (0)
+
 /**@brief Function for initializing the Scheduler.
  *
  * @details It must be called before entering the main loop.
@@ -116,6 +187,27 @@ typedef void (*app_sched_event_handler_t)(void * p_event_data, uint16_t event_si
  */
 uint32_t app_sched_init(uint16_t max_event_size, uint16_t queue_size, void * p_evt_buffer);
 
+/**@brief Function for initializing the queue of one priority.
+ *
+ * @details Like @ref app_sched_init, but for the queue of the given priority. Queues that are not
+ *          initialized reject events with NRF_ERROR_INVALID_STATE.
+ *
+ * @param[in]   priority         Priority of the queue.
+ * @param[in]   max_event_size   Maximum size of events to be passed through the queue.
+ * @param[in]   queue_size       Number of entries in the queue.
+ * @param[in]   p_evt_buffer     Pointer to memory buffer for holding the queue. It must be
+ *                               dimensioned using the APP_SCHED_BUF_SIZE() macro. The buffer
+ *                               must be aligned to a 4 byte boundary.
+ *
+ * @retval      NRF_SUCCESS               Successful initialization.
+ * @retval      NRF_ERROR_INVALID_PARAM   Invalid priority or buffer not aligned to a 4 byte
+ *                                        boundary.
+ */
+uint32_t app_sched_prio_init(uint8_t  priority,
+                             uint16_t max_event_size,
+                             uint16_t queue_size,
+                             void *   p_evt_buffer);
+
 /**@brief Function for executing all scheduled events.
  *
  * @details This function must be called from within the main loop. It will execute all events
@@ -137,6 +229,48 @@ uint32_t app_sched_event_put(void *                    p_event_data,
                              uint16_t                  event_size,
                              app_sched_event_handler_t handler);
 
+/**@brief Function for scheduling an event with a given priority.
+ *
+ * @param[in]   priority       Priority of the event.
+ * @param[in]   p_event_data   Pointer to event data to be scheduled.
+ * @param[in]   event_size     Size of event data to be scheduled.
+ * @param[in]   handler        Event handler to receive the event.
+ *
+ * @retval      NRF_SUCCESS               The event was scheduled.
+ * @retval      NRF_ERROR_NO_MEM          The queue is full.
+ * @retval      NRF_ERROR_INVALID_LENGTH  The event is larger than the events of the queue.
+ * @retval      NRF_ERROR_INVALID_STATE   The queue has not been initialized.
+ * @retval      NRF_ERROR_INVALID_PARAM   Invalid priority.
+ */
+uint32_t app_sched_prio_event_put(uint8_t                   priority,
+                                  void const *              p_event_data,
+                                  uint16_t                  event_size,
+                                  app_sched_event_handler_t handler);
+
+/**@brief Function for reserving an event slot.
+ *
+ * @details The producer writes up to @p event_size bytes to p_slot->p_event_data and then calls
+ *          @ref app_sched_event_commit. The slot must be committed from the same context that
+ *          reserved it.
+ *
+ * @param[in]   priority       Priority of the event.
+ * @param[in]   event_size     Size of the event data.
+ * @param[in]   handler        Event handler to receive the event.
+ * @param[out]  p_slot         Reserved slot.
+ *
+ * @return      The same error codes as @ref app_sched_prio_event_put.
+ */
+uint32_t app_sched_event_alloc(uint8_t                   priority,
+                               uint16_t                  event_size,
+                               app_sched_event_handler_t handler,
+                               app_sched_event_slot_t *  p_slot);
+
+/**@brief Function for passing a slot reserved with @ref app_sched_event_alloc on for execution.
+ *
+ * @param[in]   p_slot         Reserved slot.
+ */
+void app_sched_event_commit(app_sched_event_slot_t const * p_slot);
+
 /**@brief Function for getting the maximum observed queue utilization.
  *
  * Function for tuning the module and determining QUEUE_SIZE value and thus module RAM usage.
@@ -147,6 +281,16 @@ uint32_t app_sched_event_put(void *                    p_event_data,
  */
 uint16_t app_sched_queue_utilization_get(void);
 
+/**@brief Function for getting the maximum observed utilization of the queue of one priority.
+ *
+ * @note @ref APP_SCHEDULER_WITH_PROFILER must be enabled to use this functionality.
+ *
+ * @param[in]   priority   Priority of the queue.
+ *
+ * @return Maximum number of events in the queue observed so far.
+ */
+uint16_t app_sched_prio_queue_utilization_get(uint8_t priority);
+
 /**@brief Function for getting the current amount of free space in the queue.
  *
  * @details The real amount of free space may be less if entries are being added from an interrupt.
@@ -156,6 +300,14 @@ uint16_t app_sched_queue_utilization_get(void);
  */
 uint16_t app_sched_queue_space_get(void);
 
+/**@brief Function for getting the current amount of free space in the queue of one priority.
+ *
+ * @param[in]   priority   Priority of the queue.
+ *
+ * @return Amount of free space in the queue.
+ */
+uint16_t app_sched_prio_queue_space_get(uint8_t priority);
+
 /**@brief A function to pause the scheduler.
  *
  * @details When the scheduler is paused events are not pulled from the scheduler queue for
@@ -175,6 +327,39 @@ void app_sched_pause(void);
  */
 void app_sched_resume(void);
 
+/**@brief Function for setting the time source of the handler statistics.
+ *
+ * @details The statistics are only collected after a time source has been set. A counter of the
+ *          RTC used by @ref app_timer or the DWT cycle counter are suitable sources.
+ *
+ * @note @ref APP_SCHEDULER_WITH_HANDLER_STATS must be enabled to use this functionality.
+ *
+ * @param[in]   timestamp_func   Time source, or NULL to stop collecting statistics.
+ */
+void app_sched_handler_stats_timestamp_set(app_sched_timestamp_func_t timestamp_func);
+
+/**@brief Function for getting the execution statistics of an event handler.
+ *
+ * @details Statistics are kept for the first @ref APP_SCHEDULER_HANDLER_STATS_COUNT handlers that
+ *          are executed. Call this function from the main context.
+ *
+ * @note @ref APP_SCHEDULER_WITH_HANDLER_STATS must be enabled to use this functionality.
+ *
+ * @param[in]   handler   Event handler.
+ * @param[out]  p_stats   Statistics of the handler.
+ *
+ * @retval      NRF_SUCCESS           The statistics were returned.
+ * @retval      NRF_ERROR_NOT_FOUND   No statistics are kept for the handler.
+ */
+uint32_t app_sched_handler_stats_get(app_sched_event_handler_t   handler,
+                                     app_sched_handler_stats_t * p_stats);
+
+/**@brief Function for clearing the statistics of all event handlers.
+ *
+ * @note @ref APP_SCHEDULER_WITH_HANDLER_STATS must be enabled to use this functionality.
+ */
+void app_sched_handler_stats_reset(void);
+
 #ifdef __cplusplus
 }
 #endif
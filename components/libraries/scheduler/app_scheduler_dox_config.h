@@ -30,5 +30,33 @@
 #define APP_SCHEDULER_WITH_PROFILER
 
 
+/** @brief Number of event priorities
+ *
+ *  Each priority has its own queue. Priority 0 is the highest.
+ *
+ *  Minimum value: 1
+ *  Maximum value: 8
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define APP_SCHEDULER_PRIORITY_COUNT
+
+
+/** @brief Enabling per-handler execution and queue wait time statistics
+ *
+ *  Set to 1 to activate.
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define APP_SCHEDULER_WITH_HANDLER_STATS
+
+
+/** @brief Number of event handlers with statistics
+ *
+ * @note This is an NRF_CONFIG macro.
+ */
+#define APP_SCHEDULER_HANDLER_STATS_COUNT
+
+
 
 /** @} */
@@ -0,0 +1,445 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Scheduler test and benchmark for a PC host.
+ *
+ * The first part runs in one thread and checks:
+ * - the errors of init, put and alloc,
+ * - that events run in FIFO order per queue, higher priority queues first,
+ * - that an uncommitted slot holds back only the events behind it in its own queue,
+ * - full queues, the queue space and, with APP_SCHEDULER_WITH_PROFILER, the max utilization,
+ * - with APP_SCHEDULER_WITH_PAUSE, pause and resume,
+ * - with APP_SCHEDULER_WITH_HANDLER_STATS, the handler statistics.
+ *
+ * In the second part a thread plays the interrupt handler. It puts numbered 16-byte events with
+ * app_sched_event_alloc()/app_sched_event_commit() on the highest priority, sometimes yielding
+ * between the two so that the main loop finds uncommitted slots, and numbered 64-byte events
+ * with app_sched_prio_event_put() on the lowest. The main thread executes them and checks that
+ * each queue delivers its events in order and intact. The rate is in events per second.
+ *
+ * Command line: events=<events of each kind>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include "nrf_error.h"
+#include "app_scheduler.h"
+
+
+#define EVENTS_DEFAULT      (200000)
+#define QUEUE_SIZE          (32)
+#define FRAME_SIZE          (16)
+#define BLE_SIZE            (64)
+#define FRAME_PRIORITY      (0)
+#define BLE_PRIORITY        (APP_SCHED_PRIORITY_LOWEST)
+#define ORDER_MAX           (16)
+
+#if APP_SCHEDULER_PRIORITY_COUNT > 1
+#define FRAME_QUEUE_EVENT_SIZE  FRAME_SIZE
+#else
+#define FRAME_QUEUE_EVENT_SIZE  BLE_SIZE    // Both kinds share the only queue.
+#endif
+
+pthread_mutex_t app_scheduler_bench_critical_region = PTHREAD_MUTEX_INITIALIZER;
+
+static uint32_t m_frame_buffer[CEIL_DIV(APP_SCHED_BUF_SIZE(FRAME_QUEUE_EVENT_SIZE, QUEUE_SIZE),
+                                        sizeof(uint32_t))];
+static uint32_t m_ble_buffer[CEIL_DIV(APP_SCHED_BUF_SIZE(BLE_SIZE, QUEUE_SIZE), sizeof(uint32_t))];
+
+static uint32_t          m_events = EVENTS_DEFAULT;
+static uint32_t          m_checks;
+static uint32_t          m_failures;
+static uint32_t          m_order[ORDER_MAX];    // Events seen by the order handlers.
+static uint32_t          m_order_count;
+static uint32_t          m_frames_run;
+static uint32_t          m_ble_run;
+static volatile bool     m_isr_done;
+
+
+void assert_nrf_callback(uint16_t line_num, const uint8_t * file_name)
+{
+    printf("FAILED: ASSERT at %s:%u\n", (char const *)file_name, line_num);
+    exit(1);
+}
+
+
+static void check(bool condition, char const * p_what)
+{
+    m_checks++;
+    if (!condition)
+    {
+        m_failures++;
+        printf("FAILED: %s\n", p_what);
+    }
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+static uint32_t timestamp_ns(void)
+{
+    return (uint32_t)host_time_ns();
+}
+#endif
+
+
+static void order_record(uint32_t value)
+{
+    if (m_order_count < ORDER_MAX)
+    {
+        m_order[m_order_count] = value;
+    }
+    m_order_count++;
+}
+
+
+static void frame_order_handler(void * p_event_data, uint16_t event_size)
+{
+    uint32_t value;
+
+    memcpy(&value, p_event_data, sizeof(value));
+    order_record(value);
+}
+
+
+static void ble_order_handler(void * p_event_data, uint16_t event_size)
+{
+    uint32_t value;
+
+    // Events with a number record 1000 + the number, others 2000 + their size.
+    if (event_size == sizeof(value))
+    {
+        memcpy(&value, p_event_data, sizeof(value));
+        order_record(1000 + value);
+    }
+    else
+    {
+        order_record(2000 + event_size);
+    }
+}
+
+
+static void order_check(uint32_t const * p_expected, uint32_t count, char const * p_what)
+{
+    check((m_order_count == count) &&
+          ((count == 0) || (memcmp(m_order, p_expected, count * sizeof(uint32_t)) == 0)), p_what);
+    m_order_count = 0;
+}
+
+
+static uint32_t ble_put(uint32_t value, uint16_t size)
+{
+    uint8_t data[BLE_SIZE + 1] = {0};
+
+    memcpy(data, &value, sizeof(value));
+    return app_sched_prio_event_put(BLE_PRIORITY, data, size, ble_order_handler);
+}
+
+
+static void queue_test(void)
+{
+    app_sched_event_slot_t slot;
+    uint32_t               value = 7;
+
+    check(app_sched_event_put(&value, sizeof(value), ble_order_handler) == NRF_ERROR_INVALID_STATE,
+          "put before init");
+    check(app_sched_event_alloc(FRAME_PRIORITY, 4, frame_order_handler, &slot)
+          == NRF_ERROR_INVALID_STATE, "alloc before init");
+    check(app_sched_prio_init(APP_SCHEDULER_PRIORITY_COUNT, BLE_SIZE, QUEUE_SIZE, m_ble_buffer)
+          == NRF_ERROR_INVALID_PARAM, "init of no priority");
+    check(app_sched_init(BLE_SIZE, QUEUE_SIZE, (uint8_t *)m_ble_buffer + 1)
+          == NRF_ERROR_INVALID_PARAM, "init with an unaligned buffer");
+
+    check(app_sched_init(BLE_SIZE, QUEUE_SIZE, m_ble_buffer) == NRF_SUCCESS, "init");
+#if APP_SCHEDULER_PRIORITY_COUNT > 1
+    check(app_sched_prio_init(FRAME_PRIORITY, FRAME_SIZE, QUEUE_SIZE, m_frame_buffer)
+          == NRF_SUCCESS, "init of the frame queue");
+#else
+    (void)m_frame_buffer;
+#endif
+    check(app_sched_queue_space_get() == QUEUE_SIZE, "space of an empty queue");
+
+    // Lower priority first, then higher priority.
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        check(ble_put(i, sizeof(uint32_t)) == NRF_SUCCESS, "put");
+    }
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        check(app_sched_prio_event_put(FRAME_PRIORITY, &i, sizeof(i), frame_order_handler)
+              == NRF_SUCCESS, "put of a frame");
+    }
+    check(ble_put(0, 0) == NRF_SUCCESS, "put without data");
+    app_sched_execute();
+#if APP_SCHEDULER_PRIORITY_COUNT > 1
+    uint32_t const priority_order[] = {0, 1, 2, 1000, 1001, 1002, 2000};
+#else
+    uint32_t const priority_order[] = {1000, 1001, 1002, 0, 1, 2, 2000};
+#endif
+    order_check(priority_order, ARRAY_SIZE(priority_order), "priority and FIFO order");
+
+    // An uncommitted slot holds back the events behind it in its own queue only.
+    check(app_sched_event_alloc(FRAME_PRIORITY, sizeof(value), frame_order_handler, &slot)
+          == NRF_SUCCESS, "alloc");
+    check(ble_put(7, sizeof(uint32_t)) == NRF_SUCCESS, "put behind a slot");
+    app_sched_execute();
+#if APP_SCHEDULER_PRIORITY_COUNT > 1
+    uint32_t const blocked_order[] = {1007};
+    order_check(blocked_order, ARRAY_SIZE(blocked_order), "other queue runs past a slot");
+    memcpy(slot.p_event_data, &value, sizeof(value));
+    app_sched_event_commit(&slot);
+    app_sched_execute();
+    uint32_t const committed_order[] = {7};
+#else
+    order_check(NULL, 0, "nothing runs past a slot");
+    memcpy(slot.p_event_data, &value, sizeof(value));
+    app_sched_event_commit(&slot);
+    app_sched_execute();
+    uint32_t const committed_order[] = {7, 1007};
+#endif
+    order_check(committed_order, ARRAY_SIZE(committed_order), "slot runs once committed");
+
+    check(app_sched_prio_event_put(FRAME_PRIORITY, &value, FRAME_QUEUE_EVENT_SIZE + 1,
+                                   frame_order_handler) == NRF_ERROR_INVALID_LENGTH,
+          "put of a too long event");
+    check(app_sched_prio_event_put(APP_SCHEDULER_PRIORITY_COUNT, &value, sizeof(value),
+                                   frame_order_handler) == NRF_ERROR_INVALID_PARAM,
+          "put on no priority");
+
+    // A full queue.
+    for (uint32_t i = 0; i < QUEUE_SIZE; i++)
+    {
+        check(ble_put(i, sizeof(uint32_t)) == NRF_SUCCESS, "put until full");
+    }
+    check(ble_put(0, sizeof(uint32_t)) == NRF_ERROR_NO_MEM, "put on a full queue");
+    check(app_sched_queue_space_get() == 0, "space of a full queue");
+#if APP_SCHEDULER_WITH_PROFILER
+    check(app_sched_queue_utilization_get() == QUEUE_SIZE, "max utilization");
+#endif
+#if APP_SCHEDULER_WITH_PAUSE
+    app_sched_pause();
+    app_sched_pause();
+    app_sched_resume();
+    app_sched_execute();
+    check(m_order_count == 0, "nothing runs while paused");
+    app_sched_resume();
+#endif
+    app_sched_execute();
+    check(m_order_count == QUEUE_SIZE, "full queue runs");
+    check(app_sched_queue_space_get() == QUEUE_SIZE, "space after the queue ran");
+    m_order_count = 0;
+
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+    app_sched_handler_stats_t stats;
+
+    // The statistics are only kept while there is a time source.
+    check(app_sched_handler_stats_get(frame_order_handler, &stats) == NRF_ERROR_NOT_FOUND,
+          "no statistics without a time source");
+    app_sched_handler_stats_timestamp_set(timestamp_ns);
+    for (uint32_t i = 0; i < 5; i++)
+    {
+        check(app_sched_prio_event_put(FRAME_PRIORITY, &i, sizeof(i), frame_order_handler)
+              == NRF_SUCCESS, "put for the statistics");
+    }
+    app_sched_execute();
+    check((app_sched_handler_stats_get(frame_order_handler, &stats) == NRF_SUCCESS) &&
+          (stats.event_count == 5) && (stats.exec_time_max <= stats.exec_time_total) &&
+          (stats.wait_time_max <= stats.wait_time_total), "handler statistics");
+    check(app_sched_handler_stats_get(ble_order_handler, &stats) == NRF_ERROR_NOT_FOUND,
+          "no statistics of a handler that did not run");
+    app_sched_handler_stats_reset();
+    check(app_sched_handler_stats_get(frame_order_handler, &stats) == NRF_ERROR_NOT_FOUND,
+          "statistics reset");
+    m_order_count = 0;
+#endif
+}
+
+
+static void frame_handler(void * p_event_data, uint16_t event_size)
+{
+    uint32_t words[FRAME_SIZE / sizeof(uint32_t)];
+
+    memcpy(words, p_event_data, sizeof(words));
+    if ((event_size != FRAME_SIZE) || (words[0] != m_frames_run) ||
+        (words[1] != ~m_frames_run) || (words[2] != m_frames_run * 2654435761u) ||
+        (words[3] != m_frames_run + 1))
+    {
+        if (m_failures < 10)
+        {
+            printf("FAILED: frame %u delivered as %u\n", m_frames_run, words[0]);
+        }
+        m_failures++;
+    }
+    m_frames_run++;
+}
+
+
+static void ble_handler(void * p_event_data, uint16_t event_size)
+{
+    uint8_t const * p_data = p_event_data;
+    bool            intact = (event_size == BLE_SIZE);
+
+    for (uint32_t i = 0; intact && (i < BLE_SIZE); i++)
+    {
+        intact = (p_data[i] == (uint8_t)(m_ble_run + i));
+    }
+    if (!intact)
+    {
+        if (m_failures < 10)
+        {
+            printf("FAILED: BLE event %u not intact\n", m_ble_run);
+        }
+        m_failures++;
+    }
+    m_ble_run++;
+}
+
+
+static void * isr_thread(void * p_context)
+{
+    uint32_t frames = 0;
+    uint32_t ble    = 0;
+
+    while ((frames < m_events) || (ble < m_events))
+    {
+        app_sched_event_slot_t slot;
+
+        if ((frames < m_events) &&
+            (app_sched_event_alloc(FRAME_PRIORITY, FRAME_SIZE, frame_handler, &slot)
+             == NRF_SUCCESS))
+        {
+            uint32_t words[FRAME_SIZE / sizeof(uint32_t)] =
+                {frames, ~frames, frames * 2654435761u, frames + 1};
+
+            if ((frames % 16) == 0)
+            {
+                (void)sched_yield();
+            }
+            memcpy(slot.p_event_data, words, sizeof(words));
+            app_sched_event_commit(&slot);
+            frames++;
+        }
+
+        if (ble < m_events)
+        {
+            uint8_t data[BLE_SIZE];
+
+            for (uint32_t i = 0; i < BLE_SIZE; i++)
+            {
+                data[i] = (uint8_t)(ble + i);
+            }
+            if (app_sched_prio_event_put(BLE_PRIORITY, data, BLE_SIZE, ble_handler)
+                == NRF_SUCCESS)
+            {
+                ble++;
+            }
+        }
+
+        if ((app_sched_prio_queue_space_get(FRAME_PRIORITY) == 0) ||
+            (app_sched_prio_queue_space_get(BLE_PRIORITY) == 0))
+        {
+            (void)sched_yield();
+        }
+    }
+
+    m_isr_done = true;
+    return NULL;
+}
+
+
+static void isr_test(void)
+{
+    pthread_t isr;
+
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+    app_sched_handler_stats_reset();
+#endif
+
+    uint64_t const start = host_time_ns();
+    if (pthread_create(&isr, NULL, isr_thread, NULL) != 0)
+    {
+        fprintf(stderr, "pthread_create failed\n");
+        exit(2);
+    }
+    while (!m_isr_done || (m_frames_run < m_events) || (m_ble_run < m_events))
+    {
+        app_sched_execute();
+        (void)sched_yield();
+    }
+    (void)pthread_join(isr, NULL);
+    uint64_t const elapsed = host_time_ns() - start;
+
+    check((m_frames_run == m_events) && (m_ble_run == m_events), "every event executed once");
+    printf("  %u frame and %u BLE events: %.2f M events/s\n", m_frames_run, m_ble_run,
+           (m_frames_run + m_ble_run) / (elapsed * 1e-3));
+
+#if APP_SCHEDULER_WITH_HANDLER_STATS
+    app_sched_event_handler_t const handlers[] = {frame_handler, ble_handler};
+    char const * const              names[]    = {"frame", "BLE"};
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(handlers); i++)
+    {
+        app_sched_handler_stats_t stats;
+
+        check((app_sched_handler_stats_get(handlers[i], &stats) == NRF_SUCCESS) &&
+              (stats.event_count == m_events), "statistics of the events");
+        printf("  %-5s handler: %5.0f ns average run, %8.0f ns average wait, %9u ns max wait\n",
+               names[i], (double)stats.exec_time_total / stats.event_count,
+               (double)stats.wait_time_total / stats.event_count, stats.wait_time_max);
+    }
+#endif
+#if APP_SCHEDULER_WITH_PROFILER
+    printf("  max utilization: frame queue %u, BLE queue %u of %u\n",
+           app_sched_prio_queue_utilization_get(FRAME_PRIORITY),
+           app_sched_prio_queue_utilization_get(BLE_PRIORITY), QUEUE_SIZE);
+#endif
+}
+
+
+int main(int argc, char * argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "events=", 7) == 0)
+        {
+            m_events = strtoul(argv[i] + 7, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [events=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    printf("%u priorities%s%s%s\n", APP_SCHEDULER_PRIORITY_COUNT,
+           APP_SCHEDULER_WITH_PAUSE ? ", pause" : "",
+           APP_SCHEDULER_WITH_PROFILER ? ", profiler" : "",
+           APP_SCHEDULER_WITH_HANDLER_STATS ? ", handler statistics" : "");
+
+    queue_test();
+    isr_test();
+
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
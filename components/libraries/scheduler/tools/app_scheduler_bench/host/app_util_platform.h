@@ -0,0 +1,32 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host replacement of components/libraries/util/app_util_platform.h for the scheduler test. A
+ * thread plays the interrupt handler and runs at the same time as the main loop, so critical
+ * regions take a mutex. */
+
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include <stdint.h>
+#include <pthread.h>
+#include "compiler_abstraction.h"
+
+extern pthread_mutex_t app_scheduler_bench_critical_region;
+
+#define CRITICAL_REGION_ENTER()     { pthread_mutex_lock(&app_scheduler_bench_critical_region);
+#define CRITICAL_REGION_EXIT()      pthread_mutex_unlock(&app_scheduler_bench_critical_region); }
+
+#define ANON_UNIONS_ENABLE
+#define ANON_UNIONS_DISABLE
+
+#endif // APP_UTIL_PLATFORM_H__
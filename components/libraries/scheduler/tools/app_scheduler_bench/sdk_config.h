@@ -0,0 +1,37 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Configuration of the scheduler test. The Makefile builds it once as it is and once with the
+ * defaults of app_scheduler: one queue and none of the options. */
+
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+#define APP_SCHEDULER_ENABLED 1
+
+#ifndef APP_SCHEDULER_PRIORITY_COUNT
+#define APP_SCHEDULER_PRIORITY_COUNT 2
+#endif
+
+#ifndef APP_SCHEDULER_WITH_PAUSE
+#define APP_SCHEDULER_WITH_PAUSE 1
+#endif
+
+#ifndef APP_SCHEDULER_WITH_PROFILER
+#define APP_SCHEDULER_WITH_PROFILER 1
+#endif
+
+#ifndef APP_SCHEDULER_WITH_HANDLER_STATS
+#define APP_SCHEDULER_WITH_HANDLER_STATS 1
+#endif
+
+#endif // SDK_CONFIG_H
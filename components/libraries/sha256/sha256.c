@@ -41,6 +41,46 @@ static const uint32_t k[64] = {
 };
 
 
+#ifndef SHA256_CONFIG_UNROLL
+#define SHA256_CONFIG_UNROLL 0
+#endif
+
+// Message schedule word i, computed in place in the 16-word window m.
+#define SCHEDULE(m,i) \
+    ((m)[(i) & 15] += SIG1((m)[((i) - 2) & 15]) + (m)[((i) - 7) & 15] + SIG0((m)[((i) - 15) & 15]))
+
+// One round. Instead of moving the working variables, callers rotate the arguments.
+#define ROUND(a,b,c,d,e,f,g,h,i,w)                              \
+    do {                                                        \
+        uint32_t t1 = (h) + EP1(e) + CH(e,f,g) + k[i] + (w);    \
+        (d) += t1;                                              \
+        (h)  = t1 + EP0(a) + MAJ(a,b,c);                        \
+    } while (0)
+
+
+/**@brief Function for loading a block into the first 16 words of the message schedule.
+ *
+ * @param[out] m     Message schedule.
+ * @param[in]  data  Block to be loaded. Assumed to be 64 bytes long.
+ */
+static __INLINE void sha256_load(uint32_t * m, const uint8_t * data)
+{
+    uint32_t i;
+
+    if (is_word_aligned(data))
+    {
+        // All supported devices are little-endian, so each word only needs its bytes reversed.
+        for (i = 0; i < 16; ++i)
+            m[i] = __REV(((uint32_t const *)data)[i]);
+    }
+    else
+    {
+        for (i = 0; i < 16; ++i, data += 4)
+            m[i] = ((uint32_t)data[0] << 24) | ((uint32_t)data[1] << 16) | ((uint32_t)data[2] << 8) | (data[3]);
+    }
+}
+
+
 /**@brief Function for calculating the hash of a 64-byte section of data.
  *
  * @param[in,out] ctx   Hash instance.
@@ -48,12 +88,9 @@ static const uint32_t k[64] = {
  */
 void sha256_transform(sha256_context_t *ctx, const uint8_t * data)
 {
-    uint32_t a, b, c, d, e, f, g, h, i, j, t1, t2, m[64];
+    uint32_t a, b, c, d, e, f, g, h, i, m[16];
 
-    for (i = 0, j = 0; i < 16; ++i, j += 4)
-        m[i] = (data[j] << 24) | (data[j + 1] << 16) | (data[j + 2] << 8) | (data[j + 3]);
-    for ( ; i < 64; ++i)
-        m[i] = SIG1(m[i - 2]) + m[i - 7] + SIG0(m[i - 15]) + m[i - 16];
+    sha256_load(m, data);
 
     a = ctx->state[0];
     b = ctx->state[1];
@@ -64,8 +101,28 @@ void sha256_transform(sha256_context_t *ctx, const uint8_t * data)
     g = ctx->state[6];
     h = ctx->state[7];
 
+#if SHA256_CONFIG_UNROLL
+    for (i = 0; i < 64; i += 8) {
+        if (i >= 16) {
+            SCHEDULE(m, i);     SCHEDULE(m, i + 1); SCHEDULE(m, i + 2); SCHEDULE(m, i + 3);
+            SCHEDULE(m, i + 4); SCHEDULE(m, i + 5); SCHEDULE(m, i + 6); SCHEDULE(m, i + 7);
+        }
+        ROUND(a, b, c, d, e, f, g, h, i,     m[(i)     & 15]);
+        ROUND(h, a, b, c, d, e, f, g, i + 1, m[(i + 1) & 15]);
+        ROUND(g, h, a, b, c, d, e, f, i + 2, m[(i + 2) & 15]);
+        ROUND(f, g, h, a, b, c, d, e, i + 3, m[(i + 3) & 15]);
+        ROUND(e, f, g, h, a, b, c, d, i + 4, m[(i + 4) & 15]);
+        ROUND(d, e, f, g, h, a, b, c, i + 5, m[(i + 5) & 15]);
+        ROUND(c, d, e, f, g, h, a, b, i + 6, m[(i + 6) & 15]);
+        ROUND(b, c, d, e, f, g, h, a, i + 7, m[(i + 7) & 15]);
+    }
+#else
     for (i = 0; i < 64; ++i) {
-        t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[i];
+        uint32_t t1, t2;
+
+        if (i >= 16)
+            SCHEDULE(m, i);
+        t1 = h + EP1(e) + CH(e,f,g) + k[i] + m[i & 15];
         t2 = EP0(a) + MAJ(a,b,c);
         h = g;
         g = f;
@@ -76,6 +133,7 @@ void sha256_transform(sha256_context_t *ctx, const uint8_t * data)
         b = a;
         a = t1 + t2;
     }
+#endif
 
     ctx->state[0] += a;
     ctx->state[1] += b;
@@ -114,23 +172,84 @@ ret_code_t sha256_update(sha256_context_t *ctx, const uint8_t * data, size_t len
     {
         return NRF_ERROR_NULL;
     }
+    if (len == 0)
+    {
+        return NRF_SUCCESS;
+    }
 
-    uint32_t i;
+    // Top up a partially filled block first.
+    if (ctx->datalen > 0)
+    {
+        size_t n = MIN(64 - ctx->datalen, len);
 
-    for (i = 0; i < len; ++i) {
-        ctx->data[ctx->datalen] = data[i];
-        ctx->datalen++;
-        if (ctx->datalen == 64) {
-            sha256_transform(ctx, ctx->data);
-            ctx->bitlen += 512;
-            ctx->datalen = 0;
+        memcpy(&ctx->data[ctx->datalen], data, n);
+        ctx->datalen += n;
+        data         += n;
+        len          -= n;
+
+        if (ctx->datalen < 64)
+        {
+            return NRF_SUCCESS;
         }
+        sha256_transform(ctx, ctx->data);
+        ctx->bitlen += 512;
+        ctx->datalen = 0;
+    }
+
+    // Hash whole blocks straight from the caller's buffer.
+    while (len >= 64)
+    {
+        sha256_transform(ctx, data);
+        ctx->bitlen += 512;
+        data        += 64;
+        len         -= 64;
+    }
+
+    // Keep the tail for the next call.
+    memcpy(ctx->data, data, len);
+    ctx->datalen = len;
+
+    return NRF_SUCCESS;
+}
+
+
+ret_code_t sha256_update_regions(sha256_context_t *ctx, sha256_region_t const * regions, size_t count)
+{
+    ret_code_t err_code;
+
+    VERIFY_PARAM_NOT_NULL(ctx);
+    if ((count > 0) && (regions == NULL))
+    {
+        return NRF_ERROR_NULL;
+    }
+
+    for (size_t i = 0; i < count; i++)
+    {
+        err_code = sha256_update(ctx, regions[i].p_data, regions[i].len);
+        VERIFY_SUCCESS(err_code);
     }
 
     return NRF_SUCCESS;
 }
 
 
+ret_code_t sha256_compute_regions(sha256_region_t const * regions, size_t count, uint8_t * hash, uint8_t le)
+{
+    ret_code_t       err_code;
+    sha256_context_t ctx;
+
+    VERIFY_PARAM_NOT_NULL(hash);
+
+    err_code = sha256_init(&ctx);
+    VERIFY_SUCCESS(err_code);
+
+    err_code = sha256_update_regions(&ctx, regions, count);
+    VERIFY_SUCCESS(err_code);
+
+    return sha256_final(&ctx, hash, le);
+}
+
+
 ret_code_t sha256_final(sha256_context_t *ctx, uint8_t * hash, uint8_t le)
 {
     uint32_t i;
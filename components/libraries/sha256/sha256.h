@@ -23,7 +23,12 @@
  *          sha256_update with the data to be hashed. This step can optionally be done with multiple
  *          calls to @ref sha256_update, each with a section of the data (in the correct order).
  *          After all data has been passed to @ref sha256_update, call @ref sha256_final to finalize
- *          and extract the hash value.
+ *          and extract the hash value. Data which is spread over several regions of memory can
+ *          be hashed in one call with @ref sha256_update_regions or @ref sha256_compute_regions.
+ *
+ *          Whole 64-byte blocks are hashed straight from the caller's buffer. Define
+ *          SHA256_CONFIG_UNROLL to 1 to unroll the rounds of the transform, which is faster but
+ *          larger.
  *
  *          This code is adapted from code by Brad Conte, retrieved from
  *          https://github.com/B-Con/crypto-algorithms.
@@ -35,6 +40,7 @@
 
 
 #include <stdint.h>
+#include <stddef.h>
 #include "sdk_errors.h"
 
 #ifdef __cplusplus
@@ -52,6 +58,14 @@ typedef struct {
 } sha256_context_t;
 
 
+/**@brief A region of memory to be hashed, for example a section of flash.
+ */
+typedef struct {
+    const uint8_t * p_data;  /**< Start of the region. */
+    size_t          len;     /**< Length of the region in bytes. */
+} sha256_region_t;
+
+
 /**@brief Function for initializing a @ref sha256_context_t instance.
  *
  * @param[out] ctx  Context instance to be initialized.
@@ -75,6 +89,34 @@ ret_code_t sha256_init(sha256_context_t *ctx);
  */
 ret_code_t sha256_update(sha256_context_t *ctx, const uint8_t * data, const size_t len);
 
+/**@brief Function for hashing a list of regions, in order.
+ *
+ * @details This is equivalent to calling @ref sha256_update once for each region.
+ *
+ * @param[in,out] ctx      Hash instance.
+ * @param[in]     regions  Regions to be hashed.
+ * @param[in]     count    Number of regions.
+ *
+ * @retval NRF_SUCCESS     If the data was successfully hashed.
+ * @retval NRF_ERROR_NULL  If the ctx parameter was NULL, the regions parameter was NULL while count
+ *                         was not zero, or a region with a non-zero length had no data.
+ */
+ret_code_t sha256_update_regions(sha256_context_t *ctx, sha256_region_t const * regions, size_t count);
+
+/**@brief Function for calculating the hash of a list of regions in one call.
+ *
+ * @details This is equivalent to @ref sha256_init, @ref sha256_update_regions and @ref sha256_final.
+ *
+ * @param[in]  regions  Regions to be hashed.
+ * @param[in]  count    Number of regions.
+ * @param[out] hash     Array to hold the hash value (assumed to be 32 bytes long).
+ * @param[in]  le       Store the hash in little-endian.
+ *
+ * @retval NRF_SUCCESS     If the hash was successfully calculated.
+ * @retval NRF_ERROR_NULL  If a parameter was NULL.
+ */
+ret_code_t sha256_compute_regions(sha256_region_t const * regions, size_t count, uint8_t * hash, uint8_t le);
+
 /**@brief Function for extracting the hash value from a hash instance.
  *
  * @details This function should be called after all data to be hashed has been passed to the hash
@@ -0,0 +1,306 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* SHA-256 benchmark for a PC host.
+ *
+ * Checks sha256.c against the FIPS-180 test vectors, and checks that hashing a buffer in random
+ * chunks, at any alignment, or as a list of regions gives the same hash as one sha256_update().
+ * Then prints the throughput of:
+ * - bytewise: the loop of the previous sha256_update(), which copied the data into the context
+ *   one byte at a time and hashed each block from there,
+ * - update:   sha256_update() on the whole buffer,
+ * - regions:  sha256_compute_regions() on the buffer split into four regions of odd lengths.
+ *
+ * Command line: size=<bytes> rounds=<n>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "sha256.h"
+
+
+#define SIZE_DEFAULT    (1024 * 1024)
+#define ROUNDS_DEFAULT  (20)
+#define CHECK_SIZE      (4096)  // Size of the buffer hashed in chunks.
+#define CHECK_SPLITS    (500)   // Random splits into chunks.
+
+// Not in sha256.h, but not static either. Used for the previous update loop.
+void sha256_transform(sha256_context_t *ctx, const uint8_t * data);
+
+
+typedef struct
+{
+    char const * p_message;
+    uint32_t     repeat;
+    uint8_t      hash[32];
+} test_vector_t;
+
+
+static test_vector_t const m_vectors[] =
+{
+    {
+        "", 1,
+        {0xe3, 0xb0, 0xc4, 0x42, 0x98, 0xfc, 0x1c, 0x14, 0x9a, 0xfb, 0xf4, 0xc8, 0x99, 0x6f, 0xb9, 0x24,
+         0x27, 0xae, 0x41, 0xe4, 0x64, 0x9b, 0x93, 0x4c, 0xa4, 0x95, 0x99, 0x1b, 0x78, 0x52, 0xb8, 0x55}
+    },
+    {
+        "abc", 1,
+        {0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+         0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad}
+    },
+    {
+        "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", 1,
+        {0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8, 0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+         0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67, 0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1}
+    },
+    {
+        "a", 1000000,
+        {0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92, 0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+         0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e, 0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0}
+    },
+};
+
+static uint32_t m_rand = 1;
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+
+static void check(bool ok, char const * p_what)
+{
+    m_checks++;
+    if (!ok)
+    {
+        m_failures++;
+        printf("FAILED: %s\n", p_what);
+    }
+}
+
+
+static uint32_t bench_rand(void)
+{
+    m_rand = (m_rand * 1103515245UL) + 12345UL;
+    return (m_rand >> 16);
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+// The update loop of sha256.c before it hashed whole blocks in place.
+static void sha256_update_bytewise(sha256_context_t * ctx, const uint8_t * data, size_t len)
+{
+    for (size_t i = 0; i < len; ++i)
+    {
+        ctx->data[ctx->datalen] = data[i];
+        ctx->datalen++;
+        if (ctx->datalen == 64)
+        {
+            sha256_transform(ctx, ctx->data);
+            ctx->bitlen += 512;
+            ctx->datalen = 0;
+        }
+    }
+}
+
+
+static void hash_bytewise(uint8_t const * p_data, size_t len, uint8_t * p_hash)
+{
+    sha256_context_t ctx;
+
+    (void)sha256_init(&ctx);
+    sha256_update_bytewise(&ctx, p_data, len);
+    (void)sha256_final(&ctx, p_hash, 0);
+}
+
+
+static void hash_update(uint8_t const * p_data, size_t len, uint8_t * p_hash)
+{
+    sha256_context_t ctx;
+
+    (void)sha256_init(&ctx);
+    (void)sha256_update(&ctx, p_data, len);
+    (void)sha256_final(&ctx, p_hash, 0);
+}
+
+
+// Four regions of odd lengths, so that every region after the first starts unaligned.
+static void hash_regions(uint8_t const * p_data, size_t len, uint8_t * p_hash)
+{
+    sha256_region_t regions[4];
+    size_t          offset = 0;
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        size_t region_len = len - offset;
+
+        if ((i < 3) && (region_len > ((len / 4) | 1)))
+        {
+            region_len = (len / 4) | 1;
+        }
+
+        regions[i].p_data = p_data + offset;
+        regions[i].len    = region_len;
+        offset           += region_len;
+    }
+    (void)sha256_compute_regions(regions, 4, p_hash, 0);
+}
+
+
+static void vectors_check(void)
+{
+    for (uint32_t i = 0; i < sizeof(m_vectors) / sizeof(m_vectors[0]); i++)
+    {
+        test_vector_t const * p_vector = &m_vectors[i];
+        sha256_context_t      ctx;
+        uint8_t               hash[32];
+        ret_code_t            err_code = NRF_SUCCESS;
+
+        check(sha256_init(&ctx) == NRF_SUCCESS, "init");
+        for (uint32_t j = 0; j < p_vector->repeat; j++)
+        {
+            err_code |= sha256_update(&ctx, (uint8_t const *)p_vector->p_message,
+                                      strlen(p_vector->p_message));
+        }
+        check(err_code == NRF_SUCCESS, "update");
+        check(sha256_final(&ctx, hash, 0) == NRF_SUCCESS, "final");
+        check(memcmp(hash, p_vector->hash, sizeof(hash)) == 0, "FIPS-180 test vector");
+    }
+
+    sha256_context_t ctx;
+    uint8_t          hash[32];
+
+    check(sha256_update(NULL, NULL, 0) == NRF_ERROR_NULL, "update NULL context");
+    check(sha256_init(&ctx) == NRF_SUCCESS, "init");
+    check(sha256_update(&ctx, NULL, 1) == NRF_ERROR_NULL, "update NULL data");
+    check(sha256_update(&ctx, NULL, 0) == NRF_SUCCESS, "update no data");
+    check(sha256_compute_regions(NULL, 1, hash, 0) == NRF_ERROR_NULL, "regions NULL");
+    check(sha256_compute_regions(NULL, 0, hash, 0) == NRF_SUCCESS, "no regions");
+    check(memcmp(hash, m_vectors[0].hash, sizeof(hash)) == 0, "no regions hash");
+}
+
+
+static void chunks_check(uint8_t const * p_buf)
+{
+    uint8_t expected[32];
+    uint8_t hash[32];
+
+    // Every start alignment, with lengths around the block boundaries.
+    for (uint32_t offset = 0; offset < 8; offset++)
+    {
+        for (uint32_t len = 0; len < 200; len++)
+        {
+            hash_bytewise(p_buf + offset, len, expected);
+            hash_update(p_buf + offset, len, hash);
+            check(memcmp(hash, expected, sizeof(hash)) == 0, "update at offset");
+            hash_regions(p_buf + offset, len, hash);
+            check(memcmp(hash, expected, sizeof(hash)) == 0, "regions at offset");
+        }
+    }
+
+    hash_bytewise(p_buf, CHECK_SIZE, expected);
+    for (uint32_t i = 0; i < CHECK_SPLITS; i++)
+    {
+        sha256_context_t ctx;
+        size_t           offset = 0;
+
+        (void)sha256_init(&ctx);
+        while (offset < CHECK_SIZE)
+        {
+            size_t len = bench_rand() % 150;
+
+            if (len > CHECK_SIZE - offset)
+            {
+                len = CHECK_SIZE - offset;
+            }
+            (void)sha256_update(&ctx, p_buf + offset, len);
+            offset += len;
+        }
+        (void)sha256_final(&ctx, hash, 0);
+        check(memcmp(hash, expected, sizeof(hash)) == 0, "update in chunks");
+    }
+}
+
+
+static double throughput(void (*hash_fn)(uint8_t const *, size_t, uint8_t *),
+                         uint8_t const * p_buf, uint32_t size, uint32_t rounds)
+{
+    uint8_t        hash[32];
+    uint64_t const start = host_time_ns();
+
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        hash_fn(p_buf, size, hash);
+    }
+    return ((double)size * rounds / 1e6) / ((host_time_ns() - start) * 1e-9);
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t size   = SIZE_DEFAULT;
+    uint32_t rounds = ROUNDS_DEFAULT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "size=", 5) == 0)
+        {
+            size = strtoul(argv[i] + 5, NULL, 0);
+        }
+        else if (strncmp(argv[i], "rounds=", 7) == 0)
+        {
+            rounds = strtoul(argv[i] + 7, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [size=<bytes>] [rounds=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((size < 8) || (rounds == 0))
+    {
+        fprintf(stderr, "size must be 8 bytes or more, rounds more than 0\n");
+        return 2;
+    }
+
+    uint32_t const buf_size = (size > CHECK_SIZE + 8) ? size : CHECK_SIZE + 8;
+    uint8_t      * p_buf    = malloc(buf_size);
+    if (p_buf == NULL)
+    {
+        return 2;
+    }
+    for (uint32_t i = 0; i < buf_size; i++)
+    {
+        p_buf[i] = (uint8_t)bench_rand();
+    }
+
+    vectors_check();
+    chunks_check(p_buf);
+
+    printf("SHA256_CONFIG_UNROLL %u: %u bytes, bytewise %.1f MB/s, update %.1f MB/s, "
+           "regions %.1f MB/s\n",
+           SHA256_CONFIG_UNROLL, size,
+           throughput(hash_bytewise, p_buf, size, rounds),
+           throughput(hash_update, p_buf, size, rounds),
+           throughput(hash_regions, p_buf, size, rounds));
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+
+    free(p_buf);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -111,4 +111,248 @@ uint32_t slip_decoding_add_char(uint8_t c, buffer_t * p_buf, slip_state_t * curr
     }
     return NRF_ERROR_BUSY;
 }
+
+
+#define BYTES_ONES  0x01010101UL /* 0x01 in every byte of a word */
+#define BYTES_HIGHS 0x80808080UL /* 0x80 in every byte of a word */
+
+/* Escape sequences and delimiter for the segment encoder. Not const, so that they are in RAM and
+ * can be read by EasyDMA. */
+static uint8_t m_slip_end[]     = {SLIP_END};
+static uint8_t m_slip_esc_end[] = {SLIP_ESC, SLIP_ESC_END};
+static uint8_t m_slip_esc_esc[] = {SLIP_ESC, SLIP_ESC_ESC};
+
+
+/**@brief Checks if any byte of a word is zero.
+ *
+ * @details Subtracting 1 from every byte sets the top bit of a zero byte, and ~word masks out
+ *          bytes that had the top bit set already. A borrow can only flag bytes above a zero
+ *          byte, so the result is non-zero if and only if the word has a zero byte.
+ */
+__STATIC_INLINE uint32_t word_has_zero_byte(uint32_t word)
+{
+    return (word - BYTES_ONES) & ~word & BYTES_HIGHS;
+}
+
+
+/**@brief Finds the first END or ESC byte.
+ *
+ * @param[in] p_data   Start of the data.
+ * @param[in] p_end    End of the data.
+ * @param[in] end_only Find only END bytes.
+ *
+ * @return Pointer to the byte, or p_end if there is none.
+ */
+static uint8_t * special_byte_find(uint8_t * p_data, uint8_t * p_end, bool end_only)
+{
+    uint8_t  esc      = end_only ? SLIP_END : SLIP_ESC;
+    uint32_t end_word = SLIP_END * BYTES_ONES;
+    uint32_t esc_word = esc * BYTES_ONES;
+
+    while ((p_data < p_end) && !is_word_aligned(p_data))
+    {
+        if ((*p_data == SLIP_END) || (*p_data == esc))
+        {
+            return p_data;
+        }
+        p_data++;
+    }
+
+    while ((p_end - p_data) >= (int32_t)sizeof(uint32_t))
+    {
+        uint32_t word;
+
+        // The data is aligned here, so the copy is a single load.
+        memcpy(&word, p_data, sizeof(word));
+
+        if (word_has_zero_byte(word ^ end_word) | word_has_zero_byte(word ^ esc_word))
+        {
+            break;
+        }
+        p_data += sizeof(uint32_t);
+    }
+
+    while ((p_data < p_end) && (*p_data != SLIP_END) && (*p_data != esc))
+    {
+        p_data++;
+    }
+    return p_data;
+}
+
+
+void slip_decoder_init(slip_decoder_t *     p_decoder,
+                       uint8_t *            p_buffer,
+                       uint32_t             buffer_size,
+                       slip_frame_handler_t frame_handler,
+                       void *               p_context)
+{
+    p_decoder->p_buffer      = p_buffer;
+    p_decoder->buffer_size   = buffer_size;
+    p_decoder->length        = 0;
+    p_decoder->state         = SLIP_DECODER_FRAME;
+    p_decoder->frame_handler = frame_handler;
+    p_decoder->p_context     = p_context;
+}
+
+
+uint32_t slip_chunk_decode(slip_decoder_t * p_decoder, uint8_t * p_chunk, uint32_t length)
+{
+    uint8_t *            p_in    = p_chunk;
+    uint8_t *            p_end   = p_chunk + length;
+    uint8_t *            p_frame = p_chunk; // Start of the frame being decoded.
+    uint8_t *            p_out   = p_chunk; // End of the decoded part of the frame.
+    uint32_t             space   = p_decoder->buffer_size;
+    slip_decoder_state_t state   = p_decoder->state;
+    uint32_t             err_code = NRF_SUCCESS;
+
+    if ((p_decoder->length > 0) || (state == SLIP_DECODER_ESC))
+    {
+        // Continue the frame from the previous chunk in the buffer.
+        p_frame = p_decoder->p_buffer;
+        p_out   = p_frame + p_decoder->length;
+        space  -= p_decoder->length;
+    }
+
+    while (p_in < p_end)
+    {
+        if (state == SLIP_DECODER_FRAME)
+        {
+            uint8_t * p_special = special_byte_find(p_in, p_end, false);
+            uint32_t  run       = p_special - p_in;
+
+            if (run > space)
+            {
+                state    = SLIP_DECODER_DROP;
+                err_code = NRF_ERROR_INVALID_DATA;
+                continue;
+            }
+            if (p_out != p_in)
+            {
+                memmove(p_out, p_in, run);
+            }
+            p_out += run;
+            space -= run;
+            p_in   = p_special;
+
+            if (p_in == p_end)
+            {
+                break;
+            }
+            if (*p_in++ == SLIP_ESC)
+            {
+                state = SLIP_DECODER_ESC;
+                continue;
+            }
+            if (p_out != p_frame)
+            {
+                p_decoder->frame_handler(p_frame, p_out - p_frame, p_decoder->p_context);
+            }
+        }
+        else if (state == SLIP_DECODER_ESC)
+        {
+            uint8_t c = *p_in;
+
+            if ((c != SLIP_ESC_END) && (c != SLIP_ESC_ESC))
+            {
+                // Violation of protocol. The byte is not consumed, so that an END ends the drop.
+                state    = SLIP_DECODER_DROP;
+                err_code = NRF_ERROR_INVALID_DATA;
+                continue;
+            }
+            if (space == 0)
+            {
+                state    = SLIP_DECODER_DROP;
+                err_code = NRF_ERROR_INVALID_DATA;
+                continue;
+            }
+            *p_out++ = (c == SLIP_ESC_END) ? SLIP_END : SLIP_ESC;
+            space--;
+            p_in++;
+            state = SLIP_DECODER_FRAME;
+            continue;
+        }
+        else
+        {
+            p_in = special_byte_find(p_in, p_end, true);
+            if (p_in == p_end)
+            {
+                break;
+            }
+            p_in++;
+            state = SLIP_DECODER_FRAME;
+        }
+
+        // An END was consumed. The next frame is decoded in place.
+        p_frame = p_in;
+        p_out   = p_in;
+        space   = p_decoder->buffer_size;
+    }
+
+    p_decoder->state  = state;
+    p_decoder->length = 0;
+    if (state != SLIP_DECODER_DROP)
+    {
+        // Keep the decoded part of an unfinished frame for the next chunk.
+        p_decoder->length = p_out - p_frame;
+        if ((p_frame != p_decoder->p_buffer) && (p_decoder->length > 0))
+        {
+            memcpy(p_decoder->p_buffer, p_frame, p_decoder->length);
+        }
+    }
+
+    return err_code;
+}
+
+
+uint32_t slip_segments_encode(slip_segment_t * p_segments,
+                              uint32_t *       p_count,
+                              uint8_t const *  p_input,
+                              uint32_t         input_length)
+{
+    uint8_t *  p_in      = (uint8_t *)p_input;
+    uint8_t *  p_end     = p_in + input_length;
+    uint32_t   max_count = *p_count;
+    uint32_t   count     = 0;
+
+    if (max_count < 2)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    p_segments[count].p_data   = m_slip_end;
+    p_segments[count++].length = sizeof(m_slip_end);
+
+    while (p_in < p_end)
+    {
+        uint8_t * p_special = special_byte_find(p_in, p_end, false);
+
+        // One entry is kept for the final END.
+        if (p_special != p_in)
+        {
+            if ((count + 1) >= max_count)
+            {
+                return NRF_ERROR_NO_MEM;
+            }
+            p_segments[count].p_data   = p_in;
+            p_segments[count++].length = p_special - p_in;
+        }
+        if (p_special == p_end)
+        {
+            break;
+        }
+        if ((count + 1) >= max_count)
+        {
+            return NRF_ERROR_NO_MEM;
+        }
+        p_segments[count].p_data   = (*p_special == SLIP_END) ? m_slip_esc_end : m_slip_esc_esc;
+        p_segments[count++].length = sizeof(m_slip_esc_end);
+        p_in = p_special + 1;
+    }
+
+    p_segments[count].p_data   = m_slip_end;
+    p_segments[count++].length = sizeof(m_slip_end);
+
+    *p_count = count;
+    return NRF_SUCCESS;
+}
 #endif //NRF_MODULE_ENABLED(SLIP)
@@ -64,6 +64,90 @@ uint32_t slip_encode(uint8_t * p_output,  uint8_t * p_input, uint32_t input_leng
  */
 uint32_t slip_decoding_add_char(uint8_t c, buffer_t * p_buf, slip_state_t * current_state);
 
+/**@brief State of the chunk decoder. */
+typedef enum {
+    SLIP_DECODER_FRAME, /**< Decoding a frame. */
+    SLIP_DECODER_ESC,   /**< ESC received, the next byte is an escaped data byte. */
+    SLIP_DECODER_DROP,  /**< Dropping an invalid frame until the next END. */
+} slip_decoder_state_t;
+
+/**@brief Handler for decoded frames.
+ *
+ * @param[in] p_frame   Decoded frame. Only valid until the handler returns.
+ * @param[in] length    Length of the frame. Never 0.
+ * @param[in] p_context Context given to @ref slip_decoder_init.
+ */
+typedef void (*slip_frame_handler_t)(uint8_t * p_frame, uint32_t length, void * p_context);
+
+/**@brief Chunk decoder instance. The fields are internal. */
+typedef struct {
+    uint8_t *            p_buffer;      /**< Buffer for frames that are split over two or more chunks. */
+    uint32_t             buffer_size;   /**< Size of the buffer, which is also the maximum frame length. */
+    uint32_t             length;        /**< Decoded length of the split frame. */
+    slip_decoder_state_t state;         /**< Decoder state. */
+    slip_frame_handler_t frame_handler; /**< Handler for decoded frames. */
+    void *               p_context;     /**< Context passed to the handler. */
+} slip_decoder_t;
+
+/**@brief Part of an encoded frame. */
+typedef struct {
+    uint8_t const * p_data; /**< Data of the segment. */
+    uint32_t        length; /**< Length of the segment. */
+} slip_segment_t;
+
+/**@brief Initializes a chunk decoder.
+ *
+ * @param[out] p_decoder     Decoder instance.
+ * @param[in]  p_buffer      Buffer for frames that are split over chunks.
+ * @param[in]  buffer_size   Size of the buffer. Longer frames are dropped.
+ * @param[in]  frame_handler Handler for decoded frames.
+ * @param[in]  p_context     Context passed to the handler.
+ */
+void slip_decoder_init(slip_decoder_t *     p_decoder,
+                       uint8_t *            p_buffer,
+                       uint32_t             buffer_size,
+                       slip_frame_handler_t frame_handler,
+                       void *               p_context);
+
+/**@brief Decodes a chunk of received data, for example a filled UART DMA buffer.
+ *
+ * @details Frames are delimited by END, and END and ESC in the data are escaped (RFC1055). Empty
+ *          frames are skipped. The data is scanned a word at a time for END and ESC, so runs of
+ *          plain data cost a few instructions per four bytes.
+ *
+ *          Frames are decoded in place: the handler gets a pointer into the chunk, which is
+ *          modified. Only a frame that is split over chunks is copied, to the decoder buffer.
+ *
+ * @param[in]    p_decoder Decoder instance.
+ * @param[inout] p_chunk   Received data. Overwritten with decoded data.
+ * @param[in]    length    Length of the data.
+ *
+ * @retval NRF_SUCCESS            If the chunk was decoded.
+ * @retval NRF_ERROR_INVALID_DATA If the chunk was decoded, but a frame with an invalid escape
+ *                                sequence or longer than the buffer size was dropped.
+ */
+uint32_t slip_chunk_decode(slip_decoder_t * p_decoder, uint8_t * p_chunk, uint32_t length);
+
+/**@brief Encodes a frame into a list of segments, without copying the data.
+ *
+ * @details Runs of plain data point to the input. END delimiters and escape sequences point to
+ *          static buffers in RAM, so the segments can be sent with EasyDMA if the input is in RAM.
+ *          The frame starts and ends with END. A frame needs at most 3 + 2 * (number of END and
+ *          ESC bytes in the input) segments.
+ *
+ * @param[out]   p_segments   Segment list.
+ * @param[inout] p_count      In: number of entries in the list. Out: number of entries used.
+ * @param[in]    p_input      Frame data. Must stay valid until the segments are sent.
+ * @param[in]    input_length Length of the frame.
+ *
+ * @retval NRF_SUCCESS      If the frame was encoded.
+ * @retval NRF_ERROR_NO_MEM If the segment list is too short.
+ */
+uint32_t slip_segments_encode(slip_segment_t * p_segments,
+                              uint32_t *       p_count,
+                              uint8_t const *  p_input,
+                              uint32_t         input_length);
+
 
 
 #ifdef __cplusplus
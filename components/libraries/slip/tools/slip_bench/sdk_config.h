@@ -0,0 +1,20 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Configuration of the SLIP test and benchmark. */
+
+#ifndef SDK_CONFIG_H
+#define SDK_CONFIG_H
+
+#define SLIP_ENABLED 1
+
+#endif // SDK_CONFIG_H
@@ -0,0 +1,523 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* SLIP test and benchmark for a PC host.
+ *
+ * The test encodes rounds of random frames with many END and ESC bytes with
+ * slip_segments_encode(), joins the segments to a stream and decodes it with slip_chunk_decode()
+ * in chunks of 1 byte, 1 to 8 bytes and 1 to 700 bytes, so that chunks and words start at any
+ * alignment. It checks that:
+ * - every valid frame is delivered once, in order and intact, including frames of exactly the
+ *   decoder buffer size and frames split over many chunks,
+ * - frames longer than the buffer and frames with an invalid escape are dropped and reported as
+ *   NRF_ERROR_INVALID_DATA, and empty frames are skipped,
+ * - the output of slip_encode() for frames without END and ESC decodes to the same frames,
+ * - slip_segments_encode() reports NRF_ERROR_NO_MEM for a short segment list.
+ *
+ * The benchmark encodes and decodes random payload in frames of 20 to 250 bytes, as on the
+ * serialization link, and prints the throughput in MB of payload per second:
+ * - encode, byte per call: a function call per encoded byte, as app_uart_put() is used by
+ *   ser_phy_hci_slip.c, but without the FIFO,
+ * - encode, slip_encode(): the existing copying encoder,
+ * - encode, slip_segments_encode(): the segment list, without copying,
+ * - decode, byte per call: a function call per received byte with the escape state machine of
+ *   ser_phy_hci_slip.c,
+ * - decode, slip_chunk_decode(): whole received chunks, decoded in place.
+ * The last line is the share of CPU time for encoding plus decoding that the segment encoder and
+ * the chunk decoder save against the byte per call paths.
+ *
+ * Command line: mbytes=<MB of payload> chunk=<bytes per received chunk>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "nrf_error.h"
+#include "slip.h"
+
+
+#define MBYTES_DEFAULT      (8)
+#define CHUNK_DEFAULT       (256)
+#define TEST_ROUNDS         (200)
+#define TEST_FRAMES_MAX     (3000)
+#define TEST_FRAME_MAX      (300)                       // Decoder buffer size of the test.
+#define TEST_SEGMENTS_MAX   ((2 * TEST_FRAME_MAX) + 5)
+#define BENCH_FRAME_MIN     (20)
+#define BENCH_FRAME_MAX     (250)
+#define BENCH_SEGMENTS_MAX  ((2 * BENCH_FRAME_MAX) + 3)
+
+#define SLIP_END            (0xC0)
+#define SLIP_ESC            (0xDB)
+#define SLIP_ESC_END        (0xDC)
+#define SLIP_ESC_ESC        (0xDD)
+
+typedef enum
+{
+    FRAME_VALID,
+    FRAME_FULL,         // Exactly the decoder buffer size.
+    FRAME_TOO_LONG,     // One byte longer than the decoder buffer, dropped.
+    FRAME_BAD_ESCAPE,   // An escape sequence is corrupted, dropped.
+    FRAME_EMPTY_AFTER,  // Followed by an empty frame, which is skipped.
+} frame_kind_t;
+
+
+static uint8_t  m_frames[TEST_FRAMES_MAX][TEST_FRAME_MAX + 1];
+static uint32_t m_frame_lengths[TEST_FRAMES_MAX];
+static bool     m_frame_valid[TEST_FRAMES_MAX];
+static uint32_t m_frame_count;
+static uint32_t m_frame_next;       // Next frame the handler expects.
+static uint32_t m_frames_received;
+static uint32_t m_frames_bad;
+static uint8_t  m_split_buffer[TEST_FRAME_MAX];
+static uint8_t  m_stream[TEST_FRAMES_MAX * ((2 * (TEST_FRAME_MAX + 1)) + 3)];
+
+static uint8_t  m_rx_buffer[BENCH_FRAME_MAX];   // Byte per call decoder.
+static uint32_t m_rx_index;
+static bool     m_rx_escape;
+static volatile uint32_t m_sink;                // Keeps the compiler from dropping the work.
+
+static uint32_t m_mbytes = MBYTES_DEFAULT;
+static uint32_t m_chunk  = CHUNK_DEFAULT;
+static uint32_t m_rand   = 1;
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+
+static void check(bool condition, char const * p_what)
+{
+    m_checks++;
+    if (!condition)
+    {
+        m_failures++;
+        printf("FAILED: %s\n", p_what);
+    }
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static uint32_t rand_get(void)
+{
+    m_rand = (m_rand * 1103515245UL) + 12345UL;
+    return m_rand >> 8;
+}
+
+
+static void test_frame_handler(uint8_t * p_frame, uint32_t length, void * p_context)
+{
+    (void)p_context;
+
+    while ((m_frame_next < m_frame_count) && !m_frame_valid[m_frame_next])
+    {
+        m_frame_next++;
+    }
+    if ((m_frame_next >= m_frame_count)
+        || (length != m_frame_lengths[m_frame_next])
+        || (memcmp(p_frame, m_frames[m_frame_next], length) != 0))
+    {
+        m_frames_bad++;
+    }
+    m_frame_next++;
+    m_frames_received++;
+}
+
+
+/**@brief Function for encoding a frame with slip_segments_encode() and joining the segments. */
+static uint32_t segments_join(uint8_t * p_output, uint8_t const * p_input, uint32_t length)
+{
+    slip_segment_t segments[TEST_SEGMENTS_MAX];
+    uint32_t       count  = TEST_SEGMENTS_MAX;
+    uint32_t       offset = 0;
+
+    check(slip_segments_encode(segments, &count, p_input, length) == NRF_SUCCESS,
+          "segment encode");
+    for (uint32_t i = 0; i < count; i++)
+    {
+        memcpy(p_output + offset, segments[i].p_data, segments[i].length);
+        offset += segments[i].length;
+    }
+    return offset;
+}
+
+
+/**@brief Function for decoding a stream in chunks of random size.
+ *
+ * @return Number of chunks that reported NRF_ERROR_INVALID_DATA.
+ */
+static uint32_t stream_decode(uint32_t length, uint32_t chunk_max)
+{
+    slip_decoder_t decoder;
+    uint32_t       errors = 0;
+
+    slip_decoder_init(&decoder, m_split_buffer, sizeof(m_split_buffer), test_frame_handler, NULL);
+    m_frame_next      = 0;
+    m_frames_received = 0;
+    m_frames_bad      = 0;
+
+    for (uint32_t offset = 0; offset < length; )
+    {
+        uint32_t chunk = 1 + (rand_get() % chunk_max);
+
+        if (chunk > (length - offset))
+        {
+            chunk = length - offset;
+        }
+        if (slip_chunk_decode(&decoder, m_stream + offset, chunk) != NRF_SUCCESS)
+        {
+            errors++;
+        }
+        offset += chunk;
+    }
+    return errors;
+}
+
+
+static void round_trip_test(void)
+{
+    static uint32_t const chunk_max[] = {1, 8, 700};
+
+    for (uint32_t round = 0; round < TEST_ROUNDS; round++)
+    {
+        uint32_t length  = 0;
+        uint32_t dropped = 0;
+        uint32_t errors;
+
+        m_frame_count = 1000 + (rand_get() % (TEST_FRAMES_MAX - 1000));
+        for (uint32_t f = 0; f < m_frame_count; f++)
+        {
+            frame_kind_t kind = (frame_kind_t)(rand_get() % 20);
+            uint32_t     encoded;
+
+            if (kind > FRAME_EMPTY_AFTER)
+            {
+                kind = FRAME_VALID;
+            }
+            m_frame_lengths[f] = (kind == FRAME_FULL)     ? TEST_FRAME_MAX :
+                                 (kind == FRAME_TOO_LONG) ? (TEST_FRAME_MAX + 1) :
+                                                            (1 + (rand_get() % TEST_FRAME_MAX));
+            for (uint32_t i = 0; i < m_frame_lengths[f]; i++)
+            {
+                uint32_t r = rand_get() % 8;
+
+                m_frames[f][i] = (r == 0) ? SLIP_END : (r == 1) ? SLIP_ESC : (uint8_t)rand_get();
+            }
+            m_frame_valid[f] = (kind != FRAME_TOO_LONG);
+
+            encoded = segments_join(m_stream + length, m_frames[f], m_frame_lengths[f]);
+            if (kind == FRAME_BAD_ESCAPE)
+            {
+                uint8_t * p_esc = memchr(m_stream + length + 1, SLIP_ESC, encoded - 2);
+
+                if (p_esc != NULL)
+                {
+                    p_esc[1]         = 0x55;
+                    m_frame_valid[f] = false;
+                }
+            }
+            if (kind == FRAME_EMPTY_AFTER)
+            {
+                m_stream[length + encoded++] = SLIP_END;
+            }
+            if (!m_frame_valid[f])
+            {
+                dropped++;
+            }
+            length += encoded;
+        }
+
+        errors = stream_decode(length, chunk_max[round % 3]);
+        check((m_frames_received == (m_frame_count - dropped)) && (m_frames_bad == 0),
+              "all valid frames decoded once and intact");
+        check((dropped == 0) || (errors > 0), "dropped frames reported");
+    }
+
+    // The output of slip_encode() ends with two END bytes and decodes the same. It escapes END
+    // as END ESC_END, which serial DFU relies on, so the frames have no END or ESC bytes.
+    {
+        uint32_t length = 0;
+
+        m_frame_count = 100;
+        for (uint32_t f = 0; f < m_frame_count; f++)
+        {
+            m_frame_lengths[f] = 1 + (rand_get() % TEST_FRAME_MAX);
+            m_frame_valid[f]   = true;
+            for (uint32_t i = 0; i < m_frame_lengths[f]; i++)
+            {
+                m_frames[f][i] = (uint8_t)rand_get();
+                if ((m_frames[f][i] == SLIP_END) || (m_frames[f][i] == SLIP_ESC))
+                {
+                    m_frames[f][i] = 0;
+                }
+            }
+            length += slip_encode(m_stream + length, m_frames[f], m_frame_lengths[f],
+                                  2 * m_frame_lengths[f]);
+        }
+        check(stream_decode(length, 64) == 0, "slip_encode output decoded without errors");
+        check((m_frames_received == m_frame_count) && (m_frames_bad == 0),
+              "slip_encode output decoded");
+    }
+}
+
+
+static void segments_test(void)
+{
+    slip_segment_t segments[4];
+    uint32_t       count;
+    uint8_t        data[] = {1, SLIP_END, 2, SLIP_ESC, 3};
+
+    count = 4;
+    check(slip_segments_encode(segments, &count, data, sizeof(data)) == NRF_ERROR_NO_MEM,
+          "segment list too short");
+    count = 3;
+    check((slip_segments_encode(segments, &count, data, 1) == NRF_SUCCESS) && (count == 3),
+          "three segments for plain data");
+    count = 2;
+    check(slip_segments_encode(segments, &count, data, 1) == NRF_ERROR_NO_MEM,
+          "two segments too few for data");
+    count = 2;
+    check((slip_segments_encode(segments, &count, data, 0) == NRF_SUCCESS) && (count == 2),
+          "two segments for an empty frame");
+}
+
+
+/**@brief Function for decoding one received byte, as ser_phy_hci_slip.c does. */
+static __attribute__((noinline)) void byte_decode(uint8_t byte)
+{
+    if (byte == SLIP_END)
+    {
+        if (m_rx_index > 0)
+        {
+            m_sink    += m_rx_index;
+            m_rx_index = 0;
+        }
+        return;
+    }
+    if (byte == SLIP_ESC)
+    {
+        m_rx_escape = true;
+        return;
+    }
+    if (m_rx_escape)
+    {
+        m_rx_escape = false;
+        byte        = (byte == SLIP_ESC_END) ? SLIP_END : SLIP_ESC;
+    }
+    if (m_rx_index < sizeof(m_rx_buffer))
+    {
+        m_rx_buffer[m_rx_index++] = byte;
+    }
+}
+
+
+/**@brief Function for sending one encoded byte. Stands in for app_uart_put(). */
+static __attribute__((noinline)) void byte_send(uint8_t byte)
+{
+    m_sink += byte;
+}
+
+
+static void bench_frame_handler(uint8_t * p_frame, uint32_t length, void * p_context)
+{
+    (void)p_context;
+    m_sink += length + p_frame[0];
+}
+
+
+static double mbytes_per_s(uint32_t bytes, uint64_t ns)
+{
+    return ((double)bytes * 1000.0) / (double)ns;
+}
+
+
+static void bench(void)
+{
+    uint32_t         payload_size = m_mbytes << 20;
+    uint8_t *        p_payload    = malloc(payload_size);
+    uint8_t *        p_encoded    = malloc((2 * payload_size) + 4096);
+    uint32_t *       p_lengths    = malloc(((payload_size / BENCH_FRAME_MIN) + 1) * sizeof(uint32_t));
+    slip_segment_t   segments[BENCH_SEGMENTS_MAX];
+    slip_decoder_t   decoder;
+    uint32_t         frames   = 0;
+    uint32_t         encoded  = 0;
+    uint32_t         offset;
+    uint64_t         start_ns;
+    uint64_t         byte_encode_ns;
+    uint64_t         copy_encode_ns;
+    uint64_t         segment_encode_ns;
+    uint64_t         byte_decode_ns;
+    uint64_t         chunk_decode_ns;
+    double           saved;
+
+    if ((p_payload == NULL) || (p_encoded == NULL) || (p_lengths == NULL))
+    {
+        check(false, "benchmark buffers");
+        return;
+    }
+
+    for (uint32_t i = 0; i < payload_size; i++)
+    {
+        p_payload[i] = (uint8_t)rand_get();
+    }
+    for (offset = 0; offset < payload_size; offset += p_lengths[frames++])
+    {
+        p_lengths[frames] = BENCH_FRAME_MIN + (rand_get() % (BENCH_FRAME_MAX - BENCH_FRAME_MIN + 1));
+        if (p_lengths[frames] > (payload_size - offset))
+        {
+            p_lengths[frames] = payload_size - offset;
+        }
+    }
+
+    // Encode, a call per byte.
+    start_ns = host_time_ns();
+    offset   = 0;
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        byte_send(SLIP_END);
+        for (uint32_t i = 0; i < p_lengths[f]; i++)
+        {
+            uint8_t byte = p_payload[offset + i];
+
+            if (byte == SLIP_END)
+            {
+                byte_send(SLIP_ESC);
+                byte_send(SLIP_ESC_END);
+            }
+            else if (byte == SLIP_ESC)
+            {
+                byte_send(SLIP_ESC);
+                byte_send(SLIP_ESC_ESC);
+            }
+            else
+            {
+                byte_send(byte);
+            }
+        }
+        byte_send(SLIP_END);
+        offset += p_lengths[f];
+    }
+    byte_encode_ns = host_time_ns() - start_ns;
+
+    // Encode with slip_encode() into a buffer.
+    start_ns = host_time_ns();
+    offset   = 0;
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        encoded += slip_encode(p_encoded + encoded, p_payload + offset, p_lengths[f],
+                               2 * p_lengths[f]);
+        offset  += p_lengths[f];
+    }
+    copy_encode_ns = host_time_ns() - start_ns;
+
+    // Encode into segment lists.
+    start_ns = host_time_ns();
+    offset   = 0;
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        uint32_t count = BENCH_SEGMENTS_MAX;
+
+        (void)slip_segments_encode(segments, &count, p_payload + offset, p_lengths[f]);
+        m_sink += count;
+        offset += p_lengths[f];
+    }
+    segment_encode_ns = host_time_ns() - start_ns;
+
+    // Build the stream the receiver gets.
+    encoded = 0;
+    offset  = 0;
+    for (uint32_t f = 0; f < frames; f++)
+    {
+        uint32_t count = BENCH_SEGMENTS_MAX;
+
+        (void)slip_segments_encode(segments, &count, p_payload + offset, p_lengths[f]);
+        for (uint32_t s = 0; s < count; s++)
+        {
+            memcpy(p_encoded + encoded, segments[s].p_data, segments[s].length);
+            encoded += segments[s].length;
+        }
+        offset += p_lengths[f];
+    }
+
+    // Decode, a call per byte.
+    start_ns = host_time_ns();
+    for (uint32_t i = 0; i < encoded; i++)
+    {
+        byte_decode(p_encoded[i]);
+    }
+    byte_decode_ns = host_time_ns() - start_ns;
+
+    // Decode in chunks, in place.
+    slip_decoder_init(&decoder, m_split_buffer, BENCH_FRAME_MAX, bench_frame_handler, NULL);
+    start_ns = host_time_ns();
+    for (uint32_t i = 0; i < encoded; i += m_chunk)
+    {
+        uint32_t chunk = ((encoded - i) < m_chunk) ? (encoded - i) : m_chunk;
+
+        check(slip_chunk_decode(&decoder, p_encoded + i, chunk) == NRF_SUCCESS, "chunk decode");
+    }
+    chunk_decode_ns = host_time_ns() - start_ns;
+
+    saved = 1.0 - ((double)(segment_encode_ns + chunk_decode_ns)
+                   / (double)(byte_encode_ns + byte_decode_ns));
+
+    printf("%u MB of payload in %u frames, %u byte chunks\n", m_mbytes, frames, m_chunk);
+    printf("encode, byte per call            %7.1f MB/s\n", mbytes_per_s(payload_size, byte_encode_ns));
+    printf("encode, slip_encode()            %7.1f MB/s\n", mbytes_per_s(payload_size, copy_encode_ns));
+    printf("encode, slip_segments_encode()   %7.1f MB/s\n", mbytes_per_s(payload_size, segment_encode_ns));
+    printf("decode, byte per call            %7.1f MB/s\n", mbytes_per_s(payload_size, byte_decode_ns));
+    printf("decode, slip_chunk_decode()      %7.1f MB/s\n", mbytes_per_s(payload_size, chunk_decode_ns));
+    printf("encode + decode CPU time saved   %5.0f %%\n", 100.0 * saved);
+
+    free(p_payload);
+    free(p_encoded);
+    free(p_lengths);
+}
+
+
+int main(int argc, char * argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "mbytes=", 7) == 0)
+        {
+            m_mbytes = strtoul(argv[i] + 7, NULL, 0);
+        }
+        else if (strncmp(argv[i], "chunk=", 6) == 0)
+        {
+            m_chunk = strtoul(argv[i] + 6, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [mbytes=<n>] [chunk=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((m_mbytes < 1) || (m_mbytes > 256) || (m_chunk < 1))
+    {
+        fprintf(stderr, "mbytes must be 1 to 256, chunk at least 1\n");
+        return 2;
+    }
+
+    round_trip_test();
+    segments_test();
+    bench();
+
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -31,6 +31,12 @@
  *          This will be the case, for example, when stopping a timer from a time-out handler when not using
  *          the scheduler.
  *
+ * @details app_timer_wheel.c can be compiled instead of app_timer.c. It keeps the running timers
+ *          in a hierarchical timing wheel and starts and stops timers directly in the caller's
+ *          context, in constant time, without the operation queue and SWI0. The op_queue_size
+ *          and buffer of APP_TIMER_INIT() are then unused, and app_timer_op_queue_utilization_get()
+ *          returns 0. Use it when many timers run at the same time.
+ *
  * @details Use the USE_SCHEDULER parameter of the APP_TIMER_INIT() macro to select if the
  *          @ref app_scheduler should be used or not. Even if the scheduler is
  *          not used, app_timer.h will include app_scheduler.h, so when
@@ -57,9 +63,9 @@ extern "C" {
 #ifdef RTX
 #define APP_TIMER_NODE_SIZE          40                         /**< Size of app_timer.timer_node_t (used to allocate data). */
 #else
-#define APP_TIMER_NODE_SIZE          32                         /**< Size of app_timer.timer_node_t (used to allocate data). */
+#define APP_TIMER_NODE_SIZE          (4 * sizeof(uint32_t) + 4 * sizeof(void *)) /**< Size of app_timer.timer_node_t (used to allocate data). 32 bytes on the nRF5; the mode and running flags take a pointer slot on a 64-bit host. */
 #endif // RTX
-#define APP_TIMER_USER_OP_SIZE       24                         /**< Size of app_timer.timer_user_op_t (only for use inside APP_TIMER_BUF_SIZE()). */
+#define APP_TIMER_USER_OP_SIZE       (2 * sizeof(uint32_t) + 4 * sizeof(void *)) /**< Size of app_timer.timer_user_op_t (only for use inside APP_TIMER_BUF_SIZE()). 24 bytes on the nRF5. */
 
 /**@brief Compute number of bytes required to hold the application timer data structures.
  *
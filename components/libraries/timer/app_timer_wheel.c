@@ -0,0 +1,787 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Timing wheel backend of app_timer. Compile this file instead of app_timer.c.
+ *
+ * Running timers are kept in a hierarchical timing wheel: WHEEL_LEVELS levels of WHEEL_SLOTS
+ * slots. A slot on level k covers WHEEL_SLOTS^k ticks, so the wheel spans 2^25 ticks, more than
+ * the 24-bit RTC1 counter. A timer is put on the lowest level whose span reaches its expiry, in
+ * the slot that holds the expiry time. When the wheel time reaches the start of a slot on level
+ * k > 0, the timers of the slot are moved down (cascaded) to the lower levels. When it reaches a
+ * slot on level 0, all timers in the slot expire.
+ *
+ * Each slot is a list with back links, and each level has a bitmap of non-empty slots. Starting
+ * and stopping a timer is therefore a constant time operation, and is done directly in the
+ * caller's context inside a critical region. No operation queue or SWI interrupt is used. The
+ * next wheel event is found from the bitmaps, and only that point in time is programmed to the
+ * RTC1 compare register, so the wheel does not tick when nothing happens.
+ *
+ * Timer handlers are run from the RTC1 interrupt, one slot at a time in order of expiry, with
+ * interrupts enabled. */
+
+#include "sdk_common.h"
+#if NRF_MODULE_ENABLED(APP_TIMER)
+#include "app_timer.h"
+#include "nrf.h"
+#include "app_error.h"
+#include "nrf_assert.h"
+#include "nrf_delay.h"
+#include "app_util_platform.h"
+
+#define RTC1_IRQ_PRI            APP_IRQ_PRIORITY_LOWEST                     /**< Priority of the RTC1 interrupt (used for checking for timeouts and executing timeout handlers). */
+
+#define MAX_RTC_COUNTER_VAL     0x00FFFFFF                                  /**< Maximum value of the RTC counter. */
+
+#define RTC_COMPARE_OFFSET_MIN  3                                           /**< Minimum offset between the current RTC counter value and the Capture Compare register. Although the nRF51 Series User Specification recommends this value to be 2, we use 3 to be safer.*/
+
+#define MAX_RTC_TASKS_DELAY     47                                          /**< Maximum delay until an RTC task is executed. */
+
+#define MAX_COMPARE_TICKS       (MAX_RTC_COUNTER_VAL / 2)                   /**< Longest time programmed to the compare register. Keeps the extended time from missing a counter wrap. */
+
+#define WHEEL_SLOT_BITS         5                                           /**< Number of bits of the time used as slot index on each level. */
+#define WHEEL_SLOTS             (1UL << WHEEL_SLOT_BITS)                    /**< Number of slots per level. Must match the bitmap width. */
+#define WHEEL_SLOT_MASK         (WHEEL_SLOTS - 1)
+#define WHEEL_LEVELS            5                                           /**< Number of levels. */
+#define WHEEL_SPAN_BITS         (WHEEL_SLOT_BITS * WHEEL_LEVELS)            /**< The wheel holds timers up to 2^WHEEL_SPAN_BITS ticks ahead of the wheel time. */
+
+#define SLOT_NONE               0xFF                                        /**< Timer is not linked. */
+#define SLOT_EXPIRED            0xFE                                        /**< Timer is linked in the expired list. */
+
+STATIC_ASSERT(WHEEL_SLOTS == 32);
+STATIC_ASSERT(WHEEL_LEVELS * WHEEL_SLOTS < SLOT_EXPIRED);
+// The wheel time lags the RTC by at most MAX_COMPARE_TICKS, and the timeout is limited to
+// MAX_RTC_COUNTER_VAL.
+STATIC_ASSERT((MAX_COMPARE_TICKS + MAX_RTC_COUNTER_VAL) < (1UL << WHEEL_SPAN_BITS));
+
+#define MODULE_INITIALIZED (m_initialized) /**< Macro designating whether the module has been initialized properly. */
+
+/**@brief Timer node type. The nodes are linked in the slots of the wheel. */
+typedef struct timer_node_s
+{
+    struct timer_node_s *       p_next;                                     /**< Next node in the slot. */
+    struct timer_node_s **      pp_prev;                                    /**< Pointer to the pointer to this node. */
+    uint32_t                    expiry;                                     /**< Expiry time, in extended ticks. */
+    uint32_t                    ticks_periodic_interval;                    /**< Timer period (for repeating timers). */
+    app_timer_timeout_handler_t p_timeout_handler;                          /**< Pointer to function to be executed when the timer expires. */
+    void *                      p_context;                                  /**< General purpose pointer. Will be passed to the timeout handler when the timer expires. */
+    uint8_t                     mode;                                       /**< Timer mode. */
+    uint8_t                     slot;                                       /**< Level * WHEEL_SLOTS + slot index, @ref SLOT_EXPIRED or @ref SLOT_NONE. */
+    bool                        is_running;                                 /**< True if timer is running, False otherwise. */
+} timer_node_t;
+
+STATIC_ASSERT(sizeof(timer_node_t) <= sizeof(app_timer_t));
+
+static timer_node_t *                m_slots[WHEEL_LEVELS][WHEEL_SLOTS];       /**< Lists of timers per slot. */
+static uint32_t                      m_slot_bitmap[WHEEL_LEVELS];              /**< Non-empty slots per level. */
+static timer_node_t *                mp_expired_head;                          /**< Timers of the slot being expired, with handlers not yet run. */
+static uint32_t                      m_wheel_ticks;                            /**< Wheel time. All slots before it have been processed. */
+static uint32_t                      m_ticks_ext;                              /**< RTC1 counter extended to 32 bits. */
+static uint32_t                      m_ticks_latest;                           /**< Last read RTC counter value. */
+static app_timer_evt_schedule_func_t m_evt_schedule_func;                      /**< Pointer to function for propagating timeout events to the scheduler. */
+static bool                          m_rtc1_running;                           /**< Boolean indicating if RTC1 is running. */
+static bool                          m_initialized;                            /**< Boolean indicating if the module is initialized. */
+
+/**@brief Function for initializing the RTC1 counter.
+ *
+ * @param[in] prescaler   Value of the RTC1 PRESCALER register. Set to 0 for no prescaling.
+ */
+static void rtc1_init(uint32_t prescaler)
+{
+    NRF_RTC1->PRESCALER = prescaler;
+    NVIC_SetPriority(RTC1_IRQn, RTC1_IRQ_PRI);
+}
+
+
+/**@brief Function for starting the RTC1 timer.
+ */
+static void rtc1_start(void)
+{
+    NRF_RTC1->EVTENSET = RTC_EVTEN_COMPARE0_Msk;
+    NRF_RTC1->INTENSET = RTC_INTENSET_COMPARE0_Msk;
+
+    NVIC_ClearPendingIRQ(RTC1_IRQn);
+    NVIC_EnableIRQ(RTC1_IRQn);
+
+    NRF_RTC1->TASKS_START = 1;
+    nrf_delay_us(MAX_RTC_TASKS_DELAY);
+
+    m_rtc1_running = true;
+}
+
+
+/**@brief Function for stopping the RTC1 timer.
+ */
+static void rtc1_stop(void)
+{
+    NVIC_DisableIRQ(RTC1_IRQn);
+
+    NRF_RTC1->EVTENCLR = RTC_EVTEN_COMPARE0_Msk;
+    NRF_RTC1->INTENCLR = RTC_INTENSET_COMPARE0_Msk;
+
+    NRF_RTC1->TASKS_STOP = 1;
+    nrf_delay_us(MAX_RTC_TASKS_DELAY);
+
+    NRF_RTC1->TASKS_CLEAR = 1;
+    m_ticks_latest        = 0;
+    nrf_delay_us(MAX_RTC_TASKS_DELAY);
+
+    m_rtc1_running = false;
+}
+
+
+/**@brief Function for returning the current value of the RTC1 counter.
+ *
+ * @return     Current value of the RTC1 counter.
+ */
+static __INLINE uint32_t rtc1_counter_get(void)
+{
+    return NRF_RTC1->COUNTER;
+}
+
+
+/**@brief Function for computing the difference between two RTC1 counter values.
+ *
+ * @return     Number of ticks elapsed from ticks_old to ticks_now.
+ */
+static __INLINE uint32_t ticks_diff_get(uint32_t ticks_now, uint32_t ticks_old)
+{
+    return ((ticks_now - ticks_old) & MAX_RTC_COUNTER_VAL);
+}
+
+
+/**@brief Function for setting the RTC1 Capture Compare register 0, and enabling the corresponding
+ *        event.
+ *
+ * @param[in] value   New value of Capture Compare register 0.
+ */
+static __INLINE void rtc1_compare0_set(uint32_t value)
+{
+    NRF_RTC1->CC[0] = value;
+}
+
+
+/**@brief Function for getting the current time in extended ticks. Must be called in a critical
+ *        region.
+ */
+static uint32_t ticks_ext_get(void)
+{
+    uint32_t counter = rtc1_counter_get();
+
+    m_ticks_ext   += ticks_diff_get(counter, m_ticks_latest);
+    m_ticks_latest = counter;
+
+    return m_ticks_ext;
+}
+
+
+/**@brief Function for finding the lowest set bit of a non-zero bitmap. */
+static __INLINE uint32_t bit_first_get(uint32_t bitmap)
+{
+#if defined(__CORTEX_M) && (__CORTEX_M >= 0x03)
+    return __CLZ(__RBIT(bitmap));
+#else
+    static const uint8_t debruijn[32] =
+    {
+        0,  1,  28, 2,  29, 14, 24, 3,  30, 22, 20, 15, 25, 17, 4,  8,
+        31, 27, 13, 23, 21, 19, 16, 7,  26, 12, 18, 6,  11, 5,  10, 9
+    };
+    return debruijn[(uint32_t)((bitmap & (0 - bitmap)) * 0x077CB531UL) >> 27];
+#endif
+}
+
+
+/**@brief Function for linking a timer in a list.
+ *
+ * @param[in]  pp_head   Pointer to the head of the list.
+ * @param[in]  p_timer   Timer to link.
+ * @param[in]  slot      Slot number to store in the timer.
+ */
+static __INLINE void node_link(timer_node_t ** pp_head, timer_node_t * p_timer, uint8_t slot)
+{
+    p_timer->p_next = *pp_head;
+    if (p_timer->p_next != NULL)
+    {
+        p_timer->p_next->pp_prev = &p_timer->p_next;
+    }
+    *pp_head         = p_timer;
+    p_timer->pp_prev = pp_head;
+    p_timer->slot    = slot;
+}
+
+
+/**@brief Function for unlinking a timer from the wheel or the expired list, if it is linked.
+ *
+ * @param[in]  p_timer   Timer to unlink.
+ */
+static void node_unlink(timer_node_t * p_timer)
+{
+    uint8_t slot = p_timer->slot;
+
+    if (slot == SLOT_NONE)
+    {
+        return;
+    }
+
+    *p_timer->pp_prev = p_timer->p_next;
+    if (p_timer->p_next != NULL)
+    {
+        p_timer->p_next->pp_prev = p_timer->pp_prev;
+    }
+    p_timer->slot = SLOT_NONE;
+
+    if ((slot != SLOT_EXPIRED) && (m_slots[slot / WHEEL_SLOTS][slot % WHEEL_SLOTS] == NULL))
+    {
+        m_slot_bitmap[slot / WHEEL_SLOTS] &= ~(1UL << (slot % WHEEL_SLOTS));
+    }
+}
+
+
+/**@brief Function for putting a timer in the wheel according to its expiry time.
+ *
+ * @details The timer goes to the lowest level whose span reaches the expiry time. A timer that is
+ *          already due goes to the slot of the current wheel time.
+ *
+ * @param[in]  p_timer   Timer to insert.
+ */
+static void wheel_insert(timer_node_t * p_timer)
+{
+    uint32_t expiry = p_timer->expiry;
+    uint32_t delta  = expiry - m_wheel_ticks;
+    uint32_t level  = 0;
+    uint32_t index;
+
+    if ((int32_t)delta < 0)
+    {
+        expiry = m_wheel_ticks;
+        delta  = 0;
+    }
+
+    ASSERT(delta < (1UL << WHEEL_SPAN_BITS));
+
+    while ((level < (WHEEL_LEVELS - 1)) && (delta >= (1UL << (WHEEL_SLOT_BITS * (level + 1)))))
+    {
+        level++;
+    }
+
+    index = (expiry >> (WHEEL_SLOT_BITS * level)) & WHEEL_SLOT_MASK;
+
+    node_link(&m_slots[level][index], p_timer, (uint8_t)(level * WHEEL_SLOTS + index));
+    m_slot_bitmap[level] |= (1UL << index);
+}
+
+
+/**@brief Function for finding the next time at which the wheel has work to do.
+ *
+ * @details That is the start of the first non-empty slot, on any level, at or after the wheel
+ *          time. For level 0 the timers of the slot expire, for the other levels they are
+ *          cascaded.
+ *
+ * @param[out] p_ticks   Time of the next event, in extended ticks.
+ *
+ * @return     True if the wheel has an event, false if it is empty.
+ */
+static bool wheel_next_event_get(uint32_t * p_ticks)
+{
+    bool     found    = false;
+    uint32_t min_diff = 0;
+    uint32_t level;
+
+    for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+        uint32_t bitmap = m_slot_bitmap[level];
+
+        if (bitmap != 0)
+        {
+            uint32_t shift = WHEEL_SLOT_BITS * level;
+            // First slot boundary of this level at or after the wheel time, in slot units.
+            uint32_t base  = (m_wheel_ticks + ((1UL << shift) - 1)) >> shift;
+            uint32_t rot   = base & WHEEL_SLOT_MASK;
+            uint32_t diff;
+
+            bitmap = (bitmap >> rot) | (bitmap << ((WHEEL_SLOTS - rot) & WHEEL_SLOT_MASK));
+            diff   = ((base + bit_first_get(bitmap)) << shift) - m_wheel_ticks;
+
+            if (!found || (diff < min_diff))
+            {
+                min_diff = diff;
+                found    = true;
+            }
+        }
+    }
+
+    *p_ticks = m_wheel_ticks + min_diff;
+    return found;
+}
+
+
+/**@brief Function for processing the slots that start at the wheel time.
+ *
+ * @details Slots on the upper levels are cascaded, from the top down, so that their timers can
+ *          land in the lower level slots of the same time. The timers of the level 0 slot are
+ *          moved to the expired list. The wheel time is advanced by one tick.
+ */
+static void wheel_tick_process(void)
+{
+    uint32_t ticks = m_wheel_ticks;
+    int32_t  level;
+    uint32_t index;
+
+    for (level = WHEEL_LEVELS - 1; level > 0; level--)
+    {
+        uint32_t shift = WHEEL_SLOT_BITS * level;
+
+        if ((ticks & ((1UL << shift) - 1)) != 0)
+        {
+            continue;
+        }
+
+        index = (ticks >> shift) & WHEEL_SLOT_MASK;
+        if (m_slot_bitmap[level] & (1UL << index))
+        {
+            timer_node_t * p_timer = m_slots[level][index];
+
+            m_slots[level][index] = NULL;
+            m_slot_bitmap[level] &= ~(1UL << index);
+
+            while (p_timer != NULL)
+            {
+                timer_node_t * p_next = p_timer->p_next;
+
+                wheel_insert(p_timer);
+                p_timer = p_next;
+            }
+        }
+    }
+
+    index = ticks & WHEEL_SLOT_MASK;
+    if (m_slot_bitmap[0] & (1UL << index))
+    {
+        timer_node_t * p_timer = m_slots[0][index];
+
+        ASSERT(mp_expired_head == NULL);
+
+        m_slots[0][index] = NULL;
+        m_slot_bitmap[0] &= ~(1UL << index);
+
+        mp_expired_head  = p_timer;
+        p_timer->pp_prev = &mp_expired_head;
+        for (; p_timer != NULL; p_timer = p_timer->p_next)
+        {
+            p_timer->slot = SLOT_EXPIRED;
+        }
+    }
+
+    m_wheel_ticks = ticks + 1;
+}
+
+
+/**@brief Function for checking if the wheel and the expired list are empty. */
+static __INLINE bool wheel_is_empty(void)
+{
+    uint32_t level;
+
+    for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+        if (m_slot_bitmap[level] != 0)
+        {
+            return false;
+        }
+    }
+    return (mp_expired_head == NULL);
+}
+
+
+/**@brief Function for scheduling a check for timeouts by generating a RTC1 interrupt.
+ */
+static void timer_timeouts_check_sched(void)
+{
+    NVIC_SetPendingIRQ(RTC1_IRQn);
+}
+
+
+/**@brief Function for updating the Capture Compare register. Must be called in a critical region.
+ */
+static void compare_reg_update(void)
+{
+    uint32_t next_ticks;
+    uint32_t ticks_to_expire;
+    uint32_t cc;
+
+    if (!wheel_next_event_get(&next_ticks))
+    {
+#if (APP_TIMER_KEEPS_RTC_ACTIVE == 0)
+        if (m_rtc1_running && (mp_expired_head == NULL))
+        {
+            // No timers are running, stop RTC
+            rtc1_stop();
+        }
+#endif //(APP_TIMER_KEEPS_RTC_ACTIVE == 0)
+        return;
+    }
+
+    if (!m_rtc1_running)
+    {
+        // No timers were already running, start RTC
+        rtc1_start();
+    }
+
+    ticks_to_expire = next_ticks - ticks_ext_get();
+    if ((int32_t)ticks_to_expire <= 0)
+    {
+        timer_timeouts_check_sched();
+        return;
+    }
+    if (ticks_to_expire < RTC_COMPARE_OFFSET_MIN)
+    {
+        ticks_to_expire = RTC_COMPARE_OFFSET_MIN;
+    }
+    else if (ticks_to_expire > MAX_COMPARE_TICKS)
+    {
+        ticks_to_expire = MAX_COMPARE_TICKS;
+    }
+
+    cc = (m_ticks_latest + ticks_to_expire) & MAX_RTC_COUNTER_VAL;
+    rtc1_compare0_set(cc);
+
+    if ((ticks_diff_get(rtc1_counter_get(), m_ticks_latest) + RTC_COMPARE_OFFSET_MIN)
+        >
+        ticks_to_expire)
+    {
+        // The counter may have passed the compare value while it was written, so the COMPARE
+        // event may not be triggered. Pend the interrupt instead.
+        timer_timeouts_check_sched();
+    }
+}
+
+
+/**@brief Function for executing an application timeout handler, either by calling it directly, or
+ *        by passing an event to the @ref app_scheduler.
+ *
+ * @param[in]  timeout_handler   Handler of the expired timer.
+ * @param[in]  p_context         Context of the expired timer.
+ */
+static void timeout_handler_exec(app_timer_timeout_handler_t timeout_handler, void * p_context)
+{
+    if (m_evt_schedule_func != NULL)
+    {
+        uint32_t err_code = m_evt_schedule_func(timeout_handler, p_context);
+        APP_ERROR_CHECK(err_code);
+    }
+    else
+    {
+        timeout_handler(p_context);
+    }
+}
+
+
+/**@brief Function for running the handlers of the timers in the expired list.
+ *
+ * @details Repeating timers are put back in the wheel before their handler runs, so the handler
+ *          can stop them. Handlers run outside the critical region.
+ */
+static void expired_timers_handle(void)
+{
+    for (;;)
+    {
+        timer_node_t *              p_timer;
+        app_timer_timeout_handler_t timeout_handler = NULL;
+        void *                      p_context       = NULL;
+
+        CRITICAL_REGION_ENTER();
+        p_timer = mp_expired_head;
+        if (p_timer != NULL)
+        {
+            node_unlink(p_timer);
+
+            timeout_handler = p_timer->p_timeout_handler;
+            p_context       = p_timer->p_context;
+
+            if (p_timer->ticks_periodic_interval != 0)
+            {
+                p_timer->expiry += p_timer->ticks_periodic_interval;
+                wheel_insert(p_timer);
+            }
+            else
+            {
+                p_timer->is_running = false;
+            }
+        }
+        CRITICAL_REGION_EXIT();
+
+        if (p_timer == NULL)
+        {
+            break;
+        }
+
+        timeout_handler_exec(timeout_handler, p_context);
+    }
+}
+
+
+/**@brief Function for handling the RTC1 interrupt.
+ *
+ * @details Advances the wheel to the current time, one event at a time, and executes timeout
+ *          handlers for expired timers.
+ */
+void RTC1_IRQHandler(void)
+{
+    uint32_t ticks_now;
+
+    // Clear all events (also unexpected ones)
+    NRF_RTC1->EVENTS_COMPARE[0] = 0;
+    NRF_RTC1->EVENTS_COMPARE[1] = 0;
+    NRF_RTC1->EVENTS_COMPARE[2] = 0;
+    NRF_RTC1->EVENTS_COMPARE[3] = 0;
+    NRF_RTC1->EVENTS_TICK       = 0;
+    NRF_RTC1->EVENTS_OVRFLW     = 0;
+
+    CRITICAL_REGION_ENTER();
+    ticks_now = ticks_ext_get();
+    CRITICAL_REGION_EXIT();
+
+    for (;;)
+    {
+        bool     has_event;
+        uint32_t next_ticks;
+
+        CRITICAL_REGION_ENTER();
+        has_event = wheel_next_event_get(&next_ticks);
+        if ((int32_t)(ticks_now - m_wheel_ticks) < 0)
+        {
+            // A timer was started on an empty wheel, which moved the wheel time past ticks_now.
+            has_event = false;
+        }
+        else if (!has_event || ((next_ticks - m_wheel_ticks) > (ticks_now - m_wheel_ticks)))
+        {
+            // Nothing happens until ticks_now.
+            m_wheel_ticks = ticks_now + 1;
+            has_event     = false;
+        }
+        else
+        {
+            m_wheel_ticks = next_ticks;
+            wheel_tick_process();
+        }
+        CRITICAL_REGION_EXIT();
+
+        if (!has_event)
+        {
+            break;
+        }
+
+        expired_timers_handle();
+    }
+
+    CRITICAL_REGION_ENTER();
+    compare_reg_update();
+    CRITICAL_REGION_EXIT();
+}
+
+
+uint32_t app_timer_init(uint32_t                      prescaler,
+                        uint8_t                       op_queue_size,
+                        void *                        p_buffer,
+                        app_timer_evt_schedule_func_t evt_schedule_func)
+{
+    UNUSED_PARAMETER(op_queue_size);
+
+    NRF_CLOCK->TASKS_LFCLKSTART = 1;
+    while (NRF_CLOCK->EVENTS_LFCLKSTARTED == 0);
+
+    // The operation queue buffer is not used, but is checked like in the list backend.
+    if (!is_word_aligned(p_buffer))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (p_buffer == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+
+    // Stop RTC to prevent any running timers from expiring (in case of reinitialization)
+    rtc1_stop();
+
+    m_evt_schedule_func = evt_schedule_func;
+
+    memset(m_slots, 0, sizeof(m_slots));
+    memset(m_slot_bitmap, 0, sizeof(m_slot_bitmap));
+    mp_expired_head = NULL;
+    m_ticks_ext     = 0;
+    m_wheel_ticks   = 0;
+
+    rtc1_init(prescaler);
+
+    m_ticks_latest = rtc1_counter_get();
+    m_initialized  = true;
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_create(app_timer_id_t const *      p_timer_id,
+                          app_timer_mode_t            mode,
+                          app_timer_timeout_handler_t timeout_handler)
+{
+    // Check state and parameters
+    VERIFY_MODULE_INITIALIZED();
+
+    if (timeout_handler == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (p_timer_id == NULL)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (((timer_node_t*)*p_timer_id)->is_running)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    timer_node_t * p_node     = (timer_node_t *)*p_timer_id;
+    p_node->is_running        = false;
+    p_node->slot              = SLOT_NONE;
+    p_node->mode              = (uint8_t)mode;
+    p_node->p_timeout_handler = timeout_handler;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+    timer_node_t * p_node = (timer_node_t*)timer_id;
+
+    // Check state and parameters
+    VERIFY_MODULE_INITIALIZED();
+
+    if (timer_id == 0)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    if ((timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS) || (timeout_ticks > MAX_RTC_COUNTER_VAL))
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (p_node->p_timeout_handler == NULL)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    CRITICAL_REGION_ENTER();
+    // A second start of a running timer is ignored.
+    if (!p_node->is_running)
+    {
+        uint32_t ticks_now = ticks_ext_get();
+
+        if (wheel_is_empty())
+        {
+            // Nothing to process before now, so the wheel time can jump ahead.
+            m_wheel_ticks = ticks_now;
+        }
+
+        p_node->expiry                  = ticks_now + timeout_ticks;
+        p_node->ticks_periodic_interval = (p_node->mode == APP_TIMER_MODE_REPEATED) ?
+                                          timeout_ticks : 0;
+        p_node->p_context               = p_context;
+        p_node->is_running              = true;
+
+        wheel_insert(p_node);
+        compare_reg_update();
+    }
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_stop(app_timer_id_t timer_id)
+{
+    timer_node_t * p_node = (timer_node_t*)timer_id;
+    // Check state and parameters
+    VERIFY_MODULE_INITIALIZED();
+
+    if ((timer_id == NULL) || (p_node->p_timeout_handler == NULL))
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+
+    // The compare register is left as it is. If it was set for this timer, the interrupt finds
+    // nothing to do and sets it for the next one.
+    CRITICAL_REGION_ENTER();
+    node_unlink(p_node);
+    p_node->is_running = false;
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_stop_all(void)
+{
+    uint32_t level;
+    uint32_t index;
+
+    // Check state
+    VERIFY_MODULE_INITIALIZED();
+
+    for (level = 0; level < WHEEL_LEVELS; level++)
+    {
+        for (index = 0; index < WHEEL_SLOTS; index++)
+        {
+            CRITICAL_REGION_ENTER();
+            while (m_slots[level][index] != NULL)
+            {
+                timer_node_t * p_timer = m_slots[level][index];
+
+                node_unlink(p_timer);
+                p_timer->is_running = false;
+            }
+            CRITICAL_REGION_EXIT();
+        }
+    }
+
+    CRITICAL_REGION_ENTER();
+    while (mp_expired_head != NULL)
+    {
+        timer_node_t * p_timer = mp_expired_head;
+
+        node_unlink(p_timer);
+        p_timer->is_running = false;
+    }
+    CRITICAL_REGION_EXIT();
+
+    return NRF_SUCCESS;
+}
+
+
+uint32_t app_timer_cnt_get(void)
+{
+    return rtc1_counter_get();
+}
+
+
+uint32_t app_timer_cnt_diff_compute(uint32_t   ticks_to,
+                                    uint32_t   ticks_from,
+                                    uint32_t * p_ticks_diff)
+{
+    *p_ticks_diff = ticks_diff_get(ticks_to, ticks_from);
+    return NRF_SUCCESS;
+}
+
+#if APP_TIMER_WITH_PROFILER
+uint8_t app_timer_op_queue_utilization_get(void)
+{
+    // Operations are not queued in this backend.
+    return 0;
+}
+#endif
+#endif //NRF_MODULE_ENABLED(APP_TIMER)
@@ -0,0 +1,525 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* app_timer simulation and benchmark for a PC host.
+ *
+ * RTC1 and the NVIC are simulated. The counter only moves when the main loop lets time pass,
+ * and an interrupt that is pending and enabled runs between calls of the main loop, so the
+ * backends run as they would with all interrupts on one priority. The tick count since the start
+ * is kept in 64 bits, so the 24-bit counter wrap and the 32-bit wrap of the wheel time are both
+ * crossed.
+ *
+ * The first part lets one repeating timer run up to 2^27 ticks before the 32-bit wrap. Then it
+ * checks that:
+ * - 256 timers, half of them repeating, with timeouts from 5 to 0xFFFFFF ticks, started and
+ *   stopped at random, also from the timeout handlers with app_timer_wheel.c, and sometimes all
+ *   stopped at once every STOP_ALL_STEPS operations,
+ * - never expire early, nor after they were stopped, and at most EXPIRY_LATE_MAX ticks late,
+ * - and that after the repeated timers are stopped, the single shots expire, and then no timer
+ *   expires after app_timer_stop_all().
+ *
+ * The second part runs n timers with long timeouts, and times a start and a stop of other timers.
+ * Then it runs n repeating timers with short periods and times each expiry. Both times are in ns
+ * and include the simulated interrupt entries.
+ *
+ * Command line: steps=<random operations> timers=<largest n>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "nrf.h"
+#include "nrf_error.h"
+#include "app_timer.h"
+
+
+#define STEPS_DEFAULT       (20000)
+#define TIMERS_DEFAULT      (2048)
+#define TIMERS_MAX          (16384)
+#define CHECKED_TIMERS      (256)
+#define BENCH_EXTRA_TIMERS  (64)
+#define BENCH_OPS           (200000)
+#define BENCH_EXPIRIES      (200000)
+#define OP_QUEUE_SIZE       (255)
+#define STOP_ALL_STEPS      (250)
+#define RTC_COUNTER_MASK    (0x00FFFFFF)
+#define WRAP_TICKS          (1ULL << 32)
+#define WRAP_MARGIN_TICKS   (1ULL << 27)
+
+#ifdef APP_TIMER_BENCH_LIST
+#define BACKEND_NAME        "app_timer.c"
+#define EXPIRY_LATE_MAX     (4)         // Measured with this test.
+#else
+#define BACKEND_NAME        "app_timer_wheel.c"
+#define EXPIRY_LATE_MAX     (2)         // The RTC_COMPARE_OFFSET_MIN clamp of the compare register.
+#endif
+
+NRF_RTC_Type   app_timer_bench_rtc1;
+NRF_CLOCK_Type app_timer_bench_clock = { .EVENTS_LFCLKSTARTED = 1 };
+
+void RTC1_IRQHandler(void);
+#ifdef APP_TIMER_BENCH_LIST
+void SWI0_IRQHandler(void);
+#endif
+
+static uint32_t m_op_buffer[CEIL_DIV(APP_TIMER_BUF_SIZE(OP_QUEUE_SIZE), sizeof(uint32_t))];
+
+static app_timer_t    m_timer_data[TIMERS_MAX];
+static app_timer_id_t m_timer_ids[TIMERS_MAX];
+static uint64_t       m_expected[CHECKED_TIMERS];   // Expiry time of each running timer, 0 if stopped.
+static uint32_t       m_period[CHECKED_TIMERS];
+static bool           m_repeated[CHECKED_TIMERS];
+static uint32_t       m_checked;                    // Timers [0, m_checked) are checked.
+static bool           m_chaos;                      // The handler starts and stops other timers.
+
+static bool           m_rtc_running;
+static bool           m_rtc1_enabled;
+static bool           m_rtc1_pending;
+static bool           m_swi0_pending;
+static uint64_t       m_time;                       // Ticks since the start.
+static uint64_t       m_irqs;
+static uint64_t       m_expiries;
+static uint64_t       m_late_max;
+static uint32_t       m_steps = STEPS_DEFAULT;
+static uint32_t       m_timers = TIMERS_DEFAULT;
+static uint32_t       m_random = 12345;
+static uint32_t       m_checks;
+static uint32_t       m_failures;
+
+
+void app_error_handler_bare(ret_code_t error_code)
+{
+    printf("FAILED: app error 0x%08x\n", (unsigned int)error_code);
+    exit(1);
+}
+
+
+static void check(bool condition, char const * p_what)
+{
+    m_checks++;
+    if (!condition)
+    {
+        m_failures++;
+        printf("FAILED: %s\n", p_what);
+    }
+}
+
+
+static uint64_t host_time_ns(void)
+{
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static uint32_t random_get(void)
+{
+    m_random = (m_random * 1103515245UL) + 12345UL;
+    return (m_random >> 8) & 0x00FFFFFF;
+}
+
+
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority)
+{
+    (void)IRQn;
+    (void)priority;
+}
+
+
+void NVIC_EnableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn == RTC1_IRQn)
+    {
+        m_rtc1_enabled = true;
+    }
+}
+
+
+void NVIC_DisableIRQ(IRQn_Type IRQn)
+{
+    if (IRQn == RTC1_IRQn)
+    {
+        m_rtc1_enabled = false;
+    }
+}
+
+
+void NVIC_SetPendingIRQ(IRQn_Type IRQn)
+{
+    if (IRQn == RTC1_IRQn)
+    {
+        m_rtc1_pending = true;
+    }
+    else
+    {
+        m_swi0_pending = true;
+    }
+}
+
+
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn)
+{
+    if (IRQn == RTC1_IRQn)
+    {
+        m_rtc1_pending = false;
+    }
+    else
+    {
+        m_swi0_pending = false;
+    }
+}
+
+
+void app_timer_bench_rtc_tasks(void)
+{
+    if (NRF_RTC1->TASKS_START)
+    {
+        NRF_RTC1->TASKS_START = 0;
+        m_rtc_running = true;
+    }
+    if (NRF_RTC1->TASKS_STOP)
+    {
+        NRF_RTC1->TASKS_STOP = 0;
+        m_rtc_running = false;
+    }
+    if (NRF_RTC1->TASKS_CLEAR)
+    {
+        NRF_RTC1->TASKS_CLEAR = 0;
+        NRF_RTC1->COUNTER     = 0;
+    }
+}
+
+
+/**@brief Function for running the pending interrupts, as if the main loop was interrupted. */
+static void irqs_run(void)
+{
+    for (;;)
+    {
+        app_timer_bench_rtc_tasks();
+        if (m_rtc1_pending && m_rtc1_enabled)
+        {
+            m_rtc1_pending = false;
+            m_irqs++;
+            RTC1_IRQHandler();
+        }
+#ifdef APP_TIMER_BENCH_LIST
+        else if (m_swi0_pending)
+        {
+            m_swi0_pending = false;
+            SWI0_IRQHandler();
+        }
+#endif
+        else
+        {
+            break;
+        }
+    }
+}
+
+
+/**@brief Function for letting time pass, with a compare interrupt each time the counter
+ *        reaches CC[0]. */
+static void ticks_advance(uint64_t ticks)
+{
+    irqs_run();
+    while (ticks > 0)
+    {
+        uint32_t to_compare;
+
+        if (!m_rtc_running)
+        {
+            m_time += ticks;
+            return;
+        }
+
+        to_compare = (NRF_RTC1->CC[0] - NRF_RTC1->COUNTER) & RTC_COUNTER_MASK;
+        if (to_compare == 0)
+        {
+            to_compare = RTC_COUNTER_MASK + 1;
+        }
+        if (to_compare > ticks)
+        {
+            NRF_RTC1->COUNTER = (NRF_RTC1->COUNTER + ticks) & RTC_COUNTER_MASK;
+            m_time           += ticks;
+            return;
+        }
+
+        NRF_RTC1->COUNTER = (NRF_RTC1->COUNTER + to_compare) & RTC_COUNTER_MASK;
+        m_time           += to_compare;
+        ticks            -= to_compare;
+        m_rtc1_pending    = true;
+        irqs_run();
+    }
+}
+
+
+static void timer_start(uint32_t index, uint32_t timeout_ticks)
+{
+    if ((index < m_checked) && (m_expected[index] == 0))
+    {
+        // A second start of a running timer is ignored.
+        m_period[index]   = timeout_ticks;
+        m_expected[index] = m_time + timeout_ticks;
+    }
+    check(app_timer_start(m_timer_ids[index], timeout_ticks, (void *)(uintptr_t)index)
+          == NRF_SUCCESS, "start");
+}
+
+
+static void timer_stop(uint32_t index)
+{
+    if (index < m_checked)
+    {
+        m_expected[index] = 0;
+    }
+    check(app_timer_stop(m_timer_ids[index]) == NRF_SUCCESS, "stop");
+}
+
+
+static void timeout_handler(void * p_context)
+{
+    uint32_t index = (uint32_t)(uintptr_t)p_context;
+
+    m_expiries++;
+    if (index >= m_checked)
+    {
+        return;
+    }
+
+    if (m_expected[index] == 0)
+    {
+        printf("timer %u expired while stopped at tick %llu\n", index, (unsigned long long)m_time);
+        check(false, "no expiry of a stopped timer");
+    }
+    else if (m_time < m_expected[index])
+    {
+        printf("timer %u expired at tick %llu, before %llu\n",
+               index, (unsigned long long)m_time, (unsigned long long)m_expected[index]);
+        check(false, "no early expiry");
+    }
+    else
+    {
+        if ((m_time - m_expected[index]) > m_late_max)
+        {
+            m_late_max = m_time - m_expected[index];
+        }
+        m_expected[index] = m_repeated[index] ? (m_expected[index] + m_period[index]) : 0;
+    }
+
+    if (m_chaos)
+    {
+        // Stop or start another timer from the handler.
+        uint32_t other = random_get() % m_checked;
+
+        if ((random_get() & 1) != 0)
+        {
+            timer_stop(other);
+        }
+        else
+        {
+            timer_start(other, APP_TIMER_MIN_TIMEOUT_TICKS + (random_get() % 5000));
+        }
+    }
+}
+
+
+static void timers_init(uint32_t count, bool repeat_half)
+{
+    check(app_timer_init(0, OP_QUEUE_SIZE, m_op_buffer, NULL) == NRF_SUCCESS, "init");
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        bool repeated = repeat_half && ((i & 1) != 0);
+
+        memset(&m_timer_data[i], 0, sizeof(m_timer_data[i]));
+        m_timer_ids[i] = &m_timer_data[i];
+        if (i < CHECKED_TIMERS)
+        {
+            m_repeated[i] = repeated;
+            m_expected[i] = 0;
+        }
+        check(app_timer_create(&m_timer_ids[i],
+                               repeated ? APP_TIMER_MODE_REPEATED : APP_TIMER_MODE_SINGLE_SHOT,
+                               timeout_handler) == NRF_SUCCESS, "create");
+    }
+}
+
+
+static void random_test(void)
+{
+    uint64_t expiries;
+
+    m_checked = CHECKED_TIMERS;
+    timers_init(m_checked, true);
+
+    // Run one repeating timer with the longest timeout up to shortly before the 32-bit wrap.
+    timer_start(1, RTC_COUNTER_MASK);
+    ticks_advance(WRAP_TICKS - WRAP_MARGIN_TICKS);
+    timer_stop(1);
+    irqs_run();
+
+#ifndef APP_TIMER_BENCH_LIST
+    // app_timer.c queues a stop from a timeout handler behind the expiries of the same interrupt.
+    m_chaos = true;
+#endif
+
+    for (uint32_t step = 0; step < m_steps; step++)
+    {
+        uint32_t index = random_get() % m_checked;
+        uint32_t op    = random_get() % 16;
+
+        if ((step % STOP_ALL_STEPS) == (STOP_ALL_STEPS - 1))
+        {
+            check(app_timer_stop_all() == NRF_SUCCESS, "stop all");
+            memset(m_expected, 0, sizeof(m_expected));
+        }
+        else if (op < 4)
+        {
+            timer_start(index, APP_TIMER_MIN_TIMEOUT_TICKS + (random_get() % 100));
+        }
+        else if (op < 6)
+        {
+            timer_start(index, APP_TIMER_MIN_TIMEOUT_TICKS + (random_get() % 100000));
+        }
+        else if (op < 7)
+        {
+            timer_start(index, APP_TIMER_MIN_TIMEOUT_TICKS
+                               + (random_get() % (RTC_COUNTER_MASK - APP_TIMER_MIN_TIMEOUT_TICKS + 1)));
+        }
+        else if (op < 10)
+        {
+            timer_stop(index);
+        }
+        irqs_run();
+        ticks_advance(random_get() % (((random_get() & 7) != 0) ? 64 : 200000));
+    }
+
+    // Stop the repeated timers and let the single shots expire, then stop all timers.
+    m_chaos = false;
+    for (uint32_t i = 0; i < m_checked; i++)
+    {
+        if (m_repeated[i])
+        {
+            timer_stop(i);
+            irqs_run();
+        }
+    }
+    ticks_advance(RTC_COUNTER_MASK + 1);
+    for (uint32_t i = 0; i < m_checked; i++)
+    {
+        check(m_expected[i] == 0, "single shots expired");
+    }
+    check(app_timer_stop_all() == NRF_SUCCESS, "stop all");
+    memset(m_expected, 0, sizeof(m_expected));
+    irqs_run();
+    expiries = m_expiries;
+    ticks_advance(RTC_COUNTER_MASK + 1);
+    check(m_expiries == expiries, "no expiries after stop all");
+    check(m_late_max <= EXPIRY_LATE_MAX, "expiries at most EXPIRY_LATE_MAX ticks late");
+
+    printf("%s: %llu expiries in %llu ticks, at most %llu ticks late, %llu RTC1 interrupts\n",
+           BACKEND_NAME, (unsigned long long)m_expiries, (unsigned long long)m_time,
+           (unsigned long long)m_late_max, (unsigned long long)m_irqs);
+}
+
+
+static void bench(uint32_t count)
+{
+    uint64_t start_ns;
+    uint64_t start_stop_ns;
+    uint64_t expiry_ns;
+    uint64_t expiries;
+
+    m_checked = 0;
+    m_chaos   = false;
+
+    // Start and stop other timers while count timers with long timeouts are running.
+    timers_init(count + BENCH_EXTRA_TIMERS, false);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        timer_start(i, 100000 + (random_get() % 1000000));
+        irqs_run();
+    }
+    start_ns = host_time_ns();
+    for (uint32_t k = 0; k < BENCH_OPS; k++)
+    {
+        uint32_t index = count + (k % BENCH_EXTRA_TIMERS);
+
+        timer_start(index, 1000 + (random_get() % 500000));
+        irqs_run();
+        timer_stop(index);
+        irqs_run();
+    }
+    start_stop_ns = host_time_ns() - start_ns;
+
+    // Let count repeating timers with short periods expire.
+    timers_init(count, false);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        check(app_timer_create(&m_timer_ids[i], APP_TIMER_MODE_REPEATED, timeout_handler)
+              == NRF_SUCCESS, "create");
+        timer_start(i, 50 + (random_get() % 2000));
+        irqs_run();
+    }
+    expiries   = m_expiries;
+    start_ns   = host_time_ns();
+    while ((m_expiries - expiries) < BENCH_EXPIRIES)
+    {
+        ticks_advance(1000);
+    }
+    expiry_ns = host_time_ns() - start_ns;
+    expiries  = m_expiries - expiries;
+
+    printf("%7u | %11.1f | %10.1f\n",
+           count, (double)start_stop_ns / BENCH_OPS, (double)expiry_ns / expiries);
+}
+
+
+int main(int argc, char * argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "steps=", 6) == 0)
+        {
+            m_steps = strtoul(argv[i] + 6, NULL, 0);
+        }
+        else if (strncmp(argv[i], "timers=", 7) == 0)
+        {
+            m_timers = strtoul(argv[i] + 7, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [steps=<n>] [timers=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((m_timers < 1) || (m_timers > (TIMERS_MAX - BENCH_EXTRA_TIMERS)))
+    {
+        fprintf(stderr, "timers must be 1 to %u\n", TIMERS_MAX - BENCH_EXTRA_TIMERS);
+        return 2;
+    }
+
+    random_test();
+
+    printf(" timers | start+stop ns | expiry ns\n");
+    for (uint32_t count = 8; count < m_timers; count *= 4)
+    {
+        bench(count);
+    }
+    bench(m_timers);
+
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+    return (m_failures == 0) ? 0 : 1;
+}
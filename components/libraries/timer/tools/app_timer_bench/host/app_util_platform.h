@@ -0,0 +1,30 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host replacement of components/libraries/util/app_util_platform.h, which needs CMSIS. The
+ * simulated interrupts only run between calls of the main loop, so critical regions are empty. */
+
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include <stdint.h>
+#include "compiler_abstraction.h"
+
+#define APP_IRQ_PRIORITY_LOWEST     7
+
+#define CRITICAL_REGION_ENTER()     {
+#define CRITICAL_REGION_EXIT()      }
+
+#define ANON_UNIONS_ENABLE
+#define ANON_UNIONS_DISABLE
+
+#endif // APP_UTIL_PLATFORM_H__
@@ -0,0 +1,70 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host replacement of components/device/nrf.h for the app_timer simulation. RTC1 and CLOCK hold
+ * only the registers app_timer uses, and app_timer_bench.c implements the NVIC functions and
+ * moves the counter. */
+
+#ifndef NRF_H
+#define NRF_H
+
+#include <stdint.h>
+#include "compiler_abstraction.h"
+
+typedef enum
+{
+    RTC1_IRQn = 17,
+    SWI0_IRQn = 20
+} IRQn_Type;
+
+typedef struct
+{
+    volatile uint32_t TASKS_START;
+    volatile uint32_t TASKS_STOP;
+    volatile uint32_t TASKS_CLEAR;
+    volatile uint32_t EVENTS_TICK;
+    volatile uint32_t EVENTS_OVRFLW;
+    volatile uint32_t EVENTS_COMPARE[4];
+    volatile uint32_t INTENSET;
+    volatile uint32_t INTENCLR;
+    volatile uint32_t EVTENSET;
+    volatile uint32_t EVTENCLR;
+    volatile uint32_t COUNTER;
+    volatile uint32_t PRESCALER;
+    volatile uint32_t CC[4];
+} NRF_RTC_Type;
+
+typedef struct
+{
+    volatile uint32_t TASKS_LFCLKSTART;
+    volatile uint32_t EVENTS_LFCLKSTARTED;
+} NRF_CLOCK_Type;
+
+extern NRF_RTC_Type   app_timer_bench_rtc1;
+extern NRF_CLOCK_Type app_timer_bench_clock;
+
+#define NRF_RTC1    (&app_timer_bench_rtc1)
+#define NRF_CLOCK   (&app_timer_bench_clock)
+
+#define RTC_INTENSET_COMPARE0_Msk   (0x1UL << 16)
+#define RTC_EVTEN_COMPARE0_Msk      (0x1UL << 16)
+
+void NVIC_SetPriority(IRQn_Type IRQn, uint32_t priority);
+void NVIC_EnableIRQ(IRQn_Type IRQn);
+void NVIC_DisableIRQ(IRQn_Type IRQn);
+void NVIC_SetPendingIRQ(IRQn_Type IRQn);
+void NVIC_ClearPendingIRQ(IRQn_Type IRQn);
+
+/**@brief Function for carrying out the RTC1 tasks that were triggered. */
+void app_timer_bench_rtc_tasks(void);
+
+#endif // NRF_H
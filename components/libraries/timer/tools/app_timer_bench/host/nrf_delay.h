@@ -0,0 +1,27 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host replacement of components/drivers_nrf/delay/nrf_delay.h. app_timer waits for the RTC
+ * tasks to take effect, so the simulated RTC carries them out here. */
+
+#ifndef _NRF_DELAY_H
+#define _NRF_DELAY_H
+
+#include "nrf.h"
+
+static inline void nrf_delay_us(uint32_t number_of_us)
+{
+    (void)number_of_us;
+    app_timer_bench_rtc_tasks();
+}
+
+#endif // _NRF_DELAY_H
@@ -0,0 +1,488 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Generated by ser_codegen.py from ble_s132.ser. Do not edit. */
+
+#include <string.h>
+#include "ble_serialization.h"
+#include "ble_gatts_app.h"
+#include "ble_gattc_app.h"
+#include "ble_gap_app.h"
+#include "ble_evt_app.h"
+#include "ble_gap_evt_app.h"
+#include "ble_gattc_evt_app.h"
+#include "ble_gatts_evt_app.h"
+#include "app_util.h"
+
+#if SER_CODEC_GEN_ENABLED
+
+// Runs of members which are copied at once must be contiguous.
+STATIC_ASSERT(sizeof(((ble_gatts_hvx_params_t *)0)->handle) == 2);
+STATIC_ASSERT(sizeof(((ble_gatts_hvx_params_t *)0)->type) == 1);
+STATIC_ASSERT(offsetof(ble_gatts_hvx_params_t, type) == offsetof(ble_gatts_hvx_params_t, handle) + 2);
+STATIC_ASSERT(sizeof(((ble_gattc_write_params_t *)0)->write_op) == 1);
+STATIC_ASSERT(sizeof(((ble_gattc_write_params_t *)0)->flags) == 1);
+STATIC_ASSERT(sizeof(((ble_gattc_write_params_t *)0)->handle) == 2);
+STATIC_ASSERT(sizeof(((ble_gattc_write_params_t *)0)->offset) == 2);
+STATIC_ASSERT(offsetof(ble_gattc_write_params_t, flags) == offsetof(ble_gattc_write_params_t, write_op) + 1);
+STATIC_ASSERT(offsetof(ble_gattc_write_params_t, handle) == offsetof(ble_gattc_write_params_t, flags) + 1);
+STATIC_ASSERT(offsetof(ble_gattc_write_params_t, offset) == offsetof(ble_gattc_write_params_t, handle) + 2);
+STATIC_ASSERT(sizeof(((ble_gap_conn_params_t *)0)->min_conn_interval) == 2);
+STATIC_ASSERT(sizeof(((ble_gap_conn_params_t *)0)->max_conn_interval) == 2);
+STATIC_ASSERT(sizeof(((ble_gap_conn_params_t *)0)->slave_latency) == 2);
+STATIC_ASSERT(sizeof(((ble_gap_conn_params_t *)0)->conn_sup_timeout) == 2);
+STATIC_ASSERT(offsetof(ble_gap_conn_params_t, max_conn_interval) == offsetof(ble_gap_conn_params_t, min_conn_interval) + 2);
+STATIC_ASSERT(offsetof(ble_gap_conn_params_t, slave_latency) == offsetof(ble_gap_conn_params_t, max_conn_interval) + 2);
+STATIC_ASSERT(offsetof(ble_gap_conn_params_t, conn_sup_timeout) == offsetof(ble_gap_conn_params_t, slave_latency) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gap_evt.params.conn_param_update.conn_params.min_conn_interval) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gap_evt.params.conn_param_update.conn_params.slave_latency) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gap_evt.params.conn_param_update.conn_params.conn_sup_timeout) == 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval) == offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.min_conn_interval) + 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.slave_latency) == offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval) + 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.conn_sup_timeout) == offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.slave_latency) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.conn_handle) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.gatt_status) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.error_handle) == 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.gatt_status) == offsetof(ble_evt_t, evt.gattc_evt.conn_handle) + 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.error_handle) == offsetof(ble_evt_t, evt.gattc_evt.gatt_status) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.hvx.handle) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.hvx.type) == 1);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.params.hvx.type) == offsetof(ble_evt_t, evt.gattc_evt.params.hvx.handle) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.write_rsp.handle) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.write_rsp.write_op) == 1);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.params.write_rsp.write_op) == offsetof(ble_evt_t, evt.gattc_evt.params.write_rsp.handle) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.write_rsp.offset) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.write_rsp.len) == 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.params.write_rsp.len) == offsetof(ble_evt_t, evt.gattc_evt.params.write_rsp.offset) + 2);
+
+// The runs are copied in the byte order of the target and the wire format is little-endian,
+// as are the Cortex-M cores of the nRF5 devices.
+#if defined(__BYTE_ORDER__)
+STATIC_ASSERT(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+#elif defined(__BIG_ENDIAN) || (defined(__ICCARM__) && !__LITTLE_ENDIAN__)
+#error "The generated codecs need a little-endian target."
+#endif
+
+
+uint32_t ble_gatts_hvx_req_enc(uint16_t                             conn_handle,
+                               ble_gatts_hvx_params_t const * const p_hvx_params,
+                               uint8_t * const                      p_buf,
+                               uint32_t * const                     p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+
+    uint32_t index;
+    uint32_t len = 4;
+    if (p_hvx_params != NULL)
+    {
+        len += 6;
+        if (p_hvx_params->p_len != NULL)
+        {
+            len += 3;
+            if (p_hvx_params->p_data != NULL)
+            {
+                len += *p_hvx_params->p_len;
+            }
+        }
+    }
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    p_buf[0] = SD_BLE_GATTS_HVX;
+    (void)uint16_encode(conn_handle, &p_buf[1]);
+    p_buf[3] = (p_hvx_params == NULL) ? SER_FIELD_NOT_PRESENT : SER_FIELD_PRESENT;
+    index = 4;
+    if (p_hvx_params != NULL)
+    {
+        memcpy(&p_buf[index], &p_hvx_params->handle, 3);
+        (void)uint16_encode(p_hvx_params->offset, &p_buf[index + 3]);
+        p_buf[index + 5] = (p_hvx_params->p_len == NULL) ? SER_FIELD_NOT_PRESENT : SER_FIELD_PRESENT;
+        index += 6;
+        if (p_hvx_params->p_len != NULL)
+        {
+            (void)uint16_encode(*p_hvx_params->p_len, &p_buf[index]);
+            p_buf[index + 2] = (p_hvx_params->p_data == NULL) ? SER_FIELD_NOT_PRESENT : SER_FIELD_PRESENT;
+            index += 3;
+            if (p_hvx_params->p_data != NULL)
+            {
+                memcpy(&p_buf[index], p_hvx_params->p_data, *p_hvx_params->p_len);
+                index += *p_hvx_params->p_len;
+            }
+        }
+    }
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gatts_hvx_rsp_dec(uint8_t const * const p_buf,
+                               uint32_t              packet_len,
+                               uint32_t * const      p_result_code,
+                               uint16_t * * const    pp_bytes_written)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_result_code);
+
+    if (packet_len < SER_CMD_RSP_HEADER_SIZE)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+    if (p_buf[SER_CMD_OP_CODE_POS] != SD_BLE_GATTS_HVX)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    *p_result_code = uint32_decode(&p_buf[SER_CMD_RSP_STATUS_CODE_POS]);
+
+    if (*p_result_code != NRF_SUCCESS)
+    {
+        SER_ASSERT_LENGTH_EQ(SER_CMD_RSP_HEADER_SIZE, packet_len);
+        return NRF_SUCCESS;
+    }
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(6, packet_len);
+    index = 6;
+    if (p_buf[index - 1] == SER_FIELD_PRESENT)
+    {
+        SER_ASSERT_NOT_NULL(pp_bytes_written);
+        SER_ASSERT_NOT_NULL(*pp_bytes_written);
+        SER_ASSERT_LENGTH_LEQ(2, packet_len - index);
+        **pp_bytes_written = uint16_decode(&p_buf[index]);
+        index += 2;
+    }
+    else if (p_buf[index - 1] == SER_FIELD_NOT_PRESENT)
+    {
+        if (pp_bytes_written != NULL)
+        {
+            *pp_bytes_written = NULL;
+        }
+    }
+    else
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_hv_confirm_req_enc(uint16_t         conn_handle,
+                                      uint16_t         handle,
+                                      uint8_t * const  p_buf,
+                                      uint32_t * const p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+
+    uint32_t index;
+    uint32_t len = 5;
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    p_buf[0] = SD_BLE_GATTC_HV_CONFIRM;
+    (void)uint16_encode(conn_handle, &p_buf[1]);
+    (void)uint16_encode(handle, &p_buf[3]);
+    index = 5;
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_hv_confirm_rsp_dec(uint8_t const * const p_buf,
+                                      uint32_t              packet_len,
+                                      uint32_t * const      p_result_code)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_result_code);
+
+    if (packet_len < SER_CMD_RSP_HEADER_SIZE)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+    if (p_buf[SER_CMD_OP_CODE_POS] != SD_BLE_GATTC_HV_CONFIRM)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    *p_result_code = uint32_decode(&p_buf[SER_CMD_RSP_STATUS_CODE_POS]);
+
+    return (packet_len == SER_CMD_RSP_HEADER_SIZE) ? NRF_SUCCESS : NRF_ERROR_DATA_SIZE;
+}
+
+
+uint32_t ble_gattc_write_req_enc(uint16_t                               conn_handle,
+                                 ble_gattc_write_params_t const * const p_write_params,
+                                 uint8_t * const                        p_buf,
+                                 uint32_t * const                       p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+
+    uint32_t index;
+    uint32_t len = 4;
+    if (p_write_params != NULL)
+    {
+        len += 9;
+        if (p_write_params->p_value != NULL)
+        {
+            len += p_write_params->len;
+        }
+    }
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    p_buf[0] = SD_BLE_GATTC_WRITE;
+    (void)uint16_encode(conn_handle, &p_buf[1]);
+    p_buf[3] = (p_write_params == NULL) ? SER_FIELD_NOT_PRESENT : SER_FIELD_PRESENT;
+    index = 4;
+    if (p_write_params != NULL)
+    {
+        memcpy(&p_buf[index], &p_write_params->write_op, 6);
+        (void)uint16_encode(p_write_params->len, &p_buf[index + 6]);
+        p_buf[index + 8] = (p_write_params->p_value == NULL) ? SER_FIELD_NOT_PRESENT : SER_FIELD_PRESENT;
+        index += 9;
+        if (p_write_params->p_value != NULL)
+        {
+            memcpy(&p_buf[index], p_write_params->p_value, p_write_params->len);
+            index += p_write_params->len;
+        }
+    }
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_write_rsp_dec(uint8_t const * const p_buf,
+                                 uint32_t              packet_len,
+                                 uint32_t * const      p_result_code)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_result_code);
+
+    if (packet_len < SER_CMD_RSP_HEADER_SIZE)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+    if (p_buf[SER_CMD_OP_CODE_POS] != SD_BLE_GATTC_WRITE)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    *p_result_code = uint32_decode(&p_buf[SER_CMD_RSP_STATUS_CODE_POS]);
+
+    return (packet_len == SER_CMD_RSP_HEADER_SIZE) ? NRF_SUCCESS : NRF_ERROR_DATA_SIZE;
+}
+
+
+uint32_t ble_gap_conn_param_update_req_enc(uint16_t                            conn_handle,
+                                           ble_gap_conn_params_t const * const p_conn_params,
+                                           uint8_t * const                     p_buf,
+                                           uint32_t * const                    p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+
+    uint32_t index;
+    uint32_t len = 4;
+    if (p_conn_params != NULL)
+    {
+        len += 8;
+    }
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    p_buf[0] = SD_BLE_GAP_CONN_PARAM_UPDATE;
+    (void)uint16_encode(conn_handle, &p_buf[1]);
+    p_buf[3] = (p_conn_params == NULL) ? SER_FIELD_NOT_PRESENT : SER_FIELD_PRESENT;
+    index = 4;
+    if (p_conn_params != NULL)
+    {
+        memcpy(&p_buf[index], &p_conn_params->min_conn_interval, 8);
+        index += 8;
+    }
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gap_conn_param_update_rsp_dec(uint8_t const * const p_buf,
+                                           uint32_t              packet_len,
+                                           uint32_t * const      p_result_code)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_result_code);
+
+    if (packet_len < SER_CMD_RSP_HEADER_SIZE)
+    {
+        return NRF_ERROR_DATA_SIZE;
+    }
+    if (p_buf[SER_CMD_OP_CODE_POS] != SD_BLE_GAP_CONN_PARAM_UPDATE)
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+    *p_result_code = uint32_decode(&p_buf[SER_CMD_RSP_STATUS_CODE_POS]);
+
+    return (packet_len == SER_CMD_RSP_HEADER_SIZE) ? NRF_SUCCESS : NRF_ERROR_DATA_SIZE;
+}
+
+
+uint32_t ble_evt_tx_complete_dec(uint8_t const * const p_buf,
+                                 uint32_t              packet_len,
+                                 ble_evt_t * const     p_event,
+                                 uint32_t * const      p_event_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_event_len);
+
+    uint32_t const evt_struct_len = offsetof(ble_evt_t, evt.common_evt.params)
+                                  - offsetof(ble_evt_t, evt)
+                                  + sizeof(ble_evt_tx_complete_t);
+    SER_ASSERT_LENGTH_LEQ(evt_struct_len, *p_event_len);
+    p_event->header.evt_id = BLE_EVT_TX_COMPLETE;
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(3, packet_len);
+    p_event->evt.common_evt.conn_handle = uint16_decode(&p_buf[0]);
+    p_event->evt.common_evt.params.tx_complete.count = p_buf[2];
+    index = 3;
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    *p_event_len = evt_struct_len;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gap_evt_conn_param_update_dec(uint8_t const * const p_buf,
+                                           uint32_t              packet_len,
+                                           ble_evt_t * const     p_event,
+                                           uint32_t * const      p_event_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_event_len);
+
+    uint32_t const evt_struct_len = offsetof(ble_evt_t, evt.gap_evt.params)
+                                  - offsetof(ble_evt_t, evt)
+                                  + sizeof(ble_gap_evt_conn_param_update_t);
+    SER_ASSERT_LENGTH_LEQ(evt_struct_len, *p_event_len);
+    p_event->header.evt_id = BLE_GAP_EVT_CONN_PARAM_UPDATE;
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(10, packet_len);
+    p_event->evt.gap_evt.conn_handle = uint16_decode(&p_buf[0]);
+    memcpy(&p_event->evt.gap_evt.params.conn_param_update.conn_params.min_conn_interval, &p_buf[2], 8);
+    index = 10;
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    *p_event_len = evt_struct_len;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_evt_hvx_dec(uint8_t const * const p_buf,
+                               uint32_t              packet_len,
+                               ble_evt_t * const     p_event,
+                               uint32_t * const      p_event_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_event_len);
+
+    uint32_t const evt_struct_len = offsetof(ble_evt_t, evt.gattc_evt.params)
+                                  - offsetof(ble_evt_t, evt)
+                                  + sizeof(ble_gattc_evt_hvx_t);
+    SER_ASSERT_LENGTH_LEQ(evt_struct_len, *p_event_len);
+    *p_event_len -= evt_struct_len;
+    uint32_t evt_extended_len = 0;
+    p_event->header.evt_id = BLE_GATTC_EVT_HVX;
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(11, packet_len);
+    memcpy(&p_event->evt.gattc_evt.conn_handle, &p_buf[0], 6);
+    memcpy(&p_event->evt.gattc_evt.params.hvx.handle, &p_buf[6], 3);
+    p_event->evt.gattc_evt.params.hvx.len = uint16_decode(&p_buf[9]);
+    index = 11;
+    uint32_t const data_ext_len = SUB1(p_event->evt.gattc_evt.params.hvx.len);
+    SER_ASSERT_LENGTH_LEQ(data_ext_len, *p_event_len);
+    SER_ASSERT_LENGTH_LEQ(p_event->evt.gattc_evt.params.hvx.len, packet_len - index);
+    memcpy(p_event->evt.gattc_evt.params.hvx.data, &p_buf[index], p_event->evt.gattc_evt.params.hvx.len);
+    index += p_event->evt.gattc_evt.params.hvx.len;
+    *p_event_len     -= data_ext_len;
+    evt_extended_len += data_ext_len;
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    *p_event_len = evt_struct_len + evt_extended_len;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_evt_write_rsp_dec(uint8_t const * const p_buf,
+                                     uint32_t              packet_len,
+                                     ble_evt_t * const     p_event,
+                                     uint32_t * const      p_event_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_event_len);
+
+    uint32_t const evt_struct_len = offsetof(ble_evt_t, evt.gattc_evt.params)
+                                  - offsetof(ble_evt_t, evt)
+                                  + sizeof(ble_gattc_evt_write_rsp_t);
+    SER_ASSERT_LENGTH_LEQ(evt_struct_len, *p_event_len);
+    *p_event_len -= evt_struct_len;
+    uint32_t evt_extended_len = 0;
+    p_event->header.evt_id = BLE_GATTC_EVT_WRITE_RSP;
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(13, packet_len);
+    memcpy(&p_event->evt.gattc_evt.conn_handle, &p_buf[0], 6);
+    memcpy(&p_event->evt.gattc_evt.params.write_rsp.handle, &p_buf[6], 3);
+    memcpy(&p_event->evt.gattc_evt.params.write_rsp.offset, &p_buf[9], 4);
+    index = 13;
+    uint32_t const data_ext_len = SUB1(p_event->evt.gattc_evt.params.write_rsp.len);
+    SER_ASSERT_LENGTH_LEQ(data_ext_len, *p_event_len);
+    SER_ASSERT_LENGTH_LEQ(p_event->evt.gattc_evt.params.write_rsp.len, packet_len - index);
+    memcpy(p_event->evt.gattc_evt.params.write_rsp.data, &p_buf[index], p_event->evt.gattc_evt.params.write_rsp.len);
+    index += p_event->evt.gattc_evt.params.write_rsp.len;
+    *p_event_len     -= data_ext_len;
+    evt_extended_len += data_ext_len;
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    *p_event_len = evt_struct_len + evt_extended_len;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gatts_evt_hvc_dec(uint8_t const * const p_buf,
+                               uint32_t              packet_len,
+                               ble_evt_t * const     p_event,
+                               uint32_t * const      p_event_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_event_len);
+
+    uint32_t const evt_struct_len = offsetof(ble_evt_t, evt.gatts_evt.params)
+                                  - offsetof(ble_evt_t, evt)
+                                  + sizeof(ble_gatts_evt_hvc_t);
+    SER_ASSERT_LENGTH_LEQ(evt_struct_len, *p_event_len);
+    p_event->header.evt_id = BLE_GATTS_EVT_HVC;
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(4, packet_len);
+    p_event->evt.gatts_evt.conn_handle = uint16_decode(&p_buf[0]);
+    p_event->evt.gatts_evt.params.hvc.handle = uint16_decode(&p_buf[2]);
+    index = 4;
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    *p_event_len = evt_struct_len;
+    return NRF_SUCCESS;
+}
+
+#endif // SER_CODEC_GEN_ENABLED
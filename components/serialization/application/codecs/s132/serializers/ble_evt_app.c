@@ -59,6 +59,7 @@ uint32_t ble_evt_user_mem_release_dec(uint8_t const * const p_buf,
     SER_EVT_DEC_END;
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_evt_tx_complete_dec(uint8_t const * const p_buf,
                                  uint32_t              packet_len,
                                  ble_evt_t * const     p_event,
@@ -71,6 +72,7 @@ uint32_t ble_evt_tx_complete_dec(uint8_t const * const p_buf,
 
     SER_EVT_DEC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 
 uint32_t ble_evt_user_mem_request_dec(uint8_t const * const p_buf,
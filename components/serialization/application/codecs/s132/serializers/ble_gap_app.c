@@ -183,6 +183,7 @@ uint32_t ble_gap_authenticate_rsp_dec(uint8_t const * const p_buf,
 }
 
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gap_conn_param_update_req_enc(uint16_t                            conn_handle,
                                            ble_gap_conn_params_t const * const p_conn_params,
                                            uint8_t * const                     p_buf,
@@ -203,6 +204,7 @@ uint32_t ble_gap_conn_param_update_rsp_dec(uint8_t const * const p_buf,
 {
     SER_RSP_DEC_RESULT_ONLY(SD_BLE_GAP_CONN_PARAM_UPDATE);
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 
 uint32_t ble_gap_conn_sec_get_req_enc(uint16_t                         conn_handle,
@@ -75,6 +75,7 @@ uint32_t ble_gap_evt_auth_status_dec(uint8_t const * const p_buf,
 }
 
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gap_evt_conn_param_update_dec(uint8_t const * const p_buf,
                                            uint32_t              packet_len,
                                            ble_evt_t * const     p_event,
@@ -87,6 +88,7 @@ uint32_t ble_gap_evt_conn_param_update_dec(uint8_t const * const p_buf,
 
     SER_EVT_DEC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 
 uint32_t ble_gap_evt_conn_param_update_request_dec(uint8_t const * const p_buf,
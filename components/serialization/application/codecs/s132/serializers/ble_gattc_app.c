@@ -128,6 +128,7 @@ uint32_t ble_gattc_descriptors_discover_rsp_dec(uint8_t const * const p_buf,
     SER_RSP_DEC_RESULT_ONLY(SD_BLE_GATTC_DESCRIPTORS_DISCOVER);
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gattc_hv_confirm_req_enc(uint16_t         conn_handle,
                                       uint16_t         handle,
                                       uint8_t * const  p_buf,
@@ -147,6 +148,7 @@ uint32_t ble_gattc_hv_confirm_rsp_dec(uint8_t const * const p_buf,
 {
     SER_RSP_DEC_RESULT_ONLY(SD_BLE_GATTC_HV_CONFIRM);
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gattc_primary_services_discover_req_enc(uint16_t                 conn_handle,
                                                      uint16_t                 start_handle,
@@ -216,6 +218,7 @@ uint32_t ble_gattc_relationships_discover_rsp_dec(uint8_t const * const p_buf,
     SER_RSP_DEC_RESULT_ONLY(SD_BLE_GATTC_RELATIONSHIPS_DISCOVER);
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gattc_write_req_enc(uint16_t                               conn_handle,
                                  ble_gattc_write_params_t const * const p_write_params,
                                  uint8_t * const                        p_buf,
@@ -236,6 +239,7 @@ uint32_t ble_gattc_write_rsp_dec(uint8_t const * const p_buf,
 {
     SER_RSP_DEC_RESULT_ONLY(SD_BLE_GATTC_WRITE);
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gattc_exchange_mtu_request_req_enc(uint16_t          conn_handle,
                                                 uint16_t          client_rx_mtu,
@@ -100,6 +100,7 @@ uint32_t ble_gattc_evt_desc_disc_rsp_dec(uint8_t const * const p_buf,
     SER_EVT_DEC_END;
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gattc_evt_hvx_dec(uint8_t const * const p_buf,
                                uint32_t              packet_len,
                                ble_evt_t * const     p_event,
@@ -115,6 +116,7 @@ uint32_t ble_gattc_evt_hvx_dec(uint8_t const * const p_buf,
 
     SER_EVT_DEC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 
 uint32_t ble_gattc_evt_prim_srvc_disc_rsp_dec(uint8_t const * const p_buf,
@@ -186,6 +188,7 @@ uint32_t ble_gattc_evt_timeout_dec(uint8_t const * const p_buf,
     SER_EVT_DEC_END;
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gattc_evt_write_rsp_dec(uint8_t const * const p_buf,
                                      uint32_t              packet_len,
                                      ble_evt_t * const     p_event,
@@ -201,6 +204,7 @@ uint32_t ble_gattc_evt_write_rsp_dec(uint8_t const * const p_buf,
 
     SER_EVT_DEC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gattc_evt_exchange_mtu_rsp_dec(uint8_t const * const p_buf,
                                             uint32_t              packet_len,
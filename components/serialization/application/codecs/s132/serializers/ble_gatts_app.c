@@ -110,6 +110,7 @@ uint32_t ble_gatts_descriptor_add_rsp_dec(uint8_t const * const p_buf,
 }
 
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gatts_hvx_req_enc(uint16_t                             conn_handle,
                                ble_gatts_hvx_params_t const * const p_hvx_params,
                                uint8_t * const                      p_buf,
@@ -135,6 +136,7 @@ uint32_t ble_gatts_hvx_rsp_dec(uint8_t const * const p_buf,
 
     SER_RSP_DEC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 
 uint32_t ble_gatts_include_add_req_enc(uint16_t         service_handle,
@@ -18,6 +18,7 @@
 
 extern ser_ble_user_mem_t m_app_user_mem_table[];
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gatts_evt_hvc_dec(uint8_t const * const p_buf,
                                uint32_t              packet_len,
                                ble_evt_t * const     p_event,
@@ -31,6 +32,7 @@ uint32_t ble_gatts_evt_hvc_dec(uint8_t const * const p_buf,
 
     SER_EVT_DEC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gatts_evt_rw_authorize_request_dec(uint8_t const * const p_buf,
                                                 uint32_t              packet_len,
@@ -91,6 +91,12 @@ typedef enum
 #define SER_FIELD_NOT_PRESENT          0x00
 
 
+/** Use the codecs generated from tools/ser_codegen/ble_s132.ser (ble_codecs_gen_*.c) instead of
+ *  the hand-written codecs of the commands and events described in the schema. */
+#ifndef SER_CODEC_GEN_ENABLED
+#define SER_CODEC_GEN_ENABLED 0
+#endif
+
 /** Enable SER_ASSERT<*> asserts */
 #define SER_ASSERTS_ENABLED 1
 
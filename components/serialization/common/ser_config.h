@@ -56,6 +56,16 @@ extern "C" {
     #define SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE         SER_HAL_TRANSPORT_CONN_TO_APP_MAX_PKT_SIZE
 #endif /* SER_CONNECTIVITY */
 
+/** Number of TX and RX packet buffers in serialization HAL Transport layer. With more than one TX
+ *  buffer, a packet can be encoded while the previous one is transmitted. With more than one RX
+ *  buffer, a packet can be received while the previous one is decoded. */
+#ifndef SER_HAL_TRANSPORT_TX_BUF_COUNT
+#define SER_HAL_TRANSPORT_TX_BUF_COUNT  2
+#endif
+#ifndef SER_HAL_TRANSPORT_RX_BUF_COUNT
+#define SER_HAL_TRANSPORT_RX_BUF_COUNT  2
+#endif
+
 
 /***********************************************************************************************//**
  * SER_PHY layer configuration.
@@ -13,12 +13,16 @@
 #include <stdbool.h>
 #include <string.h>
 #include "app_error.h"
+#include "app_util.h"
 #include "ser_config.h"
 #include "ser_phy.h"
 #include "ser_hal_transport.h"
 
 /**
  * @brief States of the RX state machine.
+ *
+ * @details The state machine follows the PHY layer, which receives one packet at a time. Received
+ *          packets are kept in their buffers until they are freed by the upper layer.
  */
 typedef enum
 {
@@ -26,25 +30,36 @@ typedef enum
     HAL_TRANSP_RX_STATE_IDLE,
     HAL_TRANSP_RX_STATE_RECEIVING,
     HAL_TRANSP_RX_STATE_DROPPING,
-    HAL_TRANSP_RX_STATE_RECEIVED,
-    HAL_TRANSP_RX_STATE_RECEIVED_PENDING_BUF_REQ,
-    HAL_TRANSP_RX_STATE_RECEIVED_DROPPING,
+    HAL_TRANSP_RX_STATE_PENDING_BUF_REQ,
     HAL_TRANSP_RX_STATE_MAX
 }ser_hal_transp_rx_states_t;
 
 /**
  * @brief States of the TX state machine.
+ *
+ * @details The state machine follows the PHY layer, which transmits one packet at a time. Packets
+ *          sent while the PHY layer is busy are queued and transmitted in order.
  */
 typedef enum
 {
     HAL_TRANSP_TX_STATE_CLOSED = 0,
     HAL_TRANSP_TX_STATE_IDLE,
-    HAL_TRANSP_TX_STATE_TX_ALLOCATED,
     HAL_TRANSP_TX_STATE_TRANSMITTING,
-    HAL_TRANSP_TX_STATE_TRANSMITTED,
     HAL_TRANSP_TX_STATE_MAX
 }ser_hal_transp_tx_states_t;
 
+/**
+ * @brief States of a packet buffer.
+ */
+typedef enum
+{
+    HAL_TRANSP_BUF_STATE_FREE = 0,
+    HAL_TRANSP_BUF_STATE_ALLOCATED,     /**< TX buffer allocated by the upper layer. */
+    HAL_TRANSP_BUF_STATE_QUEUED,        /**< TX buffer waiting for or under transmission. */
+    HAL_TRANSP_BUF_STATE_RECEIVING,     /**< RX buffer given to the PHY layer. */
+    HAL_TRANSP_BUF_STATE_RECEIVED,      /**< RX buffer waiting to be freed by the upper layer. */
+}ser_hal_transp_buf_states_t;
+
 /**
  * @brief RX state.
  */
@@ -55,13 +70,33 @@ static ser_hal_transp_rx_states_t m_rx_state = HAL_TRANSP_RX_STATE_CLOSED;
 static ser_hal_transp_tx_states_t m_tx_state = HAL_TRANSP_TX_STATE_CLOSED;
 
 /**
- * @brief Transmission buffer.
+ * @brief Transmission buffers.
  */
-static uint8_t m_tx_buffer[SER_HAL_TRANSPORT_TX_MAX_PKT_SIZE];
+static uint8_t m_tx_buffer[SER_HAL_TRANSPORT_TX_BUF_COUNT][SER_HAL_TRANSPORT_TX_MAX_PKT_SIZE];
+/**
+ * @brief Reception buffers.
+ */
+static uint8_t m_rx_buffer[SER_HAL_TRANSPORT_RX_BUF_COUNT][SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE];
+
 /**
- * @brief Reception buffer.
+ * @brief States of the transmission and reception buffers.
  */
-static uint8_t m_rx_buffer[SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE];
+static ser_hal_transp_buf_states_t m_tx_buf_state[SER_HAL_TRANSPORT_TX_BUF_COUNT];
+static ser_hal_transp_buf_states_t m_rx_buf_state[SER_HAL_TRANSPORT_RX_BUF_COUNT];
+
+/**
+ * @brief Transmission queue: indexes of the sent buffers in the order of transmission, with their
+ *        lengths. The head of the queue is under transmission.
+ */
+static uint8_t  m_tx_queue[SER_HAL_TRANSPORT_TX_BUF_COUNT];
+static uint16_t m_tx_queue_len[SER_HAL_TRANSPORT_TX_BUF_COUNT];
+static uint8_t  m_tx_queue_head;
+static uint8_t  m_tx_queue_count;
+
+/**
+ * @brief Index of the RX buffer given to the PHY layer.
+ */
+static uint8_t m_rx_buf_idx;
 
 /**
  * @brief Callback function handler for Serialization HAL Transport layer events.
@@ -69,6 +104,113 @@ static uint8_t m_rx_buffer[SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE];
 static ser_hal_transport_events_handler_t m_events_handler = NULL;
 
 
+STATIC_ASSERT(SER_HAL_TRANSPORT_TX_BUF_COUNT > 0 && SER_HAL_TRANSPORT_TX_BUF_COUNT <= UINT8_MAX);
+STATIC_ASSERT(SER_HAL_TRANSPORT_RX_BUF_COUNT > 0 && SER_HAL_TRANSPORT_RX_BUF_COUNT <= UINT8_MAX);
+
+
+/**
+ * @brief Function for finding the index of the TX buffer starting at p_buffer.
+ *
+ * @return Index of the buffer, or SER_HAL_TRANSPORT_TX_BUF_COUNT if p_buffer is not the start of
+ *         a TX buffer.
+ */
+static uint32_t tx_buf_idx_get(uint8_t const * p_buffer)
+{
+    uint32_t idx;
+
+    for (idx = 0; idx < SER_HAL_TRANSPORT_TX_BUF_COUNT; idx++)
+    {
+        if (p_buffer == m_tx_buffer[idx])
+        {
+            break;
+        }
+    }
+    return idx;
+}
+
+
+/**
+ * @brief Function for finding the index of the RX buffer starting at p_buffer.
+ *
+ * @return Index of the buffer, or SER_HAL_TRANSPORT_RX_BUF_COUNT if p_buffer is not the start of
+ *         an RX buffer.
+ */
+static uint32_t rx_buf_idx_get(uint8_t const * p_buffer)
+{
+    uint32_t idx;
+
+    for (idx = 0; idx < SER_HAL_TRANSPORT_RX_BUF_COUNT; idx++)
+    {
+        if (p_buffer == m_rx_buffer[idx])
+        {
+            break;
+        }
+    }
+    return idx;
+}
+
+
+/**
+ * @brief Function for giving a free RX buffer to the PHY layer.
+ *
+ * @retval NRF_SUCCESS          The PHY layer is receiving to a free buffer.
+ * @retval NRF_ERROR_NO_MEM     There is no free RX buffer.
+ * @return Error code returned by @ref ser_phy_rx_buf_set.
+ */
+static uint32_t rx_buf_set(void)
+{
+    uint32_t err_code;
+    uint32_t idx;
+
+    for (idx = 0; idx < SER_HAL_TRANSPORT_RX_BUF_COUNT; idx++)
+    {
+        if (HAL_TRANSP_BUF_STATE_FREE == m_rx_buf_state[idx])
+        {
+            break;
+        }
+    }
+    if (SER_HAL_TRANSPORT_RX_BUF_COUNT == idx)
+    {
+        return NRF_ERROR_NO_MEM;
+    }
+
+    err_code = ser_phy_rx_buf_set(m_rx_buffer[idx]);
+    if (NRF_SUCCESS == err_code)
+    {
+        m_rx_buf_state[idx] = HAL_TRANSP_BUF_STATE_RECEIVING;
+        m_rx_buf_idx        = (uint8_t)idx;
+        m_rx_state          = HAL_TRANSP_RX_STATE_RECEIVING;
+    }
+    return err_code;
+}
+
+
+/**
+ * @brief Function for releasing the TX buffer at the head of the transmission queue and starting
+ *        the transmission of the next queued packet. Called with PHY interrupts disabled.
+ */
+static void tx_queue_advance(void)
+{
+    uint32_t err_code;
+
+    m_tx_buf_state[m_tx_queue[m_tx_queue_head]] = HAL_TRANSP_BUF_STATE_FREE;
+    m_tx_queue_head = (uint8_t)((m_tx_queue_head + 1) % SER_HAL_TRANSPORT_TX_BUF_COUNT);
+    m_tx_queue_count--;
+
+    if (0 == m_tx_queue_count)
+    {
+        m_tx_state = HAL_TRANSP_TX_STATE_IDLE;
+    }
+    else
+    {
+        /* The PHY layer has just finished a transmission, so it cannot be busy. */
+        err_code = ser_phy_tx_pkt_send(m_tx_buffer[m_tx_queue[m_tx_queue_head]],
+                                       m_tx_queue_len[m_tx_queue_head]);
+        APP_ERROR_CHECK(err_code);
+    }
+}
+
+
 /**
  * @brief A callback function to be used to handle a PHY module events. This function is called in
  *        an interrupt context.
@@ -87,9 +229,9 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
         {
             if (HAL_TRANSP_TX_STATE_TRANSMITTING == m_tx_state)
             {
-                m_tx_state = HAL_TRANSP_TX_STATE_TRANSMITTED;
-                err_code   = ser_hal_transport_tx_pkt_free(m_tx_buffer);
-                APP_ERROR_CHECK(err_code);
+                /* Start the next queued packet before notifying the upper layer, so that the PHY
+                 * layer does not stay idle. */
+                tx_queue_advance();
                 /* An event to an upper layer that a packet has been transmitted. */
                 hal_transp_event.evt_type = SER_HAL_TRANSP_EVT_TX_PKT_SENT;
                 m_events_handler(hal_transp_event);
@@ -107,51 +249,35 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
             /* An event to an upper layer that a packet is being scheduled to receive or to drop. */
             hal_transp_event.evt_type = SER_HAL_TRANSP_EVT_RX_PKT_RECEIVING;
 
+            if (HAL_TRANSP_RX_STATE_IDLE != m_rx_state)
+            {
+                /* Lower layer should not generate this event in current state. */
+                APP_ERROR_CHECK_BOOL(false);
+            }
             /* Receive or drop a packet. */
-            if (phy_event.evt_params.rx_buf_request.num_of_bytes <= sizeof (m_rx_buffer))
+            else if (phy_event.evt_params.rx_buf_request.num_of_bytes <=
+                     SER_HAL_TRANSPORT_RX_MAX_PKT_SIZE)
             {
-                if (HAL_TRANSP_RX_STATE_IDLE == m_rx_state)
-                {
-                    m_events_handler(hal_transp_event);
-                    err_code = ser_phy_rx_buf_set(m_rx_buffer);
-                    APP_ERROR_CHECK(err_code);
-                    m_rx_state = HAL_TRANSP_RX_STATE_RECEIVING;
-                }
-                else if (HAL_TRANSP_RX_STATE_RECEIVED == m_rx_state)
+                m_events_handler(hal_transp_event);
+                err_code = rx_buf_set();
+                if (NRF_ERROR_NO_MEM == err_code)
                 {
                     /* It is OK to get know higher layer at this point that we are going to receive
-                     * a new packet even though we will start receiving when rx buffer is freed. */
-                    m_events_handler(hal_transp_event);
-                    m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED_PENDING_BUF_REQ;
+                     * a new packet even though we will start receiving when an RX buffer is freed. */
+                    m_rx_state = HAL_TRANSP_RX_STATE_PENDING_BUF_REQ;
                 }
                 else
                 {
-                    /* Lower layer should not generate this event in current state. */
-                    APP_ERROR_CHECK_BOOL(false);
+                    APP_ERROR_CHECK(err_code);
                 }
             }
             else
             {
                 /* There is not enough memory but packet has to be received to dummy location. */
-                if (HAL_TRANSP_RX_STATE_IDLE == m_rx_state)
-                {
-                    m_events_handler(hal_transp_event);
-                    err_code = ser_phy_rx_buf_set(NULL);
-                    APP_ERROR_CHECK(err_code);
-                    m_rx_state = HAL_TRANSP_RX_STATE_DROPPING;
-                }
-                else if (HAL_TRANSP_RX_STATE_RECEIVED == m_rx_state)
-                {
-                    m_events_handler(hal_transp_event);
-                    err_code = ser_phy_rx_buf_set(NULL);
-                    APP_ERROR_CHECK(err_code);
-                    m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED_DROPPING;
-                }
-                else
-                {
-                    /* Lower layer should not generate this event in current state. */
-                    APP_ERROR_CHECK_BOOL(false);
-                }
+                m_events_handler(hal_transp_event);
+                err_code = ser_phy_rx_buf_set(NULL);
+                APP_ERROR_CHECK(err_code);
+                m_rx_state = HAL_TRANSP_RX_STATE_DROPPING;
             }
             break;
         }
@@ -160,7 +286,8 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
         {
             if (HAL_TRANSP_RX_STATE_RECEIVING == m_rx_state)
             {
-                m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED;
+                m_rx_buf_state[m_rx_buf_idx] = HAL_TRANSP_BUF_STATE_RECEIVED;
+                m_rx_state                   = HAL_TRANSP_RX_STATE_IDLE;
                 /* Generate the event to an upper layer. */
                 hal_transp_event.evt_type =
                     SER_HAL_TRANSP_EVT_RX_PKT_RECEIVED;
@@ -187,13 +314,6 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
                 m_events_handler(hal_transp_event);
                 m_rx_state = HAL_TRANSP_RX_STATE_IDLE;
             }
-            else if (HAL_TRANSP_RX_STATE_RECEIVED_DROPPING == m_rx_state)
-            {
-                /* Generate the event to an upper layer. */
-                hal_transp_event.evt_type = SER_HAL_TRANSP_EVT_RX_PKT_DROPPED;
-                m_events_handler(hal_transp_event);
-                m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED;
-            }
             else
             {
                 /* Lower layer should not generate this event in current state. */
@@ -232,16 +352,13 @@ static void phy_events_handler(ser_phy_evt_t phy_event)
                 phy_event.evt_params.hw_error.error_code;
             if (HAL_TRANSP_TX_STATE_TRANSMITTING == m_tx_state)
             {
-                m_tx_state = HAL_TRANSP_TX_STATE_TRANSMITTED;
-                err_code   = ser_hal_transport_tx_pkt_free(phy_event.evt_params.hw_error.p_buffer);
-                APP_ERROR_CHECK(err_code);
-                /* An event to an upper layer that a packet has been transmitted. */
+                /* The packet under transmission is lost, continue with the next queued packet. */
+                tx_queue_advance();
             }
             else if (HAL_TRANSP_RX_STATE_RECEIVING == m_rx_state)
             {
-                m_rx_state = HAL_TRANSP_RX_STATE_RECEIVED;
-                err_code   = ser_hal_transport_rx_pkt_free(phy_event.evt_params.hw_error.p_buffer);
-                APP_ERROR_CHECK(err_code);
+                m_rx_buf_state[m_rx_buf_idx] = HAL_TRANSP_BUF_STATE_FREE;
+                m_rx_state                   = HAL_TRANSP_RX_STATE_IDLE;
             }
             m_events_handler(hal_transp_event);
 
@@ -276,6 +393,11 @@ uint32_t ser_hal_transport_open(ser_hal_transport_events_handler_t events_handle
         m_rx_state = HAL_TRANSP_RX_STATE_IDLE;
         m_tx_state = HAL_TRANSP_TX_STATE_IDLE;
 
+        memset(m_tx_buf_state, 0, sizeof (m_tx_buf_state));
+        memset(m_rx_buf_state, 0, sizeof (m_rx_buf_state));
+        m_tx_queue_head  = 0;
+        m_tx_queue_count = 0;
+
         m_events_handler = events_handler;
 
         /* Initialize a PHY module. */
@@ -314,6 +436,7 @@ void ser_hal_transport_close(void)
 uint32_t ser_hal_transport_rx_pkt_free(uint8_t * p_buffer)
 {
     uint32_t err_code = NRF_SUCCESS;
+    uint32_t idx      = rx_buf_idx_get(p_buffer);
 
     ser_phy_interrupts_disable();
 
@@ -321,29 +444,23 @@ uint32_t ser_hal_transport_rx_pkt_free(uint8_t * p_buffer)
     {
         err_code = NRF_ERROR_NULL;
     }
-    else if (p_buffer != m_rx_buffer)
+    else if (SER_HAL_TRANSPORT_RX_BUF_COUNT == idx)
     {
         err_code = NRF_ERROR_INVALID_ADDR;
     }
-    else if (HAL_TRANSP_RX_STATE_RECEIVED == m_rx_state)
-    {
-        m_rx_state = HAL_TRANSP_RX_STATE_IDLE;
-    }
-    else if (HAL_TRANSP_RX_STATE_RECEIVED_DROPPING == m_rx_state)
+    else if (HAL_TRANSP_BUF_STATE_RECEIVED == m_rx_buf_state[idx])
     {
-        m_rx_state = HAL_TRANSP_RX_STATE_DROPPING;
-    }
-    else if (HAL_TRANSP_RX_STATE_RECEIVED_PENDING_BUF_REQ == m_rx_state)
-    {
-        err_code = ser_phy_rx_buf_set(m_rx_buffer);
+        m_rx_buf_state[idx] = HAL_TRANSP_BUF_STATE_FREE;
 
-        if (NRF_SUCCESS == err_code)
+        if (HAL_TRANSP_RX_STATE_PENDING_BUF_REQ == m_rx_state)
         {
-            m_rx_state = HAL_TRANSP_RX_STATE_RECEIVING;
-        }
-        else
-        {
-            err_code = NRF_ERROR_INTERNAL;
+            /* The PHY layer is waiting for a buffer to receive the next packet. */
+            err_code = rx_buf_set();
+
+            if (NRF_SUCCESS != err_code)
+            {
+                err_code = NRF_ERROR_INTERNAL;
+            }
         }
     }
     else
@@ -360,6 +477,7 @@ uint32_t ser_hal_transport_rx_pkt_free(uint8_t * p_buffer)
 uint32_t ser_hal_transport_tx_pkt_alloc(uint8_t * * pp_memory, uint16_t * p_num_of_bytes)
 {
     uint32_t err_code = NRF_SUCCESS;
+    uint32_t idx;
 
     if ((NULL == pp_memory) || (NULL == p_num_of_bytes))
     {
@@ -369,15 +487,30 @@ uint32_t ser_hal_transport_tx_pkt_alloc(uint8_t * * pp_memory, uint16_t * p_num_
     {
         err_code = NRF_ERROR_INVALID_STATE;
     }
-    else if (HAL_TRANSP_TX_STATE_IDLE == m_tx_state)
-    {
-        m_tx_state      = HAL_TRANSP_TX_STATE_TX_ALLOCATED;
-        *pp_memory      = &m_tx_buffer[0];
-        *p_num_of_bytes = (uint16_t)sizeof (m_tx_buffer);
-    }
     else
     {
-        err_code = NRF_ERROR_NO_MEM;
+        /* Buffers are released in an interrupt context. */
+        ser_phy_interrupts_disable();
+        for (idx = 0; idx < SER_HAL_TRANSPORT_TX_BUF_COUNT; idx++)
+        {
+            if (HAL_TRANSP_BUF_STATE_FREE == m_tx_buf_state[idx])
+            {
+                m_tx_buf_state[idx] = HAL_TRANSP_BUF_STATE_ALLOCATED;
+                break;
+            }
+        }
+        ser_phy_interrupts_enable();
+
+        if (idx < SER_HAL_TRANSPORT_TX_BUF_COUNT)
+        {
+            *pp_memory      = &m_tx_buffer[idx][0];
+            *p_num_of_bytes = (uint16_t)sizeof (m_tx_buffer[idx]);
+        }
+        else
+        {
+            /* All buffers are allocated or queued for transmission. */
+            err_code = NRF_ERROR_NO_MEM;
+        }
     }
 
     return err_code;
@@ -387,6 +520,8 @@ uint32_t ser_hal_transport_tx_pkt_alloc(uint8_t * * pp_memory, uint16_t * p_num_
 uint32_t ser_hal_transport_tx_pkt_send(const uint8_t * p_buffer, uint16_t num_of_bytes)
 {
     uint32_t err_code = NRF_SUCCESS;
+    uint32_t idx      = tx_buf_idx_get(p_buffer);
+    uint32_t tail;
 
     /* The buffer provided to this function must be allocated through ser_hal_transport_tx_alloc()
      * function - this assures correct state and that correct memory buffer is used. */
@@ -398,30 +533,42 @@ uint32_t ser_hal_transport_tx_pkt_send(const uint8_t * p_buffer, uint16_t num_of
     {
         err_code = NRF_ERROR_INVALID_PARAM;
     }
-    else if (p_buffer != m_tx_buffer)
+    else if (SER_HAL_TRANSPORT_TX_BUF_COUNT == idx)
     {
         err_code = NRF_ERROR_INVALID_ADDR;
     }
-    else if (num_of_bytes > sizeof (m_tx_buffer))
+    else if (num_of_bytes > sizeof (m_tx_buffer[idx]))
     {
         err_code = NRF_ERROR_DATA_SIZE;
     }
-    else if (HAL_TRANSP_TX_STATE_TX_ALLOCATED == m_tx_state)
+    else if ((HAL_TRANSP_TX_STATE_CLOSED != m_tx_state) &&
+             (HAL_TRANSP_BUF_STATE_ALLOCATED == m_tx_buf_state[idx]))
     {
         ser_phy_interrupts_disable();
-        err_code = ser_phy_tx_pkt_send(p_buffer, num_of_bytes);
 
-        if (NRF_SUCCESS == err_code)
-        {
-            m_tx_state = HAL_TRANSP_TX_STATE_TRANSMITTING;
-        }
-        else
+        if (HAL_TRANSP_TX_STATE_IDLE == m_tx_state)
         {
-            if (NRF_ERROR_BUSY != err_code)
+            err_code = ser_phy_tx_pkt_send(p_buffer, num_of_bytes);
+
+            if (NRF_SUCCESS == err_code)
+            {
+                m_tx_state = HAL_TRANSP_TX_STATE_TRANSMITTING;
+            }
+            else if (NRF_ERROR_BUSY != err_code)
             {
                 err_code = NRF_ERROR_INTERNAL;
             }
         }
+
+        if (NRF_SUCCESS == err_code)
+        {
+            /* Transmitted now or when the packets queued before it have been transmitted. */
+            tail                 = (m_tx_queue_head + m_tx_queue_count) % SER_HAL_TRANSPORT_TX_BUF_COUNT;
+            m_tx_queue[tail]     = (uint8_t)idx;
+            m_tx_queue_len[tail] = num_of_bytes;
+            m_tx_queue_count++;
+            m_tx_buf_state[idx]  = HAL_TRANSP_BUF_STATE_QUEUED;
+        }
         ser_phy_interrupts_enable();
     }
     else
@@ -436,20 +583,21 @@ uint32_t ser_hal_transport_tx_pkt_send(const uint8_t * p_buffer, uint16_t num_of
 uint32_t ser_hal_transport_tx_pkt_free(uint8_t * p_buffer)
 {
     uint32_t err_code = NRF_SUCCESS;
+    uint32_t idx      = tx_buf_idx_get(p_buffer);
 
     if (NULL == p_buffer)
     {
         err_code = NRF_ERROR_NULL;
     }
-    else if (p_buffer != m_tx_buffer)
+    else if (SER_HAL_TRANSPORT_TX_BUF_COUNT == idx)
     {
         err_code = NRF_ERROR_INVALID_ADDR;
     }
-    else if ((HAL_TRANSP_TX_STATE_TX_ALLOCATED == m_tx_state) ||
-             (HAL_TRANSP_TX_STATE_TRANSMITTED == m_tx_state))
+    else if (HAL_TRANSP_BUF_STATE_ALLOCATED == m_tx_buf_state[idx])
     {
-        /* Release TX buffer for use. */
-        m_tx_state = HAL_TRANSP_TX_STATE_IDLE;
+        /* Release TX buffer for use. Queued buffers are released when they have been
+         * transmitted. */
+        m_tx_buf_state[idx] = HAL_TRANSP_BUF_STATE_FREE;
     }
     else
     {
@@ -150,6 +150,8 @@ void ser_hal_transport_close(void);
  *       @ref SER_HAL_TRANSP_EVT_RX_PKT_RECEIVED when the received data has beed processed. The function
  *       frees the RX memory pointed by p_buffer. The memory, immediately or at a later time, is
  *       reused by the underlying transport layer.
+ *       Up to @ref SER_HAL_TRANSPORT_RX_BUF_COUNT received packets can be held at a time. When all
+ *       of them are held, the reception of the next packet waits until one of them is freed.
  *
  * @param[in] p_buffer    A pointer to the beginning of the buffer that has been processed (has to be
  *                        the same address as provided in the event of type
@@ -167,6 +169,9 @@ uint32_t ser_hal_transport_rx_pkt_free(uint8_t * p_buffer);
 
 
 /**@brief Function for allocating memory for a TX packet.
+ *
+ * @note Up to @ref SER_HAL_TRANSPORT_TX_BUF_COUNT buffers can be allocated or queued for
+ *       transmission at a time, so a packet can be built while the previous ones are transmitted.
  *
  * @param[out] pp_memory       A pointer to pointer to which an address of the beginning of the
  *                             allocated buffer is written.
@@ -175,7 +180,8 @@ uint32_t ser_hal_transport_rx_pkt_free(uint8_t * p_buffer);
  *
  * @retval NRF_SUCCESS              Operation success. Memory was allocated.
  * @retval NRF_ERROR_NULL           Operation failure. NULL pointer supplied.
- * @retval NRF_ERROR_NO_MEM         Operation failure. No memory available.
+ * @retval NRF_ERROR_NO_MEM         Operation failure. No memory available: all the TX buffers
+ *                                  are allocated or queued for transmission.
  * @retval NRF_ERROR_INVALID_STATE  Operation failure. The function was called before calling
  *                                  @ref ser_hal_transport_open function.
  */
@@ -185,6 +191,8 @@ uint32_t ser_hal_transport_tx_pkt_alloc(uint8_t ** pp_memory, uint16_t * p_num_o
  *
  * @note The function adds a packet pointed by the p_buffer parameter to a transmission queue. A buffer
  *       provided to this function must be allocated by the @ref ser_hal_transport_tx_pkt_alloc function.
+ *       Packets are transmitted in the order in which they were added to the queue, and an event of type
+ *       @ref SER_HAL_TRANSP_EVT_TX_PKT_SENT is generated for each of them in the same order.
  *
  * @warning Completion of this method does not guarantee that actual peripheral transmission will be completed.
  *
@@ -0,0 +1,489 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Generated by ser_codegen.py from ble_s132.ser. Do not edit. */
+
+#include <string.h>
+#include "ble_serialization.h"
+#include "ble_gatts_conn.h"
+#include "ble_gattc_conn.h"
+#include "ble_gap_conn.h"
+#include "ble_evt_conn.h"
+#include "ble_gap_evt_conn.h"
+#include "ble_gattc_evt_conn.h"
+#include "ble_gatts_evt_conn.h"
+#include "app_util.h"
+
+#if SER_CODEC_GEN_ENABLED
+
+// Runs of members which are copied at once must be contiguous.
+STATIC_ASSERT(sizeof(((ble_gatts_hvx_params_t *)0)->handle) == 2);
+STATIC_ASSERT(sizeof(((ble_gatts_hvx_params_t *)0)->type) == 1);
+STATIC_ASSERT(offsetof(ble_gatts_hvx_params_t, type) == offsetof(ble_gatts_hvx_params_t, handle) + 2);
+STATIC_ASSERT(sizeof(((ble_gattc_write_params_t *)0)->write_op) == 1);
+STATIC_ASSERT(sizeof(((ble_gattc_write_params_t *)0)->flags) == 1);
+STATIC_ASSERT(sizeof(((ble_gattc_write_params_t *)0)->handle) == 2);
+STATIC_ASSERT(sizeof(((ble_gattc_write_params_t *)0)->offset) == 2);
+STATIC_ASSERT(offsetof(ble_gattc_write_params_t, flags) == offsetof(ble_gattc_write_params_t, write_op) + 1);
+STATIC_ASSERT(offsetof(ble_gattc_write_params_t, handle) == offsetof(ble_gattc_write_params_t, flags) + 1);
+STATIC_ASSERT(offsetof(ble_gattc_write_params_t, offset) == offsetof(ble_gattc_write_params_t, handle) + 2);
+STATIC_ASSERT(sizeof(((ble_gap_conn_params_t *)0)->min_conn_interval) == 2);
+STATIC_ASSERT(sizeof(((ble_gap_conn_params_t *)0)->max_conn_interval) == 2);
+STATIC_ASSERT(sizeof(((ble_gap_conn_params_t *)0)->slave_latency) == 2);
+STATIC_ASSERT(sizeof(((ble_gap_conn_params_t *)0)->conn_sup_timeout) == 2);
+STATIC_ASSERT(offsetof(ble_gap_conn_params_t, max_conn_interval) == offsetof(ble_gap_conn_params_t, min_conn_interval) + 2);
+STATIC_ASSERT(offsetof(ble_gap_conn_params_t, slave_latency) == offsetof(ble_gap_conn_params_t, max_conn_interval) + 2);
+STATIC_ASSERT(offsetof(ble_gap_conn_params_t, conn_sup_timeout) == offsetof(ble_gap_conn_params_t, slave_latency) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gap_evt.params.conn_param_update.conn_params.min_conn_interval) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gap_evt.params.conn_param_update.conn_params.slave_latency) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gap_evt.params.conn_param_update.conn_params.conn_sup_timeout) == 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval) == offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.min_conn_interval) + 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.slave_latency) == offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval) + 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.conn_sup_timeout) == offsetof(ble_evt_t, evt.gap_evt.params.conn_param_update.conn_params.slave_latency) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.conn_handle) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.gatt_status) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.error_handle) == 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.gatt_status) == offsetof(ble_evt_t, evt.gattc_evt.conn_handle) + 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.error_handle) == offsetof(ble_evt_t, evt.gattc_evt.gatt_status) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.hvx.handle) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.hvx.type) == 1);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.params.hvx.type) == offsetof(ble_evt_t, evt.gattc_evt.params.hvx.handle) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.write_rsp.handle) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.write_rsp.write_op) == 1);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.params.write_rsp.write_op) == offsetof(ble_evt_t, evt.gattc_evt.params.write_rsp.handle) + 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.write_rsp.offset) == 2);
+STATIC_ASSERT(sizeof(((ble_evt_t *)0)->evt.gattc_evt.params.write_rsp.len) == 2);
+STATIC_ASSERT(offsetof(ble_evt_t, evt.gattc_evt.params.write_rsp.len) == offsetof(ble_evt_t, evt.gattc_evt.params.write_rsp.offset) + 2);
+
+// The runs are copied in the byte order of the target and the wire format is little-endian,
+// as are the Cortex-M cores of the nRF5 devices.
+#if defined(__BYTE_ORDER__)
+STATIC_ASSERT(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);
+#elif defined(__BIG_ENDIAN) || (defined(__ICCARM__) && !__LITTLE_ENDIAN__)
+#error "The generated codecs need a little-endian target."
+#endif
+
+
+uint32_t ble_gatts_hvx_req_dec(uint8_t const * const            p_buf,
+                               uint32_t                         packet_len,
+                               uint16_t * const                 p_conn_handle,
+                               ble_gatts_hvx_params_t * * const pp_hvx_params)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT(packet_len > 0, NRF_ERROR_INVALID_PARAM);
+    SER_ASSERT(p_buf[0] == SD_BLE_GATTS_HVX, NRF_ERROR_INVALID_PARAM);
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(4, packet_len);
+    *p_conn_handle = uint16_decode(&p_buf[1]);
+    index = 4;
+    if (p_buf[index - 1] == SER_FIELD_PRESENT)
+    {
+        SER_ASSERT_NOT_NULL(pp_hvx_params);
+        SER_ASSERT_NOT_NULL(*pp_hvx_params);
+        ble_gatts_hvx_params_t * const p_hvx_params = *pp_hvx_params;
+        SER_ASSERT_LENGTH_LEQ(6, packet_len - index);
+        memcpy(&p_hvx_params->handle, &p_buf[index], 3);
+        p_hvx_params->offset = uint16_decode(&p_buf[index + 3]);
+        index += 6;
+        if (p_buf[index - 1] == SER_FIELD_PRESENT)
+        {
+            SER_ASSERT_NOT_NULL(p_hvx_params->p_len);
+            SER_ASSERT_LENGTH_LEQ(2, packet_len - index);
+            *p_hvx_params->p_len = uint16_decode(&p_buf[index]);
+            index += 2;
+        }
+        else if (p_buf[index - 1] == SER_FIELD_NOT_PRESENT)
+        {
+            p_hvx_params->p_len = NULL;
+        }
+        else
+        {
+            return NRF_ERROR_INVALID_DATA;
+        }
+        if (p_hvx_params->p_len != NULL)
+        {
+            SER_ASSERT_LENGTH_LEQ(1, packet_len - index);
+            index += 1;
+            if (p_buf[index - 1] == SER_FIELD_PRESENT)
+            {
+                SER_ASSERT_NOT_NULL(p_hvx_params->p_data);
+                SER_ASSERT_LENGTH_LEQ(*p_hvx_params->p_len, packet_len - index);
+                memcpy((uint8_t *)p_hvx_params->p_data, &p_buf[index], *p_hvx_params->p_len);
+                index += *p_hvx_params->p_len;
+            }
+            else
+            {
+                p_hvx_params->p_data = NULL;
+            }
+        }
+    }
+    else if (p_buf[index - 1] == SER_FIELD_NOT_PRESENT)
+    {
+        if (pp_hvx_params != NULL)
+        {
+            *pp_hvx_params = NULL;
+        }
+    }
+    else
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gatts_hvx_rsp_enc(uint32_t               return_code,
+                               uint8_t * const        p_buf,
+                               uint32_t * const       p_buf_len,
+                               uint16_t const * const p_bytes_written)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+
+    uint32_t index;
+    uint32_t len = 5;
+    if (return_code == NRF_SUCCESS)
+    {
+        len += 1;
+        if (p_bytes_written != NULL)
+        {
+            len += 2;
+        }
+    }
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    p_buf[SER_CMD_OP_CODE_POS] = SD_BLE_GATTS_HVX;
+    (void)uint32_encode(return_code, &p_buf[SER_CMD_RSP_STATUS_CODE_POS]);
+    index = 5;
+    if (return_code == NRF_SUCCESS)
+    {
+        p_buf[index] = (p_bytes_written == NULL) ? SER_FIELD_NOT_PRESENT : SER_FIELD_PRESENT;
+        index += 1;
+        if (p_bytes_written != NULL)
+        {
+            (void)uint16_encode(*p_bytes_written, &p_buf[index]);
+            index += 2;
+        }
+    }
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_hv_confirm_req_dec(uint8_t const * const p_buf,
+                                      uint32_t              packet_len,
+                                      uint16_t * const      p_conn_handle,
+                                      uint16_t * const      p_handle)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT(packet_len > 0, NRF_ERROR_INVALID_PARAM);
+    SER_ASSERT(p_buf[0] == SD_BLE_GATTC_HV_CONFIRM, NRF_ERROR_INVALID_PARAM);
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(5, packet_len);
+    *p_conn_handle = uint16_decode(&p_buf[1]);
+    *p_handle = uint16_decode(&p_buf[3]);
+    index = 5;
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_hv_confirm_rsp_enc(uint32_t         return_code,
+                                      uint8_t * const  p_buf,
+                                      uint32_t * const p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+
+    uint32_t index;
+    uint32_t len = 5;
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    p_buf[SER_CMD_OP_CODE_POS] = SD_BLE_GATTC_HV_CONFIRM;
+    (void)uint32_encode(return_code, &p_buf[SER_CMD_RSP_STATUS_CODE_POS]);
+    index = 5;
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_write_req_dec(uint8_t const * const              p_buf,
+                                 uint16_t                           packet_len,
+                                 uint16_t * const                   p_conn_handle,
+                                 ble_gattc_write_params_t * * const pp_write_params)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT(packet_len > 0, NRF_ERROR_INVALID_PARAM);
+    SER_ASSERT(p_buf[0] == SD_BLE_GATTC_WRITE, NRF_ERROR_INVALID_PARAM);
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(4, packet_len);
+    *p_conn_handle = uint16_decode(&p_buf[1]);
+    index = 4;
+    if (p_buf[index - 1] == SER_FIELD_PRESENT)
+    {
+        SER_ASSERT_NOT_NULL(pp_write_params);
+        SER_ASSERT_NOT_NULL(*pp_write_params);
+        ble_gattc_write_params_t * const p_write_params = *pp_write_params;
+        SER_ASSERT_LENGTH_LEQ(9, packet_len - index);
+        memcpy(&p_write_params->write_op, &p_buf[index], 6);
+        uint16_t const p_value_buf_len = p_write_params->len;
+        p_write_params->len = uint16_decode(&p_buf[index + 6]);
+        index += 9;
+        if (p_buf[index - 1] == SER_FIELD_PRESENT)
+        {
+            SER_ASSERT_NOT_NULL(p_write_params->p_value);
+            SER_ASSERT_LENGTH_LEQ(p_write_params->len, p_value_buf_len);
+            SER_ASSERT_LENGTH_LEQ(p_write_params->len, packet_len - index);
+            memcpy((uint8_t *)p_write_params->p_value, &p_buf[index], p_write_params->len);
+            index += p_write_params->len;
+        }
+        else
+        {
+            p_write_params->p_value = NULL;
+        }
+    }
+    else if (p_buf[index - 1] == SER_FIELD_NOT_PRESENT)
+    {
+        if (pp_write_params != NULL)
+        {
+            *pp_write_params = NULL;
+        }
+    }
+    else
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_write_rsp_enc(uint32_t         return_code,
+                                 uint8_t * const  p_buf,
+                                 uint32_t * const p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+
+    uint32_t index;
+    uint32_t len = 5;
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    p_buf[SER_CMD_OP_CODE_POS] = SD_BLE_GATTC_WRITE;
+    (void)uint32_encode(return_code, &p_buf[SER_CMD_RSP_STATUS_CODE_POS]);
+    index = 5;
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gap_conn_param_update_req_dec(uint8_t const * const           p_buf,
+                                           uint32_t                        packet_len,
+                                           uint16_t * const                p_conn_handle,
+                                           ble_gap_conn_params_t * * const pp_conn_params)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT(packet_len > 0, NRF_ERROR_INVALID_PARAM);
+    SER_ASSERT(p_buf[0] == SD_BLE_GAP_CONN_PARAM_UPDATE, NRF_ERROR_INVALID_PARAM);
+    SER_ASSERT_NOT_NULL(p_conn_handle);
+    SER_ASSERT_NOT_NULL(pp_conn_params);
+    SER_ASSERT_NOT_NULL(*pp_conn_params);
+
+    uint32_t index;
+    SER_ASSERT_LENGTH_LEQ(4, packet_len);
+    *p_conn_handle = uint16_decode(&p_buf[1]);
+    index = 4;
+    if (p_buf[index - 1] == SER_FIELD_PRESENT)
+    {
+        SER_ASSERT_NOT_NULL(pp_conn_params);
+        SER_ASSERT_NOT_NULL(*pp_conn_params);
+        ble_gap_conn_params_t * const p_conn_params = *pp_conn_params;
+        SER_ASSERT_LENGTH_LEQ(8, packet_len - index);
+        memcpy(&p_conn_params->min_conn_interval, &p_buf[index], 8);
+        index += 8;
+    }
+    else if (p_buf[index - 1] == SER_FIELD_NOT_PRESENT)
+    {
+        if (pp_conn_params != NULL)
+        {
+            *pp_conn_params = NULL;
+        }
+    }
+    else
+    {
+        return NRF_ERROR_INVALID_DATA;
+    }
+
+    SER_ASSERT_LENGTH_EQ(index, packet_len);
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gap_conn_param_update_rsp_enc(uint32_t         return_code,
+                                           uint8_t * const  p_buf,
+                                           uint32_t * const p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+
+    uint32_t index;
+    uint32_t len = 5;
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    p_buf[SER_CMD_OP_CODE_POS] = SD_BLE_GAP_CONN_PARAM_UPDATE;
+    (void)uint32_encode(return_code, &p_buf[SER_CMD_RSP_STATUS_CODE_POS]);
+    index = 5;
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_evt_tx_complete_enc(ble_evt_t const * const p_event,
+                                 uint32_t                event_len,
+                                 uint8_t * const         p_buf,
+                                 uint32_t * const        p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_event);
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+    SER_ASSERT(p_event->header.evt_id == BLE_EVT_TX_COMPLETE, NRF_ERROR_INVALID_PARAM);
+
+    uint32_t index;
+    uint32_t len = 5;
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    (void)uint16_encode(BLE_EVT_TX_COMPLETE, &p_buf[SER_EVT_ID_POS]);
+    (void)uint16_encode(p_event->evt.common_evt.conn_handle, &p_buf[2]);
+    p_buf[4] = p_event->evt.common_evt.params.tx_complete.count;
+    index = 5;
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gap_evt_conn_param_update_enc(ble_evt_t const * const p_event,
+                                           uint32_t                event_len,
+                                           uint8_t * const         p_buf,
+                                           uint32_t * const        p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_event);
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+    SER_ASSERT(p_event->header.evt_id == BLE_GAP_EVT_CONN_PARAM_UPDATE, NRF_ERROR_INVALID_PARAM);
+
+    uint32_t index;
+    uint32_t len = 12;
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    (void)uint16_encode(BLE_GAP_EVT_CONN_PARAM_UPDATE, &p_buf[SER_EVT_ID_POS]);
+    (void)uint16_encode(p_event->evt.gap_evt.conn_handle, &p_buf[2]);
+    memcpy(&p_buf[4], &p_event->evt.gap_evt.params.conn_param_update.conn_params.min_conn_interval, 8);
+    index = 12;
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_evt_hvx_enc(ble_evt_t const * const p_event,
+                               uint32_t                event_len,
+                               uint8_t * const         p_buf,
+                               uint32_t * const        p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_event);
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+    SER_ASSERT(p_event->header.evt_id == BLE_GATTC_EVT_HVX, NRF_ERROR_INVALID_PARAM);
+
+    uint32_t index;
+    uint32_t len = 13;
+    len += p_event->evt.gattc_evt.params.hvx.len;
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    (void)uint16_encode(BLE_GATTC_EVT_HVX, &p_buf[SER_EVT_ID_POS]);
+    memcpy(&p_buf[2], &p_event->evt.gattc_evt.conn_handle, 6);
+    memcpy(&p_buf[8], &p_event->evt.gattc_evt.params.hvx.handle, 3);
+    (void)uint16_encode(p_event->evt.gattc_evt.params.hvx.len, &p_buf[11]);
+    memcpy(&p_buf[13], p_event->evt.gattc_evt.params.hvx.data, p_event->evt.gattc_evt.params.hvx.len);
+    index = 13;
+    index += p_event->evt.gattc_evt.params.hvx.len;
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gattc_evt_write_rsp_enc(ble_evt_t const * const p_event,
+                                     uint32_t                event_len,
+                                     uint8_t * const         p_buf,
+                                     uint32_t * const        p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_event);
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+    SER_ASSERT(p_event->header.evt_id == BLE_GATTC_EVT_WRITE_RSP, NRF_ERROR_INVALID_PARAM);
+
+    uint32_t index;
+    uint32_t len = 15;
+    len += p_event->evt.gattc_evt.params.write_rsp.len;
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    (void)uint16_encode(BLE_GATTC_EVT_WRITE_RSP, &p_buf[SER_EVT_ID_POS]);
+    memcpy(&p_buf[2], &p_event->evt.gattc_evt.conn_handle, 6);
+    memcpy(&p_buf[8], &p_event->evt.gattc_evt.params.write_rsp.handle, 3);
+    memcpy(&p_buf[11], &p_event->evt.gattc_evt.params.write_rsp.offset, 4);
+    memcpy(&p_buf[15], p_event->evt.gattc_evt.params.write_rsp.data, p_event->evt.gattc_evt.params.write_rsp.len);
+    index = 15;
+    index += p_event->evt.gattc_evt.params.write_rsp.len;
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ble_gatts_evt_hvc_enc(ble_evt_t const * const p_event,
+                               uint32_t                event_len,
+                               uint8_t * const         p_buf,
+                               uint32_t * const        p_buf_len)
+{
+    SER_ASSERT_NOT_NULL(p_event);
+    SER_ASSERT_NOT_NULL(p_buf);
+    SER_ASSERT_NOT_NULL(p_buf_len);
+    SER_ASSERT(p_event->header.evt_id == BLE_GATTS_EVT_HVC, NRF_ERROR_INVALID_PARAM);
+
+    uint32_t index;
+    uint32_t len = 6;
+    SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);
+
+    (void)uint16_encode(BLE_GATTS_EVT_HVC, &p_buf[SER_EVT_ID_POS]);
+    (void)uint16_encode(p_event->evt.gatts_evt.conn_handle, &p_buf[2]);
+    (void)uint16_encode(p_event->evt.gatts_evt.params.hvc.handle, &p_buf[4]);
+    index = 6;
+
+    *p_buf_len = index;
+    return NRF_SUCCESS;
+}
+
+#endif // SER_CODEC_GEN_ENABLED
@@ -38,6 +38,7 @@ uint32_t ble_evt_user_mem_release_enc(ble_evt_t const * const p_event,
 
 
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_evt_tx_complete_enc(ble_evt_t const * const p_event,
                                  uint32_t                event_len,
                                  uint8_t * const         p_buf,
@@ -50,6 +51,7 @@ uint32_t ble_evt_tx_complete_enc(ble_evt_t const * const p_event,
 
     SER_EVT_ENC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_evt_user_mem_request_enc(ble_evt_t const * const p_event,
                                       uint32_t                event_len,
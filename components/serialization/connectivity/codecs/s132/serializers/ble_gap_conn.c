@@ -187,6 +187,7 @@ uint32_t ble_gap_authenticate_rsp_enc(uint32_t         return_code,
     SER_RSP_ENC_RESULT_ONLY(SD_BLE_GAP_AUTHENTICATE);
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gap_conn_param_update_req_dec(uint8_t const * const           p_buf,
                                            uint32_t                        packet_len,
                                            uint16_t *                      p_conn_handle,
@@ -210,6 +211,7 @@ uint32_t ble_gap_conn_param_update_rsp_enc(uint32_t         return_code,
 {
     SER_RSP_ENC_RESULT_ONLY(SD_BLE_GAP_CONN_PARAM_UPDATE);
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gap_conn_sec_get_req_dec(uint8_t const * const        p_buf,
                                       uint32_t                     packet_len,
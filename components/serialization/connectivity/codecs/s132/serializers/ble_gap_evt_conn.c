@@ -76,6 +76,7 @@ uint32_t ble_gap_evt_auth_status_enc(ble_evt_t const * const p_event,
 }
 
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gap_evt_conn_param_update_enc(ble_evt_t const * const p_event,
                                            uint32_t                event_len,
                                            uint8_t * const         p_buf,
@@ -88,6 +89,7 @@ uint32_t ble_gap_evt_conn_param_update_enc(ble_evt_t const * const p_event,
 
     SER_EVT_ENC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gap_evt_conn_param_update_request_enc(ble_evt_t const * const p_event,
                                                    uint32_t                event_len,
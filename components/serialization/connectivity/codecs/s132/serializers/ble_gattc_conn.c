@@ -145,6 +145,7 @@ uint32_t ble_gattc_descriptors_discover_rsp_enc(uint32_t         return_code,
     SER_RSP_ENC_RESULT_ONLY(SD_BLE_GATTC_DESCRIPTORS_DISCOVER);
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gattc_hv_confirm_req_dec(uint8_t const * const p_buf,
                                       uint32_t              packet_len,
                                       uint16_t * const      p_conn_handle,
@@ -164,6 +165,7 @@ uint32_t ble_gattc_hv_confirm_rsp_enc(uint32_t         return_code,
 {
     SER_RSP_ENC_RESULT_ONLY(SD_BLE_GATTC_HV_CONFIRM);
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gattc_primary_services_discover_req_dec(uint8_t const * const p_buf,
                                                      uint16_t              packet_len,
@@ -231,6 +233,7 @@ uint32_t ble_gattc_relationships_discover_rsp_enc(uint32_t         return_code,
     SER_RSP_ENC_RESULT_ONLY(SD_BLE_GATTC_RELATIONSHIPS_DISCOVER);
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gattc_write_req_dec(uint8_t const * const              p_buf,
                                  uint16_t                           packet_len,
                                  uint16_t * const                   p_conn_handle,
@@ -250,6 +253,7 @@ uint32_t ble_gattc_write_rsp_enc(uint32_t         return_code,
 {
     SER_RSP_ENC_RESULT_ONLY(SD_BLE_GATTC_WRITE);
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gattc_exchange_mtu_request_req_dec(uint8_t const * const       p_buf,
                                                 uint16_t                    packet_len,
@@ -96,6 +96,7 @@ uint32_t ble_gattc_evt_desc_disc_rsp_enc(ble_evt_t const * const p_event,
     SER_EVT_ENC_END;
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gattc_evt_hvx_enc(ble_evt_t const * const p_event,
                                uint32_t                event_len,
                                uint8_t * const         p_buf,
@@ -110,6 +111,7 @@ uint32_t ble_gattc_evt_hvx_enc(ble_evt_t const * const p_event,
 
     SER_EVT_ENC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gattc_evt_prim_srvc_disc_rsp_enc(ble_evt_t const * const p_event,
                                               uint32_t                event_len,
@@ -175,6 +177,7 @@ uint32_t ble_gattc_evt_timeout_enc(ble_evt_t const * const p_event,
     SER_EVT_ENC_END;
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gattc_evt_write_rsp_enc(ble_evt_t const * const p_event,
                                      uint32_t                event_len,
                                      uint8_t * const         p_buf,
@@ -190,6 +193,7 @@ uint32_t ble_gattc_evt_write_rsp_enc(ble_evt_t const * const p_event,
 
     SER_EVT_ENC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gattc_evt_exchange_mtu_rsp_enc(ble_evt_t const * const p_event,
                                             uint32_t                event_len,
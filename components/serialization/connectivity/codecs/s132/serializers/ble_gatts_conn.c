@@ -104,6 +104,7 @@ uint32_t ble_gatts_descriptor_add_rsp_enc(uint32_t         return_code,
     SER_RSP_ENC_END;
 }
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gatts_hvx_req_dec(uint8_t const * const            p_buf,
                                uint32_t                         packet_len,
                                uint16_t * const                 p_conn_handle,
@@ -128,6 +129,7 @@ uint32_t ble_gatts_hvx_rsp_enc(uint32_t               return_code,
 
     SER_RSP_ENC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 uint32_t ble_gatts_include_add_req_dec(uint8_t const * const p_buf,
                                        uint16_t              packet_len,
@@ -46,6 +46,7 @@ uint32_t ble_gatts_evt_rw_authorize_request_enc(ble_evt_t const * const p_event,
 }
 
 
+#if !SER_CODEC_GEN_ENABLED
 uint32_t ble_gatts_evt_hvc_enc(ble_evt_t const * const p_event,
                                uint32_t                event_len,
                                uint8_t * const         p_buf,
@@ -58,6 +59,7 @@ uint32_t ble_gatts_evt_hvc_enc(ble_evt_t const * const p_event,
 
     SER_EVT_ENC_END;
 }
+#endif // !SER_CODEC_GEN_ENABLED
 
 
 uint32_t ble_gatts_evt_sc_confirm_enc(ble_evt_t const * const p_event,
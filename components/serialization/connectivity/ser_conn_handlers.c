@@ -13,6 +13,7 @@
 #include <string.h>
 #include "app_error.h"
 #include "app_scheduler.h"
+#include "app_util_platform.h"
 #include "ser_config.h"
 #include "ser_conn_handlers.h"
 #include "ser_conn_event_encoder.h"
@@ -32,11 +33,16 @@
  *          the SoftDevice and events generated by the HAL Transport layer.
  */
 
-/** Parameters of a received packet. */
-static ser_hal_transport_evt_rx_pkt_received_params_t m_rx_pkt_received_params;
+/** Parameters of received packets, in the order of reception. The HAL Transport layer holds at most
+ *  SER_HAL_TRANSPORT_RX_BUF_COUNT received packets, so the queue cannot overflow. */
+static ser_hal_transport_evt_rx_pkt_received_params_t
+    m_rx_pkt_received_params[SER_HAL_TRANSPORT_RX_BUF_COUNT];
 
-/** Indicator of received packet that should be process. */
-static bool m_rx_pkt_to_process = false;
+/** Index of the next received packet to process. */
+static uint32_t m_rx_pkt_head = 0;
+
+/** Number of received packets that should be processed. */
+static volatile uint32_t m_rx_pkt_count = 0;
 
 
 void ser_conn_hal_transport_event_handle(ser_hal_transport_evt_t event)
@@ -69,9 +75,11 @@ void ser_conn_hal_transport_event_handle(ser_hal_transport_evt_t event)
             /* We can NOT add received packets as events to the application scheduler queue because
              * received packets have to be processed before SoftDevice events but the scheduler
              * queue do not have priorities. */
-            memcpy(&m_rx_pkt_received_params, &event.evt_params.rx_pkt_received,
+            memcpy(&m_rx_pkt_received_params[(m_rx_pkt_head + m_rx_pkt_count) %
+                                             SER_HAL_TRANSPORT_RX_BUF_COUNT],
+                   &event.evt_params.rx_pkt_received,
                    sizeof (ser_hal_transport_evt_rx_pkt_received_params_t));
-            m_rx_pkt_to_process = true;
+            m_rx_pkt_count++;
             break;
         }
 
@@ -100,12 +108,21 @@ uint32_t ser_conn_rx_process(void)
 {
     uint32_t err_code = NRF_SUCCESS;
 
-    if (m_rx_pkt_to_process)
+    ser_hal_transport_evt_rx_pkt_received_params_t rx_pkt_params;
+
+    if (m_rx_pkt_count > 0)
     {
-        /* No critical section needed on m_rx_pkt_to_process parameter because it is not possible
-         * to get next packet before sending a response. */
-        m_rx_pkt_to_process = false;
-        err_code            = ser_conn_received_pkt_process(&m_rx_pkt_received_params);
+        /* The packet is taken from the queue before it is processed because processing frees its
+         * buffer, which lets the HAL Transport layer report the next packet. The event handler
+         * writes to the slot after the queued packets, so the head and the count are updated
+         * together. */
+        CRITICAL_REGION_ENTER();
+        rx_pkt_params = m_rx_pkt_received_params[m_rx_pkt_head];
+        m_rx_pkt_head = (m_rx_pkt_head + 1) % SER_HAL_TRANSPORT_RX_BUF_COUNT;
+        m_rx_pkt_count--;
+        CRITICAL_REGION_EXIT();
+
+        err_code = ser_conn_received_pkt_process(&rx_pkt_params);
     }
 
     return err_code;
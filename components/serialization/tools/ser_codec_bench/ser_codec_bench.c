@@ -0,0 +1,916 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host test and benchmark of the generated serialization codecs.
+ *
+ * The hand-written codecs and the codecs generated from ble_s132.ser (with the gen_ prefix) are
+ * linked side by side. For each message of the schema, the test:
+ *  - encodes random commands, responses and events with both, into buffers of random size, and
+ *    compares the error codes, the lengths and the bytes,
+ *  - decodes the encoded messages with both, after truncating them, changing a byte or adding a
+ *    trailing byte in some iterations, and compares the error codes and the decoded data.
+ *
+ * Then each codec is run in a loop on a typical message and the throughput is printed in
+ * messages per second.
+ *
+ * Command line: iterations=<n> seconds=<n>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "ble.h"
+#include "ble_serialization.h"
+#include "ble_gap_app.h"
+#include "ble_gattc_app.h"
+#include "ble_gatts_app.h"
+#include "ble_evt_app.h"
+#include "ble_gap_evt_app.h"
+#include "ble_gattc_evt_app.h"
+#include "ble_gatts_evt_app.h"
+#include "ble_gap_conn.h"
+#include "ble_gattc_conn.h"
+#include "ble_gatts_conn.h"
+#include "ble_evt_conn.h"
+#include "ble_gap_evt_conn.h"
+#include "ble_gattc_evt_conn.h"
+#include "ble_gatts_evt_conn.h"
+#include "gen_app.h"
+#include "gen_conn.h"
+
+
+#define BUF_SIZE            (1024)      // Serialized messages.
+#define EVT_BUF_SIZE        (1024)      // Decoded events, with their extended data.
+#define DATA_MAX            (300)       // Maximum random data length, above the packet size.
+#define MAX_REPORTS         (20)        // Mismatches printed in full.
+
+#define ITERATIONS_DEFAULT  (20000)
+#define SECONDS_DEFAULT     (1)
+
+typedef uint32_t (*evt_enc_t)(ble_evt_t const * const, uint32_t, uint8_t * const, uint32_t * const);
+typedef uint32_t (*evt_dec_t)(uint8_t const * const, uint32_t, ble_evt_t * const, uint32_t * const);
+
+/**@brief   One set of codecs, hand-written or generated. */
+typedef struct
+{
+    char const * p_name;
+
+    uint32_t (*gatts_hvx_req_enc)(uint16_t, ble_gatts_hvx_params_t const * const, uint8_t * const, uint32_t * const);
+    uint32_t (*gatts_hvx_req_dec)(uint8_t const * const, uint32_t, uint16_t * const, ble_gatts_hvx_params_t * * const);
+    uint32_t (*gatts_hvx_rsp_enc)(uint32_t, uint8_t * const, uint32_t * const, uint16_t const * const);
+    uint32_t (*gatts_hvx_rsp_dec)(uint8_t const * const, uint32_t, uint32_t * const, uint16_t * * const);
+
+    uint32_t (*hv_confirm_req_enc)(uint16_t, uint16_t, uint8_t * const, uint32_t * const);
+    uint32_t (*hv_confirm_req_dec)(uint8_t const * const, uint32_t, uint16_t * const, uint16_t * const);
+    uint32_t (*hv_confirm_rsp_enc)(uint32_t, uint8_t * const, uint32_t * const);
+    uint32_t (*hv_confirm_rsp_dec)(uint8_t const * const, uint32_t, uint32_t * const);
+
+    uint32_t (*write_req_enc)(uint16_t, ble_gattc_write_params_t const * const, uint8_t * const, uint32_t *);
+    uint32_t (*write_req_dec)(uint8_t const * const, uint16_t, uint16_t * const, ble_gattc_write_params_t * * const);
+    uint32_t (*write_rsp_enc)(uint32_t, uint8_t * const, uint32_t * const);
+    uint32_t (*write_rsp_dec)(uint8_t const * const, uint32_t, uint32_t * const);
+
+    uint32_t (*cpu_req_enc)(uint16_t, ble_gap_conn_params_t const * const, uint8_t * const, uint32_t * const);
+    uint32_t (*cpu_req_dec)(uint8_t const * const, uint32_t, uint16_t *, ble_gap_conn_params_t * * const);
+    uint32_t (*cpu_rsp_enc)(uint32_t, uint8_t * const, uint32_t * const);
+    uint32_t (*cpu_rsp_dec)(uint8_t const * const, uint32_t, uint32_t * const);
+
+    evt_enc_t evt_enc[5];
+    evt_dec_t evt_dec[5];
+} codecs_t;
+
+static const uint16_t m_evt_ids[5] =
+{
+    BLE_EVT_TX_COMPLETE,
+    BLE_GAP_EVT_CONN_PARAM_UPDATE,
+    BLE_GATTC_EVT_HVX,
+    BLE_GATTC_EVT_WRITE_RSP,
+    BLE_GATTS_EVT_HVC,
+};
+
+static char const * const m_evt_names[5] =
+{
+    "evt_tx_complete",
+    "gap_evt_conn_param_update",
+    "gattc_evt_hvx",
+    "gattc_evt_write_rsp",
+    "gatts_evt_hvc",
+};
+
+static const codecs_t m_codecs[2] =
+{
+    {
+        "hand-written",
+        ble_gatts_hvx_req_enc, ble_gatts_hvx_req_dec, ble_gatts_hvx_rsp_enc, ble_gatts_hvx_rsp_dec,
+        ble_gattc_hv_confirm_req_enc, ble_gattc_hv_confirm_req_dec,
+        ble_gattc_hv_confirm_rsp_enc, ble_gattc_hv_confirm_rsp_dec,
+        ble_gattc_write_req_enc, ble_gattc_write_req_dec, ble_gattc_write_rsp_enc, ble_gattc_write_rsp_dec,
+        ble_gap_conn_param_update_req_enc, ble_gap_conn_param_update_req_dec,
+        ble_gap_conn_param_update_rsp_enc, ble_gap_conn_param_update_rsp_dec,
+        {ble_evt_tx_complete_enc, ble_gap_evt_conn_param_update_enc, ble_gattc_evt_hvx_enc,
+         ble_gattc_evt_write_rsp_enc, ble_gatts_evt_hvc_enc},
+        {ble_evt_tx_complete_dec, ble_gap_evt_conn_param_update_dec, ble_gattc_evt_hvx_dec,
+         ble_gattc_evt_write_rsp_dec, ble_gatts_evt_hvc_dec},
+    },
+    {
+        "generated",
+        gen_ble_gatts_hvx_req_enc, gen_ble_gatts_hvx_req_dec, gen_ble_gatts_hvx_rsp_enc, gen_ble_gatts_hvx_rsp_dec,
+        gen_ble_gattc_hv_confirm_req_enc, gen_ble_gattc_hv_confirm_req_dec,
+        gen_ble_gattc_hv_confirm_rsp_enc, gen_ble_gattc_hv_confirm_rsp_dec,
+        gen_ble_gattc_write_req_enc, gen_ble_gattc_write_req_dec, gen_ble_gattc_write_rsp_enc, gen_ble_gattc_write_rsp_dec,
+        gen_ble_gap_conn_param_update_req_enc, gen_ble_gap_conn_param_update_req_dec,
+        gen_ble_gap_conn_param_update_rsp_enc, gen_ble_gap_conn_param_update_rsp_dec,
+        {gen_ble_evt_tx_complete_enc, gen_ble_gap_evt_conn_param_update_enc, gen_ble_gattc_evt_hvx_enc,
+         gen_ble_gattc_evt_write_rsp_enc, gen_ble_gatts_evt_hvc_enc},
+        {gen_ble_evt_tx_complete_dec, gen_ble_gap_evt_conn_param_update_dec, gen_ble_gattc_evt_hvx_dec,
+         gen_ble_gattc_evt_write_rsp_dec, gen_ble_gatts_evt_hvc_dec},
+    },
+};
+
+static uint8_t  m_out[2][BUF_SIZE];                 // Encoder output of each codec set.
+static uint8_t  m_in[BUF_SIZE];                     // Decoder input.
+static uint8_t  m_data[BUF_SIZE];                   // Random payloads.
+static uint32_t m_evt[2][EVT_BUF_SIZE / 4];         // Decoded events, word aligned.
+static uint32_t m_evt_in[EVT_BUF_SIZE / 4];         // Event to encode.
+
+static uint32_t m_rng = 0x2545F491;
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+
+static uint32_t rnd(void)
+{
+    m_rng ^= m_rng << 13;
+    m_rng ^= m_rng >> 17;
+    m_rng ^= m_rng << 5;
+    return m_rng;
+}
+
+
+static uint32_t rnd_below(uint32_t n)
+{
+    return (n == 0) ? 0 : rnd() % n;
+}
+
+
+static void check(bool ok, char const * p_msg, char const * p_what)
+{
+    m_checks++;
+    if (!ok)
+    {
+        if (m_failures < MAX_REPORTS)
+        {
+            printf("MISMATCH %s: %s\n", p_msg, p_what);
+        }
+        m_failures++;
+    }
+}
+
+
+/**@brief   Compares the results of the two encoders, which wrote to m_out[0] and m_out[1]. */
+static void compare_enc(char const * p_msg, uint32_t const err[2], uint32_t const len[2])
+{
+    check(err[0] == err[1], p_msg, "encoder error code");
+    if ((err[0] == NRF_SUCCESS) && (err[1] == NRF_SUCCESS))
+    {
+        check(len[0] == len[1], p_msg, "encoded length");
+        check(memcmp(m_out[0], m_out[1], len[0]) == 0, p_msg, "encoded bytes");
+    }
+}
+
+
+/**@brief   Size of the buffer given to an encoder: around the needed size, sometimes short. */
+static uint32_t enc_buf_len(void)
+{
+    return (rnd() % 4 == 0) ? rnd_below(40) : BUF_SIZE;
+}
+
+
+/**@brief   Copies an encoded message to the decoder input, damaging it in some iterations.
+ *
+ * @return  The length of the decoder input.
+ */
+static uint32_t mutate(uint8_t const * p_msg, uint32_t len)
+{
+    memcpy(m_in, p_msg, len);
+    switch (rnd() % 8)
+    {
+        case 0:
+            return rnd_below(len + 1);
+
+        case 1:
+            if (len > 0)
+            {
+                m_in[rnd_below(len)] = (uint8_t)rnd();
+            }
+            return len;
+
+        case 2:
+            if (len > 0)
+            {
+                m_in[rnd_below(len)] ^= (uint8_t)(1 << rnd_below(8));
+            }
+            return len;
+
+        case 3:
+            m_in[len] = (uint8_t)rnd();
+            return len + 1;
+
+        default:
+            return len;
+    }
+}
+
+
+static void fill_random(uint8_t * p_data, uint32_t len)
+{
+    for (uint32_t i = 0; i < len; i++)
+    {
+        p_data[i] = (uint8_t)rnd();
+    }
+}
+
+
+static uint32_t rnd_result(void)
+{
+    return (rnd() % 4 == 0) ? NRF_ERROR_INVALID_STATE + rnd_below(4) : NRF_SUCCESS;
+}
+
+
+static void test_gatts_hvx(void)
+{
+    uint32_t err[2];
+    uint32_t len[2];
+
+    // Request.
+    uint16_t               conn_handle = (uint16_t)rnd();
+    uint16_t               hvx_len     = (uint16_t)rnd_below(DATA_MAX);
+    ble_gatts_hvx_params_t params      =
+    {
+        .handle = (uint16_t)rnd(),
+        .type   = (uint8_t)rnd(),
+        .offset = (uint16_t)rnd(),
+        .p_len  = (rnd() % 4 == 0) ? NULL : &hvx_len,
+        .p_data = (rnd() % 4 == 0) ? NULL : m_data,
+    };
+    ble_gatts_hvx_params_t const * p_params = (rnd() % 8 == 0) ? NULL : &params;
+    uint32_t buf_len = enc_buf_len();
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        len[i] = buf_len;
+        err[i] = m_codecs[i].gatts_hvx_req_enc(conn_handle, p_params, m_out[i], &len[i]);
+    }
+    compare_enc("gatts_hvx_req_enc", err, len);
+
+    if (err[0] == NRF_SUCCESS)
+    {
+        static uint8_t data_out[2][0x10000];   // *p_len is not checked against the buffer.
+        uint32_t in_len = mutate(m_out[0], len[0]);
+        uint16_t handle_out[2];
+        uint16_t len_out[2];
+        ble_gatts_hvx_params_t params_out[2];
+        ble_gatts_hvx_params_t * p_params_out[2];
+        bool give_params = (rnd() % 16 != 0);
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            memset(&params_out[i], 0, sizeof(params_out[i]));
+            params_out[i].p_len  = &len_out[i];
+            params_out[i].p_data = data_out[i];
+            p_params_out[i]      = give_params ? &params_out[i] : NULL;
+            err[i] = m_codecs[i].gatts_hvx_req_dec(m_in, in_len, &handle_out[i], &p_params_out[i]);
+        }
+        check(err[0] == err[1], "gatts_hvx_req_dec", "error code");
+        if ((err[0] == NRF_SUCCESS) && (err[1] == NRF_SUCCESS))
+        {
+            check(handle_out[0] == handle_out[1], "gatts_hvx_req_dec", "conn_handle");
+            check((p_params_out[0] == NULL) == (p_params_out[1] == NULL), "gatts_hvx_req_dec", "params");
+            if ((p_params_out[0] != NULL) && (p_params_out[1] != NULL))
+            {
+                ble_gatts_hvx_params_t const * p0 = p_params_out[0];
+                ble_gatts_hvx_params_t const * p1 = p_params_out[1];
+                check((p0->handle == p1->handle) && (p0->type == p1->type) && (p0->offset == p1->offset),
+                      "gatts_hvx_req_dec", "params fields");
+                check((p0->p_len == NULL) == (p1->p_len == NULL), "gatts_hvx_req_dec", "p_len");
+                if ((p0->p_len != NULL) && (p1->p_len != NULL))
+                {
+                    check(*p0->p_len == *p1->p_len, "gatts_hvx_req_dec", "*p_len");
+                    check((p0->p_data == NULL) == (p1->p_data == NULL), "gatts_hvx_req_dec", "p_data");
+                    if ((p0->p_data != NULL) && (p1->p_data != NULL) && (*p0->p_len == *p1->p_len))
+                    {
+                        check(memcmp(p0->p_data, p1->p_data, *p0->p_len) == 0, "gatts_hvx_req_dec", "data");
+                    }
+                }
+            }
+        }
+    }
+
+    // Response.
+    uint32_t result        = rnd_result();
+    uint16_t bytes_written = (uint16_t)rnd();
+    uint16_t const * p_bytes_written = (rnd() % 4 == 0) ? NULL : &bytes_written;
+    buf_len = (rnd() % 4 == 0) ? rnd_below(10) : BUF_SIZE;
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        len[i] = buf_len;
+        err[i] = m_codecs[i].gatts_hvx_rsp_enc(result, m_out[i], &len[i], p_bytes_written);
+    }
+    compare_enc("gatts_hvx_rsp_enc", err, len);
+
+    if (err[0] == NRF_SUCCESS)
+    {
+        uint32_t in_len = mutate(m_out[0], len[0]);
+        uint32_t result_out[2] = {0, 0};
+        uint16_t written_out[2] = {0, 0};
+        uint16_t * p_written_out[2];
+        bool give_written = (rnd() % 16 != 0);
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            p_written_out[i] = give_written ? &written_out[i] : NULL;
+            err[i] = m_codecs[i].gatts_hvx_rsp_dec(m_in, in_len, &result_out[i], &p_written_out[i]);
+        }
+        check(err[0] == err[1], "gatts_hvx_rsp_dec", "error code");
+        if ((err[0] == NRF_SUCCESS) && (err[1] == NRF_SUCCESS))
+        {
+            check(result_out[0] == result_out[1], "gatts_hvx_rsp_dec", "result code");
+            check((p_written_out[0] == NULL) == (p_written_out[1] == NULL), "gatts_hvx_rsp_dec", "p_bytes_written");
+            check(written_out[0] == written_out[1], "gatts_hvx_rsp_dec", "bytes_written");
+        }
+    }
+}
+
+
+static void test_hv_confirm(void)
+{
+    uint32_t err[2];
+    uint32_t len[2];
+    uint16_t conn_handle = (uint16_t)rnd();
+    uint16_t handle      = (uint16_t)rnd();
+    uint32_t buf_len     = (rnd() % 4 == 0) ? rnd_below(8) : BUF_SIZE;
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        len[i] = buf_len;
+        err[i] = m_codecs[i].hv_confirm_req_enc(conn_handle, handle, m_out[i], &len[i]);
+    }
+    compare_enc("gattc_hv_confirm_req_enc", err, len);
+
+    if (err[0] == NRF_SUCCESS)
+    {
+        uint32_t in_len = mutate(m_out[0], len[0]);
+        uint16_t conn_handle_out[2];
+        uint16_t handle_out[2];
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            err[i] = m_codecs[i].hv_confirm_req_dec(m_in, in_len, &conn_handle_out[i], &handle_out[i]);
+        }
+        check(err[0] == err[1], "gattc_hv_confirm_req_dec", "error code");
+        if ((err[0] == NRF_SUCCESS) && (err[1] == NRF_SUCCESS))
+        {
+            check((conn_handle_out[0] == conn_handle_out[1]) && (handle_out[0] == handle_out[1]),
+                  "gattc_hv_confirm_req_dec", "fields");
+        }
+    }
+
+    uint32_t result = rnd_result();
+    buf_len = (rnd() % 4 == 0) ? rnd_below(8) : BUF_SIZE;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        len[i] = buf_len;
+        err[i] = m_codecs[i].hv_confirm_rsp_enc(result, m_out[i], &len[i]);
+    }
+    compare_enc("gattc_hv_confirm_rsp_enc", err, len);
+
+    if (err[0] == NRF_SUCCESS)
+    {
+        uint32_t in_len = mutate(m_out[0], len[0]);
+        uint32_t result_out[2] = {0, 0};
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            err[i] = m_codecs[i].hv_confirm_rsp_dec(m_in, in_len, &result_out[i]);
+        }
+        check(err[0] == err[1], "gattc_hv_confirm_rsp_dec", "error code");
+        check((err[0] != NRF_SUCCESS) || (result_out[0] == result_out[1]),
+              "gattc_hv_confirm_rsp_dec", "result code");
+    }
+}
+
+
+static void test_gattc_write(void)
+{
+    uint32_t err[2];
+    uint32_t len[2];
+    uint16_t conn_handle = (uint16_t)rnd();
+    ble_gattc_write_params_t params =
+    {
+        .write_op = (uint8_t)rnd(),
+        .flags    = (uint8_t)rnd(),
+        .handle   = (uint16_t)rnd(),
+        .offset   = (uint16_t)rnd(),
+        .len      = (uint16_t)rnd_below(2 * BLE_GATTC_WRITE_P_VALUE_LEN_MAX),
+        .p_value  = (rnd() % 4 == 0) ? NULL : m_data,
+    };
+    ble_gattc_write_params_t const * p_params = (rnd() % 8 == 0) ? NULL : &params;
+    uint32_t buf_len = enc_buf_len();
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        len[i] = buf_len;
+        err[i] = m_codecs[i].write_req_enc(conn_handle, p_params, m_out[i], &len[i]);
+    }
+    compare_enc("gattc_write_req_enc", err, len);
+
+    if (err[0] == NRF_SUCCESS)
+    {
+        uint32_t in_len = mutate(m_out[0], len[0]);
+        uint16_t handle_out[2];
+        uint8_t  value_out[2][BLE_GATTC_WRITE_P_VALUE_LEN_MAX];
+        ble_gattc_write_params_t params_out[2];
+        ble_gattc_write_params_t * p_params_out[2];
+        bool give_params = (rnd() % 16 != 0);
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            memset(&params_out[i], 0, sizeof(params_out[i]));
+            params_out[i].len     = BLE_GATTC_WRITE_P_VALUE_LEN_MAX;
+            params_out[i].p_value = value_out[i];
+            p_params_out[i]       = give_params ? &params_out[i] : NULL;
+            err[i] = m_codecs[i].write_req_dec(m_in, (uint16_t)in_len, &handle_out[i], &p_params_out[i]);
+        }
+        check(err[0] == err[1], "gattc_write_req_dec", "error code");
+        if ((err[0] == NRF_SUCCESS) && (err[1] == NRF_SUCCESS))
+        {
+            check(handle_out[0] == handle_out[1], "gattc_write_req_dec", "conn_handle");
+            check((p_params_out[0] == NULL) == (p_params_out[1] == NULL), "gattc_write_req_dec", "params");
+            if ((p_params_out[0] != NULL) && (p_params_out[1] != NULL))
+            {
+                ble_gattc_write_params_t const * p0 = p_params_out[0];
+                ble_gattc_write_params_t const * p1 = p_params_out[1];
+                check((p0->write_op == p1->write_op) && (p0->flags == p1->flags)
+                      && (p0->handle == p1->handle) && (p0->offset == p1->offset) && (p0->len == p1->len),
+                      "gattc_write_req_dec", "params fields");
+                check((p0->p_value == NULL) == (p1->p_value == NULL), "gattc_write_req_dec", "p_value");
+                if ((p0->p_value != NULL) && (p1->p_value != NULL) && (p0->len == p1->len))
+                {
+                    check(memcmp(p0->p_value, p1->p_value, p0->len) == 0, "gattc_write_req_dec", "value");
+                }
+            }
+        }
+    }
+
+    uint32_t result = rnd_result();
+    buf_len = (rnd() % 4 == 0) ? rnd_below(8) : BUF_SIZE;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        len[i] = buf_len;
+        err[i] = m_codecs[i].write_rsp_enc(result, m_out[i], &len[i]);
+    }
+    compare_enc("gattc_write_rsp_enc", err, len);
+
+    if (err[0] == NRF_SUCCESS)
+    {
+        uint32_t in_len = mutate(m_out[0], len[0]);
+        uint32_t result_out[2] = {0, 0};
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            err[i] = m_codecs[i].write_rsp_dec(m_in, in_len, &result_out[i]);
+        }
+        check(err[0] == err[1], "gattc_write_rsp_dec", "error code");
+        check((err[0] != NRF_SUCCESS) || (result_out[0] == result_out[1]),
+              "gattc_write_rsp_dec", "result code");
+    }
+}
+
+
+static void test_conn_param_update(void)
+{
+    uint32_t err[2];
+    uint32_t len[2];
+    uint16_t conn_handle = (uint16_t)rnd();
+    ble_gap_conn_params_t params =
+    {
+        .min_conn_interval = (uint16_t)rnd(),
+        .max_conn_interval = (uint16_t)rnd(),
+        .slave_latency     = (uint16_t)rnd(),
+        .conn_sup_timeout  = (uint16_t)rnd(),
+    };
+    ble_gap_conn_params_t const * p_params = (rnd() % 8 == 0) ? NULL : &params;
+    uint32_t buf_len = (rnd() % 4 == 0) ? rnd_below(16) : BUF_SIZE;
+
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        len[i] = buf_len;
+        err[i] = m_codecs[i].cpu_req_enc(conn_handle, p_params, m_out[i], &len[i]);
+    }
+    compare_enc("gap_conn_param_update_req_enc", err, len);
+
+    if (err[0] == NRF_SUCCESS)
+    {
+        uint32_t in_len = mutate(m_out[0], len[0]);
+        uint16_t handle_out[2];
+        ble_gap_conn_params_t params_out[2];
+        ble_gap_conn_params_t * p_params_out[2];
+        bool give_params = (rnd() % 16 != 0);
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            memset(&params_out[i], 0, sizeof(params_out[i]));
+            p_params_out[i] = give_params ? &params_out[i] : NULL;
+            err[i] = m_codecs[i].cpu_req_dec(m_in, in_len, &handle_out[i], &p_params_out[i]);
+        }
+        check(err[0] == err[1], "gap_conn_param_update_req_dec", "error code");
+        if ((err[0] == NRF_SUCCESS) && (err[1] == NRF_SUCCESS))
+        {
+            check(handle_out[0] == handle_out[1], "gap_conn_param_update_req_dec", "conn_handle");
+            check((p_params_out[0] == NULL) == (p_params_out[1] == NULL), "gap_conn_param_update_req_dec", "params");
+            check(memcmp(&params_out[0], &params_out[1], sizeof(params_out[0])) == 0,
+                  "gap_conn_param_update_req_dec", "params fields");
+        }
+    }
+
+    uint32_t result = rnd_result();
+    buf_len = (rnd() % 4 == 0) ? rnd_below(8) : BUF_SIZE;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        len[i] = buf_len;
+        err[i] = m_codecs[i].cpu_rsp_enc(result, m_out[i], &len[i]);
+    }
+    compare_enc("gap_conn_param_update_rsp_enc", err, len);
+
+    if (err[0] == NRF_SUCCESS)
+    {
+        uint32_t in_len = mutate(m_out[0], len[0]);
+        uint32_t result_out[2] = {0, 0};
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            err[i] = m_codecs[i].cpu_rsp_dec(m_in, in_len, &result_out[i]);
+        }
+        check(err[0] == err[1], "gap_conn_param_update_rsp_dec", "error code");
+        check((err[0] != NRF_SUCCESS) || (result_out[0] == result_out[1]),
+              "gap_conn_param_update_rsp_dec", "result code");
+    }
+}
+
+
+/**@brief   Fills m_evt_in with a random event of type @p evt, with a random event ID in some
+ *          iterations if @p bad_id is true. */
+static void random_event(uint32_t evt, uint16_t data_len, bool bad_id)
+{
+    ble_evt_t * p_event = (ble_evt_t *)m_evt_in;
+
+    fill_random((uint8_t *)m_evt_in, sizeof(m_evt_in));
+    p_event->header.evt_id  = (bad_id && (rnd() % 32 == 0)) ? (uint16_t)rnd() : m_evt_ids[evt];
+    p_event->header.evt_len = sizeof(m_evt_in);
+
+    if (evt == 2)
+    {
+        p_event->evt.gattc_evt.params.hvx.len = data_len;
+    }
+    else if (evt == 3)
+    {
+        p_event->evt.gattc_evt.params.write_rsp.len = data_len;
+    }
+}
+
+
+static void test_event(uint32_t evt)
+{
+    uint32_t err[2];
+    uint32_t len[2];
+    uint32_t buf_len = enc_buf_len();
+
+    random_event(evt, (uint16_t)rnd_below(DATA_MAX), true);
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        len[i] = buf_len;
+        err[i] = m_codecs[i].evt_enc[evt]((ble_evt_t *)m_evt_in, sizeof(m_evt_in), m_out[i], &len[i]);
+    }
+    compare_enc(m_evt_names[evt], err, len);
+
+    if (err[0] == NRF_SUCCESS)
+    {
+        // The event decoders start after the event ID.
+        uint32_t in_len = mutate(&m_out[0][SER_EVT_HEADER_SIZE], len[0] - SER_EVT_HEADER_SIZE);
+        uint32_t evt_len[2];
+        uint32_t evt_capacity = rnd_below(EVT_BUF_SIZE / 2);
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            memset(m_evt[i], 0x5A, sizeof(m_evt[i]));
+            evt_len[i] = evt_capacity;
+            err[i] = m_codecs[i].evt_dec[evt](m_in, in_len, (ble_evt_t *)m_evt[i], &evt_len[i]);
+        }
+        check(err[0] == err[1], m_evt_names[evt], "decoder error code");
+        if ((err[0] == NRF_SUCCESS) && (err[1] == NRF_SUCCESS))
+        {
+            check(evt_len[0] == evt_len[1], m_evt_names[evt], "decoded length");
+            check(memcmp(m_evt[0], m_evt[1], sizeof(m_evt[0])) == 0, m_evt_names[evt], "decoded event");
+        }
+    }
+}
+
+
+/**@brief   Checks the round trip of the generated codecs on valid messages. */
+static void test_round_trip(void)
+{
+    codecs_t const * p_gen = &m_codecs[1];
+    uint32_t len = BUF_SIZE;
+
+    uint16_t hvx_len = 20;
+    ble_gatts_hvx_params_t hvx = {.handle = 0x1234, .type = BLE_GATT_HVX_NOTIFICATION, .offset = 0,
+                                  .p_len = &hvx_len, .p_data = m_data};
+    check(p_gen->gatts_hvx_req_enc(0x0042, &hvx, m_out[0], &len) == NRF_SUCCESS, "round trip", "hvx encode");
+
+    uint16_t conn_handle = 0;
+    uint16_t len_out     = 0;
+    uint8_t  data_out[32];
+    ble_gatts_hvx_params_t hvx_out = {.p_len = &len_out, .p_data = data_out};
+    ble_gatts_hvx_params_t * p_hvx_out = &hvx_out;
+    check(p_gen->gatts_hvx_req_dec(m_out[0], len, &conn_handle, &p_hvx_out) == NRF_SUCCESS,
+          "round trip", "hvx decode");
+    check((conn_handle == 0x0042) && (hvx_out.handle == hvx.handle) && (hvx_out.type == hvx.type)
+          && (len_out == hvx_len) && (memcmp(data_out, m_data, hvx_len) == 0), "round trip", "hvx fields");
+
+    ble_evt_t * p_event = (ble_evt_t *)m_evt_in;
+    memset(m_evt_in, 0, sizeof(m_evt_in));
+    p_event->header.evt_id = BLE_GAP_EVT_CONN_PARAM_UPDATE;
+    p_event->evt.gap_evt.conn_handle = 7;
+    p_event->evt.gap_evt.params.conn_param_update.conn_params.min_conn_interval = 6;
+    p_event->evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval = 12;
+    p_event->evt.gap_evt.params.conn_param_update.conn_params.slave_latency     = 4;
+    p_event->evt.gap_evt.params.conn_param_update.conn_params.conn_sup_timeout  = 400;
+
+    len = BUF_SIZE;
+    check(p_gen->evt_enc[1](p_event, sizeof(m_evt_in), m_out[0], &len) == NRF_SUCCESS, "round trip", "event encode");
+
+    static const uint8_t expected[] = {0x12, 0x00, 0x07, 0x00, 0x06, 0x00, 0x0C, 0x00, 0x04, 0x00, 0x90, 0x01};
+    check((len == sizeof(expected)) && (memcmp(m_out[0], expected, len) == 0), "round trip", "event bytes");
+
+    uint32_t evt_len = sizeof(m_evt[0]);
+    memset(m_evt[0], 0, sizeof(m_evt[0]));
+    check(p_gen->evt_dec[1](&m_out[0][SER_EVT_HEADER_SIZE], len - SER_EVT_HEADER_SIZE,
+                            (ble_evt_t *)m_evt[0], &evt_len) == NRF_SUCCESS, "round trip", "event decode");
+    ble_evt_t const * p_out = (ble_evt_t const *)m_evt[0];
+    check((p_out->header.evt_id == BLE_GAP_EVT_CONN_PARAM_UPDATE) && (p_out->evt.gap_evt.conn_handle == 7)
+          && (memcmp(&p_out->evt.gap_evt.params.conn_param_update, &p_event->evt.gap_evt.params.conn_param_update,
+                     sizeof(ble_gap_evt_conn_param_update_t)) == 0), "round trip", "event fields");
+}
+
+
+static double now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+
+enum
+{
+    OP_HVX_REQ_ENC,
+    OP_HVX_REQ_DEC,
+    OP_HVX_RSP_ENC,
+    OP_HVX_RSP_DEC,
+    OP_WRITE_REQ_ENC,
+    OP_WRITE_REQ_DEC,
+    OP_CPU_REQ_ENC,
+    OP_CPU_REQ_DEC,
+    OP_HV_CONFIRM_RSP_ENC,
+    OP_HV_CONFIRM_RSP_DEC,
+    OP_EVT_FIRST,
+    OP_COUNT = OP_EVT_FIRST + 2 * 5,
+};
+
+static char const * const m_op_names[OP_COUNT] =
+{
+    "gatts_hvx_req_enc (20 B)", "gatts_hvx_req_dec (20 B)", "gatts_hvx_rsp_enc", "gatts_hvx_rsp_dec",
+    "gattc_write_req_enc (20 B)", "gattc_write_req_dec (20 B)",
+    "gap_conn_param_update_req_enc", "gap_conn_param_update_req_dec",
+    "gattc_hv_confirm_rsp_enc", "gattc_hv_confirm_rsp_dec",
+    "evt_tx_complete_enc", "evt_tx_complete_dec",
+    "gap_evt_conn_param_update_enc", "gap_evt_conn_param_update_dec",
+    "gattc_evt_hvx_enc (20 B)", "gattc_evt_hvx_dec (20 B)",
+    "gattc_evt_write_rsp_enc (20 B)", "gattc_evt_write_rsp_dec (20 B)",
+    "gatts_evt_hvc_enc", "gatts_evt_hvc_dec",
+};
+
+static uint8_t  m_bench_in[OP_COUNT][64];    // Encoded input of each decoder.
+static uint32_t m_bench_in_len[OP_COUNT];
+static uint32_t m_bench_out_len;             // Length returned by the last operation.
+
+
+/**@brief   Runs one operation on the bench message. */
+static uint32_t bench_op(codecs_t const * p_codecs, uint32_t op)
+{
+    static uint16_t               hvx_len = 20;
+    static ble_gatts_hvx_params_t hvx     = {.handle = 0x0010, .type = BLE_GATT_HVX_NOTIFICATION,
+                                             .p_len = &hvx_len, .p_data = m_data};
+    static ble_gattc_write_params_t write = {.write_op = BLE_GATT_OP_WRITE_CMD, .handle = 0x0020,
+                                             .len = 20, .p_value = m_data};
+    static ble_gap_conn_params_t  cp      = {6, 12, 4, 400};
+    static uint16_t               bytes_written = 20;
+
+    uint8_t * p_out   = m_out[0];
+    uint32_t  len     = BUF_SIZE;
+    uint32_t  result  = 0;
+    uint16_t  handle  = 0;
+    uint8_t const * p_in = m_bench_in[op];
+    uint32_t  in_len  = m_bench_in_len[op];
+    uint32_t  err;
+
+    switch (op)
+    {
+        case OP_HVX_REQ_ENC:
+            err = p_codecs->gatts_hvx_req_enc(0x0001, &hvx, p_out, &len);
+            break;
+
+        case OP_HVX_REQ_DEC:
+        {
+            static uint16_t len_out;
+            static uint8_t  data_out[64];
+            ble_gatts_hvx_params_t out = {.p_len = &len_out, .p_data = data_out};
+            ble_gatts_hvx_params_t * p_out_params = &out;
+            err = p_codecs->gatts_hvx_req_dec(p_in, in_len, &handle, &p_out_params);
+            len = len_out;
+        } break;
+
+        case OP_HVX_RSP_ENC:
+            err = p_codecs->gatts_hvx_rsp_enc(NRF_SUCCESS, p_out, &len, &bytes_written);
+            break;
+
+        case OP_HVX_RSP_DEC:
+        {
+            uint16_t   written = 0;
+            uint16_t * p_written = &written;
+            err = p_codecs->gatts_hvx_rsp_dec(p_in, in_len, &result, &p_written);
+            len = written;
+        } break;
+
+        case OP_WRITE_REQ_ENC:
+            err = p_codecs->write_req_enc(0x0001, &write, p_out, &len);
+            break;
+
+        case OP_WRITE_REQ_DEC:
+        {
+            static uint8_t value_out[BLE_GATTC_WRITE_P_VALUE_LEN_MAX];
+            ble_gattc_write_params_t out = {.len = sizeof(value_out), .p_value = value_out};
+            ble_gattc_write_params_t * p_out_params = &out;
+            err = p_codecs->write_req_dec(p_in, (uint16_t)in_len, &handle, &p_out_params);
+            len = out.len;
+        } break;
+
+        case OP_CPU_REQ_ENC:
+            err = p_codecs->cpu_req_enc(0x0001, &cp, p_out, &len);
+            break;
+
+        case OP_CPU_REQ_DEC:
+        {
+            ble_gap_conn_params_t out;
+            ble_gap_conn_params_t * p_out_params = &out;
+            err = p_codecs->cpu_req_dec(p_in, in_len, &handle, &p_out_params);
+            len = out.conn_sup_timeout;
+        } break;
+
+        case OP_HV_CONFIRM_RSP_ENC:
+            err = p_codecs->hv_confirm_rsp_enc(NRF_SUCCESS, p_out, &len);
+            break;
+
+        case OP_HV_CONFIRM_RSP_DEC:
+            err = p_codecs->hv_confirm_rsp_dec(p_in, in_len, &result);
+            break;
+
+        default:
+        {
+            uint32_t evt = (op - OP_EVT_FIRST) / 2;
+            if ((op - OP_EVT_FIRST) % 2 == 0)
+            {
+                err = p_codecs->evt_enc[evt]((ble_evt_t *)m_evt_in, sizeof(m_evt_in), p_out, &len);
+            }
+            else
+            {
+                len = sizeof(m_evt[0]);
+                err = p_codecs->evt_dec[evt](p_in, in_len, (ble_evt_t *)m_evt[0], &len);
+            }
+        } break;
+    }
+    m_bench_out_len = len;
+    return err + len + result + handle;
+}
+
+
+/**@brief   Runs an encoder on the bench message and returns the encoded length. */
+static uint32_t bench_enc_len(codecs_t const * p_codecs, uint32_t op)
+{
+    (void)bench_op(p_codecs, op);
+    return m_bench_out_len;
+}
+
+
+static void bench(double seconds)
+{
+    printf("\n%-32s %14s %14s %8s\n", "operation", "hand-written", "generated", "speedup");
+
+    for (uint32_t op = 0; op < OP_COUNT; op++)
+    {
+        double   rate[2];
+        uint32_t sink = 0;
+
+        // Each encoder produces, with the hand-written codecs, the input of the decoder after it.
+        if ((op % 2) == 0)
+        {
+            uint32_t skip = 0;
+
+            if (op >= OP_EVT_FIRST)
+            {
+                uint32_t evt = (op - OP_EVT_FIRST) / 2;
+                random_event(evt, 20, false);
+                skip = SER_EVT_HEADER_SIZE;
+            }
+            m_bench_in_len[op + 1] = bench_enc_len(&m_codecs[0], op) - skip;
+            memcpy(m_bench_in[op + 1], &m_out[0][skip], m_bench_in_len[op + 1]);
+        }
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            uint32_t n     = 0;
+            double   start = now();
+            double   elapsed;
+            do
+            {
+                for (uint32_t j = 0; j < 10000; j++)
+                {
+                    sink += bench_op(&m_codecs[i], op);
+                }
+                n      += 10000;
+                elapsed = now() - start;
+            } while (elapsed < seconds / 2);
+            rate[i] = n / elapsed;
+        }
+        // The sink is printed as an empty string so that the calls are not optimized out.
+        printf("%-32s %10.2f M/s %10.2f M/s %7.2fx%s\n", m_op_names[op], rate[0] / 1e6, rate[1] / 1e6,
+               rate[1] / rate[0], (sink == 0xFFFFFFFF) ? " " : "");
+    }
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t iterations = ITERATIONS_DEFAULT;
+    double   seconds    = SECONDS_DEFAULT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "iterations=", 11) == 0)
+        {
+            iterations = strtoul(argv[i] + 11, NULL, 0);
+        }
+        else if (strncmp(argv[i], "seconds=", 8) == 0)
+        {
+            seconds = strtod(argv[i] + 8, NULL);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [iterations=<n>] [seconds=<n>]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    fill_random(m_data, sizeof(m_data));
+
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        test_gatts_hvx();
+        test_hv_confirm();
+        test_gattc_write();
+        test_conn_param_update();
+        for (uint32_t evt = 0; evt < 5; evt++)
+        {
+            test_event(evt);
+        }
+    }
+    test_round_trip();
+
+    printf("%u iterations, %u checks, %u mismatches\n", iterations, m_checks, m_failures);
+
+    bench(seconds);
+
+    return (m_failures == 0) ? 0 : 1;
+}
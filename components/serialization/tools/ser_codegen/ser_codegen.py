@@ -0,0 +1,968 @@
+#!/usr/bin/env python3
+# Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+#
+# The information contained herein is property of Nordic Semiconductor ASA.
+# Terms and conditions of usage are described in detail in NORDIC
+# SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+#
+# Licensees are granted free, non-transferable use of the information. NO
+# WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+# the file.
+#
+
+"""Generator of SoftDevice serialization codecs.
+
+Reads a schema which describes the wire layout of commands and events and
+writes straight-line C encoders and decoders with the prototypes of the
+hand-written codecs in */codecs/<sd>/serializers:
+
+    app     Command request encoders, command response decoders and event
+            decoders (the application side).
+    conn    Command request decoders, command response encoders and event
+            encoders (the connectivity side).
+
+The generated code produces the same bytes and returns the same error codes as
+the hand-written codecs. An encoder computes the length of the message, checks
+it once against the buffer and writes the fields. A decoder checks the length
+once per run of fixed-size fields; a run ends at a presence flag or at
+variable-length data. Runs of scalar members which are laid out back to back
+in memory are copied with memcpy, which relies on a little-endian target; the
+generated code checks this at compile time.
+
+Schema syntax ('#' starts a comment, fields are indented):
+
+    struct <c type>
+        <field>
+
+    command <opcode> <name> [packet_len=u16]
+        check <pointer> ...             NULL checks done by the request decoder
+        req <field>                     Parameter of the request
+        rsp <field>                     Output of the response
+
+    event <event id> <name> <group> <params c type>
+        <field>                         Member of p_event->evt.<group>_evt
+
+    <field> is one of:
+        u8|u16|u32 <member>
+        struct <c type> <member>        Inline structure described by 'struct'
+        cond u8|u16|u32|<c type> <member>
+                                        Presence flag, then the value if the
+                                        pointer is not NULL
+        buf <member> [*]<len member> [if <member>]
+                                        Presence flag, then the bytes if the
+                                        pointer is not NULL
+        len16data <member> <len member> 16-bit length, then 'buf'
+        u8array <member> <len member> [ext]
+                                        Bytes, 'ext' if they extend past the
+                                        event structure
+
+Examples:
+    ser_codegen.py ble_s132.ser app ../../application/codecs/s132/serializers/ble_codecs_gen_app.c
+    ser_codegen.py ble_s132.ser conn out.c --prefix gen_ --header out.h
+
+Only the Python 3 standard library is used.
+"""
+
+import argparse
+import os
+import re
+import sys
+
+LICENSE = """\
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+"""
+
+SCALARS = {'u8': 1, 'u16': 2, 'u32': 4}
+C_SCALARS = {'u8': 'uint8_t', 'u16': 'uint16_t', 'u32': 'uint32_t'}
+
+RSP_HEADER_SIZE = 5
+EVT_HEADER_SIZE = 2
+
+
+class SchemaError(Exception):
+    pass
+
+
+class Field(object):
+    """One entry of a field list. 'kind' is a scalar name, 'struct', 'cond',
+    'buf', 'len16data' or 'u8array'."""
+
+    def __init__(self, kind, name, **kw):
+        self.kind = kind
+        self.name = name
+        self.inner = kw.get('inner')        # Scalar name or struct type of 'cond'.
+        self.ctype = kw.get('ctype')        # Struct type of 'struct'.
+        self.length = kw.get('length')      # Length member of 'buf', 'len16data', 'u8array'.
+        self.deref = kw.get('deref', False) # 'buf' length is *length.
+        self.cond = kw.get('cond')          # 'buf' is only present if this member is not NULL.
+        self.ext = kw.get('ext', False)
+
+
+class Command(object):
+    def __init__(self, opcode, name, packet_len):
+        self.opcode = opcode
+        self.name = name
+        self.packet_len = packet_len
+        self.checks = []
+        self.req = []
+        self.rsp = []
+
+
+class Event(object):
+    def __init__(self, evt_id, name, group, params_type):
+        self.evt_id = evt_id
+        self.name = name
+        self.group = group
+        self.params_type = params_type
+        self.fields = []
+
+
+class Schema(object):
+    def __init__(self):
+        self.structs = {}
+        self.commands = []
+        self.events = []
+
+
+def parse_field(tokens, where):
+    kind = tokens[0]
+    try:
+        if kind in SCALARS and len(tokens) == 2:
+            return Field(kind, tokens[1])
+        if kind == 'struct' and len(tokens) == 3:
+            return Field(kind, tokens[2], ctype=tokens[1])
+        if kind == 'cond' and len(tokens) == 3:
+            return Field(kind, tokens[2], inner=tokens[1])
+        if kind == 'buf' and len(tokens) in (3, 5):
+            deref = tokens[2].startswith('*')
+            field = Field(kind, tokens[1], length=tokens[2].lstrip('*'), deref=deref)
+            if len(tokens) == 5:
+                if tokens[3] != 'if':
+                    raise IndexError
+                field.cond = tokens[4]
+            return field
+        if kind == 'len16data' and len(tokens) == 3:
+            return Field(kind, tokens[1], length=tokens[2])
+        if kind == 'u8array' and len(tokens) in (3, 4):
+            if len(tokens) == 4 and tokens[3] != 'ext':
+                raise IndexError
+            return Field(kind, tokens[1], length=tokens[2], ext=(len(tokens) == 4))
+    except IndexError:
+        pass
+    raise SchemaError('%s: invalid field: %s' % (where, ' '.join(tokens)))
+
+
+def parse_schema(path):
+    schema = Schema()
+    block = None
+    with open(path) as f:
+        for number, line in enumerate(f, 1):
+            where = '%s:%d' % (path, number)
+            tokens = line.split('#', 1)[0].split()
+            if not tokens:
+                continue
+            if not line[0].isspace():
+                if tokens[0] == 'struct' and len(tokens) == 2:
+                    block = []
+                    schema.structs[tokens[1]] = block
+                elif tokens[0] == 'command' and len(tokens) in (3, 4):
+                    packet_len = 'uint32_t'
+                    if len(tokens) == 4:
+                        if tokens[3] != 'packet_len=u16':
+                            raise SchemaError('%s: unknown option %s' % (where, tokens[3]))
+                        packet_len = 'uint16_t'
+                    block = Command(tokens[1], tokens[2], packet_len)
+                    schema.commands.append(block)
+                elif tokens[0] == 'event' and len(tokens) == 5:
+                    block = Event(*tokens[1:])
+                    schema.events.append(block)
+                else:
+                    raise SchemaError('%s: invalid declaration' % where)
+            elif block is None:
+                raise SchemaError('%s: field outside of a declaration' % where)
+            elif isinstance(block, Command):
+                if tokens[0] == 'check':
+                    block.checks.extend(tokens[1:])
+                elif tokens[0] in ('req', 'rsp'):
+                    field = parse_field(tokens[1:], where)
+                    if field.kind not in SCALARS and field.kind != 'cond':
+                        raise SchemaError('%s: parameters are scalars or cond' % where)
+                    getattr(block, tokens[0]).append(field)
+                else:
+                    raise SchemaError('%s: expected req, rsp or check' % where)
+            elif isinstance(block, Event):
+                block.fields.append(parse_field(tokens, where))
+            else:
+                block.append(parse_field(tokens, where))
+
+    for command in schema.commands:
+        if any(f.kind in SCALARS for f in command.rsp):
+            raise SchemaError('%s: response outputs must be cond' % command.name)
+    return schema
+
+
+class Access(object):
+    """How the fields of a list are reached in C.
+
+    Members of a structure are reached through 'prefix' ('p_x->' or
+    'p_event->evt.gap_evt.'). 'offset_type' and 'offset_path' give the
+    offsetof() of a member, for checking that a run of members can be copied
+    at once. Parameters of a command have no prefix, and are passed by value
+    to the request encoder and by pointer to the request decoder."""
+
+    def __init__(self, prefix=None, offset_type=None, offset_path=''):
+        self.prefix = prefix
+        self.offset_type = offset_type
+        self.offset_path = offset_path
+
+    def is_param(self):
+        return self.prefix is None
+
+    def member(self, name):
+        return self.prefix + name
+
+    def nested(self, name):
+        return Access(self.prefix + name + '.', self.offset_type, self.offset_path + name + '.')
+
+    def offsetof(self, name):
+        if self.offset_type is None:
+            return None
+        return 'offsetof(%s, %s)' % (self.offset_type, self.offset_path + name)
+
+    def parent(self, name):
+        return name.rpartition('.')[0]
+
+    # Encoder side.
+    def value(self, field):
+        return field.name if self.is_param() else self.member(field.name)
+
+    def pointer(self, field):
+        return 'p_' + field.name if self.is_param() else self.member(field.name)
+
+    # Decoder side.
+    def lvalue(self, field):
+        return '*p_' + field.name if self.is_param() else self.member(field.name)
+
+    def pointer_lvalue(self, field):
+        return '*pp_' + field.name if self.is_param() else self.member(field.name)
+
+    def pointer_holder(self, field):
+        """The pointer to the pointer of a cond field, if it may be NULL."""
+        return 'pp_' + field.name if self.is_param() else None
+
+
+def natural_offset(offset, size):
+    return (offset + size - 1) // size * size
+
+
+def scalar_runs(fields, access):
+    """Splits a field list in items: lists of scalar members which are
+    contiguous in memory, and single fields."""
+    items = []
+    run = []
+    run_end = 0
+    for field in fields:
+        if field.kind in SCALARS and access.offset_type is not None:
+            size = SCALARS[field.kind]
+            if (run and access.parent(field.name) == access.parent(run[-1].name)
+                    and natural_offset(run_end, size) == run_end):
+                run.append(field)
+                run_end += size
+                continue
+            if run:
+                items.append(run)
+            run = [field]
+            run_end = size
+            continue
+        if run:
+            items.append(run)
+            run = []
+        items.append(field)
+    if run:
+        items.append(run)
+
+    result = []
+    for item in items:
+        if isinstance(item, list) and len(item) == 1:
+            result.append(item[0])
+        else:
+            result.append(item)
+    return result
+
+
+def presence_pointer(field, access):
+    """The pointer which encoders test before writing the field, or None."""
+    if field.kind == 'cond':
+        return access.pointer(field)
+    if field.kind == 'buf' and field.cond:
+        return access.member(field.cond)
+    return None
+
+
+def presence_groups(items, access):
+    """Replaces each field which is written only if a pointer is not NULL by a
+    tuple of it and the 'buf ... if' fields right after it which test the same
+    pointer, so that encoders test that pointer once."""
+    result = []
+    for item in items:
+        pointer = None if isinstance(item, list) else presence_pointer(item, access)
+        if pointer is None:
+            result.append(item)
+        elif (item.kind == 'buf' and result and isinstance(result[-1], tuple)
+                and presence_pointer(result[-1][0], access) == pointer):
+            result[-1] += (item,)
+        else:
+            result.append((item,))
+    return result
+
+
+class Writer(object):
+    def __init__(self):
+        self.lines = []
+        self.level = 1
+
+    def line(self, text=''):
+        self.lines.append(('    ' * self.level + text) if text else '')
+
+    def open(self, text):
+        self.line(text)
+        self.line('{')
+        self.level += 1
+
+    def close(self):
+        self.level -= 1
+        self.line('}')
+
+
+class Cursor(object):
+    """Position in the buffer: the runtime 'index' plus a constant offset.
+    While 'index' is known to be zero, positions are printed as constants."""
+
+    def __init__(self, offset=0):
+        self.offset = offset
+        self.index_zero = True
+
+    def at(self, extra=0):
+        offset = self.offset + extra
+        if self.index_zero:
+            return str(offset)
+        if offset == 0:
+            return 'index'
+        return 'index + %d' % offset
+
+    def flush(self, w):
+        if self.index_zero:
+            w.line('index = %d;' % self.offset)
+            self.index_zero = False
+        elif self.offset:
+            w.line('index += %d;' % self.offset)
+        self.offset = 0
+
+
+class Generator(object):
+    def __init__(self, schema, prefix):
+        self.schema = schema
+        self.prefix = prefix
+        self.asserts = []
+
+    def struct(self, ctype):
+        try:
+            return self.schema.structs[ctype]
+        except KeyError:
+            raise SchemaError('unknown struct %s' % ctype)
+
+    def check_run(self, run, access):
+        """Records the static checks which prove that 'run' is contiguous."""
+        checks = []
+        for field in run:
+            checks.append('STATIC_ASSERT(sizeof(((%s *)0)->%s) == %d);'
+                          % (access.offset_type, access.offset_path + field.name, SCALARS[field.kind]))
+        for prev, field in zip(run, run[1:]):
+            checks.append('STATIC_ASSERT(%s == %s + %d);'
+                          % (access.offsetof(field.name), access.offsetof(prev.name),
+                             SCALARS[prev.kind]))
+        for check in checks:
+            if check not in self.asserts:
+                self.asserts.append(check)
+
+    # Encoders.
+
+    def enc_size(self, fields, access, w):
+        """Writes the statements which add the variable part of the length
+        and returns the constant part."""
+        size = 0
+        for field in presence_groups(fields, access):
+            if isinstance(field, tuple):
+                size += self.enc_group_size(field, access, w)
+            elif field.kind in SCALARS:
+                size += SCALARS[field.kind]
+            elif field.kind == 'struct':
+                size += self.enc_size(self.struct(field.ctype), access.nested(field.name), w)
+            elif field.kind == 'buf':
+                size += 1
+                self.enc_buf_size(field, access, w)
+            elif field.kind == 'len16data':
+                size += 3
+                w.open('if (%s != NULL)' % access.member(field.name))
+                w.line('len += %s;' % access.member(field.length))
+                w.close()
+            elif field.kind == 'u8array':
+                w.line('len += %s;' % access.member(field.length))
+        return size
+
+    def enc_buf_size(self, field, access, w):
+        length = ('*' if field.deref else '') + access.member(field.length)
+        w.open('if (%s != NULL)' % access.member(field.name))
+        w.line('len += %s;' % length)
+        w.close()
+
+    def enc_group_size(self, group, access, w):
+        """Writes the length of the fields in a presence group and returns the
+        constant part, the presence byte of a cond field."""
+        pointer = presence_pointer(group[0], access)
+        inner = Writer()
+        inner.level = w.level + 1
+        inner_size = 0
+        for field in group:
+            if field.kind == 'cond' and field.inner in SCALARS:
+                inner_size += SCALARS[field.inner]
+            elif field.kind == 'cond':
+                inner_size += self.enc_size(self.struct(field.inner), Access(pointer + '->', field.inner), inner)
+            else:
+                inner_size += 1
+                self.enc_buf_size(field, access, inner)
+        w.open('if (%s != NULL)' % pointer)
+        w.line('len += %d;' % inner_size)
+        w.lines.extend(inner.lines)
+        w.close()
+        return 1 if group[0].kind == 'cond' else 0
+
+    def enc_scalar(self, kind, value, cur, w):
+        if kind == 'u8':
+            w.line('p_buf[%s] = %s;' % (cur.at(), value))
+        else:
+            w.line('(void)uint%d_encode(%s, &p_buf[%s]);' % (SCALARS[kind] * 8, value, cur.at()))
+        cur.offset += SCALARS[kind]
+
+    def enc_presence(self, pointer, cur, w):
+        w.line('p_buf[%s] = (%s == NULL) ? SER_FIELD_NOT_PRESENT : SER_FIELD_PRESENT;'
+               % (cur.at(), pointer))
+        cur.offset += 1
+
+    def enc_bytes(self, pointer, length, cur, w):
+        cur.flush(w)
+        w.open('if (%s != NULL)' % pointer)
+        w.line('memcpy(&p_buf[index], %s, %s);' % (pointer, length))
+        w.line('index += %s;' % length)
+        w.close()
+
+    def enc_group(self, group, access, cur, w):
+        """Writes the fields of a presence group under one test of their pointer."""
+        pointer = presence_pointer(group[0], access)
+        if group[0].kind == 'cond':
+            self.enc_presence(pointer, cur, w)
+        cur.flush(w)
+        w.open('if (%s != NULL)' % pointer)
+        inner = Cursor()
+        inner.index_zero = False
+        for field in group:
+            if field.kind == 'cond' and field.inner in SCALARS:
+                self.enc_scalar(field.inner, '*' + pointer, inner, w)
+            elif field.kind == 'cond':
+                self.enc_fields(self.struct(field.inner), Access(pointer + '->', field.inner), inner, w)
+            else:
+                buf_pointer = access.member(field.name)
+                length = ('*' if field.deref else '') + access.member(field.length)
+                self.enc_presence(buf_pointer, inner, w)
+                self.enc_bytes(buf_pointer, length, inner, w)
+        inner.flush(w)
+        w.close()
+
+    def enc_fields(self, fields, access, cur, w):
+        for item in presence_groups(scalar_runs(fields, access), access):
+            if isinstance(item, tuple):
+                self.enc_group(item, access, cur, w)
+                continue
+            if isinstance(item, list):
+                self.check_run(item, access)
+                length = sum(SCALARS[f.kind] for f in item)
+                w.line('memcpy(&p_buf[%s], &%s, %d);' % (cur.at(), access.member(item[0].name), length))
+                cur.offset += length
+                continue
+
+            field = item
+            if field.kind in SCALARS:
+                self.enc_scalar(field.kind, access.value(field), cur, w)
+            elif field.kind == 'struct':
+                self.enc_fields(self.struct(field.ctype), access.nested(field.name), cur, w)
+            elif field.kind == 'buf':
+                pointer = access.member(field.name)
+                length = ('*' if field.deref else '') + access.member(field.length)
+                self.enc_presence(pointer, cur, w)
+                self.enc_bytes(pointer, length, cur, w)
+            elif field.kind == 'len16data':
+                pointer = access.member(field.name)
+                self.enc_scalar('u16', access.member(field.length), cur, w)
+                self.enc_presence(pointer, cur, w)
+                self.enc_bytes(pointer, access.member(field.length), cur, w)
+            elif field.kind == 'u8array':
+                length = access.member(field.length)
+                w.line('memcpy(&p_buf[%s], %s, %s);' % (cur.at(), access.member(field.name), length))
+                cur.flush(w)
+                w.line('index += %s;' % length)
+
+    def encoder(self, header, fields, access, cur, w, guard=None):
+        """Writes the length computation, the single length check and the
+        fields. 'header' writes the bytes in front of the fields."""
+        size_w = Writer()
+        size_w.level = w.level + (1 if guard else 0)
+        size = self.enc_size(fields, access, size_w)
+        if guard:
+            w.line('uint32_t len = %d;' % cur.offset)
+            w.open('if (%s)' % guard)
+            w.line('len += %d;' % size)
+            w.lines.extend(size_w.lines)
+            w.close()
+        else:
+            w.line('uint32_t len = %d;' % (cur.offset + size))
+            w.lines.extend(size_w.lines)
+        w.line('SER_ASSERT_LENGTH_LEQ(len, *p_buf_len);')
+        w.line()
+        header(w)
+        if guard:
+            cur.flush(w)
+            w.open('if (%s)' % guard)
+            inner = Cursor()
+            inner.index_zero = False
+            self.enc_fields(fields, access, inner, w)
+            inner.flush(w)
+            w.close()
+        else:
+            self.enc_fields(fields, access, cur, w)
+            cur.flush(w)
+        w.line()
+        w.line('*p_buf_len = index;')
+        w.line('return NRF_SUCCESS;')
+
+    # Decoders.
+
+    def dec_segment(self, cur, reads, w):
+        """Writes the length check of the fixed-size fields in 'reads', the
+        reads themselves and moves the index past them."""
+        if cur.offset:
+            if cur.index_zero:
+                w.line('SER_ASSERT_LENGTH_LEQ(%d, packet_len);' % cur.offset)
+            else:
+                w.line('SER_ASSERT_LENGTH_LEQ(%d, packet_len - index);' % cur.offset)
+        for read in reads:
+            w.line(read)
+        del reads[:]
+        cur.flush(w)
+
+    def dec_scalar(self, kind, lvalue, cur, reads):
+        if kind == 'u8':
+            reads.append('%s = p_buf[%s];' % (lvalue, cur.at()))
+        else:
+            reads.append('%s = uint%d_decode(&p_buf[%s]);' % (lvalue, SCALARS[kind] * 8, cur.at()))
+        cur.offset += SCALARS[kind]
+
+    def dec_bytes(self, pointer, length, capacity, cur, reads, w):
+        """Writes the decoding of a presence flag followed by bytes."""
+        cur.offset += 1
+        self.dec_segment(cur, reads, w)
+        w.open('if (p_buf[index - 1] == SER_FIELD_PRESENT)')
+        w.line('SER_ASSERT_NOT_NULL(%s);' % pointer)
+        if capacity:
+            w.line('SER_ASSERT_LENGTH_LEQ(%s, %s);' % (length, capacity))
+        w.line('SER_ASSERT_LENGTH_LEQ(%s, packet_len - index);' % length)
+        w.line('memcpy((uint8_t *)%s, &p_buf[index], %s);' % (pointer, length))
+        w.line('index += %s;' % length)
+        w.close()
+        w.open('else')
+        w.line('%s = NULL;' % pointer)
+        w.close()
+
+    def dec_fields(self, fields, access, cur, reads, w):
+        for item in scalar_runs(fields, access):
+            if isinstance(item, list):
+                self.check_run(item, access)
+                length = sum(SCALARS[f.kind] for f in item)
+                reads.append('memcpy(&%s, &p_buf[%s], %d);' % (access.member(item[0].name), cur.at(), length))
+                cur.offset += length
+                continue
+
+            field = item
+            if field.kind in SCALARS:
+                self.dec_scalar(field.kind, access.lvalue(field), cur, reads)
+            elif field.kind == 'struct':
+                self.dec_fields(self.struct(field.ctype), access.nested(field.name), cur, reads, w)
+            elif field.kind == 'cond':
+                pointer = access.pointer_lvalue(field)
+                holder = access.pointer_holder(field)
+                cur.offset += 1
+                self.dec_segment(cur, reads, w)
+                w.open('if (p_buf[index - 1] == SER_FIELD_PRESENT)')
+                if holder:
+                    w.line('SER_ASSERT_NOT_NULL(%s);' % holder)
+                w.line('SER_ASSERT_NOT_NULL(%s);' % pointer)
+                inner = Cursor()
+                inner.index_zero = False
+                if field.inner in SCALARS:
+                    self.dec_scalar(field.inner, '*' + pointer, inner, reads)
+                else:
+                    target = '(%s)' % pointer
+                    if holder:
+                        target = 'p_' + field.name
+                        w.line('%s * const %s = %s;' % (field.inner, target, pointer))
+                    self.dec_fields(self.struct(field.inner), Access(target + '->', field.inner),
+                                    inner, reads, w)
+                self.dec_segment(inner, reads, w)
+                w.close()
+                w.open('else if (p_buf[index - 1] == SER_FIELD_NOT_PRESENT)')
+                if holder:
+                    w.open('if (%s != NULL)' % holder)
+                    w.line('%s = NULL;' % pointer)
+                    w.close()
+                else:
+                    w.line('%s = NULL;' % pointer)
+                w.close()
+                w.open('else')
+                w.line('return NRF_ERROR_INVALID_DATA;')
+                w.close()
+            elif field.kind == 'buf':
+                pointer = access.member(field.name)
+                length = ('*' if field.deref else '') + access.member(field.length)
+                if field.cond:
+                    self.dec_segment(cur, reads, w)
+                    w.open('if (%s != NULL)' % access.member(field.cond))
+                    inner = Cursor()
+                    inner.index_zero = False
+                    self.dec_bytes(pointer, length, None, inner, reads, w)
+                    w.close()
+                else:
+                    self.dec_bytes(pointer, length, None, cur, reads, w)
+            elif field.kind == 'len16data':
+                pointer = access.member(field.name)
+                length = access.member(field.length)
+                capacity = field.name + '_buf_len'
+                reads.append('uint16_t const %s = %s;' % (capacity, length))
+                self.dec_scalar('u16', length, cur, reads)
+                self.dec_bytes(pointer, length, capacity, cur, reads, w)
+            elif field.kind == 'u8array':
+                length = access.member(field.length)
+                self.dec_segment(cur, reads, w)
+                if field.ext:
+                    w.line('uint32_t const %s_ext_len = SUB1(%s);' % (field.name, length))
+                    w.line('SER_ASSERT_LENGTH_LEQ(%s_ext_len, *p_event_len);' % field.name)
+                w.line('SER_ASSERT_LENGTH_LEQ(%s, packet_len - index);' % length)
+                w.line('memcpy(%s, &p_buf[index], %s);' % (access.member(field.name), length))
+                w.line('index += %s;' % length)
+                if field.ext:
+                    w.line('*p_event_len     -= %s_ext_len;' % field.name)
+                    w.line('evt_extended_len += %s_ext_len;' % field.name)
+
+    def has_ext(self, fields):
+        for field in fields:
+            if field.kind == 'u8array' and field.ext:
+                return True
+            if field.kind == 'struct' and self.has_ext(self.struct(field.ctype)):
+                return True
+        return False
+
+    # Functions.
+
+    def signature(self, name, params):
+        """Formats a prototype with aligned parameter names, like the
+        hand-written codecs."""
+        width = max(len(t) for t, _ in params)
+        head = 'uint32_t %s%s(' % (self.prefix, name)
+        lines = []
+        for i, (ctype, pname) in enumerate(params):
+            text = '%s %s' % (ctype.ljust(width), pname)
+            lines.append((head if i == 0 else ' ' * len(head)) + text)
+        return ',\n'.join(lines) + ')'
+
+    def param_types(self, fields, encode):
+        params = []
+        for field in fields:
+            if field.kind in SCALARS:
+                if encode:
+                    params.append((C_SCALARS[field.kind], field.name))
+                else:
+                    params.append(('%s * const' % C_SCALARS[field.kind], 'p_' + field.name))
+            else:
+                ctype = C_SCALARS.get(field.inner, field.inner)
+                if encode:
+                    params.append(('%s const * const' % ctype, 'p_' + field.name))
+                else:
+                    params.append(('%s * * const' % ctype, 'pp_' + field.name))
+        return params
+
+    def function(self, out, name, params, w):
+        out.append(self.signature(name, params))
+        out.append('{')
+        out.extend(w.lines)
+        out.append('}')
+        out.append('')
+        out.append('')
+
+    def req_enc(self, cmd, out):
+        params = self.param_types(cmd.req, True)
+        params += [('uint8_t * const', 'p_buf'), ('uint32_t * const', 'p_buf_len')]
+        w = Writer()
+        w.line('SER_ASSERT_NOT_NULL(p_buf);')
+        w.line('SER_ASSERT_NOT_NULL(p_buf_len);')
+        w.line()
+        w.line('uint32_t index;')
+        cur = Cursor(1)
+
+        def header(w):
+            w.line('p_buf[0] = %s;' % cmd.opcode)
+        self.encoder(header, cmd.req, Access(), cur, w)
+        self.function(out, cmd.name + '_req_enc', params, w)
+
+    def rsp_dec(self, cmd, out):
+        params = [('uint8_t const * const', 'p_buf'), ('uint32_t', 'packet_len'),
+                  ('uint32_t * const', 'p_result_code')]
+        params += self.param_types(cmd.rsp, False)
+        w = Writer()
+        w.line('SER_ASSERT_NOT_NULL(p_buf);')
+        w.line('SER_ASSERT_NOT_NULL(p_result_code);')
+        w.line()
+        w.line('if (packet_len < SER_CMD_RSP_HEADER_SIZE)')
+        w.line('{')
+        w.line('    return NRF_ERROR_DATA_SIZE;')
+        w.line('}')
+        w.line('if (p_buf[SER_CMD_OP_CODE_POS] != %s)' % cmd.opcode)
+        w.line('{')
+        w.line('    return NRF_ERROR_INVALID_DATA;')
+        w.line('}')
+        w.line('*p_result_code = uint32_decode(&p_buf[SER_CMD_RSP_STATUS_CODE_POS]);')
+        w.line()
+        if not cmd.rsp:
+            w.line('return (packet_len == SER_CMD_RSP_HEADER_SIZE) ? NRF_SUCCESS : NRF_ERROR_DATA_SIZE;')
+        else:
+            w.open('if (*p_result_code != NRF_SUCCESS)')
+            w.line('SER_ASSERT_LENGTH_EQ(SER_CMD_RSP_HEADER_SIZE, packet_len);')
+            w.line('return NRF_SUCCESS;')
+            w.close()
+            w.line()
+            w.line('uint32_t index;')
+            cur = Cursor(RSP_HEADER_SIZE)
+            reads = []
+            self.dec_fields(cmd.rsp, Access(), cur, reads, w)
+            self.dec_segment(cur, reads, w)
+            w.line()
+            w.line('SER_ASSERT_LENGTH_EQ(index, packet_len);')
+            w.line('return NRF_SUCCESS;')
+        self.function(out, cmd.name + '_rsp_dec', params, w)
+
+    def req_dec(self, cmd, out):
+        params = [('uint8_t const * const', 'p_buf'), (cmd.packet_len, 'packet_len')]
+        params += self.param_types(cmd.req, False)
+        w = Writer()
+        w.line('SER_ASSERT_NOT_NULL(p_buf);')
+        w.line('SER_ASSERT(packet_len > 0, NRF_ERROR_INVALID_PARAM);')
+        w.line('SER_ASSERT(p_buf[0] == %s, NRF_ERROR_INVALID_PARAM);' % cmd.opcode)
+        for check in cmd.checks:
+            w.line('SER_ASSERT_NOT_NULL(%s);' % check)
+        w.line()
+        w.line('uint32_t index;')
+        cur = Cursor(1)
+        reads = []
+        self.dec_fields(cmd.req, Access(), cur, reads, w)
+        self.dec_segment(cur, reads, w)
+        w.line()
+        w.line('SER_ASSERT_LENGTH_EQ(index, packet_len);')
+        w.line('return NRF_SUCCESS;')
+        self.function(out, cmd.name + '_req_dec', params, w)
+
+    def rsp_enc(self, cmd, out):
+        params = [('uint32_t', 'return_code'), ('uint8_t * const', 'p_buf'),
+                  ('uint32_t * const', 'p_buf_len')]
+        params += self.param_types(cmd.rsp, True)
+        w = Writer()
+        w.line('SER_ASSERT_NOT_NULL(p_buf);')
+        w.line('SER_ASSERT_NOT_NULL(p_buf_len);')
+        w.line()
+        w.line('uint32_t index;')
+        cur = Cursor(RSP_HEADER_SIZE)
+
+        def header(w):
+            w.line('p_buf[SER_CMD_OP_CODE_POS] = %s;' % cmd.opcode)
+            w.line('(void)uint32_encode(return_code, &p_buf[SER_CMD_RSP_STATUS_CODE_POS]);')
+        self.encoder(header, cmd.rsp, Access(), cur, w,
+                     guard='return_code == NRF_SUCCESS' if cmd.rsp else None)
+        self.function(out, cmd.name + '_rsp_enc', params, w)
+
+    def event_access(self, evt):
+        return Access('p_event->evt.%s_evt.' % evt.group, 'ble_evt_t', 'evt.%s_evt.' % evt.group)
+
+    def evt_enc(self, evt, out):
+        params = [('ble_evt_t const * const', 'p_event'), ('uint32_t', 'event_len'),
+                  ('uint8_t * const', 'p_buf'), ('uint32_t * const', 'p_buf_len')]
+        w = Writer()
+        w.line('SER_ASSERT_NOT_NULL(p_event);')
+        w.line('SER_ASSERT_NOT_NULL(p_buf);')
+        w.line('SER_ASSERT_NOT_NULL(p_buf_len);')
+        w.line('SER_ASSERT(p_event->header.evt_id == %s, NRF_ERROR_INVALID_PARAM);' % evt.evt_id)
+        w.line()
+        w.line('uint32_t index;')
+        cur = Cursor(EVT_HEADER_SIZE)
+
+        def header(w):
+            w.line('(void)uint16_encode(%s, &p_buf[SER_EVT_ID_POS]);' % evt.evt_id)
+        self.encoder(header, evt.fields, self.event_access(evt), cur, w)
+        self.function(out, evt.name + '_enc', params, w)
+
+    def evt_dec(self, evt, out):
+        params = [('uint8_t const * const', 'p_buf'), ('uint32_t', 'packet_len'),
+                  ('ble_evt_t * const', 'p_event'), ('uint32_t * const', 'p_event_len')]
+        ext = self.has_ext(evt.fields)
+        w = Writer()
+        w.line('SER_ASSERT_NOT_NULL(p_buf);')
+        w.line('SER_ASSERT_NOT_NULL(p_event_len);')
+        w.line()
+        w.line('uint32_t const evt_struct_len = offsetof(ble_evt_t, evt.%s_evt.params)' % evt.group)
+        w.line('                              - offsetof(ble_evt_t, evt)')
+        w.line('                              + sizeof(%s);' % evt.params_type)
+        w.line('SER_ASSERT_LENGTH_LEQ(evt_struct_len, *p_event_len);')
+        if ext:
+            w.line('*p_event_len -= evt_struct_len;')
+            w.line('uint32_t evt_extended_len = 0;')
+        w.line('p_event->header.evt_id = %s;' % evt.evt_id)
+        w.line()
+        w.line('uint32_t index;')
+        cur = Cursor()
+        reads = []
+        self.dec_fields(evt.fields, self.event_access(evt), cur, reads, w)
+        self.dec_segment(cur, reads, w)
+        w.line()
+        w.line('SER_ASSERT_LENGTH_EQ(index, packet_len);')
+        w.line('*p_event_len = evt_struct_len%s;' % (' + evt_extended_len' if ext else ''))
+        w.line('return NRF_SUCCESS;')
+        self.function(out, evt.name + '_dec', params, w)
+
+    def generate(self, side):
+        """Returns the list of header names and the list of source lines."""
+        out = []
+        headers = []
+        for cmd in self.schema.commands:
+            module = '_'.join(cmd.name.split('_')[:2])
+            headers.append('%s_%s.h' % (module, side))
+            if side == 'app':
+                self.req_enc(cmd, out)
+                self.rsp_dec(cmd, out)
+            else:
+                self.req_dec(cmd, out)
+                self.rsp_enc(cmd, out)
+        for evt in self.schema.events:
+            module = 'ble_evt' if evt.group == 'common' else 'ble_%s_evt' % evt.group
+            headers.append('%s_%s.h' % (module, side))
+            if side == 'app':
+                self.evt_dec(evt, out)
+            else:
+                self.evt_enc(evt, out)
+
+        unique = []
+        for header in headers:
+            if header not in unique:
+                unique.append(header)
+        return unique, out
+
+
+def prototypes(lines):
+    """Extracts the prototypes from the generated source."""
+    result = []
+    proto = []
+    for line in lines:
+        if line.startswith('uint32_t ') or proto:
+            proto.append(line)
+            if line.endswith(')'):
+                result.append('\n'.join(proto) + ';')
+                proto = []
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Generate serialization codecs from a schema.')
+    parser.add_argument('schema', help='schema file')
+    parser.add_argument('side', choices=('app', 'conn'), help='side of the link to generate')
+    parser.add_argument('output', help='C file to write')
+    parser.add_argument('--prefix', default='',
+                        help='prefix of the function names, to link the generated codecs '
+                             'next to the hand-written ones')
+    parser.add_argument('--header', help='also write the prototypes to this header')
+    args = parser.parse_args()
+
+    try:
+        schema = parse_schema(args.schema)
+        generator = Generator(schema, args.prefix)
+        headers, body = generator.generate(args.side)
+    except (SchemaError, OSError) as e:
+        sys.exit('ser_codegen: %s' % e)
+
+    schema_name = os.path.basename(args.schema)
+    lines = [LICENSE.rstrip('\n')]
+    lines.append('')
+    lines.append('/* Generated by ser_codegen.py from %s. Do not edit. */' % schema_name)
+    lines.append('')
+    lines.append('#include <string.h>')
+    lines.append('#include "ble_serialization.h"')
+    for header in headers:
+        lines.append('#include "%s"' % header)
+    if args.header:
+        lines.append('#include "%s"' % os.path.basename(args.header))
+    lines.append('#include "app_util.h"')
+    lines.append('')
+    guarded = not args.prefix
+    if guarded:
+        lines.append('#if SER_CODEC_GEN_ENABLED')
+        lines.append('')
+    if generator.asserts:
+        lines.append('// Runs of members which are copied at once must be contiguous.')
+        for line in generator.asserts:
+            lines.append(line)
+        lines.append('')
+        lines.append('// The runs are copied in the byte order of the target and the wire format is little-endian,')
+        lines.append('// as are the Cortex-M cores of the nRF5 devices.')
+        lines.append('#if defined(__BYTE_ORDER__)')
+        lines.append('STATIC_ASSERT(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__);')
+        lines.append('#elif defined(__BIG_ENDIAN) || (defined(__ICCARM__) && !__LITTLE_ENDIAN__)')
+        lines.append('#error "The generated codecs need a little-endian target."')
+        lines.append('#endif')
+        lines.append('')
+    lines.append('')
+    lines.extend(body)
+    while lines[-1] == '':
+        lines.pop()
+    if guarded:
+        lines.append('')
+        lines.append('#endif // SER_CODEC_GEN_ENABLED')
+
+    with open(args.output, 'w') as f:
+        f.write('\n'.join(lines) + '\n')
+
+    if args.header:
+        guard = re.sub(r'\W', '_', os.path.basename(args.header)).upper() + '__'
+        with open(args.header, 'w') as f:
+            f.write(LICENSE)
+            f.write('\n/* Generated by ser_codegen.py from %s. Do not edit. */\n\n' % schema_name)
+            f.write('#ifndef %s\n#define %s\n\n' % (guard, guard))
+            f.write('#include <stdint.h>\n#include "ble.h"\n\n')
+            f.write('\n\n'.join(prototypes(body)) + '\n\n')
+            f.write('#endif // %s\n' % guard)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,33 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host replacement of components/libraries/util/app_util_platform.h for the HAL Transport
+ * benchmark. Interrupts are simulated: a PHY interrupt may be taken where the code enters a
+ * critical region, just before it would be masked, and where the region ends. Code that updates
+ * shared state in two steps outside one region is interrupted in between. */
+
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include <stdint.h>
+#include "compiler_abstraction.h"
+
+/**@brief Function for taking the pending simulated interrupts. */
+void ser_transport_bench_isr_point(void);
+
+#define CRITICAL_REGION_ENTER()     { ser_transport_bench_isr_point();
+#define CRITICAL_REGION_EXIT()      ser_transport_bench_isr_point(); }
+
+#define ANON_UNIONS_ENABLE
+#define ANON_UNIONS_DISABLE
+
+#endif // APP_UTIL_PLATFORM_H__
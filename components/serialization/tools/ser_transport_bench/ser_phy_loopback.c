@@ -0,0 +1,163 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+#include <string.h>
+#include "nrf_error.h"
+#include "ser_config.h"
+#include "ser_phy.h"
+#include "ser_phy_loopback.h"
+
+typedef enum
+{
+    LOOPBACK_STATE_CLOSED,
+    LOOPBACK_STATE_IDLE,
+    LOOPBACK_STATE_HEADER,      /**< Transmitting the packet header. */
+    LOOPBACK_STATE_WAIT_BUF,    /**< Header received, waiting for an RX buffer. */
+    LOOPBACK_STATE_PAYLOAD,     /**< Transmitting the packet payload. */
+} loopback_state_t;
+
+static ser_phy_events_handler_t m_events_handler;
+static loopback_state_t         m_state = LOOPBACK_STATE_CLOSED;
+static uint64_t                 m_byte_time_ns = 10000;     // 1 Mbaud UART.
+static uint64_t                 m_now;
+static uint64_t                 m_event_time;               // End of the header or the payload.
+
+static const uint8_t * mp_tx_buffer;
+static uint16_t        m_tx_length;
+static uint8_t *       mp_rx_buffer;
+
+
+void ser_phy_loopback_byte_time_set(uint64_t byte_time_ns)
+{
+    m_byte_time_ns = byte_time_ns;
+}
+
+
+bool ser_phy_loopback_next_event_get(uint64_t * p_time)
+{
+    if ((m_state == LOOPBACK_STATE_HEADER) || (m_state == LOOPBACK_STATE_PAYLOAD))
+    {
+        *p_time = m_event_time;
+        return true;
+    }
+    return false;
+}
+
+
+void ser_phy_loopback_run(uint64_t now)
+{
+    ser_phy_evt_t event;
+
+    m_now = now;
+
+    if ((m_state == LOOPBACK_STATE_HEADER) && (m_event_time <= now))
+    {
+        m_state = LOOPBACK_STATE_WAIT_BUF;
+
+        event.evt_type                               = SER_PHY_EVT_RX_BUF_REQUEST;
+        event.evt_params.rx_buf_request.num_of_bytes = m_tx_length;
+        m_events_handler(event);
+    }
+
+    if ((m_state == LOOPBACK_STATE_PAYLOAD) && (m_event_time <= now))
+    {
+        uint8_t * p_rx_buffer = mp_rx_buffer;
+
+        // The PHY is idle before the events, so that the next packet can be sent from them.
+        m_state = LOOPBACK_STATE_IDLE;
+
+        if (p_rx_buffer != NULL)
+        {
+            memcpy(p_rx_buffer, mp_tx_buffer, m_tx_length);
+            event.evt_type                                = SER_PHY_EVT_RX_PKT_RECEIVED;
+            event.evt_params.rx_pkt_received.p_buffer     = p_rx_buffer;
+            event.evt_params.rx_pkt_received.num_of_bytes = m_tx_length;
+        }
+        else
+        {
+            event.evt_type = SER_PHY_EVT_RX_PKT_DROPPED;
+        }
+        m_events_handler(event);
+
+        event.evt_type = SER_PHY_EVT_TX_PKT_SENT;
+        m_events_handler(event);
+    }
+}
+
+
+uint32_t ser_phy_open(ser_phy_events_handler_t events_handler)
+{
+    if (events_handler == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (m_state != LOOPBACK_STATE_CLOSED)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    m_events_handler = events_handler;
+    m_state          = LOOPBACK_STATE_IDLE;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ser_phy_tx_pkt_send(const uint8_t * p_buffer, uint16_t num_of_bytes)
+{
+    if (p_buffer == NULL)
+    {
+        return NRF_ERROR_NULL;
+    }
+    if (num_of_bytes == 0)
+    {
+        return NRF_ERROR_INVALID_PARAM;
+    }
+    if (m_state != LOOPBACK_STATE_IDLE)
+    {
+        return NRF_ERROR_BUSY;
+    }
+    mp_tx_buffer = p_buffer;
+    m_tx_length  = num_of_bytes;
+    m_event_time = m_now + SER_PHY_HEADER_SIZE * m_byte_time_ns;
+    m_state      = LOOPBACK_STATE_HEADER;
+    return NRF_SUCCESS;
+}
+
+
+uint32_t ser_phy_rx_buf_set(uint8_t * p_buffer)
+{
+    if (m_state != LOOPBACK_STATE_WAIT_BUF)
+    {
+        return NRF_ERROR_INVALID_STATE;
+    }
+    mp_rx_buffer = p_buffer;
+    m_event_time = m_now + m_tx_length * m_byte_time_ns;
+    m_state      = LOOPBACK_STATE_PAYLOAD;
+    return NRF_SUCCESS;
+}
+
+
+void ser_phy_close(void)
+{
+    m_events_handler = NULL;
+    m_state          = LOOPBACK_STATE_CLOSED;
+}
+
+
+// The events are generated from ser_phy_loopback_run(), never during a call to the transport.
+void ser_phy_interrupts_enable(void)
+{
+}
+
+
+void ser_phy_interrupts_disable(void)
+{
+}
@@ -0,0 +1,41 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Loopback implementation of the ser_phy API for a PC host. Packets sent with ser_phy_tx_pkt_send()
+ * are received by the same PHY, after the time their transmission takes on a link of the configured
+ * byte time. The reception of a packet waits after its header until an RX buffer is set, like a
+ * UART link with flow control.
+ *
+ * The time is simulated: the caller sets the current time and runs the PHY events which are due,
+ * as the PHY interrupt would. */
+
+#ifndef SER_PHY_LOOPBACK_H__
+#define SER_PHY_LOOPBACK_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/**@brief Function for setting the time needed to transmit one byte, in nanoseconds. */
+void ser_phy_loopback_byte_time_set(uint64_t byte_time_ns);
+
+/**@brief Function for getting the time of the next PHY event.
+ *
+ * @param[out] p_time   Time of the next event, in nanoseconds.
+ *
+ * @return False if no event is pending.
+ */
+bool ser_phy_loopback_next_event_get(uint64_t * p_time);
+
+/**@brief Function for setting the current time and generating the PHY events which are due. */
+void ser_phy_loopback_run(uint64_t now);
+
+#endif // SER_PHY_LOOPBACK_H__
@@ -0,0 +1,535 @@
+/* Copyright (c) 2016 Nordic Semiconductor. All Rights Reserved.
+ *
+ * The information contained herein is property of Nordic Semiconductor ASA.
+ * Terms and conditions of usage are described in detail in NORDIC
+ * SEMICONDUCTOR STANDARD SOFTWARE LICENSE AGREEMENT.
+ *
+ * Licensees are granted free, non-transferable use of the information. NO
+ * WARRANTY of ANY KIND is provided. This heading must NOT be removed from
+ * the file.
+ *
+ */
+
+/* Host test and benchmark of the serialization HAL Transport layer over the loopback PHY.
+ *
+ * A producer allocates TX buffers, spends the encode time on each packet and sends it. The packets
+ * are received by the same transport, and a consumer spends the decode time on each of them before
+ * freeing it. The producer, the link and the consumer run in parallel in simulated time, as the two
+ * chips and the link would. The test checks the API error codes, that the packets are received in
+ * order and intact, and prints the throughput and the latency (from sending a packet to freeing it
+ * after decoding).
+ *
+ * A second case passes the received packets to ser_conn_handlers.c, as on the connectivity chip,
+ * with simulated interrupts (see app_util_platform.h in this directory), so that packets arrive
+ * while the handler is taking and processing the previous one.
+ *
+ * Command line: packets=<n> len=<bytes> encode_us=<us> decode_us=<us> baud=<bit/s>
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "nrf_error.h"
+#include "app_util.h"
+#include "ser_config.h"
+#include "ser_hal_transport.h"
+#include "ser_phy_loopback.h"
+#include "ser_conn_handlers.h"
+#include "ser_conn_pkt_decoder.h"
+#include "ser_conn_event_encoder.h"
+#include "ser_conn_dtm_cmd_decoder.h"
+#include "app_scheduler.h"
+#include "softdevice_handler.h"
+
+#define PACKETS_DEFAULT     (10000)
+#define LEN_DEFAULT         (40)        // Typical notification: 20 bytes of data and the headers.
+#define ENCODE_US_DEFAULT   (150)
+#define DECODE_US_DEFAULT   (150)
+#define BAUD_DEFAULT        (1000000)
+#define BITS_PER_BYTE       (10)        // UART: start bit, 8 data bits and stop bit.
+#define NO_EVENT            (UINT64_MAX)
+
+typedef struct
+{
+    uint8_t * p_buffer;
+    uint16_t  num_of_bytes;
+} rx_pkt_t;
+
+static uint32_t m_packets   = PACKETS_DEFAULT;
+static uint32_t m_len       = LEN_DEFAULT;
+static uint64_t m_encode_ns = ENCODE_US_DEFAULT * 1000ull;
+static uint64_t m_decode_ns = DECODE_US_DEFAULT * 1000ull;
+
+static uint64_t m_now;
+static uint64_t m_conn_now;                 // Time of the connectivity handler case.
+
+static uint8_t * mp_encoding;               // TX buffer being encoded.
+static uint64_t  m_encode_end  = NO_EVENT;
+static bool      m_wait_tx_buf;             // The producer waits for a TX buffer to be freed.
+static uint64_t  m_producer_time;           // When the producer tries to allocate the next buffer.
+static uint32_t  m_sent;
+
+static rx_pkt_t  m_rx_queue[SER_HAL_TRANSPORT_RX_BUF_COUNT];
+static uint32_t  m_rx_head;
+static uint32_t  m_rx_count;
+static uint64_t  m_decode_end  = NO_EVENT;
+static uint32_t  m_decoded;
+
+static uint64_t * mp_send_time;
+static uint64_t   m_latency_sum;
+static uint64_t   m_latency_max;
+static uint32_t   m_tx_sent_evts;
+
+static bool      m_isr_sim;                 // Simulated interrupts are taken at critical regions.
+static bool      m_in_isr;
+static uint32_t  m_isr_seed    = 1;         // Decides at which interrupt points the PHY advances.
+static uint32_t  m_conn_received;
+static uint32_t  m_conn_processed;
+
+static uint32_t m_checks;
+static uint32_t m_failures;
+
+
+void app_error_handler_bare(uint32_t error_code)
+{
+    printf("APP_ERROR_CHECK failed: 0x%X\n", error_code);
+    exit(1);
+}
+
+
+void app_error_handler(uint32_t error_code, uint32_t line_num, const uint8_t * p_file_name)
+{
+    printf("APP_ERROR_CHECK failed: 0x%X at %s:%u\n", error_code, p_file_name, line_num);
+    exit(1);
+}
+
+
+static void check(bool ok, char const * p_what)
+{
+    m_checks++;
+    if (!ok)
+    {
+        if (m_failures < 20)
+        {
+            printf("FAILED: %s\n", p_what);
+        }
+        m_failures++;
+    }
+}
+
+
+static void hal_transport_handler(ser_hal_transport_evt_t event)
+{
+    switch (event.evt_type)
+    {
+        case SER_HAL_TRANSP_EVT_TX_PKT_SENT:
+            m_tx_sent_evts++;
+            if (m_wait_tx_buf)
+            {
+                m_wait_tx_buf   = false;
+                m_producer_time = m_now;
+            }
+            break;
+
+        case SER_HAL_TRANSP_EVT_RX_PKT_RECEIVED:
+        {
+            uint32_t tail = (m_rx_head + m_rx_count) % SER_HAL_TRANSPORT_RX_BUF_COUNT;
+
+            check(m_rx_count < SER_HAL_TRANSPORT_RX_BUF_COUNT, "more received packets than RX buffers");
+            m_rx_queue[tail].p_buffer     = event.evt_params.rx_pkt_received.p_buffer;
+            m_rx_queue[tail].num_of_bytes = event.evt_params.rx_pkt_received.num_of_bytes;
+            m_rx_count++;
+        } break;
+
+        case SER_HAL_TRANSP_EVT_RX_PKT_RECEIVING:
+            break;
+
+        default:
+            check(false, "unexpected HAL Transport event");
+            break;
+    }
+}
+
+
+static void packet_fill(uint8_t * p_buffer, uint32_t seq)
+{
+    (void)uint32_encode(seq, p_buffer);
+    for (uint32_t i = 4; i < m_len; i++)
+    {
+        p_buffer[i] = (uint8_t)(seq + i);
+    }
+}
+
+
+static bool packet_check(uint8_t const * p_buffer, uint32_t len, uint32_t seq)
+{
+    if ((len != m_len) || (uint32_decode(p_buffer) != seq))
+    {
+        return false;
+    }
+    for (uint32_t i = 4; i < m_len; i++)
+    {
+        if (p_buffer[i] != (uint8_t)(seq + i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+
+/**@brief Checks the error codes of the API on an open, idle transport. */
+static void api_test(void)
+{
+    uint8_t * p_buf[SER_HAL_TRANSPORT_TX_BUF_COUNT];
+    uint8_t * p_extra;
+    uint16_t  len;
+    uint8_t   not_a_buffer[4];
+
+    for (uint32_t i = 0; i < SER_HAL_TRANSPORT_TX_BUF_COUNT; i++)
+    {
+        check(ser_hal_transport_tx_pkt_alloc(&p_buf[i], &len) == NRF_SUCCESS, "alloc");
+        check(len == SER_HAL_TRANSPORT_TX_MAX_PKT_SIZE, "allocated size");
+        for (uint32_t j = 0; j < i; j++)
+        {
+            check(p_buf[i] != p_buf[j], "distinct buffers");
+        }
+    }
+    check(ser_hal_transport_tx_pkt_alloc(&p_extra, &len) == NRF_ERROR_NO_MEM, "alloc when all are used");
+    check(ser_hal_transport_tx_pkt_alloc(NULL, &len) == NRF_ERROR_NULL, "alloc NULL");
+    check(ser_hal_transport_tx_pkt_send(not_a_buffer, 1) == NRF_ERROR_INVALID_ADDR, "send other memory");
+    check(ser_hal_transport_tx_pkt_send(p_buf[0] + 1, 1) == NRF_ERROR_INVALID_ADDR, "send inside a buffer");
+    check(ser_hal_transport_tx_pkt_send(p_buf[0], 0) == NRF_ERROR_INVALID_PARAM, "send 0 bytes");
+    check(ser_hal_transport_tx_pkt_send(p_buf[0], SER_HAL_TRANSPORT_TX_MAX_PKT_SIZE + 1) ==
+          NRF_ERROR_DATA_SIZE, "send too long");
+    check(ser_hal_transport_tx_pkt_free(not_a_buffer) == NRF_ERROR_INVALID_ADDR, "free other memory");
+    check(ser_hal_transport_rx_pkt_free(p_buf[0]) == NRF_ERROR_INVALID_ADDR, "free TX buffer as RX");
+    check(ser_hal_transport_rx_pkt_free(NULL) == NRF_ERROR_NULL, "free NULL RX buffer");
+
+    for (uint32_t i = 0; i < SER_HAL_TRANSPORT_TX_BUF_COUNT; i++)
+    {
+        check(ser_hal_transport_tx_pkt_free(p_buf[i]) == NRF_SUCCESS, "free");
+        check(ser_hal_transport_tx_pkt_free(p_buf[i]) == NRF_ERROR_INVALID_STATE, "free twice");
+        check(ser_hal_transport_tx_pkt_send(p_buf[i], 1) == NRF_ERROR_INVALID_STATE, "send freed");
+    }
+    check(ser_hal_transport_tx_pkt_alloc(&p_extra, &len) == NRF_SUCCESS, "alloc after free");
+    check(ser_hal_transport_tx_pkt_free(p_extra) == NRF_SUCCESS, "free after alloc");
+}
+
+
+static uint64_t min_time(uint64_t a, uint64_t b)
+{
+    return (a < b) ? a : b;
+}
+
+
+/**@brief Runs the producer, the link and the consumer until all packets have been decoded. */
+static void run(void)
+{
+    uint16_t len;
+
+    while (m_decoded < m_packets)
+    {
+        uint64_t next = NO_EVENT;
+        uint64_t phy_time;
+
+        // Find the time of the next event.
+        if (ser_phy_loopback_next_event_get(&phy_time))
+        {
+            next = phy_time;
+        }
+        next = min_time(next, m_encode_end);
+        next = min_time(next, m_decode_end);
+        if ((mp_encoding == NULL) && !m_wait_tx_buf && (m_sent < m_packets))
+        {
+            next = min_time(next, m_producer_time);
+        }
+        if ((m_decode_end == NO_EVENT) && (m_rx_count > 0))
+        {
+            next = min_time(next, m_now);
+        }
+        if (next == NO_EVENT)
+        {
+            check(false, "deadlock");
+            return;
+        }
+        m_now = next;
+
+        // The PHY interrupt has the highest priority.
+        ser_phy_loopback_run(m_now);
+
+        if (m_encode_end <= m_now)
+        {
+            packet_fill(mp_encoding, m_sent);
+            mp_send_time[m_sent] = m_now;
+            check(ser_hal_transport_tx_pkt_send(mp_encoding, (uint16_t)m_len) == NRF_SUCCESS, "send");
+            m_sent++;
+            mp_encoding     = NULL;
+            m_encode_end    = NO_EVENT;
+            m_producer_time = m_now;
+        }
+
+        if ((mp_encoding == NULL) && !m_wait_tx_buf && (m_sent < m_packets) && (m_producer_time <= m_now))
+        {
+            uint32_t err_code = ser_hal_transport_tx_pkt_alloc(&mp_encoding, &len);
+
+            if (err_code == NRF_SUCCESS)
+            {
+                m_encode_end = m_now + m_encode_ns;
+            }
+            else
+            {
+                // Back-pressure: wait for a transmission to complete.
+                check(err_code == NRF_ERROR_NO_MEM, "alloc error code");
+                mp_encoding   = NULL;
+                m_wait_tx_buf = true;
+            }
+        }
+
+        if (m_decode_end <= m_now)
+        {
+            rx_pkt_t * p_pkt   = &m_rx_queue[m_rx_head];
+            uint64_t   latency = m_now - mp_send_time[m_decoded];
+
+            check(packet_check(p_pkt->p_buffer, p_pkt->num_of_bytes, m_decoded), "packet order and content");
+            m_latency_sum += latency;
+            m_latency_max  = (latency > m_latency_max) ? latency : m_latency_max;
+            m_decoded++;
+
+            m_rx_head = (m_rx_head + 1) % SER_HAL_TRANSPORT_RX_BUF_COUNT;
+            m_rx_count--;
+            m_decode_end = NO_EVENT;
+            check(ser_hal_transport_rx_pkt_free(p_pkt->p_buffer) == NRF_SUCCESS, "rx free");
+            check(ser_hal_transport_rx_pkt_free(p_pkt->p_buffer) == NRF_ERROR_INVALID_STATE, "rx free twice");
+        }
+
+        if ((m_decode_end == NO_EVENT) && (m_rx_count > 0))
+        {
+            m_decode_end = m_now + m_decode_ns;
+        }
+    }
+}
+
+
+/* Stand-ins for the parts of the connectivity application that ser_conn_handlers.c calls. */
+
+void app_sched_pause(void)
+{
+}
+
+
+void app_sched_resume(void)
+{
+}
+
+
+uint32_t app_sched_event_put(void * p_event_data, uint16_t event_size, app_sched_event_handler_t handler)
+{
+    return NRF_SUCCESS;
+}
+
+
+uint16_t app_sched_queue_space_get(void)
+{
+    return 1;
+}
+
+
+void softdevice_handler_suspend(void)
+{
+}
+
+
+void ser_conn_is_ready_to_enter_dtm(void)
+{
+}
+
+
+void ser_conn_ble_event_encoder(void * p_event_data, uint16_t event_size)
+{
+}
+
+
+/**@brief Takes the next PHY event, if any, at some of the points where an interrupt can occur.
+ *
+ * @details The link runs at an unknown speed relative to the connectivity main loop, so whether an
+ *          event occurs at a given point is decided by a pseudo-random sequence with a fixed seed.
+ *          Over many packets, every event is taken at every point, including between two
+ *          updates of shared state which are not in one critical region.
+ */
+void ser_transport_bench_isr_point(void)
+{
+    uint64_t phy_time;
+
+    if (!m_isr_sim || m_in_isr)
+    {
+        return;
+    }
+
+    m_isr_seed ^= m_isr_seed << 13;
+    m_isr_seed ^= m_isr_seed >> 17;
+    m_isr_seed ^= m_isr_seed << 5;
+
+    if (((m_isr_seed & 1) != 0) && ser_phy_loopback_next_event_get(&phy_time))
+    {
+        m_in_isr = true;
+        if (phy_time > m_conn_now)
+        {
+            m_conn_now = phy_time;
+        }
+        ser_phy_loopback_run(m_conn_now);
+        m_in_isr = false;
+    }
+}
+
+
+// Replaces the command decoder: checks the packet and frees its buffer.
+uint32_t ser_conn_received_pkt_process(ser_hal_transport_evt_rx_pkt_received_params_t * p_rx_pkt_params)
+{
+    check(packet_check(p_rx_pkt_params->p_buffer, p_rx_pkt_params->num_of_bytes, m_conn_processed),
+          "connectivity packet order and content");
+    m_conn_processed++;
+    check(ser_hal_transport_rx_pkt_free(p_rx_pkt_params->p_buffer) == NRF_SUCCESS, "connectivity rx free");
+
+    // The freed buffer lets the next packet in while this one is still being processed.
+    ser_transport_bench_isr_point();
+    return NRF_SUCCESS;
+}
+
+
+static void conn_event_handle(ser_hal_transport_evt_t event)
+{
+    if (event.evt_type == SER_HAL_TRANSP_EVT_RX_PKT_RECEIVED)
+    {
+        m_conn_received++;
+    }
+    ser_conn_hal_transport_event_handle(event);
+}
+
+
+/**@brief Sends packets back to back and processes them with ser_conn_rx_process().
+ *
+ * @details The PHY events are taken as simulated interrupts at the critical regions in the
+ *          handler and in the main loop, see @ref ser_transport_bench_isr_point.
+ */
+static void conn_run(void)
+{
+    uint32_t sent = 0;
+    uint16_t len;
+    uint64_t phy_time;
+
+    check(ser_hal_transport_open(conn_event_handle) == NRF_SUCCESS, "open connectivity");
+    m_conn_now = m_now;
+    m_isr_sim  = true;
+
+    while (m_conn_processed < m_packets)
+    {
+        uint8_t * p_buf;
+
+        while ((sent < m_packets) && (ser_hal_transport_tx_pkt_alloc(&p_buf, &len) == NRF_SUCCESS))
+        {
+            packet_fill(p_buf, sent);
+            check(ser_hal_transport_tx_pkt_send(p_buf, (uint16_t)m_len) == NRF_SUCCESS, "connectivity send");
+            sent++;
+        }
+
+        if (!ser_phy_loopback_next_event_get(&phy_time) && (m_conn_received == m_conn_processed))
+        {
+            check(false, "connectivity deadlock");
+            break;
+        }
+
+        check(ser_conn_rx_process() == NRF_SUCCESS, "rx process");
+        ser_transport_bench_isr_point();
+        check(m_conn_received - m_conn_processed <= SER_HAL_TRANSPORT_RX_BUF_COUNT,
+              "more received packets than RX buffers");
+        if (m_failures > 0)
+        {
+            break;
+        }
+    }
+
+    m_isr_sim = false;
+    ser_hal_transport_close();
+}
+
+
+int main(int argc, char * argv[])
+{
+    uint32_t baud = BAUD_DEFAULT;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "packets=", 8) == 0)
+        {
+            m_packets = strtoul(argv[i] + 8, NULL, 0);
+        }
+        else if (strncmp(argv[i], "len=", 4) == 0)
+        {
+            m_len = strtoul(argv[i] + 4, NULL, 0);
+        }
+        else if (strncmp(argv[i], "encode_us=", 10) == 0)
+        {
+            m_encode_ns = strtoull(argv[i] + 10, NULL, 0) * 1000;
+        }
+        else if (strncmp(argv[i], "decode_us=", 10) == 0)
+        {
+            m_decode_ns = strtoull(argv[i] + 10, NULL, 0) * 1000;
+        }
+        else if (strncmp(argv[i], "baud=", 5) == 0)
+        {
+            baud = strtoul(argv[i] + 5, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [packets=<n>] [len=<bytes>] [encode_us=<us>] "
+                            "[decode_us=<us>] [baud=<bit/s>]\n", argv[0]);
+            return 2;
+        }
+    }
+    if ((m_len < 4) || (m_len > SER_HAL_TRANSPORT_TX_MAX_PKT_SIZE) || (m_packets == 0) || (baud == 0))
+    {
+        fprintf(stderr, "len must be 4 to %u bytes, packets and baud more than 0\n",
+                (unsigned)SER_HAL_TRANSPORT_TX_MAX_PKT_SIZE);
+        return 2;
+    }
+
+    mp_send_time = calloc(m_packets, sizeof(uint64_t));
+    if (mp_send_time == NULL)
+    {
+        return 2;
+    }
+
+    ser_phy_loopback_byte_time_set(BITS_PER_BYTE * 1000000000ull / baud);
+
+    check(ser_hal_transport_open(NULL) == NRF_ERROR_NULL, "open NULL");
+    check(ser_hal_transport_open(hal_transport_handler) == NRF_SUCCESS, "open");
+    check(ser_hal_transport_open(hal_transport_handler) == NRF_ERROR_INVALID_STATE, "open twice");
+
+    api_test();
+    run();
+    check(m_tx_sent_evts == m_packets, "one TX_PKT_SENT event per packet");
+
+    ser_hal_transport_close();
+    uint8_t * p_buf;
+    check(ser_hal_transport_tx_pkt_alloc(&p_buf, &(uint16_t){0}) == NRF_ERROR_INVALID_STATE, "alloc closed");
+
+    conn_run();
+    check(m_conn_processed == m_packets, "connectivity packets processed");
+
+    printf("TX buffers %u, RX buffers %u: %u packets of %u bytes, encode %u us, decode %u us, "
+           "%u bit/s\n",
+           (unsigned)SER_HAL_TRANSPORT_TX_BUF_COUNT, (unsigned)SER_HAL_TRANSPORT_RX_BUF_COUNT,
+           m_decoded, m_len, (unsigned)(m_encode_ns / 1000), (unsigned)(m_decode_ns / 1000), baud);
+    if (m_decoded > 0)
+    {
+        printf("  %.0f packets/s, latency %.1f us average, %.1f us max\n",
+               m_decoded / (m_now * 1e-9), m_latency_sum / (m_decoded * 1e3), m_latency_max / 1e3);
+    }
+    printf("  connectivity handler: %u packets processed\n", m_conn_processed);
+    printf("  %u checks, %u failures\n", m_checks, m_failures);
+
+    free(mp_send_time);
+    return (m_failures == 0) ? 0 : 1;
+}
@@ -139,6 +139,70 @@ extern "C" {
 		*/
 		void  HID_API_EXPORT HID_API_CALL hid_free_enumeration(struct hid_device_info *devs);
 
+		/** Hotplug events passed to a #hid_hotplug_callback. */
+		enum hid_hotplug_event {
+			/** A matching device has been attached. */
+			HID_HOTPLUG_EVENT_DEVICE_ARRIVED = 1,
+			/** A matching device has been detached. */
+			HID_HOTPLUG_EVENT_DEVICE_LEFT = 2
+		};
+
+		/** Callback invoked when a device is attached or detached.
+		    @p info is only valid for the duration of the call. */
+		typedef void (HID_API_CALL *hid_hotplug_callback)(enum hid_hotplug_event event, const struct hid_device_info *info, void *user_data);
+
+		/** @brief Register a callback for device arrival and removal.
+
+			The callback is called for each device which matches
+			@p vendor_id and @p product_id (0 matching any) when it is
+			attached or detached. Callbacks run on the thread which
+			calls hid_hotplug_process() or hid_enumerate(), and must
+			not register or deregister callbacks themselves.
+
+			Hotplug notification is currently only implemented by the
+			Linux/hidraw backend.
+
+			@ingroup API
+			@param vendor_id The Vendor ID (VID) to match, or 0.
+			@param product_id The Product ID (PID) to match, or 0.
+			@param callback The function to call.
+			@param user_data Passed unmodified to @p callback.
+
+			@returns
+				This function returns 0 on success and -1 on error.
+		*/
+		int HID_API_EXPORT HID_API_CALL hid_register_hotplug_callback(unsigned short vendor_id, unsigned short product_id, hid_hotplug_callback callback, void *user_data);
+
+		/** @brief Deregister a callback registered with
+			hid_register_hotplug_callback().
+
+			@ingroup API
+			@param callback The function which was registered.
+			@param user_data The user data it was registered with.
+
+			@returns
+				This function returns 0 on success and -1 if no such
+				callback was registered.
+		*/
+		int HID_API_EXPORT HID_API_CALL hid_deregister_hotplug_callback(hid_hotplug_callback callback, void *user_data);
+
+		/** @brief Process pending hotplug events.
+
+			Waits up to @p milliseconds for devices to be attached or
+			detached, updates the device list used by hid_enumerate()
+			and calls the registered hotplug callbacks.
+
+			@ingroup API
+			@param milliseconds timeout in milliseconds, 0 to only
+				process events which are already pending, or -1 for
+				blocking wait.
+
+			@returns
+				This function returns the number of events processed
+				and -1 on error.
+		*/
+		int HID_API_EXPORT HID_API_CALL hid_hotplug_process(int milliseconds);
+
 		/** @brief Open a HID device using a Vendor ID (VID), Product ID
 			(PID) and optionally a serial number.
 
@@ -220,6 +284,35 @@ extern "C" {
 		*/
 		int HID_API_EXPORT HID_API_CALL hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds);
 
+		/** @brief Read an Input report from a HID device with timeout,
+			along with the time at which the report arrived.
+
+			This behaves exactly like hid_read_timeout(), but additionally
+			returns the time at which the report was received from the
+			operating system, so that the time a report spent queued in
+			HIDAPI can be separated from the latency of the device itself.
+			The timestamp is taken from a monotonic clock (CLOCK_MONOTONIC
+			on Linux) and is expressed in nanoseconds. It is only
+			meaningful when compared with other timestamps returned by
+			this function.
+
+			@ingroup API
+			@param device A device handle returned from hid_open().
+			@param data A buffer to put the read data into.
+			@param length The number of bytes to read. For devices with
+				multiple reports, make sure to read an extra byte for
+				the report number.
+			@param milliseconds timeout in milliseconds or -1 for blocking wait.
+			@param timestamp_ns Receives the arrival time of the returned
+				report in nanoseconds, or 0 if no report was returned.
+				May be NULL.
+
+			@returns
+				This function returns the actual number of bytes read and
+				-1 on error.
+		*/
+		int HID_API_EXPORT HID_API_CALL hid_read_timeout_timestamp(hid_device *dev, unsigned char *data, size_t length, int milliseconds, unsigned long long *timestamp_ns);
+
 		/** @brief Read an Input report from a HID device.
 
 			Input reports are returned
@@ -364,6 +457,26 @@ extern "C" {
 		*/
 		int HID_API_EXPORT_CALL hid_get_indexed_string(hid_device *device, int string_index, wchar_t *string, size_t maxlen);
 
+		/** @brief Get the Report Descriptor of a HID device.
+
+			The descriptor can be passed to hid_parse_report_descriptor()
+			(see hidparser.h) to decode reports by usage rather than by
+			byte offset.
+
+			Not implemented by the Windows backend.
+
+			@ingroup API
+			@param device A device handle returned from hid_open().
+			@param buf A buffer to put the descriptor into.
+			@param buf_size The size of @p buf in bytes. A descriptor
+				can be up to 4096 bytes long.
+
+			@returns
+				This function returns the number of bytes copied into
+				@p buf and -1 on error.
+		*/
+		int HID_API_EXPORT_CALL hid_get_report_descriptor(hid_device *device, unsigned char *buf, size_t buf_size);
+
 		/** @brief Get a string describing the last error which occurred.
 
 			@ingroup API
@@ -0,0 +1,379 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Report Descriptor Parser
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+/* C */
+#include <string.h>
+
+#include "hidparser.h"
+
+/* Depth of the Push/Pop stack of global items. */
+#define GLOBAL_STACK_DEPTH 4
+
+/* Item tags (the key with the size bits masked off). See the HID
+   specification, version 1.11, sections 6.2.2.4 to 6.2.2.8. */
+#define TAG_INPUT            0x80
+#define TAG_OUTPUT           0x90
+#define TAG_FEATURE          0xb0
+#define TAG_COLLECTION       0xa0
+#define TAG_END_COLLECTION   0xc0
+#define TAG_USAGE_PAGE       0x04
+#define TAG_LOGICAL_MINIMUM  0x14
+#define TAG_LOGICAL_MAXIMUM  0x24
+#define TAG_REPORT_SIZE      0x74
+#define TAG_REPORT_ID        0x84
+#define TAG_REPORT_COUNT     0x94
+#define TAG_PUSH             0xa4
+#define TAG_POP              0xb4
+#define TAG_USAGE            0x08
+#define TAG_USAGE_MINIMUM    0x18
+#define TAG_USAGE_MAXIMUM    0x28
+
+/* Main item flag bits */
+#define FLAG_CONSTANT        0x01
+#define FLAG_VARIABLE        0x02
+
+/* Global item state, saved and restored by Push and Pop. */
+struct global_state {
+	uint16_t usage_page;
+	int32_t logical_minimum;
+	uint32_t logical_maximum_raw;
+	int logical_maximum_len;
+	uint32_t report_size;
+	uint32_t report_count;
+	uint8_t report_id;
+};
+
+/* Local item state, cleared after every main item. A usage declared
+   with 4 bytes carries its own Usage Page in the upper 16 bits. */
+struct local_state {
+	uint32_t usages[HID_PARSER_MAX_FIELDS];
+	int num_usages;
+	uint32_t usage_minimum;
+	uint32_t usage_maximum;
+	int has_usage_range;
+};
+
+/* Sign-extend an item value of len bytes. */
+static int32_t signed_value(uint32_t value, int len)
+{
+	switch (len) {
+	case 1:
+		return (int8_t) value;
+	case 2:
+		return (int16_t) value;
+	default:
+		return (int32_t) value;
+	}
+}
+
+/* Add the usage page to a usage, unless the usage was extended. */
+static uint32_t full_usage(uint32_t usage, int len, uint16_t usage_page)
+{
+	if (len == 4)
+		return usage;
+	return ((uint32_t) usage_page << 16) | usage;
+}
+
+/* Return the layout for type/report_id, creating it if needed. */
+static struct hid_report_layout *get_layout(struct hid_report_descriptor *parsed, int type, uint8_t report_id)
+{
+	struct hid_report_layout *layout;
+	int i;
+
+	for (i = 0; i < parsed->num_reports; i++) {
+		layout = &parsed->reports[i];
+		if (layout->type == type && layout->report_id == report_id)
+			return layout;
+	}
+
+	if (parsed->num_reports == HID_PARSER_MAX_REPORTS)
+		return NULL;
+
+	layout = &parsed->reports[parsed->num_reports++];
+	memset(layout, 0, sizeof(*layout));
+	layout->type = type;
+	layout->report_id = report_id;
+	return layout;
+}
+
+/* Pick the usage of the index'th element declared by a main item. */
+static uint32_t element_usage(const struct local_state *local, uint32_t index, int is_variable)
+{
+	if (!is_variable)
+		index = 0;
+
+	if (local->num_usages > 0) {
+		if (index >= (uint32_t) local->num_usages)
+			index = local->num_usages - 1;
+		return local->usages[index];
+	}
+	if (local->has_usage_range) {
+		uint32_t usage = local->usage_minimum + index;
+		return (usage > local->usage_maximum)? local->usage_maximum: usage;
+	}
+	return 0;
+}
+
+/* Handle an Input, Output or Feature item: append its fields to the
+   layout of the current report and precompile their extractors. */
+static int add_fields(struct hid_report_descriptor *parsed, int type, uint32_t flags,
+                      const struct global_state *global, const struct local_state *local)
+{
+	struct hid_report_layout *layout;
+	uint32_t total_bits = global->report_size * global->report_count;
+	uint32_t i;
+
+	layout = get_layout(parsed, type, global->report_id);
+	if (!layout)
+		return -1;
+
+	if (global->report_count > 0 &&
+	    total_bits / global->report_count != global->report_size)
+		return -1; /* overflow */
+	if (layout->size_bits + total_bits > HID_PARSER_MAX_REPORT_SIZE * 8)
+		return -1;
+
+	if (!(flags & FLAG_CONSTANT)) {
+		int32_t logical_maximum;
+
+		if (global->report_size < 1 || global->report_size > 32)
+			return -1;
+		if (layout->num_fields + global->report_count > HID_PARSER_MAX_FIELDS)
+			return -1;
+
+		/* Logical Maximum is signed like Logical Minimum, but many
+		   devices write an unsigned value whose top bit is set. If
+		   the minimum isn't negative, read the maximum as unsigned. */
+		logical_maximum = signed_value(global->logical_maximum_raw, global->logical_maximum_len);
+		if (global->logical_minimum >= 0 && logical_maximum < global->logical_minimum)
+			logical_maximum = (int32_t) global->logical_maximum_raw;
+
+		for (i = 0; i < global->report_count; i++) {
+			int n = layout->num_fields++;
+			struct hid_field *field = &layout->fields[n];
+			uint32_t usage = element_usage(local, i, flags & FLAG_VARIABLE);
+
+			field->usage_page = usage >> 16;
+			field->usage = usage & 0xffff;
+			field->bit_offset = layout->size_bits + i * global->report_size;
+			field->bit_size = global->report_size;
+			field->is_signed = global->logical_minimum < 0;
+			field->flags = flags;
+			field->logical_minimum = global->logical_minimum;
+			field->logical_maximum = logical_maximum;
+
+			layout->x_byte[n] = field->bit_offset / 8;
+			layout->x_shift[n] = field->bit_offset % 8;
+			layout->x_mask[n] = (field->bit_size == 32)? 0xffffffff: ((uint32_t) 1 << field->bit_size) - 1;
+			layout->x_sign[n] = (field->is_signed)? (uint32_t) 1 << (field->bit_size - 1): 0;
+		}
+	}
+
+	layout->size_bits += total_bits;
+	return 0;
+}
+
+int hid_parse_report_descriptor(const unsigned char *desc, size_t size, struct hid_report_descriptor *parsed)
+{
+	struct global_state global;
+	struct global_state stack[GLOBAL_STACK_DEPTH];
+	struct local_state local;
+	int stack_depth = 0;
+	int collection_depth = 0;
+	int found_top_level = 0;
+	size_t i = 0;
+
+	memset(parsed, 0, sizeof(*parsed));
+	memset(&global, 0, sizeof(global));
+	memset(&local, 0, sizeof(local));
+
+	while (i < size) {
+		int key = desc[i];
+		int tag = key & 0xfc;
+		int data_len;
+		uint32_t value = 0;
+		int j;
+
+		if (key == 0xfe) {
+			/* This is a Long Item. The next byte contains the
+			   length of the data section (value) for this key.
+			   No long item tags are defined, so just skip it.
+			   See the HID specification, version 1.11, section
+			   6.2.2.3, titled "Long Items." */
+			if (i + 1 >= size)
+				return -1;
+			i += 3 + desc[i+1];
+			continue;
+		}
+
+		/* This is a Short Item. The bottom two bits of the
+		   key contain the size code for the data section
+		   (value) for this key. Refer to the HID
+		   specification, version 1.11, section 6.2.2.2,
+		   titled "Short Items." */
+		data_len = key & 0x3;
+		if (data_len == 3)
+			data_len = 4;
+		if (i + 1 + data_len > size)
+			return -1; /* malformed report */
+		for (j = 0; j < data_len; j++)
+			value |= (uint32_t) desc[i+1+j] << (8 * j);
+
+		switch (tag) {
+		/* Main items */
+		case TAG_INPUT:
+			if (add_fields(parsed, HID_REPORT_TYPE_INPUT, value, &global, &local) < 0)
+				return -1;
+			break;
+		case TAG_OUTPUT:
+			if (add_fields(parsed, HID_REPORT_TYPE_OUTPUT, value, &global, &local) < 0)
+				return -1;
+			break;
+		case TAG_FEATURE:
+			if (add_fields(parsed, HID_REPORT_TYPE_FEATURE, value, &global, &local) < 0)
+				return -1;
+			break;
+		case TAG_COLLECTION:
+			if (collection_depth == 0 && !found_top_level) {
+				uint32_t usage = element_usage(&local, 0, 0);
+				parsed->usage_page = usage >> 16;
+				parsed->usage = usage & 0xffff;
+				found_top_level = 1;
+			}
+			collection_depth++;
+			break;
+		case TAG_END_COLLECTION:
+			if (collection_depth == 0)
+				return -1;
+			collection_depth--;
+			break;
+
+		/* Global items */
+		case TAG_USAGE_PAGE:
+			global.usage_page = value;
+			break;
+		case TAG_LOGICAL_MINIMUM:
+			global.logical_minimum = signed_value(value, data_len);
+			break;
+		case TAG_LOGICAL_MAXIMUM:
+			global.logical_maximum_raw = value;
+			global.logical_maximum_len = data_len;
+			break;
+		case TAG_REPORT_SIZE:
+			global.report_size = value;
+			break;
+		case TAG_REPORT_ID:
+			if (value == 0 || value > 0xff)
+				return -1;
+			global.report_id = value;
+			parsed->uses_report_ids = 1;
+			break;
+		case TAG_REPORT_COUNT:
+			global.report_count = value;
+			break;
+		case TAG_PUSH:
+			if (stack_depth == GLOBAL_STACK_DEPTH)
+				return -1;
+			stack[stack_depth++] = global;
+			break;
+		case TAG_POP:
+			if (stack_depth == 0)
+				return -1;
+			global = stack[--stack_depth];
+			break;
+
+		/* Local items */
+		case TAG_USAGE:
+			if (local.num_usages < HID_PARSER_MAX_FIELDS)
+				local.usages[local.num_usages++] = full_usage(value, data_len, global.usage_page);
+			break;
+		case TAG_USAGE_MINIMUM:
+			local.usage_minimum = full_usage(value, data_len, global.usage_page);
+			local.has_usage_range = 1;
+			break;
+		case TAG_USAGE_MAXIMUM:
+			local.usage_maximum = full_usage(value, data_len, global.usage_page);
+			local.has_usage_range = 1;
+			break;
+
+		default:
+			/* Physical range, units, designators, strings and
+			   delimiters don't affect the report layout. */
+			break;
+		}
+
+		/* Local items only apply to the next main item. */
+		if ((key & 0x0c) == 0x00)
+			memset(&local, 0, sizeof(local));
+
+		/* Skip over this key and it's associated data */
+		i += 1 + data_len;
+	}
+
+	return 0;
+}
+
+const struct hid_report_layout *hid_find_report_layout(const struct hid_report_descriptor *parsed, enum hid_parser_report_type type, uint8_t report_id)
+{
+	int i;
+
+	for (i = 0; i < parsed->num_reports; i++) {
+		const struct hid_report_layout *layout = &parsed->reports[i];
+		if (layout->type == type && layout->report_id == report_id)
+			return layout;
+	}
+	return NULL;
+}
+
+/* Load 8 bytes little-endian. Compilers turn this into a single load on
+   little-endian targets. */
+static uint64_t load_le64(const unsigned char *p)
+{
+	return (uint64_t) p[0]       | (uint64_t) p[1] << 8  |
+	       (uint64_t) p[2] << 16 | (uint64_t) p[3] << 24 |
+	       (uint64_t) p[4] << 32 | (uint64_t) p[5] << 40 |
+	       (uint64_t) p[6] << 48 | (uint64_t) p[7] << 56;
+}
+
+int hid_decode_report(const struct hid_report_layout *layout, const unsigned char *data, size_t length, int32_t *values)
+{
+	/* The report is copied into a buffer padded with 8 zero bytes, so
+	   that the window of the last field can be loaded without a bounds
+	   check. */
+	unsigned char buf[HID_PARSER_MAX_REPORT_SIZE + 8];
+	size_t size = (layout->size_bits + 7) / 8;
+	int i;
+
+	if (layout->report_id) {
+		if (length < 1 || data[0] != layout->report_id)
+			return -1;
+		data++;
+		length--;
+	}
+	if (length < size)
+		return -1;
+
+	memcpy(buf, data, size);
+	memset(buf + size, 0, 8);
+
+	for (i = 0; i < layout->num_fields; i++) {
+		uint32_t v = (uint32_t) (load_le64(buf + layout->x_byte[i]) >> layout->x_shift[i]) & layout->x_mask[i];
+		values[i] = (int32_t) ((v ^ layout->x_sign[i]) - layout->x_sign[i]);
+	}
+
+	return layout->num_fields;
+}
@@ -0,0 +1,174 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Report Descriptor Parser
+
+ At the discretion of the user of this library,
+ this software may be licensed under the terms of the
+ GNU Public License v3, a BSD-Style license, or the
+ original HIDAPI license as outlined in the LICENSE.txt,
+ LICENSE-gpl3.txt, LICENSE-bsd.txt, and LICENSE-orig.txt
+ files located at the root of the source distribution.
+ These files may also be found in the public source
+ code repository located at:
+        http://github.com/signal11/hidapi .
+********************************************************/
+
+/** @file
+ * @defgroup PARSER hidapi report descriptor parser
+ *
+ * The parser compiles a HID report descriptor into one table of fields
+ * per report (usage, bit offset, bit size, signedness and logical range),
+ * so that reports can be decoded without hand-written byte offsets.
+ */
+
+#ifndef HIDPARSER_H__
+#define HIDPARSER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Maximum number of reports, of all types, kept per descriptor. */
+#ifndef HID_PARSER_MAX_REPORTS
+#define HID_PARSER_MAX_REPORTS 16
+#endif
+
+/** Maximum number of data fields kept per report. */
+#ifndef HID_PARSER_MAX_FIELDS
+#define HID_PARSER_MAX_FIELDS 64
+#endif
+
+/** Maximum size of a report in bytes, excluding the Report ID. */
+#ifndef HID_PARSER_MAX_REPORT_SIZE
+#define HID_PARSER_MAX_REPORT_SIZE 512
+#endif
+
+		/** Report types, as used by the Input, Output and Feature main items. */
+		enum hid_parser_report_type {
+			HID_REPORT_TYPE_INPUT = 0,
+			HID_REPORT_TYPE_OUTPUT = 1,
+			HID_REPORT_TYPE_FEATURE = 2
+		};
+
+		/** One data field of a report. */
+		struct hid_field {
+			/** Usage Page of the field */
+			uint16_t usage_page;
+			/** Usage of the field. For array fields, the first
+			    usage of the range the field selects from. */
+			uint16_t usage;
+			/** Offset of the field in bits, counted from the first
+			    byte after the Report ID. */
+			uint16_t bit_offset;
+			/** Size of the field in bits (1 to 32). */
+			uint8_t bit_size;
+			/** Non-zero if the Logical Minimum is negative, in which
+			    case the field is sign-extended when decoded. */
+			uint8_t is_signed;
+			/** Flags of the main item which declared the field
+			    (bit 1 set: Variable, bit 2 set: Relative). */
+			uint16_t flags;
+			/** Logical Minimum */
+			int32_t logical_minimum;
+			/** Logical Maximum */
+			int32_t logical_maximum;
+		};
+
+		/** The compiled layout of one report. */
+		struct hid_report_layout {
+			/** Report ID, or 0 if the device doesn't use numbered reports. */
+			uint8_t report_id;
+			/** One of #hid_parser_report_type. */
+			uint8_t type;
+			/** Size of the report data in bits, excluding the Report ID. */
+			uint16_t size_bits;
+			/** Number of entries used in @p fields. */
+			int num_fields;
+			/** The data fields, in report order. Constant (padding)
+			    fields are not included. */
+			struct hid_field fields[HID_PARSER_MAX_FIELDS];
+
+			/* Precompiled extractor, one entry per field: the byte at
+			   which an 8-byte little-endian window is loaded, the
+			   shift which moves the field to bit 0 of the window, the
+			   mask of the field width, and the sign bit of signed
+			   fields (0 for unsigned ones). */
+			uint16_t x_byte[HID_PARSER_MAX_FIELDS];
+			uint8_t x_shift[HID_PARSER_MAX_FIELDS];
+			uint32_t x_mask[HID_PARSER_MAX_FIELDS];
+			uint32_t x_sign[HID_PARSER_MAX_FIELDS];
+		};
+
+		/** A parsed report descriptor. */
+		struct hid_report_descriptor {
+			/** Non-zero if reports carry a Report ID in their first byte. */
+			int uses_report_ids;
+			/** Usage Page of the first top-level collection. */
+			uint16_t usage_page;
+			/** Usage of the first top-level collection. */
+			uint16_t usage;
+			/** Number of entries used in @p reports. */
+			int num_reports;
+			/** The compiled reports. */
+			struct hid_report_layout reports[HID_PARSER_MAX_REPORTS];
+		};
+
+		/** @brief Parse a report descriptor.
+
+			@ingroup PARSER
+			@param desc The raw report descriptor, for example as
+				returned by hid_get_report_descriptor().
+			@param size The size of @p desc in bytes.
+			@param parsed Receives the compiled reports.
+
+			@returns
+				This function returns 0 on success and -1 if the
+				descriptor is malformed or exceeds the
+				HID_PARSER_MAX_REPORTS, HID_PARSER_MAX_FIELDS or
+				HID_PARSER_MAX_REPORT_SIZE limits.
+		*/
+		int hid_parse_report_descriptor(const unsigned char *desc, size_t size, struct hid_report_descriptor *parsed);
+
+		/** @brief Find the layout of a report.
+
+			@ingroup PARSER
+			@param parsed A descriptor parsed by hid_parse_report_descriptor().
+			@param type One of #hid_parser_report_type.
+			@param report_id The Report ID, or 0 for unnumbered reports.
+
+			@returns
+				This function returns the layout, or NULL if the
+				descriptor has no such report.
+		*/
+		const struct hid_report_layout *hid_find_report_layout(const struct hid_report_descriptor *parsed, enum hid_parser_report_type type, uint8_t report_id);
+
+		/** @brief Decode every field of a report.
+
+			Every field is extracted with the same load, shift, mask
+			and sign-extend sequence, so the cost doesn't depend on
+			how the fields are packed.
+
+			@ingroup PARSER
+			@param layout The layout of the report.
+			@param data The report as returned by hid_read(), starting
+				with the Report ID if @p layout has one.
+			@param length The number of bytes in @p data.
+			@param values Receives layout->num_fields values, in field
+				order. Unsigned 32-bit fields are returned modulo 2^32.
+
+			@returns
+				This function returns the number of values decoded and
+				-1 if @p data is too short or has the wrong Report ID.
+		*/
+		int hid_decode_report(const struct hid_report_layout *layout, const unsigned char *data, size_t length, int32_t *values);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,174 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Benchmark helpers shared by hidtest and uhidtest
+
+ This contents of this file may be used by anyone
+ for any reason without any conditions and may be
+ used as a starting point for your own applications
+ which use HIDAPI.
+********************************************************/
+
+/* C */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hidbench.h"
+
+const unsigned char hidbench_report_map[] = {
+	0x05, 0x01, // Usage Page (Generic Desktop)
+	0x09, 0x02, // Usage (Mouse)
+	0xA1, 0x01, // Collection (Application)
+		// Report ID 1: Mouse buttons + scroll/pan
+		0x85, 0x01,       // Report Id 1
+		0x09, 0x01,       // Usage (Pointer)
+		0xA1, 0x00,       // Collection (Physical)
+			0x95, 0x05,       // Report Count (3)
+			0x75, 0x01,       // Report Size (1)
+			0x05, 0x09,       // Usage Page (Buttons)
+			0x19, 0x01,       // Usage Minimum (01)
+			0x29, 0x05,       // Usage Maximum (05)
+			0x15, 0x00,       // Logical Minimum (0)
+			0x25, 0x01,       // Logical Maximum (1)
+			0x81, 0x02,       // Input (Data, Variable, Absolute)
+			0x95, 0x01,       // Report Count (1)
+			0x75, 0x03,       // Report Size (3)
+			0x81, 0x01,       // Input (Constant) for padding
+			0x75, 0x08,       // Report Size (8)
+			0x95, 0x01,       // Report Count (1)
+			0x05, 0x01,       // Usage Page (Generic Desktop)
+			0x09, 0x38,       // Usage (Wheel)
+			0x15, 0x81,       // Logical Minimum (-127)
+			0x25, 0x7F,       // Logical Maximum (127)
+			0x81, 0x06,       // Input (Data, Variable, Relative)
+			0x05, 0x0C,       // Usage Page (Consumer)
+			0x0A, 0x38, 0x02, // Usage (AC Pan)
+			0x95, 0x01,       // Report Count (1)
+			0x81, 0x06,       // Input (Data,Value,Relative,Bit Field)
+		0xC0,             // End Collection (Physical)
+		// Report ID 2: Mouse motion
+		0x85, 0x02,       // Report Id 2
+		0x09, 0x01,       // Usage (Pointer)
+		0xA1, 0x00,       // Collection (Physical)
+			0x75, 0x0C,       // Report Size (12)
+			0x95, 0x02,       // Report Count (2)
+			0x05, 0x01,       // Usage Page (Generic Desktop)
+			0x09, 0x30,       // Usage (X)
+			0x09, 0x31,       // Usage (Y)
+			0x16, 0x01, 0xF8, // Logical maximum (2047)
+			0x26, 0xFF, 0x07, // Logical minimum (-2047)
+			0x81, 0x06,       // Input (Data, Variable, Relative)
+		0xC0,             // End Collection (Physical)
+	0xC0,             // End Collection (Application)
+	// Report ID 3: Advanced buttons
+	0x05, 0x0C,       // Usage Page (Consumer)
+	0x09, 0x01,       // Usage (Consumer Control)
+	0xA1, 0x01,       // Collection (Application)
+		0x85, 0x03,       // Report Id (3)
+		0x15, 0x00,       // Logical minimum (0)
+		0x25, 0x01,       // Logical maximum (1)
+		0x75, 0x01,       // Report Size (1)
+		0x95, 0x01,       // Report Count (1)
+		0x09, 0xCD,       // Usage (Play/Pause)
+		0x81, 0x06,       // Input (Data,Value,Relative,Bit Field)
+		0x0A, 0x83, 0x01, // Usage (AL Consumer Control Configuration)
+		0x81, 0x06,       // Input (Data,Value,Relative,Bit Field)
+		0x09, 0xB5,       // Usage (Scan Next Track)
+		0x81, 0x06,       // Input (Data,Value,Relative,Bit Field)
+		0x09, 0xB6,       // Usage (Scan Previous Track)
+		0x81, 0x06,       // Input (Data,Value,Relative,Bit Field)
+		0x09, 0xEA,       // Usage (Volume Down)
+		0x81, 0x06,       // Input (Data,Value,Relative,Bit Field)
+		0x09, 0xE9,       // Usage (Volume Up)
+		0x81, 0x06,       // Input (Data,Value,Relative,Bit Field)
+		0x0A, 0x25, 0x02, // Usage (AC Forward)
+		0x81, 0x06,       // Input (Data,Value,Relative,Bit Field)
+		0x0A, 0x24, 0x02, // Usage (AC Back)
+		0x81, 0x06,       // Input (Data,Value,Relative,Bit Field)
+	0xC0,              // End Collection
+	// Report ID 4: Digitizer (Touchpad)
+	0x05, 0x0D,       // Usage Page (Digitizer)
+	0x09, 0x05,       // Usage (Touchpad)
+	0xA1, 0x01,       // Collection (Application)
+		0x09, 0x22,       // Usage (Pointer)
+		0xA1, 0x00,       // Collection (Physical)
+			0x85, 0x04,       // Report Id (4)
+			0x75, 0x10,       // Report Size (16)
+			0x95, 0x04,       // Report Count (4)
+			0x05, 0x01,       // Usage Page (Generic Desktop)
+			0x09, 0x3B,       // Usage (Byte Count / Frame ID)
+			0x09, 0x30,       // Usage (X)
+			0x09, 0x31,       // Usage (Y)
+			0x09, 0x32,       // Usage (Z)
+			0x16, 0x00, 0x00, // Logical minimum (0)
+			0x26, 0xA0, 0xF0, // Logical maximum (4000)
+			0x81, 0x06,       // Input (Data, Variable, Relative)
+		0xC0,             // End Collection (Physical)
+	0xC0              // End Collection
+};
+
+const size_t hidbench_report_map_size = sizeof(hidbench_report_map);
+
+int hidbench_load_capture(const char *file, struct hidbench_report **reports, size_t *num_reports)
+{
+	FILE *fp = fopen(file, "r");
+	char line[2 * HIDBENCH_MAX_REPORT_LEN + 64];
+	size_t cap = 0;
+
+	if (!fp) {
+		printf("unable to open %s\n", file);
+		return -1;
+	}
+
+	*reports = NULL;
+	*num_reports = 0;
+	while (fgets(line, sizeof(line), fp)) {
+		struct hidbench_report *rpt;
+		unsigned long long arrival;
+		char hex[2 * HIDBENCH_MAX_REPORT_LEN + 1];
+		size_t i;
+
+		if (line[0] == '#' || sscanf(line, "%llu %128s", &arrival, hex) != 2)
+			continue;
+
+		if (*num_reports == cap) {
+			cap = cap? cap * 2: 1024;
+			*reports = (struct hidbench_report *) realloc(*reports, cap * sizeof(**reports));
+		}
+		rpt = &(*reports)[(*num_reports)++];
+		memset(rpt, 0, sizeof(*rpt));
+		rpt->arrival_ns = arrival;
+		rpt->len = strlen(hex) / 2;
+		for (i = 0; i < rpt->len; i++) {
+			unsigned int byte;
+			sscanf(hex + 2 * i, "%2x", &byte);
+			rpt->data[i] = byte;
+		}
+	}
+
+	fclose(fp);
+	return 0;
+}
+
+static int compare_ull(const void *a, const void *b)
+{
+	unsigned long long x = *(const unsigned long long *) a;
+	unsigned long long y = *(const unsigned long long *) b;
+	return (x > y) - (x < y);
+}
+
+void hidbench_sort(unsigned long long *values, size_t n)
+{
+	qsort(values, n, sizeof(*values), compare_ull);
+}
+
+double hidbench_percentile(const unsigned long long *sorted, size_t n, double p)
+{
+	size_t i;
+	if (n == 0)
+		return 0;
+	i = (size_t) (p / 100.0 * (n - 1) + 0.5);
+	return (double) sorted[i];
+}
@@ -0,0 +1,54 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Benchmark helpers shared by hidtest and uhidtest
+
+ This contents of this file may be used by anyone
+ for any reason without any conditions and may be
+ used as a starting point for your own applications
+ which use HIDAPI.
+********************************************************/
+
+#ifndef HIDBENCH_H__
+#define HIDBENCH_H__
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Report ID of the T-Board digitizer report. */
+#define HIDBENCH_DIGITIZER_REPORT_ID 4
+
+/* Largest report kept in a capture, including the Report ID. */
+#define HIDBENCH_MAX_REPORT_LEN 64
+
+/* A report of a capture or synthetic stream. */
+struct hidbench_report {
+	unsigned long long arrival_ns;
+	size_t len;
+	unsigned char data[HIDBENCH_MAX_REPORT_LEN];
+};
+
+/* The report map set up by hids_init() in ble_app_hids_mouse. */
+extern const unsigned char hidbench_report_map[];
+extern const size_t hidbench_report_map_size;
+
+/* Read a capture written by "hidtest bench -w". Each line holds the
+   arrival time in nanoseconds and the report bytes in hex. On success
+   *reports is allocated with malloc() and 0 is returned. */
+int hidbench_load_capture(const char *file, struct hidbench_report **reports, size_t *num_reports);
+
+/* Sort n values in ascending order. */
+void hidbench_sort(unsigned long long *values, size_t n);
+
+/* The p'th percentile of n sorted values. */
+double hidbench_percentile(const unsigned long long *sorted, size_t n, double p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -19,15 +19,25 @@
 #include <string.h>
 #include <stdlib.h>
 #include "hidapi.h"
+#include "hidparser.h"
+#include "hidbench.h"
 
-// Headers needed for sleeping.
+// Headers needed for sleeping and timing.
 #ifdef _WIN32
 	#include <windows.h>
 #else
 	#include <unistd.h>
+	#include <time.h>
+	#include <sys/time.h>
+	#include <sys/resource.h>
+#endif
+#ifdef __linux__
+	#include <fcntl.h>
+	#include <dirent.h>
+	#include <linux/uhid.h>
 #endif
 
-int main(int argc, char* argv[])
+static int run_demo(void)
 {
 	int res;
 	unsigned char buf[256];
@@ -36,11 +46,6 @@ int main(int argc, char* argv[])
 	hid_device *handle;
 	int i;
 
-#ifdef WIN32
-	UNREFERENCED_PARAMETER(argc);
-	UNREFERENCED_PARAMETER(argv);
-#endif
-
 	struct hid_device_info *devs, *cur_dev;
 	
 	devs = hid_enumerate(0x0, 0x0);
@@ -189,3 +194,651 @@ int main(int argc, char* argv[])
 
 	return 0;
 }
+
+/* Benchmark mode.
+
+   "hidtest bench" streams input reports for a number of seconds and
+   reports throughput, inter-arrival jitter, frames lost according to the
+   frame timestamp which the T-Board firmware puts in every digitizer
+   report, and the CPU time spent per report. The reports can come from
+   the device, from a capture recorded with -w, or from a synthetic
+   stream, so that the tool also runs without hardware.
+
+   It also reports when the first touch arrived, relative to the first
+   report. The firmware sends reports without a touch (Z = 0xFFFF) while
+   its sensor calibration is being learned, so for a capture started at
+   power-on this is the time to the first valid touch. */
+
+// The T-Board digitizer.
+#define BENCH_VID 0x1915
+#define BENCH_PID 0xeeee
+
+// The firmware stamps each frame with app_timer_cnt_get() / 32, which
+// counts 1/1024 s ticks, truncated to 16 bits.
+#define FRAME_TICKS_PER_SEC 1024
+
+// Longer frame intervals are the firmware's idle mode, not lost frames.
+#define FRAME_IDLE_TICKS 900
+
+// Z value of a digitizer report without a touch.
+#define NO_TOUCH_Z 0xFFFF
+
+// Where benchmark reports come from: the device if handle is set,
+// otherwise the reports array.
+struct report_source {
+	hid_device *handle;
+	struct hidbench_report *reports;
+	size_t num_reports;
+	size_t pos;
+	int paced;
+	unsigned long long start_ns;
+};
+
+struct bench_options {
+	unsigned short vendor_id;
+	unsigned short product_id;
+	const char *path;
+	double seconds;
+	const char *replay_file;
+	const char *record_file;
+	int synthetic;
+	int drop_every;
+	int paced;
+	double scan_rate;
+	int json;
+};
+
+static void usage(void)
+{
+	printf("usage: hidtest                 run the interactive test\n"
+	       "       hidtest bench [options] stream reports and measure them\n"
+	       "         -t SECONDS  run time (default 10)\n"
+	       "         -v VID -p PID  device to open, in hex (default 1915 eeee)\n"
+	       "         -P PATH     open the device by path instead\n"
+	       "         -r FILE     replay a capture instead of using the device\n"
+	       "         -S          replay a synthetic stream instead\n"
+	       "         -D N        drop every Nth synthetic frame\n"
+	       "         -x          replay as fast as possible\n"
+	       "         -w FILE     record the reports into a capture\n"
+	       "         -f HZ       frame rate of the firmware (default 50)\n"
+	       "         -j          print the results as JSON\n"
+	       "       hidtest enum [options]  time cold and warm hid_enumerate()\n"
+	       "         -n COUNT    warm calls and lookups (default 100)\n"
+	       "         -c COUNT    cold calls (default 5)\n"
+	       "         -v VID -p PID  devices to list (default all)\n"
+	       "         -u NODES    add virtual hidraw nodes first (Linux, needs /dev/uhid)\n"
+	       "         -j          print the results as JSON\n");
+}
+
+static unsigned long long now_ns(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (unsigned long long) (count.QuadPart / freq.QuadPart) * 1000000000ULL +
+		(unsigned long long) (count.QuadPart % freq.QuadPart) * 1000000000ULL / freq.QuadPart;
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+// User plus system CPU time used by the process, in seconds.
+static double cpu_seconds(void)
+{
+#ifdef _WIN32
+	FILETIME creation, exit, kernel, user;
+	ULARGE_INTEGER k, u;
+	GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user);
+	k.LowPart = kernel.dwLowDateTime;
+	k.HighPart = kernel.dwHighDateTime;
+	u.LowPart = user.dwLowDateTime;
+	u.HighPart = user.dwHighDateTime;
+	return (k.QuadPart + u.QuadPart) / 1e7;
+#else
+	struct rusage ru;
+	getrusage(RUSAGE_SELF, &ru);
+	return ru.ru_utime.tv_sec + ru.ru_utime.tv_usec / 1e6 +
+	       ru.ru_stime.tv_sec + ru.ru_stime.tv_usec / 1e6;
+#endif
+}
+
+static void sleep_ns(unsigned long long ns)
+{
+#ifdef _WIN32
+	Sleep((DWORD) (ns / 1000000));
+#else
+	usleep(ns / 1000);
+#endif
+}
+
+// Make a stream of digitizer frames at the firmware's frame rate, with
+// one touch moving across the pad, dropping every drop_every'th frame.
+static void make_synthetic(const struct bench_options *opt, struct hidbench_report **reports, size_t *num_reports)
+{
+	size_t frames = (size_t) (opt->seconds * opt->scan_rate);
+	size_t i;
+
+	*reports = (struct hidbench_report *) calloc(frames? frames: 1, sizeof(**reports));
+	*num_reports = 0;
+	for (i = 0; i < frames; i++) {
+		struct hidbench_report *rpt;
+		unsigned short ts = (unsigned short) (i * FRAME_TICKS_PER_SEC / opt->scan_rate);
+		unsigned short x = (unsigned short) (i * 331);
+		unsigned short y = (unsigned short) (i * 197);
+		unsigned short z = 100 + i % 400;
+
+		if (opt->drop_every > 0 && i % opt->drop_every == (size_t) opt->drop_every - 1)
+			continue;
+
+		rpt = &(*reports)[(*num_reports)++];
+		rpt->arrival_ns = (unsigned long long) (i * 1e9 / opt->scan_rate);
+		rpt->len = 9;
+		rpt->data[0] = HIDBENCH_DIGITIZER_REPORT_ID;
+		rpt->data[1] = ts & 0xff;
+		rpt->data[2] = ts >> 8;
+		rpt->data[3] = x & 0xff;
+		rpt->data[4] = x >> 8;
+		rpt->data[5] = y & 0xff;
+		rpt->data[6] = y >> 8;
+		rpt->data[7] = z & 0xff;
+		rpt->data[8] = z >> 8;
+	}
+}
+
+// Like hid_read_timeout_timestamp(), for any source. Returns -1 at the
+// end of a replay.
+static int source_read(struct report_source *src, unsigned char *data, size_t length, int milliseconds, unsigned long long *timestamp_ns)
+{
+	struct hidbench_report *rpt;
+	size_t len;
+
+	if (src->handle)
+		return hid_read_timeout_timestamp(src->handle, data, length, milliseconds, timestamp_ns);
+
+	if (src->pos == src->num_reports)
+		return -1;
+	rpt = &src->reports[src->pos];
+
+	if (src->paced) {
+		// Deliver the report when it is due relative to the first one.
+		unsigned long long due = src->start_ns + (rpt->arrival_ns - src->reports[0].arrival_ns);
+		unsigned long long now = now_ns();
+		if (due > now) {
+			unsigned long long wait = due - now;
+			if (milliseconds >= 0 && wait > (unsigned long long) milliseconds * 1000000) {
+				sleep_ns((unsigned long long) milliseconds * 1000000);
+				return 0;
+			}
+			sleep_ns(wait);
+		}
+	}
+
+	len = (length < rpt->len)? length: rpt->len;
+	memcpy(data, rpt->data, len);
+	*timestamp_ns = rpt->arrival_ns;
+	src->pos++;
+	return len;
+}
+
+static int parse_bench_options(int argc, char *argv[], struct bench_options *opt)
+{
+	int i;
+
+	opt->vendor_id = BENCH_VID;
+	opt->product_id = BENCH_PID;
+	opt->path = NULL;
+	opt->seconds = 10;
+	opt->replay_file = NULL;
+	opt->record_file = NULL;
+	opt->synthetic = 0;
+	opt->drop_every = 0;
+	opt->paced = 1;
+	opt->scan_rate = 50;
+	opt->json = 0;
+
+	for (i = 1; i < argc; i++) {
+		const char *arg = argv[i];
+		const char *val = (i + 1 < argc)? argv[i + 1]: NULL;
+
+		if (strcmp(arg, "-S") == 0)
+			opt->synthetic = 1;
+		else if (strcmp(arg, "-x") == 0)
+			opt->paced = 0;
+		else if (strcmp(arg, "-j") == 0)
+			opt->json = 1;
+		else if (!val) {
+			usage();
+			return -1;
+		}
+		else {
+			if (strcmp(arg, "-t") == 0)
+				opt->seconds = atof(val);
+			else if (strcmp(arg, "-v") == 0)
+				opt->vendor_id = (unsigned short) strtoul(val, NULL, 16);
+			else if (strcmp(arg, "-p") == 0)
+				opt->product_id = (unsigned short) strtoul(val, NULL, 16);
+			else if (strcmp(arg, "-P") == 0)
+				opt->path = val;
+			else if (strcmp(arg, "-r") == 0)
+				opt->replay_file = val;
+			else if (strcmp(arg, "-w") == 0)
+				opt->record_file = val;
+			else if (strcmp(arg, "-D") == 0)
+				opt->drop_every = atoi(val);
+			else if (strcmp(arg, "-f") == 0)
+				opt->scan_rate = atof(val);
+			else {
+				usage();
+				return -1;
+			}
+			i++;
+		}
+	}
+
+	if (opt->seconds <= 0 || opt->scan_rate <= 0) {
+		usage();
+		return -1;
+	}
+	return 0;
+}
+
+static int run_bench(int argc, char *argv[])
+{
+	struct bench_options opt;
+	struct report_source src;
+	struct hid_report_descriptor parsed;
+	const struct hid_report_layout *layout = NULL;
+	unsigned char desc[4096];
+	unsigned char buf[256];
+	int32_t values[HID_PARSER_MAX_FIELDS];
+	int desc_len = -1;
+	int ts_field = -1;
+	int z_field = -1;
+	FILE *record = NULL;
+	unsigned long long *deltas = NULL;
+	size_t num_deltas = 0, cap_deltas = 0;
+	unsigned long long reports = 0, bytes = 0;
+	unsigned long long first_arrival = 0, last_arrival = 0;
+	unsigned long long first_touch = 0;
+	int have_touch = 0;
+	unsigned long long frames = 0, lost_frames = 0, gaps = 0, idle = 0;
+	unsigned long long end_ns;
+	double cpu_start, cpu_used, elapsed;
+	double frame_ticks;
+	int have_frame_ts = 0;
+	unsigned short last_frame_ts = 0;
+	int i;
+
+	if (parse_bench_options(argc, argv, &opt) < 0)
+		return 1;
+
+	memset(&src, 0, sizeof(src));
+	src.paced = opt.paced;
+	if (opt.replay_file) {
+		if (hidbench_load_capture(opt.replay_file, &src.reports, &src.num_reports) < 0)
+			return 1;
+	}
+	else if (opt.synthetic) {
+		make_synthetic(&opt, &src.reports, &src.num_reports);
+	}
+	else {
+		src.handle = (opt.path)? hid_open_path(opt.path): hid_open(opt.vendor_id, opt.product_id, NULL);
+		if (!src.handle) {
+			printf("unable to open device\n");
+			return 1;
+		}
+		desc_len = hid_get_report_descriptor(src.handle, desc, sizeof(desc));
+	}
+
+	// Find the frame timestamp and Z fields of the digitizer report.
+	if (desc_len < 0 || hid_parse_report_descriptor(desc, desc_len, &parsed) < 0 ||
+	    !hid_find_report_layout(&parsed, HID_REPORT_TYPE_INPUT, HIDBENCH_DIGITIZER_REPORT_ID))
+		hid_parse_report_descriptor(hidbench_report_map, hidbench_report_map_size, &parsed);
+	layout = hid_find_report_layout(&parsed, HID_REPORT_TYPE_INPUT, HIDBENCH_DIGITIZER_REPORT_ID);
+	for (i = 0; layout && i < layout->num_fields; i++) {
+		if (layout->fields[i].usage_page == 0x01 && layout->fields[i].usage == 0x3b)
+			ts_field = i;
+		else if (layout->fields[i].usage_page == 0x01 && layout->fields[i].usage == 0x32)
+			z_field = i;
+	}
+
+	if (opt.record_file) {
+		record = fopen(opt.record_file, "w");
+		if (!record) {
+			printf("unable to open %s\n", opt.record_file);
+			return 1;
+		}
+		fprintf(record, "# hidtest capture: arrival_ns report\n");
+	}
+
+	frame_ticks = FRAME_TICKS_PER_SEC / opt.scan_rate;
+	cpu_start = cpu_seconds();
+	src.start_ns = now_ns();
+	end_ns = src.start_ns + (unsigned long long) (opt.seconds * 1e9);
+
+	while (now_ns() < end_ns) {
+		unsigned long long arrival;
+		int res;
+
+		res = source_read(&src, buf, sizeof(buf), 100, &arrival);
+		if (res < 0)
+			break;
+		if (res == 0)
+			continue;
+
+		// Replays as fast as possible end when the replay does.
+		if (!src.handle && !src.paced && reports > 0 &&
+		    arrival - first_arrival > (unsigned long long) (opt.seconds * 1e9))
+			break;
+
+		reports++;
+		bytes += res;
+		if (reports == 1) {
+			first_arrival = arrival;
+		}
+		else {
+			if (num_deltas == cap_deltas) {
+				cap_deltas = cap_deltas? cap_deltas * 2: 4096;
+				deltas = (unsigned long long *) realloc(deltas, cap_deltas * sizeof(*deltas));
+			}
+			deltas[num_deltas++] = arrival - last_arrival;
+		}
+		last_arrival = arrival;
+
+		if (record) {
+			fprintf(record, "%llu ", arrival);
+			for (i = 0; i < res; i++)
+				fprintf(record, "%02x", buf[i]);
+			fprintf(record, "\n");
+		}
+
+		if (!have_touch && z_field >= 0 && hid_decode_report(layout, buf, res, values) > z_field &&
+		    (values[z_field] & 0xFFFF) != NO_TOUCH_Z) {
+			first_touch = arrival - first_arrival;
+			have_touch = 1;
+		}
+
+		// Several reports (one per touch) share a frame timestamp.
+		if (ts_field >= 0 && hid_decode_report(layout, buf, res, values) > ts_field) {
+			unsigned short ts = (unsigned short) values[ts_field];
+			unsigned short diff = ts - last_frame_ts;
+
+			if (!have_frame_ts) {
+				frames++;
+				have_frame_ts = 1;
+			}
+			else if (diff != 0) {
+				int missing = (int) (diff / frame_ticks + 0.5) - 1;
+
+				frames++;
+				if (diff > FRAME_IDLE_TICKS) {
+					idle++;
+				}
+				else if (missing > 0) {
+					gaps++;
+					lost_frames += missing;
+				}
+			}
+			last_frame_ts = ts;
+		}
+	}
+
+	cpu_used = cpu_seconds() - cpu_start;
+	elapsed = (last_arrival - first_arrival) / 1e9;
+
+	if (record)
+		fclose(record);
+	if (src.handle)
+		hid_close(src.handle);
+	free(src.reports);
+	hid_exit();
+
+	hidbench_sort(deltas, num_deltas);
+
+	if (opt.json) {
+		printf("{\n");
+		printf("  \"source\": \"%s\",\n", (src.handle)? "device": (opt.replay_file)? "replay": "synthetic");
+		printf("  \"reports\": %llu,\n", reports);
+		printf("  \"bytes\": %llu,\n", bytes);
+		printf("  \"seconds\": %.6f,\n", elapsed);
+		printf("  \"reports_per_sec\": %.3f,\n", (elapsed > 0)? reports / elapsed: 0.0);
+		printf("  \"inter_arrival_us\": { \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"p999\": %.3f, \"max\": %.3f },\n",
+		       hidbench_percentile(deltas, num_deltas, 50) / 1e3,
+		       hidbench_percentile(deltas, num_deltas, 90) / 1e3,
+		       hidbench_percentile(deltas, num_deltas, 99) / 1e3,
+		       hidbench_percentile(deltas, num_deltas, 99.9) / 1e3,
+		       hidbench_percentile(deltas, num_deltas, 100) / 1e3);
+		printf("  \"frames\": %llu,\n", frames);
+		printf("  \"gaps\": %llu,\n", gaps);
+		printf("  \"lost_frames\": %llu,\n", lost_frames);
+		printf("  \"idle_periods\": %llu,\n", idle);
+		if (have_touch)
+			printf("  \"first_touch_ms\": %.3f,\n", first_touch / 1e6);
+		else
+			printf("  \"first_touch_ms\": null,\n");
+		printf("  \"cpu_us_per_report\": %.3f\n", (reports)? cpu_used * 1e6 / reports: 0.0);
+		printf("}\n");
+	}
+	else {
+		printf("Reports:        %llu (%llu bytes) in %.3f s\n", reports, bytes, elapsed);
+		printf("Reports/s:      %.1f\n", (elapsed > 0)? reports / elapsed: 0.0);
+		printf("Inter-arrival:  p50 %.1f us, p90 %.1f us, p99 %.1f us, p99.9 %.1f us, max %.1f us\n",
+		       hidbench_percentile(deltas, num_deltas, 50) / 1e3,
+		       hidbench_percentile(deltas, num_deltas, 90) / 1e3,
+		       hidbench_percentile(deltas, num_deltas, 99) / 1e3,
+		       hidbench_percentile(deltas, num_deltas, 99.9) / 1e3,
+		       hidbench_percentile(deltas, num_deltas, 100) / 1e3);
+		if (ts_field >= 0)
+			printf("Frames:         %llu, %llu lost in %llu gaps, %llu idle periods\n", frames, lost_frames, gaps, idle);
+		else
+			printf("Frames:         no frame timestamp in the report descriptor\n");
+		if (have_touch)
+			printf("First touch:    %.1f ms after the first report\n", first_touch / 1e6);
+		else if (z_field >= 0)
+			printf("First touch:    none\n");
+		printf("CPU per report: %.2f us\n", (reports)? cpu_used * 1e6 / reports: 0.0);
+	}
+
+	free(deltas);
+	return 0;
+}
+
+#ifdef __linux__
+// Count the hidraw nodes in sysfs.
+static int count_hidraw_nodes(void)
+{
+	DIR *dir = opendir("/sys/class/hidraw");
+	struct dirent *ent;
+	int nodes = 0;
+
+	while (dir && (ent = readdir(dir)) != NULL) {
+		if (ent->d_name[0] != '.')
+			nodes++;
+	}
+	if (dir)
+		closedir(dir);
+	return nodes;
+}
+
+// Create virtual digitizers through /dev/uhid, one per file descriptor,
+// and wait until their hidraw nodes show up. Returns the number created.
+// Closing a descriptor destroys its device.
+static int create_virtual_nodes(int *fds, int count)
+{
+	int before = count_hidraw_nodes();
+	int created, tries;
+
+	for (created = 0; created < count; created++) {
+		struct uhid_event ev;
+
+		fds[created] = open("/dev/uhid", O_RDWR | O_CLOEXEC);
+		if (fds[created] < 0) {
+			perror("/dev/uhid");
+			break;
+		}
+
+		memset(&ev, 0, sizeof(ev));
+		ev.type = UHID_CREATE2;
+		snprintf((char *) ev.u.create2.name, sizeof(ev.u.create2.name), "hidtest virtual digitizer");
+		snprintf((char *) ev.u.create2.uniq, sizeof(ev.u.create2.uniq), "hidtest-%d-%d", (int) getpid(), created);
+		memcpy(ev.u.create2.rd_data, hidbench_report_map, hidbench_report_map_size);
+		ev.u.create2.rd_size = hidbench_report_map_size;
+		ev.u.create2.bus = BUS_USB;
+		ev.u.create2.vendor = BENCH_VID;
+		ev.u.create2.product = BENCH_PID;
+		if (write(fds[created], &ev, sizeof(ev)) != (ssize_t) sizeof(ev)) {
+			perror("write /dev/uhid");
+			close(fds[created]);
+			break;
+		}
+	}
+
+	for (tries = 0; tries < 500 && count_hidraw_nodes() < before + created; tries++)
+		usleep(10 * 1000);
+
+	return created;
+}
+#endif
+
+// Time hid_enumerate() right after hid_init(), when it has to scan every
+// hidraw node in the system (or, without a device registry, every call),
+// against later calls, and time hid_open() for a serial number that
+// isn't there, which is only a lookup.
+//
+// With -u, virtual hidraw nodes are added first, so that the scan has
+// many nodes to walk. They have no USB parent, so they are scanned but
+// not listed.
+static int run_enum_bench(int argc, char *argv[])
+{
+	unsigned short vendor_id = 0, product_id = 0;
+	int count = 100;
+	int cold_count = 5;
+	int virtual_count = 0;
+	int created = 0;
+	int *virtual_fds = NULL;
+	int json = 0;
+	unsigned long long start, t;
+	unsigned long long cold_total = 0, cold_min = 0;
+	unsigned long long warm_total = 0, warm_min = 0;
+	unsigned long long lookup_total = 0;
+	size_t devices = 0;
+	struct hid_device_info *devs, *cur_dev;
+	hid_device *handle;
+	int i;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-j") == 0)
+			json = 1;
+		else if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+			count = atoi(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "-c") == 0)
+			cold_count = atoi(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "-u") == 0)
+			virtual_count = atoi(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "-v") == 0)
+			vendor_id = (unsigned short) strtoul(argv[++i], NULL, 16);
+		else if (i + 1 < argc && strcmp(argv[i], "-p") == 0)
+			product_id = (unsigned short) strtoul(argv[++i], NULL, 16);
+		else {
+			usage();
+			return 1;
+		}
+	}
+	if (count < 1 || cold_count < 1 || virtual_count < 0) {
+		usage();
+		return 1;
+	}
+
+	if (virtual_count > 0) {
+#ifdef __linux__
+		virtual_fds = (int *) malloc(virtual_count * sizeof(int));
+		if (!virtual_fds)
+			return 1;
+		created = create_virtual_nodes(virtual_fds, virtual_count);
+		if (created < virtual_count)
+			printf("Only %d of %d virtual nodes created\n", created, virtual_count);
+#else
+		printf("Virtual nodes are only available on Linux\n");
+#endif
+	}
+
+	// Cold: every call starts from nothing.
+	for (i = 0; i < cold_count; i++) {
+		hid_exit();
+
+		start = now_ns();
+		devs = hid_enumerate(vendor_id, product_id);
+		t = now_ns() - start;
+
+		devices = 0;
+		for (cur_dev = devs; cur_dev; cur_dev = cur_dev->next)
+			devices++;
+		hid_free_enumeration(devs);
+
+		cold_total += t;
+		if (i == 0 || t < cold_min)
+			cold_min = t;
+	}
+
+	// Warm: the library is initialized.
+	for (i = 0; i < count; i++) {
+		start = now_ns();
+		devs = hid_enumerate(vendor_id, product_id);
+		t = now_ns() - start;
+		hid_free_enumeration(devs);
+
+		warm_total += t;
+		if (i == 0 || t < warm_min)
+			warm_min = t;
+	}
+
+	for (i = 0; i < count; i++) {
+		start = now_ns();
+		handle = hid_open(BENCH_VID, BENCH_PID, (wchar_t *) L"hidtest-no-such-serial");
+		lookup_total += now_ns() - start;
+		if (handle)
+			hid_close(handle);
+	}
+
+	hid_exit();
+
+#ifdef __linux__
+	for (i = 0; i < created; i++)
+		close(virtual_fds[i]);
+#endif
+	free(virtual_fds);
+
+	if (json) {
+		printf("{ \"devices\": %u, \"virtual_nodes\": %d, \"cold_avg_us\": %.3f, \"cold_min_us\": %.3f, "
+		       "\"warm_avg_us\": %.3f, \"warm_min_us\": %.3f, \"lookup_avg_us\": %.3f }\n",
+		       (unsigned) devices, created, cold_total / 1e3 / cold_count, cold_min / 1e3,
+		       warm_total / 1e3 / count, warm_min / 1e3, lookup_total / 1e3 / count);
+	}
+	else {
+		printf("Devices:   %u, %d virtual nodes\n", (unsigned) devices, created);
+		printf("Cold:      %.1f us average, %.1f us best of %d\n", cold_total / 1e3 / cold_count, cold_min / 1e3, cold_count);
+		printf("Warm:      %.1f us average, %.1f us best of %d\n", warm_total / 1e3 / count, warm_min / 1e3, count);
+		printf("Lookup:    %.1f us average hid_open() of a missing serial number\n", lookup_total / 1e3 / count);
+	}
+
+	return 0;
+}
+
+int main(int argc, char* argv[])
+{
+	if (argc > 1 && strcmp(argv[1], "bench") == 0)
+		return run_bench(argc - 1, argv + 1);
+	if (argc > 1 && strcmp(argv[1], "enum") == 0)
+		return run_enum_bench(argc - 1, argv + 1);
+	if (argc > 1) {
+		usage();
+		return 1;
+	}
+
+	return run_demo();
+}
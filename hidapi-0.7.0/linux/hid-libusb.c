@@ -31,6 +31,7 @@
 #include <ctype.h>
 #include <locale.h>
 #include <errno.h>
+#include <time.h>
 
 /* Unix */
 #include <unistd.h>
@@ -70,6 +71,7 @@ instead to differentiate between interfaces on a composite HID device. */
 struct input_report {
 	uint8_t *data;
 	size_t len;
+	unsigned long long timestamp; /* CLOCK_MONOTONIC arrival, in ns */
 	struct input_report *next;
 };
 
@@ -109,7 +111,7 @@ struct hid_device_ {
 static int initialized = 0;
 
 uint16_t get_usb_code_for_current_locale(void);
-static int return_data(hid_device *dev, unsigned char *data, size_t length);
+static int return_data(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp_ns);
 
 static hid_device *new_hid_device(void)
 {
@@ -145,6 +147,15 @@ static void free_hid_device(hid_device *dev)
 	free(dev);
 }
 
+/* Return the current CLOCK_MONOTONIC time in nanoseconds. This is used
+   to stamp input reports with the time they were received. */
+static unsigned long long monotonic_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 #if 0
 //TODO: Implement this funciton on Linux.
 static void register_error(hid_device *device, const char *op)
@@ -580,6 +591,22 @@ void  HID_API_EXPORT hid_free_enumeration(struct hid_device_info *devs)
 	}
 }
 
+int HID_API_EXPORT hid_register_hotplug_callback(unsigned short vendor_id, unsigned short product_id, hid_hotplug_callback callback, void *user_data)
+{
+	/* Hotplug notification is not implemented by this backend. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_deregister_hotplug_callback(hid_hotplug_callback callback, void *user_data)
+{
+	return -1;
+}
+
+int HID_API_EXPORT hid_hotplug_process(int milliseconds)
+{
+	return -1;
+}
+
 hid_device * hid_open(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number)
 {
 	struct hid_device_info *devs, *cur_dev;
@@ -622,6 +649,10 @@ static void read_callback(struct libusb_transfer *transfer)
 	if (transfer->status == LIBUSB_TRANSFER_COMPLETED) {
 
 		struct input_report *rpt = malloc(sizeof(*rpt));
+		/* Stamp the report before anything else, so that the
+		   allocation and the list walk below don't count as
+		   device latency. */
+		rpt->timestamp = monotonic_ns();
 		rpt->data = malloc(transfer->actual_length);
 		memcpy(rpt->data, transfer->buffer, transfer->actual_length);
 		rpt->len = transfer->actual_length;
@@ -649,7 +680,7 @@ static void read_callback(struct libusb_transfer *transfer)
 			   way we don't grow forever if the user never reads
 			   anything from the device. */
 			if (num_queued > 30) {
-				return_data(dev, NULL, 0);
+				return_data(dev, NULL, 0, NULL);
 			}			
 		}
 		pthread_mutex_unlock(&dev->mutex);
@@ -925,7 +956,7 @@ int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t
 
 /* Helper function, to simplify hid_read().
    This should be called with dev->mutex locked. */
-static int return_data(hid_device *dev, unsigned char *data, size_t length)
+static int return_data(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp_ns)
 {
 	/* Copy the data out of the linked list item (rpt) into the
 	   return buffer (data), and delete the liked list item. */
@@ -933,6 +964,8 @@ static int return_data(hid_device *dev, unsigned char *data, size_t length)
 	size_t len = (length < rpt->len)? length: rpt->len;
 	if (len > 0)
 		memcpy(data, rpt->data, len);
+	if (timestamp_ns)
+		*timestamp_ns = rpt->timestamp;
 	dev->input_reports = rpt->next;
 	free(rpt->data);
 	free(rpt);
@@ -946,10 +979,13 @@ static void cleanup_mutex(void *param)
 }
 
 
-int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+int HID_API_EXPORT hid_read_timeout_timestamp(hid_device *dev, unsigned char *data, size_t length, int milliseconds, unsigned long long *timestamp_ns)
 {
 	int bytes_read = -1;
 
+	if (timestamp_ns)
+		*timestamp_ns = 0;
+
 #if 0
 	int transferred;
 	int res = libusb_interrupt_transfer(dev->device_handle, dev->input_endpoint, data, length, &transferred, 5000);
@@ -963,7 +999,7 @@ int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t
 	/* There's an input report queued up. Return it. */
 	if (dev->input_reports) {
 		/* Return the first one */
-		bytes_read = return_data(dev, data, length);
+		bytes_read = return_data(dev, data, length, timestamp_ns);
 		goto ret;
 	}
 	
@@ -980,7 +1016,7 @@ int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t
 			pthread_cond_wait(&dev->condition, &dev->mutex);
 		}
 		if (dev->input_reports) {
-			bytes_read = return_data(dev, data, length);
+			bytes_read = return_data(dev, data, length, timestamp_ns);
 		}
 	}
 	else if (milliseconds > 0) {
@@ -999,7 +1035,7 @@ int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t
 			res = pthread_cond_timedwait(&dev->condition, &dev->mutex, &ts);
 			if (res == 0) {
 				if (dev->input_reports) {
-					bytes_read = return_data(dev, data, length);
+					bytes_read = return_data(dev, data, length, timestamp_ns);
 					break;
 				}
 				
@@ -1031,6 +1067,11 @@ ret:
 	return bytes_read;
 }
 
+int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+{
+	return hid_read_timeout_timestamp(dev, data, length, milliseconds, NULL);
+}
+
 int HID_API_EXPORT hid_read(hid_device *dev, unsigned char *data, size_t length)
 {
 	return hid_read_timeout(dev, data, length, dev->blocking ? -1 : 0);
@@ -1130,7 +1171,7 @@ void HID_API_EXPORT hid_close(hid_device *dev)
 	/* Clear out the queue of received reports. */
 	pthread_mutex_lock(&dev->mutex);
 	while (dev->input_reports) {
-		return_data(dev, NULL, 0);
+		return_data(dev, NULL, 0, NULL);
 	}
 	pthread_mutex_unlock(&dev->mutex);
 	
@@ -1153,6 +1194,28 @@ int HID_API_EXPORT_CALL hid_get_serial_number_string(hid_device *dev, wchar_t *s
 	return hid_get_indexed_string(dev, dev->serial_index, string, maxlen);
 }
 
+int HID_API_EXPORT_CALL hid_get_report_descriptor(hid_device *dev, unsigned char *buf, size_t buf_size)
+{
+	int res;
+
+	if (buf_size > 0xffff)
+		buf_size = 0xffff;
+
+	/* The interface is already claimed, so this doesn't have the
+	   problems described under INVASIVE_GET_USAGE. */
+	res = libusb_control_transfer(dev->device_handle,
+		LIBUSB_ENDPOINT_IN|LIBUSB_RECIPIENT_INTERFACE,
+		LIBUSB_REQUEST_GET_DESCRIPTOR,
+		LIBUSB_DT_REPORT << 8,
+		dev->interface,
+		buf, buf_size,
+		1000/*timeout millis*/);
+	if (res < 0)
+		return -1;
+
+	return res;
+}
+
 int HID_API_EXPORT_CALL hid_get_indexed_string(hid_device *dev, int string_index, wchar_t *string, size_t maxlen)
 {
 	wchar_t *str;
@@ -27,6 +27,8 @@
 #include <stdlib.h>
 #include <locale.h>
 #include <errno.h>
+#include <time.h>
+#include <wchar.h>
 
 /* Unix */
 #include <unistd.h>
@@ -36,6 +38,7 @@
 #include <sys/utsname.h>
 #include <fcntl.h>
 #include <poll.h>
+#include <pthread.h>
 
 /* Linux */
 #include <linux/hidraw.h>
@@ -77,6 +80,15 @@ static void register_error(hid_device *device, const char *op)
 
 }
 
+/* Return the current CLOCK_MONOTONIC time in nanoseconds. This is used
+   to stamp input reports with the time they were received. */
+static unsigned long long monotonic_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
 /* Get an attribute value from a udev_device and return it as a whar_t
    string. The returned string must be freed with free() when done.*/
 static wchar_t *copy_udev_string(struct udev_device *dev, const char *udev_name)
@@ -203,88 +215,559 @@ end:
 	return ret;
 }
 
-int HID_API_EXPORT hid_init(void)
+/* The device registry. Walking every hidraw node and its parents is
+   expensive, so the registry is filled by one full scan in hid_init()
+   and then kept up to date from a udev monitor. hid_enumerate() and
+   hid_open() answer from it. Entries are chained into three hash tables:
+   one keyed by VID/PID for hid_enumerate(), one keyed by VID/PID and
+   serial number for hid_open(), and one keyed by sysfs path, since udev
+   "remove" events only carry the path. */
+#define REGISTRY_BUCKETS 64
+
+struct registry_entry {
+	char *syspath;
+	struct hid_device_info info;
+	struct registry_entry *next_by_id;
+	struct registry_entry *next_by_serial;
+	struct registry_entry *next_by_path;
+};
+
+struct hotplug_callback {
+	unsigned short vendor_id;
+	unsigned short product_id;
+	hid_hotplug_callback callback;
+	void *user_data;
+	struct hotplug_callback *next;
+};
+
+static struct udev *registry_udev = NULL;
+static struct udev_monitor *registry_monitor = NULL;
+static struct registry_entry *registry_by_id[REGISTRY_BUCKETS];
+static struct registry_entry *registry_by_serial[REGISTRY_BUCKETS];
+static struct registry_entry *registry_by_path[REGISTRY_BUCKETS];
+static struct hotplug_callback *hotplug_callbacks = NULL;
+
+/* Recursive, so that hotplug callbacks may call hid_enumerate() and
+   hid_open(). */
+static pthread_mutex_t registry_mutex;
+static pthread_once_t registry_mutex_once = PTHREAD_ONCE_INIT;
+
+static void registry_mutex_init(void)
 {
-	/* Nothing to do for this in the Linux/hidraw implementation. */
-	return 0;
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&registry_mutex, &attr);
+	pthread_mutexattr_destroy(&attr);
 }
 
-int HID_API_EXPORT hid_exit(void)
+static void registry_lock(void)
 {
-	/* Nothing to do for this in the Linux/hidraw implementation. */
-	return 0;
+	pthread_once(&registry_mutex_once, registry_mutex_init);
+	pthread_mutex_lock(&registry_mutex);
 }
 
-struct hid_device_info  HID_API_EXPORT *hid_enumerate(unsigned short vendor_id, unsigned short product_id)
+static void registry_unlock(void)
 {
-	struct udev *udev;
-	struct udev_enumerate *enumerate;
-	struct udev_list_entry *devices, *dev_list_entry;
+	pthread_mutex_unlock(&registry_mutex);
+}
+
+static unsigned int id_bucket(unsigned short vendor_id, unsigned short product_id)
+{
+	return ((unsigned int) vendor_id * 31 + product_id) % REGISTRY_BUCKETS;
+}
+
+static unsigned int serial_bucket(unsigned short vendor_id, unsigned short product_id, const wchar_t *serial_number)
+{
+	/* djb2, seeded with the VID/PID. A missing serial number hashes
+	   like an empty one. */
+	unsigned int hash = 5381 + (unsigned int) vendor_id * 31 + product_id;
+	if (serial_number) {
+		while (*serial_number)
+			hash = hash * 33 + (unsigned int) *serial_number++;
+	}
+	return hash % REGISTRY_BUCKETS;
+}
+
+static unsigned int path_bucket(const char *syspath)
+{
+	/* djb2 */
+	unsigned int hash = 5381;
+	while (*syspath)
+		hash = hash * 33 + (unsigned char) *syspath++;
+	return hash % REGISTRY_BUCKETS;
+}
+
+static char *dup_str(const char *s)
+{
+	char *ret;
+	if (!s)
+		return NULL;
+	ret = malloc(strlen(s) + 1);
+	if (ret)
+		strcpy(ret, s);
+	return ret;
+}
+
+static wchar_t *dup_wcs(const wchar_t *s)
+{
+	wchar_t *ret;
+	if (!s)
+		return NULL;
+	ret = malloc((wcslen(s) + 1) * sizeof(wchar_t));
+	if (ret)
+		wcscpy(ret, s);
+	return ret;
+}
+
+/* Make a stand-alone copy of a registry record, for returning from
+   hid_enumerate(). Free it with hid_free_enumeration(). */
+static struct hid_device_info *copy_device_info(const struct hid_device_info *info)
+{
+	struct hid_device_info *ret = malloc(sizeof(struct hid_device_info));
+	if (!ret)
+		return NULL;
+	*ret = *info;
+	ret->path = dup_str(info->path);
+	ret->serial_number = dup_wcs(info->serial_number);
+	ret->manufacturer_string = dup_wcs(info->manufacturer_string);
+	ret->product_string = dup_wcs(info->product_string);
+	ret->next = NULL;
+	return ret;
+}
+
+/* Build a registry entry for a hidraw udev node. Returns NULL if the node
+   doesn't sit on a USB device. */
+static struct registry_entry *new_registry_entry(struct udev_device *hid_dev)
+{
+	struct registry_entry *entry;
+	struct hid_device_info *cur_dev;
+	struct udev_device *dev; // The actual hardware device.
+	struct udev_device *intf_dev; // The device's interface (in the USB sense).
+	const char *str;
+
+	/* The device pointed to by hid_dev contains information about
+	   the hidraw device. In order to get information about the
+	   USB device, get the parent device with the
+	   subsystem/devtype pair of "usb"/"usb_device". This will
+	   be several levels up the tree, but the function will find
+	   it.*/
+	dev = udev_device_get_parent_with_subsystem_devtype(
+	       hid_dev,
+	       "usb",
+	       "usb_device");
+	if (!dev) {
+		/* Unable to find parent usb device. */
+		return NULL;
+	}
+
+	entry = calloc(1, sizeof(struct registry_entry));
+	entry->syspath = dup_str(udev_device_get_syspath(hid_dev));
+	cur_dev = &entry->info;
+
+	/* Fill out the record */
+	cur_dev->next = NULL;
+	cur_dev->path = dup_str(udev_device_get_devnode(hid_dev));
+
+	/* Serial Number */
+	cur_dev->serial_number
+		= copy_udev_string(dev, "serial");
+
+	/* Manufacturer and Product strings */
+	cur_dev->manufacturer_string
+		= copy_udev_string(dev, "manufacturer");
+	cur_dev->product_string
+		= copy_udev_string(dev, "product");
 	
-	struct hid_device_info *root = NULL; // return object
-	struct hid_device_info *cur_dev = NULL;
+	/* VID/PID */
+	str = udev_device_get_sysattr_value(dev,"idVendor");
+	cur_dev->vendor_id = (str)? strtol(str, NULL, 16): 0x0;
+	str = udev_device_get_sysattr_value(dev, "idProduct");
+	cur_dev->product_id = (str)? strtol(str, NULL, 16): 0x0;
+
+	/* Release Number */
+	str = udev_device_get_sysattr_value(dev, "bcdDevice");
+	cur_dev->release_number = (str)? strtol(str, NULL, 16): 0x0;
 	
-	setlocale(LC_ALL,"");
+	/* Interface Number */
+	cur_dev->interface_number = -1;
+	/* Get a handle to the interface's udev node. */
+	intf_dev = udev_device_get_parent_with_subsystem_devtype(
+		   hid_dev,
+		   "usb",
+		   "usb_interface");
+	if (intf_dev) {
+		str = udev_device_get_sysattr_value(intf_dev, "bInterfaceNumber");
+		cur_dev->interface_number = (str)? strtol(str, NULL, 16): -1;
+	}
 
-	/* Create the udev object */
-	udev = udev_new();
-	if (!udev) {
-		printf("Can't create udev\n");
+	/* dev and intf_dev don't need to be (and can't be)
+	   unref()d.  It will cause a double-free() error.  I'm not
+	   sure why.  */
+
+	return entry;
+}
+
+static void free_registry_entry(struct registry_entry *entry)
+{
+	free(entry->syspath);
+	free(entry->info.path);
+	free(entry->info.serial_number);
+	free(entry->info.manufacturer_string);
+	free(entry->info.product_string);
+	free(entry);
+}
+
+static void registry_insert(struct registry_entry *entry)
+{
+	unsigned int id = id_bucket(entry->info.vendor_id, entry->info.product_id);
+	unsigned int serial = serial_bucket(entry->info.vendor_id, entry->info.product_id, entry->info.serial_number);
+	unsigned int path = path_bucket(entry->syspath);
+
+	entry->next_by_id = registry_by_id[id];
+	registry_by_id[id] = entry;
+	entry->next_by_serial = registry_by_serial[serial];
+	registry_by_serial[serial] = entry;
+	entry->next_by_path = registry_by_path[path];
+	registry_by_path[path] = entry;
+}
+
+/* Unlink the entry for syspath from both tables and return it, or return
+   NULL if there isn't one. */
+static struct registry_entry *registry_detach(const char *syspath)
+{
+	struct registry_entry **link = &registry_by_path[path_bucket(syspath)];
+	struct registry_entry *entry;
+
+	while (*link && strcmp((*link)->syspath, syspath) != 0)
+		link = &(*link)->next_by_path;
+	entry = *link;
+	if (!entry)
+		return NULL;
+	*link = entry->next_by_path;
+
+	link = &registry_by_id[id_bucket(entry->info.vendor_id, entry->info.product_id)];
+	while (*link != entry)
+		link = &(*link)->next_by_id;
+	*link = entry->next_by_id;
+
+	link = &registry_by_serial[serial_bucket(entry->info.vendor_id, entry->info.product_id, entry->info.serial_number)];
+	while (*link != entry)
+		link = &(*link)->next_by_serial;
+	*link = entry->next_by_serial;
+
+	return entry;
+}
+
+/* Find the entry for a VID/PID and, if serial_number isn't NULL, serial
+   number. Without a serial number, this is the entry hid_enumerate()
+   would list first. */
+static struct registry_entry *registry_find(unsigned short vendor_id, unsigned short product_id, const wchar_t *serial_number)
+{
+	struct registry_entry *entry;
+
+	if (serial_number) {
+		entry = registry_by_serial[serial_bucket(vendor_id, product_id, serial_number)];
+		for (; entry; entry = entry->next_by_serial) {
+			if (entry->info.vendor_id == vendor_id &&
+			    entry->info.product_id == product_id &&
+			    entry->info.serial_number &&
+			    wcscmp(entry->info.serial_number, serial_number) == 0)
+				return entry;
+		}
 		return NULL;
 	}
 
-	/* Create a list of the devices in the 'hidraw' subsystem. */
-	enumerate = udev_enumerate_new(udev);
+	entry = registry_by_id[id_bucket(vendor_id, product_id)];
+	for (; entry; entry = entry->next_by_id) {
+		if (entry->info.vendor_id == vendor_id &&
+		    entry->info.product_id == product_id)
+			return entry;
+	}
+	return NULL;
+}
+
+static void registry_clear(void)
+{
+	int i;
+	for (i = 0; i < REGISTRY_BUCKETS; i++) {
+		struct registry_entry *entry = registry_by_id[i];
+		while (entry) {
+			struct registry_entry *next = entry->next_by_id;
+			free_registry_entry(entry);
+			entry = next;
+		}
+		registry_by_id[i] = NULL;
+		registry_by_serial[i] = NULL;
+		registry_by_path[i] = NULL;
+	}
+}
+
+/* Fill the registry by walking every node in the 'hidraw' subsystem. */
+static void registry_scan(void)
+{
+	struct udev_enumerate *enumerate;
+	struct udev_list_entry *devices, *dev_list_entry;
+
+	enumerate = udev_enumerate_new(registry_udev);
 	udev_enumerate_add_match_subsystem(enumerate, "hidraw");
 	udev_enumerate_scan_devices(enumerate);
 	devices = udev_enumerate_get_list_entry(enumerate);
-	/* For each item, see if it matches the vid/pid, and if so
-	   create a udev_device record for it */
 	udev_list_entry_foreach(dev_list_entry, devices) {
-		const char *sysfs_path;
-		const char *dev_path;
-		const char *str;
-		struct udev_device *hid_dev; // The device's HID udev node.
-		struct udev_device *dev; // The actual hardware device.
-		struct udev_device *intf_dev; // The device's interface (in the USB sense).
-		unsigned short dev_vid;
-		unsigned short dev_pid;
-		
-		/* Get the filename of the /sys entry for the device
-		   and create a udev_device object (dev) representing it */
-		sysfs_path = udev_list_entry_get_name(dev_list_entry);
-		hid_dev = udev_device_new_from_syspath(udev, sysfs_path);
-		dev_path = udev_device_get_devnode(hid_dev);
-		
-		/* The device pointed to by hid_dev contains information about
-		   the hidraw device. In order to get information about the
-		   USB device, get the parent device with the
-		   subsystem/devtype pair of "usb"/"usb_device". This will
-		   be several levels up the tree, but the function will find
-		   it.*/
-		dev = udev_device_get_parent_with_subsystem_devtype(
-		       hid_dev,
-		       "usb",
-		       "usb_device");
-		if (!dev) {
-			/* Unable to find parent usb device. */
-			goto next;
+		const char *sysfs_path = udev_list_entry_get_name(dev_list_entry);
+		struct udev_device *hid_dev = udev_device_new_from_syspath(registry_udev, sysfs_path);
+		struct registry_entry *entry;
+
+		if (!hid_dev)
+			continue;
+		entry = new_registry_entry(hid_dev);
+		if (entry)
+			registry_insert(entry);
+		udev_device_unref(hid_dev);
+	}
+	udev_enumerate_unref(enumerate);
+}
+
+static void notify_hotplug(enum hid_hotplug_event event, const struct hid_device_info *info)
+{
+	struct hotplug_callback *cb;
+	for (cb = hotplug_callbacks; cb; cb = cb->next) {
+		if ((cb->vendor_id == 0x0 || cb->vendor_id == info->vendor_id) &&
+		    (cb->product_id == 0x0 || cb->product_id == info->product_id))
+			cb->callback(event, info, cb->user_data);
+	}
+}
+
+/* Apply the events queued on the udev monitor to the registry, waiting
+   up to milliseconds for the first one. Must be called with the registry
+   locked. */
+static int registry_update(int milliseconds)
+{
+	int processed = 0;
+	struct pollfd fds;
+
+	fds.fd = udev_monitor_get_fd(registry_monitor);
+	fds.events = POLLIN;
+
+	for (;;) {
+		struct udev_device *hid_dev;
+		const char *action;
+		const char *syspath;
+		int ret;
+
+		fds.revents = 0;
+		ret = poll(&fds, 1, processed? 0: milliseconds);
+		if (ret < 0)
+			return (errno == EINTR)? processed: -1;
+		if (ret == 0)
+			break;
+
+		hid_dev = udev_monitor_receive_device(registry_monitor);
+		if (!hid_dev)
+			continue;
+
+		action = udev_device_get_action(hid_dev);
+		syspath = udev_device_get_syspath(hid_dev);
+		if (action && syspath) {
+			struct registry_entry *old_entry = NULL;
+			struct registry_entry *new_entry = NULL;
+
+			/* "remove" drops the record of the node, "add" and
+			   "change" replace it. Other actions ("bind", "move",
+			   ...) leave the registry as it is. A replaced record
+			   is only reported if the node stops or starts being a
+			   USB HID device. */
+			if (strcmp(action, "remove") == 0) {
+				old_entry = registry_detach(syspath);
+				processed++;
+			}
+			else if (strcmp(action, "add") == 0 || strcmp(action, "change") == 0) {
+				new_entry = new_registry_entry(hid_dev);
+				old_entry = registry_detach(syspath);
+				if (new_entry)
+					registry_insert(new_entry);
+				processed++;
+			}
+
+			if (old_entry && !new_entry)
+				notify_hotplug(HID_HOTPLUG_EVENT_DEVICE_LEFT, &old_entry->info);
+			if (new_entry && !old_entry)
+				notify_hotplug(HID_HOTPLUG_EVENT_DEVICE_ARRIVED, &new_entry->info);
+			if (old_entry)
+				free_registry_entry(old_entry);
 		}
+		udev_device_unref(hid_dev);
+	}
 
-		/* Get the VID/PID of the device */
-		str = udev_device_get_sysattr_value(dev,"idVendor");
-		dev_vid = (str)? strtol(str, NULL, 16): 0x0;
-		str = udev_device_get_sysattr_value(dev, "idProduct");
-		dev_pid = (str)? strtol(str, NULL, 16): 0x0;
+	return processed;
+}
 
-		/* Check the VID/PID against the arguments */
-		if ((vendor_id == 0x0 && product_id == 0x0) ||
-		    (vendor_id == dev_vid && product_id == dev_pid)) {
+int HID_API_EXPORT hid_init(void)
+{
+	registry_lock();
+	if (registry_udev) {
+		registry_unlock();
+		return 0;
+	}
+
+	setlocale(LC_ALL,"");
+
+	/* Create the udev object */
+	registry_udev = udev_new();
+	if (!registry_udev) {
+		printf("Can't create udev\n");
+		registry_unlock();
+		return -1;
+	}
+
+	/* Start listening before the scan, so that nothing which changes
+	   during the scan is missed. If the monitor can't be set up (no
+	   netlink access, for example), hid_enumerate() falls back to a
+	   full scan on each call. */
+	registry_monitor = udev_monitor_new_from_netlink(registry_udev, "udev");
+	if (registry_monitor) {
+		udev_monitor_filter_add_match_subsystem_devtype(registry_monitor, "hidraw", NULL);
+		if (udev_monitor_enable_receiving(registry_monitor) < 0) {
+			udev_monitor_unref(registry_monitor);
+			registry_monitor = NULL;
+		}
+	}
+
+	registry_scan();
+	registry_unlock();
+
+	return 0;
+}
+
+int HID_API_EXPORT hid_exit(void)
+{
+	registry_lock();
+	registry_clear();
+	while (hotplug_callbacks) {
+		struct hotplug_callback *next = hotplug_callbacks->next;
+		free(hotplug_callbacks);
+		hotplug_callbacks = next;
+	}
+	if (registry_monitor) {
+		udev_monitor_unref(registry_monitor);
+		registry_monitor = NULL;
+	}
+	if (registry_udev) {
+		udev_unref(registry_udev);
+		registry_udev = NULL;
+	}
+	registry_unlock();
+
+	return 0;
+}
+
+int HID_API_EXPORT hid_register_hotplug_callback(unsigned short vendor_id, unsigned short product_id, hid_hotplug_callback callback, void *user_data)
+{
+	struct hotplug_callback *cb;
+
+	if (!callback || hid_init() < 0)
+		return -1;
+
+	cb = malloc(sizeof(struct hotplug_callback));
+	if (!cb)
+		return -1;
+	cb->vendor_id = vendor_id;
+	cb->product_id = product_id;
+	cb->callback = callback;
+	cb->user_data = user_data;
+
+	registry_lock();
+	cb->next = hotplug_callbacks;
+	hotplug_callbacks = cb;
+	registry_unlock();
+
+	return 0;
+}
+
+int HID_API_EXPORT hid_deregister_hotplug_callback(hid_hotplug_callback callback, void *user_data)
+{
+	struct hotplug_callback **link;
+	int ret = -1;
+
+	registry_lock();
+	for (link = &hotplug_callbacks; *link; link = &(*link)->next) {
+		struct hotplug_callback *cb = *link;
+		if (cb->callback == callback && cb->user_data == user_data) {
+			*link = cb->next;
+			free(cb);
+			ret = 0;
+			break;
+		}
+	}
+	registry_unlock();
+
+	return ret;
+}
+
+int HID_API_EXPORT hid_hotplug_process(int milliseconds)
+{
+	int ret;
+
+	if (hid_init() < 0)
+		return -1;
+
+	registry_lock();
+	ret = (registry_monitor)? registry_update(milliseconds): -1;
+	registry_unlock();
+
+	return ret;
+}
+
+/* Bring the registry up to date. Must be called with the registry
+   locked. */
+static void registry_refresh(void)
+{
+	if (registry_monitor) {
+		registry_update(0);
+	}
+	else {
+		registry_clear();
+		registry_scan();
+	}
+}
+
+struct hid_device_info  HID_API_EXPORT *hid_enumerate(unsigned short vendor_id, unsigned short product_id)
+{
+	struct hid_device_info *root = NULL; // return object
+	struct hid_device_info *cur_dev = NULL;
+	unsigned int i, first, last;
+
+	if (hid_init() < 0)
+		return NULL;
+
+	registry_lock();
+	registry_refresh();
+
+	/* A specific VID/PID only needs its own bucket. */
+	if (vendor_id == 0x0 && product_id == 0x0) {
+		first = 0;
+		last = REGISTRY_BUCKETS;
+	}
+	else {
+		first = id_bucket(vendor_id, product_id);
+		last = first + 1;
+	}
+
+	for (i = first; i < last; i++) {
+		struct registry_entry *entry;
+
+		for (entry = registry_by_id[i]; entry; entry = entry->next_by_id) {
 			struct hid_device_info *tmp;
-			size_t len;
 
-		    	/* VID/PID match. Create the record. */
-			tmp = malloc(sizeof(struct hid_device_info));
+			/* Check the VID/PID against the arguments */
+			if ((vendor_id != 0x0 || product_id != 0x0) &&
+			    (vendor_id != entry->info.vendor_id ||
+			     product_id != entry->info.product_id))
+				continue;
+
+			tmp = copy_device_info(&entry->info);
+			if (!tmp)
+				continue;
 			if (cur_dev) {
 				cur_dev->next = tmp;
 			}
@@ -292,61 +775,10 @@ struct hid_device_info  HID_API_EXPORT *hid_enumerate(unsigned short vendor_id,
 				root = tmp;
 			}
 			cur_dev = tmp;
-			
-			/* Fill out the record */
-			cur_dev->next = NULL;
-			str = dev_path;
-			if (str) {
-				len = strlen(str);
-				cur_dev->path = calloc(len+1, sizeof(char));
-				strncpy(cur_dev->path, str, len+1);
-				cur_dev->path[len] = '\0';
-			}
-			else
-				cur_dev->path = NULL;
-			
-			/* Serial Number */
-			cur_dev->serial_number
-				= copy_udev_string(dev, "serial");
-
-			/* Manufacturer and Product strings */
-			cur_dev->manufacturer_string
-				= copy_udev_string(dev, "manufacturer");
-			cur_dev->product_string
-				= copy_udev_string(dev, "product");
-			
-			/* VID/PID */
-			cur_dev->vendor_id = dev_vid;
-			cur_dev->product_id = dev_pid;
-
-			/* Release Number */
-			str = udev_device_get_sysattr_value(dev, "bcdDevice");
-			cur_dev->release_number = (str)? strtol(str, NULL, 16): 0x0;
-			
-			/* Interface Number */
-			cur_dev->interface_number = -1;
-			/* Get a handle to the interface's udev node. */
-			intf_dev = udev_device_get_parent_with_subsystem_devtype(
-				   hid_dev,
-				   "usb",
-				   "usb_interface");
-			if (intf_dev) {
-				str = udev_device_get_sysattr_value(intf_dev, "bInterfaceNumber");
-				cur_dev->interface_number = (str)? strtol(str, NULL, 16): -1;
-			}
 		}
-		else
-			goto next;
-
-	next:
-		udev_device_unref(hid_dev);
-		/* dev and intf_dev don't need to be (and can't be)
-		   unref()d.  It will cause a double-free() error.  I'm not
-		   sure why.  */
 	}
-	/* Free the enumerator and udev objects. */
-	udev_enumerate_unref(enumerate);
-	udev_unref(udev);
+
+	registry_unlock();
 	
 	return root;
 }
@@ -367,36 +799,29 @@ void  HID_API_EXPORT hid_free_enumeration(struct hid_device_info *devs)
 
 hid_device * hid_open(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number)
 {
-	struct hid_device_info *devs, *cur_dev;
-	const char *path_to_open = NULL;
+	struct registry_entry *entry;
+	char *path_to_open = NULL;
 	hid_device *handle = NULL;
-	
-	devs = hid_enumerate(vendor_id, product_id);
-	cur_dev = devs;
-	while (cur_dev) {
-		if (cur_dev->vendor_id == vendor_id &&
-		    cur_dev->product_id == product_id) {
-			if (serial_number) {
-				if (wcscmp(serial_number, cur_dev->serial_number) == 0) {
-					path_to_open = cur_dev->path;
-					break;
-				}
-			}
-			else {
-				path_to_open = cur_dev->path;
-				break;
-			}
-		}
-		cur_dev = cur_dev->next;
-	}
+
+	if (hid_init() < 0)
+		return NULL;
+
+	/* Look the device up directly rather than through a copy of the
+	   enumeration. The path is copied, since the entry may go away once
+	   the registry is unlocked. */
+	registry_lock();
+	registry_refresh();
+	entry = registry_find(vendor_id, product_id, serial_number);
+	if (entry)
+		path_to_open = dup_str(entry->info.path);
+	registry_unlock();
 
 	if (path_to_open) {
 		/* Open the device */
 		handle = hid_open_path(path_to_open);
+		free(path_to_open);
 	}
 
-	hid_free_enumeration(devs);
-	
 	return handle;
 }
 
@@ -471,9 +896,10 @@ int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t
 }
 
 
-int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+int HID_API_EXPORT hid_read_timeout_timestamp(hid_device *dev, unsigned char *data, size_t length, int milliseconds, unsigned long long *timestamp_ns)
 {
 	int bytes_read;
+	unsigned long long arrival = 0;
 
 	if (milliseconds != 0) {
 		/* milliseconds is -1 or > 0. In both cases, we want to
@@ -486,9 +912,15 @@ int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t
 		fds.events = POLLIN;
 		fds.revents = 0;
 		ret = poll(&fds, 1, milliseconds);
-		if (ret == -1 || ret == 0)
+		if (ret == -1 || ret == 0) {
 			/* Error or timeout */
+			if (timestamp_ns)
+				*timestamp_ns = 0;
 			return ret;
+		}
+
+		/* The report became readable when poll() woke up. */
+		arrival = monotonic_ns();
 	}
 
 	bytes_read = read(dev->device_handle, data, length);
@@ -503,9 +935,21 @@ int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t
 		bytes_read--;
 	}
 
+	if (timestamp_ns) {
+		if (bytes_read > 0)
+			*timestamp_ns = (arrival)? arrival: monotonic_ns();
+		else
+			*timestamp_ns = 0;
+	}
+
 	return bytes_read;
 }
 
+int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+{
+	return hid_read_timeout_timestamp(dev, data, length, milliseconds, NULL);
+}
+
 int HID_API_EXPORT hid_read(hid_device *dev, unsigned char *data, size_t length)
 {
 	return hid_read_timeout(dev, data, length, (dev->blocking)? -1: 0);
@@ -588,6 +1032,34 @@ int HID_API_EXPORT_CALL hid_get_indexed_string(hid_device *dev, int string_index
 	return -1;
 }
 
+int HID_API_EXPORT_CALL hid_get_report_descriptor(hid_device *dev, unsigned char *buf, size_t buf_size)
+{
+	int res, desc_size = 0;
+	struct hidraw_report_descriptor rpt_desc;
+
+	/* Get Report Descriptor Size */
+	res = ioctl(dev->device_handle, HIDIOCGRDESCSIZE, &desc_size);
+	if (res < 0) {
+		perror("HIDIOCGRDESCSIZE");
+		return -1;
+	}
+
+	/* Get Report Descriptor */
+	memset(&rpt_desc, 0x0, sizeof(rpt_desc));
+	rpt_desc.size = desc_size;
+	res = ioctl(dev->device_handle, HIDIOCGRDESC, &rpt_desc);
+	if (res < 0) {
+		perror("HIDIOCGRDESC");
+		return -1;
+	}
+
+	if (rpt_desc.size < buf_size)
+		buf_size = rpt_desc.size;
+	memcpy(buf, rpt_desc.value, buf_size);
+
+	return buf_size;
+}
+
 
 HID_API_EXPORT const wchar_t * HID_API_CALL  hid_error(hid_device *dev)
 {
@@ -30,6 +30,7 @@
 #include <pthread.h>
 #include <sys/time.h>
 #include <unistd.h>
+#include <mach/mach_time.h>
 
 #include "hidapi.h"
 
@@ -91,12 +92,13 @@ static int pthread_barrier_wait(pthread_barrier_t *barrier)
 	}
 }
 
-static int return_data(hid_device *dev, unsigned char *data, size_t length);
+static int return_data(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp_ns);
 
 /* Linked List of input reports received from the device. */
 struct input_report {
 	uint8_t *data;
 	size_t len;
+	unsigned long long timestamp; /* monotonic arrival, in ns */
 	struct input_report *next;
 };
 
@@ -222,6 +224,16 @@ static void free_hid_device(hid_device *dev)
 static 	IOHIDManagerRef hid_mgr = 0x0;
 
 
+/* Return a monotonic time in nanoseconds. There is no clock_gettime()
+   here either, so the mach absolute time is scaled by the timebase. */
+static unsigned long long monotonic_ns(void)
+{
+	static mach_timebase_info_data_t timebase;
+	if (timebase.denom == 0)
+		mach_timebase_info(&timebase);
+	return mach_absolute_time() * timebase.numer / timebase.denom;
+}
+
 #if 0
 static void register_error(hid_device *device, const char *op)
 {
@@ -508,6 +520,22 @@ void  HID_API_EXPORT hid_free_enumeration(struct hid_device_info *devs)
 	}
 }
 
+int HID_API_EXPORT hid_register_hotplug_callback(unsigned short vendor_id, unsigned short product_id, hid_hotplug_callback callback, void *user_data)
+{
+	/* Hotplug notification is not implemented by this backend. */
+	return -1;
+}
+
+int HID_API_EXPORT hid_deregister_hotplug_callback(hid_hotplug_callback callback, void *user_data)
+{
+	return -1;
+}
+
+int HID_API_EXPORT hid_hotplug_process(int milliseconds)
+{
+	return -1;
+}
+
 hid_device * HID_API_EXPORT hid_open(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number)
 {
 	/* This function is identical to the Linux version. Platform independent. */
@@ -573,6 +601,7 @@ static void hid_report_callback(void *context, IOReturn result, void *sender,
 
 	/* Make a new Input Report object */
 	rpt = calloc(1, sizeof(struct input_report));
+	rpt->timestamp = monotonic_ns();
 	rpt->data = calloc(1, report_length);
 	memcpy(rpt->data, report, report_length);
 	rpt->len = report_length;
@@ -600,7 +629,7 @@ static void hid_report_callback(void *context, IOReturn result, void *sender,
 		   way we don't grow forever if the user never reads
 		   anything from the device. */
 		if (num_queued > 30) {
-			return_data(dev, NULL, 0);
+			return_data(dev, NULL, 0, NULL);
 		}
 	}
 
@@ -805,13 +834,15 @@ int HID_API_EXPORT hid_write(hid_device *dev, const unsigned char *data, size_t
 }
 
 /* Helper function, so that this isn't duplicated in hid_read(). */
-static int return_data(hid_device *dev, unsigned char *data, size_t length)
+static int return_data(hid_device *dev, unsigned char *data, size_t length, unsigned long long *timestamp_ns)
 {
 	/* Copy the data out of the linked list item (rpt) into the
 	   return buffer (data), and delete the liked list item. */
 	struct input_report *rpt = dev->input_reports;
 	size_t len = (length < rpt->len)? length: rpt->len;
 	memcpy(data, rpt->data, len);
+	if (timestamp_ns)
+		*timestamp_ns = rpt->timestamp;
 	dev->input_reports = rpt->next;
 	free(rpt->data);
 	free(rpt);
@@ -859,17 +890,20 @@ static int cond_timedwait(const hid_device *dev, pthread_cond_t *cond, pthread_m
 
 }
 
-int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+int HID_API_EXPORT hid_read_timeout_timestamp(hid_device *dev, unsigned char *data, size_t length, int milliseconds, unsigned long long *timestamp_ns)
 {
 	int bytes_read = -1;
 
+	if (timestamp_ns)
+		*timestamp_ns = 0;
+
 	/* Lock the access to the report list. */
 	pthread_mutex_lock(&dev->mutex);
 	
 	/* There's an input report queued up. Return it. */
 	if (dev->input_reports) {
 		/* Return the first one */
-		bytes_read = return_data(dev, data, length);
+		bytes_read = return_data(dev, data, length, timestamp_ns);
 		goto ret;
 	}
 
@@ -894,7 +928,7 @@ int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t
 		int res;
 		res = cond_wait(dev, &dev->condition, &dev->mutex);
 		if (res == 0)
-			bytes_read = return_data(dev, data, length);
+			bytes_read = return_data(dev, data, length, timestamp_ns);
 		else {
 			/* There was an error, or a device disconnection. */
 			bytes_read = -1;
@@ -916,7 +950,7 @@ int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t
 		
 		res = cond_timedwait(dev, &dev->condition, &dev->mutex, &ts);
 		if (res == 0)
-			bytes_read = return_data(dev, data, length);
+			bytes_read = return_data(dev, data, length, timestamp_ns);
 		else if (res == ETIMEDOUT)
 			bytes_read = 0;
 		else
@@ -933,6 +967,11 @@ ret:
 	return bytes_read;
 }
 
+int HID_API_EXPORT hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+{
+	return hid_read_timeout_timestamp(dev, data, length, milliseconds, NULL);
+}
+
 int HID_API_EXPORT hid_read(hid_device *dev, unsigned char *data, size_t length)
 {
 	return hid_read_timeout(dev, data, length, (dev->blocking)? -1: 0);
@@ -1009,7 +1048,7 @@ void HID_API_EXPORT hid_close(hid_device *dev)
 	/* Clear out the queue of received reports. */
 	pthread_mutex_lock(&dev->mutex);
 	while (dev->input_reports) {
-		return_data(dev, NULL, 0);
+		return_data(dev, NULL, 0, NULL);
 	}
 	pthread_mutex_unlock(&dev->mutex);
 
@@ -1038,6 +1077,23 @@ int HID_API_EXPORT_CALL hid_get_indexed_string(hid_device *dev, int string_index
 	return 0;
 }
 
+int HID_API_EXPORT_CALL hid_get_report_descriptor(hid_device *dev, unsigned char *buf, size_t buf_size)
+{
+	CFTypeRef ref;
+	CFIndex len;
+
+	ref = IOHIDDeviceGetProperty(dev->device_handle, CFSTR(kIOHIDReportDescriptorKey));
+	if (!ref || CFGetTypeID(ref) != CFDataGetTypeID())
+		return -1;
+
+	len = CFDataGetLength((CFDataRef) ref);
+	if ((size_t) len > buf_size)
+		len = buf_size;
+	CFDataGetBytes((CFDataRef) ref, CFRangeMake(0, len), buf);
+
+	return len;
+}
+
 
 HID_API_EXPORT const wchar_t * HID_API_CALL  hid_error(hid_device *dev)
 {
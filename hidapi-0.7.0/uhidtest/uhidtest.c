@@ -0,0 +1,602 @@
+/*******************************************************
+ HIDAPI - Multi-Platform library for
+ communication with HID devices.
+
+ Virtual Digitizer Test for the Linux/hidraw backend
+
+ This contents of this file may be used by anyone
+ for any reason without any conditions and may be
+ used as a starting point for your own applications
+ which use HIDAPI.
+********************************************************/
+
+/* uhidtest creates a virtual T-Board through /dev/uhid, with the report
+   map of ble_app_hids_mouse, and feeds it a synthetic or recorded stream
+   of digitizer reports at a chosen rate while reading them back through
+   hidapi (hid.c). It checks that every report comes back intact and in
+   order, and measures throughput and the latency from the write into
+   uhid to the arrival of the report.
+
+   The stream is read once per read path: hid_read_timeout_timestamp(),
+   whose arrival time is the one it reports, and hid_read() on a blocking
+   and on a non-blocking device, whose arrival time is taken when the
+   call returns.
+
+   It needs write access to /dev/uhid (usually root). */
+
+/* C */
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <time.h>
+#include <stdatomic.h>
+
+/* Unix */
+#include <unistd.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+
+/* Linux */
+#include <linux/uhid.h>
+#include <linux/input.h>
+
+#include "hidapi.h"
+#include "hidparser.h"
+#include "hidbench.h"
+
+#define VIRTUAL_VID 0x1915
+#define VIRTUAL_PID 0xeeee
+#define DIGITIZER_REPORT_LEN 9 /* Report ID and 8 bytes of data */
+
+/* Reports which don't come back in order are searched for this far
+   ahead, to tell lost reports from corrupted ones. */
+#define MATCH_WINDOW 256
+
+/* The end of a stream is marked by this report, sent until the reader
+   has seen it: Report ID 3 with every consumer control pressed at once,
+   which neither synthetic streams nor digitizer captures contain. */
+static const unsigned char end_report[] = { 0x03, 0xff };
+
+/* How long the end report is sent before the reader is given up on. */
+#define END_REPORT_TRIES 500
+#define END_REPORT_INTERVAL_US (10 * 1000)
+
+enum read_mode {
+	READ_TIMESTAMP,
+	READ_BLOCKING,
+	READ_NONBLOCKING,
+	NUM_READ_MODES
+};
+
+static const char *const mode_names[NUM_READ_MODES] = {
+	"timestamp", "blocking", "nonblocking"
+};
+
+static const char *const mode_titles[NUM_READ_MODES] = {
+	"hid_read_timeout_timestamp()", "hid_read(), blocking", "hid_read(), non-blocking"
+};
+
+/* State shared by the producer thread and the reader. The producer
+   stores the time each report is sent before writing it to uhid, and the
+   reader loads it once the report has come back. */
+struct harness {
+	int uhid_fd;
+	struct hidbench_report *reports;
+	size_t num_reports;
+	double rate; /* Reports per second, or 0 for as fast as possible */
+	int opened;  /* Only used by the producer */
+	atomic_ullong *sent_ns;
+	atomic_int producer_failed;
+	atomic_int reader_done;
+	atomic_int destroyed;
+};
+
+struct run_result {
+	size_t received;
+	size_t lost;
+	size_t corrupted;
+	unsigned long long first_arrival;
+	unsigned long long last_arrival;
+	unsigned long long *latencies;
+	int failed;
+};
+
+static unsigned long long monotonic_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void usage(void)
+{
+	printf("usage: uhidtest [options]\n"
+	       "  -n COUNT  number of synthetic reports (default 10000)\n"
+	       "  -r RATE   reports per second, 0 for as fast as possible (default 1000)\n"
+	       "  -c FILE   replay a capture recorded with \"hidtest bench -w\"\n"
+	       "  -m MODE   read path: timestamp, blocking, nonblocking or all (default all)\n"
+	       "  -L        don't fail on lost reports\n"
+	       "  -j        print the results as JSON\n");
+}
+
+/* Fill the stream with digitizer reports which are all different: the
+   X and Y fields carry a sequence number, and Z a check value. */
+static void make_synthetic(struct harness *h, size_t count)
+{
+	size_t i;
+
+	h->reports = calloc(count? count: 1, sizeof(struct hidbench_report));
+	h->num_reports = count;
+	for (i = 0; i < count; i++) {
+		struct hidbench_report *rpt = &h->reports[i];
+		unsigned short ts = (unsigned short) (i * 1024 / 50);
+		unsigned int seq = (unsigned int) i;
+		unsigned short check = (unsigned short) ((seq * 2654435761u) >> 16);
+
+		rpt->len = DIGITIZER_REPORT_LEN;
+		rpt->data[0] = HIDBENCH_DIGITIZER_REPORT_ID;
+		rpt->data[1] = ts & 0xff;
+		rpt->data[2] = ts >> 8;
+		rpt->data[3] = seq & 0xff;
+		rpt->data[4] = (seq >> 8) & 0xff;
+		rpt->data[5] = (seq >> 16) & 0xff;
+		rpt->data[6] = (seq >> 24) & 0xff;
+		rpt->data[7] = check & 0xff;
+		rpt->data[8] = check >> 8;
+	}
+}
+
+static int uhid_write(int fd, const struct uhid_event *ev)
+{
+	ssize_t ret = write(fd, ev, sizeof(*ev));
+	if (ret < 0) {
+		perror("write /dev/uhid");
+		return -1;
+	}
+	return 0;
+}
+
+static int create_device(int fd, const char *uniq)
+{
+	struct uhid_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.type = UHID_CREATE2;
+	snprintf((char *) ev.u.create2.name, sizeof(ev.u.create2.name), "T-Board virtual digitizer");
+	snprintf((char *) ev.u.create2.uniq, sizeof(ev.u.create2.uniq), "%s", uniq);
+	memcpy(ev.u.create2.rd_data, hidbench_report_map, hidbench_report_map_size);
+	ev.u.create2.rd_size = hidbench_report_map_size;
+	ev.u.create2.bus = BUS_USB;
+	ev.u.create2.vendor = VIRTUAL_VID;
+	ev.u.create2.product = VIRTUAL_PID;
+
+	return uhid_write(fd, &ev);
+}
+
+static void destroy_device(int fd)
+{
+	struct uhid_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.type = UHID_DESTROY;
+	uhid_write(fd, &ev);
+}
+
+/* Find the hidraw node of the virtual device. It has no USB parent, so
+   hid_enumerate() won't list it; look for its HID_UNIQ in sysfs instead.
+   Gives the kernel a moment to create the node. */
+static int find_hidraw_node(const char *uniq, char *path, size_t len)
+{
+	char want[128];
+	int tries;
+
+	snprintf(want, sizeof(want), "HID_UNIQ=%s\n", uniq);
+
+	for (tries = 0; tries < 100; tries++) {
+		DIR *dir = opendir("/sys/class/hidraw");
+		struct dirent *ent;
+
+		while (dir && (ent = readdir(dir)) != NULL) {
+			char uevent[512];
+			char file[256];
+			FILE *fp;
+			int found = 0;
+
+			if (ent->d_name[0] == '.')
+				continue;
+			snprintf(file, sizeof(file), "/sys/class/hidraw/%s/device/uevent", ent->d_name);
+			fp = fopen(file, "r");
+			if (!fp)
+				continue;
+			while (fgets(uevent, sizeof(uevent), fp)) {
+				if (strcmp(uevent, want) == 0)
+					found = 1;
+			}
+			fclose(fp);
+
+			if (found) {
+				snprintf(path, len, "/dev/%s", ent->d_name);
+				closedir(dir);
+				/* Wait for udev to create the node. */
+				while (access(path, R_OK | W_OK) != 0 && tries++ < 100)
+					usleep(10 * 1000);
+				return 0;
+			}
+		}
+		if (dir)
+			closedir(dir);
+		usleep(10 * 1000);
+	}
+
+	return -1;
+}
+
+/* Wait until the kernel reports that the hidraw node has been opened,
+   so that no report is sent into the void. */
+static int wait_for_open(int fd)
+{
+	struct uhid_event ev;
+	struct pollfd pfd;
+
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	for (;;) {
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 5000) <= 0)
+			return -1;
+		if (read(fd, &ev, sizeof(ev)) < 0)
+			return -1;
+		if (ev.type == UHID_OPEN)
+			return 0;
+	}
+}
+
+static int send_report(int fd, const unsigned char *data, size_t len)
+{
+	struct uhid_event ev;
+
+	memset(&ev, 0, sizeof(ev));
+	ev.type = UHID_INPUT2;
+	ev.u.input2.size = len;
+	memcpy(ev.u.input2.data, data, len);
+	return uhid_write(fd, &ev);
+}
+
+/* Give up on a run: removing the device makes every read path, blocking
+   ones included, return an error. */
+static void producer_fail(struct harness *h)
+{
+	atomic_store(&h->producer_failed, 1);
+	if (!atomic_exchange(&h->destroyed, 1))
+		destroy_device(h->uhid_fd);
+}
+
+static void *producer_thread(void *param)
+{
+	struct harness *h = param;
+	struct timespec next;
+	unsigned long long period_ns = (h->rate > 0)? (unsigned long long) (1e9 / h->rate): 0;
+	size_t i;
+	int tries;
+
+	if (!h->opened) {
+		if (wait_for_open(h->uhid_fd) < 0) {
+			printf("virtual device was never opened\n");
+			producer_fail(h);
+			return NULL;
+		}
+		h->opened = 1;
+	}
+
+	clock_gettime(CLOCK_MONOTONIC, &next);
+	for (i = 0; i < h->num_reports; i++) {
+		struct hidbench_report *rpt = &h->reports[i];
+
+		if (period_ns) {
+			clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+			next.tv_nsec += period_ns;
+			while (next.tv_nsec >= 1000000000L) {
+				next.tv_sec++;
+				next.tv_nsec -= 1000000000L;
+			}
+		}
+
+		atomic_store_explicit(&h->sent_ns[i], monotonic_ns(), memory_order_release);
+		if (send_report(h->uhid_fd, rpt->data, rpt->len) < 0) {
+			producer_fail(h);
+			return NULL;
+		}
+	}
+
+	/* The end report may be lost like any other, so repeat it. */
+	for (tries = 0; tries < END_REPORT_TRIES; tries++) {
+		if (atomic_load(&h->reader_done))
+			return NULL;
+		if (send_report(h->uhid_fd, end_report, sizeof(end_report)) < 0)
+			break;
+		usleep(END_REPORT_INTERVAL_US);
+	}
+
+	printf("the end of the stream never came back\n");
+	producer_fail(h);
+	return NULL;
+}
+
+/* Read one report through the path under test. */
+static int read_report(hid_device *dev, enum read_mode mode, unsigned char *buf, size_t len, unsigned long long *arrival)
+{
+	int res;
+
+	switch (mode) {
+	case READ_TIMESTAMP:
+		return hid_read_timeout_timestamp(dev, buf, len, 200, arrival);
+	case READ_BLOCKING:
+		res = hid_read(dev, buf, len);
+		break;
+	default:
+		res = hid_read(dev, buf, len);
+		if (res == 0)
+			sched_yield();
+		break;
+	}
+	*arrival = monotonic_ns();
+	return res;
+}
+
+/* Send the stream once and read it back through one read path, until
+   the end report arrives. */
+static void run_stream(struct harness *h, hid_device *dev, enum read_mode mode, struct run_result *res)
+{
+	pthread_t producer;
+	unsigned char buf[HIDBENCH_MAX_REPORT_LEN];
+	size_t expected = 0;
+	size_t i;
+
+	memset(res, 0, sizeof(*res));
+	res->latencies = calloc(h->num_reports? h->num_reports: 1, sizeof(unsigned long long));
+	for (i = 0; i < h->num_reports; i++)
+		atomic_init(&h->sent_ns[i], 0);
+	atomic_store(&h->producer_failed, 0);
+	atomic_store(&h->reader_done, 0);
+
+	if (hid_set_nonblocking(dev, mode == READ_NONBLOCKING) < 0) {
+		printf("FAIL: hid_set_nonblocking() returned an error\n");
+		res->failed = 1;
+		return;
+	}
+
+	pthread_create(&producer, NULL, producer_thread, h);
+
+	for (;;) {
+		unsigned long long arrival;
+		size_t j;
+		int len;
+
+		len = read_report(dev, mode, buf, sizeof(buf), &arrival);
+		if (len < 0) {
+			printf("FAIL: %s returned an error\n", mode_titles[mode]);
+			res->failed = 1;
+			break;
+		}
+		if (len == 0)
+			continue;
+		if ((size_t) len == sizeof(end_report) && memcmp(buf, end_report, len) == 0)
+			break;
+
+		if (res->received == 0)
+			res->first_arrival = arrival;
+		res->last_arrival = arrival;
+
+		/* Match the report against the next one expected, skipping
+		   over lost reports. */
+		for (j = expected; j < h->num_reports && j < expected + MATCH_WINDOW; j++) {
+			if ((size_t) len == h->reports[j].len &&
+			    memcmp(buf, h->reports[j].data, len) == 0)
+				break;
+		}
+		if (j == h->num_reports || j == expected + MATCH_WINDOW) {
+			res->corrupted++;
+			continue;
+		}
+		res->lost += j - expected;
+		expected = j + 1;
+		res->latencies[res->received++] =
+			arrival - atomic_load_explicit(&h->sent_ns[j], memory_order_acquire);
+	}
+
+	atomic_store(&h->reader_done, 1);
+	pthread_join(producer, NULL);
+	res->lost += h->num_reports - expected;
+
+	/* Drop the copies of the end report still queued. */
+	if (!atomic_load(&h->destroyed) && hid_set_nonblocking(dev, 1) == 0) {
+		while (hid_read(dev, buf, sizeof(buf)) > 0)
+			;
+	}
+
+	if (atomic_load(&h->producer_failed))
+		res->failed = 1;
+	hidbench_sort(res->latencies, res->received);
+}
+
+/* Check the report descriptor hidraw returns, and that the parser finds
+   the digitizer report in it. */
+static int check_descriptor(hid_device *dev)
+{
+	unsigned char desc[4096];
+	struct hid_report_descriptor parsed;
+	const struct hid_report_layout *layout;
+	int len;
+
+	len = hid_get_report_descriptor(dev, desc, sizeof(desc));
+	if (len != (int) hidbench_report_map_size || memcmp(desc, hidbench_report_map, len) != 0) {
+		printf("FAIL: report descriptor doesn't match the report map\n");
+		return -1;
+	}
+	if (hid_parse_report_descriptor(desc, len, &parsed) < 0) {
+		printf("FAIL: report descriptor doesn't parse\n");
+		return -1;
+	}
+	layout = hid_find_report_layout(&parsed, HID_REPORT_TYPE_INPUT, HIDBENCH_DIGITIZER_REPORT_ID);
+	if (!layout || layout->num_fields != 4 || layout->size_bits != 64) {
+		printf("FAIL: digitizer report layout is wrong\n");
+		return -1;
+	}
+	return 0;
+}
+
+static void print_result(const struct harness *h, enum read_mode mode, const struct run_result *res, int json)
+{
+	double seconds = (res->last_arrival - res->first_arrival) / 1e9;
+
+	if (json) {
+		printf("  \"%s\": {\n", mode_names[mode]);
+		printf("    \"sent\": %u,\n", (unsigned) h->num_reports);
+		printf("    \"received\": %u,\n", (unsigned) res->received);
+		printf("    \"lost\": %u,\n", (unsigned) res->lost);
+		printf("    \"corrupted\": %u,\n", (unsigned) res->corrupted);
+		printf("    \"reports_per_sec\": %.3f,\n", (seconds > 0)? res->received / seconds: 0.0);
+		printf("    \"latency_us\": { \"p50\": %.3f, \"p90\": %.3f, \"p99\": %.3f, \"max\": %.3f },\n",
+		       hidbench_percentile(res->latencies, res->received, 50) / 1e3,
+		       hidbench_percentile(res->latencies, res->received, 90) / 1e3,
+		       hidbench_percentile(res->latencies, res->received, 99) / 1e3,
+		       hidbench_percentile(res->latencies, res->received, 100) / 1e3);
+		printf("    \"result\": \"%s\"\n", (res->failed)? "FAIL": "PASS");
+		printf("  },\n");
+	}
+	else {
+		printf("%s:\n", mode_titles[mode]);
+		printf("  Sent:        %u reports\n", (unsigned) h->num_reports);
+		printf("  Received:    %u, %u lost, %u corrupted\n", (unsigned) res->received, (unsigned) res->lost, (unsigned) res->corrupted);
+		printf("  Reports/s:   %.1f\n", (seconds > 0)? res->received / seconds: 0.0);
+		printf("  Latency:     p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us\n",
+		       hidbench_percentile(res->latencies, res->received, 50) / 1e3,
+		       hidbench_percentile(res->latencies, res->received, 90) / 1e3,
+		       hidbench_percentile(res->latencies, res->received, 99) / 1e3,
+		       hidbench_percentile(res->latencies, res->received, 100) / 1e3);
+		printf("  %s\n", (res->failed)? "FAIL": "PASS");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	struct harness h;
+	hid_device *dev;
+	char uniq[64];
+	char path[64];
+	const char *capture = NULL;
+	size_t count = 10000;
+	int first_mode = 0, last_mode = NUM_READ_MODES - 1;
+	int allow_loss = 0;
+	int json = 0;
+	int failed = 0;
+	int i, mode;
+
+	memset(&h, 0, sizeof(h));
+	h.rate = 1000;
+
+	for (i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-L") == 0)
+			allow_loss = 1;
+		else if (strcmp(argv[i], "-j") == 0)
+			json = 1;
+		else if (i + 1 < argc && strcmp(argv[i], "-n") == 0)
+			count = strtoul(argv[++i], NULL, 10);
+		else if (i + 1 < argc && strcmp(argv[i], "-r") == 0)
+			h.rate = atof(argv[++i]);
+		else if (i + 1 < argc && strcmp(argv[i], "-c") == 0)
+			capture = argv[++i];
+		else if (i + 1 < argc && strcmp(argv[i], "-m") == 0) {
+			const char *name = argv[++i];
+
+			if (strcmp(name, "all") != 0) {
+				for (mode = 0; mode < NUM_READ_MODES; mode++) {
+					if (strcmp(name, mode_names[mode]) == 0)
+						break;
+				}
+				if (mode == NUM_READ_MODES) {
+					usage();
+					return 1;
+				}
+				first_mode = last_mode = mode;
+			}
+		}
+		else {
+			usage();
+			return 1;
+		}
+	}
+
+	if (capture) {
+		if (hidbench_load_capture(capture, &h.reports, &h.num_reports) < 0)
+			return 1;
+	}
+	else {
+		make_synthetic(&h, count);
+	}
+	h.sent_ns = calloc(h.num_reports? h.num_reports: 1, sizeof(atomic_ullong));
+
+	h.uhid_fd = open("/dev/uhid", O_RDWR | O_CLOEXEC);
+	if (h.uhid_fd < 0) {
+		perror("open /dev/uhid");
+		return 1;
+	}
+
+	snprintf(uniq, sizeof(uniq), "uhidtest-%d", (int) getpid());
+	if (create_device(h.uhid_fd, uniq) < 0)
+		return 1;
+	if (find_hidraw_node(uniq, path, sizeof(path)) < 0) {
+		printf("no hidraw node for the virtual device\n");
+		destroy_device(h.uhid_fd);
+		return 1;
+	}
+
+	dev = hid_open_path(path);
+	if (!dev) {
+		printf("unable to open %s\n", path);
+		destroy_device(h.uhid_fd);
+		return 1;
+	}
+	if (check_descriptor(dev) < 0)
+		failed = 1;
+
+	if (json)
+		printf("{\n");
+	for (mode = first_mode; mode <= last_mode; mode++) {
+		struct run_result res;
+
+		run_stream(&h, dev, (enum read_mode) mode, &res);
+		if (res.corrupted > 0 || (res.lost > 0 && !allow_loss))
+			res.failed = 1;
+		if (res.failed)
+			failed = 1;
+		print_result(&h, (enum read_mode) mode, &res, json);
+		free(res.latencies);
+
+		/* Without the device the other read paths can't be run. */
+		if (atomic_load(&h.destroyed))
+			break;
+	}
+	if (json) {
+		printf("  \"result\": \"%s\"\n", (failed)? "FAIL": "PASS");
+		printf("}\n");
+	}
+	else {
+		printf("%s\n", (failed)? "FAIL": "PASS");
+	}
+
+	hid_close(dev);
+	if (!atomic_load(&h.destroyed))
+		destroy_device(h.uhid_fd);
+	close(h.uhid_fd);
+	hid_exit();
+
+	free(h.sent_ns);
+	free(h.reports);
+
+	return failed;
+}
@@ -481,6 +481,22 @@ void  HID_API_EXPORT HID_API_CALL hid_free_enumeration(struct hid_device_info *d
 	}
 }
 
+int HID_API_EXPORT HID_API_CALL hid_register_hotplug_callback(unsigned short vendor_id, unsigned short product_id, hid_hotplug_callback callback, void *user_data)
+{
+	/* Hotplug notification is not implemented by this backend. */
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_deregister_hotplug_callback(hid_hotplug_callback callback, void *user_data)
+{
+	return -1;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_hotplug_process(int milliseconds)
+{
+	return -1;
+}
+
 
 HID_API_EXPORT hid_device * HID_API_CALL hid_open(unsigned short vendor_id, unsigned short product_id, wchar_t *serial_number)
 {
@@ -599,11 +615,26 @@ int HID_API_EXPORT HID_API_CALL hid_write(hid_device *dev, const unsigned char *
 }
 
 
-int HID_API_EXPORT HID_API_CALL hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+/* Return a monotonic time in nanoseconds, from the performance counter. */
+static unsigned long long monotonic_ns(void)
+{
+	static LARGE_INTEGER freq;
+	LARGE_INTEGER count;
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&count);
+	return (unsigned long long) (count.QuadPart / freq.QuadPart) * 1000000000ULL +
+		(unsigned long long) (count.QuadPart % freq.QuadPart) * 1000000000ULL / freq.QuadPart;
+}
+
+int HID_API_EXPORT HID_API_CALL hid_read_timeout_timestamp(hid_device *dev, unsigned char *data, size_t length, int milliseconds, unsigned long long *timestamp_ns)
 {
 	DWORD bytes_read = 0;
 	BOOL res;
 
+	if (timestamp_ns)
+		*timestamp_ns = 0;
+
 	// Copy the handle for convenience.
 	HANDLE ev = dev->ol.hEvent;
 
@@ -642,6 +673,11 @@ int HID_API_EXPORT HID_API_CALL hid_read_timeout(hid_device *dev, unsigned char
 	// Set pending back to false, even if GetOverlappedResult() returned error.
 	dev->read_pending = FALSE;
 
+	// Windows doesn't tell us when the report arrived, so the completion
+	// of the overlapped read is the closest we can get.
+	if (timestamp_ns && res && bytes_read > 0)
+		*timestamp_ns = monotonic_ns();
+
 	if (res && bytes_read > 0) {
 		if (dev->read_buf[0] == 0x0) {
 			/* If report numbers aren't being used, but Windows sticks a report
@@ -666,6 +702,11 @@ end_of_function:
 	return bytes_read;
 }
 
+int HID_API_EXPORT HID_API_CALL hid_read_timeout(hid_device *dev, unsigned char *data, size_t length, int milliseconds)
+{
+	return hid_read_timeout_timestamp(dev, data, length, milliseconds, NULL);
+}
+
 int HID_API_EXPORT HID_API_CALL hid_read(hid_device *dev, unsigned char *data, size_t length)
 {
 	return hid_read_timeout(dev, data, length, (dev->blocking)? -1: 0);
@@ -795,6 +836,12 @@ int HID_API_EXPORT_CALL HID_API_CALL hid_get_indexed_string(hid_device *dev, int
 	return 0;
 }
 
+int HID_API_EXPORT_CALL HID_API_CALL hid_get_report_descriptor(hid_device *dev, unsigned char *buf, size_t buf_size)
+{
+	// Windows only exposes the descriptor in its preparsed form.
+	return -1;
+}
+
 
 HID_API_EXPORT const wchar_t * HID_API_CALL  hid_error(hid_device *dev)
 {